@@ -0,0 +1,1482 @@
+/*
+  Copyright 2018 David Anderson. All rights reserved.
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of version 2 of the GNU General Public License as
+  published by the Free Software Foundation.
+
+  This program is distributed in the hope that it would be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  Further, this software is distributed without any warranty that it is
+  free of the rightful claim of any third person regarding infringement
+  or the like.  Any license provided herein, whether implied or
+  otherwise, applies only to this software file.  Patent licenses, if
+  any, provided herein do not apply to combinations of this program with
+  other software, or any other product whatsoever.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write the Free Software Foundation, Inc., 51
+  Franklin Street - Fifth Floor, Boston MA 02110-1301, USA.
+*/
+
+/*  See cu_cache.h.
+
+    The cache file is a header, one record per CU saved
+    and a trailer.  A record holds the CU's hash and what
+    cu_workers.c passes from a worker to the parent: the
+    state the CU started from and left behind, the counts
+    it added (-ku usage counts included) and its stdout
+    and stderr, along with the -kG errors it saw.  The new file is
+    written beside the old one as the CUs are printed and
+    renamed over it at the end, so a CU that is not
+    printed this time drops out of the cache.
+
+    A CU is saved by pointing stdout and stderr at
+    temporary files while it is printed.  Should dwarfdump
+    exit part way through the CU, an atexit() function
+    copies what was printed to the real stdout and stderr.
+    As with -x workers= that needs a Unix-like system;
+    elsewhere the option is accepted and does nothing. */
+
+#include "globals.h"
+#include <limits.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include "tag_common.h"
+#include "cu_workers.h"
+#include "cu_cache.h"
+
+#ifdef HAVE_CU_WORKERS
+#define CU_CACHE_MAGIC   0x44434355
+#define CU_CACHE_TRAILER 0x44434345
+/*  Change whenever what is saved, or what the hash
+    covers, changes. */
+#define CU_CACHE_VERSION 2
+
+#define CACHE_FNV_OFFSET 0xcbf29ce484222325ULL
+#define CACHE_FNV_PRIME  0x100000001b3ULL
+
+struct cache_section_s {
+    const char        *cs_name;
+    const Dwarf_Small *cs_data;
+    Dwarf_Unsigned     cs_size;
+    boolean            cs_loaded;
+    boolean            cs_hashed;
+    Dwarf_Unsigned     cs_hash;
+};
+
+enum cache_section_e {
+    CS_INFO,
+    CS_TYPES,
+    CS_ABBREV,
+    CS_LINE,
+    CS_LINE_STR,
+    CS_RANGES,
+    CS_LOC,
+    CS_RNGLISTS,
+    CS_LOCLISTS,
+    CS_ADDR,
+    CS_STR_OFFSETS,
+    CS_COUNT
+};
+
+static const char *cache_section_names[CS_COUNT] = {
+    ".debug_info",
+    ".debug_types",
+    ".debug_abbrev",
+    ".debug_line",
+    ".debug_line_str",
+    ".debug_ranges",
+    ".debug_loc",
+    ".debug_rnglists",
+    ".debug_loclists",
+    ".debug_addr",
+    ".debug_str_offsets"
+};
+
+/*  One record of the previous run's file. */
+struct cache_entry_s {
+    Dwarf_Unsigned ce_is_info;
+    Dwarf_Unsigned ce_cu_offset;
+    Dwarf_Unsigned ce_hash;
+    long           ce_record;  /* Where its length is. */
+    Dwarf_Unsigned ce_length;  /* Bytes after the length. */
+};
+
+/*  What a CU record starts with. */
+struct cache_key_s {
+    Dwarf_Unsigned ck_is_info;
+    Dwarf_Unsigned ck_cu_offset;
+    Dwarf_Unsigned ck_hash;
+};
+
+struct cache_header_s {
+    unsigned       ch_magic;
+    unsigned       ch_version;
+    unsigned       ch_sizes;
+    Dwarf_Unsigned ch_object_hash;
+};
+
+static Dwarf_Unsigned options_hash = CACHE_FNV_OFFSET;
+
+static boolean cache_is_active = FALSE;
+static boolean cache_big_endian = FALSE;
+static Dwarf_Debug cache_dbg = 0;
+static Dwarf_Unsigned object_hash = 0;
+static struct cache_section_s cache_sections[CS_COUNT];
+
+static FILE *old_file = 0;
+static struct cache_entry_s *old_entries = 0;
+static Dwarf_Unsigned old_count = 0;
+
+static FILE *new_file = 0;
+static char *new_path = 0;
+
+/*  Set while a CU is being saved. */
+static boolean recording = FALSE;
+static struct cache_key_s rec_key;
+static struct cu_worker_boundary_s rec_inbound;
+static struct cu_cache_checks_s rec_before;
+static FILE *rec_out = 0;
+static FILE *rec_err = 0;
+/*  The harmless errors from before the CU, then the
+    CU's own. */
+static FILE *rec_harmless = 0;
+static long harmless_saved_end = 0;
+static int real_stdout = -1;
+static int real_stderr = -1;
+static boolean atexit_done = FALSE;
+
+static Dwarf_Unsigned
+hash_bytes(Dwarf_Unsigned h,const void *data,Dwarf_Unsigned len)
+{
+    const unsigned char *p = (const unsigned char *)data;
+    const unsigned char *end = p + len;
+
+    for ( ; p < end; ++p) {
+        h ^= *p;
+        h *= CACHE_FNV_PRIME;
+    }
+    return h;
+}
+
+static Dwarf_Unsigned
+hash_value(Dwarf_Unsigned h,Dwarf_Unsigned v)
+{
+    unsigned char b[8];
+    int i = 0;
+
+    for (i = 0; i < 8; ++i) {
+        b[i] = (unsigned char)(v >> (i*8));
+    }
+    return hash_bytes(h,b,sizeof(b));
+}
+
+static Dwarf_Unsigned
+hash_string(Dwarf_Unsigned h,const char *s)
+{
+    return hash_bytes(h,s,strlen(s)+1);
+}
+
+void
+cu_cache_set_options(int optcount,char **argv)
+{
+    int i = 0;
+
+    options_hash = CACHE_FNV_OFFSET;
+    for (i = 1; i < optcount; ++i) {
+        options_hash = hash_string(options_hash,argv[i]);
+    }
+}
+
+static struct cache_section_s *
+cache_section(enum cache_section_e which)
+{
+    struct cache_section_s *cs = &cache_sections[which];
+
+    if (!cs->cs_loaded) {
+        Dwarf_Error err = 0;
+        int res = dwarf_get_section_data_by_name(cache_dbg,cs->cs_name,
+            &cs->cs_data,&cs->cs_size,&err);
+
+        if (res == DW_DLV_ERROR) {
+            dwarf_dealloc(cache_dbg,err,DW_DLA_ERROR);
+        }
+        if (res != DW_DLV_OK) {
+            cs->cs_data = 0;
+            cs->cs_size = 0;
+        }
+        cs->cs_loaded = TRUE;
+    }
+    return cs;
+}
+
+/*  For sections only reachable through an index (or
+    not worth following) the whole section is hashed,
+    once. */
+static Dwarf_Unsigned
+hash_whole_section(Dwarf_Unsigned h,enum cache_section_e which)
+{
+    struct cache_section_s *cs = cache_section(which);
+
+    if (!cs->cs_hashed) {
+        cs->cs_hash = hash_bytes(CACHE_FNV_OFFSET,cs->cs_data,
+            cs->cs_size);
+        cs->cs_hashed = TRUE;
+    }
+    h = hash_value(h,cs->cs_size);
+    return hash_value(h,cs->cs_hash);
+}
+
+/*  Readers for the list and table parsers below.  Each
+    returns FALSE if the value runs past end. */
+static boolean
+read_uleb(const Dwarf_Small **pp,const Dwarf_Small *end,
+    Dwarf_Unsigned *out)
+{
+    const Dwarf_Small *p = *pp;
+    Dwarf_Unsigned v = 0;
+    unsigned shift = 0;
+
+    for (;;) {
+        if (p >= end) {
+            return FALSE;
+        }
+        if (shift < 64) {
+            v |= ((Dwarf_Unsigned)(*p & 0x7f)) << shift;
+        }
+        shift += 7;
+        if (!(*p++ & 0x80)) {
+            break;
+        }
+    }
+    *pp = p;
+    *out = v;
+    return TRUE;
+}
+
+static boolean
+read_fixed(const Dwarf_Small **pp,const Dwarf_Small *end,
+    unsigned len,Dwarf_Unsigned *out)
+{
+    const Dwarf_Small *p = *pp;
+    Dwarf_Unsigned v = 0;
+    unsigned i = 0;
+
+    if (len > 8 || (Dwarf_Unsigned)(end - p) < len) {
+        return FALSE;
+    }
+    for (i = 0; i < len; ++i) {
+        unsigned shift = cache_big_endian? (len-1-i)*8: i*8;
+
+        v |= ((Dwarf_Unsigned)p[i]) << shift;
+    }
+    *pp = p + len;
+    *out = v;
+    return TRUE;
+}
+
+static boolean
+skip_bytes(const Dwarf_Small **pp,const Dwarf_Small *end,
+    Dwarf_Unsigned len)
+{
+    if ((Dwarf_Unsigned)(end - *pp) < len) {
+        return FALSE;
+    }
+    *pp += len;
+    return TRUE;
+}
+
+/*  Hashes the bytes of a section from offset to wherever
+    the list or table there ends, as found by endfunc.
+    A list that cannot be followed brings in the whole
+    section instead. */
+typedef boolean (*cache_end_func)(const Dwarf_Small **pp,
+    const Dwarf_Small *end,unsigned address_size);
+
+static Dwarf_Unsigned
+hash_section_part(Dwarf_Unsigned h,enum cache_section_e which,
+    Dwarf_Unsigned offset,cache_end_func endfunc,
+    unsigned address_size)
+{
+    struct cache_section_s *cs = cache_section(which);
+    const Dwarf_Small *p = 0;
+    const Dwarf_Small *end = cs->cs_data + cs->cs_size;
+
+    if (!cs->cs_data || offset >= cs->cs_size) {
+        return hash_whole_section(h,which);
+    }
+    p = cs->cs_data + offset;
+    if (!endfunc(&p,end,address_size)) {
+        return hash_whole_section(h,which);
+    }
+    h = hash_value(h,offset);
+    return hash_bytes(h,cs->cs_data + offset,p - (cs->cs_data + offset));
+}
+
+/*  One abbreviation table, up to its zero code. */
+static boolean
+abbrev_table_end(const Dwarf_Small **pp,const Dwarf_Small *end,
+    UNUSEDARG unsigned address_size)
+{
+    for (;;) {
+        Dwarf_Unsigned code = 0;
+        Dwarf_Unsigned tag = 0;
+
+        if (!read_uleb(pp,end,&code)) {
+            return FALSE;
+        }
+        if (!code) {
+            return TRUE;
+        }
+        if (!read_uleb(pp,end,&tag) || !skip_bytes(pp,end,1)) {
+            return FALSE;
+        }
+        for (;;) {
+            Dwarf_Unsigned attr = 0;
+            Dwarf_Unsigned form = 0;
+            Dwarf_Unsigned ignored = 0;
+
+            if (!read_uleb(pp,end,&attr) ||
+                !read_uleb(pp,end,&form)) {
+                return FALSE;
+            }
+            if (!attr && !form) {
+                break;
+            }
+            if (form == DW_FORM_implicit_const &&
+                !read_uleb(pp,end,&ignored)) {
+                return FALSE;
+            }
+        }
+    }
+}
+
+/*  DWARF2,3,4 .debug_ranges: address pairs up to a 0,0 pair. */
+static boolean
+ranges_list_end(const Dwarf_Small **pp,const Dwarf_Small *end,
+    unsigned address_size)
+{
+    for (;;) {
+        Dwarf_Unsigned lo = 0;
+        Dwarf_Unsigned hi = 0;
+
+        if (!read_fixed(pp,end,address_size,&lo) ||
+            !read_fixed(pp,end,address_size,&hi)) {
+            return FALSE;
+        }
+        if (!lo && !hi) {
+            return TRUE;
+        }
+    }
+}
+
+/*  DWARF2,3,4 .debug_loc: like .debug_ranges but each
+    pair other than a base address selection is followed
+    by a 2 byte length and an expression. */
+static boolean
+loc_list_end(const Dwarf_Small **pp,const Dwarf_Small *end,
+    unsigned address_size)
+{
+    Dwarf_Unsigned max = (address_size == 8)?
+        0xffffffffffffffffULL: 0xffffffff;
+
+    for (;;) {
+        Dwarf_Unsigned lo = 0;
+        Dwarf_Unsigned hi = 0;
+        Dwarf_Unsigned len = 0;
+
+        if (!read_fixed(pp,end,address_size,&lo) ||
+            !read_fixed(pp,end,address_size,&hi)) {
+            return FALSE;
+        }
+        if (!lo && !hi) {
+            return TRUE;
+        }
+        if (lo == max) {
+            continue;
+        }
+        if (!read_fixed(pp,end,2,&len) || !skip_bytes(pp,end,len)) {
+            return FALSE;
+        }
+    }
+}
+
+/*  DWARF5 .debug_rnglists, from DW_RLE_* to DW_RLE_end_of_list. */
+static boolean
+rnglist_end(const Dwarf_Small **pp,const Dwarf_Small *end,
+    unsigned address_size)
+{
+    for (;;) {
+        Dwarf_Unsigned kind = 0;
+        Dwarf_Unsigned v = 0;
+
+        if (!read_fixed(pp,end,1,&kind)) {
+            return FALSE;
+        }
+        switch (kind) {
+        case DW_RLE_end_of_list:
+            return TRUE;
+        case DW_RLE_base_addressx:
+            if (!read_uleb(pp,end,&v)) {
+                return FALSE;
+            }
+            break;
+        case DW_RLE_startx_endx:
+        case DW_RLE_startx_length:
+        case DW_RLE_offset_pair:
+            if (!read_uleb(pp,end,&v) || !read_uleb(pp,end,&v)) {
+                return FALSE;
+            }
+            break;
+        case DW_RLE_base_address:
+            if (!skip_bytes(pp,end,address_size)) {
+                return FALSE;
+            }
+            break;
+        case DW_RLE_start_end:
+            if (!skip_bytes(pp,end,2*address_size)) {
+                return FALSE;
+            }
+            break;
+        case DW_RLE_start_length:
+            if (!skip_bytes(pp,end,address_size) ||
+                !read_uleb(pp,end,&v)) {
+                return FALSE;
+            }
+            break;
+        default:
+            return FALSE;
+        }
+    }
+}
+
+/*  DWARF5 .debug_loclists, from DW_LLE_* to DW_LLE_end_of_list. */
+static boolean
+loclist_end(const Dwarf_Small **pp,const Dwarf_Small *end,
+    unsigned address_size)
+{
+    for (;;) {
+        Dwarf_Unsigned kind = 0;
+        Dwarf_Unsigned v = 0;
+        boolean has_expr = TRUE;
+
+        if (!read_fixed(pp,end,1,&kind)) {
+            return FALSE;
+        }
+        switch (kind) {
+        case DW_LLE_end_of_list:
+            return TRUE;
+        case DW_LLE_base_addressx:
+            if (!read_uleb(pp,end,&v)) {
+                return FALSE;
+            }
+            has_expr = FALSE;
+            break;
+        case DW_LLE_startx_endx:
+        case DW_LLE_startx_length:
+        case DW_LLE_offset_pair:
+            if (!read_uleb(pp,end,&v) || !read_uleb(pp,end,&v)) {
+                return FALSE;
+            }
+            break;
+        case DW_LLE_default_location:
+            break;
+        case DW_LLE_base_address:
+            if (!skip_bytes(pp,end,address_size)) {
+                return FALSE;
+            }
+            has_expr = FALSE;
+            break;
+        case DW_LLE_start_end:
+            if (!skip_bytes(pp,end,2*address_size)) {
+                return FALSE;
+            }
+            break;
+        case DW_LLE_start_length:
+            if (!skip_bytes(pp,end,address_size) ||
+                !read_uleb(pp,end,&v)) {
+                return FALSE;
+            }
+            break;
+        default:
+            return FALSE;
+        }
+        if (has_expr &&
+            (!read_uleb(pp,end,&v) || !skip_bytes(pp,end,v))) {
+            return FALSE;
+        }
+    }
+}
+
+/*  One line table program, by its unit length.  A DWARF5
+    table names its files in .debug_line_str, which is
+    then hashed as a whole. */
+static Dwarf_Unsigned
+hash_line_table(Dwarf_Unsigned h,Dwarf_Unsigned offset)
+{
+    struct cache_section_s *cs = cache_section(CS_LINE);
+    const Dwarf_Small *p = 0;
+    const Dwarf_Small *end = cs->cs_data + cs->cs_size;
+    Dwarf_Unsigned length = 0;
+    Dwarf_Unsigned version = 0;
+    const Dwarf_Small *start = 0;
+
+    if (!cs->cs_data || offset >= cs->cs_size) {
+        return hash_whole_section(h,CS_LINE);
+    }
+    start = p = cs->cs_data + offset;
+    if (!read_fixed(&p,end,4,&length)) {
+        return hash_whole_section(h,CS_LINE);
+    }
+    if (length == 0xffffffff && !read_fixed(&p,end,8,&length)) {
+        return hash_whole_section(h,CS_LINE);
+    }
+    if ((Dwarf_Unsigned)(end - p) < length ||
+        !read_fixed(&p,end,2,&version)) {
+        return hash_whole_section(h,CS_LINE);
+    }
+    p = p - 2 + length;
+    h = hash_value(h,offset);
+    h = hash_bytes(h,start,p - start);
+    if (version >= 5) {
+        h = hash_whole_section(h,CS_LINE_STR);
+    }
+    return h;
+}
+
+/*  Section offset from a DW_FORM_sec_offset or DW_FORM_dataN
+    attribute. */
+static boolean
+attr_offset(Dwarf_Attribute attr,Dwarf_Half form,Dwarf_Unsigned *out)
+{
+    Dwarf_Error err = 0;
+    Dwarf_Off off = 0;
+    Dwarf_Unsigned u = 0;
+    int res = 0;
+
+    if (form == DW_FORM_sec_offset) {
+        res = dwarf_global_formref(attr,&off,&err);
+        u = off;
+    } else {
+        res = dwarf_formudata(attr,&u,&err);
+    }
+    if (res == DW_DLV_ERROR) {
+        dwarf_dealloc(cache_dbg,err,DW_DLA_ERROR);
+    }
+    if (res != DW_DLV_OK) {
+        return FALSE;
+    }
+    *out = u;
+    return TRUE;
+}
+
+struct cu_hash_s {
+    Dwarf_Unsigned hs_hash;
+    Dwarf_Half     hs_version;
+    Dwarf_Half     hs_offset_size;
+    Dwarf_Half     hs_address_size;
+    /*  Whole sections to bring in once the CU is done. */
+    boolean        hs_whole[CS_COUNT];
+};
+
+/*  Adds what one attribute reaches outside the CU.
+    Returns DW_DLV_NO_ENTRY if the CU must not be cached. */
+static int
+hash_attribute(struct cu_hash_s *hs,Dwarf_Attribute attr)
+{
+    Dwarf_Error err = 0;
+    Dwarf_Half attrnum = 0;
+    Dwarf_Half form = 0;
+    Dwarf_Unsigned offset = 0;
+    char *str = 0;
+    int res = 0;
+
+    if (dwarf_whatattr(attr,&attrnum,&err) != DW_DLV_OK ||
+        dwarf_whatform(attr,&form,&err) != DW_DLV_OK) {
+        if (err) {
+            dwarf_dealloc(cache_dbg,err,DW_DLA_ERROR);
+        }
+        return DW_DLV_NO_ENTRY;
+    }
+    switch (form) {
+    case DW_FORM_ref_addr:
+    case DW_FORM_ref_sig8:
+    case DW_FORM_ref_sup4:
+    case DW_FORM_ref_sup8:
+    case DW_FORM_strp_sup:
+    case DW_FORM_GNU_ref_alt:
+    case DW_FORM_GNU_strp_alt:
+        /*  Checking follows these into other CUs or files. */
+        return DW_DLV_NO_ENTRY;
+    case DW_FORM_strx:
+    case DW_FORM_strx1:
+    case DW_FORM_strx2:
+    case DW_FORM_strx3:
+    case DW_FORM_strx4:
+    case DW_FORM_GNU_str_index:
+        hs->hs_whole[CS_STR_OFFSETS] = TRUE;
+        /* FALLTHRU */
+    case DW_FORM_string:
+    case DW_FORM_strp:
+    case DW_FORM_line_strp:
+        res = dwarf_formstring(attr,&str,&err);
+        if (res == DW_DLV_ERROR) {
+            dwarf_dealloc(cache_dbg,err,DW_DLA_ERROR);
+            return DW_DLV_NO_ENTRY;
+        }
+        if (res == DW_DLV_OK) {
+            hs->hs_hash = hash_string(hs->hs_hash,str);
+        }
+        return DW_DLV_OK;
+    case DW_FORM_addrx:
+    case DW_FORM_addrx1:
+    case DW_FORM_addrx2:
+    case DW_FORM_addrx3:
+    case DW_FORM_addrx4:
+    case DW_FORM_GNU_addr_index:
+        hs->hs_whole[CS_ADDR] = TRUE;
+        return DW_DLV_OK;
+    case DW_FORM_loclistx:
+        hs->hs_whole[CS_LOCLISTS] = TRUE;
+        return DW_DLV_OK;
+    case DW_FORM_rnglistx:
+        hs->hs_whole[CS_RNGLISTS] = TRUE;
+        return DW_DLV_OK;
+    default:
+        break;
+    }
+    /*  Split DWARF4 bases: offsets and indexes in the CU
+        are relative to these. */
+    if (attrnum == DW_AT_GNU_addr_base) {
+        hs->hs_whole[CS_ADDR] = TRUE;
+        return DW_DLV_OK;
+    }
+    if (attrnum == DW_AT_GNU_ranges_base) {
+        hs->hs_whole[CS_RANGES] = TRUE;
+        return DW_DLV_OK;
+    }
+    switch (dwarf_get_form_class(hs->hs_version,attrnum,
+        hs->hs_offset_size,form)) {
+    case DW_FORM_CLASS_LINEPTR:
+        if (!attr_offset(attr,form,&offset)) {
+            return DW_DLV_NO_ENTRY;
+        }
+        hs->hs_hash = hash_line_table(hs->hs_hash,offset);
+        break;
+    case DW_FORM_CLASS_LOCLISTPTR:
+        if (!attr_offset(attr,form,&offset)) {
+            return DW_DLV_NO_ENTRY;
+        }
+        hs->hs_hash = hash_section_part(hs->hs_hash,CS_LOC,offset,
+            loc_list_end,hs->hs_address_size);
+        break;
+    case DW_FORM_CLASS_RANGELISTPTR:
+        if (!attr_offset(attr,form,&offset)) {
+            return DW_DLV_NO_ENTRY;
+        }
+        hs->hs_hash = hash_section_part(hs->hs_hash,CS_RANGES,offset,
+            ranges_list_end,hs->hs_address_size);
+        break;
+    case DW_FORM_CLASS_LOCLIST:
+        if (!attr_offset(attr,form,&offset)) {
+            return DW_DLV_NO_ENTRY;
+        }
+        hs->hs_hash = hash_section_part(hs->hs_hash,CS_LOCLISTS,offset,
+            loclist_end,hs->hs_address_size);
+        break;
+    case DW_FORM_CLASS_RNGLIST:
+        if (!attr_offset(attr,form,&offset)) {
+            return DW_DLV_NO_ENTRY;
+        }
+        hs->hs_hash = hash_section_part(hs->hs_hash,CS_RNGLISTS,offset,
+            rnglist_end,hs->hs_address_size);
+        break;
+    case DW_FORM_CLASS_ADDRPTR:
+        hs->hs_whole[CS_ADDR] = TRUE;
+        break;
+    case DW_FORM_CLASS_STROFFSETSPTR:
+        hs->hs_whole[CS_STR_OFFSETS] = TRUE;
+        break;
+    case DW_FORM_CLASS_LOCLISTSPTR:
+        hs->hs_whole[CS_LOCLISTS] = TRUE;
+        break;
+    case DW_FORM_CLASS_RNGLISTSPTR:
+        hs->hs_whole[CS_RNGLISTS] = TRUE;
+        break;
+    default:
+        /*  The value is in the CU bytes. */
+        break;
+    }
+    return DW_DLV_OK;
+}
+
+static int
+hash_die_attributes(struct cu_hash_s *hs,Dwarf_Die die)
+{
+    Dwarf_Error err = 0;
+    Dwarf_Attribute *atlist = 0;
+    Dwarf_Signed atcnt = 0;
+    Dwarf_Signed i = 0;
+    int res = dwarf_attrlist(die,&atlist,&atcnt,&err);
+
+    if (res == DW_DLV_ERROR) {
+        dwarf_dealloc(cache_dbg,err,DW_DLA_ERROR);
+        return DW_DLV_NO_ENTRY;
+    }
+    if (res == DW_DLV_NO_ENTRY) {
+        return DW_DLV_OK;
+    }
+    res = DW_DLV_OK;
+    for (i = 0; i < atcnt; ++i) {
+        if (res == DW_DLV_OK) {
+            res = hash_attribute(hs,atlist[i]);
+        }
+        dwarf_dealloc(cache_dbg,atlist[i],DW_DLA_ATTR);
+    }
+    dwarf_dealloc(cache_dbg,atlist,DW_DLA_LIST);
+    return res;
+}
+
+/*  The DIE and its siblings and all their children.
+    die is deallocated here unless it is the CU DIE. */
+static int
+hash_dies(struct cu_hash_s *hs,Dwarf_Die die,Dwarf_Bool is_info,
+    boolean is_cu_die)
+{
+    int res = DW_DLV_OK;
+
+    while (die) {
+        Dwarf_Error err = 0;
+        Dwarf_Die child = 0;
+        Dwarf_Die sibling = 0;
+        int cres = 0;
+        int sres = DW_DLV_NO_ENTRY;
+
+        res = hash_die_attributes(hs,die);
+        if (res == DW_DLV_OK) {
+            cres = dwarf_child(die,&child,&err);
+            if (cres == DW_DLV_OK) {
+                res = hash_dies(hs,child,is_info,FALSE);
+            } else if (cres == DW_DLV_ERROR) {
+                dwarf_dealloc(cache_dbg,err,DW_DLA_ERROR);
+                res = DW_DLV_NO_ENTRY;
+            }
+        }
+        if (res == DW_DLV_OK && !is_cu_die) {
+            sres = dwarf_siblingof_b(cache_dbg,die,is_info,
+                &sibling,&err);
+            if (sres == DW_DLV_ERROR) {
+                dwarf_dealloc(cache_dbg,err,DW_DLA_ERROR);
+                res = DW_DLV_NO_ENTRY;
+            }
+        }
+        if (!is_cu_die) {
+            dwarf_dealloc(cache_dbg,die,DW_DLA_DIE);
+        }
+        if (res != DW_DLV_OK || sres != DW_DLV_OK) {
+            break;
+        }
+        die = sibling;
+    }
+    return res;
+}
+
+/*  Returns DW_DLV_NO_ENTRY if the CU cannot be cached. */
+static int
+hash_cu(Dwarf_Debug dbg,Dwarf_Bool is_info,Dwarf_Die cu_die,
+    Dwarf_Off cu_offset,Dwarf_Off next_cu_offset,
+    Dwarf_Unsigned abbrev_offset,Dwarf_Unsigned *hash_out)
+{
+    struct cu_hash_s hs;
+    struct cache_section_s *cs =
+        cache_section(is_info? CS_INFO: CS_TYPES);
+    Dwarf_Error err = 0;
+    int res = 0;
+    int i = 0;
+
+    memset(&hs,0,sizeof(hs));
+    if (!cs->cs_data || next_cu_offset <= cu_offset ||
+        next_cu_offset > cs->cs_size) {
+        return DW_DLV_NO_ENTRY;
+    }
+    if (dwarf_get_version_of_die(cu_die,&hs.hs_version,
+        &hs.hs_offset_size) != DW_DLV_OK) {
+        return DW_DLV_NO_ENTRY;
+    }
+    res = dwarf_get_die_address_size(cu_die,&hs.hs_address_size,&err);
+    if (res == DW_DLV_ERROR) {
+        dwarf_dealloc(dbg,err,DW_DLA_ERROR);
+    }
+    if (res != DW_DLV_OK) {
+        return DW_DLV_NO_ENTRY;
+    }
+    hs.hs_hash = hash_value(object_hash,is_info);
+    hs.hs_hash = hash_value(hs.hs_hash,cu_offset);
+    hs.hs_hash = hash_bytes(hs.hs_hash,cs->cs_data + cu_offset,
+        next_cu_offset - cu_offset);
+    hs.hs_hash = hash_section_part(hs.hs_hash,CS_ABBREV,abbrev_offset,
+        abbrev_table_end,0);
+    res = hash_dies(&hs,cu_die,is_info,TRUE);
+    if (res != DW_DLV_OK) {
+        return DW_DLV_NO_ENTRY;
+    }
+    for (i = 0; i < CS_COUNT; ++i) {
+        if (hs.hs_whole[i]) {
+            hs.hs_hash = hash_whole_section(hs.hs_hash,
+                (enum cache_section_e)i);
+        }
+    }
+    *hash_out = hs.hs_hash;
+    return DW_DLV_OK;
+}
+
+/*  The options and the section table (the address
+    checks use the .text bounds and the linkonce
+    sections) go into every hash. */
+static Dwarf_Unsigned
+hash_object(Dwarf_Debug dbg)
+{
+    Dwarf_Unsigned h = options_hash;
+    int count = dwarf_get_section_count(dbg);
+    int i = 0;
+
+    h = hash_value(h,CU_CACHE_VERSION);
+    h = hash_value(h,cache_big_endian);
+    for (i = 0; i < count; ++i) {
+        const char *name = 0;
+        Dwarf_Addr addr = 0;
+        Dwarf_Unsigned size = 0;
+        Dwarf_Error err = 0;
+        int res = dwarf_get_section_info_by_index(dbg,i,&name,
+            &addr,&size,&err);
+
+        if (res == DW_DLV_ERROR) {
+            dwarf_dealloc(dbg,err,DW_DLA_ERROR);
+        }
+        if (res != DW_DLV_OK) {
+            continue;
+        }
+        h = hash_string(h,name? name: "");
+        h = hash_value(h,addr);
+        h = hash_value(h,size);
+    }
+    return h;
+}
+
+/*  Catches both a change to what is saved and a
+    dwarfdump built differently. */
+static unsigned
+record_sizes(void)
+{
+    return (unsigned)(sizeof(struct cu_worker_boundary_s) +
+        sizeof(struct cu_worker_tail_s)*3 +
+        sizeof(struct cu_cache_checks_s)*5);
+}
+
+static int
+compare_entries(const void *l,const void *r)
+{
+    const struct cache_entry_s *a = (const struct cache_entry_s *)l;
+    const struct cache_entry_s *b = (const struct cache_entry_s *)r;
+
+    if (a->ce_is_info != b->ce_is_info) {
+        return a->ce_is_info < b->ce_is_info? -1: 1;
+    }
+    if (a->ce_cu_offset != b->ce_cu_offset) {
+        return a->ce_cu_offset < b->ce_cu_offset? -1: 1;
+    }
+    return 0;
+}
+
+/*  Reads the record keys of the previous run's file.
+    A file for another object, options or dwarfdump, or
+    one that was not completed, is not used. */
+static void
+load_old_file(void)
+{
+    struct cache_header_s hdr;
+    Dwarf_Unsigned allocated = 0;
+    unsigned trailer = 0;
+
+    old_file = fopen(cu_cache_path,"rb");
+    if (!old_file) {
+        return;
+    }
+    memset(&hdr,0,sizeof(hdr));
+    if (cu_worker_read(old_file,&hdr,sizeof(hdr)) ||
+        hdr.ch_magic != CU_CACHE_MAGIC ||
+        hdr.ch_version != CU_CACHE_VERSION ||
+        hdr.ch_sizes != record_sizes() ||
+        hdr.ch_object_hash != object_hash) {
+        fclose(old_file);
+        old_file = 0;
+        return;
+    }
+    for (;;) {
+        struct cache_entry_s e;
+        struct cache_key_s key;
+
+        e.ce_record = ftell(old_file);
+        if (cu_worker_read(old_file,&trailer,sizeof(trailer))) {
+            break;
+        }
+        if (trailer == CU_CACHE_TRAILER) {
+            break;
+        }
+        trailer = 0;
+        if (fseek(old_file,e.ce_record,SEEK_SET) ||
+            cu_worker_read(old_file,&e.ce_length,sizeof(e.ce_length)) ||
+            e.ce_length < sizeof(key) ||
+            e.ce_length > LONG_MAX ||
+            cu_worker_read(old_file,&key,sizeof(key)) ||
+            fseek(old_file,(long)(e.ce_length - sizeof(key)),SEEK_CUR)) {
+            break;
+        }
+        e.ce_is_info = key.ck_is_info;
+        e.ce_cu_offset = key.ck_cu_offset;
+        e.ce_hash = key.ck_hash;
+        if (old_count == allocated) {
+            struct cache_entry_s *n = 0;
+
+            allocated = allocated? allocated*2: 256;
+            n = (struct cache_entry_s *)realloc(old_entries,
+                allocated*sizeof(struct cache_entry_s));
+            if (!n) {
+                break;
+            }
+            old_entries = n;
+        }
+        old_entries[old_count++] = e;
+    }
+    if (trailer != CU_CACHE_TRAILER) {
+        old_count = 0;
+    }
+    if (!old_count) {
+        fclose(old_file);
+        old_file = 0;
+        return;
+    }
+    qsort(old_entries,old_count,sizeof(struct cache_entry_s),
+        compare_entries);
+}
+
+static struct cache_entry_s *
+find_old_entry(Dwarf_Bool is_info,Dwarf_Off cu_offset)
+{
+    struct cache_entry_s key;
+
+    if (!old_count) {
+        return 0;
+    }
+    key.ce_is_info = is_info? 1: 0;
+    key.ce_cu_offset = cu_offset;
+    return (struct cache_entry_s *)bsearch(&key,old_entries,
+        old_count,sizeof(struct cache_entry_s),compare_entries);
+}
+
+/*  A failure writing the new file just means no new file. */
+static void
+drop_new_file(void)
+{
+    if (new_file) {
+        fclose(new_file);
+        new_file = 0;
+        remove(new_path);
+    }
+}
+
+static void
+restore_real_output(void)
+{
+    fflush(stdout);
+    fflush(stderr);
+    dup2(real_stdout,fileno(stdout));
+    dup2(real_stderr,fileno(stderr));
+}
+
+/*  The capture files are written through the dup2()ed
+    stdout and stderr descriptors, so they are only ever
+    accessed by descriptor: the FILE's own idea of its
+    position and contents would be stale. */
+static int
+reset_capture(FILE *f)
+{
+    if (ftruncate(fileno(f),0) || lseek(fileno(f),0,SEEK_SET)) {
+        return DW_DLV_ERROR;
+    }
+    return DW_DLV_OK;
+}
+
+static Dwarf_Unsigned
+captured_length(FILE *f)
+{
+    off_t end = lseek(fileno(f),0,SEEK_END);
+
+    return end < 0? 0: (Dwarf_Unsigned)end;
+}
+
+/*  Copies the len bytes captured in from to each of to
+    and also (either may be NULL). */
+static int
+copy_captured(FILE *from,Dwarf_Unsigned len,FILE *to,FILE *also)
+{
+    char buf[8192];
+    int fd = fileno(from);
+
+    if (lseek(fd,0,SEEK_SET)) {
+        return DW_DLV_ERROR;
+    }
+    while (len) {
+        size_t n = len > sizeof(buf)? sizeof(buf): (size_t)len;
+        ssize_t got = read(fd,buf,n);
+
+        if (got <= 0) {
+            return DW_DLV_ERROR;
+        }
+        if (to) {
+            fwrite(buf,1,got,to);
+        }
+        if (also) {
+            fwrite(buf,1,got,also);
+        }
+        len -= got;
+    }
+    return DW_DLV_OK;
+}
+
+/*  Copies len bytes from from to each of to and also
+    (either may be NULL). */
+static int
+copy_bytes(FILE *from,Dwarf_Unsigned len,FILE *to,FILE *also)
+{
+    char buf[8192];
+
+    while (len) {
+        size_t n = len > sizeof(buf)? sizeof(buf): (size_t)len;
+
+        if (fread(buf,1,n,from) != n) {
+            return DW_DLV_ERROR;
+        }
+        if (to) {
+            fwrite(buf,1,n,to);
+        }
+        if (also) {
+            fwrite(buf,1,n,also);
+        }
+        len -= n;
+    }
+    return DW_DLV_OK;
+}
+
+static void
+cache_atexit(void)
+{
+    if (recording) {
+        /*  dwarfdump is giving up part way through a CU:
+            let what the CU printed through. */
+        Dwarf_Unsigned len = 0;
+
+        recording = FALSE;
+        restore_real_output();
+        len = captured_length(rec_out);
+        copy_captured(rec_out,len,stdout,0);
+        len = captured_length(rec_err);
+        copy_captured(rec_err,len,stderr,0);
+        fflush(stdout);
+        fflush(stderr);
+    }
+    drop_new_file();
+}
+
+void
+cu_cache_open(Dwarf_Debug dbg,Elf *elf)
+{
+    struct cache_header_s hdr;
+    char *ident = 0;
+    size_t identlen = 0;
+    int i = 0;
+
+    if (!cu_cache_path) {
+        return;
+    }
+    if (!cu_cache_options_usable()) {
+        cu_cache_ignored("with -S, -P, -u, -H or -x format=");
+        return;
+    }
+    ident = elf_getident(elf,&identlen);
+    if (!ident || identlen <= EI_DATA) {
+        cu_cache_ignored("for an object that is not ELF");
+        return;
+    }
+    if (!rec_out) {
+        rec_out = tmpfile();
+        rec_err = tmpfile();
+        rec_harmless = tmpfile();
+        fflush(stdout);
+        fflush(stderr);
+        real_stdout = dup(fileno(stdout));
+        real_stderr = dup(fileno(stderr));
+    }
+    if (!rec_out || !rec_err || !rec_harmless ||
+        real_stdout < 0 || real_stderr < 0) {
+        cu_cache_ignored("as its temporary files cannot be created");
+        return;
+    }
+    if (!atexit_done) {
+        atexit(cache_atexit);
+        atexit_done = TRUE;
+    }
+    cache_dbg = dbg;
+    cache_big_endian = (ident[EI_DATA] == ELFDATA2MSB);
+    memset(cache_sections,0,sizeof(cache_sections));
+    for (i = 0; i < CS_COUNT; ++i) {
+        cache_sections[i].cs_name = cache_section_names[i];
+    }
+    object_hash = hash_object(dbg);
+    load_old_file();
+
+    new_path = (char *)malloc(strlen(cu_cache_path) + 5);
+    if (new_path) {
+        strcpy(new_path,cu_cache_path);
+        strcat(new_path,".new");
+        new_file = fopen(new_path,"wb");
+    }
+    memset(&hdr,0,sizeof(hdr));
+    hdr.ch_magic = CU_CACHE_MAGIC;
+    hdr.ch_version = CU_CACHE_VERSION;
+    hdr.ch_sizes = record_sizes();
+    hdr.ch_object_hash = object_hash;
+    if (new_file && cu_worker_write(new_file,&hdr,sizeof(hdr))) {
+        drop_new_file();
+    }
+    cache_is_active = TRUE;
+}
+
+boolean
+cu_cache_active(void)
+{
+    return cache_is_active;
+}
+
+void
+cu_cache_close(void)
+{
+    if (!cache_is_active) {
+        return;
+    }
+    if (new_file) {
+        unsigned trailer = CU_CACHE_TRAILER;
+
+        if (cu_worker_write(new_file,&trailer,sizeof(trailer)) ||
+            fflush(new_file) || ferror(new_file)) {
+            drop_new_file();
+        } else {
+            fclose(new_file);
+            new_file = 0;
+            if (rename(new_path,cu_cache_path)) {
+                remove(new_path);
+            }
+        }
+    }
+    free(new_path);
+    new_path = 0;
+    if (old_file) {
+        fclose(old_file);
+        old_file = 0;
+    }
+    free(old_entries);
+    old_entries = 0;
+    old_count = 0;
+    cache_dbg = 0;
+    cache_is_active = FALSE;
+}
+
+/*  Prints a CU from the previous run's file and copies
+    its record to the new one.  FALSE, having done
+    nothing, if the CU started from a different state. */
+static boolean
+replay_cu(Dwarf_Debug dbg,struct cache_entry_s *e,
+    struct cu_worker_boundary_s *inbound)
+{
+    struct cache_key_s key;
+    struct cu_worker_boundary_s saved_inbound;
+    struct cu_worker_tail_s tail;
+    struct cu_cache_checks_s checks;
+    Dwarf_Unsigned len = 0;
+    int res = 0;
+
+    if (fseek(old_file,e->ce_record + (long)sizeof(e->ce_length),
+            SEEK_SET) ||
+        cu_worker_read(old_file,&key,sizeof(key)) ||
+        cu_worker_read(old_file,&saved_inbound,sizeof(saved_inbound)) ||
+        !cu_worker_same_boundary(inbound,&saved_inbound) ||
+        cu_worker_read(old_file,&tail,sizeof(tail)) ||
+        cu_worker_read(old_file,&checks,sizeof(checks))) {
+        return FALSE;
+    }
+    /*  Checked before anything is applied. */
+    res = cu_cache_replay_unique_errors(old_file);
+    if (res == DW_DLV_NO_ENTRY) {
+        return FALSE;
+    }
+    cu_cache_add_compiler_checks(&checks);
+    if (res == DW_DLV_ERROR ||
+        cu_worker_merge_die_checks(old_file) ||
+        cu_worker_merge_usage_counts(old_file) ||
+        cu_worker_merge_harmless(dbg,old_file) ||
+        cu_worker_read(old_file,&len,sizeof(len)) ||
+        (fflush(stdout),copy_bytes(old_file,len,stdout,0)) ||
+        cu_worker_read(old_file,&len,sizeof(len)) ||
+        (fflush(stderr),copy_bytes(old_file,len,stderr,0))) {
+        /*  Part applied already. */
+        fprintf(stderr,"%s ERROR:  cannot read the -x cache file %s\n",
+            program_name,cu_cache_path);
+        exit(FAILED);
+    }
+    cu_worker_set_tail(&tail);
+    if (new_file) {
+        if (fseek(old_file,e->ce_record,SEEK_SET) ||
+            copy_bytes(old_file,e->ce_length + sizeof(e->ce_length),
+                new_file,0)) {
+            drop_new_file();
+        }
+    }
+    return TRUE;
+}
+
+/*  Sets libdwarf's harmless errors so far aside (fetching
+    them empties the list), so those a CU adds can be told
+    apart, and gives them back. */
+static int
+save_harmless(Dwarf_Debug dbg)
+{
+    rewind(rec_harmless);
+    if (cu_worker_write_harmless(dbg,rec_harmless) ||
+        fflush(rec_harmless)) {
+        return DW_DLV_ERROR;
+    }
+    harmless_saved_end = ftell(rec_harmless);
+    return DW_DLV_OK;
+}
+
+static void
+restore_harmless(Dwarf_Debug dbg)
+{
+    rewind(rec_harmless);
+    cu_worker_merge_harmless(dbg,rec_harmless);
+}
+
+boolean
+cu_cache_begin_cu(Dwarf_Debug dbg,Dwarf_Bool is_info,
+    Dwarf_Die cu_die,Dwarf_Off cu_offset,
+    Dwarf_Off next_cu_offset,Dwarf_Unsigned abbrev_offset)
+{
+    struct cache_entry_s *e = 0;
+    Dwarf_Unsigned hash = 0;
+    int res = 0;
+
+    if (!cache_is_active) {
+        return FALSE;
+    }
+    if (save_harmless(dbg)) {
+        restore_harmless(dbg);
+        return FALSE;
+    }
+    res = hash_cu(dbg,is_info,cu_die,cu_offset,next_cu_offset,
+        abbrev_offset,&hash);
+    /*  The hashing must not show: drop any it caused. */
+    dwarf_get_harmless_error_list(dbg,0,NULL,NULL);
+    restore_harmless(dbg);
+    if (res != DW_DLV_OK) {
+        return FALSE;
+    }
+    cu_worker_get_die_state(&rec_inbound);
+    e = find_old_entry(is_info,cu_offset);
+    if (e && e->ce_hash == hash && replay_cu(dbg,e,&rec_inbound)) {
+        return TRUE;
+    }
+    if (!new_file || save_harmless(dbg)) {
+        restore_harmless(dbg);
+        return FALSE;
+    }
+
+    /*  Print the CU into the record files. */
+    rec_key.ck_is_info = is_info? 1: 0;
+    rec_key.ck_cu_offset = cu_offset;
+    rec_key.ck_hash = hash;
+    cu_cache_get_compiler_checks(&rec_before);
+    cu_cache_begin_unique_errors();
+    cu_cache_begin_die_checks();
+    fflush(stdout);
+    fflush(stderr);
+    if (reset_capture(rec_out) || reset_capture(rec_err)) {
+        /*  Nothing redirected yet. */
+        cu_cache_end_unique_errors(NULL);
+        cu_cache_end_die_checks(NULL);
+        restore_harmless(dbg);
+        return FALSE;
+    }
+    dup2(fileno(rec_out),fileno(stdout));
+    dup2(fileno(rec_err),fileno(stderr));
+    recording = TRUE;
+    return FALSE;
+}
+
+/*  Leaves in after what was added since before. */
+static void
+checks_delta(struct cu_cache_checks_s *after,
+    struct cu_cache_checks_s *before)
+{
+    int i = 0;
+
+    after->cc_check_error -= before->cc_check_error;
+    after->cc_verified = after->cc_verified && !before->cc_verified;
+    for (i = 0; i < LAST_CATEGORY; ++i) {
+        after->cc_total[i].checks -= before->cc_total[i].checks;
+        after->cc_total[i].errors -= before->cc_total[i].errors;
+        after->cc_compiler[i].checks -= before->cc_compiler[i].checks;
+        after->cc_compiler[i].errors -= before->cc_compiler[i].errors;
+    }
+}
+
+void
+cu_cache_end_cu(Dwarf_Debug dbg)
+{
+    struct cu_worker_tail_s tail;
+    struct cu_cache_checks_s delta;
+    Dwarf_Unsigned length = 0;
+    Dwarf_Unsigned outlen = 0;
+    Dwarf_Unsigned errlen = 0;
+    long record = 0;
+    long harmless_end = 0;
+    int res = DW_DLV_OK;
+
+    if (!recording) {
+        return;
+    }
+    recording = FALSE;
+    restore_real_output();
+    outlen = captured_length(rec_out);
+    errlen = captured_length(rec_err);
+
+    cu_worker_get_tail(&tail);
+    cu_cache_get_compiler_checks(&delta);
+    checks_delta(&delta,&rec_before);
+    record = ftell(new_file);
+    if (cu_worker_write(new_file,&length,sizeof(length)) ||
+        cu_worker_write(new_file,&rec_key,sizeof(rec_key)) ||
+        cu_worker_write(new_file,&rec_inbound,sizeof(rec_inbound)) ||
+        cu_worker_write(new_file,&tail,sizeof(tail)) ||
+        cu_worker_write(new_file,&delta,sizeof(delta))) {
+        res = DW_DLV_ERROR;
+    }
+    if (cu_cache_end_unique_errors(new_file)) {
+        res = DW_DLV_ERROR;
+    }
+    /*  Adds the CU's counts back in whatever happens. */
+    if (cu_cache_end_die_checks(new_file)) {
+        res = DW_DLV_ERROR;
+    }
+
+    /*  The CU's harmless errors go after the earlier ones;
+        then all are given back to libdwarf in order. */
+    if (fseek(rec_harmless,harmless_saved_end,SEEK_SET) ||
+        cu_worker_write_harmless(dbg,rec_harmless) ||
+        fflush(rec_harmless)) {
+        res = DW_DLV_ERROR;
+    }
+    harmless_end = ftell(rec_harmless);
+    restore_harmless(dbg);
+    cu_worker_merge_harmless(dbg,rec_harmless);
+    if (fseek(rec_harmless,harmless_saved_end,SEEK_SET) ||
+        copy_bytes(rec_harmless,harmless_end - harmless_saved_end,
+            new_file,0)) {
+        res = DW_DLV_ERROR;
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    if (cu_worker_write(new_file,&outlen,sizeof(outlen)) ||
+        copy_captured(rec_out,outlen,new_file,stdout) ||
+        cu_worker_write(new_file,&errlen,sizeof(errlen)) ||
+        copy_captured(rec_err,errlen,new_file,stderr)) {
+        res = DW_DLV_ERROR;
+    }
+    fflush(stdout);
+    fflush(stderr);
+    if (res == DW_DLV_OK) {
+        long end = ftell(new_file);
+
+        length = end - record - sizeof(length);
+        if (fseek(new_file,record,SEEK_SET) ||
+            cu_worker_write(new_file,&length,sizeof(length)) ||
+            fseek(new_file,end,SEEK_SET)) {
+            res = DW_DLV_ERROR;
+        }
+    }
+    if (res != DW_DLV_OK) {
+        drop_new_file();
+    }
+}
+#else /* !HAVE_CU_WORKERS */
+void
+cu_cache_set_options(UNUSEDARG int optcount,UNUSEDARG char **argv)
+{
+}
+
+void
+cu_cache_open(UNUSEDARG Dwarf_Debug dbg,UNUSEDARG Elf *elf)
+{
+    if (cu_cache_path) {
+        cu_cache_ignored("on this system");
+    }
+}
+
+void
+cu_cache_close(void)
+{
+}
+
+boolean
+cu_cache_active(void)
+{
+    return FALSE;
+}
+
+boolean
+cu_cache_begin_cu(UNUSEDARG Dwarf_Debug dbg,
+    UNUSEDARG Dwarf_Bool is_info,
+    UNUSEDARG Dwarf_Die cu_die,
+    UNUSEDARG Dwarf_Off cu_offset,
+    UNUSEDARG Dwarf_Off next_cu_offset,
+    UNUSEDARG Dwarf_Unsigned abbrev_offset)
+{
+    return FALSE;
+}
+
+void
+cu_cache_end_cu(UNUSEDARG Dwarf_Debug dbg)
+{
+}
+#endif /* HAVE_CU_WORKERS */
+
+/*  Says, once, why the cache is not used. */
+void
+cu_cache_ignored(const char *why)
+{
+    static boolean warned = FALSE;
+
+    if (warned) {
+        return;
+    }
+    warned = TRUE;
+    fflush(stdout);
+    fprintf(stderr,"%s WARNING:  -x cache= ignored %s\n",
+        program_name,why);
+}
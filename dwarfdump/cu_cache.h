@@ -0,0 +1,95 @@
+/*
+  Copyright 2018 David Anderson. All rights reserved.
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of version 2 of the GNU General Public License as
+  published by the Free Software Foundation.
+
+  This program is distributed in the hope that it would be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  Further, this software is distributed without any warranty that it is
+  free of the rightful claim of any third person regarding infringement
+  or the like.  Any license provided herein, whether implied or
+  otherwise, applies only to this software file.  Patent licenses, if
+  any, provided herein do not apply to combinations of this program with
+  other software, or any other product whatsoever.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write the Free Software Foundation, Inc., 51
+  Franklin Street - Fifth Floor, Boston MA 02110-1301, USA.
+*/
+#ifndef CU_CACHE_H
+#define CU_CACHE_H
+
+/*  -x cache=<path> keeps what printing (and checking) each
+    CU of .debug_info and .debug_types produced: its output,
+    its -k counts and the state it left for the next CU.
+    A later run replays a CU from the file instead of
+    printing it again when the CU hashes the same.  New 2018.
+
+    The hash covers the CU bytes and where the CU is, its
+    abbreviations, its line table program, the strings its
+    attributes reach and its .debug_ranges, .debug_loc,
+    .debug_rnglists and .debug_loclists lists.  DWARF5
+    sections reached through an index (.debug_addr,
+    .debug_str_offsets and lists by DW_FORM_*listx) and
+    .debug_line_str are hashed whole.  The file is
+    dropped altogether if the options or the object's
+    section table (which the address checks use) differ.
+
+    A CU is printed normally, and not saved, if it refers
+    outside itself (DW_FORM_ref_addr, DW_FORM_ref_sig8 and
+    the like) or has macro data, or if the state the
+    previous CU left (including, with -kG, which of the
+    CU's errors were already seen) is not what it was when
+    the CU was saved.  The cache is not used, with a
+    warning, for archives, with a tied file, or with the
+    options cu_cache_options_usable() refuses.
+
+    Results are the same as without the option. */
+
+/*  What printing one CU added to the -k counts. */
+struct cu_cache_checks_s {
+    int     cc_check_error;
+    boolean cc_verified;
+    Dwarf_Check_Result cc_total[LAST_CATEGORY];
+    Dwarf_Check_Result cc_compiler[LAST_CATEGORY];
+};
+
+/*  In dwarfdump.c. */
+void cu_cache_get_compiler_checks(struct cu_cache_checks_s *c);
+void cu_cache_add_compiler_checks(struct cu_cache_checks_s *c);
+/*  The -kG table: what the CU being saved did to it. */
+void cu_cache_begin_unique_errors(void);
+int  cu_cache_end_unique_errors(FILE *f);
+int  cu_cache_replay_unique_errors(FILE *f);
+
+/*  In print_die.c. While a CU is saved the attribute
+    encoding counts (-kE) go to a table of their own
+    and the -ku counts from before it are set aside. */
+void cu_cache_begin_die_checks(void);
+int  cu_cache_end_die_checks(FILE *f);
+
+/*  In cu_cache.c */
+/*  Called once options are parsed: argv[1] to
+    argv[optcount-1] are the options. */
+void cu_cache_set_options(int optcount,char **argv);
+/*  Around printing .debug_info and .debug_types
+    of one object. */
+void cu_cache_open(Dwarf_Debug dbg,Elf *elf);
+void cu_cache_close(void);
+boolean cu_cache_active(void);
+void cu_cache_ignored(const char *why);
+
+/*  Called by print_die_section_cus() for each CU to be
+    printed.  Returns TRUE if the CU was replayed from the
+    cache; otherwise the CU is printed as usual and
+    cu_cache_end_cu() called after it. */
+boolean cu_cache_begin_cu(Dwarf_Debug dbg,Dwarf_Bool is_info,
+    Dwarf_Die cu_die,Dwarf_Off cu_offset,
+    Dwarf_Off next_cu_offset,Dwarf_Unsigned abbrev_offset);
+void cu_cache_end_cu(Dwarf_Debug dbg);
+
+#endif /* CU_CACHE_H */
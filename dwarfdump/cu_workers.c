@@ -0,0 +1,1138 @@
+/*
+  Copyright 2018 David Anderson. All rights reserved.
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of version 2 of the GNU General Public License as
+  published by the Free Software Foundation.
+
+  This program is distributed in the hope that it would be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  Further, this software is distributed without any warranty that it is
+  free of the rightful claim of any third person regarding infringement
+  or the like.  Any license provided herein, whether implied or
+  otherwise, applies only to this software file.  Patent licenses, if
+  any, provided herein do not apply to combinations of this program with
+  other software, or any other product whatsoever.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write the Free Software Foundation, Inc., 51
+  Franklin Street - Fifth Floor, Boston MA 02110-1301, USA.
+*/
+
+/*  Print .debug_info and .debug_types with -x workers=<n>.
+    See cu_workers.h for the outline.
+
+    dwarfdump keeps its state in globals, so the workers
+    are processes, not threads.  Each worker writes its
+    part of the output to one temporary file and its
+    -k counts (and the state the next CU would see)
+    to another. */
+
+#include "globals.h"
+#include <limits.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include "tag_common.h"
+#include "cu_workers.h"
+#include "cu_cache.h"
+#ifdef HAVE_CU_WORKERS
+#include <sys/stat.h>
+#include <sys/wait.h>
+#endif
+
+/*  Ends every complete results file. */
+#define CU_WORKER_TRAILER 0x43555752
+
+/*  libdwarf keeps the latest 50 harmless errors
+    (see dwarf_set_harmless_error_list_size() in dbgsetup()). */
+#define CU_WORKER_HARMLESS_MAX 50
+
+int
+cu_worker_write(FILE *f,const void *data,size_t len)
+{
+    if (len && fwrite(data,1,len,f) != len) {
+        return DW_DLV_ERROR;
+    }
+    return DW_DLV_OK;
+}
+
+int
+cu_worker_read(FILE *f,void *data,size_t len)
+{
+    if (len && fread(data,1,len,f) != len) {
+        return DW_DLV_ERROR;
+    }
+    return DW_DLV_OK;
+}
+
+/*  Options whose state spans every CU (rather than just
+    the previous one) or which stop early are not worth
+    splitting up; those runs stay serial.  -x cache= has
+    the same limits but for -kG: a saved CU keeps the
+    errors it saw (see cu_cache_begin_unique_errors()). */
+boolean
+cu_worker_options_usable(void)
+{
+    if (glflags.gf_print_unique_errors) {
+        return FALSE;
+    }
+    return cu_cache_options_usable();
+}
+
+boolean
+cu_cache_options_usable(void)
+{
+    if (glflags.gf_search_is_on ||
+        glflags.gf_producer_children_flag ||
+        glflags.gf_cu_name_flag ||
+        glflags.gf_record_format ||
+        break_after_n_units != INT_MAX) {
+        return FALSE;
+    }
+    return TRUE;
+}
+
+boolean
+cu_workers_usable(void)
+{
+#ifdef HAVE_CU_WORKERS
+    if (glflags.gf_cu_workers < 2) {
+        return FALSE;
+    }
+    /*  A CU replayed from -x cache= has no DIEs to print. */
+    if (cu_cache_active()) {
+        return FALSE;
+    }
+    return cu_worker_options_usable();
+#else  /* !HAVE_CU_WORKERS */
+    return FALSE;
+#endif /* HAVE_CU_WORKERS */
+}
+
+boolean
+cu_worker_same_boundary(struct cu_worker_boundary_s *a,
+    struct cu_worker_boundary_s *b)
+{
+    if (a->cb_record_dwarf_error != b->cb_record_dwarf_error ||
+        a->cb_seen_PU != b->cb_seen_PU ||
+        a->cb_seen_PU_base_address != b->cb_seen_PU_base_address ||
+        a->cb_seen_PU_high_address != b->cb_seen_PU_high_address ||
+        a->cb_need_PU_valid_code != b->cb_need_PU_valid_code ||
+        a->cb_PU_base_address != b->cb_PU_base_address ||
+        a->cb_PU_high_address != b->cb_PU_high_address ||
+        strcmp(a->cb_PU_name,b->cb_PU_name) ||
+        a->cb_in_valid_code != b->cb_in_valid_code ||
+        a->cb_local_symbols_already_began !=
+            b->cb_local_symbols_already_began ||
+        a->cb_suppress_checking_on_dwp !=
+            b->cb_suppress_checking_on_dwp ||
+        a->cb_check_ranges != b->cb_check_ranges ||
+        a->cb_check_aranges != b->cb_check_aranges ||
+        a->cb_check_decl_file != b->cb_check_decl_file ||
+        a->cb_check_lines != b->cb_check_lines ||
+        a->cb_check_pubname_attr != b->cb_check_pubname_attr ||
+        a->cb_check_fdes != b->cb_check_fdes) {
+        return FALSE;
+    }
+    return TRUE;
+}
+
+void
+cu_worker_get_tail(struct cu_worker_tail_s *t)
+{
+    memset(t,0,sizeof(*t));
+    cu_worker_get_die_state(&t->ct_boundary);
+    t->ct_seen_CU = seen_CU;
+    t->ct_need_CU_name = need_CU_name;
+    t->ct_need_CU_base_address = need_CU_base_address;
+    t->ct_need_CU_high_address = need_CU_high_address;
+    t->ct_CU_base_address = CU_base_address;
+    t->ct_CU_low_address = CU_low_address;
+    t->ct_CU_high_address = CU_high_address;
+    t->ct_DIE_offset = DIE_offset;
+    t->ct_DIE_overall_offset = DIE_overall_offset;
+    t->ct_DIE_CU_offset = DIE_CU_offset;
+    t->ct_DIE_CU_overall_offset = DIE_CU_overall_offset;
+    safe_strcpy(t->ct_CU_name,sizeof(t->ct_CU_name),
+        CU_name,strlen(CU_name));
+    safe_strcpy(t->ct_CU_producer,sizeof(t->ct_CU_producer),
+        CU_producer,strlen(CU_producer));
+}
+
+void
+cu_worker_set_tail(struct cu_worker_tail_s *t)
+{
+    cu_worker_set_die_state(&t->ct_boundary);
+    seen_CU = t->ct_seen_CU;
+    need_CU_name = t->ct_need_CU_name;
+    need_CU_base_address = t->ct_need_CU_base_address;
+    need_CU_high_address = t->ct_need_CU_high_address;
+    CU_base_address = t->ct_CU_base_address;
+    CU_low_address = t->ct_CU_low_address;
+    CU_high_address = t->ct_CU_high_address;
+    DIE_offset = t->ct_DIE_offset;
+    DIE_overall_offset = t->ct_DIE_overall_offset;
+    DIE_CU_offset = t->ct_DIE_CU_offset;
+    DIE_CU_overall_offset = t->ct_DIE_CU_overall_offset;
+    safe_strcpy(CU_name,sizeof(CU_name),
+        t->ct_CU_name,strlen(t->ct_CU_name));
+    safe_strcpy(CU_producer,sizeof(CU_producer),
+        t->ct_CU_producer,strlen(t->ct_CU_producer));
+}
+
+int
+cu_worker_write_harmless(Dwarf_Debug dbg,FILE *f)
+{
+    const char *list[CU_WORKER_HARMLESS_MAX+1];
+    unsigned total = 0;
+    unsigned count = 0;
+    int res = 0;
+
+    res = dwarf_get_harmless_error_list(dbg,CU_WORKER_HARMLESS_MAX+1,
+        list,&total);
+    if (res == DW_DLV_NO_ENTRY) {
+        total = 0;
+        list[0] = 0;
+    }
+    while (list[count]) {
+        ++count;
+    }
+    if (cu_worker_write(f,&total,sizeof(total)) ||
+        cu_worker_write(f,&count,sizeof(count))) {
+        return DW_DLV_ERROR;
+    }
+    for (count = 0; list[count]; ++count) {
+        unsigned len = strlen(list[count]);
+
+        if (cu_worker_write(f,&len,sizeof(len)) ||
+            cu_worker_write(f,list[count],len)) {
+            return DW_DLV_ERROR;
+        }
+    }
+    return DW_DLV_OK;
+}
+
+/*  Re-inserting each worker's list in CU order leaves
+    libdwarf holding the same latest errors a serial run
+    would; the ones it no longer has are only counted. */
+int
+cu_worker_merge_harmless(Dwarf_Debug dbg,FILE *f)
+{
+    unsigned total = 0;
+    unsigned count = 0;
+    unsigned i = 0;
+
+    if (cu_worker_read(f,&total,sizeof(total)) ||
+        cu_worker_read(f,&count,sizeof(count)) ||
+        count > total) {
+        return DW_DLV_ERROR;
+    }
+    for (i = 0; i < count; ++i) {
+        char msg[DW_HARMLESS_ERROR_MSG_STRING_SIZE];
+        unsigned len = 0;
+
+        if (cu_worker_read(f,&len,sizeof(len)) ||
+            len >= sizeof(msg) ||
+            cu_worker_read(f,msg,len)) {
+            return DW_DLV_ERROR;
+        }
+        msg[len] = 0;
+        dwarf_insert_harmless_error(dbg,msg);
+    }
+    cu_worker_add_uncollected_harmless(total - count);
+    return DW_DLV_OK;
+}
+
+#ifdef HAVE_CU_WORKERS
+/*  A worker starts from zero counts so the parent
+    can simply add them up. */
+static void
+reset_worker_checks(Dwarf_Debug dbg)
+{
+    cu_worker_reset_compiler_checks();
+    cu_worker_reset_die_checks();
+    cu_worker_reset_usage_counts();
+    /*  Fetching the harmless error list empties it. */
+    dwarf_get_harmless_error_list(dbg,0,NULL,NULL);
+}
+
+/*  Called by print_die_section_cus() as it reaches the
+    first CU of the range. */
+void
+cu_worker_begin_range(struct cu_worker_range_s *range)
+{
+    if (range->cw_replay >= 0) {
+        /*  The replayed CU was printed only for the
+            state it leaves; start over from here. */
+        fflush(stdout);
+        fflush(stderr);
+        dup2(fileno(range->cw_out),fileno(stdout));
+        dup2(fileno(range->cw_err),fileno(stderr));
+        reset_worker_checks(range->cw_dbg);
+    }
+    cu_worker_get_die_state(&range->cw_inbound);
+    range->cw_began = TRUE;
+}
+
+/*  The worker process. Never returns. */
+static void
+run_worker(Dwarf_Bool is_info,struct cu_worker_range_s *range,
+    FILE *resf)
+{
+    Dwarf_Error err = 0;
+    struct cu_worker_tail_s tail;
+    unsigned trailer = CU_WORKER_TRAILER;
+    int nres = 0;
+
+    if (range->cw_replay >= 0) {
+        int devnull = open("/dev/null",O_WRONLY);
+
+        if (devnull < 0) {
+            _exit(FAILED);
+        }
+        dup2(devnull,fileno(stdout));
+        dup2(devnull,fileno(stderr));
+        close(devnull);
+    } else {
+        dup2(fileno(range->cw_out),fileno(stdout));
+        dup2(fileno(range->cw_err),fileno(stderr));
+    }
+    reset_worker_checks(range->cw_dbg);
+    nres = print_die_section_cus(range->cw_dbg,is_info,range,&err);
+    fflush(stdout);
+    fflush(stderr);
+    if (nres != DW_DLV_NO_ENTRY) {
+        _exit(FAILED);
+    }
+    cu_worker_get_tail(&tail);
+    if (cu_worker_write(resf,&range->cw_began,sizeof(range->cw_began)) ||
+        cu_worker_write(resf,&range->cw_unmergeable,
+            sizeof(range->cw_unmergeable)) ||
+        cu_worker_write(resf,&range->cw_inbound,
+            sizeof(range->cw_inbound)) ||
+        cu_worker_write(resf,&tail,sizeof(tail)) ||
+        cu_worker_write_compiler_checks(resf) ||
+        cu_worker_write_die_checks(resf) ||
+        cu_worker_write_usage_counts(resf) ||
+        (glflags.gf_check_harmless &&
+            cu_worker_write_harmless(range->cw_dbg,resf)) ||
+        cu_worker_write(resf,&trailer,sizeof(trailer)) ||
+        fflush(resf)) {
+        _exit(FAILED);
+    }
+    _exit(0);
+}
+
+/*  Read the CU headers once, recording where each CU ends.
+    Workers fork()ed after this share the CU contexts. */
+static int
+find_cu_ends(Dwarf_Debug dbg,Dwarf_Bool is_info,
+    Dwarf_Unsigned **ends_out,int *count_out,
+    Dwarf_Error *pod_err)
+{
+    Dwarf_Unsigned *ends = 0;
+    int count = 0;
+    int size = 0;
+    int nres = DW_DLV_OK;
+
+    for (;;) {
+        Dwarf_Unsigned next_cu_offset = 0;
+        Dwarf_Half cu_type = 0;
+
+        nres = dwarf_next_cu_header_d(dbg,is_info,
+            NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,
+            &next_cu_offset,&cu_type,pod_err);
+        if (nres != DW_DLV_OK) {
+            break;
+        }
+        if (count == size) {
+            Dwarf_Unsigned *newends = 0;
+
+            size = size? size*2: 64;
+            newends = (Dwarf_Unsigned *)realloc(ends,
+                size*sizeof(Dwarf_Unsigned));
+            if (!newends) {
+                free(ends);
+                fprintf(stderr,"%s ERROR:  out of memory "
+                    "recording CU offsets\n",program_name);
+                exit(FAILED);
+            }
+            ends = newends;
+        }
+        ends[count++] = next_cu_offset;
+    }
+    *ends_out = ends;
+    *count_out = count;
+    return nres;
+}
+
+/*  ends[i] is where item i ends, in bytes from the start
+    of the first.  firsts[j] becomes the first item of
+    worker j, with the bytes shared out about evenly and
+    each worker given at least one item. */
+static void
+split_by_size(const Dwarf_Unsigned *ends,int count,int nworkers,
+    int *firsts)
+{
+    Dwarf_Unsigned total = ends[count-1];
+    int j = 0;
+
+    firsts[0] = 0;
+    for (j = 1; j < nworkers; ++j) {
+        Dwarf_Unsigned target = (total/nworkers)*j;
+        int first = firsts[j-1] + 1;
+
+        while (first < count && ends[first-1] < target) {
+            ++first;
+        }
+        if (first > count - (nworkers - j)) {
+            first = count - (nworkers - j);
+        }
+        firsts[j] = first;
+    }
+}
+
+static void
+copy_to(FILE *from,FILE *to)
+{
+    char buf[8192];
+    size_t len = 0;
+
+    fflush(to);
+    rewind(from);
+    while ((len = fread(buf,1,sizeof(buf),from)) > 0) {
+        fwrite(buf,1,len,to);
+    }
+    fflush(to);
+}
+
+/*  Returns FALSE if the section must be printed serially
+    instead, having printed nothing.  Otherwise *result is
+    what print_die_section_cus() would have returned. */
+boolean
+print_die_section_in_workers(Dwarf_Debug dbg,Dwarf_Bool is_info,
+    int *result,Dwarf_Error *pod_err)
+{
+    struct cu_worker_range_s ranges[CU_WORKERS_MAX];
+    FILE *resf[CU_WORKERS_MAX];
+    pid_t pids[CU_WORKERS_MAX];
+    struct cu_worker_tail_s tail;
+    struct cu_worker_tail_s prevtail;
+    Dwarf_Unsigned *ends = 0;
+    int firsts[CU_WORKERS_MAX];
+    long headersize = 0;
+    int count = 0;
+    int nworkers = 0;
+    int started = 0;
+    int hres = 0;
+    int j = 0;
+    boolean ok = TRUE;
+
+    hres = find_cu_ends(dbg,is_info,&ends,&count,pod_err);
+    if (hres == DW_DLV_ERROR) {
+        if (!count) {
+            /*  A serial run gets the same error at once. */
+            free(ends);
+            return FALSE;
+        }
+        /*  libdwarf will not read past the bad CU header
+            again, so no serial rerun is possible: print
+            the good CUs with one worker. */
+        nworkers = 1;
+    } else {
+        if (count < 2) {
+            free(ends);
+            return FALSE;
+        }
+        nworkers = glflags.gf_cu_workers;
+        if (nworkers > count) {
+            nworkers = count;
+        }
+    }
+
+    /*  Split by section bytes, each worker at least one CU. */
+    split_by_size(ends,count,nworkers,firsts);
+    memset(ranges,0,sizeof(ranges));
+    memset(resf,0,sizeof(resf));
+    for (j = 0; j < nworkers; ++j) {
+        struct cu_worker_range_s *r = &ranges[j];
+
+        r->cw_dbg = dbg;
+        r->cw_first = firsts[j];
+        r->cw_last = (j+1 < nworkers)? firsts[j+1]-1 : count-1;
+        r->cw_replay = r->cw_first - 1;
+    }
+    free(ends);
+
+    fflush(stdout);
+    fflush(stderr);
+    for (j = 0; j < nworkers; ++j) {
+        struct cu_worker_range_s *r = &ranges[j];
+
+        r->cw_out = tmpfile();
+        r->cw_err = tmpfile();
+        resf[j] = tmpfile();
+        if (!r->cw_out || !r->cw_err || !resf[j]) {
+            ok = FALSE;
+            break;
+        }
+        pids[j] = fork();
+        if (pids[j] < 0) {
+            ok = FALSE;
+            break;
+        }
+        if (pids[j] == 0) {
+            run_worker(is_info,r,resf[j]);
+        }
+        ++started;
+    }
+    for (j = 0; j < started; ++j) {
+        int status = 0;
+
+        if (waitpid(pids[j],&status,0) != pids[j] ||
+            !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            ok = FALSE;
+        }
+    }
+
+    /*  Check what each worker assumed against what the
+        previous one left. */
+    headersize = 2*sizeof(boolean) +
+        sizeof(struct cu_worker_boundary_s) +
+        sizeof(struct cu_worker_tail_s);
+    for (j = 0; ok && j < nworkers; ++j) {
+        boolean began = FALSE;
+        boolean unmergeable = FALSE;
+        struct cu_worker_boundary_s inbound;
+        unsigned trailer = 0;
+
+        if (fseek(resf[j],-(long)sizeof(trailer),SEEK_END) ||
+            cu_worker_read(resf[j],&trailer,sizeof(trailer)) ||
+            trailer != CU_WORKER_TRAILER) {
+            ok = FALSE;
+            break;
+        }
+        rewind(resf[j]);
+        if (cu_worker_read(resf[j],&began,sizeof(began)) ||
+            cu_worker_read(resf[j],&unmergeable,sizeof(unmergeable)) ||
+            cu_worker_read(resf[j],&inbound,sizeof(inbound)) ||
+            cu_worker_read(resf[j],&tail,sizeof(tail)) ||
+            !began || unmergeable) {
+            ok = FALSE;
+            break;
+        }
+        if (j > 0 &&
+            !cu_worker_same_boundary(&prevtail.ct_boundary,&inbound)) {
+            ok = FALSE;
+            break;
+        }
+        prevtail = tail;
+    }
+
+    for (j = 0; ok && j < nworkers; ++j) {
+        if (fseek(resf[j],headersize,SEEK_SET) ||
+            cu_worker_merge_compiler_checks(resf[j],
+                j == (nworkers-1)) ||
+            cu_worker_merge_die_checks(resf[j]) ||
+            cu_worker_merge_usage_counts(resf[j]) ||
+            (glflags.gf_check_harmless &&
+                cu_worker_merge_harmless(dbg,resf[j]))) {
+            /*  Part merged already: too late to go serial. */
+            fprintf(stderr,"%s ERROR:  cannot merge the results "
+                "of -x workers\n",program_name);
+            exit(FAILED);
+        }
+        copy_to(ranges[j].cw_out,stdout);
+        copy_to(ranges[j].cw_err,stderr);
+    }
+    if (ok) {
+        cu_worker_set_tail(&tail);
+    }
+    for (j = 0; j < nworkers; ++j) {
+        if (ranges[j].cw_out) {
+            fclose(ranges[j].cw_out);
+        }
+        if (ranges[j].cw_err) {
+            fclose(ranges[j].cw_err);
+        }
+        if (resf[j]) {
+            fclose(resf[j]);
+        }
+    }
+    if (!ok) {
+        return FALSE;
+    }
+    *result = hres;
+    return TRUE;
+}
+
+/*  Archive members.  */
+
+struct member_span_s {
+    long ms_start;
+    long ms_end;
+};
+
+struct member_worker_s {
+    /*  Member replayed with output discarded before
+        mw_first, or -1. */
+    int      mw_replay;
+    int      mw_first;
+    int      mw_last;
+    FILE    *mw_out;
+    /*  NULL when stderr is the same file as stdout,
+        in which case both go to mw_out. */
+    FILE    *mw_err;
+    FILE    *mw_res;
+    pid_t    mw_pid;
+    boolean  mw_began;
+    boolean  mw_unmergeable;
+    struct cu_worker_boundary_s mw_inbound;
+    /*  The print_checks_results() reports the parent
+        may drop, as offsets in mw_out. */
+    struct member_span_s *mw_spans;
+    unsigned mw_span_count;
+    unsigned mw_span_allocated;
+    /*  Where each member's -ku report belongs in mw_out.
+        The parent prints it there from the totals, having
+        added the counts that member left in mw_usage. */
+    long    *mw_usage_marks;
+    unsigned mw_usage_mark_count;
+    unsigned mw_usage_mark_allocated;
+    FILE    *mw_usage;
+};
+
+/*  Set only in a member worker. */
+static struct member_worker_s *current_member_worker = 0;
+
+static long
+stdout_offset(void)
+{
+    fflush(stdout);
+    fflush(stderr);
+    return (long)lseek(fileno(stdout),0,SEEK_CUR);
+}
+
+boolean
+member_worker_optional_begin(void)
+{
+    struct member_worker_s *w = current_member_worker;
+
+    if (!w || !w->mw_began) {
+        return FALSE;
+    }
+    if (w->mw_span_count == w->mw_span_allocated) {
+        unsigned newcount = w->mw_span_allocated?
+            w->mw_span_allocated*2: 16;
+        struct member_span_s *newspans = (struct member_span_s *)
+            realloc(w->mw_spans,newcount*sizeof(struct member_span_s));
+
+        if (!newspans) {
+            /*  The parent redoes the range. */
+            w->mw_unmergeable = TRUE;
+            return FALSE;
+        }
+        w->mw_spans = newspans;
+        w->mw_span_allocated = newcount;
+    }
+    w->mw_spans[w->mw_span_count].ms_start = stdout_offset();
+    return TRUE;
+}
+
+void
+member_worker_optional_end(void)
+{
+    struct member_worker_s *w = current_member_worker;
+
+    w->mw_spans[w->mw_span_count].ms_end = stdout_offset();
+    ++w->mw_span_count;
+}
+
+boolean
+member_worker_usage_report(void)
+{
+    struct member_worker_s *w = current_member_worker;
+
+    if (!w || !w->mw_began || w->mw_unmergeable) {
+        return FALSE;
+    }
+    if (w->mw_usage_mark_count == w->mw_usage_mark_allocated) {
+        unsigned newcount = w->mw_usage_mark_allocated?
+            w->mw_usage_mark_allocated*2: 16;
+        long *newmarks = (long *)realloc(w->mw_usage_marks,
+            newcount*sizeof(long));
+
+        if (!newmarks) {
+            w->mw_unmergeable = TRUE;
+            return FALSE;
+        }
+        w->mw_usage_marks = newmarks;
+        w->mw_usage_mark_allocated = newcount;
+    }
+    if (cu_worker_write_usage_counts(w->mw_usage)) {
+        w->mw_unmergeable = TRUE;
+        return FALSE;
+    }
+    cu_worker_reset_usage_counts();
+    w->mw_usage_marks[w->mw_usage_mark_count] = stdout_offset();
+    ++w->mw_usage_mark_count;
+    return TRUE;
+}
+
+static boolean
+stdout_is_stderr(void)
+{
+    struct stat outstat;
+    struct stat errstat;
+
+    if (fstat(fileno(stdout),&outstat) ||
+        fstat(fileno(stderr),&errstat)) {
+        return FALSE;
+    }
+    return outstat.st_dev == errstat.st_dev &&
+        outstat.st_ino == errstat.st_ino;
+}
+
+static void
+member_worker_output(struct member_worker_s *w)
+{
+    fflush(stdout);
+    fflush(stderr);
+    dup2(fileno(w->mw_out),fileno(stdout));
+    dup2(fileno(w->mw_err? w->mw_err: w->mw_out),fileno(stderr));
+}
+
+/*  The worker process. Never returns. */
+static void
+run_member_worker(int fd,Elf *arf,Elf *elftied,
+    const char *file_name,const char *tied_file_name,
+    struct member_worker_s *w)
+{
+    Elf_Cmd cmd = ELF_C_READ;
+    Elf *elf = 0;
+    struct cu_worker_tail_s tail;
+    unsigned trailer = CU_WORKER_TRAILER;
+    int start = w->mw_replay >= 0? w->mw_replay: w->mw_first;
+    int index = 0;
+
+    current_member_worker = w;
+    if (w->mw_replay >= 0) {
+        int devnull = open("/dev/null",O_WRONLY);
+
+        if (devnull < 0) {
+            _exit(FAILED);
+        }
+        dup2(devnull,fileno(stdout));
+        dup2(devnull,fileno(stderr));
+        close(devnull);
+    } else {
+        member_worker_output(w);
+    }
+    for ( ; index <= w->mw_last &&
+        (elf = elf_begin(fd,cmd,arf)) != 0; ++index) {
+        if (index == w->mw_first) {
+            if (w->mw_replay >= 0) {
+                member_worker_output(w);
+            }
+            cu_worker_reset_compiler_checks();
+            cu_worker_reset_usage_counts();
+            cu_worker_get_die_state(&w->mw_inbound);
+            w->mw_began = TRUE;
+        }
+        if (index >= start) {
+            process_one_member(elf,elftied,file_name,tied_file_name,
+                TRUE,index);
+        }
+        cmd = elf_next(elf);
+        elf_end(elf);
+    }
+    fflush(stdout);
+    fflush(stderr);
+    cu_worker_get_tail(&tail);
+    if (cu_worker_write(w->mw_res,&w->mw_began,sizeof(w->mw_began)) ||
+        cu_worker_write(w->mw_res,&w->mw_unmergeable,
+            sizeof(w->mw_unmergeable)) ||
+        cu_worker_write(w->mw_res,&w->mw_inbound,
+            sizeof(w->mw_inbound)) ||
+        cu_worker_write(w->mw_res,&tail,sizeof(tail)) ||
+        cu_worker_write_compiler_checks(w->mw_res) ||
+        cu_worker_write(w->mw_res,&w->mw_span_count,
+            sizeof(w->mw_span_count)) ||
+        cu_worker_write(w->mw_res,w->mw_spans,
+            w->mw_span_count*sizeof(struct member_span_s)) ||
+        cu_worker_write(w->mw_res,&w->mw_usage_mark_count,
+            sizeof(w->mw_usage_mark_count)) ||
+        cu_worker_write(w->mw_res,w->mw_usage_marks,
+            w->mw_usage_mark_count*sizeof(long)) ||
+        fflush(w->mw_usage) ||
+        cu_worker_write(w->mw_res,&trailer,sizeof(trailer)) ||
+        fflush(w->mw_res)) {
+        _exit(FAILED);
+    }
+    _exit(0);
+}
+
+/*  Member sizes, as find_cu_ends() records CU ends. */
+static int
+find_member_ends(int fd,Dwarf_Unsigned **ends_out)
+{
+    Elf_Cmd cmd = ELF_C_READ;
+    Elf *arf = elf_begin(fd,cmd,(Elf *)0);
+    Elf *elf = 0;
+    Dwarf_Unsigned *ends = 0;
+    Dwarf_Unsigned end = 0;
+    int count = 0;
+    int size = 0;
+
+    if (!arf) {
+        *ends_out = 0;
+        return 0;
+    }
+    while ((elf = elf_begin(fd,cmd,arf)) != 0) {
+        Elf_Arhdr *mem_header = elf_getarhdr(elf);
+
+        if (count == size) {
+            Dwarf_Unsigned *newends = 0;
+
+            size = size? size*2: 64;
+            newends = (Dwarf_Unsigned *)realloc(ends,
+                size*sizeof(Dwarf_Unsigned));
+            if (!newends) {
+                elf_end(elf);
+                count = 0;
+                break;
+            }
+            ends = newends;
+        }
+        end += mem_header? mem_header->ar_size: 0;
+        ends[count++] = end;
+        cmd = elf_next(elf);
+        elf_end(elf);
+    }
+    elf_end(arf);
+    *ends_out = ends;
+    return count;
+}
+
+/*  Copies a member worker's output less the spans,
+    printing the -ku report at each of the marks. */
+static int
+copy_without_spans(FILE *from,FILE *to,
+    struct member_span_s *spans,unsigned span_count,
+    long *marks,unsigned mark_count,FILE *usagef)
+{
+    char buf[8192];
+    long pos = 0;
+    unsigned i = 0;
+    unsigned m = 0;
+
+    fflush(to);
+    rewind(from);
+    if (mark_count) {
+        rewind(usagef);
+    }
+    for (;;) {
+        long stop = i < span_count? spans[i].ms_start: LONG_MAX;
+        size_t want = sizeof(buf);
+        size_t len = 0;
+
+        if (pos == stop) {
+            if (spans[i].ms_end < pos ||
+                fseek(from,spans[i].ms_end,SEEK_SET)) {
+                return DW_DLV_ERROR;
+            }
+            pos = spans[i].ms_end;
+            ++i;
+            continue;
+        }
+        if (m < mark_count && marks[m] < stop) {
+            stop = marks[m];
+            if (pos > stop) {
+                return DW_DLV_ERROR;
+            }
+        }
+        if (pos == stop) {
+            if (cu_worker_merge_usage_counts(usagef)) {
+                return DW_DLV_ERROR;
+            }
+            print_tag_attributes_usage(0);
+            fflush(to);
+            ++m;
+            continue;
+        }
+        if ((unsigned long)(stop - pos) < want) {
+            want = stop - pos;
+        }
+        len = fread(buf,1,want,from);
+        if (!len) {
+            break;
+        }
+        fwrite(buf,1,len,to);
+        pos += len;
+    }
+    fflush(to);
+    if (m < mark_count) {
+        return DW_DLV_ERROR;
+    }
+    return DW_DLV_OK;
+}
+
+/*  Reads what a worker left and, if the range can be
+    used, merges its counts and copies its output. */
+static boolean
+merge_member_worker(struct member_worker_s *w,boolean is_last)
+{
+    boolean began = FALSE;
+    boolean unmergeable = FALSE;
+    boolean keep_optional = FALSE;
+    struct cu_worker_boundary_s inbound;
+    struct cu_worker_boundary_s current;
+    struct cu_worker_tail_s tail;
+    unsigned span_count = 0;
+    struct member_span_s *spans = 0;
+    unsigned mark_count = 0;
+    long *marks = 0;
+    unsigned trailer = 0;
+    int status = 0;
+
+    if (waitpid(w->mw_pid,&status,0) != w->mw_pid ||
+        !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return FALSE;
+    }
+    if (fseek(w->mw_res,-(long)sizeof(trailer),SEEK_END) ||
+        cu_worker_read(w->mw_res,&trailer,sizeof(trailer)) ||
+        trailer != CU_WORKER_TRAILER) {
+        return FALSE;
+    }
+    rewind(w->mw_res);
+    cu_worker_get_die_state(&current);
+    if (cu_worker_read(w->mw_res,&began,sizeof(began)) ||
+        cu_worker_read(w->mw_res,&unmergeable,sizeof(unmergeable)) ||
+        cu_worker_read(w->mw_res,&inbound,sizeof(inbound)) ||
+        cu_worker_read(w->mw_res,&tail,sizeof(tail)) ||
+        !began || unmergeable ||
+        !cu_worker_same_boundary(&current,&inbound)) {
+        return FALSE;
+    }
+    /*  A serial run would print the reports only if
+        some earlier member had errors. */
+    keep_optional = cu_worker_any_check_errors();
+    if (cu_worker_merge_compiler_checks(w->mw_res,is_last) ||
+        cu_worker_read(w->mw_res,&span_count,sizeof(span_count))) {
+        fprintf(stderr,"%s ERROR:  cannot merge the results "
+            "of -x workers\n",program_name);
+        exit(FAILED);
+    }
+    if (span_count) {
+        spans = (struct member_span_s *)malloc(
+            span_count*sizeof(struct member_span_s));
+        if (!spans ||
+            cu_worker_read(w->mw_res,spans,
+                span_count*sizeof(struct member_span_s))) {
+            fprintf(stderr,"%s ERROR:  cannot merge the results "
+                "of -x workers\n",program_name);
+            exit(FAILED);
+        }
+    }
+    if (cu_worker_read(w->mw_res,&mark_count,sizeof(mark_count))) {
+        fprintf(stderr,"%s ERROR:  cannot merge the results "
+            "of -x workers\n",program_name);
+        exit(FAILED);
+    }
+    if (mark_count) {
+        marks = (long *)malloc(mark_count*sizeof(long));
+        if (!marks ||
+            cu_worker_read(w->mw_res,marks,
+                mark_count*sizeof(long))) {
+            fprintf(stderr,"%s ERROR:  cannot merge the results "
+                "of -x workers\n",program_name);
+            exit(FAILED);
+        }
+    }
+    if (copy_without_spans(w->mw_out,stdout,spans,
+        keep_optional? 0: span_count,
+        marks,mark_count,w->mw_usage)) {
+        fprintf(stderr,"%s ERROR:  cannot merge the results "
+            "of -x workers\n",program_name);
+        exit(FAILED);
+    }
+    free(spans);
+    free(marks);
+    if (w->mw_err) {
+        copy_to(w->mw_err,stderr);
+    }
+    cu_worker_set_tail(&tail);
+    return TRUE;
+}
+
+static void
+close_member_worker(struct member_worker_s *w)
+{
+    if (w->mw_out) {
+        fclose(w->mw_out);
+    }
+    if (w->mw_err) {
+        fclose(w->mw_err);
+    }
+    if (w->mw_res) {
+        fclose(w->mw_res);
+    }
+    if (w->mw_usage) {
+        fclose(w->mw_usage);
+    }
+}
+
+/*  Options whose results span members, and those
+    print_die_section_in_workers() cannot split, leave
+    an archive serial. */
+static boolean
+archive_workers_usable(void)
+{
+    if (glflags.gf_cu_workers < 2) {
+        return FALSE;
+    }
+    if (glflags.gf_search_is_on ||
+        glflags.gf_record_format ||
+        !glflags.gf_check_all_compilers) {
+        return FALSE;
+    }
+    return TRUE;
+}
+
+boolean
+process_archive_in_workers(int fd,Elf *arf,Elf *elftied,
+    const char *file_name,const char *tied_file_name)
+{
+    struct member_worker_s workers[CU_WORKERS_MAX];
+    int firsts[CU_WORKERS_MAX];
+    Dwarf_Unsigned *ends = 0;
+    Elf_Cmd cmd = ELF_C_READ;
+    boolean shared_err = FALSE;
+    int count = 0;
+    int nworkers = 0;
+    int started = 0;
+    int j = 0;
+    int cu_workers = glflags.gf_cu_workers;
+
+    if (!archive_workers_usable()) {
+        return FALSE;
+    }
+    count = find_member_ends(fd,&ends);
+    if (count < 2) {
+        free(ends);
+        return FALSE;
+    }
+    nworkers = glflags.gf_cu_workers;
+    if (nworkers > count) {
+        nworkers = count;
+    }
+    split_by_size(ends,count,nworkers,firsts);
+    free(ends);
+    /*  Members are printed the same way here and in the
+        workers, each with its CUs in turn. */
+    glflags.gf_cu_workers = 1;
+
+    shared_err = stdout_is_stderr();
+    memset(workers,0,sizeof(workers));
+    fflush(stdout);
+    fflush(stderr);
+    for (j = 0; j < nworkers; ++j) {
+        struct member_worker_s *w = &workers[j];
+
+        w->mw_first = firsts[j];
+        w->mw_last = (j+1 < nworkers)? firsts[j+1]-1 : count-1;
+        w->mw_replay = w->mw_first - 1;
+        w->mw_out = tmpfile();
+        w->mw_err = shared_err? 0: tmpfile();
+        w->mw_res = tmpfile();
+        w->mw_usage = tmpfile();
+        if (!w->mw_out || (!shared_err && !w->mw_err) ||
+            !w->mw_res || !w->mw_usage) {
+            break;
+        }
+        w->mw_pid = fork();
+        if (w->mw_pid < 0) {
+            break;
+        }
+        if (w->mw_pid == 0) {
+            run_member_worker(fd,arf,elftied,
+                file_name,tied_file_name,w);
+        }
+        ++started;
+    }
+
+    /*  In member order: take what each worker did or,
+        failing that, do its members here. */
+    for (j = 0; j < nworkers; ++j) {
+        struct member_worker_s *w = &workers[j];
+        boolean merged = FALSE;
+        int index = 0;
+
+        if (j < started) {
+            merged = merge_member_worker(w,j == (nworkers-1));
+        }
+        for (index = w->mw_first; index <= w->mw_last; ++index) {
+            Elf *elf = elf_begin(fd,cmd,arf);
+
+            if (!elf) {
+                break;
+            }
+            if (!merged) {
+                process_one_member(elf,elftied,file_name,
+                    tied_file_name,TRUE,index);
+            }
+            cmd = elf_next(elf);
+            elf_end(elf);
+        }
+        close_member_worker(w);
+    }
+    glflags.gf_cu_workers = cu_workers;
+    return TRUE;
+}
+#else /* !HAVE_CU_WORKERS */
+void
+cu_worker_begin_range(UNUSEDARG struct cu_worker_range_s *range)
+{
+}
+
+boolean
+member_worker_optional_begin(void)
+{
+    return FALSE;
+}
+
+void
+member_worker_optional_end(void)
+{
+}
+
+boolean
+member_worker_usage_report(void)
+{
+    return FALSE;
+}
+
+boolean
+process_archive_in_workers(UNUSEDARG int fd,
+    UNUSEDARG Elf *arf,
+    UNUSEDARG Elf *elftied,
+    UNUSEDARG const char *file_name,
+    UNUSEDARG const char *tied_file_name)
+{
+    return FALSE;
+}
+
+boolean
+print_die_section_in_workers(UNUSEDARG Dwarf_Debug dbg,
+    UNUSEDARG Dwarf_Bool is_info,
+    UNUSEDARG int *result,
+    UNUSEDARG Dwarf_Error *pod_err)
+{
+    return FALSE;
+}
+#endif /* HAVE_CU_WORKERS */
@@ -0,0 +1,175 @@
+/*
+  Copyright 2018 David Anderson. All rights reserved.
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of version 2 of the GNU General Public License as
+  published by the Free Software Foundation.
+
+  This program is distributed in the hope that it would be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  Further, this software is distributed without any warranty that it is
+  free of the rightful claim of any third person regarding infringement
+  or the like.  Any license provided herein, whether implied or
+  otherwise, applies only to this software file.  Patent licenses, if
+  any, provided herein do not apply to combinations of this program with
+  other software, or any other product whatsoever.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write the Free Software Foundation, Inc., 51
+  Franklin Street - Fifth Floor, Boston MA 02110-1301, USA.
+*/
+#ifndef CU_WORKERS_H
+#define CU_WORKERS_H
+
+/*  -x workers=<n> prints .debug_info and .debug_types
+    with n worker processes, each printing a contiguous
+    range of CUs into a private temporary file.
+    The parent copies the files out in CU order and
+    merges the -k counts, so the output is the same as
+    a serial run.  New 2018.
+
+    Workers are fork()ed, so each has its own copy of
+    the Dwarf_Debug and of all dwarfdump global state.
+    Where the serial run carries state from one CU into
+    the next the worker replays the previous CU (output
+    discarded) first, and the parent checks that what
+    each worker started with is what the previous worker
+    ended with.  If any check fails the section is
+    simply printed serially. */
+
+#if !defined(_WIN32) && defined(HAVE_UNISTD_H)
+#define HAVE_CU_WORKERS 1
+#endif
+
+#define CU_WORKERS_MAX 64
+
+/*  Global state one CU can leave behind for the next.  */
+struct cu_worker_boundary_s {
+    boolean cb_record_dwarf_error;
+    boolean cb_seen_PU;
+    boolean cb_seen_PU_base_address;
+    boolean cb_seen_PU_high_address;
+    boolean cb_need_PU_valid_code;
+    Dwarf_Addr cb_PU_base_address;
+    Dwarf_Addr cb_PU_high_address;
+    char cb_PU_name[COMPILE_UNIT_NAME_LEN];
+    boolean cb_in_valid_code;
+    boolean cb_local_symbols_already_began;
+
+    /*  Checks a DWARF5 dwp CU turns off for the rest
+        of the run. */
+    boolean cb_suppress_checking_on_dwp;
+    boolean cb_check_ranges;
+    boolean cb_check_aranges;
+    boolean cb_check_decl_file;
+    boolean cb_check_lines;
+    boolean cb_check_pubname_attr;
+    boolean cb_check_fdes;
+};
+
+/*  What the last worker leaves behind becomes the
+    state of dwarfdump after the section is printed. */
+struct cu_worker_tail_s {
+    struct cu_worker_boundary_s ct_boundary;
+    boolean    ct_seen_CU;
+    boolean    ct_need_CU_name;
+    boolean    ct_need_CU_base_address;
+    boolean    ct_need_CU_high_address;
+    Dwarf_Addr ct_CU_base_address;
+    Dwarf_Addr ct_CU_low_address;
+    Dwarf_Addr ct_CU_high_address;
+    Dwarf_Off  ct_DIE_offset;
+    Dwarf_Off  ct_DIE_overall_offset;
+    Dwarf_Off  ct_DIE_CU_offset;
+    Dwarf_Off  ct_DIE_CU_overall_offset;
+    char       ct_CU_name[COMPILE_UNIT_NAME_LEN];
+    char       ct_CU_producer[COMPILE_UNIT_NAME_LEN];
+};
+
+/*  The CUs one worker prints, by index in the section. */
+struct cu_worker_range_s {
+    Dwarf_Debug cw_dbg;
+    /*  CU replayed with output discarded before
+        cw_first, or -1. */
+    int      cw_replay;
+    int      cw_first;
+    int      cw_last;
+    FILE    *cw_out;
+    FILE    *cw_err;
+    boolean  cw_began;
+    /*  Set if a CU in the range depends on CUs
+        outside it in a way the parent cannot merge. */
+    boolean  cw_unmergeable;
+    struct cu_worker_boundary_s cw_inbound;
+};
+
+/*  In print_die.c. Prints the CUs of one section, all of
+    them if range is NULL. */
+int print_die_section_cus(Dwarf_Debug dbg,Dwarf_Bool is_info,
+    struct cu_worker_range_s *range,Dwarf_Error *pod_err);
+void cu_worker_get_die_state(struct cu_worker_boundary_s *b);
+void cu_worker_set_die_state(struct cu_worker_boundary_s *b);
+void cu_worker_reset_die_checks(void);
+int  cu_worker_write_die_checks(FILE *f);
+int  cu_worker_merge_die_checks(FILE *f);
+void cu_worker_reset_usage_counts(void);
+int  cu_worker_write_usage_counts(FILE *f);
+int  cu_worker_merge_usage_counts(FILE *f);
+
+/*  In dwarfdump.c. The compiler table and its -k counts. */
+void process_one_member(Elf *elf,Elf *elftied,
+    const char *file_name,const char *tied_file_name,
+    int archive,int archmemnum);
+void cu_worker_reset_compiler_checks(void);
+boolean cu_worker_any_check_errors(void);
+int  cu_worker_write_compiler_checks(FILE *f);
+int  cu_worker_merge_compiler_checks(FILE *f,boolean is_last);
+void cu_worker_add_uncollected_harmless(unsigned count);
+
+/*  In cu_workers.c */
+boolean cu_workers_usable(void);
+boolean cu_worker_options_usable(void);
+boolean cu_cache_options_usable(void);
+int  cu_worker_write(FILE *f,const void *data,size_t len);
+int  cu_worker_read(FILE *f,void *data,size_t len);
+boolean cu_worker_same_boundary(struct cu_worker_boundary_s *a,
+    struct cu_worker_boundary_s *b);
+void cu_worker_get_tail(struct cu_worker_tail_s *t);
+void cu_worker_set_tail(struct cu_worker_tail_s *t);
+/*  libdwarf's harmless error list, which fetching empties. */
+int  cu_worker_write_harmless(Dwarf_Debug dbg,FILE *f);
+int  cu_worker_merge_harmless(Dwarf_Debug dbg,FILE *f);
+void cu_worker_begin_range(struct cu_worker_range_s *range);
+boolean print_die_section_in_workers(Dwarf_Debug dbg,
+    Dwarf_Bool is_info,int *result,Dwarf_Error *pod_err);
+
+/*  -x workers=<n> given an archive hands each worker a
+    contiguous range of members instead; the CUs of a
+    member are then printed serially.  As with CUs a
+    worker first replays the member before its range and
+    the parent checks the state each range started from.
+    A range that fails the check, or whose worker failed,
+    is processed again by the parent.  New 2018.
+
+    Returns FALSE, having done nothing, if the archive
+    must be processed serially. */
+boolean process_archive_in_workers(int fd,Elf *arf,Elf *elftied,
+    const char *file_name,const char *tied_file_name);
+
+/*  print_checks_results() prints its report only once some
+    object has had errors.  A worker prints it anyway between
+    these calls and the parent drops it if no member before
+    the worker's range had errors.  begin returns FALSE when
+    not in a member worker. */
+boolean member_worker_optional_begin(void);
+void member_worker_optional_end(void);
+
+/*  The -ku counts add up over the members.  In a member
+    worker this hands the member's counts to the parent,
+    which prints the report in its place, and returns TRUE.
+    Returns FALSE when the report must be printed here. */
+boolean member_worker_usage_report(void);
+
+#endif /* CU_WORKERS_H */
@@ -0,0 +1,194 @@
+/*
+  Copyright 2018 David Anderson. All rights reserved.
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of version 2 of the GNU General Public License as
+  published by the Free Software Foundation.
+
+  This program is distributed in the hope that it would be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  Further, this software is distributed without any warranty that it is
+  free of the rightful claim of any third person regarding infringement
+  or the like.  Any license provided herein, whether implied or
+  otherwise, applies only to this software file.  Patent licenses, if
+  any, provided herein do not apply to combinations of this program with
+  other software, or any other product whatsoever.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write the Free Software Foundation, Inc., 51
+  Franklin Street - Fifth Floor, Boston MA 02110-1301, USA.
+*/
+
+/*  See die_summary.h.
+
+    ds_bits has a bit for each byte of the CU, set where a
+    recorded DIE starts.  ds_rank[w] is the number of bits
+    set in the words before ds_bits[w], so the index of
+    a DIE in ds_entries is ds_rank[w] plus the bits set
+    below it in its own word.  DIEs are recorded in offset
+    order, so ds_rank is filled in as the walk goes. */
+
+#include "globals.h"
+#include "die_summary.h"
+
+#define DS_WORD_BITS 64
+
+struct die_summary_s {
+    Dwarf_Debug     ds_dbg;
+    Dwarf_Bool      ds_is_info;
+    boolean         ds_active;
+    Dwarf_Off       ds_cu_goffset;
+    /*  Bytes in the CU. */
+    Dwarf_Unsigned  ds_cu_length;
+    Dwarf_Unsigned  ds_last_rel;
+    Dwarf_Unsigned  ds_words;
+    Dwarf_Unsigned  ds_words_allocated;
+    Dwarf_Unsigned *ds_bits;
+    Dwarf_Unsigned *ds_rank;
+    Dwarf_Unsigned  ds_rank_filled;
+    Dwarf_Unsigned  ds_count;
+    Dwarf_Unsigned  ds_entries_allocated;
+    struct die_summary_entry_s *ds_entries;
+};
+
+static struct die_summary_s die_summary;
+
+static unsigned
+bits_set(Dwarf_Unsigned v)
+{
+    v = v - ((v >> 1) & 0x5555555555555555ULL);
+    v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+    v = (v + (v >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (unsigned)((v * 0x0101010101010101ULL) >> 56);
+}
+
+void
+die_summary_begin_cu(Dwarf_Debug dbg, Dwarf_Bool is_info,
+    Dwarf_Off cu_goffset, Dwarf_Off cu_end_goffset)
+{
+    struct die_summary_s *ds = &die_summary;
+    Dwarf_Unsigned words = 0;
+
+    ds->ds_active = FALSE;
+    ds->ds_count = 0;
+    ds->ds_rank_filled = 0;
+    ds->ds_last_rel = 0;
+    if (cu_end_goffset <= cu_goffset) {
+        return;
+    }
+    words = (cu_end_goffset - cu_goffset + DS_WORD_BITS - 1) /
+        DS_WORD_BITS;
+    if (words > ds->ds_words_allocated) {
+        Dwarf_Unsigned *newbits = 0;
+        Dwarf_Unsigned *newrank = 0;
+
+        newbits = (Dwarf_Unsigned *)realloc(ds->ds_bits,
+            words * sizeof(Dwarf_Unsigned));
+        if (!newbits) {
+            return;
+        }
+        ds->ds_bits = newbits;
+        newrank = (Dwarf_Unsigned *)realloc(ds->ds_rank,
+            words * sizeof(Dwarf_Unsigned));
+        if (!newrank) {
+            return;
+        }
+        ds->ds_rank = newrank;
+        ds->ds_words_allocated = words;
+    }
+    memset(ds->ds_bits, 0, words * sizeof(Dwarf_Unsigned));
+    ds->ds_words = words;
+    ds->ds_dbg = dbg;
+    ds->ds_is_info = is_info;
+    ds->ds_cu_goffset = cu_goffset;
+    ds->ds_cu_length = cu_end_goffset - cu_goffset;
+    ds->ds_active = TRUE;
+}
+
+void
+die_summary_record(Dwarf_Debug dbg, Dwarf_Bool is_info,
+    Dwarf_Off die_goffset, Dwarf_Half tag, int signedness)
+{
+    struct die_summary_s *ds = &die_summary;
+    struct die_summary_entry_s *e = 0;
+    Dwarf_Unsigned rel = 0;
+    Dwarf_Unsigned w = 0;
+
+    if (!ds->ds_active || ds->ds_dbg != dbg ||
+        ds->ds_is_info != is_info ||
+        die_goffset < ds->ds_cu_goffset) {
+        return;
+    }
+    rel = die_goffset - ds->ds_cu_goffset;
+    if (rel >= ds->ds_cu_length ||
+        (ds->ds_count && rel <= ds->ds_last_rel)) {
+        return;
+    }
+    if (ds->ds_count == ds->ds_entries_allocated) {
+        Dwarf_Unsigned newcount = ds->ds_entries_allocated?
+            ds->ds_entries_allocated * 2 : 256;
+        struct die_summary_entry_s *newentries =
+            (struct die_summary_entry_s *)realloc(ds->ds_entries,
+            newcount * sizeof(struct die_summary_entry_s));
+
+        if (!newentries) {
+            /*  Stop recording. Lookups still work for
+                what is recorded. */
+            ds->ds_cu_length = rel;
+            return;
+        }
+        ds->ds_entries = newentries;
+        ds->ds_entries_allocated = newcount;
+    }
+    w = rel / DS_WORD_BITS;
+    for ( ; ds->ds_rank_filled <= w; ++ds->ds_rank_filled) {
+        ds->ds_rank[ds->ds_rank_filled] = ds->ds_count;
+    }
+    ds->ds_bits[w] |= ((Dwarf_Unsigned)1) << (rel % DS_WORD_BITS);
+    e = ds->ds_entries + ds->ds_count;
+    e->dse_tag = tag;
+    e->dse_signedness = (signed char)signedness;
+    ds->ds_count++;
+    ds->ds_last_rel = rel;
+}
+
+const struct die_summary_entry_s *
+die_summary_find(Dwarf_Debug dbg, Dwarf_Bool is_info,
+    Dwarf_Off die_goffset)
+{
+    struct die_summary_s *ds = &die_summary;
+    Dwarf_Unsigned rel = 0;
+    Dwarf_Unsigned w = 0;
+    Dwarf_Unsigned bit = 0;
+    Dwarf_Unsigned index = 0;
+
+    if (!ds->ds_active || !ds->ds_count || ds->ds_dbg != dbg ||
+        ds->ds_is_info != is_info ||
+        die_goffset < ds->ds_cu_goffset) {
+        return NULL;
+    }
+    rel = die_goffset - ds->ds_cu_goffset;
+    if (rel > ds->ds_last_rel) {
+        return NULL;
+    }
+    w = rel / DS_WORD_BITS;
+    bit = ((Dwarf_Unsigned)1) << (rel % DS_WORD_BITS);
+    if (!(ds->ds_bits[w] & bit)) {
+        return NULL;
+    }
+    index = ds->ds_rank[w] + bits_set(ds->ds_bits[w] & (bit - 1));
+    return ds->ds_entries + index;
+}
+
+void
+die_summary_destructor(void)
+{
+    struct die_summary_s *ds = &die_summary;
+
+    free(ds->ds_bits);
+    free(ds->ds_rank);
+    free(ds->ds_entries);
+    memset(ds, 0, sizeof(*ds));
+}
@@ -0,0 +1,61 @@
+/*
+  Copyright 2018 David Anderson. All rights reserved.
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of version 2 of the GNU General Public License as
+  published by the Free Software Foundation.
+
+  This program is distributed in the hope that it would be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  Further, this software is distributed without any warranty that it is
+  free of the rightful claim of any third person regarding infringement
+  or the like.  Any license provided herein, whether implied or
+  otherwise, applies only to this software file.  Patent licenses, if
+  any, provided herein do not apply to combinations of this program with
+  other software, or any other product whatsoever.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write the Free Software Foundation, Inc., 51
+  Franklin Street - Fifth Floor, Boston MA 02110-1301, USA.
+*/
+#ifndef DIE_SUMMARY_H
+#define DIE_SUMMARY_H
+
+/*  While print_die_and_children() walks a CU every DIE it
+    has finished with is recorded here: a bit per section
+    byte of the CU marks where the DIEs start, and the
+    n'th set bit indexes a small summary of the n'th DIE.
+    So a reference back to a DIE already walked (most
+    DW_AT_type references are) is checked without
+    dwarf_offdie_b().  New 2018.
+
+    Only the current CU is kept.  A reference to anything
+    not yet recorded (a forward reference, another CU) is
+    not found here and the caller must ask libdwarf. */
+
+struct die_summary_entry_s {
+    Dwarf_Half  dse_tag;
+    /*  From DW_AT_encoding, as check_for_type_unsigned()
+        returns it: -1 signed, 1 unsigned, 0 unknown. */
+    signed char dse_signedness;
+};
+
+void die_summary_begin_cu(Dwarf_Debug dbg, Dwarf_Bool is_info,
+    Dwarf_Off cu_goffset, Dwarf_Off cu_end_goffset);
+
+/*  DIEs must be recorded in increasing offset order;
+    anything else is ignored. */
+void die_summary_record(Dwarf_Debug dbg, Dwarf_Bool is_info,
+    Dwarf_Off die_goffset, Dwarf_Half tag, int signedness);
+
+/*  Returns NULL unless die_goffset is the start of a
+    DIE recorded in the current CU. */
+const struct die_summary_entry_s *
+die_summary_find(Dwarf_Debug dbg, Dwarf_Bool is_info,
+    Dwarf_Off die_goffset);
+
+void die_summary_destructor(void);
+
+#endif /* DIE_SUMMARY_H */
@@ -49,6 +49,13 @@
 #include "uri.h"
 #include "esb.h"                /* For flexible string buffer. */
 #include "tag_common.h"
+#include "cu_workers.h"
+#include "dwarf_tsearch.h"
+#include "die_summary.h"
+#include "outbuf.h"
+#include "records.h"
+#include "search_index.h"
+#include "cu_cache.h"
 
 #ifdef _WIN32
 extern int elf_open(const char *name,int mode);
@@ -214,6 +221,8 @@ Dwarf_Addr CU_high_address = 0;       /* CU High address */
 const char *search_any_text = 0;
 const char *search_match_text = 0;
 const char *search_regex_text = 0;
+const char *search_name_text = 0;
+const char *cu_cache_path = 0;
 int search_occurrences = 0;
 
 #ifdef HAVE_REGEX
@@ -228,6 +237,7 @@ static void release_unique_errors_table(void);
 static void dump_unique_errors_table(void);
 #endif
 static boolean add_to_unique_errors_table(char * error_text);
+static void print_unique_errors_summary(void);
 
 /*  These configure items are for the
     frame data.  We're flexible in
@@ -406,6 +416,96 @@ clean_up_compilers_detected(void)
 }
 
 
+/*  Everything done for one object, which may be
+    archive member number archmemnum. */
+void
+process_one_member(Elf *elf,Elf *elftied,
+    const char *file_name,const char *tied_file_name,
+    int archive,int archmemnum)
+{
+    int isknown = is_it_known_elf_header(elf);
+    if (!isknown) {
+        /* not a 64-bit obj either! */
+        /* dwarfdump is almost-quiet when not an object */
+        if (archive) {
+            Elf_Arhdr *mem_header = elf_getarhdr(elf);
+            const char *memname =
+                (mem_header && mem_header->ar_name)?
+                mem_header->ar_name:"";
+
+            /*  / and // archive entries are not archive
+                objects, but are not errors. */
+            if (strcmp(memname,"/") && strcmp(memname,"//")) {
+                fprintf(stderr, "Can't process archive member "
+                    "%d %s of %s: unknown format\n",
+                    archmemnum,
+                    sanitized(memname),
+                    file_name);
+            }
+        } else {
+            fprintf(stderr, "Can't process %s: unknown format\n",
+                file_name);
+        }
+        check_error = 1;
+        return;
+    }
+    memset(&section_high_offsets_global,0,
+        sizeof(section_high_offsets_global));
+        /*  If we are checking .debug_line, .debug_ranges, .debug_aranges,
+        or .debug_loc build the tables containing
+        the pairs LowPC and HighPC. It is safer  (and not
+        expensive) to build all
+        of these at once so mistakes in options do not lead
+        to coredumps (like -ka -p did once). */
+    if (glflags.gf_check_decl_file || glflags.gf_check_ranges ||
+        glflags.gf_check_locations ||
+        glflags.gf_do_check_dwarf ||
+        glflags.gf_check_self_references) {
+        pRangesInfo = AllocateBucketGroup(KIND_RANGES_INFO);
+        pLinkonceInfo = AllocateBucketGroup(KIND_SECTIONS_INFO);
+        pVisitedInfo = AllocateBucketGroup(KIND_VISITED_INFO);
+    }
+
+    /* Create the unique error table */
+    if (glflags.gf_print_unique_errors) {
+        allocate_unique_errors_table();
+    }
+
+    /* Allocate range array to be used by all CUs */
+    if (glflags.gf_check_ranges) {
+        allocate_range_array_info();
+    }
+    process_one_file(elf,elftied,
+        file_name, tied_file_name,
+        archive, &g_config_file_data);
+    /* Now cleanup object-specific allocations. */
+    /* Trivial malloc space cleanup. */
+    clean_up_syms_malloc_data();
+    if (pRangesInfo) {
+        ReleaseBucketGroup(pRangesInfo);
+        pRangesInfo = 0;
+    }
+    if (pLinkonceInfo) {
+        ReleaseBucketGroup(pLinkonceInfo);
+        pLinkonceInfo = 0;
+    }
+    if (pVisitedInfo) {
+        ReleaseBucketGroup(pVisitedInfo);
+        pVisitedInfo = 0;
+    }
+    /* Release range array to be used by all CUs */
+    if (glflags.gf_check_ranges) {
+        release_range_array_info();
+    }
+    /* Delete the unique error set */
+    if (glflags.gf_print_unique_errors) {
+        release_unique_errors_table();
+    }
+    clean_up_compilers_detected();
+    destruct_abbrev_array();
+    die_summary_destructor();
+}
+
 /*
    Iterate through dwarf and print all info.
 */
@@ -465,6 +565,7 @@ main(int argc, char *argv[])
 #endif
     dup2(fileno(stdout),fileno(stderr));
 #endif /* _WIN32 */
+    outbuf_init();
 
     print_version_details(argv[0],FALSE);
 
@@ -490,6 +591,9 @@ main(int argc, char *argv[])
         print_version_details(argv[0],TRUE);
         print_args(argc,argv);
     }
+    /*  -x format=: from here on records go to what was
+        stdout and text to stderr. */
+    records_open();
 
     /*  Because LibDwarf now generates some new warnings,
         allow the user to hide them by using command line options */
@@ -543,92 +647,16 @@ main(int argc, char *argv[])
     }
 
 
-    while ((elf = elf_begin(f, cmd, arf)) != 0) {
-        int isknown = is_it_known_elf_header(elf);
-        if (!isknown) {
-            /* not a 64-bit obj either! */
-            /* dwarfdump is almost-quiet when not an object */
-            if (archive) {
-                Elf_Arhdr *mem_header = elf_getarhdr(elf);
-                const char *memname =
-                    (mem_header && mem_header->ar_name)?
-                    mem_header->ar_name:"";
-
-                /*  / and // archive entries are not archive
-                    objects, but are not errors. */
-                if (strcmp(memname,"/") && strcmp(memname,"//")) {
-                    fprintf(stderr, "Can't process archive member "
-                        "%d %s of %s: unknown format\n",
-                        archmemnum,
-                        sanitized(memname),
-                        file_name);
-                }
-            } else {
-                fprintf(stderr, "Can't process %s: unknown format\n",
-                    file_name);
-            }
-            check_error = 1;
+    if (!archive ||
+        !process_archive_in_workers(f,arf,elftied,
+            file_name,tied_file_name)) {
+        while ((elf = elf_begin(f, cmd, arf)) != 0) {
+            process_one_member(elf,elftied,file_name,tied_file_name,
+                archive,archmemnum);
             cmd = elf_next(elf);
             elf_end(elf);
-            continue;
-        }
-        memset(&section_high_offsets_global,0,
-            sizeof(section_high_offsets_global));
-            /*  If we are checking .debug_line, .debug_ranges, .debug_aranges,
-            or .debug_loc build the tables containing
-            the pairs LowPC and HighPC. It is safer  (and not
-            expensive) to build all
-            of these at once so mistakes in options do not lead
-            to coredumps (like -ka -p did once). */
-        if (glflags.gf_check_decl_file || glflags.gf_check_ranges ||
-            glflags.gf_check_locations ||
-            glflags.gf_do_check_dwarf ||
-            glflags.gf_check_self_references) {
-            pRangesInfo = AllocateBucketGroup(KIND_RANGES_INFO);
-            pLinkonceInfo = AllocateBucketGroup(KIND_SECTIONS_INFO);
-            pVisitedInfo = AllocateBucketGroup(KIND_VISITED_INFO);
-        }
-
-        /* Create the unique error table */
-        if (glflags.gf_print_unique_errors) {
-            allocate_unique_errors_table();
+            archmemnum += 1;
         }
-
-        /* Allocate range array to be used by all CUs */
-        if (glflags.gf_check_ranges) {
-            allocate_range_array_info();
-        }
-        process_one_file(elf,elftied,
-            file_name, tied_file_name,
-            archive, &g_config_file_data);
-        /* Now cleanup object-specific allocations. */
-        /* Trivial malloc space cleanup. */
-        clean_up_syms_malloc_data();
-        if (pRangesInfo) {
-            ReleaseBucketGroup(pRangesInfo);
-            pRangesInfo = 0;
-        }
-        if (pLinkonceInfo) {
-            ReleaseBucketGroup(pLinkonceInfo);
-            pLinkonceInfo = 0;
-        }
-        if (pVisitedInfo) {
-            ReleaseBucketGroup(pVisitedInfo);
-            pVisitedInfo = 0;
-        }
-        /* Release range array to be used by all CUs */
-        if (glflags.gf_check_ranges) {
-            release_range_array_info();
-        }
-        /* Delete the unique error set */
-        if (glflags.gf_print_unique_errors) {
-            release_unique_errors_table();
-        }
-        clean_up_compilers_detected();
-        destruct_abbrev_array();
-        cmd = elf_next(elf);
-        elf_end(elf);
-        archmemnum += 1;
     }
     elf_end(arf);
     if (elftied) {
@@ -643,6 +671,7 @@ main(int argc, char *argv[])
         regfree(&search_re);
     }
 #endif
+    search_index_destructor();
     makename_destructor();
     esb_destructor(&config_file_path);
     esb_destructor(&config_file_tiedpath);
@@ -653,6 +682,7 @@ main(int argc, char *argv[])
     sanitized_string_destructor();
     ranges_esb_string_destructor();
     esb_destructor(&newprogname);
+    records_close();
 
     close_a_file(f);
 
@@ -667,6 +697,16 @@ main(int argc, char *argv[])
     return OKAY;
 }
 
+/*  Harmless errors counted by -x workers whose text
+    libdwarf had already dropped. */
+static unsigned harmless_errors_uncollected = 0;
+
+void
+cu_worker_add_uncollected_harmless(unsigned count)
+{
+    harmless_errors_uncollected += count;
+}
+
 void
 print_any_harmless_errors(Dwarf_Debug dbg)
 {
@@ -679,6 +719,9 @@ print_any_harmless_errors(Dwarf_Debug dbg)
     unsigned printcount = 0;
     int res = dwarf_get_harmless_error_list(dbg,LOCAL_PTR_ARY_COUNT,buf,
         &totalcount);
+
+    totalcount += harmless_errors_uncollected;
+    harmless_errors_uncollected = 0;
     if (res == DW_DLV_NO_ENTRY) {
         return;
     }
@@ -960,6 +1003,9 @@ print_search_results(void)
         if (search_match_text) {
             search_type = "match";
             search_text = search_match_text;
+        } else if (search_name_text) {
+            search_type = glflags.gf_search_global? "global" : "name";
+            search_text = search_name_text;
         } else {
             search_type = "regex";
             search_text = search_regex_text;
@@ -980,6 +1026,7 @@ print_checks_results(void)
     int index = 0;
     Compiler *pCompilers;
     Compiler *pCompiler;
+    boolean optional_report = FALSE;
 
     /* Sort based on errors detected; the first entry is reserved */
     pCompilers = &compilers_detected[1];
@@ -1010,10 +1057,18 @@ print_checks_results(void)
         printf("\nDetected %d CU names\n",total);
     }
 
+    /*  An archive member worker cannot know if members
+        before its own found errors: the parent keeps or
+        drops the report. */
+    if (glflags.gf_do_check_dwarf && !check_error &&
+        !glflags.gf_check_show_results) {
+        optional_report = member_worker_optional_begin();
+    }
+
     /* Print error report only if errors have been detected */
     /* Print error report if the -kd option */
     if ((glflags.gf_do_check_dwarf && check_error) ||
-        glflags.gf_check_show_results) {
+        glflags.gf_check_show_results || optional_report) {
         int count = 0;
         int compilers_not_detected = 0;
         int compilers_verified = 0;
@@ -1087,8 +1142,16 @@ print_checks_results(void)
             printf("\n*** TOTAL ERRORS FOR ALL COMPILERS ***\n");
             print_specific_checks_results(&compilers_detected[0]);
         }
+
+        /*  With -kG, how often each of the errors was seen. */
+        if (glflags.gf_print_unique_errors) {
+            print_unique_errors_summary();
+        }
     }
     fflush(stdout);
+    if (optional_report) {
+        member_worker_optional_end();
+    }
 }
 
 /* This is for dwarf_print_lines() */
@@ -1295,9 +1358,22 @@ process_one_file(Elf * elf,Elf *elftied,
         glflags.gf_cu_name_flag || glflags.gf_search_is_on ||
         glflags.gf_producer_children_flag) {
 
+        if (search_name_text) {
+            search_index_setup(dbg);
+        }
+        if (cu_cache_path) {
+            if (archive) {
+                cu_cache_ignored("for archives");
+            } else if (dbgtied) {
+                cu_cache_ignored("with -x tied=");
+            } else {
+                cu_cache_open(dbg,elf);
+            }
+        }
         print_infos(dbg,TRUE);
         reset_overall_CU_error_data();
         print_infos(dbg,FALSE);
+        cu_cache_close();
         if (glflags.gf_check_macros) {
             set_global_section_sizes(dbg);
             if(macro_check_tree) {
@@ -1317,6 +1393,8 @@ process_one_file(Elf * elf,Elf *elftied,
         }
         clear_macro_statistics(&macro_check_tree);
         clear_macro_statistics(&macinfo_check_tree);
+    } else if (cu_cache_path) {
+        cu_cache_ignored("as no compilation units are printed");
     }
     if (glflags.gf_gdbindex_flag) {
         reset_overall_CU_error_data();
@@ -1408,7 +1486,8 @@ process_one_file(Elf * elf,Elf *elftied,
     }
 
     /* Print the tags and attribute usage */
-    if (glflags.gf_print_usage_tag_attr) {
+    if (glflags.gf_print_usage_tag_attr &&
+        !member_worker_usage_report()) {
         print_tag_attributes_usage(dbg);
     }
 
@@ -1421,6 +1500,11 @@ process_one_file(Elf * elf,Elf *elftied,
         dbgtied = 0;
     }
     groups_restore_subsidiary_flags();
+    if (glflags.gf_print_stats) {
+        /*  Printed through printf_callback_for_libdwarf(). */
+        printf("\nlibdwarf statistics\n");
+        dwarf_print_memory_stats(dbg);
+    }
     dres = dwarf_finish(dbg, &onef_err);
     if (dres != DW_DLV_OK) {
         print_error(dbg, "dwarf_finish", dres, onef_err);
@@ -1551,6 +1635,12 @@ static const char *usage_text[] = {
 "\t\t  \twith <option>:",
 "\t\t  \t-S any=<text>\tany <text>",
 "\t\t  \t-S match=<text>\tmatching <text>",
+"\t\t  \t-S name=<text>\tDW_AT_name or linkage name <text>,",
+"\t\t  \t    a trailing * matches a prefix",
+"\t\t  \t-S global=<text>\tDW_AT_name <text> of an external",
+"\t\t  \t    function or variable definition, uses",
+"\t\t  \t    .debug_names, .gdb_index or .debug_pubnames",
+"\t\t  \t    if present",
 #ifdef HAVE_REGEX
 "\t\t  \t-S regex=<text>\tuse regular expression matching",
 #endif
@@ -1566,9 +1656,18 @@ static const char *usage_text[] = {
 "\t\t-vv verbose: show even more information",
 "\t\t-V print version information",
 "\t\t-x abi=<abi>\tname abi in dwarfdump.conf",
+"\t\t-x cache=<path>\tkeep per-CU results in path, reuse",
+"\t\t   \tthose of unchanged CUs",
+"\t\t-x format=jsonl\twrite DIEs, line and frame rows, aranges",
+"\t\t   \tand pubnames as JSON Lines records, other output",
+"\t\t   \tto stderr",
+"\t\t-x format=binary\tthe same records length-prefixed",
 "\t\t-x groupnumber=<n>\tgroupnumber to print",
 "\t\t-x name=<path>\tname dwarfdump.conf",
+"\t\t-x stats\tprint libdwarf memory and section statistics",
 "\t\t-x tied=<tiedpath>\tname an associated object file (Split DWARF)",
+"\t\t-x workers=<n>\tprint .debug_info with n worker processes",
+"\t\t   \tor, given an archive, the members",
 #if 0
 "\t\t-x nosanitizestrings\tLet bogus string characters come thru printf",
 #endif
@@ -1776,6 +1875,35 @@ process_args(int argc, char *argv[])
                         goto badopt;
                     }
                     break;
+                } else if (strncmp(dwoptarg, "workers=", 8) == 0) {
+                    long int wnum = 0;
+                    int res = get_number_value(dwoptarg+8,&wnum);
+
+                    if (res != DW_DLV_OK || wnum < 1 ||
+                        wnum > CU_WORKERS_MAX) {
+                        goto badopt;
+                    }
+                    glflags.gf_cu_workers = wnum;
+                    break;
+                } else if (strncmp(dwoptarg, "cache=", 6) == 0) {
+                    cu_cache_path = do_uri_translation(&dwoptarg[6],
+                        "-x cache=");
+                    if (strlen(cu_cache_path) < 1) {
+                        goto badopt;
+                    }
+                    break;
+                } else if (strcmp(dwoptarg, "format=jsonl") == 0) {
+                    glflags.gf_record_format = RECORD_FORMAT_JSONL;
+                    break;
+                } else if (strcmp(dwoptarg, "format=binary") == 0) {
+                    glflags.gf_record_format = RECORD_FORMAT_BINARY;
+                    break;
+                } else if (strcmp(dwoptarg, "format=text") == 0) {
+                    glflags.gf_record_format = RECORD_FORMAT_TEXT;
+                    break;
+                } else if (strcmp(dwoptarg, "stats") == 0) {
+                    glflags.gf_print_stats = TRUE;
+                    break;
                 } else if (strcmp(dwoptarg, "nosanitizestrings") == 0) {
                     no_sanitize_string_garbage = TRUE;
                     break;
@@ -1792,6 +1920,14 @@ process_args(int argc, char *argv[])
                     fprintf(stderr, " and  \n");
                     fprintf(stderr, "-x line5={std,s2l,orig,orig2l} \n");
                     fprintf(stderr, " and  \n");
+                    fprintf(stderr, "-x workers=<1-%d> \n",CU_WORKERS_MAX);
+                    fprintf(stderr, " and  \n");
+                    fprintf(stderr, "-x format={text,jsonl,binary} \n");
+                    fprintf(stderr, " and  \n");
+                    fprintf(stderr, "-x cache=<path> \n");
+                    fprintf(stderr, " and  \n");
+                    fprintf(stderr, "-x stats \n");
+                    fprintf(stderr, " and  \n");
                     fprintf(stderr, "-x nosanitizestrings \n");
                     fprintf(stderr, "are legal, not -x %s\n", dwoptarg);
                     usage_error = TRUE;
@@ -1933,7 +2069,7 @@ process_args(int argc, char *argv[])
                 boolean serr = TRUE;
                 glflags.gf_search_is_on = TRUE;
                 /* 'v' option, to print number of occurrences */
-                /* -S[v]match|any|regex=text*/
+                /* -S[v]match|any|name|global|regex=text*/
                 if (dwoptarg[0] == 'v') {
                     ++dwoptarg;
                     glflags.gf_search_print_results = TRUE;
@@ -1957,6 +2093,27 @@ process_args(int argc, char *argv[])
                             serr = FALSE;
                         }
                     }
+                    /* -S name=<text>*/
+                    else if (strncmp(dwoptarg,"name=",5) == 0) {
+                        search_name_text = makename(&dwoptarg[5]);
+                        tempstr = remove_quotes_pair(search_name_text);
+                        search_name_text = do_uri_translation(tempstr,
+                            "-S name=");
+                        if (strlen(search_name_text) > 0) {
+                            serr = FALSE;
+                        }
+                    }
+                    /* -S global=<text>*/
+                    else if (strncmp(dwoptarg,"global=",7) == 0) {
+                        search_name_text = makename(&dwoptarg[7]);
+                        tempstr = remove_quotes_pair(search_name_text);
+                        search_name_text = do_uri_translation(tempstr,
+                            "-S global=");
+                        glflags.gf_search_global = TRUE;
+                        if (strlen(search_name_text) > 0) {
+                            serr = FALSE;
+                        }
+                    }
 #ifdef HAVE_REGEX
                     else {
                         /* -S regex=<regular expression>*/
@@ -1974,6 +2131,8 @@ process_args(int argc, char *argv[])
                                         search_regex_text);
                                 }
                                 else {
+                                    search_regex_prepare(
+                                        search_regex_text);
                                     serr = FALSE;
                                 }
                             }
@@ -1982,7 +2141,7 @@ process_args(int argc, char *argv[])
 #endif /* HAVE_REGEX */
                 }
                 if (serr) {
-                    fprintf(stderr,"-S any=<text> or -S match=<text> or -S regex=<text>\n");
+                    fprintf(stderr,"-S any=<text> or -S match=<text> or -S name=<text> or -S global=<text> or -S regex=<text>\n");
                     fprintf(stderr, "is allowed, not -S %s\n",dwoptarg);
                     usage_error = TRUE;
                 }
@@ -2457,6 +2616,7 @@ process_args(int argc, char *argv[])
         /* Reduce verbosity when checking (checking means checking-only). */
         verbose = 1;
     }
+    cu_cache_set_options(dwoptind,argv);
     return do_uri_translation(argv[dwoptind],"file-to-process");
 }
 
@@ -2961,6 +3121,209 @@ reset_compiler_entry(Compiler *compiler)
     memset(compiler,0,sizeof(Compiler));
 }
 
+/*  -x workers support (see cu_workers.c).  A worker zeroes
+    the counts it inherited and the parent adds in what each
+    worker found, in CU order, so compilers get the numbers
+    a serial run would give them.  New 2018. */
+void
+cu_worker_reset_compiler_checks(void)
+{
+    int index = 0;
+
+    for (index = 0; index <= compilers_detected_count; ++index) {
+        memset(compilers_detected[index].results,0,
+            sizeof(compilers_detected[index].results));
+        compilers_detected[index].verified = FALSE;
+    }
+    for (index = 1; index <= compilers_targeted_count; ++index) {
+        compilers_targeted[index].verified = FALSE;
+    }
+    check_error = 0;
+}
+
+boolean
+cu_worker_any_check_errors(void)
+{
+    return check_error != 0;
+}
+
+int
+cu_worker_write_compiler_checks(FILE *f)
+{
+    int index = 0;
+
+    if (cu_worker_write(f,&check_error,sizeof(check_error)) ||
+        cu_worker_write(f,&current_cu_is_checked_compiler,
+            sizeof(current_cu_is_checked_compiler)) ||
+        cu_worker_write(f,&current_compiler,sizeof(current_compiler)) ||
+        cu_worker_write(f,&compilers_detected_count,
+            sizeof(compilers_detected_count)) ||
+        cu_worker_write(f,&compilers_targeted_count,
+            sizeof(compilers_targeted_count))) {
+        return DW_DLV_ERROR;
+    }
+    for (index = 0; index <= compilers_detected_count; ++index) {
+        Compiler *pCompiler = &compilers_detected[index];
+        unsigned len = pCompiler->name? strlen(pCompiler->name):0;
+
+        if (cu_worker_write(f,&len,sizeof(len)) ||
+            cu_worker_write(f,pCompiler->name,len) ||
+            cu_worker_write(f,&pCompiler->verified,
+                sizeof(pCompiler->verified)) ||
+            cu_worker_write(f,pCompiler->results,
+                sizeof(pCompiler->results))) {
+            return DW_DLV_ERROR;
+        }
+    }
+    for (index = 1; index <= compilers_targeted_count; ++index) {
+        if (cu_worker_write(f,&compilers_targeted[index].verified,
+            sizeof(compilers_targeted[index].verified))) {
+            return DW_DLV_ERROR;
+        }
+    }
+    return DW_DLV_OK;
+}
+
+/*  is_last means the worker printed the final CUs, so
+    its idea of the current compiler is the right one. */
+int
+cu_worker_merge_compiler_checks(FILE *f,boolean is_last)
+{
+    int index = 0;
+    int errors = 0;
+    boolean checked = FALSE;
+    int wcurrent = 0;
+    int wdetected = 0;
+    int wtargeted = 0;
+    int map[COMPILER_TABLE_MAX];
+
+    if (cu_worker_read(f,&errors,sizeof(errors)) ||
+        cu_worker_read(f,&checked,sizeof(checked)) ||
+        cu_worker_read(f,&wcurrent,sizeof(wcurrent)) ||
+        cu_worker_read(f,&wdetected,sizeof(wdetected)) ||
+        cu_worker_read(f,&wtargeted,sizeof(wtargeted))) {
+        return DW_DLV_ERROR;
+    }
+    if (wdetected < 0 || wdetected >= COMPILER_TABLE_MAX ||
+        wtargeted != compilers_targeted_count) {
+        return DW_DLV_ERROR;
+    }
+    check_error += errors;
+    for (index = 0; index <= wdetected; ++index) {
+        Compiler w;
+        Compiler *pCompiler = 0;
+        unsigned len = 0;
+        char *name = 0;
+        int c = 0;
+
+        if (cu_worker_read(f,&len,sizeof(len)) ||
+            len >= COMPILE_UNIT_NAME_LEN) {
+            return DW_DLV_ERROR;
+        }
+        name = (char *)malloc(len+1);
+        if (!name) {
+            return DW_DLV_ERROR;
+        }
+        name[len] = 0;
+        if (cu_worker_read(f,name,len) ||
+            cu_worker_read(f,&w.verified,sizeof(w.verified)) ||
+            cu_worker_read(f,w.results,sizeof(w.results))) {
+            free(name);
+            return DW_DLV_ERROR;
+        }
+        map[index] = -1;
+        if (index == 0) {
+            map[index] = 0;
+        } else {
+            for (c = 1; c <= compilers_detected_count; ++c) {
+                if (!strcmp(compilers_detected[c].name,name)) {
+                    map[index] = c;
+                    break;
+                }
+            }
+            if (map[index] < 0 &&
+                compilers_detected_count + 1 < COMPILER_TABLE_MAX) {
+                map[index] = ++compilers_detected_count;
+                pCompiler = &compilers_detected[map[index]];
+                reset_compiler_entry(pCompiler);
+                pCompiler->name = makename(name);
+            }
+        }
+        free(name);
+        if (map[index] < 0) {
+            continue;
+        }
+        pCompiler = &compilers_detected[map[index]];
+        pCompiler->verified |= w.verified;
+        for (c = 0; c < LAST_CATEGORY; ++c) {
+            pCompiler->results[c].checks += w.results[c].checks;
+            pCompiler->results[c].errors += w.results[c].errors;
+        }
+    }
+    for (index = 1; index <= compilers_targeted_count; ++index) {
+        boolean verified = FALSE;
+
+        if (cu_worker_read(f,&verified,sizeof(verified))) {
+            return DW_DLV_ERROR;
+        }
+        compilers_targeted[index].verified |= verified;
+    }
+    if (is_last) {
+        current_cu_is_checked_compiler = checked;
+        if (wcurrent > 0 && wcurrent <= wdetected &&
+            map[wcurrent] > 0) {
+            current_compiler = map[wcurrent];
+        } else {
+            current_compiler = wcurrent;
+        }
+    }
+    return DW_DLV_OK;
+}
+
+/*  -x cache= support (see cu_cache.c).  While one CU is
+    printed only the totals and the CU's own compiler
+    gain counts, so those are all a cached CU records.
+    New 2018. */
+void
+cu_cache_get_compiler_checks(struct cu_cache_checks_s *c)
+{
+    memset(c,0,sizeof(*c));
+    c->cc_check_error = check_error;
+    memcpy(c->cc_total,compilers_detected[0].results,
+        sizeof(c->cc_total));
+    if (current_compiler > 0 && current_compiler < COMPILER_TABLE_MAX) {
+        c->cc_verified = compilers_detected[current_compiler].verified;
+        memcpy(c->cc_compiler,
+            compilers_detected[current_compiler].results,
+            sizeof(c->cc_compiler));
+    }
+}
+
+void
+cu_cache_add_compiler_checks(struct cu_cache_checks_s *c)
+{
+    int index = 0;
+
+    check_error += c->cc_check_error;
+    for (index = 0; index < LAST_CATEGORY; ++index) {
+        compilers_detected[0].results[index].checks +=
+            c->cc_total[index].checks;
+        compilers_detected[0].results[index].errors +=
+            c->cc_total[index].errors;
+    }
+    if (current_compiler > 0 && current_compiler < COMPILER_TABLE_MAX) {
+        Compiler *pCompiler = &compilers_detected[current_compiler];
+
+        pCompiler->verified |= c->cc_verified;
+        for (index = 0; index < LAST_CATEGORY; ++index) {
+            pCompiler->results[index].checks +=
+                c->cc_compiler[index].checks;
+            pCompiler->results[index].errors +=
+                c->cc_compiler[index].errors;
+        }
+    }
+}
+
 /*  Making this a named string makes it simpler to change
     what the reset,or 'I do not know'  value is for
     CU name or producer name for PRINT_CU_INFO. */
@@ -3097,20 +3460,75 @@ void DWARF_CHECK_ERROR_PRINT_CU()
 
 /*  Sometimes is useful, just to know the kind of errors in an object file;
     not much interest in the number of errors; the specific case is just to
-    have a general idea about the DWARF quality in the file */
-char ** set_unique_errors = NULL;
-unsigned int set_unique_errors_entries = 0;
-unsigned int set_unique_errors_size = 0;
+    have a general idea about the DWARF quality in the file.
+    Broken objects can produce millions of errors, so the
+    messages are kept in a search tree (rather than being
+    compared one by one) and each records how often it was seen.
+    The array keeps the messages in the order first seen,
+    for the summary. */
+struct unique_error_s {
+    char *ue_text;
+    unsigned long ue_count;
+    /*  The last CU saved by -x cache= that saw it. */
+    unsigned long ue_cu_serial;
+};
+static void *unique_errors_tree = NULL;
+static struct unique_error_s **set_unique_errors = NULL;
+static unsigned int set_unique_errors_entries = 0;
+static unsigned int set_unique_errors_size = 0;
 #define SET_UNIQUE_ERRORS_DELTA 64
 
+/*  -x cache= support: the errors a CU being saved saw,
+    in the order first seen, each with whether it was
+    known before the CU and its count then.  New 2018. */
+struct unique_error_use_s {
+    struct unique_error_s *uu_entry;
+    boolean uu_known;
+    unsigned long uu_count_before;
+};
+static struct unique_error_use_s *unique_error_uses = NULL;
+static unsigned int unique_error_uses_count = 0;
+static unsigned int unique_error_uses_size = 0;
+static boolean unique_error_recording = FALSE;
+static boolean unique_error_record_failed = FALSE;
+static boolean unique_error_found_in = FALSE;
+static unsigned long unique_error_cu_serial = 0;
+
+static int
+unique_error_compare_func(const void *l, const void *r)
+{
+    const struct unique_error_s *ml = l;
+    const struct unique_error_s *mr = r;
+    return strcmp(ml->ue_text,mr->ue_text);
+}
+
+/*  The FNV-1a hash. Used only if dwarfdump is built
+    with the hashing dwarf_tsearch. */
+static unsigned long
+unique_error_hash_func(const void *keyp)
+{
+    const struct unique_error_s *e = keyp;
+    const unsigned char *cp = (const unsigned char *)e->ue_text;
+    unsigned long h = 2166136261UL;
+
+    for ( ; *cp; ++cp) {
+        h ^= *cp;
+        h *= 16777619UL;
+    }
+    return h;
+}
+
 /*  Create the space to store the unique error messages */
 void allocate_unique_errors_table(void)
 {
     if (!set_unique_errors) {
-        set_unique_errors = (char **)
-            malloc(SET_UNIQUE_ERRORS_DELTA * sizeof(char*));
+        set_unique_errors = (struct unique_error_s **)
+            malloc(SET_UNIQUE_ERRORS_DELTA *
+            sizeof(struct unique_error_s *));
         set_unique_errors_size = SET_UNIQUE_ERRORS_DELTA;
         set_unique_errors_entries = 0;
+        dwarf_initialize_search_hash(&unique_errors_tree,
+            unique_error_hash_func,0);
     }
 }
 
@@ -3124,39 +3542,316 @@ void dump_unique_errors_table(void)
     printf("Size   : %d\n",set_unique_errors_size);
     printf("Entries: %d\n",set_unique_errors_entries);
     for (index = 0; index < set_unique_errors_entries; ++index) {
-        printf("%3d: '%s'\n",index,set_unique_errors[index]);
+        printf("%3d: %lu '%s'\n",index,
+            set_unique_errors[index]->ue_count,
+            set_unique_errors[index]->ue_text);
     }
 }
 #endif
 
+/*  The entries themselves are freed through the array. */
+static void
+unique_error_free_func(UNUSEDARG void *nodep)
+{
+}
+
 /*  Release the space used to store the unique error messages */
 void release_unique_errors_table(void)
 {
     unsigned int index;
+
+    dwarf_tdestroy(unique_errors_tree,unique_error_free_func);
+    unique_errors_tree = 0;
     for (index = 0; index < set_unique_errors_entries; ++index) {
+        free(set_unique_errors[index]->ue_text);
         free(set_unique_errors[index]);
     }
     free(set_unique_errors);
     set_unique_errors = 0;
     set_unique_errors_entries = 0;
     set_unique_errors_size = 0;
+    free(unique_error_uses);
+    unique_error_uses = 0;
+    unique_error_uses_count = 0;
+    unique_error_uses_size = 0;
+}
+
+/*  Print each unique error with the number of times it was
+    seen. The messages have their own leading and trailing
+    newlines, which are dropped here. */
+static void
+print_unique_errors_summary(void)
+{
+    unsigned int index;
+
+    if (!set_unique_errors_entries) {
+        return;
+    }
+    printf("\n*** UNIQUE ERRORS ***\n");
+    printf("%10s  %s\n","Count","Error");
+    for (index = 0; index < set_unique_errors_entries; ++index) {
+        struct unique_error_s *e = set_unique_errors[index];
+        const char *text = e->ue_text;
+        size_t len = 0;
+
+        while (*text == '\n') {
+            ++text;
+        }
+        len = strlen(text);
+        while (len && text[len-1] == '\n') {
+            --len;
+        }
+        printf("%10lu  %.*s\n",e->ue_count,(int)len,text);
+    }
+}
+
+static struct unique_error_s *
+find_unique_error(char *text)
+{
+    struct unique_error_s key;
+    void *retval = 0;
+
+    key.ue_text = text;
+    key.ue_count = 0;
+    retval = dwarf_tfind(&key,&unique_errors_tree,
+        unique_error_compare_func);
+    return retval? *(struct unique_error_s **)retval: 0;
+}
+
+/*  Adds the (malloc'd) text to the table, which owns it
+    from then on, or frees it on failure. */
+static struct unique_error_s *
+insert_unique_error(char *text,unsigned long count)
+{
+    struct unique_error_s *entry = 0;
+    void *retval = 0;
+
+    /* Store the new text; check if we have space to store the error text */
+    if (set_unique_errors_entries + 1 >= set_unique_errors_size) {
+        struct unique_error_s **newset = 0;
+        unsigned int newsize = set_unique_errors_size +
+            SET_UNIQUE_ERRORS_DELTA;
+
+        newset = (struct unique_error_s **)realloc(set_unique_errors,
+            newsize * sizeof(struct unique_error_s *));
+        if (!newset) {
+            free(text);
+            return 0;
+        }
+        set_unique_errors = newset;
+        set_unique_errors_size = newsize;
+    }
+    entry = (struct unique_error_s *)malloc(sizeof(*entry));
+    if (!entry) {
+        free(text);
+        return 0;
+    }
+    entry->ue_text = text;
+    entry->ue_count = count;
+    entry->ue_cu_serial = 0;
+    retval = dwarf_tsearch(entry,&unique_errors_tree,
+        unique_error_compare_func);
+    if (!retval) {
+        free(text);
+        free(entry);
+        return 0;
+    }
+    set_unique_errors[set_unique_errors_entries] = entry;
+    ++set_unique_errors_entries;
+    return entry;
+}
+
+/*  Notes the first time the CU being saved sees an error. */
+static void
+record_unique_error_use(struct unique_error_s *entry,boolean known)
+{
+    struct unique_error_use_s *u = 0;
+
+    if (!unique_error_recording ||
+        entry->ue_cu_serial == unique_error_cu_serial) {
+        return;
+    }
+    entry->ue_cu_serial = unique_error_cu_serial;
+    if (unique_error_uses_count == unique_error_uses_size) {
+        unsigned int newsize = unique_error_uses_size +
+            SET_UNIQUE_ERRORS_DELTA;
+        struct unique_error_use_s *newuses =
+            (struct unique_error_use_s *)realloc(unique_error_uses,
+            newsize * sizeof(struct unique_error_use_s));
+
+        if (!newuses) {
+            unique_error_record_failed = TRUE;
+            return;
+        }
+        unique_error_uses = newuses;
+        unique_error_uses_size = newsize;
+    }
+    u = &unique_error_uses[unique_error_uses_count++];
+    u->uu_entry = entry;
+    u->uu_known = known;
+    u->uu_count_before = known? entry->ue_count: 0;
+}
+
+/*  -x cache= support (see cu_cache.c).  With -kG a CU
+    prints an error only if no earlier CU saw it, so a
+    saved CU keeps the errors it saw and whether each was
+    new, and is replayed only if the table agrees. */
+void
+cu_cache_begin_unique_errors(void)
+{
+    if (!glflags.gf_print_unique_errors) {
+        return;
+    }
+    ++unique_error_cu_serial;
+    unique_error_uses_count = 0;
+    unique_error_record_failed = FALSE;
+    unique_error_found_in = glflags.gf_found_error_message;
+    unique_error_recording = TRUE;
+}
+
+/*  Writes what the CU did to the table, if f. */
+int
+cu_cache_end_unique_errors(FILE *f)
+{
+    Dwarf_Unsigned count = 0;
+    boolean found_out = glflags.gf_found_error_message;
+    unsigned int i = 0;
+
+    if (unique_error_recording) {
+        count = unique_error_uses_count;
+        unique_error_recording = FALSE;
+        if (unique_error_record_failed) {
+            return DW_DLV_ERROR;
+        }
+    }
+    if (!f) {
+        return DW_DLV_ERROR;
+    }
+    if (cu_worker_write(f,&count,sizeof(count)) ||
+        cu_worker_write(f,&unique_error_found_in,
+            sizeof(unique_error_found_in)) ||
+        cu_worker_write(f,&found_out,sizeof(found_out))) {
+        return DW_DLV_ERROR;
+    }
+    for (i = 0; i < count; ++i) {
+        struct unique_error_use_s *u = &unique_error_uses[i];
+        Dwarf_Unsigned added = u->uu_entry->ue_count -
+            u->uu_count_before;
+        Dwarf_Unsigned len = strlen(u->uu_entry->ue_text);
+
+        if (cu_worker_write(f,&u->uu_known,sizeof(u->uu_known)) ||
+            cu_worker_write(f,&added,sizeof(added)) ||
+            cu_worker_write(f,&len,sizeof(len)) ||
+            cu_worker_write(f,u->uu_entry->ue_text,len)) {
+            return DW_DLV_ERROR;
+        }
+    }
+    return DW_DLV_OK;
+}
+
+struct unique_error_saved_s {
+    char *us_text;
+    boolean us_known;
+    Dwarf_Unsigned us_added;
+};
+
+static void
+free_unique_errors_saved(struct unique_error_saved_s *saved,
+    Dwarf_Unsigned count)
+{
+    Dwarf_Unsigned i = 0;
+
+    for (i = 0; i < count; ++i) {
+        free(saved[i].us_text);
+    }
+    free(saved);
+}
+
+/*  Applies what a saved CU did to the table.  Returns
+    DW_DLV_NO_ENTRY, having done nothing, if the table is
+    not as it was when the CU was saved. */
+int
+cu_cache_replay_unique_errors(FILE *f)
+{
+    Dwarf_Unsigned count = 0;
+    Dwarf_Unsigned i = 0;
+    boolean found_in = FALSE;
+    boolean found_out = FALSE;
+    struct unique_error_saved_s *saved = 0;
+
+    if (cu_worker_read(f,&count,sizeof(count)) ||
+        cu_worker_read(f,&found_in,sizeof(found_in)) ||
+        cu_worker_read(f,&found_out,sizeof(found_out)) ||
+        found_in != glflags.gf_found_error_message) {
+        return DW_DLV_NO_ENTRY;
+    }
+    if (count) {
+        if (!glflags.gf_print_unique_errors) {
+            return DW_DLV_NO_ENTRY;
+        }
+        saved = (struct unique_error_saved_s *)calloc(count,
+            sizeof(struct unique_error_saved_s));
+        if (!saved) {
+            return DW_DLV_NO_ENTRY;
+        }
+    }
+    for (i = 0; i < count; ++i) {
+        struct unique_error_saved_s *us = &saved[i];
+        Dwarf_Unsigned len = 0;
+
+        if (cu_worker_read(f,&us->us_known,sizeof(us->us_known)) ||
+            cu_worker_read(f,&us->us_added,sizeof(us->us_added)) ||
+            cu_worker_read(f,&len,sizeof(len)) ||
+            len > (Dwarf_Unsigned)INT_MAX ||
+            (us->us_text = (char *)malloc(len+1)) == 0 ||
+            cu_worker_read(f,us->us_text,len)) {
+            free_unique_errors_saved(saved,i+1);
+            return DW_DLV_NO_ENTRY;
+        }
+        us->us_text[len] = 0;
+        if (!find_unique_error(us->us_text) != !us->us_known) {
+            free_unique_errors_saved(saved,i+1);
+            return DW_DLV_NO_ENTRY;
+        }
+    }
+    for (i = 0; i < count; ++i) {
+        struct unique_error_saved_s *us = &saved[i];
+
+        if (us->us_known) {
+            find_unique_error(us->us_text)->ue_count += us->us_added;
+            continue;
+        }
+        if (!insert_unique_error(us->us_text,us->us_added)) {
+            saved[i].us_text = 0;
+            free_unique_errors_saved(saved,count);
+            return DW_DLV_ERROR;
+        }
+        /*  The table has it now. */
+        saved[i].us_text = 0;
+    }
+    free_unique_errors_saved(saved,count);
+    glflags.gf_found_error_message = found_out;
+    return DW_DLV_OK;
 }
 
 /*  Returns TRUE if the text is already in the set; otherwise FALSE */
 boolean add_to_unique_errors_table(char * error_text)
 {
-    unsigned int index;
     size_t len;
-    char * stored_text;
     char * filtered_text;
     char * start = NULL;
     char * end = NULL;
     char * pattern = "0x";
     char * white = " ";
     char * question = "?";
+    struct unique_error_s *entry = 0;
 
-    /* Create a copy of the incoming text */
-    filtered_text = makename(error_text);
+    /*  Create a copy of the incoming text. Not makename():
+        the copy is modified below. */
+    filtered_text = strdup(error_text);
+    if (!filtered_text) {
+        return FALSE;
+    }
     len = strlen(filtered_text);
 
     /*  Remove from the error_text, any hexadecimal numbers (start with 0x),
@@ -3171,27 +3866,23 @@ boolean add_to_unique_errors_table(char * error_text)
             end = filtered_text + len -1;
         }
         memset(start,*question,end - start);
-        start = strstr(filtered_text,pattern);
+        start = strstr(end,pattern);
     }
 
     /* Check if the error text is already in the table */
-    for (index = 0; index < set_unique_errors_entries; ++index) {
-        stored_text = set_unique_errors[index];
-        if (!strcmp(stored_text,filtered_text)) {
-            return TRUE;
-        }
+    entry = find_unique_error(filtered_text);
+    if (entry) {
+        record_unique_error_use(entry,TRUE);
+        entry->ue_count++;
+        free(filtered_text);
+        return TRUE;
     }
-
-    /* Store the new text; check if we have space to store the error text */
-    if (set_unique_errors_entries + 1 == set_unique_errors_size) {
-        set_unique_errors_size += SET_UNIQUE_ERRORS_DELTA;
-        set_unique_errors = (char **)realloc(set_unique_errors,
-            set_unique_errors_size * sizeof(char*));
+    entry = insert_unique_error(filtered_text,1);
+    if (!entry) {
+        unique_error_record_failed = TRUE;
+        return FALSE;
     }
-
-    set_unique_errors[set_unique_errors_entries] = filtered_text;
-    ++set_unique_errors_entries;
-
+    record_unique_error_use(entry,FALSE);
     return FALSE;
 }
 
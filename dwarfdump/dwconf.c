@@ -39,6 +39,8 @@
 #include <ctype.h>
 #include "dwconf.h"
 #include "makename.h"
+#include "esb.h"
+#include "outbuf.h"
 
 extern int verbose;
 
@@ -1395,29 +1397,31 @@ print_reg_from_config_data(Dwarf_Unsigned reg,
 {
     char *name = 0;
     if (reg == config_data->cf_cfa_reg) {
-        fputs("cfa",stdout);
+        outbuf_string("cfa");
         return;
     }
     if (reg == config_data->cf_undefined_val) {
-        fputs("u",stdout);
+        outbuf_char('u');
         return;
     }
     if (reg == config_data->cf_same_val) {
-        fputs("s",stdout);
+        outbuf_char('s');
         return;
     }
 
     if (config_data->cf_regs == 0 ||
         reg >= config_data->cf_named_regs_table_size) {
-        printf("r%" DW_PR_DUu "",reg);
+        outbuf_char('r');
+        outbuf_unsigned(reg,0);
         return;
     }
     name = config_data->cf_regs[reg];
     if (!name) {
         /* Can happen, the reg names table can be sparse. */
-        printf("r%" DW_PR_DUu "", reg);
+        outbuf_char('r');
+        outbuf_unsigned(reg,0);
         return;
     }
-    fputs(name,stdout);
+    outbuf_string(name);
     return;
 }
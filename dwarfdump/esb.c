@@ -273,6 +273,7 @@ esb_get_allocated_size(struct esb_s *data)
     return data->esb_allocated_size;
 }
 
+#ifdef _WIN32
 /*  Make more room. Leaving  contents unchanged, effectively.
     The NUL byte at end has room and this preserves that room.
 */
@@ -280,21 +281,13 @@ static void
 esb_allocate_more_if_needed(struct esb_s *data,
     const char *in_string,va_list ap)
 {
-#ifndef _WIN32
-    static char a_buffer[512];
-#endif /* _WIN32*/
-
     int netlen = 0;
     va_list ap_copy;
 
     /* Preserve the original argument list, to be used a second time */
     va_copy(ap_copy,ap);
 
-#ifdef _WIN32
     netlen = vfprintf(null_device_handle,in_string,ap_copy);
-#else
-    netlen = vsnprintf(a_buffer,sizeof(a_buffer),in_string,ap_copy);
-#endif /* _WIN32*/
 
     /*  "The object ap may be passed as an argument to another
         function; if that function invokes the va_arg()
@@ -307,16 +300,47 @@ esb_allocate_more_if_needed(struct esb_s *data,
     /* Allocate enough space to hold the full text */
     esb_force_allocation(data,netlen + 1);
 }
+#endif /* _WIN32 */
 
-/*  Append a formatted string */
+/*  Append a formatted string.
+    Except on Windows (where vsnprintf does not report
+    the length needed) we format straight into the space
+    left and only format a second time when the
+    string has to grow. */
 void
 esb_append_printf_ap(struct esb_s *data,const char *in_string,va_list ap)
 {
     int netlen = 0;
     int expandedlen = 0;
 
+#ifdef _WIN32
     /* Allocate enough space for the input string */
     esb_allocate_more_if_needed(data,in_string,ap);
+#else
+    va_list ap_copy;
+
+    if (data->esb_allocated_size == 0) {
+        init_esb_string(data, alloc_size);
+    }
+    netlen = data->esb_allocated_size - data->esb_used_bytes;
+    va_copy(ap_copy,ap);
+    expandedlen =
+        vsnprintf(&data->esb_string[data->esb_used_bytes],
+        netlen,in_string,ap_copy);
+    va_end(ap_copy);
+    if (expandedlen < 0) {
+        /*  There was an error.
+            Do nothing. */
+        data->esb_string[data->esb_used_bytes] = 0;
+        return;
+    }
+    if (expandedlen < netlen) {
+        data->esb_used_bytes += expandedlen;
+        return;
+    }
+    /* Allocate enough space to hold the full text */
+    esb_force_allocation(data,expandedlen + 1);
+#endif /* _WIN32 */
 
     netlen = data->esb_allocated_size - data->esb_used_bytes;
     expandedlen =
@@ -352,6 +376,85 @@ esb_append_printf(struct esb_s *data,const char *in_string, ...)
     va_end(ap);
 }
 
+/*  Writes the digits of v backwards, ending just before
+    bufend, and returns the first character.  No format
+    string is parsed.  base is 10 or 16 (lowercase),
+    mindigits pads with leading zeros.  The caller
+    provides at least ESB_NUMBER_BUF_LEN bytes.  */
+char *
+esb_format_unsigned(char *bufend, unsigned long long v,
+    unsigned base, unsigned mindigits)
+{
+    static const char digits[] = "0123456789abcdef";
+    char *p = bufend;
+    char *limit = 0;
+
+    if (mindigits > ESB_NUMBER_BUF_LEN - 1) {
+        mindigits = ESB_NUMBER_BUF_LEN - 1;
+    }
+    limit = bufend - mindigits;
+    if (base == 16) {
+        do {
+            *--p = digits[v & 0xf];
+            v >>= 4;
+        } while (v);
+    } else {
+        do {
+            *--p = digits[v % 10];
+            v /= 10;
+        } while (v);
+    }
+    while (p > limit) {
+        *--p = '0';
+    }
+    return p;
+}
+
+/*  Same as esb_append_printf(data,"%llu",v). */
+void
+esb_append_unsigned(struct esb_s *data, unsigned long long v)
+{
+    char buf[ESB_NUMBER_BUF_LEN];
+    char *end = buf + sizeof(buf);
+    char *p = esb_format_unsigned(end,v,10,0);
+
+    esb_appendn_internal(data,p,end - p);
+}
+
+/*  Same as esb_append_printf(data,"%lld",v). */
+void
+esb_append_signed(struct esb_s *data, long long v)
+{
+    char buf[ESB_NUMBER_BUF_LEN];
+    char *end = buf + sizeof(buf);
+    char *p = 0;
+
+    if (v < 0) {
+        /*  Negate as unsigned so the most negative value
+            works too. */
+        p = esb_format_unsigned(end,
+            0ULL - (unsigned long long)v,10,0);
+        *--p = '-';
+    } else {
+        p = esb_format_unsigned(end,(unsigned long long)v,10,0);
+    }
+    esb_appendn_internal(data,p,end - p);
+}
+
+/*  Same as esb_append_printf(data,"0x%0*llx",mindigits,v). */
+void
+esb_append_hex(struct esb_s *data, unsigned long long v,
+    unsigned mindigits)
+{
+    char buf[ESB_NUMBER_BUF_LEN + 2];
+    char *end = buf + sizeof(buf);
+    char *p = esb_format_unsigned(end,v,16,mindigits);
+
+    *--p = 'x';
+    *--p = '0';
+    esb_appendn_internal(data,p,end - p);
+}
+
 /*  Get a copy of the internal data buffer.
     It is up to the code calling this
     to free() the string using the
@@ -482,6 +585,25 @@ int main()
         validate_esb(14,&d5,19,50,"aaaa insert me bbbb");
         esb_destructor(&d5);
     }
+    {
+        struct esb_s d;
+        esb_constructor(&d);
+
+        esb_append_unsigned(&d,0);
+        esb_append(&d," ");
+        esb_append_unsigned(&d,18446744073709551615ULL);
+        validate_esb(17,&d,22,23,"0 18446744073709551615");
+        esb_empty_string(&d);
+        esb_append_signed(&d,-12);
+        esb_append(&d," ");
+        esb_append_signed(&d,-9223372036854775807LL - 1);
+        validate_esb(18,&d,24,43,"-12 -9223372036854775808");
+        esb_empty_string(&d);
+        esb_append_hex(&d,0x1f,8);
+        esb_append_hex(&d,0xabcdef,0);
+        validate_esb(19,&d,18,43,"0x0000001f0xabcdef");
+        esb_destructor(&d);
+    }
     {
         struct esb_s d;
         struct esb_s e;
@@ -90,6 +90,17 @@ void esb_append_printf(struct esb_s *data,const char *format, ...);
     and should not be touched. */
 void esb_append_printf_ap(struct esb_s *data,const char *format,va_list ap);
 
+/*  Integers appended without going through a format
+    string.  New 2018. */
+#define ESB_NUMBER_BUF_LEN 24
+char * esb_format_unsigned(char *bufend, unsigned long long v,
+    unsigned base, unsigned mindigits);
+void esb_append_unsigned(struct esb_s *data, unsigned long long v);
+void esb_append_signed(struct esb_s *data, long long v);
+/* Appends 0x and at least mindigits hex digits. */
+void esb_append_hex(struct esb_s *data, unsigned long long v,
+    unsigned mindigits);
+
 /* Get a copy of the internal data buffer */
 char * esb_get_copy(struct esb_s *data);
 
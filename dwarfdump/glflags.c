@@ -151,4 +151,8 @@ init_global_flags(void)
     glflags.gf_cu_name_flag         = FALSE;
     glflags.gf_show_global_offsets  = FALSE;
     glflags.gf_display_offsets      = TRUE;
+    glflags.gf_cu_workers           = 0;
+    glflags.gf_record_format        = 0;
+    glflags.gf_print_stats          = FALSE;
+    glflags.gf_search_global        = FALSE;
 }
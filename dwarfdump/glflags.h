@@ -143,6 +143,22 @@ struct glflags_s {
     boolean gf_cu_name_flag;
     boolean gf_show_global_offsets;
     boolean gf_display_offsets;
+
+    /*  -x workers=<n>: print .debug_info and .debug_types
+        with n worker processes. 0 or 1 means serially. */
+    int     gf_cu_workers;
+
+    /*  -x format=jsonl or -x format=binary:
+        RECORD_FORMAT_* from records.h. */
+    int     gf_record_format;
+
+    /*  -x stats: print dwarf_print_memory_stats() for
+        each object before dwarf_finish(). */
+    boolean gf_print_stats;
+
+    /*  -S global=: search_name_text only matches external
+        function and variable definitions. */
+    boolean gf_search_global;
 };
 
 extern struct glflags_s glflags;
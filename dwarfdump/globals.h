@@ -187,12 +187,16 @@ extern void calculate_attributes_usage(Dwarf_Half attr,Dwarf_Half theform,
 extern const char *search_any_text;
 extern const char *search_match_text;
 extern const char *search_regex_text;
+extern const char *search_name_text;
 extern int search_occurrences;
 #ifdef HAVE_REGEX
 extern regex_t search_re;
 #endif
 extern boolean is_strstrnocase(const char *data, const char *pattern);
 
+/* -x cache=<path>: the per-CU results cache, see cu_cache.h */
+extern const char *cu_cache_path;
+
 /* Options to enable debug tracing. */
 #define MAX_TRACE_LEVEL 10
 extern int nTrace[MAX_TRACE_LEVEL + 1];
@@ -441,7 +445,7 @@ extern Dwarf_Die current_cu_die_for_print_frames; /* This is
 extern void printreg(Dwarf_Unsigned reg,struct dwconf_s *config_data);
 
 int get_proc_name(Dwarf_Debug dbg, Dwarf_Die die, Dwarf_Addr low_pc,
-    char *proc_name_buf, int proc_name_buf_len, void **pcMap);
+    char *proc_name_buf, int proc_name_buf_len);
 
 void get_attr_value(Dwarf_Debug dbg, Dwarf_Half tag,
     Dwarf_Die die,
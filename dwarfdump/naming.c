@@ -256,5 +256,11 @@ const char * get_ADDR_name(unsigned int val_in,int printonerr)
    int res = dwarf_get_ADDR_name(val_in,&v);
    return ellipname(res,val_in,v,"ADDR",printonerr);
 }
+const char * get_IDX_name(unsigned int val_in,int printonerr)
+{
+   const char *v = 0;
+   int res = dwarf_get_IDX_name(val_in,&v);
+   return ellipname(res,val_in,v,"IDX",printonerr);
+}
 
 
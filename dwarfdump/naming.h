@@ -61,6 +61,7 @@ extern const char * get_EH_name(unsigned int val_in,int printonerr);
 extern const char * get_FRAME_name(unsigned int val_in,int printonerr);
 extern const char * get_CHILDREN_name(unsigned int val_in,int printonerr);
 extern const char * get_ADDR_name(unsigned int val_in,int printonerr);
+extern const char * get_IDX_name(unsigned int val_in,int printonerr);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,150 @@
+/*
+  Copyright 2018 David Anderson. All rights reserved.
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of version 2 of the GNU General Public License as
+  published by the Free Software Foundation.
+
+  This program is distributed in the hope that it would be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  Further, this software is distributed without any warranty that it is
+  free of the rightful claim of any third person regarding infringement
+  or the like.  Any license provided herein, whether implied or
+  otherwise, applies only to this software file.  Patent licenses, if
+  any, provided herein do not apply to combinations of this program with
+  other software, or any other product whatsoever.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write the Free Software Foundation, Inc., 51
+  Franklin Street - Fifth Floor, Boston MA 02110-1301, USA.
+*/
+
+/*  See outbuf.h. */
+
+#include "globals.h"
+#ifdef HAVE_UNISTD_H
+#include <unistd.h> /* for isatty() */
+#endif
+#include "esb.h"
+#include "outbuf.h"
+
+/*  Big enough that a full -a dump is written in few
+    system calls. */
+#define OUTBUF_SIZE (256*1024)
+
+#if defined(__GLIBC__)
+#define OUTBUF_WRITE(p,n) fwrite_unlocked((p),1,(n),stdout)
+#define OUTBUF_PUTC(c)    putc_unlocked((c),stdout)
+#else
+#define OUTBUF_WRITE(p,n) fwrite((p),1,(n),stdout)
+#define OUTBUF_PUTC(c)    putc((c),stdout)
+#endif
+
+static const char outbuf_blanks[] = "                                ";
+
+void
+outbuf_init(void)
+{
+#if !defined(_WIN32) && defined(HAVE_UNISTD_H)
+    /*  Windows keeps stdout unbuffered, see main(). */
+    if (!isatty(fileno(stdout))) {
+        setvbuf(stdout,NULL,_IOFBF,OUTBUF_SIZE);
+    }
+#endif
+}
+
+void
+outbuf_flush(void)
+{
+    fflush(stdout);
+}
+
+void
+outbuf_char(int c)
+{
+    OUTBUF_PUTC(c);
+}
+
+void
+outbuf_string(const char *s)
+{
+    OUTBUF_WRITE(s,strlen(s));
+}
+
+void
+outbuf_esb(struct esb_s *e)
+{
+    OUTBUF_WRITE(esb_get_string(e),esb_string_len(e));
+}
+
+void
+outbuf_spaces(unsigned n)
+{
+    while (n > 0) {
+        unsigned c = n;
+
+        if (c > sizeof(outbuf_blanks) - 1) {
+            c = sizeof(outbuf_blanks) - 1;
+        }
+        OUTBUF_WRITE(outbuf_blanks,c);
+        n -= c;
+    }
+}
+
+void
+outbuf_string_padded(const char *s, unsigned width)
+{
+    size_t len = strlen(s);
+
+    OUTBUF_WRITE(s,len);
+    if (len < width) {
+        outbuf_spaces(width - len);
+    }
+}
+
+void
+outbuf_unsigned(Dwarf_Unsigned v, unsigned width)
+{
+    char buf[ESB_NUMBER_BUF_LEN];
+    char *end = buf + sizeof(buf);
+    char *p = esb_format_unsigned(end,v,10,0);
+
+    if ((unsigned)(end - p) < width) {
+        outbuf_spaces(width - (end - p));
+    }
+    OUTBUF_WRITE(p,end - p);
+}
+
+void
+outbuf_signed(Dwarf_Signed v, unsigned width)
+{
+    char buf[ESB_NUMBER_BUF_LEN];
+    char *end = buf + sizeof(buf);
+    char *p = 0;
+
+    if (v < 0) {
+        p = esb_format_unsigned(end,
+            0ULL - (Dwarf_Unsigned)v,10,0);
+        *--p = '-';
+    } else {
+        p = esb_format_unsigned(end,(Dwarf_Unsigned)v,10,0);
+    }
+    if ((unsigned)(end - p) < width) {
+        outbuf_spaces(width - (end - p));
+    }
+    OUTBUF_WRITE(p,end - p);
+}
+
+void
+outbuf_hex(Dwarf_Unsigned v, unsigned mindigits)
+{
+    char buf[ESB_NUMBER_BUF_LEN + 2];
+    char *end = buf + sizeof(buf);
+    char *p = esb_format_unsigned(end,v,16,mindigits);
+
+    *--p = 'x';
+    *--p = '0';
+    OUTBUF_WRITE(p,end - p);
+}
@@ -0,0 +1,56 @@
+/*
+  Copyright 2018 David Anderson. All rights reserved.
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of version 2 of the GNU General Public License as
+  published by the Free Software Foundation.
+
+  This program is distributed in the hope that it would be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  Further, this software is distributed without any warranty that it is
+  free of the rightful claim of any third person regarding infringement
+  or the like.  Any license provided herein, whether implied or
+  otherwise, applies only to this software file.  Patent licenses, if
+  any, provided herein do not apply to combinations of this program with
+  other software, or any other product whatsoever.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write the Free Software Foundation, Inc., 51
+  Franklin Street - Fifth Floor, Boston MA 02110-1301, USA.
+*/
+#ifndef OUTBUF_H
+#define OUTBUF_H
+
+/*  Output for the busiest print paths.  New 2018.
+    All of it goes to stdout through the stdio buffer
+    (so it stays in order with the printf() calls
+    elsewhere), but without taking the stream lock on
+    each call and with integers formatted directly
+    rather than by parsing a format string.
+    outbuf_init() gives stdout a large buffer when it
+    is not a terminal. */
+
+/*  DW_PR_XZEROS is either "08" or "": the hex digits
+    the 0x%08llx style offsets are padded to. */
+#define OUTBUF_XZEROS_DIGITS ((sizeof(DW_PR_XZEROS) > 1)? 8: 0)
+
+void outbuf_init(void);
+void outbuf_flush(void);
+
+void outbuf_char(int c);
+void outbuf_string(const char *s);
+void outbuf_esb(struct esb_s *e);
+/*  Same as printf("%*s",n," ") for n > 0. */
+void outbuf_spaces(unsigned n);
+/*  Same as printf("%-*s",width,s). */
+void outbuf_string_padded(const char *s, unsigned width);
+/*  Same as printf("%*llu",width,v). */
+void outbuf_unsigned(Dwarf_Unsigned v, unsigned width);
+/*  Same as printf("%*lld",width,v). */
+void outbuf_signed(Dwarf_Signed v, unsigned width);
+/*  Same as printf("0x%0*llx",mindigits,v). */
+void outbuf_hex(Dwarf_Unsigned v, unsigned mindigits);
+
+#endif /* OUTBUF_H */
@@ -35,6 +35,8 @@
 #include "naming.h"
 #include "dwconf.h"
 #include "esb.h"
+#include "records.h"
+#include "outbuf.h"
 
 #include "print_sections.h"
 
@@ -201,8 +203,14 @@ print_aranges(Dwarf_Debug dbg)
                             cures3, pa_error);
                     }
 
+                    if (RECORDING && glflags.gf_do_print_dwarf) {
+                        /*  The record replaces the CU DIE and
+                            arange text. */
+                        record_arange(cu_die_offset,segment,
+                            start,length);
+                    }
                     /* Print the CU information if different.  */
-                    if (prev_off != off || first_cu) {
+                    if (!RECORDING && (prev_off != off || first_cu)) {
                         first_cu = FALSE;
                         prev_off = off;
                         /*  We are faking the indent level. We do not know
@@ -233,30 +241,29 @@ print_aranges(Dwarf_Debug dbg)
                         }
                     }
 
-                    if (glflags.gf_do_print_dwarf) {
+                    if (glflags.gf_do_print_dwarf && !RECORDING) {
                         /* Print current aranges record */
                         if (segment_entry_size) {
-                            printf(
-                                "\narange starts at seg,off 0x%"
-                                DW_PR_XZEROS DW_PR_DUx
-                                ",0x%" DW_PR_XZEROS DW_PR_DUx
-                                ", ",
-                                segment,
-                                (Dwarf_Unsigned)start);
+                            outbuf_string("\narange starts at seg,off ");
+                            outbuf_hex(segment,OUTBUF_XZEROS_DIGITS);
+                            outbuf_char(',');
                         } else {
-                            printf("\narange starts at 0x%"
-                                DW_PR_XZEROS DW_PR_DUx ", ",
-                                (Dwarf_Unsigned)start);
+                            outbuf_string("\narange starts at ");
                         }
-                        printf("length of 0x%" DW_PR_XZEROS DW_PR_DUx
-                            ", cu_die_offset = 0x%" DW_PR_XZEROS DW_PR_DUx,
-                            length,
-                            (Dwarf_Unsigned)cu_die_offset);
+                        outbuf_hex((Dwarf_Unsigned)start,
+                            OUTBUF_XZEROS_DIGITS);
+                        outbuf_string(", length of ");
+                        outbuf_hex(length,OUTBUF_XZEROS_DIGITS);
+                        outbuf_string(", cu_die_offset = ");
+                        outbuf_hex((Dwarf_Unsigned)cu_die_offset,
+                            OUTBUF_XZEROS_DIGITS);
 
                     }
-                    if (verbose && glflags.gf_do_print_dwarf) {
-                        printf(" cuhdr 0x%" DW_PR_XZEROS DW_PR_DUx "\n",
-                            (Dwarf_Unsigned)off);
+                    if (verbose && glflags.gf_do_print_dwarf &&
+                        !RECORDING) {
+                        outbuf_string(" cuhdr ");
+                        outbuf_hex((Dwarf_Unsigned)off,OUTBUF_XZEROS_DIGITS);
+                        outbuf_char('\n');
                     }
                     dwarf_dealloc(dbg, cu_die, DW_DLA_DIE);
                     cu_die = 0;
@@ -264,8 +271,8 @@ print_aranges(Dwarf_Debug dbg)
                     /*  Must be a range end. We really do want to print
                         this as there is a real record here, an
                         'arange end' record. */
-                    if (glflags.gf_do_print_dwarf) {
-                        printf("\narange end\n");
+                    if (glflags.gf_do_print_dwarf && !RECORDING) {
+                        outbuf_string("\narange end\n");
                     }
                 }/* end start||length test */
             }  /* end aires DW_DLV_OK test */
@@ -37,6 +37,12 @@
 #include "macrocheck.h"
 #include "helpertree.h"
 #include "tag_common.h"
+#include "cu_workers.h"
+#include "cu_cache.h"
+#include "die_summary.h"
+#include "outbuf.h"
+#include "records.h"
+#include "search_index.h"
 
 /*  Traverse a DIE and attributes to check self references */
 static boolean traverse_one_die(Dwarf_Debug dbg,
@@ -104,6 +110,8 @@ static void formx_data16(Dwarf_Form_Data16 * u, struct esb_s *esbp,
     Dwarf_Bool hex_format);
 
 static void formx_signed(Dwarf_Signed s, struct esb_s *esbp);
+static int encoding_signedness(Dwarf_Debug dbg,
+    Dwarf_Attribute encodingattr);
 
 static int pd_dwarf_names_print_on_error = 1;
 
@@ -622,23 +630,8 @@ static int
 print_one_die_section(Dwarf_Debug dbg,Dwarf_Bool is_info,
     Dwarf_Error *pod_err)
 {
-    Dwarf_Unsigned cu_header_length = 0;
-    Dwarf_Unsigned abbrev_offset = 0;
-    Dwarf_Half version_stamp = 0;
-    Dwarf_Half address_size = 0;
-    Dwarf_Half extension_size = 0;
-    Dwarf_Half length_size = 0;
-    Dwarf_Sig8 signature;
-    Dwarf_Unsigned typeoffset = 0;
-    Dwarf_Unsigned next_cu_offset = 0;
-    unsigned loop_count = 0;
-    int nres = DW_DLV_OK;
-    int   cu_count = 0;
-    char * cu_short_name = NULL;
-    char * cu_long_name = NULL;
     const char * section_name = 0;
     int res = 0;
-    Dwarf_Off dieprint_cu_goffset = 0;
 
     current_section_id = is_info?DEBUG_INFO:DEBUG_TYPES;
     res = dwarf_get_die_section_name(dbg, is_info,
@@ -662,6 +655,62 @@ print_one_die_section(Dwarf_Debug dbg,Dwarf_Bool is_info,
     if (print_as_info_or_cu() && glflags.gf_do_print_dwarf) {
         printf("\n%s\n",sanitized(section_name));
     }
+    if (cu_workers_usable()) {
+        if (print_die_section_in_workers(dbg,is_info,&res,pod_err)) {
+            return res;
+        }
+    }
+    return print_die_section_cus(dbg,is_info,NULL,pod_err);
+}
+
+/*  Does the CU have macro data?  Printing and checking
+    macros carries state from one CU to the next. */
+static boolean
+cu_die_has_macros(Dwarf_Debug dbg,Dwarf_Die cu_die)
+{
+    static const Dwarf_Half macattrs[] = {
+        DW_AT_macro_info, DW_AT_macros, DW_AT_GNU_macros, 0};
+    int i = 0;
+
+    for (i = 0; macattrs[i]; ++i) {
+        Dwarf_Bool has = FALSE;
+        Dwarf_Error herr = 0;
+        int hres = dwarf_hasattr(cu_die,macattrs[i],&has,&herr);
+
+        if (hres == DW_DLV_ERROR) {
+            dwarf_dealloc(dbg,herr,DW_DLA_ERROR);
+            return TRUE;
+        }
+        if (hres == DW_DLV_OK && has) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/*  Print the CUs of one section.  If range is non-null
+    this is a worker (see cu_workers.c) and only the
+    CUs in the range are printed. */
+int
+print_die_section_cus(Dwarf_Debug dbg,Dwarf_Bool is_info,
+    struct cu_worker_range_s *range,
+    Dwarf_Error *pod_err)
+{
+    Dwarf_Unsigned cu_header_length = 0;
+    Dwarf_Unsigned abbrev_offset = 0;
+    Dwarf_Half version_stamp = 0;
+    Dwarf_Half address_size = 0;
+    Dwarf_Half extension_size = 0;
+    Dwarf_Half length_size = 0;
+    Dwarf_Sig8 signature;
+    Dwarf_Unsigned typeoffset = 0;
+    Dwarf_Unsigned next_cu_offset = 0;
+    unsigned loop_count = 0;
+    int nres = DW_DLV_OK;
+    int   cu_count = 0;
+    char * cu_short_name = NULL;
+    char * cu_long_name = NULL;
+    Dwarf_Off dieprint_cu_goffset = 0;
 
     /* Loop until it fails.  */
     for (;;++loop_count) {
@@ -671,6 +720,10 @@ print_one_die_section(Dwarf_Debug dbg,Dwarf_Bool is_info,
         int fission_data_result = 0;
         Dwarf_Half cu_type = 0;
 
+        if (range && cu_count > range->cw_last) {
+            nres = DW_DLV_NO_ENTRY;
+            break;
+        }
         memset(&fission_data,0,sizeof(fission_data));
         nres = dwarf_next_cu_header_d(dbg,
             is_info,
@@ -692,6 +745,19 @@ print_one_die_section(Dwarf_Debug dbg,Dwarf_Bool is_info,
             dieprint_cu_goffset = 0;
             break;
         }
+        if (range) {
+            int start = range->cw_replay >= 0?
+                range->cw_replay:range->cw_first;
+
+            if (cu_count < start) {
+                ++cu_count;
+                dieprint_cu_goffset = next_cu_offset;
+                continue;
+            }
+            if (cu_count == range->cw_first) {
+                cu_worker_begin_range(range);
+            }
+        }
         /*  Regardless of any options used, get basic
             information about the current CU: producer, name */
         sres = dwarf_siblingof_b(dbg, NULL,is_info, &cu_die, pod_err);
@@ -714,6 +780,15 @@ print_one_die_section(Dwarf_Debug dbg,Dwarf_Bool is_info,
                 continue;
             }
         }
+        if (search_name_text &&
+            search_index_skip_cu(is_info,DIE_CU_overall_offset)) {
+            /*  The name index says no DIE here has the name. */
+            dwarf_dealloc(dbg, cu_die, DW_DLA_DIE);
+            cu_die = 0;
+            ++cu_count;
+            dieprint_cu_goffset = next_cu_offset;
+            continue;
+        }
 
         {
         /* Get producer name for this CU and update compiler list */
@@ -745,6 +820,21 @@ print_one_die_section(Dwarf_Debug dbg,Dwarf_Bool is_info,
             cu_die = 0;
             continue;
         }
+        /*  -x cache=: a CU unchanged since the last run
+            is replayed; one with macro data is left alone
+            as macros carry state from CU to CU. */
+        if (cu_cache_active() &&
+            !((glflags.gf_macro_flag || glflags.gf_macinfo_flag ||
+            glflags.gf_check_macros) && cu_die_has_macros(dbg,cu_die)) &&
+            cu_cache_begin_cu(dbg,is_info,cu_die,
+                DIE_CU_overall_offset - DIE_CU_offset,
+                next_cu_offset,abbrev_offset)) {
+            dwarf_dealloc(dbg, cu_die, DW_DLA_DIE);
+            ++cu_count;
+            dieprint_cu_goffset = next_cu_offset;
+            cu_die = 0;
+            continue;
+        }
         fission_data_result = dwarf_get_debugfission_for_die(cu_die,
             &fission_data,pod_err);
         if (fission_data_result == DW_DLV_ERROR) {
@@ -839,6 +929,8 @@ print_one_die_section(Dwarf_Debug dbg,Dwarf_Bool is_info,
                 DIE_CU_overall_offset = DIE_overall_offset;
                 DIE_CU_offset = DIE_offset;
                 dieprint_cu_goffset = DIE_overall_offset;
+                die_summary_begin_cu(dbg,is_info,
+                    DIE_overall_offset - DIE_offset,next_cu_offset);
                 print_die_and_children(dbg, cu_die,
                     dieprint_cu_goffset,is_info, srcfiles, cnt);
                 if (srcf == DW_DLV_OK) {
@@ -867,6 +959,11 @@ print_one_die_section(Dwarf_Debug dbg,Dwarf_Bool is_info,
                 print_line_numbers_this_cu(dbg, cu_die);
                 current_section_id = oldsection;
             }
+            if (range && (glflags.gf_macro_flag ||
+                glflags.gf_macinfo_flag || glflags.gf_check_macros) &&
+                cu_die_has_macros(dbg,cu_die)) {
+                range->cw_unmergeable = TRUE;
+            }
             if (glflags.gf_macro_flag || glflags.gf_check_macros) {
                 Dwarf_Bool in_import_list = FALSE;
                 Dwarf_Unsigned import_offset = 0;
@@ -904,6 +1001,7 @@ print_one_die_section(Dwarf_Debug dbg,Dwarf_Bool is_info,
         } else {
             print_error(dbg, "Regetting cu_die", sres, *pod_err);
         }
+        cu_cache_end_cu(dbg);
         ++cu_count;
         dieprint_cu_goffset = next_cu_offset;
     }
@@ -1257,6 +1355,8 @@ print_one_die(Dwarf_Debug dbg, Dwarf_Die die,
     int atres = 0;
     int abbrev_code = dwarf_die_abbrev_code(die);
     boolean attribute_matched = FALSE;
+    int signedness = 0;
+    boolean saw_encoding = FALSE;
     Dwarf_Error podie_err = 0;
 
     /* Print using indentation
@@ -1317,6 +1417,11 @@ print_one_die(Dwarf_Debug dbg, Dwarf_Die die,
         if (!ignore_die_stack) {
             die_stack[die_indent_level].already_printed_ = TRUE;
         }
+        if (RECORDING) {
+            /*  The record replaces all the text. */
+            record_die(dbg,die,overall_offset,die_indent_level,tag);
+            return FALSE;
+        }
         if (die_indent_level == 0) {
             print_cu_hdr_cudie(dbg,die, overall_offset, offset);
         } else if (local_symbols_already_began == FALSE &&
@@ -1329,7 +1434,9 @@ print_one_die(Dwarf_Debug dbg, Dwarf_Die die,
         /* Print just the Tags and Attributes */
         if (!glflags.gf_display_offsets) {
             /* Print using indentation */
-            printf("%*s%s\n",die_stack_indent_level * 2 + 2," ",tagname);
+            outbuf_spaces(die_stack_indent_level * 2 + 2);
+            outbuf_string(tagname);
+            outbuf_char('\n');
         } else {
             if (dense) {
                 if (glflags.gf_show_global_offsets) {
@@ -1382,19 +1489,19 @@ print_one_die(Dwarf_Debug dbg, Dwarf_Die die,
                     printf(">");
                 }
             } else {
+                outbuf_char('<');
+                outbuf_signed(die_indent_level,2);
+                outbuf_string("><");
+                outbuf_hex(offset,OUTBUF_XZEROS_DIGITS);
                 if (glflags.gf_show_global_offsets) {
-                    printf("<%2d><0x%" DW_PR_XZEROS DW_PR_DUx
-                        " GOFF=0x%" DW_PR_XZEROS DW_PR_DUx ">",
-                        die_indent_level, (Dwarf_Unsigned)offset,
-                        (Dwarf_Unsigned)overall_offset);
-                } else {
-                    printf("<%2d><0x%" DW_PR_XZEROS DW_PR_DUx ">",
-                        die_indent_level,
-                        (Dwarf_Unsigned)offset);
+                    outbuf_string(" GOFF=");
+                    outbuf_hex(overall_offset,OUTBUF_XZEROS_DIGITS);
                 }
+                outbuf_char('>');
 
                 /* Print using indentation */
-                printf("%*s%s",die_indent_level * 2 + 2," ",tagname);
+                outbuf_spaces(die_indent_level * 2 + 2);
+                outbuf_string(tagname);
                 if (verbose) {
                     Dwarf_Off agoff = 0;
                     Dwarf_Unsigned acount = 0;
@@ -1467,9 +1574,15 @@ print_one_die(Dwarf_Debug dbg, Dwarf_Die die,
                 }
             }
 
+            if (attr == DW_AT_encoding && !saw_encoding) {
+                /*  For die_summary_record() */
+                signedness = encoding_signedness(dbg,atlist[i]);
+                saw_encoding = TRUE;
+            }
+
             /* Print using indentation */
             if (!dense && PRINTING_DIES && print_information) {
-                printf("%*s",die_indent_level * 2 + 2 + nColumn," ");
+                outbuf_spaces(die_indent_level * 2 + 2 + nColumn);
             }
 
             {
@@ -1498,9 +1611,13 @@ print_one_die(Dwarf_Debug dbg, Dwarf_Die die,
     if (atres == DW_DLV_OK) {
         dwarf_dealloc(dbg, atlist, DW_DLA_LIST);
     }
+    if (tres == DW_DLV_OK && ores == DW_DLV_OK) {
+        die_summary_record(dbg,dwarf_get_die_infotypes_flag(die),
+            overall_offset,tag,signedness);
+    }
 
     if (PRINTING_DIES && dense && print_information) {
-        printf("\n");
+        outbuf_char('\n');
     }
     return attribute_matched;
 }
@@ -1768,7 +1885,8 @@ is_location_form(int form)
         form == DW_FORM_block ||
         form == DW_FORM_data4 ||
         form == DW_FORM_data8 ||
-        form == DW_FORM_sec_offset) {
+        form == DW_FORM_sec_offset ||
+        form == DW_FORM_loclistx) {
         return TRUE;
     }
     return FALSE;
@@ -2052,6 +2170,109 @@ traverse_one_die(Dwarf_Debug dbg,
 }
 
 
+/*  DWARF5 DW_AT_ranges refer to .debug_rnglists
+    (possibly by DW_FORM_rnglistx index), not .debug_ranges. */
+#define RNGLIST_LOCAL_COUNT 32
+static void
+print_rnglist_attribute(Dwarf_Debug dbg,
+   Dwarf_Die die,
+   Dwarf_Half attr,
+   Dwarf_Attribute attr_in,
+   int pra_dwarf_names_print_on_error,
+   boolean print_information,
+   int *append_extra_string,
+   struct esb_s *esb_extrap)
+{
+    Dwarf_Error raerr = 0;
+    Dwarf_Off listoff = 0;
+    Dwarf_Rnglist_Range localranges[RNGLIST_LOCAL_COUNT];
+    Dwarf_Rnglist_Range *ranges = localranges;
+    Dwarf_Unsigned count = 0;
+    Dwarf_Unsigned i = 0;
+    char tmp[200];
+    int res = 0;
+
+    res = dwarf_get_rnglist_offset(attr_in,&listoff,&raerr);
+    if (res == DW_DLV_OK) {
+        res = dwarf_get_rnglist(die,listoff,ranges,
+            RNGLIST_LOCAL_COUNT,&count,&raerr);
+    }
+    if (res == DW_DLV_OK && count > RNGLIST_LOCAL_COUNT) {
+        ranges = (Dwarf_Rnglist_Range *)malloc(
+            count * sizeof(Dwarf_Rnglist_Range));
+        if (!ranges) {
+            printf("ERROR: out of memory reading %" DW_PR_DUu
+                " ranges of .debug_rnglists\n",count);
+            return;
+        }
+        res = dwarf_get_rnglist(die,listoff,ranges,
+            count,&count,&raerr);
+    }
+    if (res != DW_DLV_OK) {
+        if (glflags.gf_suppress_checking_on_dwp) {
+            /* Ignore checks */
+        } else if (glflags.gf_do_print_dwarf) {
+            printf("\ndwarf_get_rnglist() "
+                "cannot read the DW_AT_ranges list at offset 0x%"
+                DW_PR_XZEROS DW_PR_DUx ".",
+                (Dwarf_Unsigned)listoff);
+        } else {
+            DWARF_CHECK_COUNT(ranges_result,1);
+            DWARF_CHECK_ERROR2(ranges_result,
+                get_AT_name(attr,
+                    pra_dwarf_names_print_on_error),
+                " cannot read DW_AT_ranges in .debug_rnglists");
+        }
+        if (res == DW_DLV_ERROR) {
+            dwarf_dealloc(dbg,raerr,DW_DLA_ERROR);
+        }
+        if (ranges != localranges) {
+            free(ranges);
+        }
+        return;
+    }
+    if (print_information) {
+        *append_extra_string = 1;
+        if (dense) {
+            snprintf(tmp,sizeof(tmp),
+                "< ranges: %" DW_PR_DUu " ranges at .debug_rnglists"
+                " offset %" DW_PR_DUu " (0x%" DW_PR_XZEROS DW_PR_DUx
+                ")>",
+                count,(Dwarf_Unsigned)listoff,
+                (Dwarf_Unsigned)listoff);
+        } else {
+            snprintf(tmp,sizeof(tmp),
+                "\t\tranges: %" DW_PR_DUu " at .debug_rnglists"
+                " offset %" DW_PR_DUu " (0x%" DW_PR_XZEROS DW_PR_DUx
+                ")\n",
+                count,(Dwarf_Unsigned)listoff,
+                (Dwarf_Unsigned)listoff);
+        }
+        esb_append(esb_extrap,tmp);
+        for (i = 0; i < count; ++i) {
+            if (dense) {
+                snprintf(tmp,sizeof(tmp),
+                    "<[%2" DW_PR_DUu "] 0x%" DW_PR_XZEROS DW_PR_DUx
+                    " 0x%" DW_PR_XZEROS DW_PR_DUx ">",
+                    i,
+                    (Dwarf_Unsigned)ranges[i].drr_lowpc,
+                    (Dwarf_Unsigned)ranges[i].drr_highpc);
+            } else {
+                snprintf(tmp,sizeof(tmp),
+                    "\t\t\t[%2" DW_PR_DUu "] 0x%" DW_PR_XZEROS DW_PR_DUx
+                    " 0x%" DW_PR_XZEROS DW_PR_DUx "\n",
+                    i,
+                    (Dwarf_Unsigned)ranges[i].drr_lowpc,
+                    (Dwarf_Unsigned)ranges[i].drr_highpc);
+            }
+            esb_append(esb_extrap,tmp);
+        }
+    }
+    if (ranges != localranges) {
+        free(ranges);
+    }
+}
+
 /*  Extracted this from print_attribute()
     to get tolerable indents.
     In other words to make it readable.
@@ -2072,8 +2293,18 @@ print_range_attribute(Dwarf_Debug dbg,
 {
     Dwarf_Error raerr = 0;
     Dwarf_Unsigned original_off = 0;
+    Dwarf_Half version = 0;
+    Dwarf_Half offset_size = 0;
     int fres = 0;
 
+    if (theform == DW_FORM_rnglistx ||
+        (dwarf_get_version_of_die(die,&version,&offset_size) ==
+        DW_DLV_OK && version >= 5)) {
+        print_rnglist_attribute(dbg,die,attr,attr_in,
+            pra_dwarf_names_print_on_error,
+            print_information,append_extra_string,esb_extrap);
+        return;
+    }
     fres = dwarf_global_formref(attr_in, &original_off, &raerr);
     if (fres == DW_DLV_OK) {
         Dwarf_Ranges *rangeset = 0;
@@ -2217,8 +2448,68 @@ trim_quotes(const char *val,struct esb_s *es)
     esb_append(es,val);
 }
 
+/*  The value of a flag attribute, FALSE if absent. */
+static boolean
+die_flag_is_set(Dwarf_Debug dbg,Dwarf_Die die,Dwarf_Half attrnum)
+{
+    Dwarf_Attribute fattr = 0;
+    Dwarf_Bool flag = FALSE;
+    Dwarf_Error ferr = 0;
+    int fres = 0;
+
+    fres = dwarf_attr(die,attrnum,&fattr,&ferr);
+    if (fres == DW_DLV_OK) {
+        fres = dwarf_formflag(fattr,&flag,&ferr);
+        dwarf_dealloc(dbg,fattr,DW_DLA_ATTR);
+    }
+    if (fres == DW_DLV_ERROR) {
+        dwarf_dealloc(dbg,ferr,DW_DLA_ERROR);
+    }
+    return fres == DW_DLV_OK && flag;
+}
+
+/*  -S global= only matches what every name index lists:
+    an external function with code or an external variable
+    with a location, not a declaration of either. */
+static boolean
+is_global_definition(Dwarf_Debug dbg,Dwarf_Die die,Dwarf_Half tag)
+{
+    Dwarf_Half needed[4] = {0,0,0,0};
+    int i = 0;
+
+    if (tag == DW_TAG_subprogram) {
+        needed[0] = DW_AT_low_pc;
+        needed[1] = DW_AT_ranges;
+        needed[2] = DW_AT_entry_pc;
+    } else if (tag == DW_TAG_variable) {
+        needed[0] = DW_AT_location;
+    } else {
+        return FALSE;
+    }
+    if (!die_flag_is_set(dbg,die,DW_AT_external) ||
+        die_flag_is_set(dbg,die,DW_AT_declaration)) {
+        return FALSE;
+    }
+    for (i = 0; needed[i]; ++i) {
+        Dwarf_Bool has = FALSE;
+        Dwarf_Error herr = 0;
+        int hres = dwarf_hasattr(die,needed[i],&has,&herr);
+
+        if (hres == DW_DLV_ERROR) {
+            dwarf_dealloc(dbg,herr,DW_DLA_ERROR);
+            return FALSE;
+        }
+        if (hres == DW_DLV_OK && has) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
 static int
-have_a_search_match(const char *valname,const char *atname)
+have_a_search_match(Dwarf_Debug dbg,Dwarf_Die die,Dwarf_Half tag,
+    const char *valname,const char *atname,
+    Dwarf_Half attr)
 {
     /*  valname may have had quotes inserted, but search_match_text
         will not. So we need to use a new copy, not valname here.
@@ -2241,14 +2532,34 @@ have_a_search_match(const char *valname,const char *atname)
         if (is_strstrnocase(s2,search_any_text) ||
             is_strstrnocase(atname,search_any_text)) {
 
+            esb_destructor(&esb_match);
+            return TRUE;
+        }
+    }
+    if (search_name_text && glflags.gf_search_global) {
+        if (attr == DW_AT_name && search_name_matches(s2) &&
+            is_global_definition(dbg,die,tag)) {
+
+            esb_destructor(&esb_match);
+            return TRUE;
+        }
+    } else if (search_name_text) {
+        if ((attr == DW_AT_name || attr == DW_AT_linkage_name ||
+            attr == DW_AT_MIPS_linkage_name) &&
+            search_name_matches(s2)) {
+
             esb_destructor(&esb_match);
             return TRUE;
         }
     }
 #ifdef HAVE_REGEX
     if (search_regex_text) {
-        if (!regexec(&search_re,s2,0,NULL,0) ||
-            !regexec(&search_re,atname,0,NULL,0)) {
+        /*  regexec() only where the required literal,
+            if any, is present. */
+        if ((search_regex_may_match(s2) &&
+            !regexec(&search_re,s2,0,NULL,0)) ||
+            (search_regex_may_match(atname) &&
+            !regexec(&search_re,atname,0,NULL,0))) {
 
             esb_destructor(&esb_match);
             return TRUE;
@@ -3372,7 +3683,7 @@ print_attribute(Dwarf_Debug dbg, Dwarf_Die die,
                 static char proc_name[BUFSIZ];
 
                 proc_name[0] = 0;
-                get_proc_name(dbg,die,low_pc,proc_name,BUFSIZ,/*pcMap=*/0);
+                get_proc_name(dbg,die,low_pc,proc_name,BUFSIZ);
                 if (proc_name[0]) {
                     safe_strcpy(PU_name,sizeof(PU_name),proc_name,
                         strlen(proc_name));
@@ -3396,7 +3707,8 @@ print_attribute(Dwarf_Debug dbg, Dwarf_Die die,
         break;
     }
     if (!print_information) {
-        if (have_a_search_match(esb_get_string(&valname),atname)) {
+        if (have_a_search_match(dbg,die,tag,
+            esb_get_string(&valname),atname,attr)) {
             /* Count occurrence of text */
             ++search_occurrences;
             if ( glflags.gf_search_wide_format) {
@@ -3410,23 +3722,28 @@ print_attribute(Dwarf_Debug dbg, Dwarf_Die die,
     if ((PRINTING_UNIQUE && PRINTING_DIES && print_information) || bTextFound) {
         /*  Print just the Tags and Attributes */
         if (!glflags.gf_display_offsets) {
-            printf("%-28s\n",atname);
+            outbuf_string_padded(atname,28);
+            outbuf_char('\n');
         } else {
             if (dense) {
-                printf(" %s<%s>", atname, esb_get_string(&valname));
+                outbuf_char(' ');
+                outbuf_string(atname);
+                outbuf_char('<');
+                outbuf_esb(&valname);
+                outbuf_char('>');
                 if (append_extra_string) {
-                    char *v = esb_get_string(&esb_extra);
-                    printf("%s", v);
+                    outbuf_esb(&esb_extra);
                 }
             } else {
-                printf("%-28s", atname);
+                outbuf_string_padded(atname,28);
                 if (strlen(atname) >= 28) {
-                    printf(" ");
+                    outbuf_char(' ');
                 }
-                printf("%s\n", sanitized(esb_get_string(&valname)));
+                outbuf_string(sanitized(esb_get_string(&valname)));
+                outbuf_char('\n');
                 if (append_extra_string) {
                     char *v = esb_get_string(&esb_extra);
-                    printf("%s", sanitized(v));
+                    outbuf_string(sanitized(v));
                 }
             }
         }
@@ -3801,6 +4118,93 @@ adexplain(Dwarf_Unsigned liberr,
     return alterr;
 }
 
+/*  DWARF5 location lists are in .debug_loclists
+    (possibly reached by DW_FORM_loclistx index).
+    The entries come back with the base address
+    and any .debug_addr indices already applied. */
+#define LOCLIST_LOCAL_COUNT 32
+static void
+get_location_list5(Dwarf_Debug dbg,
+    Dwarf_Die die,
+    Dwarf_Attribute attr,
+    Dwarf_Half version,
+    Dwarf_Half offset_size,
+    struct esb_s *esbp)
+{
+    Dwarf_Error llerr = 0;
+    Dwarf_Off listoff = 0;
+    Dwarf_Loclist_Range locallocs[LOCLIST_LOCAL_COUNT];
+    Dwarf_Loclist_Range *locs = locallocs;
+    Dwarf_Unsigned count = 0;
+    Dwarf_Unsigned i = 0;
+    Dwarf_Half address_size = 0;
+    char small_buf[150];
+    int lres = 0;
+
+    lres = dwarf_get_die_address_size(die,&address_size,&llerr);
+    if (lres != DW_DLV_OK) {
+        print_error(dbg, "dwarf_get_die_address_size", lres, llerr);
+        return;
+    }
+    lres = dwarf_get_loclist_offset(attr,&listoff,&llerr);
+    if (lres == DW_DLV_OK) {
+        lres = dwarf_get_loclist(die,listoff,locs,
+            LOCLIST_LOCAL_COUNT,&count,&llerr);
+    }
+    if (lres == DW_DLV_OK && count > LOCLIST_LOCAL_COUNT) {
+        locs = (Dwarf_Loclist_Range *)malloc(
+            count * sizeof(Dwarf_Loclist_Range));
+        if (!locs) {
+            print_error(dbg, "out of memory reading .debug_loclists",
+                DW_DLV_OK, llerr);
+            return;
+        }
+        lres = dwarf_get_loclist(die,listoff,locs,
+            count,&count,&llerr);
+    }
+    if (lres == DW_DLV_ERROR) {
+        print_error(dbg, "dwarf_get_loclist", lres, llerr);
+    } else if (lres == DW_DLV_NO_ENTRY) {
+        if (locs != locallocs) {
+            free(locs);
+        }
+        return;
+    }
+    for (i = 0; i < count; ++i) {
+        Dwarf_Loclist_Range *l = locs + i;
+
+        if (!dense) {
+            if (i == 0) {
+                snprintf(small_buf, sizeof(small_buf),
+                    "<loclist at .debug_loclists offset 0x%"
+                    DW_PR_XZEROS DW_PR_DUx
+                    " with %ld entries follows>",
+                    (Dwarf_Unsigned)listoff,
+                    (long) count);
+                esb_append(esbp, small_buf);
+            }
+            esb_append(esbp, "\n\t\t\t");
+            snprintf(small_buf, sizeof(small_buf), "[%2d]", (int)i);
+            esb_append(esbp, small_buf);
+        }
+        if (l->dlr_is_default) {
+            esb_append(esbp,"<default location>");
+        } else {
+            snprintf(small_buf,sizeof(small_buf),
+                "<lowpc=0x%" DW_PR_XZEROS DW_PR_DUx
+                "><highpc=0x%" DW_PR_XZEROS DW_PR_DUx ">",
+                (Dwarf_Unsigned)l->dlr_lowpc,
+                (Dwarf_Unsigned)l->dlr_highpc);
+            esb_append(esbp,small_buf);
+        }
+        get_string_from_locs(dbg,l->dlr_expr,l->dlr_expr_len,
+            address_size,offset_size,version,esbp);
+    }
+    if (locs != locallocs) {
+        free(locs);
+    }
+}
+
 /*  Fill buffer with location lists
     Buffer esbp expands as needed.
 */
@@ -3839,7 +4243,19 @@ get_location_list(Dwarf_Debug dbg,
     Dwarf_Signed locentry_count = 0;
     Dwarf_Unsigned ulocentry_count = 0;
     Dwarf_Bool checking = FALSE;
+    Dwarf_Half version = 0;
+    Dwarf_Half offset_size = 0;
+    Dwarf_Half theform = 0;
 
+    lres = dwarf_whatform(attr,&theform,&llerr);
+    if (lres == DW_DLV_OK &&
+        dwarf_get_version_of_die(die,&version,&offset_size) ==
+        DW_DLV_OK && version >= 5 &&
+        (theform == DW_FORM_sec_offset ||
+        theform == DW_FORM_loclistx)) {
+        get_location_list5(dbg,die,attr,version,offset_size,esbp);
+        return;
+    }
     if (!glflags.gf_use_old_dwarf_loclist) {
         lres = dwarf_get_loclist_c(attr,&loclist_head,
             &no_of_elements,&llerr);
@@ -4210,23 +4626,17 @@ formx_data16(Dwarf_Form_Data16 * u,
 static void
 formx_unsigned(Dwarf_Unsigned u, struct esb_s *esbp, Dwarf_Bool hex_format)
 {
-    char small_buf[40];
     if (hex_format) {
-        snprintf(small_buf, sizeof(small_buf),"0x%"  DW_PR_XZEROS DW_PR_DUx , u);
+        esb_append_hex(esbp,u,OUTBUF_XZEROS_DIGITS);
     } else {
-        snprintf(small_buf, sizeof(small_buf),
-            "%" DW_PR_DUu , u);
+        esb_append_unsigned(esbp,u);
     }
-    esb_append(esbp, small_buf);
 }
 
 static void
 formx_signed(Dwarf_Signed s, struct esb_s *esbp)
 {
-    char small_buf[40];
-    snprintf(small_buf, sizeof(small_buf),
-        "%" DW_PR_DSd ,s);
-    esb_append(esbp, small_buf);
+    esb_append_signed(esbp,s);
 }
 static void
 formx_unsigned_and_signed_if_neg(Dwarf_Unsigned tempud,
@@ -4241,6 +4651,42 @@ formx_unsigned_and_signed_if_neg(Dwarf_Unsigned tempud,
     }
 }
 
+/*  Returns -1 if the DW_AT_encoding is signed, 1 if it is
+    unsigned, otherwise 0. */
+static int
+encoding_signedness(Dwarf_Debug dbg,
+    Dwarf_Attribute encodingattr)
+{
+    Dwarf_Unsigned tempud = 0;
+    Dwarf_Error error = 0;
+    int show_form_here = FALSE;
+    int res = 0;
+
+    res = get_small_encoding_integer_and_name(dbg,
+        encodingattr,
+        &tempud,
+        /* attrname */ (const char *) NULL,
+        /* err_string */ ( struct esb_s *) NULL,
+        (encoding_type_func) 0,
+        &error,show_form_here);
+    if (res != DW_DLV_OK) {
+        /*bracket_hex( "<helper small encoding FAIL",diegoffset,">",esbp);*/
+        if (res == DW_DLV_ERROR) {
+            dwarf_dealloc(dbg,error,DW_DLA_ERROR);
+        }
+        return 0;
+    }
+    if (tempud == DW_ATE_signed || tempud == DW_ATE_signed_char) {
+        /*esb_append(esbp,"helper small encoding SIGNED ");*/
+        return -1;
+    }
+    if (tempud == DW_ATE_unsigned || tempud == DW_ATE_unsigned_char) {
+        /*esb_append(esbp,"helper small encoding UNSIGNED ");*/
+        return 1;
+    }
+    return 0;
+}
+
 /*  If the DIE DW_AT_type exists and is directly known signed/unsigned
     return -1 for signed 1 for unsigned.
     Otherwise return 0 meaning 'no information'.
@@ -4253,6 +4699,7 @@ check_for_type_unsigned(Dwarf_Debug dbg,
     Dwarf_Bool is_info = 0;
     struct Helpertree_Base_s * helperbase = 0;
     struct Helpertree_Map_Entry_s *e = 0;
+    const struct die_summary_entry_s *dse = 0;
     int res = 0;
     Dwarf_Attribute attr = 0;
     Dwarf_Attribute encodingattr = 0;
@@ -4260,8 +4707,6 @@ check_for_type_unsigned(Dwarf_Debug dbg,
     Dwarf_Unsigned diegoffset = 0;
     Dwarf_Unsigned typedieoffset = 0;
     Dwarf_Die typedie = 0;
-    Dwarf_Unsigned tempud = 0;
-    int show_form_here = FALSE;
     int retval = 0;
 
     if(!die) {
@@ -4320,6 +4765,11 @@ check_for_type_unsigned(Dwarf_Debug dbg,
     }
     dwarf_dealloc(dbg,attr,DW_DLA_ATTR);
     attr = 0;
+    /*  A type DIE already walked in this CU is summarized. */
+    dse = die_summary_find(dbg,is_info,typedieoffset);
+    if (dse) {
+        return dse->dse_signedness;
+    }
     e = helpertree_find(typedieoffset,helperbase);
     if(e) {
         /*bracket_hex("<helper FOUND typedieoffset ",typedieoffset,">",esbp);
@@ -4354,31 +4804,7 @@ check_for_type_unsigned(Dwarf_Debug dbg,
         return 0;
     }
 
-    res = get_small_encoding_integer_and_name(dbg,
-        encodingattr,
-        &tempud,
-        /* attrname */ (const char *) NULL,
-        /* err_string */ ( struct esb_s *) NULL,
-        (encoding_type_func) 0,
-        &error,show_form_here);
-
-    if (res != DW_DLV_OK) {
-        /*bracket_hex( "<helper small encoding FAIL",diegoffset,">",esbp);*/
-        dwarf_dealloc(dbg,typedie,DW_DLA_DIE);
-        dwarf_dealloc(dbg,encodingattr,DW_DLA_ATTR);
-        helpertree_add_entry(diegoffset, 0,helperbase);
-        helpertree_add_entry(typedieoffset, 0,helperbase);
-        return 0;
-    }
-    if (tempud == DW_ATE_signed || tempud == DW_ATE_signed_char) {
-        /*esb_append(esbp,"helper small encoding SIGNED ");*/
-        retval = -1;
-    } else {
-        if (tempud == DW_ATE_unsigned || tempud == DW_ATE_unsigned_char) {
-            /*esb_append(esbp,"helper small encoding UNSIGNED ");*/
-            retval = 1;
-        }
-    }
+    retval = encoding_signedness(dbg,encodingattr);
     /*bracket_hex( "<helper ENTERED die",diegoffset,">",esbp);
     bracket_hex( "<helper ENTERED typedie",typedieoffset,">",esbp);*/
     helpertree_add_entry(diegoffset,retval,helperbase);
@@ -4589,17 +5015,13 @@ static int attributes_encoding_factor[DW_FORM_data16 + 1];
 /*  These must be reset for each object if we are processing
     an archive! see print_attributes_encoding(). */
 static a_attr_encoding *attributes_encoding_table = NULL;
+/*  Set aside while -x cache= saves a CU. */
+static a_attr_encoding *cache_encoding_table = NULL;
 static boolean attributes_encoding_do_init = TRUE;
 
-/*  Check the potential amount of space wasted by attributes values that can
-    be represented as an unsigned LEB128. Only attributes with forms:
-    DW_FORM_data1, DW_FORM_data2, DW_FORM_data4 and DW_FORM_data are checked
-*/
 static void
-check_attributes_encoding(Dwarf_Half attr,Dwarf_Half theform,
-    Dwarf_Unsigned value)
+setup_attributes_encoding(void)
 {
-
     if (attributes_encoding_do_init) {
         /* Create table on first call */
         attributes_encoding_table = (a_attr_encoding *)calloc(DW_AT_lo_user,
@@ -4612,6 +5034,17 @@ check_attributes_encoding(Dwarf_Half attr,Dwarf_Half theform,
         attributes_encoding_factor[DW_FORM_data16] = 16;/* index 0x1e */
         attributes_encoding_do_init = FALSE;
     }
+}
+
+/*  Check the potential amount of space wasted by attributes values that can
+    be represented as an unsigned LEB128. Only attributes with forms:
+    DW_FORM_data1, DW_FORM_data2, DW_FORM_data4 and DW_FORM_data are checked
+*/
+static void
+check_attributes_encoding(Dwarf_Half attr,Dwarf_Half theform,
+    Dwarf_Unsigned value)
+{
+    setup_attributes_encoding();
 
     /* Regardless of the encoding form, count the checks. */
     DWARF_CHECK_COUNT(attr_encoding_result,1);
@@ -4743,10 +5176,247 @@ print_attributes_encoding(Dwarf_Debug dbg)
         }
         free(attributes_encoding_table);
         attributes_encoding_table = 0;
+        free(cache_encoding_table);
+        cache_encoding_table = 0;
         attributes_encoding_do_init = TRUE;
     }
 }
 
+/*  -x workers support: the print_die.c state a CU leaves
+    for the next CU, and the attribute encoding space
+    totals a worker accumulates.  New 2018. */
+void
+cu_worker_get_die_state(struct cu_worker_boundary_s *b)
+{
+    memset(b,0,sizeof(*b));
+    b->cb_record_dwarf_error = glflags.gf_record_dwarf_error;
+    b->cb_seen_PU = seen_PU;
+    b->cb_seen_PU_base_address = seen_PU_base_address;
+    b->cb_seen_PU_high_address = seen_PU_high_address;
+    b->cb_need_PU_valid_code = need_PU_valid_code;
+    b->cb_PU_base_address = PU_base_address;
+    b->cb_PU_high_address = PU_high_address;
+    safe_strcpy(b->cb_PU_name,sizeof(b->cb_PU_name),
+        PU_name,strlen(PU_name));
+    b->cb_in_valid_code = in_valid_code;
+    b->cb_local_symbols_already_began = local_symbols_already_began;
+    b->cb_suppress_checking_on_dwp = glflags.gf_suppress_checking_on_dwp;
+    b->cb_check_ranges = glflags.gf_check_ranges;
+    b->cb_check_aranges = glflags.gf_check_aranges;
+    b->cb_check_decl_file = glflags.gf_check_decl_file;
+    b->cb_check_lines = glflags.gf_check_lines;
+    b->cb_check_pubname_attr = glflags.gf_check_pubname_attr;
+    b->cb_check_fdes = glflags.gf_check_fdes;
+}
+
+void
+cu_worker_set_die_state(struct cu_worker_boundary_s *b)
+{
+    glflags.gf_record_dwarf_error = b->cb_record_dwarf_error;
+    seen_PU = b->cb_seen_PU;
+    seen_PU_base_address = b->cb_seen_PU_base_address;
+    seen_PU_high_address = b->cb_seen_PU_high_address;
+    need_PU_valid_code = b->cb_need_PU_valid_code;
+    PU_base_address = b->cb_PU_base_address;
+    PU_high_address = b->cb_PU_high_address;
+    safe_strcpy(PU_name,sizeof(PU_name),
+        b->cb_PU_name,strlen(b->cb_PU_name));
+    in_valid_code = b->cb_in_valid_code;
+    local_symbols_already_began = b->cb_local_symbols_already_began;
+    glflags.gf_suppress_checking_on_dwp = b->cb_suppress_checking_on_dwp;
+    glflags.gf_check_ranges = b->cb_check_ranges;
+    glflags.gf_check_aranges = b->cb_check_aranges;
+    glflags.gf_check_decl_file = b->cb_check_decl_file;
+    glflags.gf_check_lines = b->cb_check_lines;
+    glflags.gf_check_pubname_attr = b->cb_check_pubname_attr;
+    glflags.gf_check_fdes = b->cb_check_fdes;
+}
+
+void
+cu_worker_reset_die_checks(void)
+{
+    if (attributes_encoding_table) {
+        memset(attributes_encoding_table,0,
+            DW_AT_lo_user * sizeof(a_attr_encoding));
+    }
+}
+
+/*  Only the attributes actually seen are written. */
+int
+cu_worker_write_die_checks(FILE *f)
+{
+    Dwarf_Unsigned count = 0;
+    Dwarf_Unsigned index = 0;
+
+    if (attributes_encoding_table) {
+        for (index = 0; index < DW_AT_lo_user; ++index) {
+            if (attributes_encoding_table[index].entries) {
+                ++count;
+            }
+        }
+    }
+    if (cu_worker_write(f,&count,sizeof(count)) != DW_DLV_OK) {
+        return DW_DLV_ERROR;
+    }
+    for (index = 0; count && index < DW_AT_lo_user; ++index) {
+        if (!attributes_encoding_table[index].entries) {
+            continue;
+        }
+        if (cu_worker_write(f,&index,sizeof(index)) != DW_DLV_OK ||
+            cu_worker_write(f,&attributes_encoding_table[index],
+                sizeof(a_attr_encoding)) != DW_DLV_OK) {
+            return DW_DLV_ERROR;
+        }
+    }
+    return DW_DLV_OK;
+}
+
+int
+cu_worker_merge_die_checks(FILE *f)
+{
+    Dwarf_Unsigned count = 0;
+    Dwarf_Unsigned i = 0;
+
+    if (cu_worker_read(f,&count,sizeof(count)) != DW_DLV_OK) {
+        return DW_DLV_ERROR;
+    }
+    if (count) {
+        setup_attributes_encoding();
+        if (!attributes_encoding_table) {
+            return DW_DLV_ERROR;
+        }
+    }
+    for (i = 0; i < count; ++i) {
+        Dwarf_Unsigned index = 0;
+        a_attr_encoding e;
+
+        if (cu_worker_read(f,&index,sizeof(index)) != DW_DLV_OK ||
+            cu_worker_read(f,&e,sizeof(e)) != DW_DLV_OK ||
+            index >= DW_AT_lo_user) {
+            return DW_DLV_ERROR;
+        }
+        attributes_encoding_table[index].entries += e.entries;
+        attributes_encoding_table[index].formx   += e.formx;
+        attributes_encoding_table[index].leb128  += e.leb128;
+    }
+    return DW_DLV_OK;
+}
+
+static void cache_begin_usage_counts(void);
+static int  cache_end_usage_counts(FILE *f);
+
+/*  -x cache= support: a CU's own -kE and -ku counts,
+    for saving with it.  New 2018. */
+void
+cu_cache_begin_die_checks(void)
+{
+    cache_begin_usage_counts();
+    if (!glflags.gf_check_attr_encoding) {
+        return;
+    }
+    setup_attributes_encoding();
+    if (!cache_encoding_table) {
+        cache_encoding_table = (a_attr_encoding *)calloc(DW_AT_lo_user,
+            sizeof(a_attr_encoding));
+    }
+    if (attributes_encoding_table && cache_encoding_table) {
+        a_attr_encoding *t = attributes_encoding_table;
+
+        attributes_encoding_table = cache_encoding_table;
+        cache_encoding_table = t;
+    }
+}
+
+/*  Writes the CU's counts and adds them to the others. */
+int
+cu_cache_end_die_checks(FILE *f)
+{
+    int res = 0;
+    Dwarf_Unsigned index = 0;
+    a_attr_encoding *t = 0;
+
+    if (!glflags.gf_check_attr_encoding) {
+        Dwarf_Unsigned count = 0;
+
+        res = f? cu_worker_write(f,&count,sizeof(count)):
+            DW_DLV_ERROR;
+        if (cache_end_usage_counts(res == DW_DLV_OK? f: NULL)) {
+            res = DW_DLV_ERROR;
+        }
+        return res;
+    }
+    if (!cache_encoding_table) {
+        /*  The counts went straight into the table. */
+        cache_end_usage_counts(NULL);
+        return DW_DLV_ERROR;
+    }
+    res = f? cu_worker_write_die_checks(f): DW_DLV_ERROR;
+    t = attributes_encoding_table;
+    attributes_encoding_table = cache_encoding_table;
+    cache_encoding_table = t;
+    for (index = 0; index < DW_AT_lo_user; ++index) {
+        attributes_encoding_table[index].entries += t[index].entries;
+        attributes_encoding_table[index].formx   += t[index].formx;
+        attributes_encoding_table[index].leb128  += t[index].leb128;
+    }
+    memset(t,0,DW_AT_lo_user * sizeof(a_attr_encoding));
+    if (cache_end_usage_counts(res == DW_DLV_OK? f: NULL)) {
+        res = DW_DLV_ERROR;
+    }
+    return res;
+}
+
+/*  For the -kt check: the target of a DW_AT_type
+    had better be a type. */
+static void
+check_type_offset_tag(Dwarf_Off goff,Dwarf_Half tag_for_check)
+{
+    char small_buf[COMPILE_UNIT_NAME_LEN];
+
+    switch (tag_for_check) {
+    case DW_TAG_array_type:
+    case DW_TAG_class_type:
+    case DW_TAG_enumeration_type:
+    case DW_TAG_pointer_type:
+    case DW_TAG_reference_type:
+    case DW_TAG_rvalue_reference_type:
+    case DW_TAG_restrict_type:
+    case DW_TAG_string_type:
+    case DW_TAG_structure_type:
+    case DW_TAG_subroutine_type:
+    case DW_TAG_typedef:
+    case DW_TAG_union_type:
+    case DW_TAG_ptr_to_member_type:
+    case DW_TAG_set_type:
+    case DW_TAG_subrange_type:
+    case DW_TAG_base_type:
+    case DW_TAG_const_type:
+    case DW_TAG_file_type:
+    case DW_TAG_packed_type:
+    case DW_TAG_thrown_type:
+    case DW_TAG_volatile_type:
+    case DW_TAG_template_type_parameter:
+    case DW_TAG_template_value_parameter:
+    case DW_TAG_unspecified_type:
+    /* Template alias */
+    case DW_TAG_template_alias:
+        /* OK */
+        break;
+    default:
+        snprintf(small_buf,sizeof(small_buf),
+            "DW_AT_type offset "
+            "0x%" DW_PR_XZEROS DW_PR_DUx
+            " does not point to Type"
+            " info we got tag 0x%x %s",
+            (Dwarf_Unsigned)goff,
+            tag_for_check,
+            get_TAG_name(tag_for_check,
+                pd_dwarf_names_print_on_error));
+        DWARF_CHECK_ERROR(type_offset_result,small_buf);
+        break;
+    }
+}
+
 /*  Fill buffer with attribute value.
     We pass in tag so we can try to do the right thing with
     broken compiler DW_TAG_enumerator
@@ -4983,71 +5653,36 @@ get_attr_value(Dwarf_Debug dbg, Dwarf_Half tag,
 
         if (glflags.gf_check_type_offset) {
             if (attr == DW_AT_type && form_refers_local_info(theform)) {
-                dres = dwarf_offdie_b(dbg, goff,
-                    is_info,
-                    &die_for_check, &referr);
-                if (dres != DW_DLV_OK) {
-                    snprintf(small_buf,sizeof(small_buf),
-                        "DW_AT_type offset does not point to a DIE "
-                        "for global offset 0x%" DW_PR_XZEROS DW_PR_DUx
-                        " cu off 0x%" DW_PR_XZEROS DW_PR_DUx
-                        " local offset 0x%" DW_PR_XZEROS DW_PR_DUx
-                        " tag 0x%x",
-                        goff,dieprint_cu_goffset,off,tag);
-                    DWARF_CHECK_ERROR(type_offset_result,small_buf);
+                const struct die_summary_entry_s *dse =
+                    die_summary_find(dbg,is_info,goff);
+
+                if (dse) {
+                    /*  Already walked, no need to read it again. */
+                    check_type_offset_tag(goff,dse->dse_tag);
                 } else {
-                    int tres2 =
-                        dwarf_tag(die_for_check, &tag_for_check, &err);
-                    if (tres2 == DW_DLV_OK) {
-                        switch (tag_for_check) {
-                        case DW_TAG_array_type:
-                        case DW_TAG_class_type:
-                        case DW_TAG_enumeration_type:
-                        case DW_TAG_pointer_type:
-                        case DW_TAG_reference_type:
-                        case DW_TAG_rvalue_reference_type:
-                        case DW_TAG_restrict_type:
-                        case DW_TAG_string_type:
-                        case DW_TAG_structure_type:
-                        case DW_TAG_subroutine_type:
-                        case DW_TAG_typedef:
-                        case DW_TAG_union_type:
-                        case DW_TAG_ptr_to_member_type:
-                        case DW_TAG_set_type:
-                        case DW_TAG_subrange_type:
-                        case DW_TAG_base_type:
-                        case DW_TAG_const_type:
-                        case DW_TAG_file_type:
-                        case DW_TAG_packed_type:
-                        case DW_TAG_thrown_type:
-                        case DW_TAG_volatile_type:
-                        case DW_TAG_template_type_parameter:
-                        case DW_TAG_template_value_parameter:
-                        case DW_TAG_unspecified_type:
-                        /* Template alias */
-                        case DW_TAG_template_alias:
-                            /* OK */
-                            break;
-                        default:
-                            {
-                                snprintf(small_buf,sizeof(small_buf),
-                                    "DW_AT_type offset "
-                                    "0x%" DW_PR_XZEROS DW_PR_DUx
-                                    " does not point to Type"
-                                    " info we got tag 0x%x %s",
-                                (Dwarf_Unsigned)goff,
-                                tag_for_check,
-                                get_TAG_name(tag_for_check,
-                                    pd_dwarf_names_print_on_error));
-                                DWARF_CHECK_ERROR(type_offset_result,small_buf);
-                            }
-                            break;
+                    dres = dwarf_offdie_b(dbg, goff,
+                        is_info,
+                        &die_for_check, &referr);
+                    if (dres != DW_DLV_OK) {
+                        snprintf(small_buf,sizeof(small_buf),
+                            "DW_AT_type offset does not point to a DIE "
+                            "for global offset 0x%" DW_PR_XZEROS DW_PR_DUx
+                            " cu off 0x%" DW_PR_XZEROS DW_PR_DUx
+                            " local offset 0x%" DW_PR_XZEROS DW_PR_DUx
+                            " tag 0x%x",
+                            goff,dieprint_cu_goffset,off,tag);
+                        DWARF_CHECK_ERROR(type_offset_result,small_buf);
+                    } else {
+                        int tres2 =
+                            dwarf_tag(die_for_check, &tag_for_check, &err);
+                        if (tres2 == DW_DLV_OK) {
+                            check_type_offset_tag(goff,tag_for_check);
+                        } else {
+                            DWARF_CHECK_ERROR(type_offset_result,
+                                "DW_AT_type offset does not exist");
                         }
                         dwarf_dealloc(dbg, die_for_check, DW_DLA_DIE);
                         die_for_check = 0;
-                    } else {
-                        DWARF_CHECK_ERROR(type_offset_result,
-                            "DW_AT_type offset does not exist");
                     }
                 }
             }
@@ -5412,6 +6047,23 @@ get_attr_value(Dwarf_Debug dbg, Dwarf_Half tag,
         }
         }
         break;
+    case DW_FORM_rnglistx:
+    case DW_FORM_loclistx:
+        /*  Show the list offset the index resolves to. */
+        if (theform == DW_FORM_rnglistx) {
+            bres = dwarf_get_rnglist_offset(attrib, &off, &err);
+        } else {
+            bres = dwarf_get_loclist_offset(attrib, &off, &err);
+        }
+        if (bres == DW_DLV_OK) {
+            Dwarf_Bool hex_format = TRUE;
+            formx_unsigned(off,esbp,hex_format);
+        } else {
+            print_error(dbg,
+                "Cannot get the list offset of a rnglistx or loclistx",
+                bres, err);
+        }
+        break;
     default:
         print_error(dbg, "dwarf_whatform unexpected value", DW_DLV_OK,
             err);
@@ -5721,3 +6373,263 @@ print_tag_attributes_usage(UNUSEDARG Dwarf_Debug dbg)
 
 #endif /* HAVE_USAGE_TAG_ATTR */
 }
+
+#ifdef HAVE_USAGE_TAG_ATTR
+/*  -x workers support: each -ku count is named by its kind,
+    its tag and its position in that tag's list, so a results
+    file need carry only the counts a worker saw. New 2018. */
+#define USAGE_KIND_TAG  0
+#define USAGE_KIND_TREE 1
+#define USAGE_KIND_ATTR 2
+#define USAGE_INDEX(k,t,p) (((Dwarf_Unsigned)(k) << 32) | \
+    ((Dwarf_Unsigned)(t) << 16) | (Dwarf_Unsigned)(p))
+
+static unsigned int *
+usage_count_slot(Dwarf_Unsigned index)
+{
+    Dwarf_Unsigned kind = index >> 32;
+    Dwarf_Unsigned tag = (index >> 16) & 0xffff;
+    Dwarf_Unsigned pos = index & 0xffff;
+    Dwarf_Unsigned i = 0;
+
+    if (!tag || tag >= DW_TAG_last) {
+        return 0;
+    }
+    if (kind == USAGE_KIND_TAG) {
+        return pos? 0: &tag_usage[tag];
+    }
+    if (kind == USAGE_KIND_TREE) {
+        Usage_Tag_Tree *p = usage_tag_tree[tag];
+
+        for (i = 0; p && p->tag; ++p, ++i) {
+            if (i == pos) {
+                return &p->count;
+            }
+        }
+    } else if (kind == USAGE_KIND_ATTR) {
+        Usage_Tag_Attr *p = usage_tag_attr[tag];
+
+        for (i = 0; p && p->attr; ++p, ++i) {
+            if (i == pos) {
+                return &p->count;
+            }
+        }
+    }
+    return 0;
+}
+
+/*  Calls op on every count, stopping at the first
+    that does not return DW_DLV_OK. */
+static int
+usage_counts_walk(int (*op)(Dwarf_Unsigned index,
+    unsigned int *count,void *arg),void *arg)
+{
+    Dwarf_Unsigned tag = 0;
+
+    for (tag = 1; tag < DW_TAG_last; ++tag) {
+        Usage_Tag_Tree *t = usage_tag_tree[tag];
+        Usage_Tag_Attr *a = usage_tag_attr[tag];
+        Dwarf_Unsigned pos = 0;
+        int res = op(USAGE_INDEX(USAGE_KIND_TAG,tag,0),
+            &tag_usage[tag],arg);
+
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        for (pos = 0; t && t->tag; ++t, ++pos) {
+            res = op(USAGE_INDEX(USAGE_KIND_TREE,tag,pos),
+                &t->count,arg);
+            if (res != DW_DLV_OK) {
+                return res;
+            }
+        }
+        for (pos = 0; a && a->attr; ++a, ++pos) {
+            res = op(USAGE_INDEX(USAGE_KIND_ATTR,tag,pos),
+                &a->count,arg);
+            if (res != DW_DLV_OK) {
+                return res;
+            }
+        }
+    }
+    return DW_DLV_OK;
+}
+
+static int
+usage_count_zero(UNUSEDARG Dwarf_Unsigned index,
+    unsigned int *count,UNUSEDARG void *arg)
+{
+    *count = 0;
+    return DW_DLV_OK;
+}
+
+static int
+usage_count_tally(UNUSEDARG Dwarf_Unsigned index,
+    unsigned int *count,void *arg)
+{
+    if (*count) {
+        ++*(Dwarf_Unsigned *)arg;
+    }
+    return DW_DLV_OK;
+}
+
+static int
+usage_count_write(Dwarf_Unsigned index,
+    unsigned int *count,void *arg)
+{
+    FILE *f = (FILE *)arg;
+
+    if (!*count) {
+        return DW_DLV_OK;
+    }
+    if (cu_worker_write(f,&index,sizeof(index)) != DW_DLV_OK ||
+        cu_worker_write(f,count,sizeof(*count)) != DW_DLV_OK) {
+        return DW_DLV_ERROR;
+    }
+    return DW_DLV_OK;
+}
+#endif /* HAVE_USAGE_TAG_ATTR */
+
+void
+cu_worker_reset_usage_counts(void)
+{
+#ifdef HAVE_USAGE_TAG_ATTR
+    usage_counts_walk(usage_count_zero,0);
+#endif /* HAVE_USAGE_TAG_ATTR */
+}
+
+/*  Only the counts actually seen are written. */
+int
+cu_worker_write_usage_counts(FILE *f)
+{
+    Dwarf_Unsigned count = 0;
+
+#ifdef HAVE_USAGE_TAG_ATTR
+    usage_counts_walk(usage_count_tally,&count);
+#endif /* HAVE_USAGE_TAG_ATTR */
+    if (cu_worker_write(f,&count,sizeof(count)) != DW_DLV_OK) {
+        return DW_DLV_ERROR;
+    }
+#ifdef HAVE_USAGE_TAG_ATTR
+    if (count) {
+        return usage_counts_walk(usage_count_write,f);
+    }
+#endif /* HAVE_USAGE_TAG_ATTR */
+    return DW_DLV_OK;
+}
+
+/*  -x cache= support: the -ku counts from before the CU
+    being saved, set aside so the CU's own can be written. */
+#ifdef HAVE_USAGE_TAG_ATTR
+struct usage_counts_saved_s {
+    unsigned int  *us_counts;
+    Dwarf_Unsigned us_size;
+    Dwarf_Unsigned us_next;
+    boolean        us_in_use;
+};
+static struct usage_counts_saved_s usage_saved;
+
+static int
+usage_count_size(UNUSEDARG Dwarf_Unsigned index,
+    UNUSEDARG unsigned int *count,void *arg)
+{
+    ++*(Dwarf_Unsigned *)arg;
+    return DW_DLV_OK;
+}
+
+static int
+usage_count_set_aside(UNUSEDARG Dwarf_Unsigned index,
+    unsigned int *count,void *arg)
+{
+    struct usage_counts_saved_s *us = (struct usage_counts_saved_s *)arg;
+
+    us->us_counts[us->us_next++] = *count;
+    *count = 0;
+    return DW_DLV_OK;
+}
+
+static int
+usage_count_add_back(UNUSEDARG Dwarf_Unsigned index,
+    unsigned int *count,void *arg)
+{
+    struct usage_counts_saved_s *us = (struct usage_counts_saved_s *)arg;
+
+    *count += us->us_counts[us->us_next++];
+    return DW_DLV_OK;
+}
+#endif /* HAVE_USAGE_TAG_ATTR */
+
+static void
+cache_begin_usage_counts(void)
+{
+#ifdef HAVE_USAGE_TAG_ATTR
+    if (!glflags.gf_print_usage_tag_attr) {
+        return;
+    }
+    if (!usage_saved.us_counts) {
+        usage_counts_walk(usage_count_size,&usage_saved.us_size);
+        usage_saved.us_counts = (unsigned int *)calloc(
+            usage_saved.us_size,sizeof(unsigned int));
+        if (!usage_saved.us_counts) {
+            return;
+        }
+    }
+    usage_saved.us_next = 0;
+    usage_counts_walk(usage_count_set_aside,&usage_saved);
+    usage_saved.us_in_use = TRUE;
+#endif /* HAVE_USAGE_TAG_ATTR */
+}
+
+/*  Writes the CU's counts, if f, and adds the others
+    back in. */
+static int
+cache_end_usage_counts(FILE *f)
+{
+    int res = DW_DLV_OK;
+
+#ifdef HAVE_USAGE_TAG_ATTR
+    if (glflags.gf_print_usage_tag_attr && !usage_saved.us_in_use) {
+        /*  The counts went straight into the tables. */
+        return DW_DLV_ERROR;
+    }
+#endif /* HAVE_USAGE_TAG_ATTR */
+    if (f) {
+        res = cu_worker_write_usage_counts(f);
+    }
+#ifdef HAVE_USAGE_TAG_ATTR
+    if (usage_saved.us_in_use) {
+        usage_saved.us_next = 0;
+        usage_counts_walk(usage_count_add_back,&usage_saved);
+        usage_saved.us_in_use = FALSE;
+    }
+#endif /* HAVE_USAGE_TAG_ATTR */
+    return res;
+}
+
+int
+cu_worker_merge_usage_counts(FILE *f)
+{
+    Dwarf_Unsigned count = 0;
+    Dwarf_Unsigned i = 0;
+
+    if (cu_worker_read(f,&count,sizeof(count)) != DW_DLV_OK) {
+        return DW_DLV_ERROR;
+    }
+    for (i = 0; i < count; ++i) {
+        Dwarf_Unsigned index = 0;
+        unsigned int value = 0;
+        unsigned int *slot = 0;
+
+        if (cu_worker_read(f,&index,sizeof(index)) != DW_DLV_OK ||
+            cu_worker_read(f,&value,sizeof(value)) != DW_DLV_OK) {
+            return DW_DLV_ERROR;
+        }
+#ifdef HAVE_USAGE_TAG_ATTR
+        slot = usage_count_slot(index);
+#endif /* HAVE_USAGE_TAG_ATTR */
+        if (!slot) {
+            return DW_DLV_ERROR;
+        }
+        *slot += value;
+    }
+    return DW_DLV_OK;
+}
@@ -26,10 +26,167 @@
 #include "naming.h"
 #include "dwconf.h"
 #include "esb.h"
+#include "print_sections.h"
+
+/*  Maximum attr/form pairs in one .debug_names abbrev,
+    matches libdwarf's own limit. */
+#define DNAMES_MAX_VALUES 8
+
+static void
+print_dnames_abbrevs(Dwarf_Debug dbg,Dwarf_Dnames_Head dn,
+    Dwarf_Unsigned index_number)
+{
+    Dwarf_Unsigned abnum = 0;
+    Dwarf_Error err = 0;
+
+    printf("  Abbreviations\n");
+    for (abnum = 0; ; ++abnum) {
+        Dwarf_Unsigned code = 0;
+        Dwarf_Unsigned tag = 0;
+        Dwarf_Unsigned abcount = 0;
+        Dwarf_Unsigned pairs = 0;
+        Dwarf_Unsigned p = 0;
+        int res = 0;
+
+        res = dwarf_debugnames_abbrev_by_index(dn,index_number,
+            abnum,&code,&tag,&abcount,&pairs,&err);
+        if (res == DW_DLV_NO_ENTRY) {
+            break;
+        }
+        if (res == DW_DLV_ERROR) {
+            print_error(dbg,"dwarf_debugnames_abbrev_by_index",res,err);
+        }
+        printf("   [%3" DW_PR_DUu "] code %" DW_PR_DUu " %s\n",
+            abnum,code,get_TAG_name(tag,
+            dwarf_names_print_on_error));
+        for (p = 0; p < pairs; ++p) {
+            Dwarf_Unsigned idx = 0;
+            Dwarf_Unsigned form = 0;
+
+            res = dwarf_debugnames_abbrev_form_by_index(dn,
+                index_number,abnum,p,&idx,&form,0,&err);
+            if (res == DW_DLV_ERROR) {
+                print_error(dbg,"dwarf_debugnames_abbrev_form_by_index",
+                    res,err);
+            }
+            if (res != DW_DLV_OK) {
+                break;
+            }
+            printf("         %-20s %s\n",
+                get_IDX_name(idx,dwarf_names_print_on_error),
+                get_FORM_name(form,dwarf_names_print_on_error));
+        }
+    }
+}
+
+/*  Prints the entries in the entry pool for one name. */
+static void
+print_dnames_entries(Dwarf_Debug dbg,Dwarf_Dnames_Head dn,
+    Dwarf_Unsigned index_number,
+    Dwarf_Unsigned pool_offset)
+{
+    Dwarf_Error err = 0;
+
+    for (;;) {
+        Dwarf_Unsigned code = 0;
+        Dwarf_Unsigned tag = 0;
+        Dwarf_Unsigned value_count = 0;
+        Dwarf_Unsigned abindex = 0;
+        Dwarf_Unsigned valoffset = 0;
+        Dwarf_Unsigned idxnum[DNAMES_MAX_VALUES];
+        Dwarf_Unsigned forms[DNAMES_MAX_VALUES];
+        Dwarf_Unsigned offsets[DNAMES_MAX_VALUES];
+        Dwarf_Sig8 sigs[DNAMES_MAX_VALUES];
+        Dwarf_Unsigned v = 0;
+        int res = 0;
+
+        res = dwarf_debugnames_entrypool(dn,index_number,
+            pool_offset,&code,&tag,&value_count,&abindex,
+            &valoffset,&err);
+        if (res == DW_DLV_NO_ENTRY) {
+            /* The zero abbrev code ending this name's entries. */
+            break;
+        }
+        if (res == DW_DLV_ERROR) {
+            print_error(dbg,"dwarf_debugnames_entrypool",res,err);
+        }
+        if (value_count > DNAMES_MAX_VALUES) {
+            printf("ERROR: .debug_names abbrev code %" DW_PR_DUu
+                " has %" DW_PR_DUu " values, more than we handle\n",
+                code,value_count);
+            break;
+        }
+        res = dwarf_debugnames_entrypool_values(dn,index_number,
+            abindex,valoffset,idxnum,forms,offsets,sigs,
+            &pool_offset,&err);
+        if (res == DW_DLV_ERROR) {
+            print_error(dbg,"dwarf_debugnames_entrypool_values",res,err);
+        }
+        printf("         code %" DW_PR_DUu " %s",code,
+            get_TAG_name(tag,dwarf_names_print_on_error));
+        for (v = 0; v < value_count; ++v) {
+            printf(" %s ",get_IDX_name(idxnum[v],
+                dwarf_names_print_on_error));
+            if (idxnum[v] == DW_IDX_type_hash) {
+                struct esb_s sigstr;
+
+                esb_constructor(&sigstr);
+                format_sig8_string(&sigs[v],&sigstr);
+                printf("%s",esb_get_string(&sigstr));
+                esb_destructor(&sigstr);
+            } else {
+                printf("0x%" DW_PR_XZEROS DW_PR_DUx, offsets[v]);
+            }
+        }
+        printf("\n");
+    }
+}
+
+static void
+print_dnames_names(Dwarf_Debug dbg,Dwarf_Dnames_Head dn,
+    Dwarf_Unsigned index_number,
+    Dwarf_Unsigned name_count)
+{
+    Dwarf_Unsigned n = 0;
+    Dwarf_Error err = 0;
+
+    printf("  Names\n");
+    for (n = 0; n < name_count; ++n) {
+        Dwarf_Sig8 hashsig;
+        Dwarf_Unsigned stroff = 0;
+        Dwarf_Unsigned pooloff = 0;
+        char *name = 0;
+        Dwarf_Signed slen = 0;
+        int res = 0;
+
+        memset(&hashsig,0,sizeof(hashsig));
+        res = dwarf_debugnames_name(dn,index_number,n,0,
+            &hashsig,&stroff,&pooloff,&err);
+        if (res == DW_DLV_ERROR) {
+            print_error(dbg,"dwarf_debugnames_name",res,err);
+        }
+        if (res != DW_DLV_OK) {
+            break;
+        }
+        res = dwarf_get_str(dbg,stroff,&name,&slen,&err);
+        if (res == DW_DLV_ERROR) {
+            print_error(dbg,"dwarf_get_str for .debug_names",res,err);
+        }
+        printf("   [%4" DW_PR_DUu "] str 0x%" DW_PR_XZEROS DW_PR_DUx
+            " pool 0x%" DW_PR_XZEROS DW_PR_DUx " %s\n",
+            n,stroff,pooloff,(res == DW_DLV_OK)?name:"<no string>");
+        print_dnames_entries(dbg,dn,index_number,pooloff);
+    }
+}
 
 extern void
 print_debug_names(Dwarf_Debug dbg)
 {
+    Dwarf_Dnames_Head dn = 0;
+    Dwarf_Unsigned dn_count = 0;
+    Dwarf_Unsigned i = 0;
+    Dwarf_Error err = 0;
+    int res = 0;
 
     if(!dbg) {
         printf("Cannot print .debug_names, no Dwarf_Debug passed in");
@@ -42,6 +199,92 @@ print_debug_names(Dwarf_Debug dbg)
     if (!glflags.gf_do_print_dwarf) {
         return;
     }
-    /*  Only print anything if we know it has debug names
-        present. And for now there is none. FIXME. */
+    res = dwarf_debugnames_header(dbg,&dn,&dn_count,&err);
+    if (res == DW_DLV_NO_ENTRY) {
+        return;
+    }
+    if (res == DW_DLV_ERROR) {
+        print_error(dbg,"dwarf_debugnames_header",res,err);
+        return;
+    }
+    printf("\n.debug_names\n");
+    for (i = 0; i < dn_count; ++i) {
+        Dwarf_Unsigned section_offset = 0;
+        Dwarf_Unsigned version = 0;
+        Dwarf_Unsigned offset_size = 0;
+        Dwarf_Unsigned cu_count = 0;
+        Dwarf_Unsigned local_tu_count = 0;
+        Dwarf_Unsigned foreign_tu_count = 0;
+        Dwarf_Unsigned bucket_count = 0;
+        Dwarf_Unsigned name_count = 0;
+        Dwarf_Unsigned table_length = 0;
+        Dwarf_Unsigned abbrev_size = 0;
+        Dwarf_Unsigned pool_size = 0;
+        Dwarf_Unsigned aug_size = 0;
+        Dwarf_Unsigned j = 0;
+
+        res = dwarf_debugnames_sizes(dn,i,&section_offset,
+            &version,&offset_size,
+            &cu_count,&local_tu_count,&foreign_tu_count,
+            &bucket_count,&name_count,
+            &table_length,&abbrev_size,&pool_size,&aug_size,
+            &err);
+        if (res != DW_DLV_OK) {
+            print_error(dbg,"dwarf_debugnames_sizes",res,err);
+        }
+        printf("Name table %" DW_PR_DUu
+            " at section offset 0x%" DW_PR_XZEROS DW_PR_DUx "\n",
+            i,section_offset);
+        printf("  version %" DW_PR_DUu ", offset size %" DW_PR_DUu
+            ", length 0x%" DW_PR_XZEROS DW_PR_DUx "\n",
+            version,offset_size,table_length);
+        printf("  CU count %" DW_PR_DUu
+            ", local TU count %" DW_PR_DUu
+            ", foreign TU count %" DW_PR_DUu "\n",
+            cu_count,local_tu_count,foreign_tu_count);
+        printf("  bucket count %" DW_PR_DUu
+            ", name count %" DW_PR_DUu "\n",
+            bucket_count,name_count);
+        printf("  abbrev table size %" DW_PR_DUu
+            ", entry pool size %" DW_PR_DUu
+            ", augmentation size %" DW_PR_DUu "\n",
+            abbrev_size,pool_size,aug_size);
+        for (j = 0; j < cu_count; ++j) {
+            Dwarf_Unsigned cuoff = 0;
+
+            res = dwarf_debugnames_cu_entry(dn,i,j,0,&cuoff,&err);
+            if (res == DW_DLV_ERROR) {
+                print_error(dbg,"dwarf_debugnames_cu_entry",res,err);
+            }
+            printf("  CU [%" DW_PR_DUu "] offset 0x%"
+                DW_PR_XZEROS DW_PR_DUx "\n", j,cuoff);
+        }
+        for (j = 0; j < local_tu_count; ++j) {
+            Dwarf_Unsigned tuoff = 0;
+
+            res = dwarf_debugnames_local_tu_entry(dn,i,j,0,
+                &tuoff,&err);
+            if (res == DW_DLV_ERROR) {
+                print_error(dbg,"dwarf_debugnames_local_tu_entry",
+                    res,err);
+            }
+            printf("  local TU [%" DW_PR_DUu "] offset 0x%"
+                DW_PR_XZEROS DW_PR_DUx "\n", j,tuoff);
+        }
+        if (verbose) {
+            for (j = 0; j < bucket_count; ++j) {
+                Dwarf_Unsigned first = 0;
+
+                res = dwarf_debugnames_bucket(dn,i,j,0,&first,&err);
+                if (res == DW_DLV_ERROR) {
+                    print_error(dbg,"dwarf_debugnames_bucket",res,err);
+                }
+                printf("  bucket [%4" DW_PR_DUu "] name %" DW_PR_DUu
+                    "\n", j,first);
+            }
+        }
+        print_dnames_abbrevs(dbg,dn,i);
+        print_dnames_names(dbg,dn,i,name_count);
+    }
+    dwarf_dealloc(dbg,dn,DW_DLA_DNAMES_HEAD);
 }
@@ -39,7 +39,10 @@
 #include "dwconf.h"
 #include "esb.h"
 #include "addrmap.h"
+#include "proc_map.h"
+#include "outbuf.h"
 #include "naming.h"
+#include "records.h"
 
 #define true 1
 #define false 0
@@ -60,6 +63,12 @@ print_one_frame_reg_col(Dwarf_Debug dbg,
     struct dwconf_s *config_data,
     Dwarf_Signed offset_relevant,
     Dwarf_Signed offset, Dwarf_Ptr block_ptr);
+static void record_one_frame_reg_col(Dwarf_Signed rule_id,
+    Dwarf_Small value_type,
+    Dwarf_Unsigned reg_used,
+    struct dwconf_s *config_data,
+    Dwarf_Signed offset_relevant,
+    Dwarf_Signed offset);
 
 static void print_frame_inst_bytes(Dwarf_Debug dbg,
     Dwarf_Ptr cie_init_inst, Dwarf_Signed len,
@@ -251,14 +260,12 @@ get_abstract_origin_funcname(Dwarf_Debug dbg,Dwarf_Attribute attr,
 /*
     Returns 1 if a proc with this low_pc found.
     Else returns 0.
-
-    From print_die.c this has no pcMap passed in,
-    we do not really have a sensible context, so this
-    really just looks at the current attributes for a name.
+    Either way proc_name_buf gets the name of the
+    subprogram, if it has one.
 */
 int
 get_proc_name(Dwarf_Debug dbg, Dwarf_Die die, Dwarf_Addr low_pc,
-    char *proc_name_buf, int proc_name_buf_len, void **pcMap)
+    char *proc_name_buf, int proc_name_buf_len)
 {
     Dwarf_Signed atcnt = 0;
     Dwarf_Signed i = 0;
@@ -271,17 +278,6 @@ get_proc_name(Dwarf_Debug dbg, Dwarf_Die die, Dwarf_Addr low_pc,
     Dwarf_Error proc_name_err = 0;
 
     proc_name_buf[0] = 0;       /* always set to something */
-    if (pcMap) {
-        struct Addr_Map_Entry *ame = 0;
-        ame = addr_map_find(low_pc,pcMap);
-        if (ame && ame->mp_name) {
-            /* mp_name is NULL only if we ran out of heap space. */
-            safe_strcpy(proc_name_buf, proc_name_buf_len,
-                ame->mp_name,(long) strlen(ame->mp_name));
-            return 1;
-        }
-    }
-
     atres = dwarf_attrlist(die, &atlist, &atcnt, &proc_name_err);
     if (atres == DW_DLV_ERROR) {
         print_error(dbg, "dwarf_attrlist", atres, proc_name_err);
@@ -379,321 +375,308 @@ get_proc_name(Dwarf_Debug dbg, Dwarf_Die die, Dwarf_Addr low_pc,
         dwarf_dealloc(dbg, atlist[i], DW_DLA_ATTR);
     }
     dwarf_dealloc(dbg, atlist, DW_DLA_LIST);
-    if (funcnamefound && funcpcfound && pcMap ) {
-        /*  Insert every name to map, not just the one
-            we are looking for.
-            This version does extra work in that
-            early symbols in a CU will be inserted
-            multiple times (the extra times have no
-            effect), the dwarfdump2
-            version of this does less work.  */
-        addr_map_insert(low_pc_die,proc_name_buf,pcMap);
-    }
     if (funcnamefound == 0 || funcpcfound == 0 || low_pc != low_pc_die) {
         funcres = 0;
     }
     return (funcres);
 }
 
-/*  Modified Depth First Search looking for the procedure:
-    a)  only looks for children of subprogram.
-    b)  With subprogram looks at current die *before* looking
-        for a child.
+/*  The FDE names come from a map of every subprogram
+    address range in .debug_info (see proc_map.h), built in
+    one pass the first time a name is wanted.  New 2018. */
 
-    Needed since some languages, including SGI MP Fortran,
-    have nested functions.
-    Return 0 on failure, 1 on success.
-*/
-static int
-load_nested_proc_name(Dwarf_Debug dbg, Dwarf_Die die, Dwarf_Addr low_pc,
-    char *ret_name_buf, int ret_name_buf_len,
-    void **pcMap)
+/*  TRUE if dbg is an executable or shared object, so its
+    addresses are final.  Anything else, and an object we
+    cannot tell, is treated as relocatable. */
+static boolean
+object_is_linked(Dwarf_Debug dbg)
+{
+    Elf *elf = 0;
+    Elf32_Ehdr *eh32 = 0;
+    Dwarf_Error err = 0;
+    int res = 0;
+
+    res = dwarf_get_elf(dbg, &elf, &err);
+    if (res != DW_DLV_OK) {
+        if (res == DW_DLV_ERROR) {
+            dwarf_dealloc(dbg, err, DW_DLA_ERROR);
+        }
+        return FALSE;
+    }
+    eh32 = elf32_getehdr(elf);
+    if (eh32) {
+        return eh32->e_type == ET_EXEC || eh32->e_type == ET_DYN;
+    }
+#ifdef HAVE_ELF64_GETEHDR
+    {
+        Elf64_Ehdr *eh64 = elf64_getehdr(elf);
+
+        if (eh64) {
+            return eh64->e_type == ET_EXEC ||
+                eh64->e_type == ET_DYN;
+        }
+    }
+#endif /* HAVE_ELF64_GETEHDR */
+    return FALSE;
+}
+
+/*  Add the ranges of a subprogram DIE, if it has a name and
+    code. Errors just leave the subprogram out. */
+static void
+proc_map_add_die(Dwarf_Debug dbg, Dwarf_Die die,
+    Dwarf_Addr cu_base, struct proc_map_s *map)
 {
     char name_buf[BUFSIZ];
-    Dwarf_Die curdie = die;
-    int die_locally_gotten = 0;
-    Dwarf_Die prev_child = 0;
-    Dwarf_Die newchild = 0;
-    Dwarf_Die newsibling = 0;
-    Dwarf_Half tag;
-    Dwarf_Error nested_err = 0;
-    int chres = DW_DLV_OK;
-
-    ret_name_buf[0] = 0;
+    Dwarf_Addr low = 0;
+    Dwarf_Addr high = 0;
+    Dwarf_Half form = 0;
+    enum Dwarf_Form_Class class = DW_FORM_CLASS_UNKNOWN;
+    Dwarf_Attribute attr = 0;
+    Dwarf_Off rangesoff = 0;
+    Dwarf_Ranges *rangeset = 0;
+    Dwarf_Signed rangecount = 0;
+    Dwarf_Unsigned bytecount = 0;
+    Dwarf_Signed i = 0;
+    Dwarf_Error err = 0;
+    int res = 0;
+
     name_buf[0] = 0;
-    while (chres == DW_DLV_OK) {
-        int tres;
-
-        tres = dwarf_tag(curdie, &tag, &nested_err);
-        newchild = 0;
-        if (tres == DW_DLV_OK) {
-            int lchres = 0;
-
-            if (tag == DW_TAG_subprogram) {
-                int proc_name_v = get_proc_name(dbg, curdie, low_pc,
-                    name_buf, BUFSIZ,pcMap);
-                if (proc_name_v) {
-                    safe_strcpy(ret_name_buf, ret_name_buf_len,
-                        name_buf, (long) strlen(name_buf));
-                    if (die_locally_gotten) {
-                        /*  If we got this die from the parent, we do
-                            not want to dealloc here! */
-                        dwarf_dealloc(dbg, curdie, DW_DLA_DIE);
-                    }
-                    return 1;
-                }
-                /* Check children of subprograms recursively should
-                    this really be check children of anything,
-                    or just children of subprograms? */
-
-                lchres = dwarf_child(curdie, &newchild, &nested_err);
-                if (lchres == DW_DLV_OK) {
-                    /* look for inner subprogram */
-                    int newprog =
-                        load_nested_proc_name(dbg, newchild, low_pc,
-                            name_buf, BUFSIZ,
-                            pcMap);
-
-                    dwarf_dealloc(dbg, newchild, DW_DLA_DIE);
-                    if (newprog) {
-                        /*  Found it.  We could just take this name or
-                            we could concatenate names together For now,
-                            just take name */
-                        if (die_locally_gotten) {
-                            /*  If we got this die from the parent, we
-                                do not want to dealloc here! */
-                            dwarf_dealloc(dbg, curdie, DW_DLA_DIE);
-                        }
-                        safe_strcpy(ret_name_buf, ret_name_buf_len,
-                            name_buf, (long) strlen(name_buf));
-                        return 1;
-                    }
-                } else if (lchres == DW_DLV_NO_ENTRY) {
-                    /* nothing to do */
-                } else {
-                    load_CU_error_data(dbg, current_cu_die_for_print_frames);
-                    print_error(dbg,
-                        "load_nested_proc_name dwarf_child() failed ",
-                        lchres, nested_err);
-                    if (die_locally_gotten) {
-                        /*  If we got this die from the parent, we do
-                            not want to dealloc here! */
-                        dwarf_dealloc(dbg, curdie, DW_DLA_DIE);
-                    }
-                    return 0;
-                }
-            }                   /* end if TAG_subprogram */
-        } else {
-            load_CU_error_data(dbg, current_cu_die_for_print_frames);
-            print_error(dbg, "no tag on child read ", tres, nested_err);
-            if (die_locally_gotten) {
-                /*  If we got this die from the parent, we do not want
-                    to dealloc here! */
-                dwarf_dealloc(dbg, curdie, DW_DLA_DIE);
-            }
-            return 0;
-        }
-        /* try next sibling */
-        prev_child = curdie;
-        chres = dwarf_siblingof(dbg, curdie, &newsibling, &nested_err);
-        if (chres == DW_DLV_ERROR) {
-            load_CU_error_data(dbg, current_cu_die_for_print_frames);
-            print_error(dbg, "dwarf_cu_header On Child read ", chres,
-                nested_err);
-            if (die_locally_gotten) {
-                /*  If we got this die from the parent, we do not want
-                    to dealloc here! */
-                dwarf_dealloc(dbg, curdie, DW_DLA_DIE);
-            }
-            return 0;
-        } else if (chres == DW_DLV_NO_ENTRY) {
-            if (die_locally_gotten) {
-                /*  If we got this die from the parent, we do not want
-                    to dealloc here! */
-                dwarf_dealloc(dbg, prev_child, DW_DLA_DIE);
+    get_proc_name(dbg, die, 0, name_buf, BUFSIZ);
+    if (!name_buf[0]) {
+        return;
+    }
+    res = dwarf_lowpc(die, &low, &err);
+    if (res == DW_DLV_OK) {
+        res = dwarf_highpc_b(die, &high, &form, &class, &err);
+        if (res == DW_DLV_OK) {
+            if (class == DW_FORM_CLASS_CONSTANT) {
+                high += low;
             }
-            return 0;/* proc name not at this level */
         } else {
-            /* DW_DLV_OK */
-            curdie = newsibling;
-            if (die_locally_gotten) {
-                /*  If we got this die from the parent, we do not want
-                    to dealloc here! */
-                dwarf_dealloc(dbg, prev_child, DW_DLA_DIE);
+            if (res == DW_DLV_ERROR) {
+                dwarf_dealloc(dbg, err, DW_DLA_ERROR);
+                err = 0;
             }
-            prev_child = 0;
-            die_locally_gotten = 1;
+            high = low;
         }
+        proc_map_add(map, low, high, name_buf);
+        return;
+    }
+    if (res == DW_DLV_ERROR) {
+        dwarf_dealloc(dbg, err, DW_DLA_ERROR);
+        return;
+    }
 
+    /*  No DW_AT_low_pc. A function split into hot and cold
+        parts has DW_AT_ranges instead. */
+    res = dwarf_attr(die, DW_AT_ranges, &attr, &err);
+    if (res != DW_DLV_OK) {
+        if (res == DW_DLV_ERROR) {
+            dwarf_dealloc(dbg, err, DW_DLA_ERROR);
+        }
+        return;
     }
-    if (die_locally_gotten) {
-        /*  If we got this die from the parent, we do not want to
-            dealloc here! */
-        dwarf_dealloc(dbg, curdie, DW_DLA_DIE);
+    res = dwarf_global_formref(attr, &rangesoff, &err);
+    dwarf_dealloc(dbg, attr, DW_DLA_ATTR);
+    if (res == DW_DLV_OK) {
+        res = dwarf_get_ranges_a(dbg, rangesoff, die,
+            &rangeset, &rangecount, &bytecount, &err);
+    }
+    if (res != DW_DLV_OK) {
+        if (res == DW_DLV_ERROR) {
+            dwarf_dealloc(dbg, err, DW_DLA_ERROR);
+        }
+        return;
+    }
+    for (i = 0; i < rangecount; ++i) {
+        Dwarf_Ranges *r = rangeset + i;
+
+        if (r->dwr_type == DW_RANGES_END) {
+            break;
+        }
+        if (r->dwr_type == DW_RANGES_ADDRESS_SELECTION) {
+            cu_base = r->dwr_addr2;
+            continue;
+        }
+        proc_map_add(map, cu_base + r->dwr_addr1,
+            cu_base + r->dwr_addr2, name_buf);
     }
-    return 0;
+    dwarf_ranges_dealloc(dbg, rangeset, rangecount);
 }
 
-/*  For SGI MP Fortran and other languages, functions
-    nest!  As a result, we must dig thru all functions,
-    not just the top level.
-    This remembers the CU die and restarts each search at the start
-    of  the current cu.
-*/
-static char*
-get_fde_proc_name(Dwarf_Debug dbg, Dwarf_Addr low_pc,
-    const char *frame_section_name,
-    void **pcMap,
-    int *all_cus_seen)
+/*  Walks a list of sibling DIEs adding every subprogram.
+    Subprograms nest in some languages (SGI MP Fortran for
+    example), and C++ puts them in namespaces, so those
+    children are walked too.  Errors end the walk of this
+    list only. */
+static void
+proc_map_add_dies(Dwarf_Debug dbg, Dwarf_Die die,
+    Dwarf_Addr cu_base, struct proc_map_s *map)
 {
-    static char proc_name[BUFSIZ];
-    Dwarf_Unsigned cu_header_length = 0;
-    Dwarf_Unsigned abbrev_offset = 0;
-    Dwarf_Half version_stamp = 0;
-    Dwarf_Half address_size = 0;
-    Dwarf_Unsigned next_cu_offset = 0;
-    int cures = DW_DLV_OK;
-    int dres = DW_DLV_OK;
-    int chres = DW_DLV_OK;
-    int looping = 0;
-    Dwarf_Error pnerr = 0;
+    Dwarf_Die curdie = die;
+    Dwarf_Error err = 0;
 
-    proc_name[0] = 0;
-    {
-        struct Addr_Map_Entry *ame = 0;
-        ame = addr_map_find(low_pc,pcMap);
-        if (ame && ame->mp_name) {
-            /* mp_name is only NULL here if we just ran out of heap memory! */
-            safe_strcpy(proc_name, sizeof(proc_name),
-                ame->mp_name,(long) strlen(ame->mp_name));
-            return proc_name;
+    for (;;) {
+        Dwarf_Half tag = 0;
+        Dwarf_Die sibling = 0;
+        int res = 0;
+
+        res = dwarf_tag(curdie, &tag, &err);
+        if (res == DW_DLV_OK) {
+            boolean walk_children = FALSE;
+
+            switch (tag) {
+            case DW_TAG_subprogram:
+                proc_map_add_die(dbg, curdie, cu_base, map);
+                walk_children = TRUE;
+                break;
+            case DW_TAG_lexical_block:
+            case DW_TAG_namespace:
+            case DW_TAG_module:
+                walk_children = TRUE;
+                break;
+            default:
+                break;
+            }
+            if (walk_children) {
+                Dwarf_Die child = 0;
+
+                res = dwarf_child(curdie, &child, &err);
+                if (res == DW_DLV_OK) {
+                    proc_map_add_dies(dbg, child, cu_base, map);
+                    dwarf_dealloc(dbg, child, DW_DLA_DIE);
+                }
+            }
         }
-        if (*all_cus_seen) {
-            return "";
+        if (res == DW_DLV_ERROR) {
+            dwarf_dealloc(dbg, err, DW_DLA_ERROR);
+            err = 0;
         }
-    }
-    if (current_cu_die_for_print_frames == NULL) {
-        /* Call depends on dbg->cu_context to know what to do. */
-        cures = dwarf_next_cu_header(dbg, &cu_header_length,
-            &version_stamp, &abbrev_offset,
-            &address_size, &next_cu_offset,
-            &pnerr);
-        if (cures == DW_DLV_ERROR) {
-            /*  If there is a serious error in DIE information
-                we just skip looking for a procedure name.
-                Perhaps we should report something? */
-            return NULL;
-        } else if (cures == DW_DLV_NO_ENTRY) {
-            /* loop thru the list again */
-            current_cu_die_for_print_frames = 0;
-            ++looping;
-        } else {                /* DW_DLV_OK */
-            dres = dwarf_siblingof(dbg, NULL,
-                &current_cu_die_for_print_frames,
-                &pnerr);
-            if (dres == DW_DLV_ERROR) {
-                /*  If there is a serious error in DIE information
-                    we just skip looking for a procedure name.
-                    Perhaps we should report something? */
-                return NULL;
+        res = dwarf_siblingof(dbg, curdie, &sibling, &err);
+        if (curdie != die) {
+            dwarf_dealloc(dbg, curdie, DW_DLA_DIE);
+        }
+        if (res != DW_DLV_OK) {
+            if (res == DW_DLV_ERROR) {
+                dwarf_dealloc(dbg, err, DW_DLA_ERROR);
             }
+            return;
         }
+        curdie = sibling;
     }
-    if (dres == DW_DLV_OK) {
-        Dwarf_Die child = 0;
+}
 
-        if (current_cu_die_for_print_frames == 0) {
-            /*  no information. Possibly a stripped file */
-            return NULL;
-        }
-        chres =
-            dwarf_child(current_cu_die_for_print_frames, &child, &pnerr);
-        if (chres == DW_DLV_ERROR) {
-            print_error(dbg, "dwarf_cu_header on child read ", chres,
-                pnerr);
-        } else if (chres == DW_DLV_NO_ENTRY) {
-        } else {                /* DW_DLV_OK */
-            int gotname =
-                load_nested_proc_name(dbg, child, low_pc, proc_name,
-                    BUFSIZ,pcMap);
+/*  Adds the subprograms of one CU. The CU header
+    has just been read. Returns DW_DLV_NO_ENTRY if
+    CU die cannot be read. */
+static int
+proc_map_add_cu(Dwarf_Debug dbg, struct proc_map_s *map,
+    Dwarf_Off *cu_offset)
+{
+    Dwarf_Die cu_die = 0;
+    Dwarf_Die child = 0;
+    Dwarf_Addr cu_base = 0;
+    Dwarf_Off cu_length = 0;
+    Dwarf_Error err = 0;
+    int res = 0;
 
-            dwarf_dealloc(dbg, child, DW_DLA_DIE);
-            if (gotname) {
-                return (proc_name);
-            }
-            child = 0;
+    res = dwarf_siblingof(dbg, NULL, &cu_die, &err);
+    if (res != DW_DLV_OK) {
+        if (res == DW_DLV_ERROR) {
+            dwarf_dealloc(dbg, err, DW_DLA_ERROR);
         }
+        return DW_DLV_NO_ENTRY;
+    }
+    res = dwarf_die_CU_offset_range(cu_die, cu_offset, &cu_length, &err);
+    if (res == DW_DLV_ERROR) {
+        dwarf_dealloc(dbg, err, DW_DLA_ERROR);
+        err = 0;
     }
+    if (current_cu_die_for_print_frames) {
+        dwarf_dealloc(dbg, current_cu_die_for_print_frames, DW_DLA_DIE);
+    }
+    /*  For PRINT_CU_INFO() should get_proc_name() fail. */
+    current_cu_die_for_print_frames = cu_die;
+    res = dwarf_lowpc(cu_die, &cu_base, &err);
+    if (res == DW_DLV_ERROR) {
+        dwarf_dealloc(dbg, err, DW_DLA_ERROR);
+        err = 0;
+    }
+    res = dwarf_child(cu_die, &child, &err);
+    if (res == DW_DLV_OK) {
+        proc_map_add_dies(dbg, child, cu_base, map);
+        dwarf_dealloc(dbg, child, DW_DLA_DIE);
+    } else if (res == DW_DLV_ERROR) {
+        dwarf_dealloc(dbg, err, DW_DLA_ERROR);
+    }
+    reset_overall_CU_error_data();
+    return DW_DLV_OK;
+}
+
+/*  One pass over all of .debug_info.  The CU iteration may
+    already be part way through the section (it continues
+    where print_info() or anyone else left it), so once it
+    wraps around we go on up to the first CU seen. */
+static void
+proc_map_build(Dwarf_Debug dbg, struct proc_map_s *map)
+{
+    Dwarf_Unsigned cu_header_length = 0;
+    Dwarf_Unsigned abbrev_offset = 0;
+    Dwarf_Half version_stamp = 0;
+    Dwarf_Half address_size = 0;
+    Dwarf_Unsigned next_cu_offset = 0;
+    Dwarf_Off first_cu_offset = 0;
+    boolean first_cu = TRUE;
+    boolean wrapped = FALSE;
+    Dwarf_Error err = 0;
+
+    map->pm_built = TRUE;
+    map->pm_linked = object_is_linked(dbg);
     for (;;) {
-        Dwarf_Die ldie = 0;
+        Dwarf_Off cu_offset = 0;
+        int res = 0;
 
-        cures = dwarf_next_cu_header(dbg, &cu_header_length,
+        res = dwarf_next_cu_header(dbg, &cu_header_length,
             &version_stamp, &abbrev_offset,
             &address_size, &next_cu_offset,
-            &pnerr);
-        if (cures != DW_DLV_OK) {
-            *all_cus_seen = 1;
+            &err);
+        if (res == DW_DLV_ERROR) {
+            /*  If there is a serious error in DIE information
+                we just skip looking for more procedure names. */
+            dwarf_dealloc(dbg, err, DW_DLA_ERROR);
             break;
         }
-
-        dres = dwarf_siblingof(dbg, NULL, &ldie, &pnerr);
-        if (current_cu_die_for_print_frames) {
-            dwarf_dealloc(dbg, current_cu_die_for_print_frames,
-                DW_DLA_DIE);
-        }
-        current_cu_die_for_print_frames = 0;
-        if (dres == DW_DLV_ERROR) {
-            char buf [100];
-            snprintf(buf,sizeof(buf),
-                "dwarf_cu_header Child Read finding proc name for %s",
-                frame_section_name);
-            print_error(dbg,
-                buf, chres, pnerr);
-            continue;
-        } else if (dres == DW_DLV_NO_ENTRY) {
-            ++looping;
-            if (looping > 1) {
-                print_error(dbg, "looping  on cu headers!", dres, pnerr);
-                return NULL;
+        if (res == DW_DLV_NO_ENTRY) {
+            if (wrapped || first_cu || !first_cu_offset) {
+                break;
             }
+            wrapped = TRUE;
             continue;
         }
-        /*  DW_DLV_OK
-            In normal processing (ie, when doing print_info()
-            we would call print_attribute for each die
-            including cu_die and thus get CU_base_address,
-            CU_high_address, PU_base_address, PU_high_address,
-            CU_name for PRINT_CU_INFO() in case of error.  */
-        current_cu_die_for_print_frames = ldie;
-        {
-            int chpfres = 0;
-            Dwarf_Die child = 0;
-
-            chpfres =
-                dwarf_child(current_cu_die_for_print_frames, &child,
-                    &pnerr);
-            if (chpfres == DW_DLV_ERROR) {
-                load_CU_error_data(dbg,current_cu_die_for_print_frames);
-                print_error(dbg, "dwarf Child Read ", chpfres, pnerr);
-            } else if (chpfres == DW_DLV_NO_ENTRY) {
-
-                ;/* do nothing, loop on cu */
-            } else {
-                /* DW_DLV_OK) */
-
-                int gotname =
-                    load_nested_proc_name(dbg, child, low_pc, proc_name,
-                        BUFSIZ,pcMap);
-
-                dwarf_dealloc(dbg, child, DW_DLA_DIE);
-                if (gotname) {
-                    return (proc_name);
-                }
-            }
+        res = proc_map_add_cu(dbg, map, &cu_offset);
+        if (res != DW_DLV_OK) {
+            break;
+        }
+        if (first_cu) {
+            first_cu_offset = cu_offset;
+            first_cu = FALSE;
+        } else if (wrapped && cu_offset >= first_cu_offset) {
+            break;
         }
-        reset_overall_CU_error_data();
     }
-    return (NULL);
+    proc_map_sort(map);
+}
+
+/*  Returns the name of the subprogram for an FDE starting
+    at low_pc, or NULL. See proc_map.c.  */
+static char*
+get_fde_proc_name(Dwarf_Debug dbg, Dwarf_Addr low_pc,
+    struct proc_map_s *map)
+{
+    if (!map->pm_built) {
+        proc_map_build(dbg, map);
+    }
+    return proc_map_lookup(map, low_pc);
 }
 
 /*  Gather the fde print logic here so the control logic
@@ -710,9 +693,8 @@ print_one_fde(Dwarf_Debug dbg,
     Dwarf_Half version,
     int        is_eh,
     struct dwconf_s *config_data,
-    void    ** pcMap,
-    void    ** lowpcSet,
-    int     *  all_cus_seen)
+    struct proc_map_s *procMap,
+    void    ** lowpcSet)
 {
     Dwarf_Addr j = 0;
     Dwarf_Addr low_pc = 0;
@@ -756,8 +738,7 @@ print_one_fde(Dwarf_Debug dbg,
         temps = 0;
     } else {
         struct Addr_Map_Entry *mp = 0;
-        temps = get_fde_proc_name(dbg, low_pc,
-            frame_section_name,pcMap,all_cus_seen);
+        temps = get_fde_proc_name(dbg, low_pc, procMap);
         mp = addr_map_find(low_pc,lowpcSet);
         if (glflags.gf_check_frames || glflags.gf_check_frames_extended) {
             DWARF_CHECK_COUNT(fde_duplication,1);
@@ -788,24 +769,26 @@ print_one_fde(Dwarf_Debug dbg,
     }
 
     /* Do not print if in check mode */
-    if (glflags.gf_do_print_dwarf) {
+    if (glflags.gf_do_print_dwarf && !RECORDING) {
         /* Printing the FDE header. */
-        printf("<%5" DW_PR_DSd ">"
-            "<0x%" DW_PR_XZEROS  DW_PR_DUx
-            ":0x%" DW_PR_XZEROS DW_PR_DUx
-            "><%s>"
-            "<cie offset 0x%" DW_PR_XZEROS DW_PR_DUx ":"
-            ":cie index %5"  DW_PR_DUu ">"
-            "<fde offset 0x%" DW_PR_XZEROS DW_PR_DUx
-            " length: 0x%" DW_PR_XZEROS  DW_PR_DUx ">",
-            fde_index,
-            (Dwarf_Unsigned)low_pc,
-            (Dwarf_Unsigned)(low_pc + func_length),
-            temps ? sanitized(temps) : "",
-            (Dwarf_Unsigned)cie_offset,
-            (Dwarf_Unsigned)cie_index,
-            (Dwarf_Unsigned)fde_offset,
-            fde_bytes_length);
+        outbuf_char('<');
+        outbuf_signed((Dwarf_Signed)fde_index,5);
+        outbuf_string("><");
+        outbuf_hex((Dwarf_Unsigned)low_pc,OUTBUF_XZEROS_DIGITS);
+        outbuf_char(':');
+        outbuf_hex((Dwarf_Unsigned)(low_pc + func_length),
+            OUTBUF_XZEROS_DIGITS);
+        outbuf_string("><");
+        outbuf_string(temps ? sanitized(temps) : "");
+        outbuf_string("><cie offset ");
+        outbuf_hex((Dwarf_Unsigned)cie_offset,OUTBUF_XZEROS_DIGITS);
+        outbuf_string("::cie index ");
+        outbuf_unsigned((Dwarf_Unsigned)cie_index,5);
+        outbuf_string("><fde offset ");
+        outbuf_hex((Dwarf_Unsigned)fde_offset,OUTBUF_XZEROS_DIGITS);
+        outbuf_string(" length: ");
+        outbuf_hex(fde_bytes_length,OUTBUF_XZEROS_DIGITS);
+        outbuf_char('>');
     }
 
 
@@ -813,7 +796,7 @@ print_one_fde(Dwarf_Debug dbg,
     if (!is_eh) {
         /* IRIX uses eh_table_offset. No one else uses it. */
         /* Do not print if in check mode */
-        if (glflags.gf_do_print_dwarf) {
+        if (glflags.gf_do_print_dwarf && !RECORDING) {
             if (eh_table_offset == DW_DLX_NO_EH_OFFSET) {
                 printf("<eh offset %s>\n", "none");
             } else if (eh_table_offset == DW_DLX_EH_OFFSET_UNAVAILABLE) {
@@ -833,7 +816,7 @@ print_one_fde(Dwarf_Debug dbg,
         if (ares == DW_DLV_NO_ENTRY) {
             /* do nothing. */
         } else if (ares == DW_DLV_OK) {
-            if (glflags.gf_do_print_dwarf) {
+            if (glflags.gf_do_print_dwarf && !RECORDING) {
                 unsigned k2 = 0;
 
                 printf("\n       <eh aug data len 0x%" DW_PR_DUx , len);
@@ -849,7 +832,7 @@ print_one_fde(Dwarf_Debug dbg,
             print_error(dbg, "dwarf_get_fde_augmentation_data", ares, oneferr);
         }
         /* Do not print if in check mode */
-        if (glflags.gf_do_print_dwarf) {
+        if (glflags.gf_do_print_dwarf && !RECORDING) {
             printf("\n");
         }
     }
@@ -900,17 +883,29 @@ print_one_fde(Dwarf_Debug dbg,
             }
             /* Do not print if in check mode */
             if (!printed_intro_addr && glflags.gf_do_print_dwarf) {
-                printf("        0x%" DW_PR_XZEROS DW_PR_DUx
-                    ": ", (Dwarf_Unsigned)jsave);
+                if (RECORDING) {
+                    record_frame_row_begin(fde_offset,is_eh,jsave);
+                } else {
+                    outbuf_spaces(8);
+                    outbuf_hex((Dwarf_Unsigned)jsave,
+                        OUTBUF_XZEROS_DIGITS);
+                    outbuf_string(": ");
+                }
                 printed_intro_addr = 1;
             }
-            print_one_frame_reg_col(dbg, config_data->cf_cfa_reg,
-                value_type,
-                reg,
-                address_size,
-                offset_size,version,
-                config_data,
-                offset_relevant, offset, block_ptr);
+            if (RECORDING) {
+                /*  -1 is the CFA in a record. */
+                record_one_frame_reg_col(-1,value_type,reg,
+                    config_data,offset_relevant,offset);
+            } else {
+                print_one_frame_reg_col(dbg, config_data->cf_cfa_reg,
+                    value_type,
+                    reg,
+                    address_size,
+                    offset_size,version,
+                    config_data,
+                    offset_relevant, offset, block_ptr);
+            }
         }
         for (k = 0; k < config_data->cf_table_entry_count; k++) {
             Dwarf_Signed reg = 0;
@@ -965,20 +960,34 @@ print_one_fde(Dwarf_Debug dbg,
 
             /* Do not print if in check mode */
             if (!printed_intro_addr && glflags.gf_do_print_dwarf) {
-                printf("        0x%" DW_PR_XZEROS DW_PR_DUx ": ",
-                    (Dwarf_Unsigned)j);
+                if (RECORDING) {
+                    record_frame_row_begin(fde_offset,is_eh,j);
+                } else {
+                    outbuf_spaces(8);
+                    outbuf_hex((Dwarf_Unsigned)j,OUTBUF_XZEROS_DIGITS);
+                    outbuf_string(": ");
+                }
                 printed_intro_addr = 1;
             }
-            print_one_frame_reg_col(dbg,k,
-                value_type,
-                reg,
-                address_size,
-                offset_size,version,
-                config_data,
-                offset_relevant, offset, block_ptr);
+            if (RECORDING) {
+                record_one_frame_reg_col(k,value_type,reg,
+                    config_data,offset_relevant,offset);
+            } else {
+                print_one_frame_reg_col(dbg,k,
+                    value_type,
+                    reg,
+                    address_size,
+                    offset_size,version,
+                    config_data,
+                    offset_relevant, offset, block_ptr);
+            }
         }
         if (printed_intro_addr) {
-            printf("\n");
+            if (RECORDING) {
+                record_frame_row_end();
+            } else {
+                outbuf_char('\n');
+            }
             printed_intro_addr = 0;
         }
     }
@@ -998,7 +1007,7 @@ print_one_fde(Dwarf_Debug dbg,
                 &oneferr);
         if (offres == DW_DLV_OK) {
             /* Do not print if in check mode */
-            if (glflags.gf_do_print_dwarf) {
+            if (glflags.gf_do_print_dwarf && !RECORDING) {
                 printf(" fde section offset %" DW_PR_DUu
                     " 0x%" DW_PR_XZEROS DW_PR_DUx
                     " cie offset for fde: %" DW_PR_DUu
@@ -1057,7 +1066,7 @@ print_one_fde(Dwarf_Debug dbg,
                 ; /* ? */
             } else {
                 /* Do not print if in check mode */
-                if (glflags.gf_do_print_dwarf) {
+                if (glflags.gf_do_print_dwarf && !RECORDING) {
                     print_frame_inst_bytes(dbg, instrs,
                         (Dwarf_Signed) ilen,
                         data_alignment_factor,
@@ -1315,6 +1324,16 @@ lastop_pointless(int op)
     return false;
 }
 
+/*  Same as printf("\t%2u %s",off,name). */
+static void
+print_inst_head(unsigned off, const char *name)
+{
+    outbuf_char('\t');
+    outbuf_unsigned(off,2);
+    outbuf_char(' ');
+    outbuf_string(name);
+}
+
 /*  Print the frame instructions in detail for a glob of instructions.
 */
 /*ARGSUSED*/ static void
@@ -1356,13 +1375,13 @@ print_frame_inst_bytes(Dwarf_Debug dbg,
         switch (top) {
         case DW_CFA_advance_loc:
             delta = ibyte & 0x3f;
-            printf("\t%2u DW_CFA_advance_loc %d", off,
-                (int) (delta * code_alignment_factor));
+            print_inst_head(off,"DW_CFA_advance_loc ");
+            outbuf_signed((int) (delta * code_alignment_factor),0);
             if (verbose) {
                 printf("  (%d * %d)", (int) delta,
                     (int) code_alignment_factor);
             }
-            printf("\n");
+            outbuf_char('\n');
             break;
         case DW_CFA_offset:
             loff = off;
@@ -1376,22 +1395,23 @@ print_frame_inst_bytes(Dwarf_Debug dbg,
             instp += uleblen;
             len -= uleblen;
             off += uleblen;
-            printf("\t%2u DW_CFA_offset ", loff);
+            print_inst_head(loff,"DW_CFA_offset ");
             printreg(reg, config_data);
-            printf(" %" DW_PR_DSd , (Dwarf_Signed)
-                (((Dwarf_Signed) uval) * data_alignment_factor));
+            outbuf_char(' ');
+            outbuf_signed((Dwarf_Signed)
+                (((Dwarf_Signed) uval) * data_alignment_factor),0);
             if (verbose) {
                 printf("  (%" DW_PR_DUu " * %" DW_PR_DSd ")", uval,
                     data_alignment_factor);
             }
-            printf("\n");
+            outbuf_char('\n');
             break;
 
         case DW_CFA_restore:
             reg = ibyte & 0x3f;
-            printf("\t%2u DW_CFA_restore ", off);
+            print_inst_head(off,"DW_CFA_restore ");
             printreg(reg, config_data);
-            printf("\n");
+            outbuf_char('\n');
             break;
 
         default:
@@ -1436,8 +1456,9 @@ print_frame_inst_bytes(Dwarf_Debug dbg,
                 instp += 1;
                 len -= 1;
                 off += 1;
-                printf("\t%2u DW_CFA_advance_loc1 %" DW_PR_DUu "\n",
-                    loff, uval2);
+                print_inst_head(loff,"DW_CFA_advance_loc1 ");
+                outbuf_unsigned(uval2,0);
+                outbuf_char('\n');
                 break;
             case DW_CFA_advance_loc2:
                 memcpy(&u16, instp + 1, 2);
@@ -1445,8 +1466,9 @@ print_frame_inst_bytes(Dwarf_Debug dbg,
                 instp += 2;
                 len -= 2;
                 off += 2;
-                printf("\t%2u DW_CFA_advance_loc2 %" DW_PR_DUu "\n",
-                    loff,  uval2);
+                print_inst_head(loff,"DW_CFA_advance_loc2 ");
+                outbuf_unsigned(uval2,0);
+                outbuf_char('\n');
                 break;
             case DW_CFA_advance_loc4:
                 memcpy(&u32, instp + 1, 4);
@@ -1454,8 +1476,9 @@ print_frame_inst_bytes(Dwarf_Debug dbg,
                 instp += 4;
                 len -= 4;
                 off += 4;
-                printf("\t%2u DW_CFA_advance_loc4 %" DW_PR_DUu "\n",
-                    loff, uval2);
+                print_inst_head(loff,"DW_CFA_advance_loc4 ");
+                outbuf_unsigned(uval2,0);
+                outbuf_char('\n');
                 break;
             case DW_CFA_MIPS_advance_loc8:
                 memcpy(&u64, instp + 1, 8);
@@ -1565,10 +1588,10 @@ print_frame_inst_bytes(Dwarf_Debug dbg,
                 printf("\n");
                 break;
             case DW_CFA_remember_state:
-                printf("\t%2u DW_CFA_remember_state\n", loff);
+                print_inst_head(loff,"DW_CFA_remember_state\n");
                 break;
             case DW_CFA_restore_state:
-                printf("\t%2u DW_CFA_restore_state\n", loff);
+                print_inst_head(loff,"DW_CFA_restore_state\n");
                 break;
             case DW_CFA_def_cfa:
                 res = local_dwarf_decode_u_leb128_chk(instp + 1, &uleblen,
@@ -1589,10 +1612,11 @@ print_frame_inst_bytes(Dwarf_Debug dbg,
                 instp += uleblen;
                 len -= uleblen;
                 off += uleblen;
-                printf("\t%2u DW_CFA_def_cfa ", loff);
+                print_inst_head(loff,"DW_CFA_def_cfa ");
                 printreg( uval, config_data);
-                printf(" %" DW_PR_DUu , (unsigned long long) uval2);
-                printf("\n");
+                outbuf_char(' ');
+                outbuf_unsigned(uval2,0);
+                outbuf_char('\n');
                 break;
             case DW_CFA_def_cfa_register:
                 res = local_dwarf_decode_u_leb128_chk(instp + 1, &uleblen,
@@ -1604,9 +1628,9 @@ print_frame_inst_bytes(Dwarf_Debug dbg,
                 instp += uleblen;
                 len -= uleblen;
                 off += uleblen;
-                printf("\t%2u DW_CFA_def_cfa_register ", loff);
+                print_inst_head(loff,"DW_CFA_def_cfa_register ");
                 printreg(uval, config_data);
-                printf("\n");
+                outbuf_char('\n');
                 break;
             case DW_CFA_def_cfa_offset:
                 res = local_dwarf_decode_u_leb128_chk(instp + 1, &uleblen,
@@ -1618,12 +1642,13 @@ print_frame_inst_bytes(Dwarf_Debug dbg,
                 instp += uleblen;
                 len -= uleblen;
                 off += uleblen;
-                printf("\t%2u DW_CFA_def_cfa_offset %" DW_PR_DUu "\n",
-                    loff, uval);
+                print_inst_head(loff,"DW_CFA_def_cfa_offset ");
+                outbuf_unsigned(uval,0);
+                outbuf_char('\n');
                 break;
 
             case DW_CFA_nop:
-                printf("\t%2u DW_CFA_nop\n", loff);
+                print_inst_head(loff,"DW_CFA_nop\n");
                 break;
 
             case DW_CFA_def_cfa_expression:     /* DWARF3 */
@@ -2084,21 +2109,28 @@ print_one_frame_reg_col(Dwarf_Debug dbg,
         if (reg_used == config_data->cf_initial_rule_value) {
             break;
         }
-        if (print_type_title)
-            printf("<%s ", type_title);
+        if (print_type_title) {
+            outbuf_char('<');
+            outbuf_string(type_title);
+            outbuf_char(' ');
+        }
         printreg(rule_id, config_data);
-        printf("=");
+        outbuf_char('=');
         if (offset_relevant == 0) {
             printreg(reg_used, config_data);
-            printf(" ");
+            outbuf_char(' ');
         } else {
-            printf("%02" DW_PR_DSd , offset);
-            printf("(");
+            /*  As printf("%02lld"). */
+            if (offset >= 0 && offset < 10) {
+                outbuf_char('0');
+            }
+            outbuf_signed(offset,0);
+            outbuf_char('(');
             printreg(reg_used, config_data);
-            printf(") ");
+            outbuf_string(") ");
         }
         if (print_type_title)
-            printf("%s", "> ");
+            outbuf_string("> ");
         break;
     case DW_EXPR_EXPRESSION:
         type_title = "expr";
@@ -2107,13 +2139,16 @@ print_one_frame_reg_col(Dwarf_Debug dbg,
         type_title = "valexpr";
 
         pexp2:
-        if (print_type_title)
-            printf("<%s ", type_title);
+        if (print_type_title) {
+            outbuf_char('<');
+            outbuf_string(type_title);
+            outbuf_char(' ');
+        }
         printreg(rule_id, config_data);
-        printf("=");
-        printf("expr-block-len=%" DW_PR_DSd , offset);
+        outbuf_string("=expr-block-len=");
+        outbuf_signed(offset,0);
         if (print_type_title)
-            printf("%s", "> ");
+            outbuf_string("> ");
         if (verbose) {
             char pref[40];
 
@@ -2141,6 +2176,27 @@ print_one_frame_reg_col(Dwarf_Debug dbg,
     return;
 }
 
+/*  -x format=: the record form of print_one_frame_reg_col(),
+    leaving out the same rules it leaves out. */
+static void
+record_one_frame_reg_col(Dwarf_Signed rule_id,
+    Dwarf_Small value_type,
+    Dwarf_Unsigned reg_used,
+    struct dwconf_s *config_data,
+    Dwarf_Signed offset_relevant,
+    Dwarf_Signed offset)
+{
+    if ((value_type == DW_EXPR_OFFSET ||
+        value_type == DW_EXPR_VAL_OFFSET) &&
+        reg_used == config_data->cf_initial_rule_value) {
+        return;
+    }
+    record_frame_rule(rule_id,value_type,
+        (reg_used == config_data->cf_cfa_reg)? -1:
+        (Dwarf_Signed)reg_used,
+        offset_relevant,offset);
+}
+
 
 /*  get all the data in .debug_frame (or .eh_frame).
     The '3' versions mean print using the dwarf3 new interfaces.
@@ -2158,10 +2214,11 @@ print_frames(Dwarf_Debug dbg,
     Dwarf_Half offset_size = 0;
     Dwarf_Half version = 0;
     int framed = 0;
-    void * map_lowpc_to_name = 0;
+    struct proc_map_s proc_map;
     Dwarf_Error err = 0;
 
     current_section_id = DEBUG_FRAME;
+    memset(&proc_map, 0, sizeof(proc_map));
 
     /*  The address size here will not be right for all frames.
         Only in DWARF4 is there a real address size known
@@ -2179,7 +2236,6 @@ print_frames(Dwarf_Debug dbg,
         Dwarf_Signed fde_element_count = 0;
         int frame_count = 0;
         int cie_count = 0;
-        int all_cus_seen = 0;
         void * lowpcSet = 0;
         const char *frame_section_name = 0;
         int silent_if_missing = 0;
@@ -2271,9 +2327,8 @@ print_frames(Dwarf_Debug dbg,
                     i, cie_data, cie_element_count,
                     address_size, offset_size, version,
                     is_eh, config_data,
-                    &map_lowpc_to_name,
-                    &lowpcSet,
-                    &all_cus_seen);
+                    &proc_map,
+                    &lowpcSet);
                 ++frame_count;
                 if (frame_count >= break_after_n_units) {
                     break;
@@ -2302,8 +2357,7 @@ print_frames(Dwarf_Debug dbg,
         dwarf_dealloc(dbg, current_cu_die_for_print_frames, DW_DLA_DIE);
         current_cu_die_for_print_frames = 0;
     }
-    addr_map_destroy(map_lowpc_to_name);
-    map_lowpc_to_name = 0;
+    proc_map_destroy(&proc_map);
 }
 
 
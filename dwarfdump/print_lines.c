@@ -30,6 +30,8 @@
 #include "dwconf.h"
 #include "esb.h"
 #include "uri.h"
+#include "outbuf.h"
+#include "records.h"
 #include <ctype.h>
 #include <time.h>
 
@@ -89,6 +91,54 @@ record_line_error(const char *where, Dwarf_Error line_err)
     }
 }
 
+/*  For record_line(): the CU whose lines are being printed. */
+static Dwarf_Off line_record_cu_goffset;
+
+/*  -x format=: one line row as a record. */
+static void
+record_line_row(Dwarf_Debug dbg, Dwarf_Line line, int table,
+    Dwarf_Addr pc, Dwarf_Unsigned lineno, Dwarf_Unsigned column,
+    const char *filename)
+{
+    Dwarf_Bool b = 0;
+    Dwarf_Bool prologue_end = 0;
+    Dwarf_Bool epilogue_begin = 0;
+    Dwarf_Unsigned isa = 0;
+    Dwarf_Unsigned discriminator = 0;
+    unsigned flags = 0;
+    Dwarf_Error err = 0;
+    int res = 0;
+
+    res = dwarf_linebeginstatement(line,&b,&err);
+    if (res == DW_DLV_OK && b) {
+        flags |= RECORD_LINE_NS;
+    }
+    DROP_ERROR_INSTANCE(dbg,res,err);
+    res = dwarf_lineblock(line,&b,&err);
+    if (res == DW_DLV_OK && b) {
+        flags |= RECORD_LINE_BB;
+    }
+    DROP_ERROR_INSTANCE(dbg,res,err);
+    res = dwarf_lineendsequence(line,&b,&err);
+    if (res == DW_DLV_OK && b) {
+        flags |= RECORD_LINE_ET;
+    }
+    DROP_ERROR_INSTANCE(dbg,res,err);
+    res = dwarf_prologue_end_etc(line,&prologue_end,&epilogue_begin,
+        &isa,&discriminator,&err);
+    if (res == DW_DLV_OK) {
+        if (prologue_end) {
+            flags |= RECORD_LINE_PE;
+        }
+        if (epilogue_begin) {
+            flags |= RECORD_LINE_EB;
+        }
+    }
+    DROP_ERROR_INSTANCE(dbg,res,err);
+    record_line(line_record_cu_goffset,table,pc,lineno,column,
+        flags,filename,discriminator);
+}
+
 static void
 process_line_table(Dwarf_Debug dbg,
     const char *sec_name,
@@ -254,6 +304,20 @@ process_line_table(Dwarf_Debug dbg,
             }
         }
 
+        if (RECORDING) {
+            /*  The record replaces the text and the checks. */
+            record_line_row(dbg,line,
+                is_logicals_table? RECORD_LINE_LOGICALS:
+                (is_actuals_table? RECORD_LINE_ACTUALS:
+                RECORD_LINE_TABLE),
+                pc,is_actuals_table? logicalno: lineno,column,
+                is_actuals_table? NULL: filename);
+            if (!is_actuals_table && sres == DW_DLV_OK) {
+                dwarf_dealloc(dbg, filename, DW_DLA_STRING);
+            }
+            continue;
+        }
+
         /*  Process any possible error condition, though
             we won't be at the first such error. */
         if (glflags.gf_check_decl_file && checking_this_compiler()) {
@@ -365,16 +429,25 @@ process_line_table(Dwarf_Debug dbg,
         }
         if (glflags.gf_do_print_dwarf) {
             if (is_logicals_table || is_actuals_table) {
-                printf("[%4" DW_PR_DUu "]  ", i + 1);
+                outbuf_char('[');
+                outbuf_unsigned(i + 1,4);
+                outbuf_string("]  ");
             }
             /* Check if print of <pc> address is needed. */
             if (glflags.gf_line_print_pc) {
-                printf("0x%" DW_PR_XZEROS DW_PR_DUx "  ", pc);
+                outbuf_hex(pc,OUTBUF_XZEROS_DIGITS);
+                outbuf_string("  ");
             }
             if (is_actuals_table) {
-                printf("[%7" DW_PR_DUu "]", logicalno);
+                outbuf_char('[');
+                outbuf_unsigned(logicalno,7);
+                outbuf_char(']');
             } else {
-                printf("[%4" DW_PR_DUu ",%2" DW_PR_DUu "]", lineno, column);
+                outbuf_char('[');
+                outbuf_unsigned(lineno,4);
+                outbuf_char(',');
+                outbuf_unsigned(column,2);
+                outbuf_char(']');
             }
         }
 
@@ -382,7 +455,7 @@ process_line_table(Dwarf_Debug dbg,
             nsres = dwarf_linebeginstatement(line, &newstatement, &lt_err);
             if (nsres == DW_DLV_OK) {
                 if (newstatement && glflags.gf_do_print_dwarf) {
-                    printf(" %s","NS");
+                    outbuf_string(" NS");
                 }
             } else if (nsres == DW_DLV_ERROR) {
                 print_error(dbg, "linebeginstatment failed", nsres, lt_err);
@@ -393,7 +466,7 @@ process_line_table(Dwarf_Debug dbg,
             nsres = dwarf_lineblock(line, &new_basic_block, &lt_err);
             if (nsres == DW_DLV_OK) {
                 if (new_basic_block && glflags.gf_do_print_dwarf) {
-                    printf(" %s","BB");
+                    outbuf_string(" BB");
                 }
             } else if (nsres == DW_DLV_ERROR) {
                 print_error(dbg, "lineblock failed", nsres, lt_err);
@@ -401,7 +474,7 @@ process_line_table(Dwarf_Debug dbg,
             nsres = dwarf_lineendsequence(line, &lineendsequence, &lt_err);
             if (nsres == DW_DLV_OK) {
                 if (lineendsequence && glflags.gf_do_print_dwarf) {
-                    printf(" %s", "ET");
+                    outbuf_string(" ET");
                 }
             } else if (nsres == DW_DLV_ERROR) {
                 print_error(dbg, "lineendsequence failed", nsres, lt_err);
@@ -421,16 +494,18 @@ process_line_table(Dwarf_Debug dbg,
                     disres, lt_err);
             }
             if (prologue_end && !is_actuals_table) {
-                printf(" PE");
+                outbuf_string(" PE");
             }
             if (epilogue_begin && !is_actuals_table) {
-                printf(" EB");
+                outbuf_string(" EB");
             }
             if (isa && !is_logicals_table) {
-                printf(" IS=0x%" DW_PR_DUx, isa);
+                outbuf_string(" IS=");
+                outbuf_hex(isa,0);
             }
             if (discriminator && !is_actuals_table) {
-                printf(" DI=0x%" DW_PR_DUx, discriminator);
+                outbuf_string(" DI=");
+                outbuf_hex(discriminator,0);
             }
             if (is_logicals_table) {
                 call_context = 0;
@@ -468,7 +543,7 @@ process_line_table(Dwarf_Debug dbg,
                 translate_to_uri(filename,&urs);
                 esb_append(&urs,"\"");
                 if (glflags.gf_do_print_dwarf) {
-                    printf("%s",esb_get_string(&urs));
+                    outbuf_esb(&urs);
                 }
                 esb_destructor(&urs);
                 esb_empty_string(&lastsrc);
@@ -480,7 +555,7 @@ process_line_table(Dwarf_Debug dbg,
         }
 
         if (glflags.gf_do_print_dwarf) {
-            printf("\n");
+            outbuf_char('\n');
         }
     }
     esb_destructor(&lastsrc);
@@ -672,6 +747,7 @@ print_line_numbers_this_cu(Dwarf_Debug dbg, Dwarf_Die cu_die)
     atres = dwarf_die_offsets(cu_die,&dieprint_cu_goffset,
         &cudie_local_offset,&err);
     DROP_ERROR_INSTANCE(dbg,atres,err);
+    line_record_cu_goffset = dieprint_cu_goffset;
 
     if (glflags.gf_do_print_dwarf) {
         printf("\n%s: line number info for a single cu\n", sec_name);
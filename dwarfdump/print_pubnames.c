@@ -29,6 +29,7 @@ v Portions Copyright 2009-2011 SN Systems Ltd. All rights reserved.
 #include "naming.h"
 #include "dwconf.h"
 #include "esb.h"
+#include "records.h"
 #include "print_sections.h"
 
 /*  This unifies the code for some error checks to
@@ -129,8 +130,12 @@ print_pubname_style_entry(Dwarf_Debug dbg,
             dwarf_dealloc(dbg, cu_die, DW_DLA_DIE);
         }
     }
+    if (RECORDING) {
+        /*  The record replaces the text. */
+        record_pubname(line_title,name,die_off,cu_off);
+    }
     /* Display offsets */
-    if (glflags.gf_display_offsets) {
+    if (glflags.gf_display_offsets && !RECORDING) {
         /* Print 'name'at the end for better layout */
         printf("%s die-in-sect 0x%" DW_PR_XZEROS DW_PR_DUx
             ", cu-in-sect 0x%" DW_PR_XZEROS DW_PR_DUx ","
@@ -151,12 +156,14 @@ print_pubname_style_entry(Dwarf_Debug dbg,
     }
 
     /* Display offsets */
-    if (glflags.gf_display_offsets && verbose) {
+    if (glflags.gf_display_offsets && verbose && !RECORDING) {
         printf(" cuhdr 0x%" DW_PR_XZEROS DW_PR_DUx , global_cu_offset);
     }
 
     /* Print 'name'at the end for better layout */
-    printf(" '%s'\n",name);
+    if (!RECORDING) {
+        printf(" '%s'\n",name);
+    }
 
     dwarf_dealloc(dbg, die, DW_DLA_DIE);
 
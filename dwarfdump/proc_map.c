@@ -0,0 +1,248 @@
+/*
+  Copyright 2018 David Anderson. All rights reserved.
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of version 2 of the GNU General Public License as
+  published by the Free Software Foundation.
+
+  This program is distributed in the hope that it would be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  Further, this software is distributed without any warranty that it is
+  free of the rightful claim of any third person regarding infringement
+  or the like.  Any license provided herein, whether implied or
+  otherwise, applies only to this software file.  Patent licenses, if
+  any, provided herein do not apply to combinations of this program with
+  other software, or any other product whatsoever.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write the Free Software Foundation, Inc., 51
+  Franklin Street - Fifth Floor, Boston MA 02110-1301, USA.
+*/
+
+/*  See proc_map.h.
+
+    An FDE gets the name of the subprogram starting exactly
+    at its low pc, the first one in DIE order if there are
+    several.  In an executable or shared object an FDE that
+    starts inside a subprogram (the cold part of a function,
+    say) is named for the innermost subprogram holding its
+    low pc, with the offset appended.  In a relocatable
+    object addresses are section offsets, so that fallback
+    would name an FDE after whatever function in some other
+    section covers the same offset, and is not done. */
+
+#include "globals.h"
+#include "proc_map.h"
+
+#define PROC_MAP_DELTA 256
+
+void
+proc_map_add(struct proc_map_s *map,
+    Dwarf_Addr low, Dwarf_Addr high, const char *name)
+{
+    struct proc_range_s *r = 0;
+
+    if (map->pm_count == map->pm_size) {
+        Dwarf_Unsigned newsize = map->pm_size + PROC_MAP_DELTA;
+        struct proc_range_s *newranges = (struct proc_range_s *)
+            realloc(map->pm_ranges,
+            newsize * sizeof(struct proc_range_s));
+
+        if (!newranges) {
+            /*  Out of memory. Some FDEs go unnamed. */
+            return;
+        }
+        map->pm_ranges = newranges;
+        map->pm_size = newsize;
+    }
+    r = map->pm_ranges + map->pm_count;
+    r->pr_name = strdup(name);
+    if (!r->pr_name) {
+        return;
+    }
+    r->pr_low = low;
+    r->pr_high = (high > low)? high : low;
+    r->pr_order = map->pm_count;
+    map->pm_count++;
+}
+
+static int
+proc_range_compare(const void *l, const void *r)
+{
+    const struct proc_range_s *pl = l;
+    const struct proc_range_s *pr = r;
+
+    if (pl->pr_low < pr->pr_low) {
+        return -1;
+    }
+    if (pl->pr_low > pr->pr_low) {
+        return 1;
+    }
+    if (pl->pr_order < pr->pr_order) {
+        return -1;
+    }
+    if (pl->pr_order > pr->pr_order) {
+        return 1;
+    }
+    return 0;
+}
+
+void
+proc_map_sort(struct proc_map_s *map)
+{
+    Dwarf_Unsigned i = 0;
+
+    if (!map->pm_count) {
+        return;
+    }
+    qsort(map->pm_ranges, map->pm_count,
+        sizeof(struct proc_range_s), proc_range_compare);
+    map->pm_max_high = (Dwarf_Addr *)malloc(map->pm_count *
+        sizeof(Dwarf_Addr));
+    if (!map->pm_max_high) {
+        return;
+    }
+    for (i = 0; i < map->pm_count; ++i) {
+        Dwarf_Addr high = map->pm_ranges[i].pr_high;
+
+        if (i && map->pm_max_high[i-1] > high) {
+            high = map->pm_max_high[i-1];
+        }
+        map->pm_max_high[i] = high;
+    }
+}
+
+void
+proc_map_destroy(struct proc_map_s *map)
+{
+    Dwarf_Unsigned i = 0;
+
+    for (i = 0; i < map->pm_count; ++i) {
+        free(map->pm_ranges[i].pr_name);
+    }
+    free(map->pm_ranges);
+    free(map->pm_max_high);
+    memset(map, 0, sizeof(*map));
+}
+
+char *
+proc_map_lookup(struct proc_map_s *map, Dwarf_Addr low_pc)
+{
+    static char proc_name[BUFSIZ];
+    Dwarf_Unsigned lo = 0;
+    Dwarf_Unsigned hi = 0;
+    Dwarf_Unsigned j = 0;
+
+    if (!map->pm_max_high) {
+        return NULL;
+    }
+    /*  lo becomes the index of the first range with
+        pr_low >= low_pc. */
+    hi = map->pm_count;
+    while (lo < hi) {
+        Dwarf_Unsigned mid = lo + (hi - lo)/2;
+
+        if (map->pm_ranges[mid].pr_low < low_pc) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < map->pm_count && map->pm_ranges[lo].pr_low == low_pc) {
+        return map->pm_ranges[lo].pr_name;
+    }
+    if (!map->pm_linked) {
+        return NULL;
+    }
+    /*  Every range before lo starts below low_pc. The
+        nearest one holding low_pc is the innermost. */
+    for (j = lo; j > 0; --j) {
+        struct proc_range_s *r = map->pm_ranges + j - 1;
+
+        if (map->pm_max_high[j-1] <= low_pc) {
+            break;
+        }
+        if (r->pr_high > low_pc) {
+            snprintf(proc_name, sizeof(proc_name),
+                "%s+0x%" DW_PR_DUx, r->pr_name,
+                (Dwarf_Unsigned)(low_pc - r->pr_low));
+            return proc_name;
+        }
+    }
+    return NULL;
+}
+
+#ifdef SELFTEST
+struct lookup_test_s {
+    Dwarf_Addr  lt_pc;
+    const char *lt_linked;
+    const char *lt_relocatable;
+};
+
+/*  outer [0x100,0x200) holds inner [0x140,0x180).  In a
+    relocatable object other [0x0,0x40) and cold [0x10,0x20)
+    would be in different sections, but look nested. */
+static struct lookup_test_s lookup_tests[] = {
+{0x100, "outer",        "outer"},
+{0x104, "outer+0x4",    0},
+{0x140, "inner",        "inner"},
+{0x150, "inner+0x10",   0},
+{0x180, "outer+0x80",   0},
+{0x200, 0,              0},
+{0x0,   "other",        "other"},
+{0x10,  "cold",         "cold"},
+{0x18,  "cold+0x8",     0},
+{0x30,  "other+0x30",   0},
+{0x50,  0,              0},
+{0,0,0}
+};
+
+static int
+run_lookup_tests(boolean linked)
+{
+    struct proc_map_s map;
+    struct lookup_test_s *lt = lookup_tests;
+    int failcount = 0;
+
+    memset(&map, 0, sizeof(map));
+    map.pm_linked = linked;
+    proc_map_add(&map, 0x100, 0x200, "outer");
+    proc_map_add(&map, 0x140, 0x180, "inner");
+    proc_map_add(&map, 0x0, 0x40, "other");
+    proc_map_add(&map, 0x10, 0x20, "cold");
+    proc_map_sort(&map);
+    for ( ; lt->lt_linked || lt->lt_pc; ++lt) {
+        const char *want = linked? lt->lt_linked:
+            lt->lt_relocatable;
+        const char *got = proc_map_lookup(&map, lt->lt_pc);
+
+        if ((!want != !got) || (want && strcmp(want, got))) {
+            printf("FAIL %s lookup of 0x%" DW_PR_DUx
+                ": \"%s\" not \"%s\"\n",
+                linked? "linked": "relocatable",
+                (Dwarf_Unsigned)lt->lt_pc,
+                got? got: "<none>", want? want: "<none>");
+            failcount++;
+        }
+    }
+    proc_map_destroy(&map);
+    return failcount;
+}
+
+int
+main(void)
+{
+    int failcount = 0;
+
+    failcount += run_lookup_tests(TRUE);
+    failcount += run_lookup_tests(FALSE);
+    if (failcount) {
+        printf("FAIL proc_map selftest\n");
+        return 1;
+    }
+    printf("PASS proc_map selftest\n");
+    return 0;
+}
+#endif /* SELFTEST */
@@ -0,0 +1,66 @@
+/*
+  Copyright 2018 David Anderson. All rights reserved.
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of version 2 of the GNU General Public License as
+  published by the Free Software Foundation.
+
+  This program is distributed in the hope that it would be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  Further, this software is distributed without any warranty that it is
+  free of the rightful claim of any third person regarding infringement
+  or the like.  Any license provided herein, whether implied or
+  otherwise, applies only to this software file.  Patent licenses, if
+  any, provided herein do not apply to combinations of this program with
+  other software, or any other product whatsoever.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write the Free Software Foundation, Inc., 51
+  Franklin Street - Fifth Floor, Boston MA 02110-1301, USA.
+*/
+#ifndef PROC_MAP_H
+#define PROC_MAP_H
+
+/*  A sorted map of subprogram address ranges, used to name
+    FDEs.  print_frames.c fills it from .debug_info the first
+    time an FDE name is wanted.  New 2018. */
+struct proc_range_s {
+    Dwarf_Addr     pr_low;
+    /*  One past the end. Equal to pr_low if unknown. */
+    Dwarf_Addr     pr_high;
+    /*  Order found, so equal low pcs keep DIE order. */
+    Dwarf_Unsigned pr_order;
+    char          *pr_name;
+};
+struct proc_map_s {
+    boolean               pm_built;
+    /*  TRUE for an executable or shared object.  In a
+        relocatable object every code section starts at
+        address 0, so a range holding an address may well
+        be in another section than the address is. */
+    boolean               pm_linked;
+    Dwarf_Unsigned        pm_count;
+    Dwarf_Unsigned        pm_size;
+    struct proc_range_s  *pm_ranges;
+    /*  pm_max_high[i] is the largest pr_high in
+        pm_ranges[0] through pm_ranges[i]. */
+    Dwarf_Addr           *pm_max_high;
+};
+
+/*  Adds [low,high) named name.  Out of memory just
+    leaves it out. */
+void proc_map_add(struct proc_map_s *map,
+    Dwarf_Addr low, Dwarf_Addr high, const char *name);
+
+/*  Sorts the map once every range is added. */
+void proc_map_sort(struct proc_map_s *map);
+
+/*  The name of the subprogram for an FDE starting at
+    low_pc, or NULL.  See proc_map.c. */
+char *proc_map_lookup(struct proc_map_s *map, Dwarf_Addr low_pc);
+
+void proc_map_destroy(struct proc_map_s *map);
+
+#endif /* PROC_MAP_H */
@@ -0,0 +1,699 @@
+/*
+  Copyright 2018 David Anderson. All rights reserved.
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of version 2 of the GNU General Public License as
+  published by the Free Software Foundation.
+
+  This program is distributed in the hope that it would be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  Further, this software is distributed without any warranty that it is
+  free of the rightful claim of any third person regarding infringement
+  or the like.  Any license provided herein, whether implied or
+  otherwise, applies only to this software file.  Patent licenses, if
+  any, provided herein do not apply to combinations of this program with
+  other software, or any other product whatsoever.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write the Free Software Foundation, Inc., 51
+  Franklin Street - Fifth Floor, Boston MA 02110-1301, USA.
+*/
+
+/*  See records.h.
+    A record is built up in rec_data and written out whole
+    when it ends, so a binary record can be prefixed by its
+    length.  Only one record is ever being built. */
+
+#include "globals.h"
+#ifdef HAVE_UNISTD_H
+#include <unistd.h> /* for dup() dup2() */
+#endif
+#include "naming.h"
+#include "esb.h"
+#include "records.h"
+
+#define RECORDS_BUFSIZE (256*1024)
+
+static FILE *rec_file;
+static unsigned char *rec_data;
+static size_t rec_len;
+static size_t rec_alloc;
+/*  JSON: a member has been written at this nesting level. */
+static boolean rec_need_comma;
+static boolean rec_in_frame_row;
+
+static boolean
+rec_is_json(void)
+{
+    return glflags.gf_record_format == RECORD_FORMAT_JSONL;
+}
+
+static void
+rec_reserve(size_t n)
+{
+    unsigned char *newdata = 0;
+    size_t newalloc = 0;
+
+    if (rec_len + n <= rec_alloc) {
+        return;
+    }
+    newalloc = rec_alloc? rec_alloc * 2: 1024;
+    while (newalloc < rec_len + n) {
+        newalloc *= 2;
+    }
+    newdata = (unsigned char *)realloc(rec_data,newalloc);
+    if (!newdata) {
+        fprintf(stderr,
+            "dwarfdump is out of memory allocating %lu bytes "
+            "for a record\n",(unsigned long)newalloc);
+        exit(FAILED);
+    }
+    rec_data = newdata;
+    rec_alloc = newalloc;
+}
+
+static void
+rec_put(const void *p, size_t n)
+{
+    rec_reserve(n);
+    memcpy(rec_data + rec_len,p,n);
+    rec_len += n;
+}
+
+static void
+rec_putc(int c)
+{
+    rec_reserve(1);
+    rec_data[rec_len++] = (unsigned char)c;
+}
+
+static void
+rec_put_string(const char *s)
+{
+    rec_put(s,strlen(s));
+}
+
+static void
+rec_uleb(Dwarf_Unsigned v)
+{
+    do {
+        unsigned char byte = v & 0x7f;
+
+        v >>= 7;
+        if (v) {
+            byte |= 0x80;
+        }
+        rec_putc(byte);
+    } while (v);
+}
+
+static void
+rec_sleb(Dwarf_Signed v)
+{
+    for (;;) {
+        unsigned char byte = v & 0x7f;
+
+        /*  Arithmetic shift, so sign bits come in. */
+        v = (v < 0)? ~(~v >> 7): v >> 7;
+        if ((v == 0 && !(byte & 0x40)) ||
+            (v == -1 && (byte & 0x40))) {
+            rec_putc(byte);
+            return;
+        }
+        rec_putc(byte | 0x80);
+    }
+}
+
+static void
+rec_json_string(const char *s)
+{
+    static const char hexdigits[] = "0123456789abcdef";
+    const unsigned char *p = (const unsigned char *)s;
+
+    rec_putc('"');
+    for ( ; *p; ++p) {
+        unsigned c = *p;
+
+        if (c == '"' || c == '\\') {
+            rec_putc('\\');
+            rec_putc(c);
+        } else if (c < 0x20 || c == 0x7f) {
+            rec_put_string("\\u00");
+            rec_putc(hexdigits[c >> 4]);
+            rec_putc(hexdigits[c & 0xf]);
+        } else {
+            rec_putc(c);
+        }
+    }
+    rec_putc('"');
+}
+
+static void
+rec_json_unsigned(Dwarf_Unsigned v)
+{
+    char buf[ESB_NUMBER_BUF_LEN];
+    char *end = buf + sizeof(buf);
+    char *p = esb_format_unsigned(end,v,10,0);
+
+    rec_put(p,end - p);
+}
+
+/*  JSON only: separator and "name": of a member.
+    name is NULL for list members. */
+static void
+rec_name(const char *name)
+{
+    if (rec_need_comma) {
+        rec_putc(',');
+    }
+    rec_need_comma = TRUE;
+    if (name) {
+        rec_putc('"');
+        rec_put_string(name);
+        rec_put_string("\":");
+    }
+}
+
+static void
+rec_begin(int kind, const char *kindname)
+{
+    rec_len = 0;
+    if (rec_is_json()) {
+        rec_put_string("{\"kind\":\"");
+        rec_put_string(kindname);
+        rec_putc('"');
+        rec_need_comma = TRUE;
+    } else {
+        /*  Room for the length. */
+        rec_put("\0\0\0\0",4);
+        rec_uleb(kind);
+    }
+}
+
+static void
+rec_end(void)
+{
+    if (rec_is_json()) {
+        rec_put_string("}\n");
+    } else {
+        Dwarf_Unsigned len = rec_len - 4;
+
+        rec_data[0] = len & 0xff;
+        rec_data[1] = (len >> 8) & 0xff;
+        rec_data[2] = (len >> 16) & 0xff;
+        rec_data[3] = (len >> 24) & 0xff;
+    }
+    fwrite(rec_data,1,rec_len,rec_file);
+    rec_len = 0;
+}
+
+static void
+rec_uint(const char *name, Dwarf_Unsigned v)
+{
+    if (rec_is_json()) {
+        rec_name(name);
+        rec_json_unsigned(v);
+    } else {
+        rec_putc('u');
+        rec_uleb(v);
+    }
+}
+
+static void
+rec_sint(const char *name, Dwarf_Signed v)
+{
+    if (rec_is_json()) {
+        rec_name(name);
+        if (v < 0) {
+            rec_putc('-');
+            rec_json_unsigned(0ULL - (Dwarf_Unsigned)v);
+        } else {
+            rec_json_unsigned((Dwarf_Unsigned)v);
+        }
+    } else {
+        rec_putc('s');
+        rec_sleb(v);
+    }
+}
+
+static void
+rec_flag(const char *name, int v)
+{
+    if (rec_is_json()) {
+        rec_name(name);
+        rec_put_string(v? "true": "false");
+    } else {
+        rec_putc('f');
+        rec_putc(v? 1: 0);
+    }
+}
+
+static void
+rec_null(const char *name)
+{
+    if (rec_is_json()) {
+        rec_name(name);
+        rec_put_string("null");
+    } else {
+        rec_putc('n');
+    }
+}
+
+static void
+rec_str(const char *name, const char *s)
+{
+    if (rec_is_json()) {
+        rec_name(name);
+        rec_json_string(s);
+    } else {
+        size_t len = strlen(s);
+
+        rec_putc('t');
+        rec_uleb(len);
+        rec_put(s,len);
+    }
+}
+
+static void
+rec_bytes(const char *name, const unsigned char *p,
+    Dwarf_Unsigned len)
+{
+    if (rec_is_json()) {
+        static const char hexdigits[] = "0123456789abcdef";
+        Dwarf_Unsigned i = 0;
+
+        rec_name(name);
+        rec_putc('"');
+        rec_reserve(len * 2);
+        for (i = 0; i < len; ++i) {
+            rec_putc(hexdigits[p[i] >> 4]);
+            rec_putc(hexdigits[p[i] & 0xf]);
+        }
+        rec_putc('"');
+    } else {
+        rec_putc('b');
+        rec_uleb(len);
+        rec_put(p,len);
+    }
+}
+
+/*  A DW_TAG, DW_AT or DW_FORM: its name in JSON,
+    its number in binary. */
+static void
+rec_code(const char *name, unsigned v, const char *vname)
+{
+    if (rec_is_json()) {
+        rec_str(name,vname);
+    } else {
+        rec_uint(name,v);
+    }
+}
+
+static void
+rec_list_begin(const char *name)
+{
+    if (rec_is_json()) {
+        rec_name(name);
+        rec_putc('[');
+        rec_need_comma = FALSE;
+    } else {
+        rec_putc('[');
+    }
+}
+
+static void
+rec_list_end(void)
+{
+    rec_putc(']');
+    rec_need_comma = TRUE;
+}
+
+static void
+rec_item_begin(void)
+{
+    if (rec_is_json()) {
+        rec_name(NULL);
+        rec_need_comma = FALSE;
+    }
+    rec_putc('{');
+}
+
+static void
+rec_item_end(void)
+{
+    rec_putc('}');
+    rec_need_comma = TRUE;
+}
+
+void
+records_open(void)
+{
+    if (!RECORDING || rec_file) {
+        return;
+    }
+    fflush(stdout);
+#ifdef HAVE_UNISTD_H
+    {
+        int fd = dup(fileno(stdout));
+
+        if (fd >= 0) {
+            rec_file = fdopen(fd,"wb");
+        }
+        if (rec_file) {
+            dup2(fileno(stderr),fileno(stdout));
+        } else if (fd >= 0) {
+            close(fd);
+        }
+    }
+#endif /* HAVE_UNISTD_H */
+    if (!rec_file) {
+        /*  Records and text share stdout. */
+        rec_file = stdout;
+    } else {
+        setvbuf(rec_file,NULL,_IOFBF,RECORDS_BUFSIZE);
+    }
+    if (glflags.gf_record_format == RECORD_FORMAT_BINARY) {
+        fwrite("dwdrec1\n",1,8,rec_file);
+    }
+}
+
+void
+records_close(void)
+{
+    if (rec_file && rec_file != stdout) {
+        fclose(rec_file);
+    } else if (rec_file) {
+        fflush(rec_file);
+    }
+    rec_file = 0;
+    free(rec_data);
+    rec_data = 0;
+    rec_len = 0;
+    rec_alloc = 0;
+}
+
+/*  The value of one attribute, by form. */
+static void
+rec_attr_value(Dwarf_Debug dbg, Dwarf_Attribute attr, Dwarf_Half form)
+{
+    Dwarf_Error err = 0;
+    int res = DW_DLV_NO_ENTRY;
+
+    switch (form) {
+    case DW_FORM_string:
+    case DW_FORM_strp:
+    case DW_FORM_line_strp:
+    case DW_FORM_strp_sup:
+    case DW_FORM_GNU_strp_alt:
+    case DW_FORM_strx:
+    case DW_FORM_strx1:
+    case DW_FORM_strx2:
+    case DW_FORM_strx3:
+    case DW_FORM_strx4:
+    case DW_FORM_GNU_str_index: {
+        char *s = 0;
+
+        res = dwarf_formstring(attr,&s,&err);
+        if (res == DW_DLV_OK) {
+            rec_str("v",s);
+        }
+        break;
+    }
+    case DW_FORM_ref1:
+    case DW_FORM_ref2:
+    case DW_FORM_ref4:
+    case DW_FORM_ref8:
+    case DW_FORM_ref_udata:
+    case DW_FORM_ref_addr:
+    case DW_FORM_ref_sup4:
+    case DW_FORM_ref_sup8:
+    case DW_FORM_GNU_ref_alt:
+    case DW_FORM_sec_offset: {
+        Dwarf_Off off = 0;
+
+        res = dwarf_global_formref(attr,&off,&err);
+        if (res == DW_DLV_OK) {
+            rec_uint("v",off);
+        }
+        break;
+    }
+    case DW_FORM_ref_sig8: {
+        Dwarf_Sig8 sig;
+
+        memset(&sig,0,sizeof(sig));
+        res = dwarf_formsig8(attr,&sig,&err);
+        if (res == DW_DLV_OK) {
+            rec_bytes("v",(unsigned char *)sig.signature,
+                sizeof(sig.signature));
+        }
+        break;
+    }
+    case DW_FORM_addr:
+    case DW_FORM_addrx:
+    case DW_FORM_addrx1:
+    case DW_FORM_addrx2:
+    case DW_FORM_addrx3:
+    case DW_FORM_addrx4:
+    case DW_FORM_GNU_addr_index: {
+        Dwarf_Addr addr = 0;
+
+        res = dwarf_formaddr(attr,&addr,&err);
+        if (res == DW_DLV_OK) {
+            rec_uint("v",addr);
+        }
+        break;
+    }
+    case DW_FORM_data1:
+    case DW_FORM_data2:
+    case DW_FORM_data4:
+    case DW_FORM_data8:
+    case DW_FORM_udata: {
+        Dwarf_Unsigned u = 0;
+
+        res = dwarf_formudata(attr,&u,&err);
+        if (res == DW_DLV_OK) {
+            rec_uint("v",u);
+        }
+        break;
+    }
+    case DW_FORM_sdata:
+    case DW_FORM_implicit_const: {
+        Dwarf_Signed s = 0;
+
+        res = dwarf_formsdata(attr,&s,&err);
+        if (res == DW_DLV_OK) {
+            rec_sint("v",s);
+        }
+        break;
+    }
+    case DW_FORM_data16: {
+        Dwarf_Form_Data16 d;
+
+        memset(&d,0,sizeof(d));
+        res = dwarf_formdata16(attr,&d,&err);
+        if (res == DW_DLV_OK) {
+            rec_bytes("v",(unsigned char *)d.fd_data,
+                sizeof(d.fd_data));
+        }
+        break;
+    }
+    case DW_FORM_flag:
+    case DW_FORM_flag_present: {
+        Dwarf_Bool flag = 0;
+
+        res = dwarf_formflag(attr,&flag,&err);
+        if (res == DW_DLV_OK) {
+            rec_flag("v",flag);
+        }
+        break;
+    }
+    case DW_FORM_block:
+    case DW_FORM_block1:
+    case DW_FORM_block2:
+    case DW_FORM_block4: {
+        Dwarf_Block *b = 0;
+
+        res = dwarf_formblock(attr,&b,&err);
+        if (res == DW_DLV_OK) {
+            rec_bytes("v",(unsigned char *)b->bl_data,b->bl_len);
+            dwarf_dealloc(dbg,b,DW_DLA_BLOCK);
+        }
+        break;
+    }
+    case DW_FORM_exprloc: {
+        Dwarf_Unsigned len = 0;
+        Dwarf_Ptr p = 0;
+
+        res = dwarf_formexprloc(attr,&len,&p,&err);
+        if (res == DW_DLV_OK) {
+            rec_bytes("v",(unsigned char *)p,len);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    if (res == DW_DLV_ERROR) {
+        dwarf_dealloc(dbg,err,DW_DLA_ERROR);
+    }
+    if (res != DW_DLV_OK) {
+        rec_null("v");
+    }
+}
+
+void
+record_die(Dwarf_Debug dbg, Dwarf_Die die,
+    Dwarf_Off die_goffset, int level, Dwarf_Half tag)
+{
+    Dwarf_Attribute *atlist = 0;
+    Dwarf_Signed atcnt = 0;
+    Dwarf_Signed i = 0;
+    Dwarf_Error err = 0;
+    int res = 0;
+
+    rec_begin(RECORD_KIND_DIE,"die");
+    rec_str("sec",dwarf_get_die_infotypes_flag(die)? "info": "types");
+    rec_uint("off",die_goffset);
+    rec_uint("level",level);
+    rec_code("tag",tag,get_TAG_name(tag,FALSE));
+    rec_list_begin("attrs");
+    res = dwarf_attrlist(die,&atlist,&atcnt,&err);
+    if (res == DW_DLV_ERROR) {
+        dwarf_dealloc(dbg,err,DW_DLA_ERROR);
+        err = 0;
+    }
+    for (i = 0; i < atcnt; ++i) {
+        Dwarf_Half attr = 0;
+        Dwarf_Half form = 0;
+
+        if (dwarf_whatattr(atlist[i],&attr,&err) != DW_DLV_OK ||
+            dwarf_whatform(atlist[i],&form,&err) != DW_DLV_OK) {
+            if (err) {
+                dwarf_dealloc(dbg,err,DW_DLA_ERROR);
+                err = 0;
+            }
+            dwarf_dealloc(dbg,atlist[i],DW_DLA_ATTR);
+            continue;
+        }
+        rec_item_begin();
+        rec_code("at",attr,get_AT_name(attr,FALSE));
+        rec_code("form",form,get_FORM_name(form,FALSE));
+        rec_attr_value(dbg,atlist[i],form);
+        rec_item_end();
+        dwarf_dealloc(dbg,atlist[i],DW_DLA_ATTR);
+    }
+    if (res == DW_DLV_OK) {
+        dwarf_dealloc(dbg,atlist,DW_DLA_LIST);
+    }
+    rec_list_end();
+    rec_end();
+}
+
+void
+record_line(Dwarf_Off cu_goffset, int table,
+    Dwarf_Addr pc, Dwarf_Unsigned line, Dwarf_Unsigned col,
+    unsigned flags, const char *file,
+    Dwarf_Unsigned discriminator)
+{
+    rec_begin(RECORD_KIND_LINE,"line");
+    rec_uint("cu",cu_goffset);
+    rec_uint("table",table);
+    rec_uint("pc",pc);
+    rec_uint("line",line);
+    rec_uint("col",col);
+    rec_uint("flags",flags);
+    if (file) {
+        rec_str("file",file);
+    } else {
+        rec_null("file");
+    }
+    rec_uint("discriminator",discriminator);
+    rec_end();
+}
+
+void
+record_frame_row_begin(Dwarf_Off fde_offset, int is_eh, Dwarf_Addr pc)
+{
+    rec_begin(RECORD_KIND_FRAME_ROW,"frame_row");
+    rec_uint("fde",fde_offset);
+    rec_flag("eh",is_eh);
+    rec_uint("pc",pc);
+    rec_list_begin("rules");
+    rec_in_frame_row = TRUE;
+}
+
+void
+record_frame_rule(Dwarf_Signed reg, Dwarf_Small value_type,
+    Dwarf_Signed breg, Dwarf_Signed offset_relevant,
+    Dwarf_Signed offset)
+{
+    const char *type = "off";
+
+    if (!rec_in_frame_row) {
+        return;
+    }
+    switch (value_type) {
+    case DW_EXPR_VAL_OFFSET:     type = "valoff"; break;
+    case DW_EXPR_EXPRESSION:     type = "expr"; break;
+    case DW_EXPR_VAL_EXPRESSION: type = "valexpr"; break;
+    default: break;
+    }
+    rec_item_begin();
+    rec_sint("reg",reg);
+    if (rec_is_json()) {
+        rec_str("type",type);
+    } else {
+        rec_uint("type",value_type);
+    }
+    if (value_type == DW_EXPR_EXPRESSION ||
+        value_type == DW_EXPR_VAL_EXPRESSION) {
+        rec_null("breg");
+        rec_sint("off",offset);
+    } else {
+        rec_sint("breg",breg);
+        if (offset_relevant) {
+            rec_sint("off",offset);
+        } else {
+            rec_null("off");
+        }
+    }
+    rec_item_end();
+}
+
+void
+record_frame_row_end(void)
+{
+    if (!rec_in_frame_row) {
+        return;
+    }
+    rec_list_end();
+    rec_end();
+    rec_in_frame_row = FALSE;
+}
+
+void
+record_arange(Dwarf_Off cu_die_offset,
+    Dwarf_Unsigned segment, Dwarf_Addr start,
+    Dwarf_Unsigned length)
+{
+    rec_begin(RECORD_KIND_ARANGE,"arange");
+    rec_uint("cu",cu_die_offset);
+    rec_uint("seg",segment);
+    rec_uint("start",start);
+    rec_uint("length",length);
+    rec_end();
+}
+
+void
+record_pubname(const char *title, const char *name,
+    Dwarf_Off die_offset, Dwarf_Off cu_offset)
+{
+    rec_begin(RECORD_KIND_PUBNAME,"pubname");
+    rec_str("title",title);
+    rec_str("name",name);
+    rec_uint("die",die_offset);
+    rec_uint("cu",cu_offset);
+    rec_end();
+}
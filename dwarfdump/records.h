@@ -0,0 +1,127 @@
+/*
+  Copyright 2018 David Anderson. All rights reserved.
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of version 2 of the GNU General Public License as
+  published by the Free Software Foundation.
+
+  This program is distributed in the hope that it would be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  Further, this software is distributed without any warranty that it is
+  free of the rightful claim of any third person regarding infringement
+  or the like.  Any license provided herein, whether implied or
+  otherwise, applies only to this software file.  Patent licenses, if
+  any, provided herein do not apply to combinations of this program with
+  other software, or any other product whatsoever.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write the Free Software Foundation, Inc., 51
+  Franklin Street - Fifth Floor, Boston MA 02110-1301, USA.
+*/
+#ifndef RECORDS_H
+#define RECORDS_H
+
+/*  -x format=jsonl and -x format=binary: instead of text,
+    write one record per DIE (.debug_info, .debug_types),
+    line table row, frame table row, arange and
+    pubnames-style entry.  New 2018.
+
+    Records go to standard output as they are found.
+    Anything else dwarfdump prints (section and CU
+    headers, errors, other sections) goes to standard
+    error.  Checking (-k) is not done on what is written
+    as records.
+
+    jsonl writes one JSON object per line.  The first
+    member is always "kind".  Integers are decimal, byte
+    blocks are strings of hex digits, strings are written
+    as they appear in the object, with '"', '\' and control
+    characters escaped.
+
+    binary starts with the 8 bytes "dwdrec1\n".  Each
+    record is a 4 byte little-endian length followed by
+    that many bytes: the kind (ULEB128) then the same
+    members as jsonl, in the same order, without names.
+    Each member starts with one type byte:
+        'u' ULEB128  's' SLEB128  'f' one byte 0 or 1
+        't' string: ULEB128 length then the bytes
+        'b' bytes:  ULEB128 length then the bytes
+        'n' no value
+        '[' ']' begin and end a list
+        '{' '}' begin and end a list member
+    Where jsonl has a DW_TAG, DW_AT or DW_FORM name or a
+    frame rule type binary has the number.  A member
+    with no value is null in jsonl. */
+
+#define RECORD_FORMAT_TEXT   0
+#define RECORD_FORMAT_JSONL  1
+#define RECORD_FORMAT_BINARY 2
+
+/*  Values of the kind member. */
+#define RECORD_KIND_DIE       1  /* "die" */
+#define RECORD_KIND_LINE      2  /* "line" */
+#define RECORD_KIND_FRAME_ROW 3  /* "frame_row" */
+#define RECORD_KIND_ARANGE    4  /* "arange" */
+#define RECORD_KIND_PUBNAME   5  /* "pubname" */
+
+/*  Flags of a line record. */
+#define RECORD_LINE_NS 0x01 /* is_stmt */
+#define RECORD_LINE_BB 0x02
+#define RECORD_LINE_ET 0x04
+#define RECORD_LINE_PE 0x08
+#define RECORD_LINE_EB 0x10
+
+/*  Which line table a line record is from. */
+#define RECORD_LINE_TABLE    0
+#define RECORD_LINE_LOGICALS 1
+#define RECORD_LINE_ACTUALS  2
+
+#define RECORDING (glflags.gf_record_format != RECORD_FORMAT_TEXT)
+
+/*  Called once the options are known.  Moves the text
+    output to stderr. */
+void records_open(void);
+void records_close(void);
+
+/*  die: sec ("info" or "types"), off (global), level,
+    tag, attrs: a list of {at, form, v}.  v is a reference
+    as a global offset, a number, a flag, a string or
+    bytes depending on the form. */
+void record_die(Dwarf_Debug dbg, Dwarf_Die die,
+    Dwarf_Off die_goffset, int level, Dwarf_Half tag);
+
+/*  line: cu (global offset of the CU DIE), table, pc,
+    line (the logical row for an actuals table), col,
+    flags, file (none for an actuals table),
+    discriminator. */
+void record_line(Dwarf_Off cu_goffset, int table,
+    Dwarf_Addr pc, Dwarf_Unsigned line, Dwarf_Unsigned col,
+    unsigned flags, const char *file,
+    Dwarf_Unsigned discriminator);
+
+/*  frame_row: fde (section offset), eh, pc, rules: a list
+    of {reg, type, breg, off}, reg or breg -1 is the CFA.
+    type is "off", "valoff", "expr" or "valexpr".  For
+    the expression types off is the block length and
+    there is no breg.  A register rule has no off. */
+void record_frame_row_begin(Dwarf_Off fde_offset,
+    int is_eh, Dwarf_Addr pc);
+void record_frame_rule(Dwarf_Signed reg, Dwarf_Small value_type,
+    Dwarf_Signed breg, Dwarf_Signed offset_relevant,
+    Dwarf_Signed offset);
+void record_frame_row_end(void);
+
+/*  arange: cu (global offset of the CU DIE), seg, start,
+    length. */
+void record_arange(Dwarf_Off cu_die_offset,
+    Dwarf_Unsigned segment, Dwarf_Addr start,
+    Dwarf_Unsigned length);
+
+/*  pubname: title (the section's entry title, for example
+    "global"), name, die and cu (global offsets). */
+void record_pubname(const char *title, const char *name,
+    Dwarf_Off die_offset, Dwarf_Off cu_offset);
+
+#endif /* RECORDS_H */
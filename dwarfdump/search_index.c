@@ -0,0 +1,822 @@
+/*
+  Copyright 2018 David Anderson. All rights reserved.
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of version 2 of the GNU General Public License as
+  published by the Free Software Foundation.
+
+  This program is distributed in the hope that it would be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  Further, this software is distributed without any warranty that it is
+  free of the rightful claim of any third person regarding infringement
+  or the like.  Any license provided herein, whether implied or
+  otherwise, applies only to this software file.  Patent licenses, if
+  any, provided herein do not apply to combinations of this program with
+  other software, or any other product whatsoever.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write the Free Software Foundation, Inc., 51
+  Franklin Street - Fifth Floor, Boston MA 02110-1301, USA.
+*/
+
+/*  See search_index.h.
+
+    The index is reduced to two sorted arrays of CU DIE
+    offsets: the CUs the index covers and, of those, the
+    CUs with an entry matching -S global=.  A CU in the
+    first and not the second is skipped.  .debug_pubnames
+    only covers the CUs that have at least one entry in it,
+    so a CU it says nothing about is always walked.
+
+    Every index lists the external functions and variables
+    a CU defines, which is all -S global= can match.  Other
+    names (locals, parameters, types) are missing from some
+    of them, so -S name= never uses an index. */
+
+#include "globals.h"
+#include "search_index.h"
+#include <ctype.h>
+
+/*  As in print_dnames.c. */
+#define DNAMES_MAX_VALUES 8
+
+struct offset_set_s {
+    Dwarf_Off     *os_offsets;
+    Dwarf_Unsigned os_count;
+    Dwarf_Unsigned os_allocated;
+};
+
+static struct offset_set_s si_covered;
+static struct offset_set_s si_listed;
+static boolean si_index_usable = FALSE;
+
+static size_t  si_name_len = 0;
+static boolean si_name_is_prefix = FALSE;
+
+/*  The longest literal every -S regex= match contains,
+    empty if none was found. */
+static char   *si_regex_literal = 0;
+
+static void
+offset_set_reset(struct offset_set_s *os)
+{
+    os->os_count = 0;
+}
+
+static boolean
+offset_set_add(struct offset_set_s *os,Dwarf_Off off)
+{
+    if (os->os_count && os->os_offsets[os->os_count-1] == off) {
+        return TRUE;
+    }
+    if (os->os_count == os->os_allocated) {
+        Dwarf_Unsigned newcount = os->os_allocated?
+            os->os_allocated * 2 : 64;
+        Dwarf_Off *newoffsets = (Dwarf_Off *)realloc(os->os_offsets,
+            newcount * sizeof(Dwarf_Off));
+
+        if (!newoffsets) {
+            return FALSE;
+        }
+        os->os_offsets = newoffsets;
+        os->os_allocated = newcount;
+    }
+    os->os_offsets[os->os_count++] = off;
+    return TRUE;
+}
+
+static int
+offset_compare(const void *l,const void *r)
+{
+    Dwarf_Off lo = *(const Dwarf_Off *)l;
+    Dwarf_Off ro = *(const Dwarf_Off *)r;
+
+    if (lo < ro) {
+        return -1;
+    }
+    if (lo > ro) {
+        return 1;
+    }
+    return 0;
+}
+
+/*  Sort and drop duplicates. */
+static void
+offset_set_finish(struct offset_set_s *os)
+{
+    Dwarf_Unsigned i = 0;
+    Dwarf_Unsigned out = 0;
+
+    if (!os->os_count) {
+        return;
+    }
+    qsort(os->os_offsets,os->os_count,sizeof(Dwarf_Off),
+        offset_compare);
+    for (i = 1; i < os->os_count; ++i) {
+        if (os->os_offsets[i] != os->os_offsets[out]) {
+            os->os_offsets[++out] = os->os_offsets[i];
+        }
+    }
+    os->os_count = out + 1;
+}
+
+static boolean
+offset_set_has(struct offset_set_s *os,Dwarf_Off off)
+{
+    if (!os->os_count) {
+        return FALSE;
+    }
+    return bsearch(&off,os->os_offsets,os->os_count,
+        sizeof(Dwarf_Off),offset_compare) != NULL;
+}
+
+boolean
+search_name_matches(const char *name)
+{
+    if (!search_name_text) {
+        return FALSE;
+    }
+    if (si_name_is_prefix) {
+        return !strncmp(name,search_name_text,si_name_len);
+    }
+    return !strcmp(name,search_name_text);
+}
+
+/*  Index names of C++ entities are qualified, and
+    .gdb_index may add the parameter types, so "ns::f"
+    and "ns::f(int)" are matches for global=f. */
+static boolean
+index_name_matches(const char *name)
+{
+    const char *last = name;
+    const char *cp = name;
+    const char *params = 0;
+    boolean res = FALSE;
+    char *copy = 0;
+
+    if (search_name_matches(name)) {
+        return TRUE;
+    }
+    for ( ; *cp && *cp != '('; ++cp) {
+        if (cp[0] == ':' && cp[1] == ':') {
+            last = cp + 2;
+            ++cp;
+        }
+    }
+    if (*cp == '(') {
+        params = cp;
+    }
+    if (!params) {
+        return last != name && search_name_matches(last);
+    }
+    copy = (char *)malloc(params - last + 1);
+    if (!copy) {
+        /* Treat it as a match, the CU is then walked. */
+        return TRUE;
+    }
+    memcpy(copy,last,params - last);
+    copy[params - last] = 0;
+    res = search_name_matches(copy);
+    free(copy);
+    return res;
+}
+
+static void
+drop_error(Dwarf_Debug dbg,int res,Dwarf_Error *err)
+{
+    if (res == DW_DLV_ERROR && *err) {
+        dwarf_dealloc(dbg,*err,DW_DLA_ERROR);
+    }
+    *err = 0;
+}
+
+/*  The entries of one name index with a matching name.
+    Returns FALSE if the index cannot be used. */
+static boolean
+load_debugnames_entries(Dwarf_Debug dbg,Dwarf_Dnames_Head dn,
+    Dwarf_Unsigned index_number,Dwarf_Unsigned pool_offset,
+    Dwarf_Off *cu_die_offsets,Dwarf_Unsigned cu_count)
+{
+    Dwarf_Error err = 0;
+
+    for (;;) {
+        Dwarf_Unsigned code = 0;
+        Dwarf_Unsigned tag = 0;
+        Dwarf_Unsigned value_count = 0;
+        Dwarf_Unsigned abindex = 0;
+        Dwarf_Unsigned valoffset = 0;
+        Dwarf_Unsigned idxnum[DNAMES_MAX_VALUES];
+        Dwarf_Unsigned forms[DNAMES_MAX_VALUES];
+        Dwarf_Unsigned offsets[DNAMES_MAX_VALUES];
+        Dwarf_Sig8 sigs[DNAMES_MAX_VALUES];
+        Dwarf_Unsigned cu_index = 0;
+        boolean is_type_unit = FALSE;
+        Dwarf_Unsigned v = 0;
+        int res = 0;
+
+        res = dwarf_debugnames_entrypool(dn,index_number,
+            pool_offset,&code,&tag,&value_count,&abindex,
+            &valoffset,&err);
+        if (res == DW_DLV_NO_ENTRY) {
+            return TRUE;
+        }
+        if (res != DW_DLV_OK || value_count > DNAMES_MAX_VALUES) {
+            drop_error(dbg,res,&err);
+            return FALSE;
+        }
+        res = dwarf_debugnames_entrypool_values(dn,index_number,
+            abindex,valoffset,idxnum,forms,offsets,sigs,
+            &pool_offset,&err);
+        if (res != DW_DLV_OK) {
+            drop_error(dbg,res,&err);
+            return FALSE;
+        }
+        if (tag != DW_TAG_subprogram && tag != DW_TAG_variable) {
+            continue;
+        }
+        /*  With a single CU DW_IDX_compile_unit may be left
+            out.  .debug_types is never skipped. */
+        cu_index = cu_count == 1? 0 : cu_count;
+        for (v = 0; v < value_count; ++v) {
+            if (idxnum[v] == DW_IDX_compile_unit) {
+                cu_index = offsets[v];
+            } else if (idxnum[v] == DW_IDX_type_unit) {
+                is_type_unit = TRUE;
+            }
+        }
+        if (is_type_unit) {
+            continue;
+        }
+        if (cu_index >= cu_count ||
+            !offset_set_add(&si_listed,cu_die_offsets[cu_index])) {
+            return FALSE;
+        }
+    }
+}
+
+/*  Returns FALSE if the index cannot be used. */
+static boolean
+load_debugnames(Dwarf_Debug dbg)
+{
+    Dwarf_Dnames_Head dn = 0;
+    Dwarf_Unsigned dn_count = 0;
+    Dwarf_Unsigned i = 0;
+    Dwarf_Error err = 0;
+    boolean ok = FALSE;
+    int res = 0;
+
+    res = dwarf_debugnames_header(dbg,&dn,&dn_count,&err);
+    if (res != DW_DLV_OK) {
+        drop_error(dbg,res,&err);
+        return FALSE;
+    }
+    for (i = 0; i < dn_count; ++i) {
+        Dwarf_Unsigned section_offset = 0;
+        Dwarf_Unsigned version = 0;
+        Dwarf_Unsigned offset_size = 0;
+        Dwarf_Unsigned cu_count = 0;
+        Dwarf_Unsigned local_tu_count = 0;
+        Dwarf_Unsigned foreign_tu_count = 0;
+        Dwarf_Unsigned bucket_count = 0;
+        Dwarf_Unsigned name_count = 0;
+        Dwarf_Unsigned table_length = 0;
+        Dwarf_Unsigned abbrev_size = 0;
+        Dwarf_Unsigned pool_size = 0;
+        Dwarf_Unsigned aug_size = 0;
+        Dwarf_Off *cu_die_offsets = 0;
+        Dwarf_Unsigned j = 0;
+        boolean index_ok = FALSE;
+
+        res = dwarf_debugnames_sizes(dn,i,&section_offset,
+            &version,&offset_size,
+            &cu_count,&local_tu_count,&foreign_tu_count,
+            &bucket_count,&name_count,
+            &table_length,&abbrev_size,&pool_size,&aug_size,
+            &err);
+        if (res != DW_DLV_OK || !cu_count) {
+            drop_error(dbg,res,&err);
+            goto done;
+        }
+        cu_die_offsets = (Dwarf_Off *)calloc(cu_count,
+            sizeof(Dwarf_Off));
+        if (!cu_die_offsets) {
+            goto done;
+        }
+        for (j = 0; j < cu_count; ++j) {
+            Dwarf_Unsigned cuoff = 0;
+
+            res = dwarf_debugnames_cu_entry(dn,i,j,0,&cuoff,&err);
+            if (res == DW_DLV_OK) {
+                res = dwarf_get_cu_die_offset_given_cu_header_offset_b(
+                    dbg,cuoff,TRUE,&cu_die_offsets[j],&err);
+            }
+            if (res != DW_DLV_OK ||
+                !offset_set_add(&si_covered,cu_die_offsets[j])) {
+                drop_error(dbg,res,&err);
+                goto next;
+            }
+        }
+        for (j = 0; j < name_count; ++j) {
+            Dwarf_Sig8 hashsig;
+            Dwarf_Unsigned stroff = 0;
+            Dwarf_Unsigned pooloff = 0;
+            char *name = 0;
+            Dwarf_Signed slen = 0;
+
+            memset(&hashsig,0,sizeof(hashsig));
+            res = dwarf_debugnames_name(dn,i,j,0,
+                &hashsig,&stroff,&pooloff,&err);
+            if (res == DW_DLV_OK) {
+                res = dwarf_get_str(dbg,stroff,&name,&slen,&err);
+            }
+            if (res != DW_DLV_OK) {
+                drop_error(dbg,res,&err);
+                goto next;
+            }
+            if (index_name_matches(name) &&
+                !load_debugnames_entries(dbg,dn,i,pooloff,
+                cu_die_offsets,cu_count)) {
+                goto next;
+            }
+        }
+        index_ok = TRUE;
+        next:
+        free(cu_die_offsets);
+        if (!index_ok) {
+            goto done;
+        }
+    }
+    ok = dn_count != 0;
+    done:
+    dwarf_dealloc(dbg,dn,DW_DLA_DNAMES_HEAD);
+    return ok;
+}
+
+/*  Returns FALSE if the index cannot be used. */
+static boolean
+load_gdbindex(Dwarf_Debug dbg)
+{
+    Dwarf_Gdbindex gdbindex = 0;
+    Dwarf_Unsigned version = 0;
+    Dwarf_Unsigned cu_list_offset = 0;
+    Dwarf_Unsigned types_cu_list_offset = 0;
+    Dwarf_Unsigned address_area_offset = 0;
+    Dwarf_Unsigned symbol_table_offset = 0;
+    Dwarf_Unsigned constant_pool_offset = 0;
+    Dwarf_Unsigned section_size = 0;
+    Dwarf_Unsigned unused = 0;
+    const char *section_name = 0;
+    Dwarf_Unsigned culist_len = 0;
+    Dwarf_Unsigned symtab_len = 0;
+    Dwarf_Off *cu_die_offsets = 0;
+    Dwarf_Unsigned i = 0;
+    Dwarf_Error err = 0;
+    boolean ok = FALSE;
+    int res = 0;
+
+    res = dwarf_gdbindex_header(dbg,&gdbindex,&version,
+        &cu_list_offset,&types_cu_list_offset,
+        &address_area_offset,&symbol_table_offset,
+        &constant_pool_offset,&section_size,&unused,
+        &section_name,&err);
+    if (res != DW_DLV_OK) {
+        drop_error(dbg,res,&err);
+        return FALSE;
+    }
+    res = dwarf_gdbindex_culist_array(gdbindex,&culist_len,&err);
+    if (res != DW_DLV_OK || !culist_len) {
+        drop_error(dbg,res,&err);
+        dwarf_gdbindex_free(gdbindex);
+        return FALSE;
+    }
+    cu_die_offsets = (Dwarf_Off *)calloc(culist_len,sizeof(Dwarf_Off));
+    if (!cu_die_offsets) {
+        dwarf_gdbindex_free(gdbindex);
+        return FALSE;
+    }
+    for (i = 0; i < culist_len; ++i) {
+        Dwarf_Unsigned cu_offset = 0;
+        Dwarf_Unsigned cu_length = 0;
+
+        res = dwarf_gdbindex_culist_entry(gdbindex,i,
+            &cu_offset,&cu_length,&err);
+        if (res == DW_DLV_OK) {
+            res = dwarf_get_cu_die_offset_given_cu_header_offset_b(
+                dbg,cu_offset,TRUE,&cu_die_offsets[i],&err);
+        }
+        if (res != DW_DLV_OK ||
+            !offset_set_add(&si_covered,cu_die_offsets[i])) {
+            drop_error(dbg,res,&err);
+            goto done;
+        }
+    }
+    res = dwarf_gdbindex_symboltable_array(gdbindex,&symtab_len,&err);
+    if (res != DW_DLV_OK) {
+        drop_error(dbg,res,&err);
+        goto done;
+    }
+    for (i = 0; i < symtab_len; ++i) {
+        Dwarf_Unsigned symnameoffset = 0;
+        Dwarf_Unsigned cuvecoffset = 0;
+        Dwarf_Unsigned cuvec_len = 0;
+        Dwarf_Unsigned ii = 0;
+        const char *name = 0;
+
+        res = dwarf_gdbindex_symboltable_entry(gdbindex,i,
+            &symnameoffset,&cuvecoffset,&err);
+        if (res != DW_DLV_OK) {
+            drop_error(dbg,res,&err);
+            goto done;
+        }
+        if (symnameoffset == 0 && cuvecoffset == 0) {
+            /* Empty hash slot. */
+            continue;
+        }
+        res = dwarf_gdbindex_string_by_offset(gdbindex,
+            symnameoffset,&name,&err);
+        if (res != DW_DLV_OK) {
+            drop_error(dbg,res,&err);
+            goto done;
+        }
+        if (!index_name_matches(name)) {
+            continue;
+        }
+        res = dwarf_gdbindex_cuvector_length(gdbindex,
+            cuvecoffset,&cuvec_len,&err);
+        if (res != DW_DLV_OK) {
+            drop_error(dbg,res,&err);
+            goto done;
+        }
+        for (ii = 0; ii < cuvec_len; ++ii) {
+            Dwarf_Unsigned attributes = 0;
+            Dwarf_Unsigned cu_index = 0;
+            Dwarf_Unsigned reserved1 = 0;
+            Dwarf_Unsigned symbol_kind = 0;
+            Dwarf_Unsigned is_static = 0;
+
+            res = dwarf_gdbindex_cuvector_inner_attributes(
+                gdbindex,cuvecoffset,ii,&attributes,&err);
+            if (res == DW_DLV_OK) {
+                res = dwarf_gdbindex_cuvector_instance_expand_value(
+                    gdbindex,attributes,&cu_index,&reserved1,
+                    &symbol_kind,&is_static,&err);
+            }
+            if (res != DW_DLV_OK) {
+                drop_error(dbg,res,&err);
+                goto done;
+            }
+            /*  An index past the CU list is a type unit,
+                and .debug_types is never skipped. */
+            if (cu_index < culist_len &&
+                !offset_set_add(&si_listed,cu_die_offsets[cu_index])) {
+                goto done;
+            }
+        }
+    }
+    ok = TRUE;
+    done:
+    free(cu_die_offsets);
+    dwarf_gdbindex_free(gdbindex);
+    return ok;
+}
+
+/*  Returns FALSE if .debug_pubnames cannot be used.
+    .debug_pubtypes lists no functions or variables. */
+static boolean
+load_pubnames(Dwarf_Debug dbg)
+{
+    Dwarf_Global *globals = 0;
+    Dwarf_Signed global_count = 0;
+    Dwarf_Signed i = 0;
+    Dwarf_Error err = 0;
+    boolean ok = TRUE;
+    int res = 0;
+
+    res = dwarf_get_globals(dbg,&globals,&global_count,&err);
+    if (res != DW_DLV_OK) {
+        drop_error(dbg,res,&err);
+        return FALSE;
+    }
+    for (i = 0; ok && i < global_count; ++i) {
+        char *name = 0;
+        Dwarf_Off die_off = 0;
+        Dwarf_Off cu_die_off = 0;
+
+        res = dwarf_global_name_offsets(globals[i],&name,
+            &die_off,&cu_die_off,&err);
+        if (res != DW_DLV_OK) {
+            drop_error(dbg,res,&err);
+            ok = FALSE;
+            break;
+        }
+        if (!offset_set_add(&si_covered,cu_die_off) ||
+            (index_name_matches(name) &&
+            !offset_set_add(&si_listed,cu_die_off))) {
+            ok = FALSE;
+        }
+        dwarf_dealloc(dbg,name,DW_DLA_STRING);
+    }
+    if (global_count) {
+        dwarf_globals_dealloc(dbg,globals,global_count);
+    }
+    return ok && global_count;
+}
+
+void
+search_index_setup(Dwarf_Debug dbg)
+{
+    size_t len = 0;
+
+    si_index_usable = FALSE;
+    offset_set_reset(&si_covered);
+    offset_set_reset(&si_listed);
+    if (!search_name_text) {
+        return;
+    }
+    len = strlen(search_name_text);
+    si_name_is_prefix = len > 1 && search_name_text[len-1] == '*';
+    si_name_len = si_name_is_prefix? len - 1 : len;
+    /*  A skipped CU is not printed or checked either, so
+        the index is only used when the walk just searches. */
+    if (!glflags.gf_search_global ||
+        glflags.gf_info_flag || glflags.gf_types_flag ||
+        glflags.gf_cu_name_flag || glflags.gf_line_flag ||
+        glflags.gf_check_macros || glflags.gf_macinfo_flag ||
+        glflags.gf_macro_flag || glflags.gf_producer_children_flag ||
+        glflags.gf_do_check_dwarf || glflags.gf_print_usage_tag_attr) {
+        return;
+    }
+
+    if (!load_debugnames(dbg)) {
+        offset_set_reset(&si_covered);
+        offset_set_reset(&si_listed);
+        if (!load_gdbindex(dbg)) {
+            offset_set_reset(&si_covered);
+            offset_set_reset(&si_listed);
+            if (!load_pubnames(dbg)) {
+                offset_set_reset(&si_covered);
+                offset_set_reset(&si_listed);
+                return;
+            }
+        }
+    }
+    offset_set_finish(&si_covered);
+    offset_set_finish(&si_listed);
+    si_index_usable = TRUE;
+}
+
+boolean
+search_index_skip_cu(Dwarf_Bool is_info,Dwarf_Off cu_die_goffset)
+{
+    if (!si_index_usable || !is_info) {
+        return FALSE;
+    }
+    return offset_set_has(&si_covered,cu_die_goffset) &&
+        !offset_set_has(&si_listed,cu_die_goffset);
+}
+
+/*  Scans an extended regular expression for the longest
+    run of characters every match must contain.  Anything
+    not understood ends the current run, and alternation
+    or grouping means no literal at all. */
+void
+search_regex_prepare(const char *regex_text)
+{
+    size_t len = strlen(regex_text);
+    char *run = 0;
+    size_t runlen = 0;
+    size_t bestlen = 0;
+    const char *cp = regex_text;
+
+    free(si_regex_literal);
+    si_regex_literal = (char *)malloc(len + 1);
+    run = (char *)malloc(len + 1);
+    if (!si_regex_literal || !run) {
+        free(si_regex_literal);
+        free(run);
+        si_regex_literal = 0;
+        return;
+    }
+    si_regex_literal[0] = 0;
+    if (strchr(regex_text,'|') || strchr(regex_text,'(') ||
+        strchr(regex_text,')')) {
+        free(run);
+        return;
+    }
+    for (;;) {
+        boolean end_run = FALSE;
+        char c = *cp;
+
+        switch (c) {
+        case 0:
+            end_run = TRUE;
+            break;
+        case '\\':
+            if (cp[1] && !isalnum((unsigned char)cp[1])) {
+                run[runlen++] = cp[1];
+                ++cp;
+            } else {
+                /* \w, \b and the like. */
+                end_run = TRUE;
+                if (cp[1]) {
+                    ++cp;
+                }
+            }
+            break;
+        case '*': case '?': case '{':
+            /* The character before is optional. */
+            if (runlen) {
+                --runlen;
+            }
+            end_run = TRUE;
+            if (c == '{') {
+                while (cp[1] && cp[1] != '}') {
+                    ++cp;
+                }
+                if (cp[1]) {
+                    ++cp;
+                }
+            }
+            break;
+        case '[':
+            end_run = TRUE;
+            ++cp;
+            if (*cp == '^') {
+                ++cp;
+            }
+            if (*cp == ']') {
+                ++cp;
+            }
+            /*  A ']' inside [:alpha:], [=e=] or [.-.] does
+                not end the bracket expression. */
+            while (*cp && *cp != ']') {
+                if (cp[0] == '[' &&
+                    (cp[1] == ':' || cp[1] == '=' || cp[1] == '.')) {
+                    char delim = cp[1];
+
+                    cp += 2;
+                    while (*cp && !(cp[0] == delim && cp[1] == ']')) {
+                        ++cp;
+                    }
+                    if (!*cp) {
+                        break;
+                    }
+                    cp += 2;
+                    continue;
+                }
+                ++cp;
+            }
+            if (!*cp) {
+                /* Malformed, regcomp will have said so. */
+                runlen = 0;
+                bestlen = 0;
+                c = 0;
+            }
+            break;
+        case '+':
+            /*  Required once, unless another quantifier
+                follows as in "a+*" or "a++?". */
+            {
+                const char *q = cp + 1;
+
+                while (*q == '+') {
+                    ++q;
+                }
+                if (runlen && (*q == '*' || *q == '?' || *q == '{')) {
+                    --runlen;
+                }
+            }
+            end_run = TRUE;
+            break;
+        case '.': case '^': case '$':
+            end_run = TRUE;
+            break;
+        default:
+            run[runlen++] = c;
+            break;
+        }
+        if (end_run) {
+            if (runlen > bestlen) {
+                memcpy(si_regex_literal,run,runlen);
+                si_regex_literal[runlen] = 0;
+                bestlen = runlen;
+            }
+            runlen = 0;
+        }
+        if (!c) {
+            break;
+        }
+        ++cp;
+    }
+    si_regex_literal[bestlen] = 0;
+    free(run);
+}
+
+boolean
+search_regex_may_match(const char *s)
+{
+    if (!si_regex_literal || !si_regex_literal[0]) {
+        return TRUE;
+    }
+    return strstr(s,si_regex_literal) != NULL;
+}
+
+void
+search_index_destructor(void)
+{
+    free(si_covered.os_offsets);
+    free(si_listed.os_offsets);
+    memset(&si_covered,0,sizeof(si_covered));
+    memset(&si_listed,0,sizeof(si_listed));
+    si_index_usable = FALSE;
+    free(si_regex_literal);
+    si_regex_literal = 0;
+}
+
+#ifdef SELFTEST
+struct glflags_s glflags;
+const char *search_regex_text = 0;
+const char *search_name_text = 0;
+
+struct regex_test_s {
+    const char *rt_regex;
+    const char *rt_literal;
+};
+
+/*  The literal each -S regex= must lead to. */
+static struct regex_test_s regex_tests[] = {
+{"abc",             "abc"},
+{"ab*cd",           "cd"},
+{"[[:alpha:]]+xyz", "xyz"},
+{"a[]b]cde",        "cde"},
+{"[[.-.]]z",        "z"},
+{"[^]]q",           "q"},
+{"ab[[=e=]]cd",     "ab"},
+{"[[:digit:]]]x",   "]x"},
+{"x{2}yy",          "yy"},
+{"fo+o",            "fo"},
+{"a|b",             ""},
+{0,0}
+};
+
+static const char *regex_strings[] = {
+"", "x", "xyz", "axyz", "1xyz", "a]cde", "bcde", "acde", "-z", "z",
+"aq", "]q", "abecd", "ab]cd", "ab]]cd", "5]x", "5x", "]x",
+"xxyy", "yy", "foo", "fooo", "fo", "a", "b", "abc",
+0
+};
+
+int
+main(void)
+{
+    int failcount = 0;
+    struct regex_test_s *rt = regex_tests;
+
+    for ( ; rt->rt_regex; ++rt) {
+#ifdef HAVE_REGEX
+        regex_t re;
+        const char **sp = regex_strings;
+#endif /* HAVE_REGEX */
+
+        search_regex_prepare(rt->rt_regex);
+        if (!si_regex_literal ||
+            strcmp(si_regex_literal,rt->rt_literal)) {
+            printf("FAIL literal of %s: \"%s\" not \"%s\"\n",
+                rt->rt_regex,
+                si_regex_literal?si_regex_literal:"<none>",
+                rt->rt_literal);
+            failcount++;
+        }
+#ifdef HAVE_REGEX
+        /*  The prefilter must never reject a string
+            the regular expression matches. */
+        if (regcomp(&re,rt->rt_regex,REG_EXTENDED)) {
+            printf("FAIL regcomp %s\n",rt->rt_regex);
+            failcount++;
+            continue;
+        }
+        for ( ; *sp; ++sp) {
+            boolean unfiltered = !regexec(&re,*sp,0,NULL,0);
+            boolean filtered = search_regex_may_match(*sp) &&
+                !regexec(&re,*sp,0,NULL,0);
+
+            if (filtered != unfiltered) {
+                printf("FAIL %s on \"%s\": %d prefiltered, "
+                    "%d not\n",rt->rt_regex,*sp,filtered,unfiltered);
+                failcount++;
+            }
+        }
+        regfree(&re);
+#endif /* HAVE_REGEX */
+    }
+    search_index_destructor();
+    if (failcount) {
+        printf("FAIL search_index selftest\n");
+        return 1;
+    }
+    printf("PASS search_index selftest\n");
+    return 0;
+}
+#endif /* SELFTEST */
@@ -0,0 +1,64 @@
+/*
+  Copyright 2018 David Anderson. All rights reserved.
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of version 2 of the GNU General Public License as
+  published by the Free Software Foundation.
+
+  This program is distributed in the hope that it would be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  Further, this software is distributed without any warranty that it is
+  free of the rightful claim of any third person regarding infringement
+  or the like.  Any license provided herein, whether implied or
+  otherwise, applies only to this software file.  Patent licenses, if
+  any, provided herein do not apply to combinations of this program with
+  other software, or any other product whatsoever.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write the Free Software Foundation, Inc., 51
+  Franklin Street - Fifth Floor, Boston MA 02110-1301, USA.
+*/
+#ifndef SEARCH_INDEX_H
+#define SEARCH_INDEX_H
+
+/*  Helpers that let -S avoid work.  New 2018.
+
+    -S name=<text> matches DW_AT_name and the linkage name
+    attributes only, exactly or (with a trailing '*') by
+    prefix.  Every CU is walked.
+
+    -S global=<text> matches DW_AT_name the same way but
+    only on the definitions of external functions and
+    variables, the names every index lists.  When the
+    object has a .debug_names, a .gdb_index or a
+    .debug_pubnames the names it lists decide which
+    compilation units are walked at all: a CU the index
+    covers but that has no matching index entry is skipped.
+    With no usable index every CU is walked.
+
+    -S regex=<text> first looks for a literal substring any
+    match must contain and checks for it with strstr()
+    before calling regexec(). */
+
+/*  Called for each object before .debug_info is printed. */
+void search_index_setup(Dwarf_Debug dbg);
+
+/*  TRUE if the index shows the CU whose CU DIE is at
+    cu_die_goffset cannot hold a -S global= match. */
+boolean search_index_skip_cu(Dwarf_Bool is_info,
+    Dwarf_Off cu_die_goffset);
+
+/*  The -S name= and -S global= comparison. */
+boolean search_name_matches(const char *name);
+
+/*  Called once the -S regex= text is known. */
+void search_regex_prepare(const char *regex_text);
+
+/*  FALSE only if s cannot match the -S regex= text. */
+boolean search_regex_may_match(const char *s);
+
+void search_index_destructor(void);
+
+#endif /* SEARCH_INDEX_H */
@@ -41,6 +41,10 @@
     The --check
     option does some interface and error checking.
 
+    The --inplace
+    option walks the DIE tree with dwarf_child_inplace()
+    and dwarf_siblingof_inplace(), so no DIE is allocated.
+
     Option new September 2016:
         --dumpallnames=filepath
     This causes all the strings from the .debug_info and .debug_types
@@ -130,6 +134,7 @@ void close_a_file(int f);
 
 static int namesoptionon = 0;
 static int checkoptionon = 0;
+static int inplaceoptionon = 0;
 static int dumpallnames = 0;
 FILE *dumpallnamesfile = 0;
 static const  char * dumpallnamespath = 0;
@@ -380,6 +385,8 @@ main(int argc, char **argv)
                 dumpallnames=1;
             } else if(strcmp(argv[i],"--check") == 0) {
                 checkoptionon=1;
+            } else if(strcmp(argv[i],"--inplace") == 0) {
+                inplaceoptionon=1;
             } else if(startswithextractstring(argv[i],"--tuhash=",&tuhash)) {
                 /* done */
             } else if(startswithextractstring(argv[i],"--cuhash=",&cuhash)) {
@@ -630,6 +637,10 @@ get_die_and_siblings(Dwarf_Debug dbg, Dwarf_Die in_die,
     Dwarf_Die child = 0;
     Dwarf_Error error = 0;
     Dwarf_Error *errp = 0;
+    /*  For --inplace: the DIEs live here, not
+        in libdwarf-allocated space. */
+    Dwarf_Die_Storage childstore;
+    Dwarf_Die_Storage sibstore;
 
     if(passnullerror) {
         errp = 0;
@@ -640,7 +651,11 @@ get_die_and_siblings(Dwarf_Debug dbg, Dwarf_Die in_die,
 
     for(;;) {
         Dwarf_Die sib_die = 0;
-        res = dwarf_child(cur_die,&child,errp);
+        if (inplaceoptionon) {
+            res = dwarf_child_inplace(cur_die,&childstore,&child,errp);
+        } else {
+            res = dwarf_child(cur_die,&child,errp);
+        }
         if(res == DW_DLV_ERROR) {
             printf("Error in dwarf_child , level %d \n",in_level);
             exit(1);
@@ -649,11 +664,20 @@ get_die_and_siblings(Dwarf_Debug dbg, Dwarf_Die in_die,
             get_die_and_siblings(dbg,child,is_info,
                 in_level+1,sf);
             /* No longer need 'child' die. */
-            dwarf_dealloc(dbg,child,DW_DLA_DIE);
+            if (!inplaceoptionon) {
+                dwarf_dealloc(dbg,child,DW_DLA_DIE);
+            }
             child = 0;
         }
         /* res == DW_DLV_NO_ENTRY or DW_DLV_OK */
-        res = dwarf_siblingof_b(dbg,cur_die,is_info,&sib_die,errp);
+        if (inplaceoptionon) {
+            /*  cur_die may already be in sibstore:
+                that is allowed. */
+            res = dwarf_siblingof_inplace(dbg,cur_die,is_info,
+                &sibstore,&sib_die,errp);
+        } else {
+            res = dwarf_siblingof_b(dbg,cur_die,is_info,&sib_die,errp);
+        }
         if(res == DW_DLV_ERROR) {
             char *em = errp?dwarf_errmsg(error):"Error siblingof_b";
             printf("Error in dwarf_siblingof_b , level %d :%s \n",
@@ -665,7 +689,7 @@ get_die_and_siblings(Dwarf_Debug dbg, Dwarf_Die in_die,
             break;
         }
         /* res == DW_DLV_OK */
-        if(cur_die != in_die) {
+        if(cur_die != in_die && !inplaceoptionon) {
             dwarf_dealloc(dbg,cur_die,DW_DLA_DIE);
             cur_die = 0;
         }
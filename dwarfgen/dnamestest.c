@@ -0,0 +1,26 @@
+/*  Input for dnamestest.sh: the .debug_names dwarfgen
+    writes must list the function-scope statics and leave
+    out the automatic variable and the parameter. */
+int file_global = 3;
+static int file_static = 4;
+
+int
+counter(int step_param)
+{
+    static int fn_static_count;
+    int local_auto = step_param * 2;
+
+    fn_static_count += local_auto + file_static;
+    {
+        static int block_static;
+
+        block_static += step_param;
+        return fn_static_count + block_static;
+    }
+}
+
+int
+main(void)
+{
+    return counter(1) + file_global;
+}
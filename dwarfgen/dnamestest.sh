@@ -0,0 +1,37 @@
+#!/bin/sh
+# Builds dnamestest.c, has dwarfgen write it as DWARF5
+# and checks which variables its .debug_names lists.
+# Usage: dnamestest.sh <dwarfgen> <dwarfdump> <cc> <dnamestest.c>
+dwarfgen=$1
+dwarfdump=$2
+cc=$3
+src=$4
+tmp=dnamestest.$$
+ptrsize=4
+status=0
+
+$cc -g -gdwarf-4 -O0 $src -o $tmp.out || exit 1
+# EI_CLASS: 2 is ELFCLASS64.
+if [ `od -An -tu1 -j4 -N1 $tmp.out` = 2 ]
+then
+    ptrsize=8
+fi
+$dwarfgen -t obj -c 0 -v 5 -p $ptrsize -o $tmp.o $tmp.out \
+    > /dev/null 2>&1 || { rm -f $tmp.out $tmp.o; exit 1; }
+$dwarfdump -a $tmp.o | sed -n '/^  Names/,$p' > $tmp.names
+for n in file_global file_static fn_static_count block_static counter
+do
+    grep " $n\$" $tmp.names > /dev/null || {
+        echo "FAIL $n is not in .debug_names"; status=1; }
+done
+for n in local_auto step_param
+do
+    grep " $n\$" $tmp.names > /dev/null && {
+        echo "FAIL $n is in .debug_names"; status=1; }
+done
+rm -f $tmp.out $tmp.o $tmp.names
+if [ $status = 0 ]
+then
+    echo "PASS dnamestest"
+fi
+exit $status
@@ -128,6 +128,9 @@ CmdOptions cmdoptions = {
     DW_FORM_string, // defaultInfoStringForm
     false, //showrelocdetails
     false, //adddata16
+    false, //contiguousSections
+    false, //tailMergeStrings
+    4, //pointerSize
 };
 
 // loff_t is signed for some reason (strange) but we make offsets unsigned.
@@ -391,6 +394,8 @@ main(int argc, char **argv)
         int longindex;
         static struct dwoption longopts[] = {
             {"adddata16",dwno_argument,0,0},
+            {"contiguous-sections",dwno_argument,0,0},
+            {"tail-merge-strings",dwno_argument,0,0},
             {0,0,0,0},
         };
 
@@ -401,6 +406,10 @@ main(int argc, char **argv)
             case 0:
                 if(longindex == 0) {
                     cmdoptions.adddata16 = true;
+                } else if (longindex == 1) {
+                    cmdoptions.contiguousSections = true;
+                } else if (longindex == 2) {
+                    cmdoptions.tailMergeStrings = true;
                 } else {
                     cerr << "dwarfgen: Invalid lnogoption input " <<
                         longindex << endl;
@@ -421,8 +430,10 @@ main(int argc, char **argv)
             case 'p': /* pointer size: value 4 or 8. */
                 if (!strcmp("4",dwoptarg)) {
                     ptrsizeflagbit = DW_DLC_POINTER32;
+                    cmdoptions.pointerSize = 4;
                 } else if (!strcmp("8",dwoptarg)) {
                     ptrsizeflagbit = DW_DLC_POINTER64;
+                    cmdoptions.pointerSize = 8;
                 } else {
                     cerr << "dwarfgen: Invalid p option input " <<
                         dwoptarg << endl;
@@ -500,6 +511,17 @@ main(int argc, char **argv)
         Dwarf_Error err = 0;
         void *user_data = 0;
         Dwarf_P_Debug dbg = 0;
+        string extra;
+
+        if (cmdoptions.contiguousSections) {
+            extra = "contiguous_sections";
+        }
+        if (cmdoptions.tailMergeStrings) {
+            if (!extra.empty()) {
+                extra += ",";
+            }
+            extra += "tail_merge_strings";
+        }
 
         // We use DW_DLC_SYMBOLIC_RELOCATIONS so we can
         // read the relocations and do our own relocating.
@@ -514,7 +536,7 @@ main(int argc, char **argv)
             user_data,
             isa_name,
             dwarf_version,
-            0, // No extra identifying strings.
+            extra.c_str(),
             &dbg,
             &err);
         if(res != DW_DLV_OK) {
@@ -551,6 +573,14 @@ main(int argc, char **argv)
             ", byte total len " <<debug_str_len << endl;
         cout << "Debug_Str: Reused count " <<reused_count <<
             ", byte total len not emitted " <<reused_len << endl;
+        if (cmdoptions.tailMergeStrings) {
+            Dwarf_Unsigned merged_count = 0;
+            Dwarf_Unsigned merged_len = 0;
+            res = dwarf_pro_get_string_tail_merge_stats(dbg,
+                &merged_count,&merged_len,&err);
+            cout << "Debug_Str: Tail merged count " <<merged_count <<
+                ", byte total len not emitted " <<merged_len << endl;
+        }
         dwarf_producer_finish( dbg, 0);
         return 0;
     } // End try
@@ -673,16 +703,13 @@ write_text_section(Elf * elf)
     shdr1->sh_entsize = 0;
 }
 static void
-InsertDataIntoElf(Dwarf_Signed d,Dwarf_P_Debug dbg,Elf *elf)
+InsertBytesIntoElf(Dwarf_Signed elf_section_index,
+    Dwarf_Ptr bytes, Dwarf_Unsigned length, Elf *elf)
 {
-    Dwarf_Signed elf_section_index = 0;
-    Dwarf_Unsigned length = 0;
-    Dwarf_Ptr bytes = dwarf_get_section_bytes(dbg,d,
-        &elf_section_index,&length,0);
-
     Elf_Scn *scn =  elf_getscn(elf,elf_section_index);
     if(!scn) {
-        cerr << "dwarfgen: Unable to elf_getscn on disk transform # " << d << endl;
+        cerr << "dwarfgen: Unable to elf_getscn on elf section " <<
+            elf_section_index << endl;
         exit(1);
     }
 
@@ -691,7 +718,8 @@ InsertDataIntoElf(Dwarf_Signed d,Dwarf_P_Debug dbg,Elf *elf)
 
     Elf_Data* ed =elf_newdata(scn);
     if(!ed) {
-        cerr << "dwarfgen: elf_newdata died on transformed index " << d << endl;
+        cerr << "dwarfgen: elf_newdata died on elf section " <<
+            elf_section_index << endl;
         exit(1);
     }
     ed->d_buf = bytes;
@@ -705,6 +733,30 @@ InsertDataIntoElf(Dwarf_Signed d,Dwarf_P_Debug dbg,Elf *elf)
         elf_section_index << endl;
 }
 
+static void
+InsertDataIntoElf(Dwarf_Signed d,Dwarf_P_Debug dbg,Elf *elf)
+{
+    Dwarf_Signed elf_section_index = 0;
+    Dwarf_Unsigned length = 0;
+    Dwarf_Ptr bytes = dwarf_get_section_bytes(dbg,d,
+        &elf_section_index,&length,0);
+
+    InsertBytesIntoElf(elf_section_index,bytes,length,elf);
+}
+
+// The Dwarf_P_Section_Sink for --contiguous-sections:
+// the section bytes go straight into the Elf_Data
+// without dwarf_get_section_bytes().
+static int
+InsertSectionSink(Dwarf_Signed elf_section_index,
+    Dwarf_Ptr bytes, Dwarf_Unsigned length,
+    void *sink_data, int *)
+{
+    Elf *elfp = reinterpret_cast<Elf *>(sink_data);
+    InsertBytesIntoElf(elf_section_index,bytes,length,elfp);
+    return DW_DLV_OK;
+}
+
 #if 0
 static string
 printable_rel_type(unsigned char reltype)
@@ -799,9 +851,18 @@ write_generated_dbg(Dwarf_P_Debug dbg,Elf * elf,IRepresentation &irep)
     Dwarf_Signed sectioncount =
         dwarf_transform_to_disk_form(dbg,0);
 
-    Dwarf_Signed d = 0;
-    for(d = 0; d < sectioncount ; ++d) {
-        InsertDataIntoElf(d,dbg,elf);
+    if (cmdoptions.contiguousSections) {
+        int sres = dwarf_pro_stream_section_bytes(dbg,
+            InsertSectionSink,elf,&err);
+        if (sres == DW_DLV_ERROR) {
+            cerr << "dwarfgen: Error streaming section bytes." << endl;
+            exit(1);
+        }
+    } else {
+        Dwarf_Signed d = 0;
+        for(d = 0; d < sectioncount ; ++d) {
+            InsertDataIntoElf(d,dbg,elf);
+        }
     }
 
     // Since we are emitting in final form sometimes, we may
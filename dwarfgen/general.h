@@ -38,6 +38,9 @@ extern struct CmdOptions {
     int  defaultInfoStringForm;
     bool showrelocdetails;
     bool adddata16;
+    bool contiguousSections;
+    bool tailMergeStrings;
+    int  pointerSize;
 } cmdoptions;
 
 template <typename T >
@@ -197,7 +197,31 @@ AddAttrToDie(Dwarf_P_Debug dbg,
         break;
     case DW_FORM_CLASS_EXPRLOC:
         {
-        //FIXME
+        IRFormExprloc *f = dynamic_cast<IRFormExprloc *>(form);
+        if (!f) {
+            cerr << "ERROR Impossible DW_FORM_CLASS_EXPRLOC cast fails, attrnum "
+                <<attrnum << endl;
+            break;
+        }
+        // The expression bytes are copied as they are, so
+        // a DW_OP_addr keeps the input's address and gets
+        // no relocation.  With a different -p pointer size
+        // its operand would be the wrong size, so the
+        // expression is left out.
+        // FIXME: emit DW_FORM_exprloc (libdwarf needs feature).
+        const std::vector<char> &bytes = f->getExprlocData();
+        if (bytes.empty() ||
+            cu.getAddressSize() != cmdoptions.pointerSize) {
+            break;
+        }
+        Dwarf_P_Attribute a = dwarf_add_AT_block(dbg,outdie,attrnum,
+            reinterpret_cast<Dwarf_Small *>(
+                const_cast<char *>(&bytes[0])),
+            bytes.size(),&error);
+        if( reinterpret_cast<myintfromp>(a) == DW_DLV_BADADDR) {
+            cerr << "ERROR dwarf_add_AT_block fails, attrnum "
+                <<attrnum << endl;
+        }
         }
         break;
     case DW_FORM_CLASS_FLAG:
@@ -249,6 +249,7 @@ public:
     IRDie & baseDie() { return cudie_; };
     Dwarf_Half getVersionStamp() { return version_stamp_; };
     Dwarf_Half getOffsetSize() { return length_size_; };
+    Dwarf_Half getAddressSize() { return address_size_; };
     Dwarf_Unsigned getCUdieOffset() { return cudie_offset_; };
     IRCULineData & getCULines() { return cu_lines_; };
 
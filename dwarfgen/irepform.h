@@ -310,6 +310,8 @@ public:
     Dwarf_Half getInitialForm() { return initialform_;}
     Dwarf_Half getFinalForm() {return finalform_;}
     enum Dwarf_Form_Class getFormClass() const { return formclass_; };
+    const std::vector<char> & getExprlocData() const {
+        return exprlocdata_; };
 private:
     Dwarf_Half finalform_;
     // In most cases directform == indirect form.
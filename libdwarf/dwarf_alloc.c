@@ -98,15 +98,22 @@ struct Dwarf_Error_s _dwarf_failsafe_error = {
 /* Here is the extra we malloc for a prefix. */
 struct reserve_size_s {
    void *dummy_rsv1;
-   void *dummy_rsv2;
+   Dwarf_Unsigned dummy_rsv2;
 };
-/* Here is how we use the extra prefix area. */
+/*  Here is how we use the extra prefix area.
+    rd_length is the full malloc size, so dwarf_dealloc()
+    can keep the dwarf_get_debug_stats() byte counts. */
 struct reserve_data_s {
    void *rd_dbg;
-   unsigned short rd_length;
+   unsigned int rd_length;
    unsigned short rd_type;
 };
 #define DW_RESERVE sizeof(struct reserve_size_s)
+/*  Fails to compile if the prefix area is too small. */
+typedef char dwarf_reserve_size_check[
+    (sizeof(struct reserve_size_s) >= sizeof(struct reserve_data_s))? 1: -1];
+typedef char dwarf_stats_count_check[
+    (DW_DLA_STATS_COUNT == ALLOC_AREA_INDEX_TABLE_MAX)? 1: -1];
 
 
 static const
@@ -383,6 +390,24 @@ _dwarf_get_alloc(Dwarf_Debug dbg,
     if (!alloc_mem) {
         return NULL;
     }
+    {
+        Dwarf_Debug_Stats *ds = &dbg->de_stats;
+        Dwarf_Alloc_Stats *as = &ds->ds_alloc[type];
+
+        as->as_count++;
+        as->as_live_count++;
+        as->as_live_bytes += size;
+        if (as->as_live_count > as->as_peak_count) {
+            as->as_peak_count = as->as_live_count;
+        }
+        if (as->as_live_bytes > as->as_peak_bytes) {
+            as->as_peak_bytes = as->as_live_bytes;
+        }
+        ds->ds_live_bytes += size;
+        if (ds->ds_live_bytes > ds->ds_peak_bytes) {
+            ds->ds_peak_bytes = ds->ds_live_bytes;
+        }
+    }
     {
         char * ret_mem = alloc_mem + DW_RESERVE;
         void *key = ret_mem;
@@ -530,6 +555,16 @@ dwarf_dealloc(Dwarf_Debug dbg,
         /* internal or user app error */
         return;
     }
+    {
+        /*  Counted against the type it was allocated as,
+            which is not always the type passed here. */
+        Dwarf_Alloc_Stats *as =
+            &dbg->de_stats.ds_alloc[r->rd_type % ALLOC_AREA_INDEX_TABLE_MAX];
+
+        as->as_live_count--;
+        as->as_live_bytes -= r->rd_length;
+        dbg->de_stats.ds_live_bytes -= r->rd_length;
+    }
 
 
     if (alloc_instance_basics[type].specialdestructor) {
@@ -578,14 +613,155 @@ _dwarf_get_debug(void)
     return (dbg);
 }
 
+/*  Names for dwarf_print_memory_stats(), by DW_DLA_* value. */
+static const char *alloc_type_names[ALLOC_AREA_INDEX_TABLE_MAX] = {
+    0,                      /* 0x00 */
+    "DW_DLA_STRING",
+    "DW_DLA_LOC",
+    "DW_DLA_LOCDESC",
+    "DW_DLA_ELLIST",
+    "DW_DLA_BOUNDS",
+    "DW_DLA_BLOCK",
+    "DW_DLA_DEBUG",
+    "DW_DLA_DIE",           /* 0x08 */
+    "DW_DLA_LINE",
+    "DW_DLA_ATTR",
+    "DW_DLA_TYPE",
+    "DW_DLA_SUBSCR",
+    "DW_DLA_GLOBAL",
+    "DW_DLA_ERROR",
+    "DW_DLA_LIST",
+    "DW_DLA_LINEBUF",       /* 0x10 */
+    "DW_DLA_ARANGE",
+    "DW_DLA_ABBREV",
+    "DW_DLA_FRAME_OP",
+    "DW_DLA_CIE",
+    "DW_DLA_FDE",
+    "DW_DLA_LOC_BLOCK",
+    "DW_DLA_FRAME_BLOCK",
+    "DW_DLA_FUNC",          /* 0x18 */
+    "DW_DLA_TYPENAME",
+    "DW_DLA_VAR",
+    "DW_DLA_WEAK",
+    "DW_DLA_ADDR",
+    "DW_DLA_RANGES",
+    "DW_DLA_ABBREV_LIST",
+    "DW_DLA_CHAIN",
+    "DW_DLA_CU_CONTEXT",    /* 0x20 */
+    "DW_DLA_FRAME",
+    "DW_DLA_GLOBAL_CONTEXT",
+    "DW_DLA_FILE_ENTRY",
+    "DW_DLA_LINE_CONTEXT",
+    "DW_DLA_LOC_CHAIN",
+    "DW_DLA_HASH_TABLE",
+    "DW_DLA_FUNC_CONTEXT",
+    "DW_DLA_TYPENAME_CONTEXT", /* 0x28 */
+    "DW_DLA_VAR_CONTEXT",
+    "DW_DLA_WEAK_CONTEXT",
+    "DW_DLA_PUBTYPES_CONTEXT",
+    "DW_DLA_HASH_TABLE_ENTRY",
+    "DW_DLA_FISSION_PERCU",
+    0,
+    0,
+    0,                      /* 0x30 */
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    "DW_DLA_GDBINDEX",
+    "DW_DLA_XU_INDEX",      /* 0x38 */
+    "DW_DLA_LOC_BLOCK_C",
+    "DW_DLA_LOCDESC_C",
+    "DW_DLA_LOC_HEAD_C",
+    "DW_DLA_MACRO_CONTEXT",
+    "DW_DLA_CHAIN_2",
+    "DW_DLA_DSC_HEAD",
+    "DW_DLA_DNAMES_HEAD"
+};
+
+/*  New 2018. */
+int
+dwarf_get_debug_stats(Dwarf_Debug dbg,
+    Dwarf_Debug_Stats *stats_out,
+    Dwarf_Error *error)
+{
+    if (dbg == NULL) {
+        _dwarf_error(NULL, error, DW_DLE_DBG_NULL);
+        return (DW_DLV_ERROR);
+    }
+    *stats_out = dbg->de_stats;
+    return DW_DLV_OK;
+}
+
 /*
     This function prints out the statistics
-    collected on allocation of memory chunks.
-    No longer used.
+    collected on allocation of memory chunks, and
+    on sections loaded and the other work counted in
+    Dwarf_Debug_Stats.  Revived 2018.
 */
 void
-dwarf_print_memory_stats(UNUSEDARG Dwarf_Debug dbg)
+dwarf_print_memory_stats(Dwarf_Debug dbg)
 {
+    Dwarf_Debug_Stats *ds = 0;
+    unsigned i = 0;
+
+    if (dbg == NULL) {
+        return;
+    }
+    ds = &dbg->de_stats;
+    dwarf_printf(dbg,"%-24s %10s %10s %12s %10s %12s\n",
+        "allocation type","count","live","live bytes",
+        "peak","peak bytes");
+    for (i = 0; i < ALLOC_AREA_INDEX_TABLE_MAX; ++i) {
+        Dwarf_Alloc_Stats *as = &ds->ds_alloc[i];
+
+        if (!as->as_count) {
+            continue;
+        }
+        dwarf_printf(dbg,"%-24s %10" DW_PR_DUu " %10" DW_PR_DUu
+            " %12" DW_PR_DUu " %10" DW_PR_DUu " %12" DW_PR_DUu "\n",
+            alloc_type_names[i]? alloc_type_names[i]: "(unnamed)",
+            as->as_count, as->as_live_count, as->as_live_bytes,
+            as->as_peak_count, as->as_peak_bytes);
+    }
+    dwarf_printf(dbg,"%-24s %10s %10s %12" DW_PR_DUu " %10s %12"
+        DW_PR_DUu "\n",
+        "all types","","",ds->ds_live_bytes,"",ds->ds_peak_bytes);
+
+    dwarf_printf(dbg,"\n%-24s %12s %12s %10s\n",
+        "section","loaded bytes","compressed","relocs");
+    for (i = 0; i < dbg->de_debug_sections_total_entries; ++i) {
+        struct Dwarf_Section_s *sec =
+            dbg->de_debug_sections[i].ds_secdata;
+
+        if (!sec || !sec->dss_data || !sec->dss_name) {
+            continue;
+        }
+        dwarf_printf(dbg,"%-24s %12" DW_PR_DUu " %12" DW_PR_DUu
+            " %10" DW_PR_DUu "\n",
+            sec->dss_name, sec->dss_size,
+            sec->dss_compressed_size, sec->dss_relocations_applied);
+    }
+    dwarf_printf(dbg,"\n%-32s %12" DW_PR_DUu "\n",
+        "sections loaded",ds->ds_sections_loaded);
+    dwarf_printf(dbg,"%-32s %12" DW_PR_DUu "\n",
+        "section bytes read",ds->ds_section_bytes_loaded);
+    dwarf_printf(dbg,"%-32s %12" DW_PR_DUu "\n",
+        "sections decompressed",ds->ds_sections_decompressed);
+    dwarf_printf(dbg,"%-32s %12" DW_PR_DUu "\n",
+        "decompressed bytes",ds->ds_decompressed_bytes);
+    dwarf_printf(dbg,"%-32s %12" DW_PR_DUu "\n",
+        "relocations applied",ds->ds_relocations_applied);
+    dwarf_printf(dbg,"%-32s %12" DW_PR_DUu "\n",
+        "CU contexts created",ds->ds_cu_contexts_created);
+    dwarf_printf(dbg,"%-32s %12" DW_PR_DUu "\n",
+        "abbreviation cache hits",ds->ds_abbrev_hits);
+    dwarf_printf(dbg,"%-32s %12" DW_PR_DUu "\n",
+        "abbreviation cache misses",ds->ds_abbrev_misses);
+    dwarf_printf(dbg,"%-32s %12" DW_PR_DUu "\n",
+        "DIEs materialized",ds->ds_dies_materialized);
 }
 
 
@@ -607,10 +783,26 @@ freecontextlist(Dwarf_Debug dbg, Dwarf_Debug_InfoTypes dis)
 {
     Dwarf_CU_Context context = 0;
     Dwarf_CU_Context nextcontext = 0;
+
+    /*  The dwarf_offdie() contexts are on
+        de_cu_context_list too (_dwarf_make_CU_Context() puts
+        every context there) and may be freed by the loop
+        below, so their DIE arrays, sibling caches and
+        variable location sets are freed first.  Freeing
+        those twice is harmless. */
+    for (context = dis->de_offdie_cu_context;
+        context; context = context->cc_next) {
+        _dwarf_free_die_array(context);
+        _dwarf_free_sibling_cache(context);
+        _dwarf_free_var_loc_sets(context);
+    }
     for (context = dis->de_cu_context_list;
         context; context = nextcontext) {
         Dwarf_Hash_Table hash_table = context->cc_abbrev_hash_table;
         _dwarf_free_abbrev_hash_table_contents(dbg,hash_table);
+        _dwarf_free_die_array(context);
+        _dwarf_free_sibling_cache(context);
+        _dwarf_free_var_loc_sets(context);
         nextcontext = context->cc_next;
         dwarf_dealloc(dbg, hash_table, DW_DLA_HASH_TABLE);
         context->cc_abbrev_hash_table = 0;
@@ -646,6 +838,9 @@ _dwarf_free_all_of_one_debug(Dwarf_Debug dbg)
         dbg->de_tu_hashindex_data = 0;
     }
 
+    _dwarf_pc_index_destructor(dbg->de_pc_index);
+    dbg->de_pc_index = 0;
+    _dwarf_expr_programs_destroy(dbg);
     freecontextlist(dbg,&dbg->de_info_reading);
     freecontextlist(dbg,&dbg->de_types_reading);
 
@@ -32,6 +32,7 @@
 #include <elf.h>
 #endif
 #include <stdio.h>
+#include <stdlib.h> /* For malloc(), free() */
 #include "dwarf_die_deliv.h"
 
 #define FALSE 0
@@ -412,6 +413,7 @@ _dwarf_make_CU_Context(Dwarf_Debug dbg,
     }
     cu_context->cc_dbg = dbg;
     cu_context->cc_is_info = is_info;
+    dbg->de_stats.ds_cu_contexts_created++;
 
     dataptr = is_info? dbg->de_debug_info.dss_data:
         dbg->de_debug_types.dss_data;
@@ -1656,6 +1658,41 @@ _dwarf_next_die_info_ptr(Dwarf_Byte_Ptr die_info_ptr,
     return DW_DLV_OK;
 }
 
+/*  Dwarf_Die_Storage (libdwarf.h) must be able to hold
+    a struct Dwarf_Die_s: this fails to compile if not. */
+typedef char dwarf_die_storage_check[
+    (sizeof(Dwarf_Die_Storage) >= sizeof(struct Dwarf_Die_s))? 1: -1];
+
+/*  Copies a DIE found by one of the _internal
+    functions below into a newly allocated one. */
+static int
+_dwarf_die_out(Dwarf_Debug dbg, Dwarf_Die sdie,
+    Dwarf_Die * caller_ret_die, Dwarf_Error * error)
+{
+    Dwarf_Die ret_die = 0;
+
+    ret_die = (Dwarf_Die) _dwarf_get_alloc(dbg, DW_DLA_DIE, 1);
+    if (ret_die == NULL) {
+        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+        return (DW_DLV_ERROR);
+    }
+    *ret_die = *sdie;
+    *caller_ret_die = ret_die;
+    dbg->de_stats.ds_dies_materialized++;
+    return DW_DLV_OK;
+}
+
+/*  The *_inplace() functions copy the DIE to caller storage
+    rather than allocating. Counted as _dwarf_die_out() is. */
+static void
+die_inplace_out(Dwarf_Die sdie, void *storage)
+{
+    memcpy(storage,sdie,sizeof(*sdie));
+    if (sdie->di_cu_context) {
+        sdie->di_cu_context->cc_dbg->de_stats.ds_dies_materialized++;
+    }
+}
+
 /*  Multiple TAGs are in fact compile units.
     Allow them all.
     Return non-zero if a CU tag.
@@ -1701,16 +1738,136 @@ dwarf_siblingof(Dwarf_Debug dbg,
     Dwarf_Bool is_info = true;
     return dwarf_siblingof_b(dbg,die,is_info,caller_ret_die,error);
 }
+#define SIBLING_CACHE_INITIAL_SIZE 64
+
+static Dwarf_Unsigned
+_dwarf_sibling_cache_slot(Dwarf_Unsigned offset, Dwarf_Unsigned size)
+{
+    /*  Fibonacci hashing: DIE offsets are far from random
+        in their low bits. */
+    return ((offset * 0x9E3779B97F4A7C15ULL) >> 17) & (size - 1);
+}
+
+/*  Returns TRUE and sets *end_out if the subtree of the DIE at
+    CU-relative offset is known to end at CU-relative *end_out. */
+static Dwarf_Bool
+_dwarf_sibling_cache_find(Dwarf_CU_Context context,
+    Dwarf_Unsigned offset, Dwarf_Unsigned *end_out)
+{
+    struct Dwarf_Sibling_Cache_Entry_s *tab = context->cc_sibling_cache;
+    Dwarf_Unsigned size = context->cc_sibling_cache_size;
+    Dwarf_Unsigned slot = 0;
+
+    if (!tab) {
+        return FALSE;
+    }
+    slot = _dwarf_sibling_cache_slot(offset,size);
+    for (;;) {
+        if (tab[slot].sce_offset == offset) {
+            *end_out = tab[slot].sce_end;
+            return TRUE;
+        }
+        if (!tab[slot].sce_offset) {
+            return FALSE;
+        }
+        slot = (slot + 1) & (size - 1);
+    }
+}
+
+static void
+_dwarf_sibling_cache_put(struct Dwarf_Sibling_Cache_Entry_s *tab,
+    Dwarf_Unsigned size,
+    Dwarf_Unsigned offset, Dwarf_Unsigned end)
+{
+    Dwarf_Unsigned slot = _dwarf_sibling_cache_slot(offset,size);
+
+    while (tab[slot].sce_offset && tab[slot].sce_offset != offset) {
+        slot = (slot + 1) & (size - 1);
+    }
+    tab[slot].sce_offset = offset;
+    tab[slot].sce_end = end;
+}
+
+/*  Records a subtree end. The cache is only an optimization,
+    so if memory runs short the entry is quietly dropped. */
+static void
+_dwarf_sibling_cache_add(Dwarf_CU_Context context,
+    Dwarf_Unsigned offset, Dwarf_Unsigned end)
+{
+    Dwarf_Unsigned size = context->cc_sibling_cache_size;
+
+    /*  Keep the load factor at or below 1/2. */
+    if ((context->cc_sibling_cache_count+1)*2 > size) {
+        Dwarf_Unsigned newsize = size? size*2:
+            SIBLING_CACHE_INITIAL_SIZE;
+        struct Dwarf_Sibling_Cache_Entry_s *newtab = 0;
+        Dwarf_Unsigned i = 0;
+
+        newtab = (struct Dwarf_Sibling_Cache_Entry_s *)
+            calloc(newsize,sizeof(*newtab));
+        if (!newtab) {
+            return;
+        }
+        for (i = 0; i < size; ++i) {
+            struct Dwarf_Sibling_Cache_Entry_s *e =
+                context->cc_sibling_cache + i;
+            if (e->sce_offset) {
+                _dwarf_sibling_cache_put(newtab,newsize,
+                    e->sce_offset,e->sce_end);
+            }
+        }
+        free(context->cc_sibling_cache);
+        context->cc_sibling_cache = newtab;
+        context->cc_sibling_cache_size = newsize;
+    }
+    _dwarf_sibling_cache_put(context->cc_sibling_cache,
+        context->cc_sibling_cache_size,offset,end);
+    context->cc_sibling_cache_count++;
+    context->cc_dbg->de_sibling_cache_entries++;
+}
+
+void
+_dwarf_free_sibling_cache(Dwarf_CU_Context context)
+{
+    free(context->cc_sibling_cache);
+    context->cc_sibling_cache = 0;
+    context->cc_sibling_cache_size = 0;
+    context->cc_sibling_cache_count = 0;
+}
+
+/*  New 2018.
+    Reports how well the sibling cache worked:
+    lookups is the number of dwarf_siblingof_b() (and
+    dwarf_siblingof_inplace()) calls on a DIE with children,
+    hits how many of those found the end of the
+    subtree in the cache, and entries the number
+    of subtree ends recorded. */
+int
+dwarf_get_sibling_cache_stats(Dwarf_Debug dbg,
+    Dwarf_Unsigned * lookups,
+    Dwarf_Unsigned * hits,
+    Dwarf_Unsigned * entries,
+    Dwarf_Error * error)
+{
+    if (dbg == NULL) {
+        _dwarf_error(NULL, error, DW_DLE_DBG_NULL);
+        return (DW_DLV_ERROR);
+    }
+    *lookups = dbg->de_sibling_cache_lookups;
+    *hits = dbg->de_sibling_cache_hits;
+    *entries = dbg->de_sibling_cache_entries;
+    return DW_DLV_OK;
+}
+
 /*  This is the new form, October 2011.  On calling with 'die' NULL,
     we cannot tell if this is debug_info or debug_types, so
     we must be informed!. */
-int
-dwarf_siblingof_b(Dwarf_Debug dbg,
+static int
+_dwarf_siblingof_internal(Dwarf_Debug dbg,
     Dwarf_Die die,
     Dwarf_Bool is_info,
-    Dwarf_Die * caller_ret_die, Dwarf_Error * error)
+    Dwarf_Die ret_die, Dwarf_Error * error)
 {
-    Dwarf_Die ret_die = 0;
     Dwarf_Byte_Ptr die_info_ptr = 0;
     Dwarf_Byte_Ptr cu_info_start = 0;
 
@@ -1766,8 +1923,10 @@ dwarf_siblingof_b(Dwarf_Debug dbg,
     } else {
         /* Find sibling die. */
         Dwarf_Bool has_child = false;
+        Dwarf_Bool walked_children = false;
         Dwarf_Sword child_depth = 0;
         Dwarf_CU_Context context=0;
+        Dwarf_Unsigned die_cu_offset = 0;
 
         /*  We cannot have a legal die unless debug_info was loaded, so
             no need to load debug_info here. */
@@ -1784,6 +1943,18 @@ dwarf_siblingof_b(Dwarf_Debug dbg,
         if ((*die_info_ptr) == 0) {
             return (DW_DLV_NO_ENTRY);
         }
+        die_cu_offset = die_info_ptr - cu_info_start;
+        if (die->di_abbrev_list->abl_has_child) {
+            Dwarf_Unsigned end_offset = 0;
+
+            dbg->de_sibling_cache_lookups++;
+            if (_dwarf_sibling_cache_find(context,die_cu_offset,
+                &end_offset)) {
+                dbg->de_sibling_cache_hits++;
+                die_info_ptr = cu_info_start + end_offset;
+                goto have_sibling_ptr;
+            }
+        }
         child_depth = 0;
         do {
             int res2 = 0;
@@ -1856,8 +2027,16 @@ dwarf_siblingof_b(Dwarf_Debug dbg,
             } else {
                 child_depth = has_child ? child_depth + 1 : child_depth;
             }
+            if (child_depth) {
+                walked_children = true;
+            }
         } while (child_depth != 0);
+        if (walked_children) {
+            _dwarf_sibling_cache_add(context,die_cu_offset,
+                die_info_ptr - cu_info_start);
+        }
     }
+    have_sibling_ptr:
 
     /*  die_info_ptr > die_info_end is really a bug (possibly in dwarf
         generation)(but we are past end, no more DIEs here), whereas
@@ -1870,12 +2049,7 @@ dwarf_siblingof_b(Dwarf_Debug dbg,
         return (DW_DLV_NO_ENTRY);
     }
 
-    ret_die = (Dwarf_Die) _dwarf_get_alloc(dbg, DW_DLA_DIE, 1);
-    if (ret_die == NULL) {
-        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
-        return (DW_DLV_ERROR);
-    }
-
+    memset(ret_die,0,sizeof(*ret_die));
     ret_die->di_is_info = is_info;
     ret_die->di_debug_ptr = die_info_ptr;
     ret_die->di_cu_context =
@@ -1885,42 +2059,73 @@ dwarf_siblingof_b(Dwarf_Debug dbg,
     if (die_info_ptr > die_info_end) {
         /*  We managed to go past the end of the CU!.
             Something is badly wrong. */
-        dwarf_dealloc(dbg, ret_die, DW_DLA_DIE);
         _dwarf_error(dbg, error, DW_DLE_ABBREV_DECODE_ERROR);
         return (DW_DLV_ERROR);
     }
     abbrev_code = (Dwarf_Word) utmp;
     if (abbrev_code == 0) {
         /* Zero means a null DIE */
-        dwarf_dealloc(dbg, ret_die, DW_DLA_DIE);
         return (DW_DLV_NO_ENTRY);
     }
     ret_die->di_abbrev_code = abbrev_code;
     lres = _dwarf_get_abbrev_for_code(ret_die->di_cu_context, abbrev_code,
         &ret_die->di_abbrev_list,error);
     if (lres == DW_DLV_ERROR) {
-        dwarf_dealloc(dbg, ret_die, DW_DLA_DIE);
         return lres;
     }
     if (lres == DW_DLV_NO_ENTRY) {
-        dwarf_dealloc(dbg, ret_die, DW_DLA_DIE);
         _dwarf_error(dbg, error, DW_DLE_DIE_ABBREV_LIST_NULL);
         return DW_DLV_ERROR;
     }
     if (die == NULL && !is_cu_tag(ret_die->di_abbrev_list->abl_tag)) {
-        dwarf_dealloc(dbg, ret_die, DW_DLA_DIE);
         _dwarf_error(dbg, error, DW_DLE_FIRST_DIE_NOT_CU);
         return DW_DLV_ERROR;
     }
-
-    *caller_ret_die = ret_die;
     return (DW_DLV_OK);
 }
 
+int
+dwarf_siblingof_b(Dwarf_Debug dbg,
+    Dwarf_Die die,
+    Dwarf_Bool is_info,
+    Dwarf_Die * caller_ret_die, Dwarf_Error * error)
+{
+    struct Dwarf_Die_s sdie;
+    int res = 0;
+
+    res = _dwarf_siblingof_internal(dbg,die,is_info,&sdie,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    return _dwarf_die_out(dbg,&sdie,caller_ret_die,error);
+}
 
+/*  As dwarf_siblingof_b() but the sibling is put in
+    storage owned by the caller: nothing is allocated.
+    The storage may be the storage of die itself. */
 int
-dwarf_child(Dwarf_Die die,
-    Dwarf_Die * caller_ret_die,
+dwarf_siblingof_inplace(Dwarf_Debug dbg,
+    Dwarf_Die die,
+    Dwarf_Bool is_info,
+    Dwarf_Die_Storage * storage,
+    Dwarf_Die * caller_ret_die, Dwarf_Error * error)
+{
+    struct Dwarf_Die_s sdie;
+    int res = 0;
+
+    res = _dwarf_siblingof_internal(dbg,die,is_info,&sdie,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    die_inplace_out(&sdie,storage);
+    *caller_ret_die = (Dwarf_Die)storage;
+    return DW_DLV_OK;
+}
+
+
+static int
+_dwarf_child_internal(Dwarf_Die die,
+    Dwarf_Die ret_die,
     Dwarf_Error * error)
 {
     Dwarf_Byte_Ptr die_info_ptr = 0;
@@ -1928,7 +2133,6 @@ dwarf_child(Dwarf_Die die,
 
     /* die_info_end points one-past-end of die area. */
     Dwarf_Byte_Ptr die_info_end = 0;
-    Dwarf_Die ret_die = 0;
     Dwarf_Bool has_die_child = 0;
     Dwarf_Debug dbg;
     Dwarf_Word abbrev_code = 0;
@@ -1983,11 +2187,7 @@ dwarf_child(Dwarf_Die die,
         return DW_DLV_NO_ENTRY;
     }
 
-    ret_die = (Dwarf_Die) _dwarf_get_alloc(dbg, DW_DLA_DIE, 1);
-    if (ret_die == NULL) {
-        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
-        return DW_DLV_ERROR;
-    }
+    memset(ret_die,0,sizeof(*ret_die));
     ret_die->di_debug_ptr = die_info_ptr;
     ret_die->di_cu_context = die->di_cu_context;
     ret_die->di_is_info = die->di_is_info;
@@ -2009,27 +2209,65 @@ dwarf_child(Dwarf_Die die,
 
         /*  We have arrived at a null DIE, at the end of a CU or the end
             of a list of siblings. */
-        *caller_ret_die = 0;
-        dwarf_dealloc(dbg, ret_die, DW_DLA_DIE);
         return DW_DLV_NO_ENTRY;
     }
     ret_die->di_abbrev_code = abbrev_code;
     lres = _dwarf_get_abbrev_for_code(die->di_cu_context, abbrev_code,
         &ret_die->di_abbrev_list,error);
     if (lres == DW_DLV_ERROR) {
-        dwarf_dealloc(dbg, ret_die, DW_DLA_DIE);
         return lres;
     }
     if (lres == DW_DLV_NO_ENTRY) {
-        dwarf_dealloc(dbg, ret_die, DW_DLA_DIE);
         _dwarf_error(dbg, error, DW_DLE_DIE_BAD);
         return DW_DLV_ERROR;
     }
-
-    *caller_ret_die = ret_die;
     return (DW_DLV_OK);
 }
 
+int
+dwarf_child(Dwarf_Die die,
+    Dwarf_Die * caller_ret_die,
+    Dwarf_Error * error)
+{
+    struct Dwarf_Die_s sdie;
+    int res = 0;
+
+    res = _dwarf_child_internal(die,&sdie,error);
+    if (res == DW_DLV_NO_ENTRY) {
+        /*  Callers have long relied on a null DIE here. */
+        *caller_ret_die = 0;
+    }
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    return _dwarf_die_out(die->di_cu_context->cc_dbg,&sdie,
+        caller_ret_die,error);
+}
+
+/*  As dwarf_child() but the child is put in
+    storage owned by the caller: nothing is allocated.
+    The storage may be the storage of die itself. */
+int
+dwarf_child_inplace(Dwarf_Die die,
+    Dwarf_Die_Storage * storage,
+    Dwarf_Die * caller_ret_die,
+    Dwarf_Error * error)
+{
+    struct Dwarf_Die_s sdie;
+    int res = 0;
+
+    res = _dwarf_child_internal(die,&sdie,error);
+    if (res == DW_DLV_NO_ENTRY) {
+        *caller_ret_die = 0;
+    }
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    die_inplace_out(&sdie,storage);
+    *caller_ret_die = (Dwarf_Die)storage;
+    return DW_DLV_OK;
+}
+
 /*  Given a (global, not cu_relative) die offset, this returns
     a pointer to a DIE thru *new_die.
     It is up to the caller to do a
@@ -2045,14 +2283,13 @@ dwarf_offdie(Dwarf_Debug dbg,
     return dwarf_offdie_b(dbg,offset,is_info,new_die,error);
 }
 
-int
-dwarf_offdie_b(Dwarf_Debug dbg,
+static int
+_dwarf_offdie_internal(Dwarf_Debug dbg,
     Dwarf_Off offset, Dwarf_Bool is_info,
-    Dwarf_Die * new_die, Dwarf_Error * error)
+    Dwarf_Die die, Dwarf_Error * error)
 {
     Dwarf_CU_Context cu_context = 0;
     Dwarf_Off new_cu_offset = 0;
-    Dwarf_Die die = 0;
     Dwarf_Byte_Ptr info_ptr = 0;
     Dwarf_Unsigned abbrev_code = 0;
     Dwarf_Unsigned utmp = 0;
@@ -2121,11 +2358,7 @@ dwarf_offdie_b(Dwarf_Debug dbg,
     }
 
     die_info_end = _dwarf_calculate_info_section_end_ptr(cu_context);
-    die = (Dwarf_Die) _dwarf_get_alloc(dbg, DW_DLA_DIE, 1);
-    if (die == NULL) {
-        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
-        return (DW_DLV_ERROR);
-    }
+    memset(die,0,sizeof(*die));
     die->di_cu_context = cu_context;
     die->di_is_info = is_info;
 
@@ -2139,23 +2372,60 @@ dwarf_offdie_b(Dwarf_Debug dbg,
     abbrev_code = utmp;
     if (abbrev_code == 0) {
         /* we are at a null DIE (or there is a bug). */
-        *new_die = 0;
-        dwarf_dealloc(dbg, die, DW_DLA_DIE);
         return DW_DLV_NO_ENTRY;
     }
     die->di_abbrev_code = abbrev_code;
     lres = _dwarf_get_abbrev_for_code(cu_context, abbrev_code,
         &die->di_abbrev_list,error);
     if (lres == DW_DLV_ERROR) {
-        dwarf_dealloc(dbg, die, DW_DLA_DIE);
         return lres;
     }
     if (lres == DW_DLV_NO_ENTRY) {
-        dwarf_dealloc(dbg, die, DW_DLA_DIE);
         _dwarf_error(dbg, error, DW_DLE_DIE_ABBREV_LIST_NULL);
         return DW_DLV_ERROR;
     }
-    *new_die = die;
+    return DW_DLV_OK;
+}
+
+int
+dwarf_offdie_b(Dwarf_Debug dbg,
+    Dwarf_Off offset, Dwarf_Bool is_info,
+    Dwarf_Die * new_die, Dwarf_Error * error)
+{
+    struct Dwarf_Die_s sdie;
+    int res = 0;
+
+    res = _dwarf_offdie_internal(dbg,offset,is_info,&sdie,error);
+    if (res == DW_DLV_NO_ENTRY) {
+        /*  Callers have long relied on a null DIE here. */
+        *new_die = 0;
+    }
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    return _dwarf_die_out(dbg,&sdie,new_die,error);
+}
+
+/*  As dwarf_offdie_b() but the DIE is put in
+    storage owned by the caller: nothing is allocated. */
+int
+dwarf_offdie_inplace(Dwarf_Debug dbg,
+    Dwarf_Off offset, Dwarf_Bool is_info,
+    Dwarf_Die_Storage * storage,
+    Dwarf_Die * new_die, Dwarf_Error * error)
+{
+    struct Dwarf_Die_s sdie;
+    int res = 0;
+
+    res = _dwarf_offdie_internal(dbg,offset,is_info,&sdie,error);
+    if (res == DW_DLV_NO_ENTRY) {
+        *new_die = 0;
+    }
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    die_inplace_out(&sdie,storage);
+    *new_die = (Dwarf_Die)storage;
     return DW_DLV_OK;
 }
 
@@ -2234,3 +2504,463 @@ dwarf_get_die_section_name_b(Dwarf_Die die,
 
 
 
+
+/*  Working state of dwarf_die_array_build(). */
+struct Dwarf_Die_Array_Build_s {
+    struct Dwarf_Die_Array_Entry_s *ab_entries;
+    Dwarf_Unsigned ab_count;
+    Dwarf_Unsigned ab_alloc_count;
+
+    /*  ab_lastsib[d] is the index of the latest DIE
+        at depth d in the sibling list being read, or
+        DIE_ARRAY_NO_INDEX if that list is empty so far. */
+    Dwarf_Unsigned *ab_lastsib;
+    Dwarf_Unsigned ab_lastsib_size;
+};
+
+static int
+_dwarf_die_array_grow(Dwarf_Debug dbg,
+    struct Dwarf_Die_Array_Build_s *ab,
+    Dwarf_Unsigned depth,
+    Dwarf_Error *error)
+{
+    if (ab->ab_count >= ab->ab_alloc_count) {
+        Dwarf_Unsigned newcount = ab->ab_alloc_count * 2;
+        struct Dwarf_Die_Array_Entry_s *newentries = 0;
+
+        newentries = (struct Dwarf_Die_Array_Entry_s *)
+            realloc(ab->ab_entries,newcount*sizeof(*newentries));
+        if (!newentries) {
+            _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+            return DW_DLV_ERROR;
+        }
+        ab->ab_entries = newentries;
+        ab->ab_alloc_count = newcount;
+    }
+    if (depth >= ab->ab_lastsib_size) {
+        Dwarf_Unsigned newsize = ab->ab_lastsib_size * 2;
+        Dwarf_Unsigned *newlast = 0;
+
+        newlast = (Dwarf_Unsigned *)realloc(ab->ab_lastsib,
+            newsize*sizeof(*newlast));
+        if (!newlast) {
+            _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+            return DW_DLV_ERROR;
+        }
+        ab->ab_lastsib = newlast;
+        ab->ab_lastsib_size = newsize;
+    }
+    return DW_DLV_OK;
+}
+
+/*  Reads the unit once, in section order, recording
+    each DIE with its parent and linking it to its
+    previous sibling.  A zero abbreviation code ends a list
+    of siblings.  */
+static int
+_dwarf_die_array_fill(Dwarf_CU_Context context,
+    Dwarf_Byte_Ptr info_ptr,
+    Dwarf_Byte_Ptr info_end,
+    struct Dwarf_Die_Array_Build_s *ab,
+    Dwarf_Error *error)
+{
+    Dwarf_Debug dbg = context->cc_dbg;
+    Dwarf_Small *dataptr = 0;
+    Dwarf_Unsigned depth = 0;
+    Dwarf_Unsigned parent = DIE_ARRAY_NO_INDEX;
+
+    dataptr = context->cc_is_info? dbg->de_debug_info.dss_data:
+        dbg->de_debug_types.dss_data;
+    ab->ab_lastsib[0] = DIE_ARRAY_NO_INDEX;
+    while (info_ptr < info_end) {
+        Dwarf_Byte_Ptr die_ptr = info_ptr;
+        Dwarf_Unsigned abbrev_code = 0;
+        Dwarf_Abbrev_List abbrev_list = 0;
+        Dwarf_Bool has_child = FALSE;
+        struct Dwarf_Die_Array_Entry_s *e = 0;
+        Dwarf_Unsigned index = 0;
+        int res = 0;
+
+        DECODE_LEB128_UWORD_CK(info_ptr,abbrev_code,
+            dbg,error,info_end);
+        if (abbrev_code == 0) {
+            if (depth == 0) {
+                /*  Padding after the unit DIE. */
+                continue;
+            }
+            --depth;
+            parent = ab->ab_entries[parent].dae_parent;
+            continue;
+        }
+        res = _dwarf_get_abbrev_for_code(context,abbrev_code,
+            &abbrev_list,error);
+        if (res == DW_DLV_ERROR) {
+            return res;
+        }
+        if (res == DW_DLV_NO_ENTRY) {
+            _dwarf_error(dbg, error, DW_DLE_DIE_ABBREV_LIST_NULL);
+            return DW_DLV_ERROR;
+        }
+        res = _dwarf_die_array_grow(dbg,ab,depth+1,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        index = ab->ab_count;
+        e = ab->ab_entries + index;
+        e->dae_debug_ptr = die_ptr;
+        e->dae_abbrev_list = abbrev_list;
+        e->dae_offset = die_ptr - dataptr;
+        e->dae_parent = parent;
+        e->dae_sibling = DIE_ARRAY_NO_INDEX;
+        e->dae_depth = depth;
+        e->dae_tag = abbrev_list->abl_tag;
+        if (ab->ab_lastsib[depth] != DIE_ARRAY_NO_INDEX) {
+            ab->ab_entries[ab->ab_lastsib[depth]].dae_sibling = index;
+        }
+        ab->ab_lastsib[depth] = index;
+        ab->ab_count++;
+
+        res = _dwarf_next_die_info_ptr(die_ptr,context,info_end,
+            NULL,FALSE,&has_child,&info_ptr,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        if (has_child) {
+            ++depth;
+            parent = index;
+            ab->ab_lastsib[depth] = DIE_ARRAY_NO_INDEX;
+        }
+    }
+    return DW_DLV_OK;
+}
+
+/*  New 2018.
+    Decodes all the DIEs of the unit die is in, once,
+    into a preorder array.  Afterwards the
+    dwarf_die_array_*() navigation calls
+    are O(1) (offset lookup is a binary search)
+    and decode nothing.
+    Building an already-built array just returns its count. */
+int
+dwarf_die_array_build(Dwarf_Die die,
+    Dwarf_Unsigned * die_count,
+    Dwarf_Error * error)
+{
+    Dwarf_CU_Context context = 0;
+    Dwarf_Debug dbg = 0;
+    Dwarf_Small *dataptr = 0;
+    Dwarf_Byte_Ptr info_ptr = 0;
+    Dwarf_Byte_Ptr info_end = 0;
+    Dwarf_Unsigned headerlen = 0;
+    struct Dwarf_Die_Array_Build_s ab;
+    int res = 0;
+
+    CHECK_DIE(die, DW_DLV_ERROR);
+    context = die->di_cu_context;
+    dbg = context->cc_dbg;
+    if (context->cc_die_array) {
+        *die_count = context->cc_die_array_count;
+        return DW_DLV_OK;
+    }
+    dataptr = context->cc_is_info? dbg->de_debug_info.dss_data:
+        dbg->de_debug_types.dss_data;
+    res = _dwarf_length_of_cu_header(dbg,context->cc_debug_offset,
+        context->cc_is_info,&headerlen,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    info_ptr = dataptr + context->cc_debug_offset + headerlen;
+    info_end = _dwarf_calculate_info_section_end_ptr(context);
+    if (info_ptr >= info_end) {
+        return DW_DLV_NO_ENTRY;
+    }
+
+    memset(&ab,0,sizeof(ab));
+    /*  Most DIEs take several bytes, so this is usually
+        enough without growing. */
+    ab.ab_alloc_count = (info_end - info_ptr)/6 + 1;
+    ab.ab_entries = (struct Dwarf_Die_Array_Entry_s *)
+        malloc(ab.ab_alloc_count * sizeof(*ab.ab_entries));
+    ab.ab_lastsib_size = 32;
+    ab.ab_lastsib = (Dwarf_Unsigned *)
+        malloc(ab.ab_lastsib_size * sizeof(*ab.ab_lastsib));
+    if (!ab.ab_entries || !ab.ab_lastsib) {
+        free(ab.ab_entries);
+        free(ab.ab_lastsib);
+        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+        return DW_DLV_ERROR;
+    }
+    res = _dwarf_die_array_fill(context,info_ptr,info_end,&ab,error);
+    free(ab.ab_lastsib);
+    if (res != DW_DLV_OK) {
+        free(ab.ab_entries);
+        return res;
+    }
+    if (!ab.ab_count) {
+        free(ab.ab_entries);
+        return DW_DLV_NO_ENTRY;
+    }
+    context->cc_die_array = ab.ab_entries;
+    context->cc_die_array_count = ab.ab_count;
+    *die_count = ab.ab_count;
+    return DW_DLV_OK;
+}
+
+void
+_dwarf_free_die_array(Dwarf_CU_Context context)
+{
+    free(context->cc_die_array);
+    context->cc_die_array = 0;
+    context->cc_die_array_count = 0;
+}
+
+/*  New 2018.
+    Frees the array of the unit die is in, if
+    there is one.  Dwarf_Die's made from it remain valid. */
+int
+dwarf_die_array_free(Dwarf_Die die,
+    Dwarf_Error * error)
+{
+    CHECK_DIE(die, DW_DLV_ERROR);
+    _dwarf_free_die_array(die->di_cu_context);
+    return DW_DLV_OK;
+}
+
+/*  Finds the array entry for index, which must be
+    in the array for the unit of die. */
+static int
+_dwarf_die_array_entry(Dwarf_Die die,
+    Dwarf_Unsigned index,
+    struct Dwarf_Die_Array_Entry_s **entry_out,
+    Dwarf_Error * error)
+{
+    Dwarf_CU_Context context = 0;
+
+    CHECK_DIE(die, DW_DLV_ERROR);
+    context = die->di_cu_context;
+    if (!context->cc_die_array) {
+        _dwarf_error(context->cc_dbg, error, DW_DLE_DIE_ARRAY_MISSING);
+        return DW_DLV_ERROR;
+    }
+    if (index >= context->cc_die_array_count) {
+        _dwarf_error(context->cc_dbg, error, DW_DLE_DIE_ARRAY_INDEX_BAD);
+        return DW_DLV_ERROR;
+    }
+    *entry_out = context->cc_die_array + index;
+    return DW_DLV_OK;
+}
+
+/*  New 2018.
+    Returns the array index of the DIE at the
+    section-global offset, which must be in the
+    unit of die.  A binary search as the array is
+    in offset order.  DW_DLV_NO_ENTRY if no DIE
+    starts there. */
+int
+dwarf_die_array_offset_index(Dwarf_Die die,
+    Dwarf_Off offset,
+    Dwarf_Unsigned * index_out,
+    Dwarf_Error * error)
+{
+    Dwarf_CU_Context context = 0;
+    struct Dwarf_Die_Array_Entry_s *entries = 0;
+    Dwarf_Unsigned low = 0;
+    Dwarf_Unsigned high = 0;
+
+    CHECK_DIE(die, DW_DLV_ERROR);
+    context = die->di_cu_context;
+    entries = context->cc_die_array;
+    if (!entries) {
+        _dwarf_error(context->cc_dbg, error, DW_DLE_DIE_ARRAY_MISSING);
+        return DW_DLV_ERROR;
+    }
+    high = context->cc_die_array_count;
+    while (low < high) {
+        Dwarf_Unsigned mid = low + (high - low)/2;
+
+        if (entries[mid].dae_offset < offset) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low >= context->cc_die_array_count ||
+        entries[low].dae_offset != offset) {
+        return DW_DLV_NO_ENTRY;
+    }
+    *index_out = low;
+    return DW_DLV_OK;
+}
+
+/*  New 2018.
+    The array index of die itself. */
+int
+dwarf_die_array_index(Dwarf_Die die,
+    Dwarf_Unsigned * index_out,
+    Dwarf_Error * error)
+{
+    Dwarf_Off offset = 0;
+    int res = 0;
+
+    res = dwarf_dieoffset(die,&offset,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    return dwarf_die_array_offset_index(die,offset,index_out,error);
+}
+
+/*  New 2018.
+    Returns what the array records about the DIE at index. */
+int
+dwarf_die_array_entry(Dwarf_Die die,
+    Dwarf_Unsigned index,
+    Dwarf_Off * offset,
+    Dwarf_Half * tag,
+    Dwarf_Unsigned * depth,
+    Dwarf_Error * error)
+{
+    struct Dwarf_Die_Array_Entry_s *e = 0;
+    int res = 0;
+
+    res = _dwarf_die_array_entry(die,index,&e,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    *offset = e->dae_offset;
+    *tag = e->dae_tag;
+    *depth = e->dae_depth;
+    return DW_DLV_OK;
+}
+
+/*  New 2018.
+    DW_DLV_NO_ENTRY for the unit DIE. */
+int
+dwarf_die_array_parent(Dwarf_Die die,
+    Dwarf_Unsigned index,
+    Dwarf_Unsigned * parent_index,
+    Dwarf_Error * error)
+{
+    struct Dwarf_Die_Array_Entry_s *e = 0;
+    int res = 0;
+
+    res = _dwarf_die_array_entry(die,index,&e,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    if (e->dae_parent == DIE_ARRAY_NO_INDEX) {
+        return DW_DLV_NO_ENTRY;
+    }
+    *parent_index = e->dae_parent;
+    return DW_DLV_OK;
+}
+
+/*  New 2018.
+    DW_DLV_NO_ENTRY for the last of a list of siblings. */
+int
+dwarf_die_array_sibling(Dwarf_Die die,
+    Dwarf_Unsigned index,
+    Dwarf_Unsigned * sibling_index,
+    Dwarf_Error * error)
+{
+    struct Dwarf_Die_Array_Entry_s *e = 0;
+    int res = 0;
+
+    res = _dwarf_die_array_entry(die,index,&e,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    if (e->dae_sibling == DIE_ARRAY_NO_INDEX) {
+        return DW_DLV_NO_ENTRY;
+    }
+    *sibling_index = e->dae_sibling;
+    return DW_DLV_OK;
+}
+
+/*  New 2018.
+    In preorder the first child, if any, is the next entry. */
+int
+dwarf_die_array_child(Dwarf_Die die,
+    Dwarf_Unsigned index,
+    Dwarf_Unsigned * child_index,
+    Dwarf_Error * error)
+{
+    struct Dwarf_Die_Array_Entry_s *e = 0;
+    Dwarf_CU_Context context = 0;
+    int res = 0;
+
+    res = _dwarf_die_array_entry(die,index,&e,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    context = die->di_cu_context;
+    if ((index+1) >= context->cc_die_array_count ||
+        e[1].dae_parent != index) {
+        return DW_DLV_NO_ENTRY;
+    }
+    *child_index = index+1;
+    return DW_DLV_OK;
+}
+
+static int
+_dwarf_die_array_die_internal(Dwarf_Die die,
+    Dwarf_Unsigned index,
+    Dwarf_Die ret_die,
+    Dwarf_Error * error)
+{
+    struct Dwarf_Die_Array_Entry_s *e = 0;
+    int res = 0;
+
+    res = _dwarf_die_array_entry(die,index,&e,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    memset(ret_die,0,sizeof(*ret_die));
+    ret_die->di_debug_ptr = e->dae_debug_ptr;
+    ret_die->di_abbrev_list = e->dae_abbrev_list;
+    ret_die->di_cu_context = die->di_cu_context;
+    ret_die->di_abbrev_code = (int)e->dae_abbrev_list->abl_code;
+    ret_die->di_is_info = die->di_is_info;
+    return DW_DLV_OK;
+}
+
+/*  New 2018.
+    Makes a Dwarf_Die for the DIE at index, without
+    decoding anything. dwarf_dealloc() it as usual. */
+int
+dwarf_die_array_die(Dwarf_Die die,
+    Dwarf_Unsigned index,
+    Dwarf_Die * ret_die,
+    Dwarf_Error * error)
+{
+    struct Dwarf_Die_s sdie;
+    int res = 0;
+
+    res = _dwarf_die_array_die_internal(die,index,&sdie,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    return _dwarf_die_out(die->di_cu_context->cc_dbg,&sdie,
+        ret_die,error);
+}
+
+/*  New 2018.
+    As dwarf_die_array_die() but the DIE is put in
+    storage owned by the caller: nothing is allocated. */
+int
+dwarf_die_array_die_inplace(Dwarf_Die die,
+    Dwarf_Unsigned index,
+    Dwarf_Die_Storage * storage,
+    Dwarf_Die * ret_die,
+    Dwarf_Error * error)
+{
+    struct Dwarf_Die_s sdie;
+    int res = 0;
+
+    res = _dwarf_die_array_die_internal(die,index,&sdie,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    die_inplace_out(&sdie,storage);
+    *ret_die = (Dwarf_Die)storage;
+    return DW_DLV_OK;
+}
@@ -47,3 +47,29 @@ struct Dwarf_Abbrev_List_s {
     Dwarf_Off      abl_goffset;
     Dwarf_Unsigned abl_count;
 };
+
+/*  One DIE of a unit as recorded by dwarf_die_array_build().
+    The array is in preorder (section order) so the first
+    child of entry i, if any, is entry i+1.
+    Indexes are into the array of the unit.  */
+#define DIE_ARRAY_NO_INDEX ((Dwarf_Unsigned)-1)
+struct Dwarf_Die_Array_Entry_s {
+    Dwarf_Byte_Ptr    dae_debug_ptr;
+    Dwarf_Abbrev_List dae_abbrev_list;
+    Dwarf_Off         dae_offset;  /* Section global offset. */
+    Dwarf_Unsigned    dae_parent;  /* DIE_ARRAY_NO_INDEX if none. */
+    Dwarf_Unsigned    dae_sibling; /* DIE_ARRAY_NO_INDEX if none. */
+    Dwarf_Unsigned    dae_depth;   /* Unit DIE is depth zero. */
+    Dwarf_Half        dae_tag;
+};
+
+/*  One entry of the per-unit sibling cache: the DIE at
+    CU-relative offset sce_offset has children but no
+    DW_AT_sibling, and its subtree ends (its sibling,
+    or the null ending its sibling list) at CU-relative
+    offset sce_end.  sce_offset zero marks an empty slot:
+    no DIE is at CU offset zero, the unit header is.  */
+struct Dwarf_Sibling_Cache_Entry_s {
+    Dwarf_Unsigned sce_offset;
+    Dwarf_Unsigned sce_end;
+};
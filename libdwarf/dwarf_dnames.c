@@ -43,7 +43,7 @@ freedabs(struct Dwarf_D_Abbrev_s *dab)
     struct Dwarf_D_Abbrev_s *tmp = 0;
     for(; dab; dab = tmp) {
         tmp = dab->da_next;
-        free(tmp);
+        free(dab);
     }
 }
 
@@ -87,7 +87,7 @@ fill_in_abbrevs_table(struct Dwarf_Dnames_index_header_s * dn,
         if(!curdab) {
             freedabs(firstdab);
             _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
-            return DW_DLV_OK;
+            return DW_DLV_ERROR;
         }
         curdab->da_tag = tag;
         curdab->da_abbrev_code = code;
@@ -106,29 +106,32 @@ fill_in_abbrevs_table(struct Dwarf_Dnames_index_header_s * dn,
                 break;
             }
             if (idxcount >= ABB_PAIRS_MAX) {
+                free(curdab);
                 freedabs(firstdab);
                 _dwarf_error(dbg, error,
                     DW_DLE_DEBUG_NAMES_ABBREV_OVERFLOW);
-                return DW_DLV_OK;
+                return DW_DLV_ERROR;
             }
             curdab->da_pairs[idxcount].ap_index = idx;
             curdab->da_pairs[idxcount].ap_form = form;
             idxcount++;
         }
         curdab->da_pairs_count = idxcount;
-        abcur = inner +1;
-        if (firstdab) {
+        /*  inner is past the 0,0 pair, at the next code. */
+        abcur = inner;
+        if (!firstdab) {
             firstdab  = curdab;
             lastdab  = curdab;
         } else {
-            firstdab  = curdab;
             lastdab->da_next = curdab;
+            lastdab  = curdab;
         }
     }
     if (!foundabend) {
+        freedabs(firstdab);
         _dwarf_error(dbg, error,
             DW_DLE_DEBUG_NAMES_ABBREV_CORRUPTION);
-        return DW_DLV_OK;
+        return DW_DLV_ERROR;
     }
     {
         unsigned ct = 0;
@@ -394,7 +397,7 @@ read_a_name_index(Dwarf_Dnames_Head dn,
         }
     }
     di_header->din_cu_list = curptr;
-    curptr +=  dbg->de_length_size * comp_unit_count;
+    curptr +=  local_length_size * comp_unit_count;
     if(curptr > end_dnames) {
         free(di_header->din_augmentation_string);
         free(di_header);
@@ -403,7 +406,7 @@ read_a_name_index(Dwarf_Dnames_Head dn,
     }
     di_header->din_local_tu_list = curptr;
 
-    curptr +=  dbg->de_length_size * local_type_unit_count;
+    curptr +=  local_length_size * local_type_unit_count;
     if(curptr > end_dnames) {
         free(di_header->din_augmentation_string);
         free(di_header);
@@ -428,8 +431,9 @@ read_a_name_index(Dwarf_Dnames_Head dn,
         return DW_DLV_ERROR;
     }
 
+    /*  The hashes are 4 bytes each (DWARF5 6.1.1.4.5). */
     di_header->din_hash_table = curptr;
-    curptr +=  sizeof(Dwarf_Sig8) * name_count;
+    curptr +=  sizeof(Dwarf_ufixed) * name_count;
     if(curptr > end_dnames) {
         free(di_header->din_augmentation_string);
         free(di_header);
@@ -438,7 +442,7 @@ read_a_name_index(Dwarf_Dnames_Head dn,
     }
 
     di_header->din_string_offsets = curptr;
-    curptr +=  sizeof(Dwarf_ufixed) * name_count;
+    curptr +=  local_length_size * name_count;
     if(curptr > end_dnames) {
         free(di_header->din_augmentation_string);
         free(di_header);
@@ -447,7 +451,7 @@ read_a_name_index(Dwarf_Dnames_Head dn,
     }
 
     di_header->din_entry_offsets = curptr;
-    curptr +=  sizeof(Dwarf_ufixed) * name_count;
+    curptr +=  local_length_size * name_count;
     if(curptr > end_dnames) {
         free(di_header->din_augmentation_string);
         free(di_header);
@@ -468,7 +472,9 @@ read_a_name_index(Dwarf_Dnames_Head dn,
 
     di_header->din_entry_pool_size = end_dnames - curptr;
 
-    *curptr_in = curptr;
+    /*  The entry pool runs to the end of this name index,
+        the next index (if any) starts there. */
+    *curptr_in = end_dnames;
     *index_header_out = di_header;
     res = fill_in_abbrevs_table(di_header,error);
     if (res != DW_DLV_OK) {
@@ -585,7 +591,7 @@ dwarf_debugnames_header(Dwarf_Debug dbg,
             inhdr_count++;
         }
         usedspace = curptr - curptr_start;
-        remaining -= - usedspace;
+        remaining -= usedspace;
         if (remaining < 5) {
             /*  No more in here, just padding. Check for zero
                 in padding. */
@@ -619,8 +625,13 @@ dwarf_debugnames_header(Dwarf_Debug dbg,
                 free them at this time. */
             struct Dwarf_Dnames_index_header_s *tmp = cur->din_next;
             dn_header->dn_inhdr_first[n] = *cur;
+            dn_header->dn_inhdr_first[n].din_next = 0;
+            /*  Only the struct itself, the content now
+                belongs to the array entry. */
+            free(cur);
             cur = tmp;
         }
+        dn_header->dn_inhdr_count = inhdr_count;
     }
     *dn_out = dn_header;
     *dn_count_out = inhdr_count;
@@ -917,41 +928,44 @@ dwarf_debugnames_name(Dwarf_Dnames_Head dn,
 
     if (name_entry >= cur->din_name_count) {
         if (names_count) {
-            *names_count = cur->din_bucket_count;
+            *names_count = cur->din_name_count;
         }
         return DW_DLV_NO_ENTRY;
     }
 
     if (signature) {
+        /*  The hash is 4 bytes. It is returned in the
+            first 4 bytes of the signature, the rest zero. */
         Dwarf_Small *ptr = cur->din_hash_table +
-            name_entry *sizeof(Dwarf_Sig8);
+            name_entry *sizeof(Dwarf_ufixed);
         Dwarf_Small *endptr = cur->din_string_offsets;
-        if ((ptr + sizeof(Dwarf_Sig8)) > endptr) {
+        if ((ptr + sizeof(Dwarf_ufixed)) > endptr) {
             _dwarf_error(dbg, error, DW_DLE_DEBUG_NAMES_BAD_INDEX_ARG);
             return DW_DLV_ERROR;
         }
-        memcpy(signature,ptr,sizeof(Dwarf_Sig8));
+        memset(signature,0,sizeof(Dwarf_Sig8));
+        memcpy(signature,ptr,sizeof(Dwarf_ufixed));
     }
 
     if (offset_to_debug_str) {
         Dwarf_Unsigned offsetval = 0;
         Dwarf_Small *ptr = cur->din_string_offsets +
-            name_entry * sizeof(Dwarf_ufixed);
-        Dwarf_Small *endptr = cur->din_abbreviations;
+            name_entry * cur->din_offset_size;
+        Dwarf_Small *endptr = cur->din_entry_offsets;
 
         READ_UNALIGNED_CK(dbg, offsetval, Dwarf_Unsigned,
-            ptr, sizeof(Dwarf_ufixed),
+            ptr, cur->din_offset_size,
             error,endptr);
         *offset_to_debug_str = offsetval;
     }
     if (offset_in_entrypool) {
         Dwarf_Unsigned offsetval = 0;
         Dwarf_Small *ptr = cur->din_entry_offsets +
-            name_entry * sizeof(Dwarf_ufixed);
+            name_entry * cur->din_offset_size;
         Dwarf_Small *endptr = cur->din_abbreviations;
 
         READ_UNALIGNED_CK(dbg, offsetval, Dwarf_Unsigned,
-            ptr, sizeof(Dwarf_ufixed),
+            ptr, cur->din_offset_size,
             error,endptr);
         *offset_in_entrypool = offsetval;
     }
@@ -1117,7 +1131,7 @@ dwarf_debugnames_abbrev_form_by_index(Dwarf_Dnames_Head dn,
     if (abbrev_form_index >= abbrev->da_pairs_count) {
         return DW_DLV_NO_ENTRY;
     }
-    ap = abbrev->da_pairs + abbrev_entry_index;
+    ap = abbrev->da_pairs + abbrev_form_index;
     if(name_index_attr) {
         *name_index_attr = ap->ap_index;
     }
@@ -1232,14 +1246,27 @@ int dwarf_debugnames_entrypool_values(Dwarf_Dnames_Head dn,
     }
     poolptr = cur->din_entry_pool + offset_in_entrypool_of_values;
     abbrev = cur->din_abbrev_list + index_of_abbrev;
-    abcount = cur->din_abbrev_list_count;
+    abcount = abbrev->da_pairs_count;
     for(n = 0; n < abcount ; ++n) {
         struct abbrev_pair_s *abp = abbrev->da_pairs +n;
         unsigned idxtype = abp->ap_index;
         unsigned form = abp->ap_form;
+        unsigned dataform = form;
         array_dw_idx_number[n] = idxtype;
         array_form[n] = form;
 
+        /*  DW_IDX_die_offset and DW_IDX_parent use
+            the reference class: read them as the
+            same size data form. */
+        switch(form) {
+        case DW_FORM_ref1: dataform = DW_FORM_data1; break;
+        case DW_FORM_ref2: dataform = DW_FORM_data2; break;
+        case DW_FORM_ref4: dataform = DW_FORM_data4; break;
+        case DW_FORM_ref8: dataform = DW_FORM_data8; break;
+        case DW_FORM_ref_udata: dataform = DW_FORM_udata; break;
+        default: break;
+        }
+
         if(form == DW_FORM_data8 && idxtype == DW_IDX_type_hash) {
             if ((poolptr + sizeof(Dwarf_Sig8)) > endpool){
                 _dwarf_error(dbg,error,
@@ -1251,11 +1278,14 @@ int dwarf_debugnames_entrypool_values(Dwarf_Dnames_Head dn,
             poolptr += sizeof(Dwarf_Sig8);
             pooloffset += sizeof(Dwarf_Sig8);
             continue;
-        } else if (_dwarf_allow_formudata(form)) {
+        } else if (_dwarf_allow_formudata(dataform)) {
             Dwarf_Unsigned val = 0;
             Dwarf_Unsigned bytesread = 0;
-            res = _dwarf_formudata_internal(dbg,form,poolptr,
+            res = _dwarf_formudata_internal(dbg,dataform,poolptr,
                 endpool,&val,&bytesread,error);
+            if (res != DW_DLV_OK) {
+                return res;
+            }
             poolptr += bytesread;
             pooloffset += bytesread;
             array_of_offsets[n] = val;
@@ -472,6 +472,26 @@ const char *_dwarf_errmsgs[] = {
     "DW_DLE_GROUP_LOAD_ERROR(391) corrupt data?",
     "DW_DLE_GROUP_LOAD_READ_ERROR(392)",
     "DW_DLE_AUG_DATA_LENGTH_BAD(393) Data does not fit in section",
+    "DW_DLE_SECTION_SINK_ERROR(394) Section output sink failed",
+    "DW_DLE_DIE_ARRAY_MISSING(395) dwarf_die_array_build() not done for the unit",
+    "DW_DLE_DIE_ARRAY_INDEX_BAD(396) DIE array index out of range",
+    "DW_DLE_RNGLISTS_ERROR(397) Corrupt or unknown DW_RLE entry "
+        "in .debug_rnglists",
+    "DW_DLE_LOCLISTS_ERROR(398) Corrupt or unknown DW_LLE entry "
+        "in .debug_loclists",
+    "DW_DLE_LIST_INDEX_BAD(399) rnglistx or loclistx index or "
+        "its offsets table is out of range",
+    "DW_DLE_EXPR_OP_UNSUPPORTED(400) DWARF expression operator "
+        "cannot be evaluated",
+    "DW_DLE_EXPR_BRANCH_BAD(401) DW_OP_skip or DW_OP_bra target "
+        "is not an operator of the expression",
+    "DW_DLE_EXPR_STACK_ERROR(402) DWARF expression stack "
+        "underflow or overflow",
+    "DW_DLE_EXPR_EVAL_ERROR(403) DWARF expression evaluation "
+        "failed (callback error, missing callback or divide by zero)",
+    "DW_DLE_FRAME_PCS_NOT_SORTED(404) The pcs passed to "
+        "dwarf_get_fde_info_for_all_regs3_batch() are not "
+        "in ascending order",
 };
 
 #ifdef TESTING
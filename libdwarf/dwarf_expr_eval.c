@@ -0,0 +1,1043 @@
+/*
+
+  Copyright (C) 2018 David Anderson. All Rights Reserved.
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of version 2.1 of the GNU Lesser General Public License
+  as published by the Free Software Foundation.
+
+  This program is distributed in the hope that it would be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  Further, this software is distributed without any warranty that it is
+  free of the rightful claim of any third person regarding infringement
+  or the like.  Any license provided herein, whether implied or
+  otherwise, applies only to this software file.  Patent licenses, if
+  any, provided herein do not apply to combinations of this program with
+  other software, or any other product whatsoever.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program; if not, write the Free Software
+  Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston MA 02110-1301,
+  USA.
+
+*/
+
+/*  Evaluation of DWARF expressions.
+
+    An expression is compiled once, by decoding its operators
+    with the same _dwarf_read_loc_expr_op() that
+    dwarf_get_loclist_c() uses, into an array of instructions
+    in which the many spellings of an operator have been
+    reduced to one (DW_OP_lit5 and DW_OP_const1u 5 both become
+    DW_OP_constu 5, DW_OP_breg7 becomes DW_OP_bregx 7 ...),
+    DW_OP_addrx and DW_OP_constx have been looked up in
+    .debug_addr and DW_OP_skip and DW_OP_bra targets are
+    instruction indexes.  Compiled programs are kept in a hash
+    table on the Dwarf_Debug keyed by the address of the
+    expression in its section and the CU it was compiled for,
+    so each evaluation is just a loop over the instructions
+    with a fixed size stack.  */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "dwarf_incl.h"
+#include "dwarf_loc.h"
+#include "dwarf_tsearch.h"
+
+#define TRUE  1
+#define FALSE 0
+
+/*  Deep enough for any compiler generated expression. */
+#define EXPR_STACK_SIZE 64
+
+/*  Instructions one evaluation may execute.  Only a
+    backward DW_OP_skip or DW_OP_bra can reach this, and no
+    compiler emits a loop, so this just ends corrupt ones. */
+#define EXPR_STEP_LIMIT 10000
+
+struct Dwarf_Expr_Insn_s {
+    Dwarf_Small    ei_op;
+    Dwarf_Unsigned ei_a;
+    Dwarf_Unsigned ei_b;
+
+    /*  DW_OP_implicit_value: the ei_a bytes of the value. */
+    Dwarf_Small   *ei_data;
+
+    /*  DW_OP_entry_value with other than a register operand:
+        the compiled operand.  If 0, ei_a is the register. */
+    struct Dwarf_Expr_Program_s *ei_sub;
+};
+
+struct Dwarf_Expr_Program_s {
+    Dwarf_Debug    ep_dbg;
+
+    /*  The key of the program in de_expr_programs. */
+    Dwarf_Small   *ep_expr;
+    Dwarf_Unsigned ep_expr_len;
+    Dwarf_Half     ep_address_size;
+
+    /*  0 if compiled without a DIE.  DW_OP_addrx and
+        DW_OP_constx were resolved in this CU. */
+    Dwarf_CU_Context ep_context;
+
+    Dwarf_Unsigned ep_insn_count;
+    struct Dwarf_Expr_Insn_s *ep_insns;
+};
+
+static DW_TSHASHTYPE
+expr_program_hashfunc(const void *keyp)
+{
+    const struct Dwarf_Expr_Program_s *p = keyp;
+
+    /*  Expressions are at least a byte apart. */
+    return (DW_TSHASHTYPE)p->ep_expr;
+}
+
+static int
+expr_program_compare(const void *l, const void *r)
+{
+    const struct Dwarf_Expr_Program_s *lp = l;
+    const struct Dwarf_Expr_Program_s *rp = r;
+
+    if (lp->ep_expr != rp->ep_expr) {
+        return (lp->ep_expr < rp->ep_expr)? -1: 1;
+    }
+    if (lp->ep_expr_len != rp->ep_expr_len) {
+        return (lp->ep_expr_len < rp->ep_expr_len)? -1: 1;
+    }
+    if (lp->ep_address_size != rp->ep_address_size) {
+        return (lp->ep_address_size < rp->ep_address_size)? -1: 1;
+    }
+    if (lp->ep_context != rp->ep_context) {
+        return (lp->ep_context < rp->ep_context)? -1: 1;
+    }
+    return 0;
+}
+
+static void
+expr_program_free(struct Dwarf_Expr_Program_s *p)
+{
+    Dwarf_Unsigned i = 0;
+
+    if (!p) {
+        return;
+    }
+    for (i = 0; i < p->ep_insn_count; ++i) {
+        expr_program_free(p->ep_insns[i].ei_sub);
+    }
+    free(p->ep_insns);
+    free(p);
+}
+
+static void
+expr_program_free_node(void *nodep)
+{
+    expr_program_free((struct Dwarf_Expr_Program_s *)nodep);
+}
+
+void
+_dwarf_expr_programs_destroy(Dwarf_Debug dbg)
+{
+    if (dbg->de_expr_programs) {
+        dwarf_tdestroy(dbg->de_expr_programs,expr_program_free_node);
+        dbg->de_expr_programs = 0;
+    }
+}
+
+/*  Index of the instruction at offset in the expression,
+    or the instruction count for the end of the expression.
+    ops are in offset order. */
+static int
+expr_branch_target(struct Dwarf_Loc_c_s *ops,
+    Dwarf_Unsigned count,
+    Dwarf_Unsigned expr_len,
+    Dwarf_Signed target,
+    Dwarf_Unsigned *index_out)
+{
+    Dwarf_Unsigned lo = 0;
+    Dwarf_Unsigned hi = count;
+
+    if (target < 0 || (Dwarf_Unsigned)target > expr_len) {
+        return DW_DLV_NO_ENTRY;
+    }
+    if ((Dwarf_Unsigned)target == expr_len) {
+        *index_out = count;
+        return DW_DLV_OK;
+    }
+    while (lo < hi) {
+        Dwarf_Unsigned mid = lo + (hi - lo)/2;
+
+        if (ops[mid].lr_offset < (Dwarf_Unsigned)target) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < count && ops[lo].lr_offset == (Dwarf_Unsigned)target) {
+        *index_out = lo;
+        return DW_DLV_OK;
+    }
+    return DW_DLV_NO_ENTRY;
+}
+
+static int
+expr_compile_block(Dwarf_Debug dbg,
+    Dwarf_CU_Context context,
+    Dwarf_Small *expr,
+    Dwarf_Unsigned expr_len,
+    Dwarf_Small *section_end,
+    Dwarf_Half address_size,
+    Dwarf_Half offset_size,
+    Dwarf_Half version,
+    struct Dwarf_Expr_Program_s **prog_out,
+    Dwarf_Error *error);
+
+/*  Reduces one decoded operator to the instruction
+    the evaluator knows. */
+static int
+expr_compile_op(Dwarf_Debug dbg,
+    Dwarf_CU_Context context,
+    struct Dwarf_Loc_c_s *op,
+    Dwarf_Small *section_end,
+    Dwarf_Half address_size,
+    Dwarf_Half offset_size,
+    Dwarf_Half version,
+    struct Dwarf_Expr_Insn_s *insn,
+    Dwarf_Error *error)
+{
+    Dwarf_Small atom = op->lr_atom;
+    int res = 0;
+
+    insn->ei_op = atom;
+    insn->ei_a = op->lr_number;
+    insn->ei_b = op->lr_number2;
+    if (atom >= DW_OP_lit0 && atom <= DW_OP_lit31) {
+        insn->ei_op = DW_OP_constu;
+        insn->ei_a = atom - DW_OP_lit0;
+        return DW_DLV_OK;
+    }
+    if (atom >= DW_OP_reg0 && atom <= DW_OP_reg31) {
+        insn->ei_op = DW_OP_regx;
+        insn->ei_a = atom - DW_OP_reg0;
+        return DW_DLV_OK;
+    }
+    if (atom >= DW_OP_breg0 && atom <= DW_OP_breg31) {
+        insn->ei_op = DW_OP_bregx;
+        insn->ei_a = atom - DW_OP_breg0;
+        insn->ei_b = op->lr_number;
+        return DW_DLV_OK;
+    }
+    switch (atom) {
+    case DW_OP_addr:
+    case DW_OP_const1u:
+    case DW_OP_const1s:
+    case DW_OP_const2u:
+    case DW_OP_const2s:
+    case DW_OP_const4u:
+    case DW_OP_const4s:
+    case DW_OP_const8u:
+    case DW_OP_const8s:
+    case DW_OP_constu:
+    case DW_OP_consts:
+    case DW_OP_GNU_encoded_addr:
+        /*  The signed forms were sign extended when read. */
+        insn->ei_op = DW_OP_constu;
+        return DW_DLV_OK;
+    case DW_OP_addrx:
+    case DW_OP_GNU_addr_index:
+    case DW_OP_constx:
+    case DW_OP_GNU_const_index: {
+        Dwarf_Addr value = 0;
+
+        if (!context) {
+            _dwarf_error(dbg,error,DW_DLE_EXPR_OP_UNSUPPORTED);
+            return DW_DLV_ERROR;
+        }
+        res = _dwarf_extract_address_from_debug_addr(dbg,
+            context,op->lr_number,&value,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        insn->ei_op = DW_OP_constu;
+        insn->ei_a = value;
+        return DW_DLV_OK;
+        }
+    case DW_OP_deref:
+        insn->ei_op = DW_OP_deref_size;
+        insn->ei_a = address_size;
+        return DW_DLV_OK;
+    case DW_OP_xderef:
+        insn->ei_op = DW_OP_xderef_size;
+        insn->ei_a = address_size;
+        return DW_DLV_OK;
+    case DW_OP_deref_type:
+    case DW_OP_GNU_deref_type:
+        /*  Values are all of the generic type here. */
+        insn->ei_op = DW_OP_deref_size;
+        return DW_DLV_OK;
+    case DW_OP_regval_type:
+    case DW_OP_GNU_regval_type:
+        insn->ei_op = DW_OP_bregx;
+        insn->ei_b = 0;
+        return DW_DLV_OK;
+    case DW_OP_const_type:
+    case DW_OP_GNU_const_type: {
+        Dwarf_Unsigned value = 0;
+        Dwarf_Unsigned size = op->lr_number2;
+        Dwarf_Small *valp = (Dwarf_Small *)op->lr_number3;
+
+        if (size > sizeof(value)) {
+            _dwarf_error(dbg,error,DW_DLE_EXPR_OP_UNSUPPORTED);
+            return DW_DLV_ERROR;
+        }
+        if (size) {
+            READ_UNALIGNED_CK(dbg,value,Dwarf_Unsigned,valp,size,
+                error,section_end);
+        }
+        insn->ei_op = DW_OP_constu;
+        insn->ei_a = value;
+        return DW_DLV_OK;
+        }
+    case DW_OP_convert:
+    case DW_OP_GNU_convert:
+    case DW_OP_reinterpret:
+    case DW_OP_GNU_reinterpret:
+    case DW_OP_GNU_uninit:
+        insn->ei_op = DW_OP_nop;
+        return DW_DLV_OK;
+    case DW_OP_piece:
+        insn->ei_op = DW_OP_bit_piece;
+        insn->ei_a = op->lr_number * 8;
+        insn->ei_b = 0;
+        return DW_DLV_OK;
+    case DW_OP_implicit_value:
+        insn->ei_data = (Dwarf_Small *)op->lr_number2;
+        return DW_DLV_OK;
+    case DW_OP_GNU_implicit_pointer:
+        insn->ei_op = DW_OP_implicit_pointer;
+        return DW_DLV_OK;
+    case DW_OP_GNU_push_tls_address:
+        insn->ei_op = DW_OP_form_tls_address;
+        return DW_DLV_OK;
+    case DW_OP_entry_value:
+    case DW_OP_GNU_entry_value: {
+        Dwarf_Small *sub = (Dwarf_Small *)op->lr_number2;
+        Dwarf_Unsigned sublen = op->lr_number;
+
+        insn->ei_op = DW_OP_entry_value;
+        if (sublen == 1 && *sub >= DW_OP_reg0 &&
+            *sub <= DW_OP_reg31) {
+            insn->ei_a = *sub - DW_OP_reg0;
+            return DW_DLV_OK;
+        }
+        res = expr_compile_block(dbg,context,sub,sublen,
+            section_end,address_size,offset_size,version,
+            &insn->ei_sub,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        if (insn->ei_sub->ep_insn_count == 1 &&
+            insn->ei_sub->ep_insns[0].ei_op == DW_OP_regx) {
+            insn->ei_a = insn->ei_sub->ep_insns[0].ei_a;
+            expr_program_free(insn->ei_sub);
+            insn->ei_sub = 0;
+        }
+        return DW_DLV_OK;
+        }
+    case DW_OP_call2:
+    case DW_OP_call4:
+    case DW_OP_call_ref:
+    case DW_OP_GNU_parameter_ref:
+        _dwarf_error(dbg,error,DW_DLE_EXPR_OP_UNSUPPORTED);
+        return DW_DLV_ERROR;
+    default:
+        /*  Every other operator the decoder accepts is
+            evaluated as it is. */
+        return DW_DLV_OK;
+    }
+}
+
+static int
+expr_compile_block(Dwarf_Debug dbg,
+    Dwarf_CU_Context context,
+    Dwarf_Small *expr,
+    Dwarf_Unsigned expr_len,
+    Dwarf_Small *section_end,
+    Dwarf_Half address_size,
+    Dwarf_Half offset_size,
+    Dwarf_Half version,
+    struct Dwarf_Expr_Program_s **prog_out,
+    Dwarf_Error *error)
+{
+    struct Dwarf_Expr_Program_s *prog = 0;
+    struct Dwarf_Loc_c_s *ops = 0;
+    Dwarf_Unsigned ops_count = 0;
+    Dwarf_Unsigned ops_alloc = 0;
+    Dwarf_Unsigned offset = 0;
+    Dwarf_Unsigned i = 0;
+    Dwarf_Block_c block;
+    int res = 0;
+
+    memset(&block,0,sizeof(block));
+    block.bl_data = expr;
+    block.bl_len = expr_len;
+    for (;;) {
+        Dwarf_Unsigned nextoffset = 0;
+
+        if (ops_count == ops_alloc) {
+            Dwarf_Unsigned newalloc = ops_alloc? 2*ops_alloc: 8;
+            struct Dwarf_Loc_c_s *newops =
+                (struct Dwarf_Loc_c_s *)realloc(ops,
+                newalloc*sizeof(struct Dwarf_Loc_c_s));
+
+            if (!newops) {
+                free(ops);
+                _dwarf_error(dbg,error,DW_DLE_ALLOC_FAIL);
+                return DW_DLV_ERROR;
+            }
+            ops = newops;
+            ops_alloc = newalloc;
+        }
+        res = _dwarf_read_loc_expr_op(dbg,&block,ops_count,
+            version,offset_size,address_size,offset,section_end,
+            &nextoffset,ops+ops_count,error);
+        if (res == DW_DLV_ERROR) {
+            free(ops);
+            return res;
+        }
+        if (res == DW_DLV_NO_ENTRY) {
+            break;
+        }
+        ops_count++;
+        offset = nextoffset;
+    }
+    prog = (struct Dwarf_Expr_Program_s *)calloc(1,sizeof(*prog));
+    if (prog) {
+        prog->ep_insns = (struct Dwarf_Expr_Insn_s *)calloc(
+            ops_count? ops_count: 1,
+            sizeof(struct Dwarf_Expr_Insn_s));
+    }
+    if (!prog || !prog->ep_insns) {
+        free(prog);
+        free(ops);
+        _dwarf_error(dbg,error,DW_DLE_ALLOC_FAIL);
+        return DW_DLV_ERROR;
+    }
+    prog->ep_dbg = dbg;
+    prog->ep_expr = expr;
+    prog->ep_expr_len = expr_len;
+    prog->ep_address_size = address_size;
+    prog->ep_context = context;
+    for (i = 0; i < ops_count; ++i) {
+        struct Dwarf_Expr_Insn_s *insn = prog->ep_insns + i;
+
+        res = expr_compile_op(dbg,context,ops+i,section_end,
+            address_size,offset_size,version,insn,error);
+        /*  Counted now so a failure frees any ei_sub. */
+        prog->ep_insn_count = i+1;
+        if (res != DW_DLV_OK) {
+            expr_program_free(prog);
+            free(ops);
+            return res;
+        }
+        if (insn->ei_op == DW_OP_skip || insn->ei_op == DW_OP_bra) {
+            /*  The operand is a signed 2 byte offset from
+                the end of the operator. */
+            Dwarf_Signed delta = (Dwarf_Signed)ops[i].lr_number;
+            Dwarf_Unsigned after = (i+1 < ops_count)?
+                ops[i+1].lr_offset: expr_len;
+
+            SIGN_EXTEND(delta,2);
+            res = expr_branch_target(ops,ops_count,expr_len,
+                (Dwarf_Signed)after + delta,&insn->ei_a);
+            if (res != DW_DLV_OK) {
+                expr_program_free(prog);
+                free(ops);
+                _dwarf_error(dbg,error,DW_DLE_EXPR_BRANCH_BAD);
+                return DW_DLV_ERROR;
+            }
+        }
+    }
+    free(ops);
+    *prog_out = prog;
+    return DW_DLV_OK;
+}
+
+/*  New 2018. */
+int
+dwarf_expr_compile(Dwarf_Debug dbg,
+    Dwarf_Die die,
+    Dwarf_Ptr expr,
+    Dwarf_Unsigned expr_len,
+    Dwarf_Expr_Program *program_out,
+    Dwarf_Error *error)
+{
+    Dwarf_CU_Context context = 0;
+    struct Dwarf_Expr_Program_s key;
+    struct Dwarf_Expr_Program_s *prog = 0;
+    Dwarf_Half address_size = 0;
+    Dwarf_Half offset_size = 0;
+    Dwarf_Half version = DW_CU_VERSION4;
+    const char *section_name = 0;
+    Dwarf_Small *section_start = 0;
+    Dwarf_Unsigned section_size = 0;
+    Dwarf_Small *section_end = 0;
+    void *found = 0;
+    int res = 0;
+
+    if (!dbg) {
+        _dwarf_error(NULL, error, DW_DLE_DBG_NULL);
+        return DW_DLV_ERROR;
+    }
+    if (die) {
+        CHECK_DIE(die, DW_DLV_ERROR);
+        context = die->di_cu_context;
+        address_size = context->cc_address_size;
+        offset_size = context->cc_length_size;
+        version = context->cc_version_stamp;
+    } else {
+        address_size = dbg->de_pointer_size;
+        offset_size = dbg->de_length_size;
+    }
+    res = _dwarf_what_section_are_we(dbg,(Dwarf_Small *)expr,
+        &section_name,&section_start,&section_size,
+        &section_end,error);
+    if (res != DW_DLV_OK ||
+        expr_len > (Dwarf_Unsigned)(section_end -
+        (Dwarf_Small *)expr)) {
+        _dwarf_error(dbg, error,DW_DLE_POINTER_SECTION_UNKNOWN);
+        return DW_DLV_ERROR;
+    }
+    if (!dbg->de_expr_programs) {
+        dwarf_initialize_search_hash(&dbg->de_expr_programs,
+            expr_program_hashfunc,0);
+        if (!dbg->de_expr_programs) {
+            _dwarf_error(dbg,error,DW_DLE_ALLOC_FAIL);
+            return DW_DLV_ERROR;
+        }
+    }
+    memset(&key,0,sizeof(key));
+    key.ep_expr = (Dwarf_Small *)expr;
+    key.ep_expr_len = expr_len;
+    key.ep_address_size = address_size;
+    key.ep_context = context;
+    found = dwarf_tfind(&key,&dbg->de_expr_programs,
+        expr_program_compare);
+    if (found) {
+        *program_out = *(struct Dwarf_Expr_Program_s **)found;
+        return DW_DLV_OK;
+    }
+    res = expr_compile_block(dbg,context,(Dwarf_Small *)expr,
+        expr_len,section_end,address_size,offset_size,version,
+        &prog,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    found = dwarf_tsearch(prog,&dbg->de_expr_programs,
+        expr_program_compare);
+    if (!found) {
+        expr_program_free(prog);
+        _dwarf_error(dbg,error,DW_DLE_ALLOC_FAIL);
+        return DW_DLV_ERROR;
+    }
+    *program_out = prog;
+    return DW_DLV_OK;
+}
+
+/*  Sign extends a generic type value of address_size bytes. */
+static Dwarf_Signed
+expr_signed(Dwarf_Unsigned v, Dwarf_Half address_size)
+{
+    if (address_size < sizeof(Dwarf_Unsigned)) {
+        unsigned shift = (sizeof(Dwarf_Unsigned) - address_size)*8;
+
+        return ((Dwarf_Signed)(v << shift)) >> shift;
+    }
+    return (Dwarf_Signed)v;
+}
+
+static int
+expr_callback_result(Dwarf_Debug dbg,int res,Dwarf_Error *error)
+{
+    if (res == DW_DLV_ERROR) {
+        _dwarf_error(dbg,error,DW_DLE_EXPR_EVAL_ERROR);
+    }
+    return res;
+}
+
+#define POP(v)                                                  \
+    do {                                                        \
+        if (!sp) {                                              \
+            _dwarf_error(dbg,error,DW_DLE_EXPR_STACK_ERROR);    \
+            return DW_DLV_ERROR;                                \
+        }                                                       \
+        (v) = stack[--sp];                                      \
+    } while (0)
+#define PUSH(v)                                                 \
+    do {                                                        \
+        Dwarf_Unsigned pushv_ = (v);                            \
+        if (sp >= EXPR_STACK_SIZE) {                            \
+            _dwarf_error(dbg,error,DW_DLE_EXPR_STACK_ERROR);    \
+            return DW_DLV_ERROR;                                \
+        }                                                       \
+        stack[sp] = pushv_ & mask;                              \
+        sp++;                                                   \
+    } while (0)
+#define NEED(n)                                                 \
+    do {                                                        \
+        if (sp < (n)) {                                         \
+            _dwarf_error(dbg,error,DW_DLE_EXPR_STACK_ERROR);    \
+            return DW_DLV_ERROR;                                \
+        }                                                       \
+    } while (0)
+
+static int
+expr_run(struct Dwarf_Expr_Program_s *prog,
+    Dwarf_Expr_Env *env,
+    Dwarf_Expr_Piece *pieces,
+    Dwarf_Unsigned pieces_max,
+    Dwarf_Unsigned *pieces_count,
+    Dwarf_Error *error)
+{
+    Dwarf_Debug dbg = prog->ep_dbg;
+    Dwarf_Half address_size = prog->ep_address_size;
+    Dwarf_Unsigned mask = (address_size < sizeof(Dwarf_Unsigned))?
+        (((Dwarf_Unsigned)1 << (address_size*8)) - 1):
+        ~(Dwarf_Unsigned)0;
+    Dwarf_Unsigned stack[EXPR_STACK_SIZE];
+    unsigned sp = 0;
+    Dwarf_Unsigned pc = 0;
+    Dwarf_Unsigned count = prog->ep_insn_count;
+    struct Dwarf_Expr_Insn_s *insns = prog->ep_insns;
+    Dwarf_Unsigned npieces = 0;
+    Dwarf_Unsigned steps = 0;
+
+    /*  The location being built since the last piece;
+        if loc_kind is 0 it is memory at the top of stack. */
+    Dwarf_Small loc_kind = 0;
+    Dwarf_Unsigned loc_value = 0;
+    Dwarf_Ptr loc_data = 0;
+    Dwarf_Signed loc_offset = 0;
+    int res = 0;
+
+    if (env->dee_push_initial) {
+        PUSH(env->dee_initial_value);
+    }
+    while (pc < count) {
+        struct Dwarf_Expr_Insn_s *insn = insns + pc;
+        Dwarf_Unsigned a = 0;
+        Dwarf_Unsigned b = 0;
+
+        if (++steps > EXPR_STEP_LIMIT) {
+            _dwarf_error(dbg,error,DW_DLE_EXPR_EVAL_ERROR);
+            return DW_DLV_ERROR;
+        }
+        pc++;
+        switch (insn->ei_op) {
+        case DW_OP_constu:
+            PUSH(insn->ei_a);
+            break;
+        case DW_OP_regx:
+            loc_kind = DW_EXPR_LOC_REGISTER;
+            loc_value = insn->ei_a;
+            break;
+        case DW_OP_bregx:
+        case DW_OP_fbreg:
+            if (insn->ei_op == DW_OP_fbreg) {
+                a = env->dee_frame_base;
+                b = insn->ei_a;
+            } else {
+                if (!env->dee_read_register) {
+                    _dwarf_error(dbg,error,DW_DLE_EXPR_EVAL_ERROR);
+                    return DW_DLV_ERROR;
+                }
+                res = env->dee_read_register(env->dee_user_data,
+                    insn->ei_a,&a);
+                if (res != DW_DLV_OK) {
+                    return expr_callback_result(dbg,res,error);
+                }
+                b = insn->ei_b;
+            }
+            PUSH(a + b);
+            break;
+        case DW_OP_call_frame_cfa:
+            PUSH(env->dee_cfa);
+            break;
+        case DW_OP_push_object_address:
+            PUSH(env->dee_object_address);
+            break;
+        case DW_OP_deref_size:
+        case DW_OP_xderef_size:
+            POP(a);
+            if (insn->ei_op == DW_OP_xderef_size) {
+                /*  Address spaces are not distinguished. */
+                POP(b);
+            }
+            if (!env->dee_read_memory || !insn->ei_a ||
+                insn->ei_a > sizeof(Dwarf_Unsigned)) {
+                _dwarf_error(dbg,error,DW_DLE_EXPR_EVAL_ERROR);
+                return DW_DLV_ERROR;
+            }
+            res = env->dee_read_memory(env->dee_user_data,a,
+                (Dwarf_Small)insn->ei_a,&b);
+            if (res != DW_DLV_OK) {
+                return expr_callback_result(dbg,res,error);
+            }
+            PUSH(b);
+            break;
+        case DW_OP_form_tls_address:
+            POP(a);
+            if (!env->dee_tls_address) {
+                _dwarf_error(dbg,error,DW_DLE_EXPR_EVAL_ERROR);
+                return DW_DLV_ERROR;
+            }
+            res = env->dee_tls_address(env->dee_user_data,a,&b);
+            if (res != DW_DLV_OK) {
+                return expr_callback_result(dbg,res,error);
+            }
+            PUSH(b);
+            break;
+        case DW_OP_entry_value:
+            if (!insn->ei_sub) {
+                if (!env->dee_entry_register) {
+                    _dwarf_error(dbg,error,DW_DLE_EXPR_EVAL_ERROR);
+                    return DW_DLV_ERROR;
+                }
+                res = env->dee_entry_register(env->dee_user_data,
+                    insn->ei_a,&a);
+                if (res != DW_DLV_OK) {
+                    return expr_callback_result(dbg,res,error);
+                }
+            } else {
+                /*  Registers as they were on entry. */
+                Dwarf_Expr_Env subenv = *env;
+                Dwarf_Expr_Piece subpiece;
+                Dwarf_Unsigned subcount = 0;
+
+                subenv.dee_read_register = env->dee_entry_register;
+                subenv.dee_push_initial = FALSE;
+                res = expr_run(insn->ei_sub,&subenv,&subpiece,1,
+                    &subcount,error);
+                if (res != DW_DLV_OK) {
+                    return res;
+                }
+                if (subpiece.dep_kind != DW_EXPR_LOC_MEMORY &&
+                    subpiece.dep_kind != DW_EXPR_LOC_VALUE) {
+                    _dwarf_error(dbg,error,DW_DLE_EXPR_EVAL_ERROR);
+                    return DW_DLV_ERROR;
+                }
+                a = subpiece.dep_value;
+            }
+            PUSH(a);
+            break;
+        case DW_OP_dup:
+            NEED(1);
+            PUSH(stack[sp-1]);
+            break;
+        case DW_OP_drop:
+            POP(a);
+            break;
+        case DW_OP_over:
+            NEED(2);
+            PUSH(stack[sp-2]);
+            break;
+        case DW_OP_pick:
+            NEED(insn->ei_a+1);
+            PUSH(stack[sp-1-insn->ei_a]);
+            break;
+        case DW_OP_swap:
+            NEED(2);
+            a = stack[sp-1];
+            stack[sp-1] = stack[sp-2];
+            stack[sp-2] = a;
+            break;
+        case DW_OP_rot:
+            NEED(3);
+            a = stack[sp-1];
+            stack[sp-1] = stack[sp-2];
+            stack[sp-2] = stack[sp-3];
+            stack[sp-3] = a;
+            break;
+        case DW_OP_abs:
+            POP(a);
+            if (expr_signed(a,address_size) < 0) {
+                a = -a;
+            }
+            PUSH(a);
+            break;
+        case DW_OP_neg:
+            POP(a);
+            PUSH(-a);
+            break;
+        case DW_OP_not:
+            POP(a);
+            PUSH(~a);
+            break;
+        case DW_OP_plus_uconst:
+            POP(a);
+            PUSH(a + insn->ei_a);
+            break;
+        case DW_OP_and:
+        case DW_OP_div:
+        case DW_OP_minus:
+        case DW_OP_mod:
+        case DW_OP_mul:
+        case DW_OP_or:
+        case DW_OP_plus:
+        case DW_OP_shl:
+        case DW_OP_shr:
+        case DW_OP_shra:
+        case DW_OP_xor:
+        case DW_OP_eq:
+        case DW_OP_ge:
+        case DW_OP_gt:
+        case DW_OP_le:
+        case DW_OP_lt:
+        case DW_OP_ne: {
+            Dwarf_Signed sa = 0;
+            Dwarf_Signed sb = 0;
+
+            /*  b is the top of the stack, a is under it. */
+            POP(b);
+            POP(a);
+            sa = expr_signed(a,address_size);
+            sb = expr_signed(b,address_size);
+            switch (insn->ei_op) {
+            case DW_OP_and:   a = a & b; break;
+            case DW_OP_or:    a = a | b; break;
+            case DW_OP_xor:   a = a ^ b; break;
+            case DW_OP_plus:  a = a + b; break;
+            case DW_OP_minus: a = a - b; break;
+            case DW_OP_mul:   a = a * b; break;
+            case DW_OP_div:
+            case DW_OP_mod:
+                if (!b) {
+                    _dwarf_error(dbg,error,DW_DLE_EXPR_EVAL_ERROR);
+                    return DW_DLV_ERROR;
+                }
+                if (insn->ei_op == DW_OP_mod) {
+                    a = a % b;
+                } else if (sb == -1) {
+                    /*  Avoids the trap of the most negative
+                        value divided by -1. */
+                    a = -a;
+                } else {
+                    a = (Dwarf_Unsigned)(sa / sb);
+                }
+                break;
+            case DW_OP_shl:
+                a = (b >= address_size*8)? 0: (a << b);
+                break;
+            case DW_OP_shr:
+                a = (b >= address_size*8)? 0: (a >> b);
+                break;
+            case DW_OP_shra:
+                if (b >= address_size*8) {
+                    b = address_size*8 - 1;
+                }
+                a = (Dwarf_Unsigned)(sa >> b);
+                break;
+            case DW_OP_eq:    a = (sa == sb); break;
+            case DW_OP_ge:    a = (sa >= sb); break;
+            case DW_OP_gt:    a = (sa >  sb); break;
+            case DW_OP_le:    a = (sa <= sb); break;
+            case DW_OP_lt:    a = (sa <  sb); break;
+            default:          a = (sa != sb); break; /* DW_OP_ne */
+            }
+            PUSH(a);
+            break;
+            }
+        case DW_OP_skip:
+            pc = insn->ei_a;
+            break;
+        case DW_OP_bra:
+            POP(a);
+            if (a) {
+                pc = insn->ei_a;
+            }
+            break;
+        case DW_OP_nop:
+            break;
+        case DW_OP_stack_value:
+            NEED(1);
+            loc_kind = DW_EXPR_LOC_VALUE;
+            loc_value = stack[sp-1];
+            break;
+        case DW_OP_implicit_value:
+            loc_kind = DW_EXPR_LOC_IMPLICIT;
+            loc_value = insn->ei_a;
+            loc_data = insn->ei_data;
+            break;
+        case DW_OP_implicit_pointer:
+            loc_kind = DW_EXPR_LOC_IMPLICIT_POINTER;
+            loc_value = insn->ei_a;
+            loc_offset = (Dwarf_Signed)insn->ei_b;
+            break;
+        case DW_OP_bit_piece: {
+            Dwarf_Expr_Piece piece;
+
+            memset(&piece,0,sizeof(piece));
+            if (loc_kind) {
+                if (loc_kind == DW_EXPR_LOC_VALUE) {
+                    POP(a);
+                }
+                piece.dep_kind = loc_kind;
+                piece.dep_value = loc_value;
+                piece.dep_data = loc_data;
+                piece.dep_offset = loc_offset;
+            } else if (sp) {
+                piece.dep_kind = DW_EXPR_LOC_MEMORY;
+                POP(piece.dep_value);
+            } else {
+                piece.dep_kind = DW_EXPR_LOC_UNDEFINED;
+            }
+            piece.dep_size_bits = insn->ei_a;
+            piece.dep_bit_offset = insn->ei_b;
+            if (npieces < pieces_max) {
+                pieces[npieces] = piece;
+            }
+            npieces++;
+            loc_kind = 0;
+            break;
+            }
+        default:
+            _dwarf_error(dbg,error,DW_DLE_EXPR_OP_UNSUPPORTED);
+            return DW_DLV_ERROR;
+        }
+    }
+    if (!npieces) {
+        Dwarf_Expr_Piece piece;
+
+        memset(&piece,0,sizeof(piece));
+        if (loc_kind) {
+            piece.dep_kind = loc_kind;
+            piece.dep_value = loc_value;
+            piece.dep_data = loc_data;
+            piece.dep_offset = loc_offset;
+        } else if (sp) {
+            piece.dep_kind = DW_EXPR_LOC_MEMORY;
+            piece.dep_value = stack[sp-1];
+        } else {
+            piece.dep_kind = DW_EXPR_LOC_UNDEFINED;
+        }
+        if (pieces_max) {
+            pieces[0] = piece;
+        }
+        npieces = 1;
+    }
+    *pieces_count = npieces;
+    return DW_DLV_OK;
+}
+
+/*  New 2018. */
+int
+dwarf_expr_evaluate(Dwarf_Expr_Program program,
+    Dwarf_Expr_Env *env,
+    Dwarf_Expr_Piece *pieces,
+    Dwarf_Unsigned pieces_max,
+    Dwarf_Unsigned *pieces_count,
+    Dwarf_Error *error)
+{
+    if (!program || !env) {
+        _dwarf_error(NULL, error, DW_DLE_EXPR_EVAL_ERROR);
+        return DW_DLV_ERROR;
+    }
+    return expr_run(program,env,pieces,pieces_max,
+        pieces_count,error);
+}
+
+#ifdef TESTING
+/*  Runs hand built programs, as dwarf_expr_compile() would
+    leave them, with no Dwarf_Debug. */
+static int
+run_insns(struct Dwarf_Expr_Insn_s *insns,
+    Dwarf_Unsigned count,
+    Dwarf_Expr_Piece *piece,
+    Dwarf_Error *error)
+{
+    struct Dwarf_Expr_Program_s prog;
+    Dwarf_Expr_Env env;
+    Dwarf_Unsigned npieces = 0;
+
+    memset(&prog,0,sizeof(prog));
+    memset(&env,0,sizeof(env));
+    prog.ep_address_size = 8;
+    prog.ep_insn_count = count;
+    prog.ep_insns = insns;
+    return expr_run(&prog,&env,piece,1,&npieces,error);
+}
+
+int
+main(void)
+{
+    int errcnt = 0;
+    int res = 0;
+    Dwarf_Error error = 0;
+    Dwarf_Expr_Piece piece;
+
+    {
+        /*  DW_OP_skip -3: branches to itself. */
+        struct Dwarf_Expr_Insn_s insns[1];
+
+        memset(insns,0,sizeof(insns));
+        insns[0].ei_op = DW_OP_skip;
+        insns[0].ei_a = 0;
+        res = run_insns(insns,1,&piece,&error);
+        if (res != DW_DLV_ERROR ||
+            dwarf_errno(error) != DW_DLE_EXPR_EVAL_ERROR) {
+            printf("FAIL self looping DW_OP_skip\n");
+            ++errcnt;
+        }
+    }
+    {
+        /*  DW_OP_lit1 DW_OP_dup DW_OP_bra -3: the stack
+            does not grow, so only the step limit ends it. */
+        struct Dwarf_Expr_Insn_s insns[3];
+
+        memset(insns,0,sizeof(insns));
+        insns[0].ei_op = DW_OP_constu;
+        insns[0].ei_a = 1;
+        insns[1].ei_op = DW_OP_dup;
+        insns[2].ei_op = DW_OP_bra;
+        insns[2].ei_a = 1;
+        res = run_insns(insns,3,&piece,&error);
+        if (res != DW_DLV_ERROR ||
+            dwarf_errno(error) != DW_DLE_EXPR_EVAL_ERROR) {
+            printf("FAIL looping DW_OP_bra\n");
+            ++errcnt;
+        }
+    }
+    {
+        /*  DW_OP_lit10 then, while nonzero, minus 1:
+            a loop that ends is still evaluated. */
+        struct Dwarf_Expr_Insn_s insns[6];
+
+        memset(insns,0,sizeof(insns));
+        insns[0].ei_op = DW_OP_constu;
+        insns[0].ei_a = 10;
+        insns[1].ei_op = DW_OP_constu;
+        insns[1].ei_a = 1;
+        insns[2].ei_op = DW_OP_minus;
+        insns[3].ei_op = DW_OP_dup;
+        insns[4].ei_op = DW_OP_bra;
+        insns[4].ei_a = 1;
+        insns[5].ei_op = DW_OP_stack_value;
+        res = run_insns(insns,6,&piece,&error);
+        if (res != DW_DLV_OK ||
+            piece.dep_kind != DW_EXPR_LOC_VALUE ||
+            piece.dep_value != 0) {
+            printf("FAIL counting DW_OP_bra loop\n");
+            ++errcnt;
+        }
+    }
+    if (errcnt) {
+        printf("FAIL expression evaluator\n");
+        return 1;
+    }
+    printf("PASS expression evaluator\n");
+    return 0;
+}
+#endif /* TESTING */
@@ -59,6 +59,15 @@ static void dwarf_init_reg_rules_dw(struct Dwarf_Regtable_Entry_s *base,
     unsigned first, unsigned last,int initial_value);
 static void dwarf_init_reg_rules_dw3(struct Dwarf_Regtable_Entry3_s *base,
     unsigned first, unsigned last,int initial_value);
+static void _dwarf_frame_rule_to_entry3(struct Dwarf_Reg_Rule_s *rule,
+    struct Dwarf_Regtable_Entry3_s *out_rule);
+static void _dwarf_frame_batch_rows(struct Dwarf_Frame_Batch_s *batch,
+    Dwarf_Addr next_loc,
+    Dwarf_Addr current_loc,
+    struct Dwarf_Sparse_Row_s *row,
+    struct Dwarf_Reg_Rule_s *initial_rules,
+    unsigned reg_count,
+    struct Dwarf_Reg_Rule_s *cfa_rule);
 
 
 #if 0  /* FOR DEBUGGING */
@@ -104,6 +113,126 @@ dwarf_get_frame_section_name_eh_gnu(Dwarf_Debug dbg,
     return DW_DLV_OK;
 }
 
+/*  A remembered row for DW_CFA_remember_state. */
+struct Dwarf_Sparse_Stack_s {
+    struct Dwarf_Sparse_Row_s    ss_row;
+    struct Dwarf_Reg_Rule_s      ss_cfa;
+    struct Dwarf_Sparse_Stack_s *ss_next;
+};
+
+/*  Sets *rule_out to the rule for column reg_no of row,
+    adding the column (with its default rule) if the
+    row does not yet have it.  */
+static int
+_dwarf_sparse_rule_ref(struct Dwarf_Sparse_Row_s *row,
+    unsigned reg_no,
+    struct Dwarf_Reg_Rule_s *initial_rules,
+    int initial_value,
+    struct Dwarf_Reg_Rule_s **rule_out)
+{
+    struct Dwarf_Reg_Rule_Sparse_s *r = 0;
+    unsigned lo = 0;
+    unsigned hi = row->sr_count;
+
+    while (lo < hi) {
+        unsigned mid = lo + (hi - lo)/2;
+
+        if (row->sr_regs[mid].rs_column < reg_no) {
+            lo = mid +1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < row->sr_count && row->sr_regs[lo].rs_column == reg_no) {
+        *rule_out = &row->sr_regs[lo].rs_rule;
+        return DW_DLV_OK;
+    }
+    if (row->sr_count == row->sr_max) {
+        unsigned newmax = row->sr_max? row->sr_max*2: 8;
+        struct Dwarf_Reg_Rule_Sparse_s *newregs = 0;
+
+        newregs = (struct Dwarf_Reg_Rule_Sparse_s *)realloc(
+            row->sr_regs, newmax*sizeof(*newregs));
+        if (!newregs) {
+            return DW_DLV_ERROR;
+        }
+        row->sr_regs = newregs;
+        row->sr_max = newmax;
+    }
+    r = row->sr_regs + lo;
+    memmove(r+1,r,(row->sr_count - lo)*sizeof(*r));
+    row->sr_count++;
+    r->rs_column = reg_no;
+    if (initial_rules) {
+        r->rs_rule = initial_rules[reg_no];
+    } else {
+        dwarf_init_reg_rules_ru(&r->rs_rule,0,1,initial_value);
+    }
+    *rule_out = &r->rs_rule;
+    return DW_DLV_OK;
+}
+
+/*  Column reg_no reverts to its default rule. */
+static void
+_dwarf_sparse_rule_remove(struct Dwarf_Sparse_Row_s *row,
+    unsigned reg_no)
+{
+    unsigned i = 0;
+
+    for (i = 0; i < row->sr_count; ++i) {
+        struct Dwarf_Reg_Rule_Sparse_s *r = row->sr_regs + i;
+
+        if (r->rs_column == reg_no) {
+            memmove(r,r+1,(row->sr_count - i -1)*sizeof(*r));
+            row->sr_count--;
+            return;
+        }
+        if (r->rs_column > reg_no) {
+            return;
+        }
+    }
+}
+
+/*  Fills the dense out array of out_count rules from
+    the defaults and row.  */
+static void
+_dwarf_sparse_row_to_rules(struct Dwarf_Sparse_Row_s *row,
+    struct Dwarf_Reg_Rule_s *initial_rules,
+    int initial_value,
+    struct Dwarf_Reg_Rule_s *out,
+    unsigned out_count)
+{
+    unsigned i = 0;
+
+    if (initial_rules != out) {
+        if (initial_rules) {
+            memcpy(out,initial_rules,out_count*sizeof(*out));
+        } else {
+            dwarf_init_reg_rules_ru(out,0,out_count,initial_value);
+        }
+    }
+    for (i = 0; i < row->sr_count; ++i) {
+        struct Dwarf_Reg_Rule_Sparse_s *r = row->sr_regs + i;
+
+        if (r->rs_column >= out_count) {
+            break;
+        }
+        out[r->rs_column] = r->rs_rule;
+    }
+}
+
+static void
+_dwarf_sparse_stack_free(struct Dwarf_Sparse_Stack_s *top)
+{
+    while (top) {
+        struct Dwarf_Sparse_Stack_s *next = top->ss_next;
+
+        free(top->ss_row.sr_regs);
+        free(top);
+        top = next;
+    }
+}
+
 /*
     This function is the heart of the debug_frame stuff.  Don't even
     think of reading this without reading both the Libdwarf and
@@ -177,6 +306,16 @@ dwarf_get_frame_section_name_eh_gnu(Dwarf_Debug dbg,
     Different cies may have distinct address-sizes, so the cie
     is used, not de_pointer_size.
 
+    (5) If batch is non-null (search_pc is then false) each of its
+    sorted pcs gets a copy of the row in effect for it, as
+    the instructions are executed, in one pass.
+
+    The row being built is kept sparse: only the columns the
+    instructions set are recorded, everything else keeps the
+    cie initial rule.  If table is non-null the sparse row
+    is handed over in table->fr_changed (and fr_reg filled
+    in if present).
+
 */
 
 int
@@ -194,6 +333,7 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
     Dwarf_Sword * returned_count,
     Dwarf_Bool * has_more_rows,
     Dwarf_Addr * subsequent_pc,
+    struct Dwarf_Frame_Batch_s *batch,
     Dwarf_Error *error)
 {
 /*  The following macro depends on macreg and
@@ -207,9 +347,29 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
         }                                                    \
     } /*CONSTCOND */ while (0)
 #define SIMPLE_ERROR_RETURN(code) \
-        free(localregtab);        \
+        free(localrow.sr_regs);   \
+        _dwarf_sparse_stack_free(top_stack); \
         _dwarf_error(dbg,error,code); \
         return DW_DLV_ERROR
+/*  Sets lrule to the rule being changed. */
+#define SPARSE_RULE(reg)                                     \
+    do {                                                     \
+        if (_dwarf_sparse_rule_ref(&localrow,(reg),          \
+            initial_rules,dbg->de_frame_rule_initial_value,  \
+            &lrule) != DW_DLV_OK) {                          \
+            SIMPLE_ERROR_RETURN(DW_DLE_DF_ALLOC_FAIL);       \
+        }                                                    \
+    } /*CONSTCOND */ while (0)
+/*  The current row applies to batch pcs below the
+    location an instruction is advancing to. */
+#define BATCH_ROWS(next_loc)                                  \
+    do {                                                     \
+        if (batch) {                                         \
+            _dwarf_frame_batch_rows(batch,(next_loc),        \
+                current_loc,&localrow,initial_rules,         \
+                reg_count,&cfa_reg);                         \
+        }                                                    \
+    } /*CONSTCOND */ while (0)
 
     /*  Sweeps the frame instructions. */
     Dwarf_Small *instr_ptr;
@@ -229,8 +389,14 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
     Dwarf_Unsigned adv_loc = 0;
 
     unsigned reg_count = dbg->de_frame_reg_rules_entry_count;
-    struct Dwarf_Reg_Rule_s *localregtab = calloc(reg_count,
-        sizeof(struct Dwarf_Reg_Rule_s));
+    struct Dwarf_Sparse_Row_s localrow;
+
+    /*  The defaults of the columns not in localrow.
+        Null means the initial rule value. */
+    struct Dwarf_Reg_Rule_s *initial_rules = 0;
+
+    /*  The rule an instruction is setting. */
+    struct Dwarf_Reg_Rule_s *lrule = 0;
 
     struct Dwarf_Reg_Rule_s cfa_reg;
 
@@ -265,8 +431,8 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
     /*  Stack_table points to the row (Dwarf_Frame ie) being pushed or
         popped by a remember or restore instruction. Top_stack points to
         the top of the stack of rows. */
-    Dwarf_Frame stack_table = NULL;
-    Dwarf_Frame top_stack = NULL;
+    struct Dwarf_Sparse_Stack_s *stack_table = NULL;
+    struct Dwarf_Sparse_Stack_s *top_stack = NULL;
 
     /*  These are used only when make_instr is true. Curr_instr is a
         pointer to the current frame instruction executed.
@@ -298,16 +464,9 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
     /*  Initialize first row from associated Cie. Using temp regs
         explicity */
 
-    if (localregtab == 0) {
-        SIMPLE_ERROR_RETURN(DW_DLE_ALLOC_FAIL);
-    }
+    memset(&localrow,0,sizeof(localrow));
     {
-        struct Dwarf_Reg_Rule_s *t1reg = localregtab;
         if (cie != NULL && cie->ci_initial_table != NULL) {
-            unsigned minregcount = 0;
-            unsigned curreg = 0;
-            struct Dwarf_Reg_Rule_s *t2reg = cie->ci_initial_table->fr_reg;
-
             if (reg_count != cie->ci_initial_table->fr_reg_count) {
                 /*  Should never happen, it makes no sense to have the
                     table sizes change. There is no real allowance for
@@ -317,14 +476,9 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
                 SIMPLE_ERROR_RETURN
                     (DW_DLE_FRAME_REGISTER_COUNT_MISMATCH);
             }
-            minregcount = MIN(reg_count,cie->ci_initial_table->fr_reg_count);
-            for (; curreg < minregcount ;curreg++, t1reg++, t2reg++) {
-                *t1reg = *t2reg;
-            }
+            initial_rules = cie->ci_initial_table->fr_reg;
             cfa_reg = cie->ci_initial_table->fr_cfa_rule;
         } else {
-            dwarf_init_reg_rules_ru(localregtab,0,reg_count,
-                dbg->de_frame_rule_initial_value);
             dwarf_init_reg_rules_ru(&cfa_reg,0, 1,
                 dbg->de_frame_rule_initial_value);
         }
@@ -377,6 +531,7 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
                 search_over = search_pc &&
                     (possible_subsequent_pc > search_pc_val);
                 /* If gone past pc needed, retain old pc.  */
+                BATCH_ROWS(possible_subsequent_pc);
                 if (!search_over) {
                     current_loc = possible_subsequent_pc;
                 }
@@ -399,10 +554,11 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
                     SIMPLE_ERROR_RETURN(DW_DLE_DF_NO_CIE_AUGMENTATION);
                 }
 
-                localregtab[reg_no].ru_is_off = 1;
-                localregtab[reg_no].ru_value_type = DW_EXPR_OFFSET;
-                localregtab[reg_no].ru_register = reg_num_of_cfa;
-                localregtab[reg_no].ru_offset_or_block_len =
+                SPARSE_RULE(reg_no);
+                lrule->ru_is_off = 1;
+                lrule->ru_value_type = DW_EXPR_OFFSET;
+                lrule->ru_register = reg_num_of_cfa;
+                lrule->ru_offset_or_block_len =
                     factored_N_value * data_alignment_factor;
 
                 break;
@@ -416,8 +572,7 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
                 fp_register = reg_no;
 
                 if (cie != NULL && cie->ci_initial_table != NULL)
-                    localregtab[reg_no] =
-                        cie->ci_initial_table->fr_reg[reg_no];
+                    _dwarf_sparse_rule_remove(&localrow,reg_no);
                 else if (!make_instr) {
                     SIMPLE_ERROR_RETURN(DW_DLE_DF_MAKE_INSTR_NO_INIT);
                 }
@@ -451,6 +606,7 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
 
                 /* If gone past pc needed, retain old pc.  */
                 possible_subsequent_pc =  new_loc;
+                BATCH_ROWS(possible_subsequent_pc);
                 if (!search_over) {
                     current_loc = possible_subsequent_pc;
                 }
@@ -476,6 +632,7 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
                     (possible_subsequent_pc > search_pc_val);
 
                 /* If gone past pc needed, retain old pc.  */
+                BATCH_ROWS(possible_subsequent_pc);
                 if (!search_over) {
                     current_loc = possible_subsequent_pc;
                 }
@@ -499,6 +656,7 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
                 search_over = search_pc &&
                     (possible_subsequent_pc > search_pc_val);
                 /* If gone past pc needed, retain old pc.  */
+                BATCH_ROWS(possible_subsequent_pc);
                 if (!search_over) {
                     current_loc = possible_subsequent_pc;
                 }
@@ -522,6 +680,7 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
                 search_over = search_pc &&
                     (possible_subsequent_pc > search_pc_val);
                 /* If gone past pc needed, retain old pc.  */
+                BATCH_ROWS(possible_subsequent_pc);
                 if (!search_over) {
                     current_loc = possible_subsequent_pc;
                 }
@@ -543,10 +702,11 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
                 if (need_augmentation) {
                     SIMPLE_ERROR_RETURN(DW_DLE_DF_NO_CIE_AUGMENTATION);
                 }
-                localregtab[reg_no].ru_is_off = 1;
-                localregtab[reg_no].ru_value_type = DW_EXPR_OFFSET;
-                localregtab[reg_no].ru_register = reg_num_of_cfa;
-                localregtab[reg_no].ru_offset_or_block_len = factored_N_value *
+                SPARSE_RULE(reg_no);
+                lrule->ru_is_off = 1;
+                lrule->ru_value_type = DW_EXPR_OFFSET;
+                lrule->ru_register = reg_num_of_cfa;
+                lrule->ru_offset_or_block_len = factored_N_value *
                     data_alignment_factor;
 
                 fp_register = reg_no;
@@ -565,7 +725,7 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
                 ERROR_IF_REG_NUM_TOO_HIGH(reg_no, reg_count);
 
                 if (cie != NULL && cie->ci_initial_table != NULL) {
-                    localregtab[reg_no] = cie->ci_initial_table->fr_reg[reg_no];
+                    _dwarf_sparse_rule_remove(&localrow,reg_no);
                 } else {
                     if (!make_instr) {
                         SIMPLE_ERROR_RETURN
@@ -586,11 +746,12 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
                 reg_no = (reg_num_type) lreg;
                 ERROR_IF_REG_NUM_TOO_HIGH(reg_no, reg_count);
 
-                localregtab[reg_no].ru_is_off = 0;
-                localregtab[reg_no].ru_value_type = DW_EXPR_OFFSET;
-                localregtab[reg_no].ru_register =
+                SPARSE_RULE(reg_no);
+                lrule->ru_is_off = 0;
+                lrule->ru_value_type = DW_EXPR_OFFSET;
+                lrule->ru_register =
                     dbg->de_frame_undefined_value_number;
-                localregtab[reg_no].ru_offset_or_block_len = 0;
+                lrule->ru_offset_or_block_len = 0;
 
                 fp_register = reg_no;
                 break;
@@ -605,11 +766,12 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
                 reg_no = (reg_num_type) lreg;
                 ERROR_IF_REG_NUM_TOO_HIGH(reg_no, reg_count);
 
-                localregtab[reg_no].ru_is_off = 0;
-                localregtab[reg_no].ru_value_type = DW_EXPR_OFFSET;
-                localregtab[reg_no].ru_register =
+                SPARSE_RULE(reg_no);
+                lrule->ru_is_off = 0;
+                lrule->ru_value_type = DW_EXPR_OFFSET;
+                lrule->ru_register =
                     dbg->de_frame_same_value_number;
-                localregtab[reg_no].ru_offset_or_block_len = 0;
+                lrule->ru_offset_or_block_len = 0;
                 fp_register = reg_no;
                 break;
             }
@@ -635,10 +797,11 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
                 }
 
 
-                localregtab[reg_noA].ru_is_off = 0;
-                localregtab[reg_noA].ru_value_type = DW_EXPR_OFFSET;
-                localregtab[reg_noA].ru_register = reg_noB;
-                localregtab[reg_noA].ru_offset_or_block_len = 0;
+                SPARSE_RULE(reg_noA);
+                lrule->ru_is_off = 0;
+                lrule->ru_value_type = DW_EXPR_OFFSET;
+                lrule->ru_register = reg_noB;
+                lrule->ru_offset_or_block_len = 0;
 
                 fp_register = reg_noA;
                 fp_offset = reg_noB;
@@ -647,18 +810,28 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
 
         case DW_CFA_remember_state:
             {
-                stack_table = (Dwarf_Frame)
-                    _dwarf_get_alloc(dbg, DW_DLA_FRAME, 1);
+                stack_table = (struct Dwarf_Sparse_Stack_s *)
+                    calloc(1,sizeof(struct Dwarf_Sparse_Stack_s));
                 if (stack_table == NULL) {
                     SIMPLE_ERROR_RETURN(DW_DLE_DF_ALLOC_FAIL);
                 }
-
-                for (i = 0; i < reg_count; i++)
-                    stack_table->fr_reg[i] = localregtab[i];
-                stack_table->fr_cfa_rule = cfa_reg;
-
-                if (top_stack != NULL)
-                    stack_table->fr_next = top_stack;
+                stack_table->ss_row.sr_count = localrow.sr_count;
+                stack_table->ss_row.sr_max = localrow.sr_count;
+                if (localrow.sr_count) {
+                    stack_table->ss_row.sr_regs =
+                        (struct Dwarf_Reg_Rule_Sparse_s *)malloc(
+                        localrow.sr_count*
+                        sizeof(struct Dwarf_Reg_Rule_Sparse_s));
+                    if (!stack_table->ss_row.sr_regs) {
+                        free(stack_table);
+                        SIMPLE_ERROR_RETURN(DW_DLE_DF_ALLOC_FAIL);
+                    }
+                    memcpy(stack_table->ss_row.sr_regs,
+                        localrow.sr_regs,localrow.sr_count*
+                        sizeof(struct Dwarf_Reg_Rule_Sparse_s));
+                }
+                stack_table->ss_cfa = cfa_reg;
+                stack_table->ss_next = top_stack;
                 top_stack = stack_table;
 
                 break;
@@ -670,13 +843,12 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
                     SIMPLE_ERROR_RETURN(DW_DLE_DF_POP_EMPTY_STACK);
                 }
                 stack_table = top_stack;
-                top_stack = stack_table->fr_next;
+                top_stack = stack_table->ss_next;
 
-                for (i = 0; i < reg_count; i++)
-                    localregtab[i] = stack_table->fr_reg[i];
-                cfa_reg = stack_table->fr_cfa_rule;
-
-                dwarf_dealloc(dbg, stack_table, DW_DLA_FRAME);
+                free(localrow.sr_regs);
+                localrow = stack_table->ss_row;
+                cfa_reg = stack_table->ss_cfa;
+                free(stack_table);
                 break;
             }
 
@@ -792,10 +964,11 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
                 ERROR_IF_REG_NUM_TOO_HIGH(reg_no, reg_count);
                 DECODE_LEB128_UWORD_CK(instr_ptr, block_len,
                     dbg,error,final_instr_ptr);
-                localregtab[lreg].ru_is_off = 0;        /* arbitrary */
-                localregtab[lreg].ru_value_type = DW_EXPR_EXPRESSION;
-                localregtab[lreg].ru_offset_or_block_len = block_len;
-                localregtab[lreg].ru_block = instr_ptr;
+                SPARSE_RULE(lreg);
+                lrule->ru_is_off = 0;        /* arbitrary */
+                lrule->ru_value_type = DW_EXPR_EXPRESSION;
+                lrule->ru_offset_or_block_len = block_len;
+                lrule->ru_block = instr_ptr;
                 fp_offset = (Dwarf_Unsigned) instr_ptr;
                 fp_register = reg_no;
                 instr_ptr += block_len;
@@ -820,10 +993,11 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
                 if (need_augmentation) {
                     SIMPLE_ERROR_RETURN(DW_DLE_DF_NO_CIE_AUGMENTATION);
                 }
-                localregtab[reg_no].ru_is_off = 1;
-                localregtab[reg_no].ru_value_type = DW_EXPR_OFFSET;
-                localregtab[reg_no].ru_register = reg_num_of_cfa;
-                localregtab[reg_no].ru_offset_or_block_len =
+                SPARSE_RULE(reg_no);
+                lrule->ru_is_off = 1;
+                lrule->ru_value_type = DW_EXPR_OFFSET;
+                lrule->ru_register = reg_num_of_cfa;
+                lrule->ru_offset_or_block_len =
                     signed_factored_N_value * data_alignment_factor;
 
                 fp_register = reg_no;
@@ -904,10 +1078,11 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
                 }
                 /*  Do set ru_is_off here, as here factored_N_value
                     counts.  */
-                localregtab[reg_no].ru_is_off = 1;
-                localregtab[reg_no].ru_register = reg_num_of_cfa;
-                localregtab[reg_no].ru_value_type = DW_EXPR_VAL_OFFSET;
-                localregtab[reg_no].ru_offset_or_block_len =
+                SPARSE_RULE(reg_no);
+                lrule->ru_is_off = 1;
+                lrule->ru_register = reg_num_of_cfa;
+                lrule->ru_value_type = DW_EXPR_VAL_OFFSET;
+                lrule->ru_offset_or_block_len =
                     factored_N_value * data_alignment_factor;
 
                 fp_offset = factored_N_value;
@@ -933,9 +1108,10 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
                 }
                 /*  Do set ru_is_off here, as here factored_N_value
                     counts.  */
-                localregtab[reg_no].ru_is_off = 1;
-                localregtab[reg_no].ru_value_type = DW_EXPR_VAL_OFFSET;
-                localregtab[reg_no].ru_offset_or_block_len =
+                SPARSE_RULE(reg_no);
+                lrule->ru_is_off = 1;
+                lrule->ru_value_type = DW_EXPR_VAL_OFFSET;
+                lrule->ru_offset_or_block_len =
                     signed_factored_N_value * data_alignment_factor;
 
                 fp_offset = signed_factored_N_value;
@@ -957,10 +1133,11 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
                 ERROR_IF_REG_NUM_TOO_HIGH(reg_no, reg_count);
                 DECODE_LEB128_UWORD_CK(instr_ptr, block_len,
                     dbg,error,final_instr_ptr);
-                localregtab[lreg].ru_is_off = 0;        /* arbitrary */
-                localregtab[lreg].ru_value_type = DW_EXPR_VAL_EXPRESSION;
-                localregtab[lreg].ru_offset_or_block_len = block_len;
-                localregtab[lreg].ru_block = instr_ptr;
+                SPARSE_RULE(lreg);
+                lrule->ru_is_off = 0;        /* arbitrary */
+                lrule->ru_value_type = DW_EXPR_VAL_EXPRESSION;
+                lrule->ru_offset_or_block_len = block_len;
+                lrule->ru_block = instr_ptr;
                 fp_offset = (Dwarf_Unsigned) instr_ptr;
 
                 instr_ptr += block_len;
@@ -1058,18 +1235,22 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
         }
     }
 
+    /*  The last row applies to the rest of the batch pcs. */
+    BATCH_ROWS(~(Dwarf_Addr)0);
+
     /* Fill in the actual output table, the space the caller passed in. */
     if (table != NULL) {
-
-        struct Dwarf_Reg_Rule_s *t2reg = table->fr_reg;
-        struct Dwarf_Reg_Rule_s *t3reg = localregtab;
         unsigned minregcount =  MIN(table->fr_reg_count,reg_count);
-        unsigned curreg = 0;
 
         table->fr_loc = current_loc;
-        for (; curreg < minregcount ; curreg++, t3reg++, t2reg++) {
-            *t2reg = *t3reg;
+        if (table->fr_reg) {
+            _dwarf_sparse_row_to_rules(&localrow,initial_rules,
+                dbg->de_frame_rule_initial_value,
+                table->fr_reg,minregcount);
         }
+        free(table->fr_changed.sr_regs);
+        table->fr_changed = localrow;
+        memset(&localrow,0,sizeof(localrow));
 
         /*  CONSTCOND */
         /*  Do not update the main table with the cfa_reg.
@@ -1078,11 +1259,8 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
     }
 
     /* Dealloc anything remaining on stack. */
-    for (; top_stack != NULL;) {
-        stack_table = top_stack;
-        top_stack = top_stack->fr_next;
-        dwarf_dealloc(dbg, stack_table, DW_DLA_FRAME);
-    }
+    _dwarf_sparse_stack_free(top_stack);
+    top_stack = 0;
 
     if (make_instr) {
         /*  Allocate list of pointers to Dwarf_Frame_Op's.  */
@@ -1109,10 +1287,11 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
     } else {
         *returned_count = 0;
     }
-    free(localregtab);
+    free(localrow.sr_regs);
     return DW_DLV_OK;
 #undef ERROR_IF_REG_NUM_TOO_HIGH
 #undef SIMPLE_ERROR_RETURN
+#undef SPARSE_RULE
 }
 
 /*  Depending on version, either read the return address register
@@ -1542,40 +1721,20 @@ dwarf_get_cie_info_b(Dwarf_Cie cie,
     return (DW_DLV_OK);
 }
 
-/* Return the register rules for all registers at a given pc.
-*/
+/*  Makes sure the initial row of the cie of fde exists
+    and finds the end of the fde instructions.  */
 static int
-_dwarf_get_fde_info_for_a_pc_row(Dwarf_Fde fde,
-    Dwarf_Addr pc_requested,
-    Dwarf_Frame table,
+_dwarf_fde_instr_setup(Dwarf_Fde fde,
     Dwarf_Half cfa_reg_col_num,
-    Dwarf_Bool * has_more_rows,
-    Dwarf_Addr * subsequent_pc,
+    Dwarf_Small **instr_end_out,
     Dwarf_Error * error)
 {
-    Dwarf_Debug dbg = 0;
+    Dwarf_Debug dbg = fde->fd_dbg;
     Dwarf_Cie cie = 0;
     Dwarf_Sword icount = 0;
+    Dwarf_Small *instr_end = 0;
     int res = 0;
 
-    if (fde == NULL) {
-        _dwarf_error(NULL, error, DW_DLE_FDE_NULL);
-        return DW_DLV_ERROR;
-    }
-
-    dbg = fde->fd_dbg;
-    if (dbg == NULL) {
-        _dwarf_error(NULL, error, DW_DLE_FDE_DBG_NULL);
-        return DW_DLV_ERROR;
-    }
-
-    if (pc_requested < fde->fd_initial_location ||
-        pc_requested >=
-        fde->fd_initial_location + fde->fd_address_range) {
-        _dwarf_error(dbg, error, DW_DLE_PC_NOT_IN_FDE_RANGE);
-        return DW_DLV_ERROR;
-    }
-
     cie = fde->fd_cie;
     if (cie->ci_initial_table == NULL) {
         Dwarf_Small *instrstart = cie->ci_cie_instr_start;
@@ -1609,37 +1768,79 @@ _dwarf_get_fde_info_for_a_pc_row(Dwarf_Fde fde,
             cie->ci_initial_table, cie, dbg,
             cfa_reg_col_num, &icount,
             NULL,NULL,
+            /* batch */ NULL,
             error);
         if (res != DW_DLV_OK) {
             return res;
         }
     }
 
-    {
-        Dwarf_Small *instr_end = fde->fd_fde_instr_start +
-            fde->fd_length +
-            fde->fd_length_size +
-            fde->fd_extension_size - (fde->fd_fde_instr_start -
-                fde->fd_fde_start);
-        if (instr_end > fde->fd_fde_end) {
-            _dwarf_error(dbg, error,DW_DLE_FDE_INSTR_PTR_ERROR);
-            return DW_DLV_ERROR;
-        }
+    instr_end = fde->fd_fde_instr_start +
+        fde->fd_length +
+        fde->fd_length_size +
+        fde->fd_extension_size - (fde->fd_fde_instr_start -
+            fde->fd_fde_start);
+    if (instr_end > fde->fd_fde_end) {
+        _dwarf_error(dbg, error,DW_DLE_FDE_INSTR_PTR_ERROR);
+        return DW_DLV_ERROR;
+    }
+    *instr_end_out = instr_end;
+    return DW_DLV_OK;
+}
 
-        res = _dwarf_exec_frame_instr( /* make_instr= */ false,
-            /* ret_frame_instr= */ NULL,
-            /* search_pc */ true,
-            /* search_pc_val */ pc_requested,
-            fde->fd_initial_location,
-            fde->fd_fde_instr_start,
-            instr_end,
-            table,
-            cie, dbg,
-            cfa_reg_col_num, &icount,
-            has_more_rows,
-            subsequent_pc,
-            error);
+/* Return the register rules for all registers at a given pc.
+*/
+static int
+_dwarf_get_fde_info_for_a_pc_row(Dwarf_Fde fde,
+    Dwarf_Addr pc_requested,
+    Dwarf_Frame table,
+    Dwarf_Half cfa_reg_col_num,
+    Dwarf_Bool * has_more_rows,
+    Dwarf_Addr * subsequent_pc,
+    Dwarf_Error * error)
+{
+    Dwarf_Debug dbg = 0;
+    Dwarf_Sword icount = 0;
+    Dwarf_Small *instr_end = 0;
+    int res = 0;
+
+    if (fde == NULL) {
+        _dwarf_error(NULL, error, DW_DLE_FDE_NULL);
+        return DW_DLV_ERROR;
+    }
+
+    dbg = fde->fd_dbg;
+    if (dbg == NULL) {
+        _dwarf_error(NULL, error, DW_DLE_FDE_DBG_NULL);
+        return DW_DLV_ERROR;
+    }
+
+    if (pc_requested < fde->fd_initial_location ||
+        pc_requested >=
+        fde->fd_initial_location + fde->fd_address_range) {
+        _dwarf_error(dbg, error, DW_DLE_PC_NOT_IN_FDE_RANGE);
+        return DW_DLV_ERROR;
     }
+
+    res = _dwarf_fde_instr_setup(fde,cfa_reg_col_num,
+        &instr_end,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    res = _dwarf_exec_frame_instr( /* make_instr= */ false,
+        /* ret_frame_instr= */ NULL,
+        /* search_pc */ true,
+        /* search_pc_val */ pc_requested,
+        fde->fd_initial_location,
+        fde->fd_fde_instr_start,
+        instr_end,
+        table,
+        fde->fd_cie, dbg,
+        cfa_reg_col_num, &icount,
+        has_more_rows,
+        subsequent_pc,
+        /* batch */ NULL,
+        error);
     if (res != DW_DLV_OK) {
         return res;
     }
@@ -1809,6 +2010,143 @@ dwarf_get_fde_info_for_all_regs3(Dwarf_Fde fde,
     return DW_DLV_OK;
 }
 
+/*  New 2018.  As dwarf_get_fde_info_for_all_regs3() but
+    for pc_count pcs of the fde at once, in ascending order,
+    with one pass over the frame instructions.
+    reg_tables[i] (and row_pcs[i] if row_pcs is non-null)
+    is set for pcs[i] exactly as
+    dwarf_get_fde_info_for_all_regs3() would set it.  */
+int
+dwarf_get_fde_info_for_all_regs3_batch(Dwarf_Fde fde,
+    Dwarf_Addr * pcs,
+    Dwarf_Unsigned pc_count,
+    Dwarf_Regtable3 * reg_tables,
+    Dwarf_Addr * row_pcs,
+    Dwarf_Error * error)
+{
+    struct Dwarf_Frame_Batch_s batch;
+    Dwarf_Debug dbg = 0;
+    Dwarf_Sword icount = 0;
+    Dwarf_Small *instr_end = 0;
+    Dwarf_Unsigned i = 0;
+    int res = 0;
+
+    FDE_NULL_CHECKS_AND_SET_DBG(fde, dbg);
+    if (!pc_count) {
+        return DW_DLV_NO_ENTRY;
+    }
+    for (i = 0; i < pc_count; ++i) {
+        if (pcs[i] < fde->fd_initial_location ||
+            pcs[i] >= fde->fd_initial_location +
+            fde->fd_address_range) {
+            _dwarf_error(dbg, error, DW_DLE_PC_NOT_IN_FDE_RANGE);
+            return DW_DLV_ERROR;
+        }
+        if (i && pcs[i] < pcs[i-1]) {
+            _dwarf_error(dbg, error, DW_DLE_FRAME_PCS_NOT_SORTED);
+            return DW_DLV_ERROR;
+        }
+    }
+    res = _dwarf_fde_instr_setup(fde,dbg->de_frame_cfa_col_number,
+        &instr_end,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    batch.fb_pcs = pcs;
+    batch.fb_count = pc_count;
+    batch.fb_next = 0;
+    batch.fb_tables = reg_tables;
+    batch.fb_row_pcs = row_pcs;
+    batch.fb_undefined_value = dbg->de_frame_undefined_value_number;
+    batch.fb_initial_value = dbg->de_frame_rule_initial_value;
+    res = _dwarf_exec_frame_instr( /* make_instr= */ false,
+        /* ret_frame_instr= */ NULL,
+        /* search_pc */ false,
+        /* search_pc_val */ 0,
+        fde->fd_initial_location,
+        fde->fd_fde_instr_start,
+        instr_end,
+        /* table */ NULL,
+        fde->fd_cie, dbg,
+        dbg->de_frame_cfa_col_number, &icount,
+        NULL,NULL,
+        &batch,
+        error);
+    return res;
+}
+
+/*  New 2018.  Returns only the registers whose rule at
+    pc_requested is set by the cie or fde instructions,
+    in ascending column order: rt3_rules[k] is the rule for
+    column columns[k].  All other columns have the initial
+    rule value.  *changed_count is the number of such
+    registers even if rt3_reg_table_size is smaller and
+    not all of them could be returned.  */
+int
+dwarf_get_fde_info_for_changed_regs3(Dwarf_Fde fde,
+    Dwarf_Addr pc_requested,
+    Dwarf_Regtable3 * reg_table,
+    Dwarf_Half * columns,
+    Dwarf_Unsigned * changed_count,
+    Dwarf_Addr * row_pc,
+    Dwarf_Error * error)
+{
+    struct Dwarf_Frame_s fde_table;
+    struct Dwarf_Sparse_Row_s *cierow = 0;
+    struct Dwarf_Sparse_Row_s *fderow = 0;
+    unsigned ci = 0;
+    unsigned fi = 0;
+    Dwarf_Unsigned count = 0;
+    Dwarf_Unsigned size = reg_table->rt3_reg_table_size;
+    Dwarf_Debug dbg = 0;
+    int res = 0;
+
+    FDE_NULL_CHECKS_AND_SET_DBG(fde, dbg);
+
+    /*  fr_reg stays null: only the sparse row is wanted. */
+    memset(&fde_table,0,sizeof(fde_table));
+    res = _dwarf_get_fde_info_for_a_pc_row(fde, pc_requested,
+        &fde_table, dbg->de_frame_cfa_col_number,NULL,NULL, error);
+    if (res != DW_DLV_OK) {
+        dwarf_free_fde_table(&fde_table);
+        return res;
+    }
+    cierow = &fde->fd_cie->ci_initial_table->fr_changed;
+    fderow = &fde_table.fr_changed;
+    while (ci < cierow->sr_count || fi < fderow->sr_count) {
+        struct Dwarf_Reg_Rule_Sparse_s *r = 0;
+
+        if (fi >= fderow->sr_count ||
+            (ci < cierow->sr_count &&
+            cierow->sr_regs[ci].rs_column <
+            fderow->sr_regs[fi].rs_column)) {
+            r = cierow->sr_regs + ci++;
+        } else {
+            if (ci < cierow->sr_count &&
+                cierow->sr_regs[ci].rs_column ==
+                fderow->sr_regs[fi].rs_column) {
+                /*  The fde rule replaces the cie rule. */
+                ci++;
+            }
+            r = fderow->sr_regs + fi++;
+        }
+        if (count < size) {
+            columns[count] = r->rs_column;
+            _dwarf_frame_rule_to_entry3(&r->rs_rule,
+                reg_table->rt3_rules + count);
+        }
+        count++;
+    }
+    _dwarf_frame_rule_to_entry3(&fde_table.fr_cfa_rule,
+        &reg_table->rt3_cfa_rule);
+    *changed_count = count;
+    if (row_pc != NULL) {
+        *row_pc = fde_table.fr_loc;
+    }
+    dwarf_free_fde_table(&fde_table);
+    return DW_DLV_OK;
+}
+
 /*  Gets the register info for a single register at a given PC value
     for the FDE specified.
 
@@ -2251,6 +2589,7 @@ dwarf_expand_frame_instructions(Dwarf_Cie cie,
         dbg,
         dbg->de_frame_cfa_col_number, &instr_count,
         NULL,NULL,
+        /* batch */ NULL,
         error);
     if (res != DW_DLV_OK) {
         return (res);
@@ -2565,6 +2904,8 @@ dwarf_free_fde_table(struct Dwarf_Frame_s *fde_table)
     free(fde_table->fr_reg);
     fde_table->fr_reg_count = 0;
     fde_table->fr_reg = 0;
+    free(fde_table->fr_changed.sr_regs);
+    memset(&fde_table->fr_changed,0,sizeof(fde_table->fr_changed));
 }
 
 
@@ -2638,3 +2979,69 @@ dwarf_init_reg_rules_dw3(struct Dwarf_Regtable_Entry3_s *base,
         r->dw_block_ptr = 0;
     }
 }
+
+static void
+_dwarf_frame_rule_to_entry3(struct Dwarf_Reg_Rule_s *rule,
+    struct Dwarf_Regtable_Entry3_s *out_rule)
+{
+    out_rule->dw_offset_relevant = rule->ru_is_off;
+    out_rule->dw_value_type = rule->ru_value_type;
+    out_rule->dw_regnum = rule->ru_register;
+    out_rule->dw_offset_or_block_len = rule->ru_offset_or_block_len;
+    out_rule->dw_block_ptr = rule->ru_block;
+}
+
+/*  Gives the row at current_loc to each batch pc
+    below next_loc.  Pcs sharing a row copy the
+    first table filled.  */
+static void
+_dwarf_frame_batch_rows(struct Dwarf_Frame_Batch_s *batch,
+    Dwarf_Addr next_loc,
+    Dwarf_Addr current_loc,
+    struct Dwarf_Sparse_Row_s *row,
+    struct Dwarf_Reg_Rule_s *initial_rules,
+    unsigned reg_count,
+    struct Dwarf_Reg_Rule_s *cfa_rule)
+{
+    Dwarf_Regtable3 *first = 0;
+
+    for ( ; batch->fb_next < batch->fb_count &&
+        batch->fb_pcs[batch->fb_next] < next_loc;
+        batch->fb_next++) {
+        Dwarf_Regtable3 *rt = batch->fb_tables + batch->fb_next;
+        unsigned size = rt->rt3_reg_table_size;
+        unsigned dense = MIN(size,reg_count);
+        unsigned i = 0;
+
+        if (batch->fb_row_pcs) {
+            batch->fb_row_pcs[batch->fb_next] = current_loc;
+        }
+        _dwarf_frame_rule_to_entry3(cfa_rule,&rt->rt3_cfa_rule);
+        if (first && first->rt3_reg_table_size == size) {
+            memcpy(rt->rt3_rules,first->rt3_rules,
+                size*sizeof(struct Dwarf_Regtable_Entry3_s));
+            continue;
+        }
+        if (initial_rules) {
+            for (i = 0; i < dense; ++i) {
+                _dwarf_frame_rule_to_entry3(initial_rules+i,
+                    rt->rt3_rules+i);
+            }
+        } else {
+            dwarf_init_reg_rules_dw3(rt->rt3_rules,0,dense,
+                batch->fb_initial_value);
+        }
+        dwarf_init_reg_rules_dw3(rt->rt3_rules,dense,size,
+            batch->fb_undefined_value);
+        for (i = 0; i < row->sr_count; ++i) {
+            struct Dwarf_Reg_Rule_Sparse_s *r = row->sr_regs + i;
+
+            if (r->rs_column >= dense) {
+                break;
+            }
+            _dwarf_frame_rule_to_entry3(&r->rs_rule,
+                rt->rt3_rules + r->rs_column);
+        }
+        first = rt;
+    }
+}
@@ -142,6 +142,21 @@ struct Dwarf_Reg_Rule_s {
 
 typedef struct Dwarf_Frame_s *Dwarf_Frame;
 
+/*  New 2018.  A sparse row of register rules.
+    Only the columns a frame program set are listed,
+    in ascending column order.  Every other column has
+    the rule of the cie initial row (or, running the cie
+    instructions themselves, the initial rule value).  */
+struct Dwarf_Reg_Rule_Sparse_s {
+    unsigned                rs_column;
+    struct Dwarf_Reg_Rule_s rs_rule;
+};
+struct Dwarf_Sparse_Row_s {
+    unsigned sr_count;
+    unsigned sr_max;
+    struct Dwarf_Reg_Rule_Sparse_s *sr_regs;
+};
+
 /*
     This structure represents a row of the frame table.
     Fr_loc is the pc value for this row, and Fr_reg
@@ -164,6 +179,12 @@ struct Dwarf_Frame_s {
     struct Dwarf_Reg_Rule_s *fr_reg;
 
     Dwarf_Frame fr_next;
+
+    /*  The columns the frame program set for this row.
+        fr_reg is filled from this and the cie initial row.
+        For the cie initial row this is what the cie
+        instructions set.  */
+    struct Dwarf_Sparse_Row_s fr_changed;
 };
 
 typedef struct Dwarf_Frame_Op_List_s *Dwarf_Frame_Op_List;
@@ -396,6 +417,18 @@ struct cie_fde_prefix_s {
     Dwarf_Unsigned cf_section_length;
 };
 
+/*  For dwarf_get_fde_info_for_all_regs3_batch():
+    fb_pcs[fb_next] onward have not yet been given a row.  */
+struct Dwarf_Frame_Batch_s {
+    Dwarf_Addr      *fb_pcs;
+    Dwarf_Unsigned   fb_count;
+    Dwarf_Unsigned   fb_next;
+    Dwarf_Regtable3 *fb_tables;
+    Dwarf_Addr      *fb_row_pcs;
+    int              fb_undefined_value;
+    int              fb_initial_value;
+};
+
 int
 _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
     Dwarf_Frame_Op ** ret_frame_instr,
@@ -411,6 +444,7 @@ _dwarf_exec_frame_instr(Dwarf_Bool make_instr,
     Dwarf_Sword * returned_count,
     Dwarf_Bool  * has_more_rows,
     Dwarf_Addr  * subsequent_pc,
+    struct Dwarf_Frame_Batch_s *batch,
     Dwarf_Error * error);
 
 
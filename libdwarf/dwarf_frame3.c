@@ -109,7 +109,8 @@ _dwarf_frame_address_offsets(Dwarf_Debug dbg, Dwarf_Addr ** addrlist,
             dbg,
             DW_FRAME_CFA_COL,
             &icount,
-            NULL, NULL,err);
+            NULL, NULL,
+            /* batch */ NULL,err);
         if (res == DW_DLV_ERROR) {
             return res;
         } else if (res == DW_DLV_NO_ENTRY) {
@@ -204,7 +205,8 @@ _dwarf_frame_address_offsets(Dwarf_Debug dbg, Dwarf_Addr ** addrlist,
             dbg,
             DW_FRAME_CFA_COL,
             &icount,
-            NULL,NULL,err);
+            NULL,NULL,
+            /* batch */ NULL,err);
         if (res == DW_DLV_ERROR) {
             return res;
         } else if (res == DW_DLV_NO_ENTRY) {
@@ -30,6 +30,7 @@
 #include "dwarf_incl.h"
 
 #include <stdio.h>
+#include <stddef.h> /* for offsetof */
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <string.h>
@@ -310,91 +311,188 @@ all_sig8_bits_zero(Dwarf_Sig8 *val)
 #endif
 
 
-/* Return DW_DLV_OK etc. */
-static int
-set_up_section(Dwarf_Debug dbg,
-   /* Section name from object format. */
-   const char *secname,
-   /* Section number from object format  */
-   unsigned obj_sec_num,
-   /* The name associated with this secdata */
-   const char *targname,
-   /* DW_GROUPNUMBER_ANY or BASE or DWO or some other group num */
-   unsigned  groupnum_of_sec,
-   struct Dwarf_Section_s *secdata,
-   int duperr,int emptyerr,int have_dwarf,
-   int *err)
+/*  The sections libdwarf sets up, as seen in an object file
+    (a .zdebug_ name is looked up as its .debug_ name).
+    ks_dwo_group means the section is always in
+    group DW_GROUPNUMBER_DWO.
+    ks_have_dwarf is a somewhat imprecise
+    way to determine if there is at least one 'meaningful'
+    DWARF information section present in the object file.
+    If not set on some section we claim (later) that there
+    is no DWARF info present. see 'foundDwarf' in this file.
+    ".debug_macinfo.dwo", ".debug_ranges.dwo", ".debug_sup.dwo"
+    ".debug_addr.dwo" and ".debug_names.dwo" are not allowed. */
+struct Dwarf_Known_Section_s {
+    const char *ks_name;
+    /*  Where the struct Dwarf_Section_s is in Dwarf_Debug_s. */
+    size_t      ks_secdata_offset;
+    int         ks_dwo_group;
+    int         ks_duperr;
+    int         ks_emptyerr;
+    int         ks_have_dwarf;
+};
+#define KNOWN_SECTION(n,f,dwo,dup,empty,hd) \
+    { n,offsetof(struct Dwarf_Debug_s,f),dwo,dup,empty,hd }
+static const struct Dwarf_Known_Section_s known_sections[] = {
+    KNOWN_SECTION(".debug_info",de_debug_info,FALSE,
+        DW_DLE_DEBUG_INFO_DUPLICATE,DW_DLE_DEBUG_INFO_NULL,TRUE),
+    KNOWN_SECTION(".debug_info.dwo",de_debug_info,TRUE,
+        DW_DLE_DEBUG_INFO_DUPLICATE,DW_DLE_DEBUG_INFO_NULL,TRUE),
+    KNOWN_SECTION(".debug_types",de_debug_types,FALSE,
+        DW_DLE_DEBUG_TYPES_DUPLICATE,DW_DLE_DEBUG_TYPES_NULL,TRUE),
+    KNOWN_SECTION(".debug_types.dwo",de_debug_types,TRUE,
+        DW_DLE_DEBUG_TYPES_DUPLICATE,DW_DLE_DEBUG_TYPES_NULL,TRUE),
+    KNOWN_SECTION(".debug_abbrev",de_debug_abbrev,FALSE,
+        DW_DLE_DEBUG_ABBREV_DUPLICATE,DW_DLE_DEBUG_ABBREV_NULL,TRUE),
+    KNOWN_SECTION(".debug_abbrev.dwo",de_debug_abbrev,TRUE,
+        DW_DLE_DEBUG_ABBREV_DUPLICATE,DW_DLE_DEBUG_ABBREV_NULL,TRUE),
+    KNOWN_SECTION(".debug_aranges",de_debug_aranges,FALSE,
+        DW_DLE_DEBUG_ARANGES_DUPLICATE,0,FALSE),
+    KNOWN_SECTION(".debug_line",de_debug_line,FALSE,
+        DW_DLE_DEBUG_LINE_DUPLICATE,0,TRUE),
+    KNOWN_SECTION(".debug_line_str",de_debug_line_str,FALSE,
+        DW_DLE_DEBUG_LINE_DUPLICATE,0,FALSE),
+    KNOWN_SECTION(".debug_line.dwo",de_debug_line,TRUE,
+        DW_DLE_DEBUG_LINE_DUPLICATE,0,TRUE),
+    KNOWN_SECTION(".debug_frame",de_debug_frame,FALSE,
+        DW_DLE_DEBUG_FRAME_DUPLICATE,0,TRUE),
+    KNOWN_SECTION(".eh_frame",de_debug_frame_eh_gnu,FALSE,
+        DW_DLE_DEBUG_FRAME_DUPLICATE,0,TRUE),
+    KNOWN_SECTION(".debug_loc",de_debug_loc,FALSE,
+        DW_DLE_DEBUG_LOC_DUPLICATE,0,FALSE),
+    KNOWN_SECTION(".debug_loc.dwo",de_debug_loc,TRUE,
+        DW_DLE_DEBUG_LOC_DUPLICATE,0,FALSE),
+    KNOWN_SECTION(".debug_pubnames",de_debug_pubnames,FALSE,
+        DW_DLE_DEBUG_PUBNAMES_DUPLICATE,0,FALSE),
+    KNOWN_SECTION(".debug_str",de_debug_str,FALSE,
+        DW_DLE_DEBUG_STR_DUPLICATE,0,FALSE),
+    KNOWN_SECTION(".debug_str.dwo",de_debug_str,TRUE,
+        DW_DLE_DEBUG_STR_DUPLICATE,0,FALSE),
+    KNOWN_SECTION(".debug_pubtypes",de_debug_pubtypes,FALSE,
+        DW_DLE_DEBUG_PUBTYPES_DUPLICATE,0,FALSE),
+    KNOWN_SECTION(".debug_names",de_debug_names,FALSE,
+        DW_DLE_DEBUG_NAMES_DUPLICATE,0,FALSE),
+    KNOWN_SECTION(".debug_loclists",de_debug_loclists,FALSE,
+        DW_DLE_DEBUG_LOClISTS_DUPLICATE,0,FALSE),
+    KNOWN_SECTION(".debug_loclists.dwo",de_debug_loclists,TRUE,
+        DW_DLE_DEBUG_LOClISTS_DUPLICATE,0,FALSE),
+    KNOWN_SECTION(".debug_rnglists",de_debug_rnglists,FALSE,
+        DW_DLE_DEBUG_RNGLISTS_DUPLICATE,0,FALSE),
+    KNOWN_SECTION(".debug_rnglists.dwo",de_debug_rnglists,TRUE,
+        DW_DLE_DEBUG_RNGLISTS_DUPLICATE,0,FALSE),
+    KNOWN_SECTION(".debug_str_offsets",de_debug_str_offsets,FALSE,
+        DW_DLE_DEBUG_STR_OFFSETS_DUPLICATE,0,FALSE),
+    KNOWN_SECTION(".debug_str_offsets.dwo",de_debug_str_offsets,TRUE,
+        DW_DLE_DEBUG_STR_OFFSETS_DUPLICATE,0,FALSE),
+    KNOWN_SECTION(".debug_funcnames",de_debug_funcnames,FALSE,
+        DW_DLE_DEBUG_FUNCNAMES_DUPLICATE,0,FALSE),
+    KNOWN_SECTION(".debug_typenames",de_debug_typenames,FALSE,
+        DW_DLE_DEBUG_TYPENAMES_DUPLICATE,0,FALSE),
+    KNOWN_SECTION(".debug_varnames",de_debug_varnames,FALSE,
+        DW_DLE_DEBUG_VARNAMES_DUPLICATE,0,FALSE),
+    KNOWN_SECTION(".debug_weaknames",de_debug_weaknames,FALSE,
+        DW_DLE_DEBUG_WEAKNAMES_DUPLICATE,0,FALSE),
+    KNOWN_SECTION(".debug_macinfo",de_debug_macinfo,FALSE,
+        DW_DLE_DEBUG_MACINFO_DUPLICATE,0,TRUE),
+    KNOWN_SECTION(".debug_macro",de_debug_macro,FALSE,
+        DW_DLE_DEBUG_MACRO_DUPLICATE,0,TRUE),
+    KNOWN_SECTION(".debug_macro.dwo",de_debug_macro,TRUE,
+        DW_DLE_DEBUG_MACRO_DUPLICATE,0,TRUE),
+    KNOWN_SECTION(".debug_ranges",de_debug_ranges,FALSE,
+        DW_DLE_DEBUG_RANGES_DUPLICATE,0,TRUE),
+    KNOWN_SECTION(".debug_sup",de_debug_sup,FALSE,
+        DW_DLE_DEBUG_SUP_DUPLICATE,0,TRUE),
+    KNOWN_SECTION(".symtab",de_elf_symtab,FALSE,
+        DW_DLE_DEBUG_SYMTAB_ERR,0,FALSE),
+    KNOWN_SECTION(".strtab",de_elf_strtab,FALSE,
+        DW_DLE_DEBUG_STRTAB_ERR,0,FALSE),
+    KNOWN_SECTION(".debug_addr",de_debug_addr,FALSE,
+        DW_DLE_DEBUG_ADDR_DUPLICATE,0,TRUE),
+    KNOWN_SECTION(".gdb_index",de_debug_gdbindex,FALSE,
+        DW_DLE_DUPLICATE_GDB_INDEX,0,FALSE),
+    KNOWN_SECTION(".debug_cu_index",de_debug_cu_index,TRUE,
+        DW_DLE_DUPLICATE_CU_INDEX,0,FALSE),
+    KNOWN_SECTION(".debug_tu_index",de_debug_tu_index,TRUE,
+        DW_DLE_DUPLICATE_TU_INDEX,0,FALSE),
+};
+#undef KNOWN_SECTION
+
+/*  known_section_slot[known_section_hash(name)] is one plus
+    the index in known_sections[] of name, or zero.
+    The seed was chosen (by trying seeds) so that no two
+    names above share a slot: a perfect hash.  Adding
+    a name means finding a new seed and recomputing the slots:
+    build this file with -DTESTING (make test, or the
+    knownsections test with cmake) and run it with -g
+    to print both.  Run without -g it checks the table.  */
+#define KNOWN_SECTION_HASH_SEED 706
+#define KNOWN_SECTION_SLOTS 128
+static const unsigned char known_section_slot[KNOWN_SECTION_SLOTS] = {
+     0, 0, 0, 0, 8, 0, 0,19,23, 0,34, 0, 0, 0, 0, 0,
+     0,10, 0, 9, 0, 0, 0,26, 0,21, 0, 0, 0, 0,22, 0,
+     0, 0, 0,30, 0,31, 0, 0, 0, 0,33, 0, 5,14, 0,37,
+     0, 0, 0, 4, 0, 0, 0, 0, 0,18, 0, 0, 0,28, 0, 0,
+     0,24,29, 0, 0, 0,17, 0, 0, 0, 0, 0,27, 0,11, 0,
+     0, 0, 7,38, 0, 0, 0, 0, 0, 0, 0, 0,40, 3, 0,35,
+    32, 0, 0, 0, 0, 0, 2, 0, 0,13,12, 0, 0, 0,25,16,
+     0,36, 0, 0, 0, 0, 6,20, 0, 0,15, 0, 1, 0, 0,39,
+};
+
+static unsigned
+known_section_hash_seeded(const char *name, Dwarf_ufixed seed)
+{
+    Dwarf_ufixed v = seed;
+
+    for ( ; *name; ++name) {
+        v = (v ^ (unsigned char)*name) * 16777619;
+    }
+    return (v ^ (v >> 16)) & (KNOWN_SECTION_SLOTS-1);
+}
+
+static unsigned
+known_section_hash(const char *name)
+{
+    return known_section_hash_seeded(name,KNOWN_SECTION_HASH_SEED);
+}
+
+/*  Returns the known_sections[] entry for scn_name or NULL.
+    Sets *havezdebug if scn_name is the .zdebug_ version.  */
+static const struct Dwarf_Known_Section_s *
+known_section_lookup(const char *scn_name, int *havezdebug)
 {
-    /*  Here accomodate the .debug or .zdebug version, (and of
-        course non- .debug too, but those never zlib) .
-        SECNAMEMAX should be a little bigger than any section
+    /*  SECNAMEMAX should be a little bigger than any section
         name we care about as possibly compressed. */
     #define SECNAMEMAX 30
     char buildsecname[SECNAMEMAX];
-    unsigned secnamelen = strlen(secname);
     static const char *dprefix = ".debug_";
     static const char *zprefix = ".zdebug_";
-    int havezdebug = FALSE;
-    unsigned targnamelen = strlen(targname);
-    const char *finalname = targname;
-
-    if(secnamelen < SECNAMEMAX && strncmp(secname,zprefix,8) == 0) {
-        strcpy(buildsecname,zprefix);
-        /*  Now lets see if a targname updated with z matches
-            secname. */
-        /*  2 ensures NUL and added 'z' are ok */
-        if ((targnamelen+2) < SECNAMEMAX && strncmp(targname,dprefix,7) == 0 ){
-            strcat(buildsecname,targname+7);
-            /* We turned tarname .debug_info to .zdebug_info, for example. */
-            finalname = buildsecname;
-            if (strcmp(finalname,secname) == 0) {
-                havezdebug = TRUE;
-            }
+    const char *name = scn_name;
+    const struct Dwarf_Known_Section_s *ks = 0;
+    unsigned slot = 0;
+
+    *havezdebug = FALSE;
+    if (strncmp(scn_name,zprefix,8) == 0) {
+        /*  We turn .zdebug_info to .debug_info, for example. */
+        if ((strlen(scn_name)+1) >= SECNAMEMAX) {
+            return NULL;
         }
+        strcpy(buildsecname,dprefix);
+        strcat(buildsecname,scn_name+8);
+        name = buildsecname;
+        *havezdebug = TRUE;
     }
-
-    /* SETUP_SECTION. See also BUILDING_SECTIONS, BUILDING_MAP  */
-    if(!strcmp(secname,finalname)) {
-        /*  The section name is a match with targname, or
-            the .zdebug version of targname. */
-        int sectionerr = 0;
-
-        sectionerr = add_debug_section_info(dbg,secname,
-            obj_sec_num,
-            secdata,
-            groupnum_of_sec,
-            duperr,emptyerr, have_dwarf,
-            havezdebug,err);
-        if (sectionerr != DW_DLV_OK) {
-            /* *err is set already */
-            return sectionerr;
-        }
-        return DW_DLV_OK;
+    slot = known_section_slot[known_section_hash(name)];
+    if (!slot) {
+        return NULL;
     }
-    /*  This is not the target section.
-        our caller will keep looking. */
-    return DW_DLV_NO_ENTRY;
+    ks = &known_sections[slot-1];
+    if (strcmp(ks->ks_name,name)) {
+        return NULL;
+    }
+    return ks;
+    #undef SECNAMEMAX
 }
 
-#define SET_UP_SECTION(mdbg,mname,mtarg,mgrp,minfo,me1,me2,mdw,mer) \
-    {                                           \
-    int lerr = 0;                               \
-    lerr =  set_up_section(mdbg, mname,         \
-        /* scn_number from macro use context */ \
-        scn_number,mtarg,mgrp,                  \
-        minfo,                                  \
-        me1,me2,mdw,mer);                       \
-    if (lerr != DW_DLV_NO_ENTRY) {              \
-        return lerr;                            \
-    }    /* else fall through. */               \
-    }
-
-/*  If running this long set of tests is slow
-    enough to matter one could set up a local
-    tsearch tree with all this content and search
-    it instead of this set of sequential tests.
-    Or use a switch(){} here with a search tree
-    to to turn name into index for the switch(). */
 static int
 enter_section_in_de_debug_sections_array(Dwarf_Debug dbg,
     const char *scn_name,
@@ -403,265 +501,44 @@ enter_section_in_de_debug_sections_array(Dwarf_Debug dbg,
     unsigned group_number,
     int *err)
 {
-    /*  Setup the table that contains the basic information about the
-        sections that are DWARF related. The entries are very unlikely
-        to change very often. */
-    SET_UP_SECTION(dbg,scn_name,".debug_info",
-        group_number,
-        &dbg->de_debug_info,
-        DW_DLE_DEBUG_INFO_DUPLICATE,DW_DLE_DEBUG_INFO_NULL,
-        TRUE,err);
-    SET_UP_SECTION(dbg,scn_name,".debug_info.dwo",
-        DW_GROUPNUMBER_DWO,
-        &dbg->de_debug_info,
-        DW_DLE_DEBUG_INFO_DUPLICATE,DW_DLE_DEBUG_INFO_NULL,
-        TRUE,err);
-    SET_UP_SECTION(dbg,scn_name,".debug_types",
-        group_number,
-        &dbg->de_debug_types,
-        DW_DLE_DEBUG_TYPES_DUPLICATE,DW_DLE_DEBUG_TYPES_NULL,
-        TRUE,err);
-    SET_UP_SECTION(dbg,scn_name,".debug_types.dwo",
-        DW_GROUPNUMBER_DWO,
-        &dbg->de_debug_types,
-        DW_DLE_DEBUG_TYPES_DUPLICATE,DW_DLE_DEBUG_TYPES_NULL,
-        TRUE,err);
-    SET_UP_SECTION(dbg,scn_name,".debug_abbrev",
-        group_number,
-        &dbg->de_debug_abbrev, /*03*/
-        DW_DLE_DEBUG_ABBREV_DUPLICATE,DW_DLE_DEBUG_ABBREV_NULL,
-        TRUE,err);
-    SET_UP_SECTION(dbg,scn_name,".debug_abbrev.dwo",
-        DW_GROUPNUMBER_DWO,
-        &dbg->de_debug_abbrev, /*03*/
-        DW_DLE_DEBUG_ABBREV_DUPLICATE,DW_DLE_DEBUG_ABBREV_NULL,
-        TRUE,err);
-    SET_UP_SECTION(dbg,scn_name,".debug_aranges",
-        group_number,
-        &dbg->de_debug_aranges,
-        DW_DLE_DEBUG_ARANGES_DUPLICATE,0,
-        FALSE,err);
-    SET_UP_SECTION(dbg,scn_name,".debug_line",
-        group_number,
-        &dbg->de_debug_line,
-        DW_DLE_DEBUG_LINE_DUPLICATE,0,
-        TRUE,err);
-    /* DWARF5 */
-    SET_UP_SECTION(dbg,scn_name,".debug_line_str",
-        group_number,
-        &dbg->de_debug_line_str,
-        DW_DLE_DEBUG_LINE_DUPLICATE,0,
-        FALSE,err);
-    SET_UP_SECTION(dbg,scn_name,".debug_line.dwo",
-        DW_GROUPNUMBER_DWO,
-        &dbg->de_debug_line,
-        DW_DLE_DEBUG_LINE_DUPLICATE,0,
-        TRUE,err);
-    SET_UP_SECTION(dbg,scn_name,".debug_frame",
-        group_number,
-        &dbg->de_debug_frame,
-        DW_DLE_DEBUG_FRAME_DUPLICATE,0,
-        TRUE,err);
-    /* gnu egcs-1.1.2 data */
-    SET_UP_SECTION(dbg,scn_name,".eh_frame",
-        group_number,
-        &dbg->de_debug_frame_eh_gnu,
-        DW_DLE_DEBUG_FRAME_DUPLICATE,0,
-        TRUE,err);
-    SET_UP_SECTION(dbg,scn_name,".debug_loc",
-        group_number,
-        &dbg->de_debug_loc,
-        DW_DLE_DEBUG_LOC_DUPLICATE,0,
-        FALSE,err);
-    SET_UP_SECTION(dbg,scn_name,".debug_loc.dwo",
-        DW_GROUPNUMBER_DWO,
-        &dbg->de_debug_loc,
-        DW_DLE_DEBUG_LOC_DUPLICATE,0,
-        FALSE,err);
-    SET_UP_SECTION(dbg,scn_name,".debug_pubnames",
-        group_number,
-        &dbg->de_debug_pubnames,
-        DW_DLE_DEBUG_PUBNAMES_DUPLICATE,0,
-        FALSE,err);
-    SET_UP_SECTION(dbg,scn_name,".debug_str",
-        group_number,
-        &dbg->de_debug_str,
-        DW_DLE_DEBUG_STR_DUPLICATE,0,
-        FALSE,err);
-    SET_UP_SECTION(dbg,scn_name,".debug_str.dwo",
-        DW_GROUPNUMBER_DWO,
-        &dbg->de_debug_str,
-        DW_DLE_DEBUG_STR_DUPLICATE,0,
-        FALSE,err);
-    /* Section new in DWARF3.  */
-    SET_UP_SECTION(dbg,scn_name,".debug_pubtypes",
-        group_number,
-        &dbg->de_debug_pubtypes,
-        /*13*/ DW_DLE_DEBUG_PUBTYPES_DUPLICATE,0,
-        FALSE,err);
-    /* DWARF5 */
-    SET_UP_SECTION(dbg,scn_name,".debug_names",
-        group_number,
-        &dbg->de_debug_names,
-        /*13*/ DW_DLE_DEBUG_NAMES_DUPLICATE,0,
-        FALSE,err);
-    /* DWARF5 */
-    SET_UP_SECTION(dbg,scn_name,".debug_loclists",
-        group_number,
-        &dbg->de_debug_loclists,
-        /*13*/ DW_DLE_DEBUG_LOClISTS_DUPLICATE,0,
-        FALSE,err);
-    /* DWARF5 */
-    SET_UP_SECTION(dbg,scn_name,".debug_loclists.dwo",
-        DW_GROUPNUMBER_DWO,
-        &dbg->de_debug_loclists,
-        /*13*/ DW_DLE_DEBUG_LOClISTS_DUPLICATE,0,
-        FALSE,err);
-    /* DWARF5 */
-    SET_UP_SECTION(dbg,scn_name,".debug_rnglists",
-        group_number,
-        &dbg->de_debug_rnglists,
-        /*13*/ DW_DLE_DEBUG_RNGLISTS_DUPLICATE,0,
-        FALSE,err);
-    /* DWARF5 */
-    SET_UP_SECTION(dbg,scn_name,".debug_rnglists.dwo",
-        DW_GROUPNUMBER_DWO,
-        &dbg->de_debug_rnglists,
-        /*13*/ DW_DLE_DEBUG_RNGLISTS_DUPLICATE,0,
-        FALSE,err);
-    /* DWARF5 */
-    SET_UP_SECTION(dbg,scn_name,".debug_str_offsets",
-        group_number,
-        &dbg->de_debug_str_offsets,
-        DW_DLE_DEBUG_STR_OFFSETS_DUPLICATE,0,
-        FALSE,err);
-    /* DWARF5 */
-    SET_UP_SECTION(dbg,scn_name,".debug_str_offsets.dwo",
-        DW_GROUPNUMBER_DWO,
-        &dbg->de_debug_str_offsets,
-        DW_DLE_DEBUG_STR_OFFSETS_DUPLICATE,0,
-        FALSE,err);
-
-    /* SGI IRIX-only. */
-    SET_UP_SECTION(dbg,scn_name,".debug_funcnames",
-        group_number,
-        &dbg->de_debug_funcnames,
-        /*11*/ DW_DLE_DEBUG_FUNCNAMES_DUPLICATE,0,
-        FALSE,err);
-    /*  SGI IRIX-only, created years before DWARF3. Content
-        essentially identical to .debug_pubtypes.  */
-    SET_UP_SECTION(dbg,scn_name,".debug_typenames",
-        group_number,
-        &dbg->de_debug_typenames,
-        /*12*/ DW_DLE_DEBUG_TYPENAMES_DUPLICATE,0,
-        FALSE,err);
-    /* SGI IRIX-only.  */
-    SET_UP_SECTION(dbg,scn_name,".debug_varnames",
-        group_number,
-        &dbg->de_debug_varnames,
-        DW_DLE_DEBUG_VARNAMES_DUPLICATE,0,
-        FALSE,err);
-    /* SGI IRIX-only. */
-    SET_UP_SECTION(dbg,scn_name,".debug_weaknames",
-        group_number,
-        &dbg->de_debug_weaknames,
-        DW_DLE_DEBUG_WEAKNAMES_DUPLICATE,0,
-        FALSE,err);
-
-    SET_UP_SECTION(dbg,scn_name,".debug_macinfo",
-        group_number,
-        &dbg->de_debug_macinfo,
-        DW_DLE_DEBUG_MACINFO_DUPLICATE,0,
-        TRUE,err);
-    /*  ".debug_macinfo.dwo" is not allowed.  */
-
-
-    /* DWARF5 */
-    SET_UP_SECTION(dbg,scn_name,".debug_macro",
-        group_number,
-        &dbg->de_debug_macro,
-        DW_DLE_DEBUG_MACRO_DUPLICATE,0,
-        TRUE,err);
-    /* DWARF5 */
-    SET_UP_SECTION(dbg,scn_name,".debug_macro.dwo",
-        DW_GROUPNUMBER_DWO,
-        &dbg->de_debug_macro,
-        DW_DLE_DEBUG_MACRO_DUPLICATE,0,
-        TRUE,err);
-    SET_UP_SECTION(dbg,scn_name,".debug_ranges",
-        group_number,
-        &dbg->de_debug_ranges,
-        DW_DLE_DEBUG_RANGES_DUPLICATE,0,
-        TRUE,err);
-    /*  No .debug_ranges.dwo allowed. */
-
-    /* New DWARF5 */
-    SET_UP_SECTION(dbg,scn_name,".debug_sup",
-        group_number,
-        &dbg->de_debug_sup,
-        DW_DLE_DEBUG_SUP_DUPLICATE,0,
-        TRUE,err);
-    /* No .debug_sup.dwo allowed. */
-
-    /*  .symtab and .strtab have to be in any group.  */
-    SET_UP_SECTION(dbg,scn_name,".symtab",
-        group_number,
-        &dbg->de_elf_symtab,
-        DW_DLE_DEBUG_SYMTAB_ERR,0,
-        FALSE,err);
-    SET_UP_SECTION(dbg,scn_name,".strtab",
-        group_number,
-        &dbg->de_elf_strtab,
-        DW_DLE_DEBUG_STRTAB_ERR,0,
-        FALSE,err);
-
-    /* New DWARF5 */
-    SET_UP_SECTION(dbg,scn_name,".debug_addr",
-        group_number,
-        &dbg->de_debug_addr,
-        DW_DLE_DEBUG_ADDR_DUPLICATE,0,
-        TRUE,err);
-    /*  No .debug_addr.dwo allowed.  */
-
-    /* gdb added this. */
-    SET_UP_SECTION(dbg,scn_name,".gdb_index",
-        group_number,
-        &dbg->de_debug_gdbindex,
-        DW_DLE_DUPLICATE_GDB_INDEX,0,
-        FALSE,err);
-
-    /* New DWARF5 */
-    SET_UP_SECTION(dbg,scn_name,".debug_names",
-        group_number,
-        &dbg->de_debug_names,
-        DW_DLE_DEBUG_NAMES_DUPLICATE,0,
-        FALSE,err);
-    /* No .debug_names.dwo allowed. */
-
-    /* gdb added this in DW4. It is in standard DWARF5  */
-    SET_UP_SECTION(dbg,scn_name,".debug_cu_index",
-        DW_GROUPNUMBER_DWO,
-        &dbg->de_debug_cu_index,
-        DW_DLE_DUPLICATE_CU_INDEX,0,
-        FALSE,err);
-    /* gdb added this in DW4. It is in standard DWARF5 */
-    SET_UP_SECTION(dbg,scn_name,".debug_tu_index",
-        DW_GROUPNUMBER_DWO,
-        &dbg->de_debug_tu_index,
-        DW_DLE_DUPLICATE_TU_INDEX,0,
-        FALSE,err);
-    return DW_DLV_NO_ENTRY;
+    const struct Dwarf_Known_Section_s *ks = 0;
+    struct Dwarf_Section_s *secdata = 0;
+    int havezdebug = FALSE;
+
+    /* SETUP_SECTION. See also BUILDING_SECTIONS, BUILDING_MAP  */
+    ks = known_section_lookup(scn_name,&havezdebug);
+    if (!ks) {
+        /*  Not a section we set up (a .rela, for example). */
+        return DW_DLV_NO_ENTRY;
+    }
+    secdata = (struct Dwarf_Section_s *)
+        ((char *)dbg + ks->ks_secdata_offset);
+    return add_debug_section_info(dbg,scn_name,
+        scn_number,
+        secdata,
+        ks->ks_dwo_group? DW_GROUPNUMBER_DWO: group_number,
+        ks->ks_duperr,ks->ks_emptyerr,ks->ks_have_dwarf,
+        havezdebug,err);
 }
+
+/*  Only a name we set up can have been entered, and then
+    its secdata is in use under that very name.  */
 static int
 is_section_name_known_already(Dwarf_Debug dbg, const char *scn_name)
 {
-    unsigned i = 0;
-    for ( ; i < dbg->de_debug_sections_total_entries; ++i) {
-        struct Dwarf_dbg_sect_s *section = &dbg->de_debug_sections[i];
-        if (!strcmp(scn_name, section->ds_name)) {
-            /*  The caller will declare this a duplicate, an error. */
-            return DW_DLV_OK;
-        }
+    const struct Dwarf_Known_Section_s *ks = 0;
+    struct Dwarf_Section_s *secdata = 0;
+    int havezdebug = FALSE;
+
+    ks = known_section_lookup(scn_name,&havezdebug);
+    if (!ks) {
+        return DW_DLV_NO_ENTRY;
+    }
+    secdata = (struct Dwarf_Section_s *)
+        ((char *)dbg + ks->ks_secdata_offset);
+    if (secdata->dss_is_in_use && !strcmp(scn_name,secdata->dss_name)) {
+        /*  The caller will declare this a duplicate, an error. */
+        return DW_DLV_OK;
     }
     /* This is normal, we expect we've not accepted scn_name already. */
     return DW_DLV_NO_ENTRY;
@@ -1672,6 +1549,8 @@ _dwarf_load_section(Dwarf_Debug dbg,
             no DWARF related section could possbly be bss. */
         return res;
     }
+    dbg->de_stats.ds_sections_loaded++;
+    dbg->de_stats.ds_section_bytes_loaded += section->dss_size;
     if (section->dss_requires_decompress) {
         if (!section->dss_data) {
             /*  Impossible. This makes no sense.
@@ -1679,9 +1558,16 @@ _dwarf_load_section(Dwarf_Debug dbg,
             DWARF_DBG_ERROR(dbg, DW_DLE_COMPRESSED_EMPTY_SECTION, DW_DLV_ERROR);
         }
 #ifdef HAVE_ZLIB
-        res = do_decompress_zlib(dbg,section,error);
-        if (res != DW_DLV_OK) {
-            return res;
+        {
+            Dwarf_Unsigned compressed_size = section->dss_size;
+
+            res = do_decompress_zlib(dbg,section,error);
+            if (res != DW_DLV_OK) {
+                return res;
+            }
+            section->dss_compressed_size = compressed_size;
+            dbg->de_stats.ds_sections_decompressed++;
+            dbg->de_stats.ds_decompressed_bytes += section->dss_size;
         }
 #else
         DWARF_DBG_ERROR(dbg,DW_DLE_ZDEBUG_REQUIRES_ZLIB, DW_DLV_ERROR);
@@ -1702,6 +1588,12 @@ _dwarf_load_section(Dwarf_Debug dbg,
     if (res == DW_DLV_ERROR) {
         DWARF_DBG_ERROR(dbg, err, DW_DLV_ERROR);
     }
+    if (res == DW_DLV_OK && section->dss_reloc_entrysize) {
+        section->dss_relocations_applied =
+            section->dss_reloc_size/section->dss_reloc_entrysize;
+        dbg->de_stats.ds_relocations_applied +=
+            section->dss_relocations_applied;
+    }
     return res;
 }
 
@@ -1858,6 +1750,78 @@ dwarf_get_section_max_offsets_d(Dwarf_Debug dbg,
     return DW_DLV_OK;
 }
 
+/*  Given a DWARF section name, get its bytes as the
+    rest of libdwarf sees them.  New 2018. */
+int
+dwarf_get_section_data_by_name(Dwarf_Debug dbg,
+    const char *section_name,
+    const Dwarf_Small **section_data,
+    Dwarf_Unsigned *section_size,
+    Dwarf_Error * error)
+{
+    unsigned i = 0;
+
+    *section_data = 0;
+    *section_size = 0;
+    for (i = 0; i < dbg->de_debug_sections_total_entries; ++i) {
+        struct Dwarf_Section_s *sec =
+            dbg->de_debug_sections[i].ds_secdata;
+        int res = 0;
+
+        if (!sec || !sec->dss_name ||
+            strcmp(section_name,sec->dss_name)) {
+            continue;
+        }
+        if (!sec->dss_size) {
+            return DW_DLV_NO_ENTRY;
+        }
+        res = _dwarf_load_section(dbg,sec,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        *section_data = sec->dss_data;
+        *section_size = sec->dss_size;
+        return DW_DLV_OK;
+    }
+    return DW_DLV_NO_ENTRY;
+}
+
+/*  What _dwarf_load_section() did for the named section.
+    Returns DW_DLV_NO_ENTRY if there is no such section
+    or it has not been loaded.  New 2018. */
+int
+dwarf_get_section_load_stats(Dwarf_Debug dbg,
+    const char *section_name,
+    Dwarf_Unsigned *loaded_bytes,
+    Dwarf_Unsigned *compressed_bytes,
+    Dwarf_Unsigned *relocations,
+    Dwarf_Error * error)
+{
+    unsigned i = 0;
+
+    if (dbg == NULL) {
+        _dwarf_error(NULL, error, DW_DLE_DBG_NULL);
+        return (DW_DLV_ERROR);
+    }
+    for (i = 0; i < dbg->de_debug_sections_total_entries; ++i) {
+        struct Dwarf_Section_s *sec =
+            dbg->de_debug_sections[i].ds_secdata;
+
+        if (!sec || !sec->dss_name ||
+            strcmp(section_name,sec->dss_name)) {
+            continue;
+        }
+        if (!sec->dss_data) {
+            return DW_DLV_NO_ENTRY;
+        }
+        *loaded_bytes = sec->dss_size;
+        *compressed_bytes = sec->dss_compressed_size;
+        *relocations = sec->dss_relocations_applied;
+        return DW_DLV_OK;
+    }
+    return DW_DLV_NO_ENTRY;
+}
+
 /*  Given a section name, get its size and address */
 int
 dwarf_get_section_info_by_name(Dwarf_Debug dbg,
@@ -1961,3 +1925,121 @@ dwarf_record_cmdline_options(Dwarf_Cmdline_Options options)
 {
     dwarf_cmdline_options = options;
 }
+
+#ifdef TESTING
+/*  Checks known_section_slot[] against known_sections[].
+    With -g finds the lowest seed giving no collisions and
+    prints KNOWN_SECTION_HASH_SEED and known_section_slot[]
+    to paste in above.  */
+#define KNOWN_SECTION_COUNT \
+    (sizeof(known_sections)/sizeof(known_sections[0]))
+
+static int
+known_section_generate(void)
+{
+    Dwarf_ufixed seed = 0;
+
+    if (KNOWN_SECTION_COUNT > 255 ||
+        KNOWN_SECTION_COUNT > KNOWN_SECTION_SLOTS/2) {
+        printf("FAIL too many names for KNOWN_SECTION_SLOTS %u\n",
+            (unsigned)KNOWN_SECTION_SLOTS);
+        return 1;
+    }
+    for (seed = 0; seed < 10000000; ++seed) {
+        unsigned char slots[KNOWN_SECTION_SLOTS];
+        unsigned i = 0;
+
+        memset(slots,0,sizeof(slots));
+        for (i = 0; i < KNOWN_SECTION_COUNT; ++i) {
+            unsigned h = known_section_hash_seeded(
+                known_sections[i].ks_name,seed);
+
+            if (slots[h]) {
+                break;
+            }
+            slots[h] = i+1;
+        }
+        if (i < KNOWN_SECTION_COUNT) {
+            continue;
+        }
+        printf("#define KNOWN_SECTION_HASH_SEED %lu\n",
+            (unsigned long)seed);
+        printf("#define KNOWN_SECTION_SLOTS %u\n",
+            (unsigned)KNOWN_SECTION_SLOTS);
+        printf("static const unsigned char "
+            "known_section_slot[KNOWN_SECTION_SLOTS] = {\n");
+        for (i = 0; i < KNOWN_SECTION_SLOTS; ++i) {
+            if (!(i%16)) {
+                printf("    ");
+            }
+            printf("%2u,",slots[i]);
+            if ((i%16) == 15) {
+                printf("\n");
+            }
+        }
+        printf("};\n");
+        return 0;
+    }
+    printf("FAIL no seed found, make KNOWN_SECTION_SLOTS larger\n");
+    return 1;
+}
+
+int
+main(int argc, char **argv)
+{
+    unsigned i = 0;
+    int errcnt = 0;
+
+    if (argc > 1 && !strcmp(argv[1],"-g")) {
+        return known_section_generate();
+    }
+    for (i = 0; i < KNOWN_SECTION_COUNT; ++i) {
+        const char *name = known_sections[i].ks_name;
+        unsigned h = known_section_hash(name);
+        int havezdebug = FALSE;
+
+        if (known_section_slot[h] != i+1) {
+            printf("FAIL %s hashes to slot %u holding %u, not %u:"
+                " run with -g\n",
+                name,h,known_section_slot[h],i+1);
+            ++errcnt;
+            continue;
+        }
+        if (known_section_lookup(name,&havezdebug) !=
+            &known_sections[i] || havezdebug) {
+            printf("FAIL lookup of %s\n",name);
+            ++errcnt;
+        }
+        if (!strncmp(name,".debug_",7)) {
+            char zname[40];
+
+            strcpy(zname,".zdebug_");
+            strcat(zname,name+7);
+            if (known_section_lookup(zname,&havezdebug) !=
+                &known_sections[i] || !havezdebug) {
+                printf("FAIL lookup of %s\n",zname);
+                ++errcnt;
+            }
+        }
+    }
+    for (i = 0; i < KNOWN_SECTION_SLOTS; ++i) {
+        unsigned slot = known_section_slot[i];
+
+        if (!slot) {
+            continue;
+        }
+        if (slot > KNOWN_SECTION_COUNT ||
+            known_section_hash(known_sections[slot-1].ks_name) != i) {
+            printf("FAIL slot %u holds %u, not a name hashing there\n",
+                i,slot);
+            ++errcnt;
+        }
+    }
+    if (errcnt) {
+        printf("FAIL known section hash table\n");
+        return 1;
+    }
+    printf("PASS known section hash table\n");
+    return 0;
+}
+#endif /* TESTING */
@@ -29,7 +29,10 @@
 #include "config.h"
 #include "dwarf_incl.h"
 #include <stdio.h>
+#include <string.h>
 #ifdef TESTING
+#include <stdlib.h>
+#include <time.h>
 #include "pro_encode_nm.h"
 #endif
 
@@ -49,6 +52,9 @@
 #define BYTESLEBMAX 10
 #define BITSPERBYTE 8
 
+#define TRUE  1
+#define FALSE 0
+
 
 /* Decode ULEB with checking */
 int
@@ -196,6 +202,276 @@ _dwarf_decode_s_leb128_chk(Dwarf_Small * leb128, Dwarf_Word * leb128_length,
     return DW_DLV_OK;
 }
 
+/*  Bulk decoding.
+    Sections such as .debug_abbrev are long runs of LEB128
+    values. Rather than test each byte for its continuation
+    bit, the decoders below take the high bit of every byte
+    of a 32 (AVX2), 16 (SSE2) or 8 (any little-endian host)
+    byte window at once. Each clear bit ends a value, and
+    every value wholly inside the window and no longer than
+    8 bytes is assembled without a per-byte loop. Anything
+    else, including values near the end of the data and
+    all values on big-endian hosts, goes through
+    _dwarf_decode_u_leb128_chk() or
+    _dwarf_decode_s_leb128_chk(), so the results and the
+    errors are exactly theirs. */
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#define LEB_WORDSIZE 8
+
+static unsigned
+leb_ctz(Dwarf_Unsigned v)
+{
+#if defined(__GNUC__)
+    return (unsigned)__builtin_ctzll(v);
+#else
+    unsigned n = 0;
+
+    while (!(v & 1)) {
+        v >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+#ifndef WORDS_BIGENDIAN
+/*  Masks keeping the low len bytes of a word. */
+static const Dwarf_Unsigned leb_len_mask[LEB_WORDSIZE+1] = {
+    0,
+    0xffULL,
+    0xffffULL,
+    0xffffffULL,
+    0xffffffffULL,
+    0xffffffffffULL,
+    0xffffffffffffULL,
+    0xffffffffffffffULL,
+    0xffffffffffffffffULL };
+
+/*  The len (1 to 8) bytes of a LEB128 value
+    starting at p, p[0] in the low byte. */
+static Dwarf_Unsigned
+leb_load_bytes(Dwarf_Small *p, unsigned len, Dwarf_Small *endptr)
+{
+    Dwarf_Unsigned w = 0;
+
+    if ((endptr - p) >= LEB_WORDSIZE) {
+        memcpy(&w,p,LEB_WORDSIZE);
+        return w & leb_len_mask[len];
+    }
+    memcpy(&w,p,len);
+    return w;
+}
+
+/*  Squeezes the 7 value bits of each of the 8 bytes
+    of w together: a branch-free decode of a LEB128 value
+    of at most 8 bytes. */
+static Dwarf_Unsigned
+leb_compress7(Dwarf_Unsigned w)
+{
+    Dwarf_Unsigned x = w & 0x7f7f7f7f7f7f7f7fULL;
+
+    x = (x & 0x007f007f007f007fULL) |
+        ((x & 0x7f007f007f007f00ULL) >> 1);
+    x = (x & 0x00003fff00003fffULL) |
+        ((x & 0x3fff00003fff0000ULL) >> 2);
+    x = (x & 0x000000000fffffffULL) |
+        ((x & 0x0fffffff00000000ULL) >> 4);
+    return x;
+}
+
+/*  Sets *mask to have bit (k << *bshift) set
+    iff byte k of the window at p ends a LEB128 value.
+    Leaves *mask zero if p is too near endptr. */
+static void
+leb_window_mask(Dwarf_Small *p, Dwarf_Small *endptr,
+    Dwarf_Unsigned *mask, unsigned *bshift)
+{
+    Dwarf_Unsigned avail = endptr - p;
+
+#if defined(__AVX2__)
+    if (avail >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)p);
+
+        *mask = ~(Dwarf_Unsigned)(unsigned)_mm256_movemask_epi8(v) &
+            0xffffffffULL;
+        *bshift = 0;
+        return;
+    }
+#endif
+#if defined(__SSE2__)
+    if (avail >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+
+        *mask = ~(Dwarf_Unsigned)(unsigned)_mm_movemask_epi8(v) &
+            0xffffULL;
+        *bshift = 0;
+        return;
+    }
+#endif
+    if (avail >= LEB_WORDSIZE) {
+        Dwarf_Unsigned w = 0;
+
+        memcpy(&w,p,LEB_WORDSIZE);
+        /*  Bit 7 of byte k is set iff that byte is last. */
+        *mask = ~w & 0x8080808080808080ULL;
+        *bshift = 3;
+    }
+}
+#endif /* WORDS_BIGENDIAN */
+
+/*  Decodes one value the careful way. */
+static int
+leb_decode_one(Dwarf_Small *p, Dwarf_Small *endptr,
+    int is_signed, Dwarf_Unsigned *outval, Dwarf_Word *len)
+{
+    if (is_signed) {
+        Dwarf_Signed sval = 0;
+        int res = _dwarf_decode_s_leb128_chk(p,len,&sval,endptr);
+
+        *outval = (Dwarf_Unsigned)sval;
+        return res;
+    }
+    return _dwarf_decode_u_leb128_chk(p,len,outval,endptr);
+}
+
+/*  The common body of the bulk decoders.
+    With pairs non-zero values are taken two at a time
+    and decoding stops after a pair in which either value
+    is zero (the end of a .debug_abbrev attribute list):
+    DW_DLV_NO_ENTRY is returned if count values are
+    decoded without finding one. */
+static int
+leb_decode_run(Dwarf_Small *leb128, Dwarf_Byte_Ptr endptr,
+    int is_signed, int pairs,
+    Dwarf_Unsigned *outvals, Dwarf_Unsigned count,
+    Dwarf_Unsigned *count_out, Dwarf_Word *leb128_length)
+{
+    Dwarf_Small *p = leb128;
+    Dwarf_Unsigned n = 0;
+
+    if (pairs) {
+        /*  Only whole pairs. */
+        count &= ~(Dwarf_Unsigned)1;
+    }
+    while (n < count) {
+        Dwarf_Word len = 0;
+        int res = 0;
+#ifndef WORDS_BIGENDIAN
+        Dwarf_Unsigned startn = n;
+        unsigned start = 0;
+        Dwarf_Unsigned mask = 0;
+        unsigned bshift = 0;
+
+        leb_window_mask(p,endptr,&mask,&bshift);
+
+        while (mask && n < count) {
+            unsigned last = leb_ctz(mask) >> bshift;
+            unsigned vlen = last - start + 1;
+            Dwarf_Unsigned v = 0;
+
+            if (vlen > LEB_WORDSIZE) {
+                break;
+            }
+            v = leb_compress7(leb_load_bytes(p+start,vlen,endptr));
+            if (is_signed) {
+                /*  Copy the sign bit (bit 6 of the last byte)
+                    to all the higher bits. */
+                Dwarf_Unsigned sign = (v >> (vlen*7 - 1)) & 1;
+
+                v |= (0 - sign) << (vlen*7);
+            }
+            outvals[n++] = v;
+            start = last + 1;
+            mask &= mask - 1;
+            if (pairs && !(n & 1) && (!outvals[n-2] || !v)) {
+                *count_out = n;
+                *leb128_length = (p + start) - leb128;
+                return DW_DLV_OK;
+            }
+        }
+        p += start;
+        if (n != startn) {
+            continue;
+        }
+#endif /* WORDS_BIGENDIAN */
+        /*  No short value ends in the window. */
+        res = leb_decode_one(p,endptr,is_signed,outvals+n,&len);
+        if (res != DW_DLV_OK) {
+            *count_out = n;
+            *leb128_length = p - leb128;
+            return DW_DLV_ERROR;
+        }
+        p += len;
+        n++;
+        if (pairs && !(n & 1) && (!outvals[n-2] || !outvals[n-1])) {
+            *count_out = n;
+            *leb128_length = p - leb128;
+            return DW_DLV_OK;
+        }
+    }
+    *count_out = n;
+    *leb128_length = p - leb128;
+    if (pairs) {
+        return DW_DLV_NO_ENTRY;
+    }
+    return DW_DLV_OK;
+}
+
+/*  Decodes count unsigned LEB128 values into outvals.
+    Returns DW_DLV_OK with *leb128_length the number of
+    bytes used, or DW_DLV_ERROR (as
+    _dwarf_decode_u_leb128_chk() would) if the data is
+    too short or a value is improper. */
+int
+_dwarf_decode_u_leb128_bulk(Dwarf_Small * leb128,
+    Dwarf_Byte_Ptr endptr,
+    Dwarf_Unsigned *outvals,
+    Dwarf_Unsigned count,
+    Dwarf_Word * leb128_length)
+{
+    Dwarf_Unsigned done = 0;
+
+    return leb_decode_run(leb128,endptr,FALSE,FALSE,
+        outvals,count,&done,leb128_length);
+}
+
+/*  As _dwarf_decode_u_leb128_bulk() for signed values. */
+int
+_dwarf_decode_s_leb128_bulk(Dwarf_Small * leb128,
+    Dwarf_Byte_Ptr endptr,
+    Dwarf_Signed *outvals,
+    Dwarf_Unsigned count,
+    Dwarf_Word * leb128_length)
+{
+    Dwarf_Unsigned done = 0;
+
+    return leb_decode_run(leb128,endptr,TRUE,FALSE,
+        (Dwarf_Unsigned *)outvals,count,&done,leb128_length);
+}
+
+/*  Decodes unsigned LEB128 values two at a time into
+    outvals (room for maxvals) until a pair in which
+    either value is zero, as ends an attribute list in
+    .debug_abbrev. Returns DW_DLV_OK when that pair is
+    found, DW_DLV_NO_ENTRY if outvals filled first (call
+    again past *leb128_length for the rest), or
+    DW_DLV_ERROR. *count_out is the number of values
+    decoded, including the terminating pair. */
+int
+_dwarf_decode_u_leb128_pairs(Dwarf_Small * leb128,
+    Dwarf_Byte_Ptr endptr,
+    Dwarf_Unsigned *outvals,
+    Dwarf_Unsigned maxvals,
+    Dwarf_Unsigned *count_out,
+    Dwarf_Word * leb128_length)
+{
+    return leb_decode_run(leb128,endptr,FALSE,TRUE,
+        outvals,maxvals,count_out,leb128_length);
+}
+
 #ifdef TESTING
 
 static void
@@ -459,7 +735,7 @@ specialtests(void)
         printf("FAIL signed decode special v3 \n");
         ++errcnt;
     }
-    if (decodeval != 0x8000000000000000) {
+    if (decodeval != (Dwarf_Signed)0x8000000000000000) {
         printf("FAIL signed decode special v3 value check %lld vs %lld \n",
             decodeval,(Dwarf_Signed)0x8000000000000000);
         ++errcnt;
@@ -488,12 +764,238 @@ specialtests(void)
     return errcnt;
 }
 
-int main(void)
+/*  A stream of LEB128 values of mixed lengths, mostly
+    short as real DWARF is, from a simple linear
+    congruential generator so runs are repeatable. */
+#define BULKVALS 100000
+static Dwarf_Unsigned bulk_uvals[BULKVALS];
+static Dwarf_Signed bulk_svals[BULKVALS];
+static Dwarf_Unsigned bulk_out[BULKVALS];
+static char bulk_ubuf[BULKVALS*BYTESLEBMAX];
+static char bulk_sbuf[BULKVALS*BYTESLEBMAX];
+static unsigned bulk_ulen;
+static unsigned bulk_slen;
+
+static Dwarf_Unsigned
+bulk_random(void)
+{
+    static Dwarf_Unsigned seed = 1;
+
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return seed;
+}
+
+static unsigned
+bulk_fill(void)
+{
+    unsigned errcnt = 0;
+    unsigned i = 0;
+
+    bulk_ulen = 0;
+    bulk_slen = 0;
+    for (i = 0; i < BULKVALS; ++i) {
+        Dwarf_Unsigned r = bulk_random();
+        unsigned sel = (r >> 56) & 0xff;
+        Dwarf_Unsigned v = bulk_random();
+        int len = 0;
+        int res = 0;
+
+        /*  About 3/4 one byte, most of the rest two. */
+        if (sel < 192) {
+            v &= 0x7f;
+        } else if (sel < 240) {
+            v &= 0x3fff;
+        } else if (sel < 252) {
+            v >>= (sel & 7) * 8;
+        }
+        bulk_uvals[i] = v;
+        bulk_svals[i] = (sel & 1)? -(Dwarf_Signed)(v >> 1):
+            (Dwarf_Signed)(v >> 1);
+        res = _dwarf_pro_encode_leb128_nm(v,&len,
+            bulk_ubuf+bulk_ulen,BYTESLEBMAX);
+        if (res != DW_DLV_OK) {
+            ++errcnt;
+        }
+        bulk_ulen += len;
+        res = _dwarf_pro_encode_signed_leb128_nm(bulk_svals[i],&len,
+            bulk_sbuf+bulk_slen,BYTESLEBMAX);
+        if (res != DW_DLV_OK) {
+            ++errcnt;
+        }
+        bulk_slen += len;
+    }
+    return errcnt;
+}
+
+/*  The bulk decoders must agree exactly with
+    the one-at-a-time decoders. */
+static unsigned
+bulktests(void)
+{
+    unsigned errcnt = bulk_fill();
+    Dwarf_Word used = 0;
+    Dwarf_Unsigned nvals = 0;
+    Dwarf_Unsigned pairvals[8];
+    Dwarf_Small *ub = (Dwarf_Small *)bulk_ubuf;
+    Dwarf_Small *sb = (Dwarf_Small *)bulk_sbuf;
+    unsigned i = 0;
+    int res = 0;
+    /*  (3,0x1ff) (0x80,0) then stray bytes. */
+    static unsigned char pairs[] = {
+        0x03, 0xff, 0x03, 0x80, 0x01, 0x00, 0x7f, 0x7f };
+
+    res = _dwarf_decode_u_leb128_bulk(ub,ub+bulk_ulen,
+        bulk_out,BULKVALS,&used);
+    if (res != DW_DLV_OK || used != bulk_ulen) {
+        printf("FAIL unsigned bulk decode\n");
+        ++errcnt;
+    }
+    for (i = 0; i < BULKVALS; ++i) {
+        if (bulk_out[i] != bulk_uvals[i]) {
+            printf("FAIL unsigned bulk decode val index %u "
+                "0x%llx vs 0x%llx\n",i,bulk_out[i],bulk_uvals[i]);
+            ++errcnt;
+            break;
+        }
+    }
+    res = _dwarf_decode_s_leb128_bulk(sb,sb+bulk_slen,
+        (Dwarf_Signed *)bulk_out,BULKVALS,&used);
+    if (res != DW_DLV_OK || used != bulk_slen) {
+        printf("FAIL signed bulk decode\n");
+        ++errcnt;
+    }
+    for (i = 0; i < BULKVALS; ++i) {
+        if ((Dwarf_Signed)bulk_out[i] != bulk_svals[i]) {
+            printf("FAIL signed bulk decode val index %u "
+                "0x%llx vs 0x%llx\n",i,bulk_out[i],bulk_svals[i]);
+            ++errcnt;
+            break;
+        }
+    }
+    /*  Truncated data is an error, as for one value. */
+    res = _dwarf_decode_u_leb128_bulk(ub,ub+bulk_ulen-1,
+        bulk_out,BULKVALS,&used);
+    if (res != DW_DLV_ERROR) {
+        printf("FAIL unsigned bulk decode truncated\n");
+        ++errcnt;
+    }
+    res = _dwarf_decode_u_leb128_bulk((Dwarf_Small *)v1,
+        (Dwarf_Small *)v1+sizeof(v1),bulk_out,1,&used);
+    if (res != DW_DLV_ERROR) {
+        printf("FAIL unsigned bulk decode special v1\n");
+        ++errcnt;
+    }
+    res = _dwarf_decode_u_leb128_pairs(pairs,pairs+sizeof(pairs),
+        pairvals,8,&nvals,&used);
+    if (res != DW_DLV_OK || nvals != 4 || used != 6 ||
+        pairvals[1] != 0x1ff || pairvals[2] != 0x80) {
+        printf("FAIL pairs decode\n");
+        ++errcnt;
+    }
+    res = _dwarf_decode_u_leb128_pairs(pairs,pairs+sizeof(pairs),
+        pairvals,2,&nvals,&used);
+    if (res != DW_DLV_NO_ENTRY || nvals != 2 || used != 3) {
+        printf("FAIL pairs decode partial\n");
+        ++errcnt;
+    }
+    return errcnt;
+}
+
+/*  dwarfleb -b [rounds]
+    Times decoding the bulk_fill() stream one value at a
+    time (as DECODE_LEB128_UWORD_CK does) against the
+    bulk decoders. */
+static int
+benchmark(unsigned rounds)
+{
+    unsigned r = 0;
+    clock_t t = 0;
+    Dwarf_Unsigned sum = 0;
+    Dwarf_Small *ub = (Dwarf_Small *)bulk_ubuf;
+    Dwarf_Small *sb = (Dwarf_Small *)bulk_sbuf;
+    double mb = 0;
+
+    if (bulk_fill()) {
+        printf("FAIL benchmark setup\n");
+        return 1;
+    }
+    mb = (double)bulk_ulen * rounds / (1024.0*1024.0);
+    t = clock();
+    for (r = 0; r < rounds; ++r) {
+        Dwarf_Small *p = ub;
+        unsigned i = 0;
+
+        for (i = 0; i < BULKVALS; ++i) {
+            Dwarf_Word len = 0;
+
+            _dwarf_decode_u_leb128_chk(p,&len,bulk_out+i,ub+bulk_ulen);
+            p += len;
+        }
+        sum += bulk_out[r % BULKVALS];
+    }
+    t = clock() - t;
+    printf("unsigned one at a time: %8.1f MB/s\n",
+        mb / ((double)t / CLOCKS_PER_SEC));
+    t = clock();
+    for (r = 0; r < rounds; ++r) {
+        Dwarf_Word used = 0;
+
+        _dwarf_decode_u_leb128_bulk(ub,ub+bulk_ulen,
+            bulk_out,BULKVALS,&used);
+        sum += bulk_out[r % BULKVALS];
+    }
+    t = clock() - t;
+    printf("unsigned bulk:          %8.1f MB/s\n",
+        mb / ((double)t / CLOCKS_PER_SEC));
+
+    mb = (double)bulk_slen * rounds / (1024.0*1024.0);
+    t = clock();
+    for (r = 0; r < rounds; ++r) {
+        Dwarf_Small *p = sb;
+        unsigned i = 0;
+
+        for (i = 0; i < BULKVALS; ++i) {
+            Dwarf_Word len = 0;
+
+            _dwarf_decode_s_leb128_chk(p,&len,
+                (Dwarf_Signed *)bulk_out+i,sb+bulk_slen);
+            p += len;
+        }
+        sum += bulk_out[r % BULKVALS];
+    }
+    t = clock() - t;
+    printf("signed one at a time:   %8.1f MB/s\n",
+        mb / ((double)t / CLOCKS_PER_SEC));
+    t = clock();
+    for (r = 0; r < rounds; ++r) {
+        Dwarf_Word used = 0;
+
+        _dwarf_decode_s_leb128_bulk(sb,sb+bulk_slen,
+            (Dwarf_Signed *)bulk_out,BULKVALS,&used);
+        sum += bulk_out[r % BULKVALS];
+    }
+    t = clock() - t;
+    printf("signed bulk:            %8.1f MB/s\n",
+        mb / ((double)t / CLOCKS_PER_SEC));
+    /* Keeps the loops from being optimized away. */
+    printf("(checksum 0x%llx)\n",sum);
+    return 0;
+}
+
+int main(int argc, char **argv)
 {
     unsigned slen = sizeof(stest)/sizeof(Dwarf_Signed);
     unsigned ulen = sizeof(utest)/sizeof(Dwarf_Unsigned);
     int errs = 0;
 
+    if (argc > 1 && !strcmp(argv[1],"-b")) {
+        unsigned rounds = 200;
+
+        if (argc > 2) {
+            rounds = (unsigned)atoi(argv[2]);
+        }
+        return benchmark(rounds? rounds : 1);
+    }
     printinteresting();
     errs += signedtest(slen);
 
@@ -501,6 +1003,8 @@ int main(void)
 
     errs += specialtests();
 
+    errs += bulktests();
+
     if (errs) {
         printf("FAIL. leb encode/decode errors\n");
         return 1;
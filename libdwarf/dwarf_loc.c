@@ -29,6 +29,7 @@
 #include "dwarf_incl.h"
 #include "dwarf_loc.h"
 #include <stdio.h> /* for debugging only. */
+#include <stdlib.h> /* For realloc(), free() */
 
 #define TRUE 1
 #define FALSE 0
@@ -98,7 +99,7 @@ read_encoded_addr(Dwarf_Small *loc_ptr,
     extract operator fields. For any
     DWARF version.
 */
-static int
+int
 _dwarf_read_loc_expr_op(Dwarf_Debug dbg,
     Dwarf_Block_c * loc_block,
     /* Caller: Start numbering at 0. */
@@ -147,3 +147,71 @@ struct Dwarf_Loc_Head_c_s {
 int _dwarf_loc_block_sanity_check(Dwarf_Debug dbg,
     Dwarf_Block_c *loc_block,Dwarf_Error*error);
 
+int _dwarf_loclists_read_entry(Dwarf_CU_Context context,
+    Dwarf_Small **ptr_io,
+    Dwarf_Small *secend,
+    Dwarf_Addr *base_io,
+    Dwarf_Small *kind_out,
+    Dwarf_Addr *low_out,
+    Dwarf_Addr *high_out,
+    Dwarf_Small **expr_out,
+    Dwarf_Unsigned *exprlen_out,
+    Dwarf_Error *error);
+
+/*  Where the location of a variable is:
+    the same 0, 1, 2 as bl_from_loclist, and DWARF5 loclists. */
+#define LOC_SOURCE_EXPR      0 /* A location expression. */
+#define LOC_SOURCE_LOC       1 /* .debug_loc */
+#define LOC_SOURCE_LOC_DWO   2 /* .debug_loc.dwo */
+#define LOC_SOURCE_LOCLISTS  3 /* .debug_loclists */
+
+/*  One variable or parameter with a location,
+    as recorded by dwarf_get_variables_at_pc(). */
+struct Dwarf_Var_Loc_s {
+    Dwarf_Off      vl_die_offset;
+    Dwarf_Unsigned vl_list_offset; /* Unless LOC_SOURCE_EXPR. */
+    Dwarf_Small    vl_source;
+    /*  Innermost enclosing DW_TAG_lexical_block or
+        DW_TAG_inlined_subroutine, index+1 in vs_blocks,
+        0 if none. */
+    Dwarf_Unsigned vl_block;
+};
+
+/*  The pc ranges of a scope inside the subprogram.
+    A variable located by a single expression is only
+    live where all its enclosing scopes are. */
+struct Dwarf_Var_Loc_Block_s {
+    Dwarf_Unsigned vk_parent;      /* As vl_block. */
+    Dwarf_Unsigned vk_range_first; /* Index in vs_ranges. */
+    Dwarf_Unsigned vk_range_count; /* 0: no pc attributes. */
+};
+struct Dwarf_Var_Loc_Range_s {
+    Dwarf_Addr     vr_low;
+    Dwarf_Addr     vr_high;
+};
+
+/*  The variables and parameters of one subprogram. */
+struct Dwarf_Var_Loc_Set_s {
+    Dwarf_Off      vs_subprogram_offset;
+    struct Dwarf_Var_Loc_s *vs_vars;
+    Dwarf_Unsigned vs_count;
+    struct Dwarf_Var_Loc_Set_s *vs_next;
+    struct Dwarf_Var_Loc_Block_s *vs_blocks;
+    Dwarf_Unsigned vs_block_count;
+    struct Dwarf_Var_Loc_Range_s *vs_ranges;
+    Dwarf_Unsigned vs_range_count;
+};
+
+/*  Decodes the operator at startoffset of loc_block.
+    Also used by dwarf_expr_compile().  */
+int _dwarf_read_loc_expr_op(Dwarf_Debug dbg,
+    Dwarf_Block_c * loc_block,
+    Dwarf_Signed opnumber,
+    Dwarf_Half version_stamp,
+    Dwarf_Half offset_size,
+    Dwarf_Half address_size,
+    Dwarf_Signed startoffset_in,
+    Dwarf_Small *section_end,
+    Dwarf_Unsigned *nextoffset_out,
+    Dwarf_Loc_c curr_loc,
+    Dwarf_Error * error);
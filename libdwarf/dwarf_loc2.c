@@ -714,6 +714,894 @@ dwarf_get_loclist_c(Dwarf_Attribute attr,
     return (DW_DLV_OK);
 }
 
+/*  Which section, if any, holds the location list of attr,
+    and the offset of the list in it. */
+static int
+_dwarf_loc_attr_source(Dwarf_Attribute attr,
+    Dwarf_Small *source_out,
+    Dwarf_Unsigned *offset_out,
+    Dwarf_Error *error)
+{
+    Dwarf_Debug dbg = 0;
+    Dwarf_CU_Context cucontext = 0;
+    Dwarf_Half form = 0;
+    Dwarf_Unsigned offset = 0;
+    int cuvstamp = 0;
+    int res = 0;
+
+    res = _dwarf_setup_loc(attr, &dbg,&cucontext, &form, error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    cuvstamp = cucontext->cc_version_stamp;
+    if (cuvstamp >= DW_CU_VERSION5 &&
+        (form == DW_FORM_sec_offset || form == DW_FORM_loclistx)) {
+        Dwarf_Off listoff = 0;
+
+        res = dwarf_get_loclist_offset(attr,&listoff,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        *source_out = LOC_SOURCE_LOCLISTS;
+        *offset_out = listoff;
+        return DW_DLV_OK;
+    }
+    if (((cuvstamp == DW_CU_VERSION2 || cuvstamp == DW_CU_VERSION3) &&
+        (form == DW_FORM_data4 || form == DW_FORM_data8)) ||
+        (cuvstamp == DW_CU_VERSION4 && form == DW_FORM_sec_offset)) {
+        res = _dwarf_get_loclist_header_start(dbg,
+            attr, &offset, error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        *source_out = cucontext->cc_is_dwo?
+            LOC_SOURCE_LOC_DWO:LOC_SOURCE_LOC;
+        *offset_out = offset;
+        return DW_DLV_OK;
+    }
+    *source_out = LOC_SOURCE_EXPR;
+    *offset_out = 0;
+    return DW_DLV_OK;
+}
+
+/*  Finds the entry of the location list at offset that
+    covers pc by reading only the pc bounds and expression
+    length of each entry.  The expression of the entry found
+    is returned in *block_out, undecoded, with the final pc
+    range in *lowpc_out and *highpc_out.
+    For .debug_loclists bl_from_loclist is left zero, the
+    expression having been checked against that section here
+    (_dwarf_loc_block_sanity_check() knows only .debug_loc).
+    A DWARF5 DW_LLE_default_location applies when no bounded
+    entry does, and is returned with a range of the whole
+    address space. */
+static int
+_dwarf_loc_find_pc_in_list(Dwarf_CU_Context context,
+    Dwarf_Small source,
+    Dwarf_Unsigned offset,
+    Dwarf_Addr pc,
+    Dwarf_Block_c *block_out,
+    Dwarf_Addr *lowpc_out,
+    Dwarf_Addr *highpc_out,
+    Dwarf_Error *error)
+{
+    Dwarf_Debug dbg = context->cc_dbg;
+    Dwarf_Half address_size = context->cc_address_size;
+    Dwarf_Addr base = 0;
+    int res = 0;
+
+    res = _dwarf_lists5_bases(context,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    base = context->cc_lists5_low_pc;
+    memset(block_out,0,sizeof(*block_out));
+    if (source == LOC_SOURCE_LOCLISTS) {
+        Dwarf_Small *secstart = 0;
+        Dwarf_Small *secend = 0;
+        Dwarf_Small *ptr = 0;
+        Dwarf_Small *default_expr = 0;
+        Dwarf_Unsigned default_len = 0;
+        Dwarf_Unsigned default_entry = 0;
+        Dwarf_Bool have_default = FALSE;
+
+        res = _dwarf_load_section(dbg,&dbg->de_debug_loclists,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        if (offset >= dbg->de_debug_loclists.dss_size) {
+            _dwarf_error(dbg,error,DW_DLE_LOCLISTS_ERROR);
+            return DW_DLV_ERROR;
+        }
+        secstart = dbg->de_debug_loclists.dss_data;
+        secend = secstart + dbg->de_debug_loclists.dss_size;
+        ptr = secstart + offset;
+        for (;;) {
+            Dwarf_Small *entry = ptr;
+            Dwarf_Small kind = 0;
+            Dwarf_Addr low = 0;
+            Dwarf_Addr high = 0;
+            Dwarf_Small *expr = 0;
+            Dwarf_Unsigned exprlen = 0;
+
+            res = _dwarf_loclists_read_entry(context,&ptr,secend,
+                &base,&kind,&low,&high,&expr,&exprlen,error);
+            if (res != DW_DLV_OK) {
+                return res;
+            }
+            if (kind == DW_LLE_end_of_list) {
+                break;
+            }
+            if (kind == DW_LLE_default_location) {
+                have_default = TRUE;
+                default_expr = expr;
+                default_len = exprlen;
+                default_entry = entry - secstart;
+                continue;
+            }
+            if (kind == DW_LLE_start_end && pc >= low && pc < high) {
+                block_out->bl_len = exprlen;
+                block_out->bl_data = expr;
+                block_out->bl_section_offset = expr - secstart;
+                block_out->bl_locdesc_offset = entry - secstart;
+                *lowpc_out = low;
+                *highpc_out = high;
+                return DW_DLV_OK;
+            }
+        }
+        if (!have_default) {
+            return DW_DLV_NO_ENTRY;
+        }
+        block_out->bl_len = default_len;
+        block_out->bl_data = default_expr;
+        block_out->bl_section_offset = default_expr - secstart;
+        block_out->bl_locdesc_offset = default_entry;
+        *lowpc_out = 0;
+        *highpc_out = MAX_ADDR;
+        return DW_DLV_OK;
+    }
+    for (;;) {
+        Dwarf_Block_c b;
+        Dwarf_Addr lowpc = 0;
+        Dwarf_Addr highpc = 0;
+        Dwarf_Addr low = 0;
+        Dwarf_Addr high = 0;
+
+        if (source == LOC_SOURCE_LOC) {
+            res = _dwarf_read_loc_section(dbg, &b,
+                &lowpc, &highpc, offset, address_size,error);
+            if (res != DW_DLV_OK) {
+                return res;
+            }
+            if (lowpc == 0 && highpc == 0) {
+                return DW_DLV_NO_ENTRY;
+            }
+            b.bl_locdesc_offset = offset;
+            offset = b.bl_section_offset + b.bl_len;
+            if (lowpc == MAX_ADDR) {
+                base = highpc;
+                continue;
+            }
+            low = base + lowpc;
+            high = base + highpc;
+        } else {
+            Dwarf_Half lle_op = 0;
+            Dwarf_Bool at_end = FALSE;
+
+            res = _dwarf_read_loc_section_dwo(dbg, &b,
+                &lowpc, &highpc, &at_end, &lle_op,
+                offset, address_size, error);
+            if (res != DW_DLV_OK) {
+                return res;
+            }
+            if (at_end) {
+                return DW_DLV_NO_ENTRY;
+            }
+            offset = b.bl_section_offset + b.bl_len;
+            switch(lle_op) {
+            case DW_LLEX_base_address_selection_entry:
+                res = _dwarf_extract_address_from_debug_addr(dbg,
+                    context,highpc,&base,error);
+                if (res != DW_DLV_OK) {
+                    return res;
+                }
+                continue;
+            case DW_LLEX_start_end_entry:
+                res = _dwarf_extract_address_from_debug_addr(dbg,
+                    context,lowpc,&low,error);
+                if (res != DW_DLV_OK) {
+                    return res;
+                }
+                res = _dwarf_extract_address_from_debug_addr(dbg,
+                    context,highpc,&high,error);
+                if (res != DW_DLV_OK) {
+                    return res;
+                }
+                break;
+            case DW_LLEX_start_length_entry:
+                res = _dwarf_extract_address_from_debug_addr(dbg,
+                    context,lowpc,&low,error);
+                if (res != DW_DLV_OK) {
+                    return res;
+                }
+                high = low + highpc;
+                break;
+            default: /* DW_LLEX_offset_pair_entry */
+                low = base + lowpc;
+                high = base + highpc;
+                break;
+            }
+        }
+        if (pc >= low && pc < high) {
+            *block_out = b;
+            *lowpc_out = low;
+            *highpc_out = high;
+            return DW_DLV_OK;
+        }
+    }
+}
+
+/*  Gets the location expression of a DW_AT_location
+    (or similar) attribute that is not a location list. */
+static int
+_dwarf_loc_expr_block(Dwarf_Debug dbg,
+    Dwarf_Attribute attr,
+    Dwarf_Block_c *block_out,
+    Dwarf_Error *error)
+{
+    Dwarf_Half form = 0;
+    int res = 0;
+
+    res = dwarf_whatform(attr, &form, error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    memset(block_out,0,sizeof(*block_out));
+    if (form == DW_FORM_exprloc) {
+        res = dwarf_formexprloc(attr,&block_out->bl_len,
+            &block_out->bl_data,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        block_out->bl_section_offset =
+            (char *)block_out->bl_data -
+            (char *)dbg->de_debug_info.dss_data;
+    } else {
+        Dwarf_Block *tblock = 0;
+
+        res = dwarf_formblock(attr, &tblock, error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        block_out->bl_len = tblock->bl_len;
+        block_out->bl_data = tblock->bl_data;
+        block_out->bl_from_loclist = tblock->bl_from_loclist;
+        block_out->bl_section_offset = tblock->bl_section_offset;
+        dwarf_dealloc(dbg, tblock, DW_DLA_BLOCK);
+    }
+    return DW_DLV_OK;
+}
+
+/*  New 2018.
+    As dwarf_get_loclist_c() but returns only the one
+    entry of a location list in effect at pc, and only
+    that entry's expression is decoded.  For a location
+    expression (not a list) that expression is returned. */
+int
+dwarf_get_loclist_for_pc_c(Dwarf_Attribute attr,
+    Dwarf_Addr pc,
+    Dwarf_Loc_Head_c * ll_header_out,
+    Dwarf_Addr       * lowpc_out,
+    Dwarf_Addr       * highpc_out,
+    Dwarf_Error      * error)
+{
+    Dwarf_Debug dbg = 0;
+    Dwarf_CU_Context cucontext = 0;
+    Dwarf_Half form = 0;
+    Dwarf_Small source = 0;
+    Dwarf_Unsigned offset = 0;
+    Dwarf_Block_c loc_block;
+    Dwarf_Addr lowpc = 0;
+    Dwarf_Addr highpc = 0;
+    Dwarf_Loc_Head_c llhead = 0;
+    Dwarf_Locdesc_c llbuf = 0;
+    Dwarf_Half address_size = 0;
+    int res = 0;
+
+    res = _dwarf_setup_loc(attr, &dbg,&cucontext, &form, error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    address_size = cucontext->cc_address_size;
+    res = _dwarf_loc_attr_source(attr,&source,&offset,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    if (source == LOC_SOURCE_EXPR) {
+        res = _dwarf_loc_expr_block(dbg,attr,&loc_block,error);
+        lowpc = 0;
+        highpc = MAX_ADDR;
+    } else {
+        res = _dwarf_loc_find_pc_in_list(cucontext,source,offset,
+            pc,&loc_block,&lowpc,&highpc,error);
+    }
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    llhead = (Dwarf_Loc_Head_c)_dwarf_get_alloc(dbg,
+        DW_DLA_LOC_HEAD_C, 1);
+    if (!llhead) {
+        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+        return (DW_DLV_ERROR);
+    }
+    llbuf = (Dwarf_Locdesc_c)
+        _dwarf_get_alloc(dbg, DW_DLA_LOCDESC_C, 1);
+    if (!llbuf) {
+        dwarf_loc_head_c_dealloc(llhead);
+        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+        return (DW_DLV_ERROR);
+    }
+    llhead->ll_locdesc = llbuf;
+    llhead->ll_locdesc_count = 1;
+    llhead->ll_from_loclist = (source == LOC_SOURCE_EXPR)?
+        0:(source == LOC_SOURCE_LOC_DWO? 2:1);
+    llhead->ll_context = cucontext;
+    llhead->ll_dbg = dbg;
+    res = _dwarf_get_locdesc_op_c(dbg,
+        0,
+        llhead,
+        &loc_block,
+        address_size,
+        cucontext->cc_length_size,
+        cucontext->cc_version_stamp,
+        lowpc, highpc,
+        error);
+    if (res != DW_DLV_OK) {
+        dwarf_loc_head_c_dealloc(llhead);
+        return res;
+    }
+    if (source != LOC_SOURCE_EXPR) {
+        /*  lopc and hipc are final pc values here,
+            whatever the list entry kind was. */
+        llbuf->ld_lle_value = DW_LLEX_start_end_entry;
+        llbuf->ld_from_loclist = llhead->ll_from_loclist;
+    }
+    *ll_header_out = llhead;
+    *lowpc_out = lowpc;
+    *highpc_out = highpc;
+    return DW_DLV_OK;
+}
+
+struct Dwarf_Var_Loc_Build_s {
+    struct Dwarf_Var_Loc_s *vb_vars;
+    Dwarf_Unsigned vb_count;
+    Dwarf_Unsigned vb_alloc;
+    struct Dwarf_Var_Loc_Block_s *vb_blocks;
+    Dwarf_Unsigned vb_block_count;
+    Dwarf_Unsigned vb_block_alloc;
+    struct Dwarf_Var_Loc_Range_s *vb_ranges;
+    Dwarf_Unsigned vb_range_count;
+    Dwarf_Unsigned vb_range_alloc;
+    /*  For .debug_ranges entries, read when first needed. */
+    Dwarf_Addr     vb_cu_base;
+    Dwarf_Bool     vb_have_cu_base;
+};
+
+static void
+_dwarf_var_loc_build_free(struct Dwarf_Var_Loc_Build_s *vb)
+{
+    free(vb->vb_vars);
+    free(vb->vb_blocks);
+    free(vb->vb_ranges);
+    memset(vb,0,sizeof(*vb));
+}
+
+static int
+_dwarf_var_loc_add_range(Dwarf_Debug dbg,
+    struct Dwarf_Var_Loc_Build_s *vb,
+    Dwarf_Addr low, Dwarf_Addr high,
+    Dwarf_Error *error)
+{
+    struct Dwarf_Var_Loc_Range_s *vr = 0;
+
+    if (vb->vb_range_count == vb->vb_range_alloc) {
+        Dwarf_Unsigned newalloc = vb->vb_range_alloc?
+            2*vb->vb_range_alloc: 16;
+        struct Dwarf_Var_Loc_Range_s *newranges =
+            (struct Dwarf_Var_Loc_Range_s *)realloc(vb->vb_ranges,
+            newalloc * sizeof(struct Dwarf_Var_Loc_Range_s));
+
+        if (!newranges) {
+            _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+            return DW_DLV_ERROR;
+        }
+        vb->vb_ranges = newranges;
+        vb->vb_range_alloc = newalloc;
+    }
+    vr = vb->vb_ranges + vb->vb_range_count;
+    vr->vr_low = low;
+    vr->vr_high = high;
+    vb->vb_range_count++;
+    return DW_DLV_OK;
+}
+
+/*  Adds the ranges of a DWARF5 DW_AT_ranges list
+    (.debug_rnglists). */
+#define VAR_LOC_LOCAL_RANGES 16
+static int
+_dwarf_var_loc_add_rnglist(Dwarf_Debug dbg,
+    struct Dwarf_Var_Loc_Build_s *vb,
+    Dwarf_Die die,
+    Dwarf_Attribute attr,
+    Dwarf_Error *error)
+{
+    Dwarf_Rnglist_Range localranges[VAR_LOC_LOCAL_RANGES];
+    Dwarf_Rnglist_Range *ranges = localranges;
+    Dwarf_Off listoff = 0;
+    Dwarf_Unsigned count = 0;
+    Dwarf_Unsigned i = 0;
+    int res = 0;
+
+    res = dwarf_get_rnglist_offset(attr,&listoff,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    res = dwarf_get_rnglist(die,listoff,ranges,
+        VAR_LOC_LOCAL_RANGES,&count,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    if (count > VAR_LOC_LOCAL_RANGES) {
+        ranges = (Dwarf_Rnglist_Range *)malloc(
+            count * sizeof(Dwarf_Rnglist_Range));
+        if (!ranges) {
+            _dwarf_error(dbg,error,DW_DLE_ALLOC_FAIL);
+            return DW_DLV_ERROR;
+        }
+        res = dwarf_get_rnglist(die,listoff,ranges,
+            count,&count,error);
+    }
+    for (i = 0; res == DW_DLV_OK && i < count; ++i) {
+        res = _dwarf_var_loc_add_range(dbg,vb,ranges[i].drr_lowpc,
+            ranges[i].drr_highpc,error);
+    }
+    if (ranges != localranges) {
+        free(ranges);
+    }
+    return res;
+}
+
+/*  The base address for .debug_ranges entries: the
+    DW_AT_low_pc of the CU DIE, or 0. */
+static int
+_dwarf_var_loc_cu_base(Dwarf_Debug dbg,
+    struct Dwarf_Var_Loc_Build_s *vb,
+    Dwarf_Die die,
+    Dwarf_Error *error)
+{
+    Dwarf_Die_Storage custore;
+    Dwarf_Die cu_die = 0;
+    Dwarf_Off cu_die_offset = 0;
+    int res = 0;
+
+    if (vb->vb_have_cu_base) {
+        return DW_DLV_OK;
+    }
+    res = dwarf_CU_dieoffset_given_die(die,&cu_die_offset,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    res = dwarf_offdie_inplace(dbg,cu_die_offset,die->di_is_info,
+        &custore,&cu_die,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    res = dwarf_lowpc(cu_die,&vb->vb_cu_base,error);
+    if (res == DW_DLV_ERROR) {
+        return res;
+    }
+    vb->vb_have_cu_base = TRUE;
+    return DW_DLV_OK;
+}
+
+/*  Records the pc ranges of die, from DW_AT_low_pc/DW_AT_high_pc
+    or DW_AT_ranges, as a new block inside parent_block.
+    A die with neither gets a block with no ranges,
+    which places no limit on pc. */
+static int
+_dwarf_var_loc_add_block(Dwarf_Debug dbg,
+    struct Dwarf_Var_Loc_Build_s *vb,
+    Dwarf_Die die,
+    Dwarf_Unsigned parent_block,
+    Dwarf_Unsigned *block_out,
+    Dwarf_Error *error)
+{
+    struct Dwarf_Var_Loc_Block_s *vk = 0;
+    Dwarf_Unsigned range_first = vb->vb_range_count;
+    Dwarf_Addr low = 0;
+    Dwarf_Addr high = 0;
+    Dwarf_Half highform = 0;
+    enum Dwarf_Form_Class highclass = DW_FORM_CLASS_UNKNOWN;
+    Dwarf_Attribute_Storage astore;
+    Dwarf_Attribute attr = 0;
+    int res = 0;
+
+    if (vb->vb_block_count == vb->vb_block_alloc) {
+        Dwarf_Unsigned newalloc = vb->vb_block_alloc?
+            2*vb->vb_block_alloc: 8;
+        struct Dwarf_Var_Loc_Block_s *newblocks =
+            (struct Dwarf_Var_Loc_Block_s *)realloc(vb->vb_blocks,
+            newalloc * sizeof(struct Dwarf_Var_Loc_Block_s));
+
+        if (!newblocks) {
+            _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+            return DW_DLV_ERROR;
+        }
+        vb->vb_blocks = newblocks;
+        vb->vb_block_alloc = newalloc;
+    }
+    res = dwarf_lowpc(die,&low,error);
+    if (res == DW_DLV_ERROR) {
+        return res;
+    }
+    if (res == DW_DLV_OK) {
+        res = dwarf_highpc_b(die,&high,&highform,&highclass,error);
+        if (res == DW_DLV_ERROR) {
+            return res;
+        }
+        if (res == DW_DLV_OK) {
+            if (highclass == DW_FORM_CLASS_CONSTANT) {
+                high += low;
+            }
+            res = _dwarf_var_loc_add_range(dbg,vb,low,high,error);
+            if (res != DW_DLV_OK) {
+                return res;
+            }
+        }
+    } else {
+        res = dwarf_attr_inplace(die,DW_AT_ranges,&astore,&attr,error);
+        if (res == DW_DLV_ERROR) {
+            return res;
+        }
+    }
+    if (attr && (die->di_cu_context->cc_version_stamp >= DW_CU_VERSION5 ||
+        attr->ar_attribute_form == DW_FORM_rnglistx)) {
+        res = _dwarf_var_loc_add_rnglist(dbg,vb,die,attr,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+    } else if (attr) {
+        Dwarf_Off rangesoffset = 0;
+        Dwarf_Ranges *ranges = 0;
+        Dwarf_Signed rangecount = 0;
+        Dwarf_Signed i = 0;
+        Dwarf_Addr base = 0;
+
+        res = _dwarf_var_loc_cu_base(dbg,vb,die,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        base = vb->vb_cu_base;
+        res = dwarf_global_formref(attr,&rangesoffset,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        res = dwarf_get_ranges_a(dbg,rangesoffset,die,
+            &ranges,&rangecount,0,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        for (i = 0; i < rangecount; ++i) {
+            Dwarf_Ranges *r = ranges + i;
+
+            if (r->dwr_type == DW_RANGES_END) {
+                break;
+            }
+            if (r->dwr_type == DW_RANGES_ADDRESS_SELECTION) {
+                base = r->dwr_addr2;
+                continue;
+            }
+            res = _dwarf_var_loc_add_range(dbg,vb,base + r->dwr_addr1,
+                base + r->dwr_addr2,error);
+            if (res != DW_DLV_OK) {
+                dwarf_ranges_dealloc(dbg,ranges,rangecount);
+                return res;
+            }
+        }
+        dwarf_ranges_dealloc(dbg,ranges,rangecount);
+    }
+    vk = vb->vb_blocks + vb->vb_block_count;
+    vk->vk_parent = parent_block;
+    vk->vk_range_first = range_first;
+    vk->vk_range_count = vb->vb_range_count - range_first;
+    vb->vb_block_count++;
+    *block_out = vb->vb_block_count;
+    return DW_DLV_OK;
+}
+
+static int
+_dwarf_var_loc_add(Dwarf_Debug dbg,
+    struct Dwarf_Var_Loc_Build_s *vb,
+    Dwarf_Die die,
+    Dwarf_Unsigned block,
+    Dwarf_Error *error)
+{
+    Dwarf_Attribute_Storage astore;
+    Dwarf_Attribute attr = 0;
+    Dwarf_Small source = 0;
+    Dwarf_Unsigned offset = 0;
+    struct Dwarf_Var_Loc_s *vl = 0;
+    int res = 0;
+
+    res = dwarf_attr_inplace(die,DW_AT_location,&astore,&attr,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    res = _dwarf_loc_attr_source(attr,&source,&offset,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    if (source == LOC_SOURCE_EXPR) {
+        Dwarf_Block_c b;
+
+        res = _dwarf_loc_expr_block(dbg,attr,&b,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        if (!b.bl_len) {
+            /* An empty expression: optimized away. */
+            return DW_DLV_NO_ENTRY;
+        }
+    }
+    if (vb->vb_count == vb->vb_alloc) {
+        Dwarf_Unsigned newalloc = vb->vb_alloc? 2*vb->vb_alloc: 16;
+        struct Dwarf_Var_Loc_s *newvars =
+            (struct Dwarf_Var_Loc_s *)realloc(vb->vb_vars,
+            newalloc * sizeof(struct Dwarf_Var_Loc_s));
+
+        if (!newvars) {
+            _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+            return DW_DLV_ERROR;
+        }
+        vb->vb_vars = newvars;
+        vb->vb_alloc = newalloc;
+    }
+    vl = vb->vb_vars + vb->vb_count;
+    res = dwarf_dieoffset(die,&vl->vl_die_offset,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    vl->vl_list_offset = offset;
+    vl->vl_source = source;
+    vl->vl_block = block;
+    vb->vb_count++;
+    return DW_DLV_OK;
+}
+
+/*  Records the variables and parameters with a location
+    among the descendants of parent, not looking inside
+    nested DW_TAG_subprogram DIEs.  block is the innermost
+    scope enclosing parent, as vl_block.  */
+static int
+_dwarf_var_loc_collect(Dwarf_Debug dbg,
+    struct Dwarf_Var_Loc_Build_s *vb,
+    Dwarf_Die parent,
+    Dwarf_Unsigned block,
+    Dwarf_Error *error)
+{
+    Dwarf_Die_Storage childstore;
+    Dwarf_Die_Storage sibstore;
+    Dwarf_Die cur = 0;
+    int res = 0;
+
+    res = dwarf_child_inplace(parent,&childstore,&cur,error);
+    while (res == DW_DLV_OK) {
+        Dwarf_Half tag = 0;
+        Dwarf_Die_Storage *next_store = 0;
+
+        res = dwarf_tag(cur,&tag,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        if (tag == DW_TAG_variable ||
+            tag == DW_TAG_formal_parameter) {
+            res = _dwarf_var_loc_add(dbg,vb,cur,block,error);
+            if (res == DW_DLV_ERROR) {
+                return res;
+            }
+        } else if (tag != DW_TAG_subprogram) {
+            Dwarf_Unsigned inner = block;
+
+            if (tag == DW_TAG_lexical_block ||
+                tag == DW_TAG_inlined_subroutine) {
+                res = _dwarf_var_loc_add_block(dbg,vb,cur,
+                    block,&inner,error);
+                if (res != DW_DLV_OK) {
+                    return res;
+                }
+            }
+            res = _dwarf_var_loc_collect(dbg,vb,cur,inner,error);
+            if (res == DW_DLV_ERROR) {
+                return res;
+            }
+        }
+        /*  The sibling must not overwrite cur while it
+            is being read, so alternate between the two. */
+        next_store = (cur == (Dwarf_Die)&childstore)?
+            &sibstore:&childstore;
+        res = dwarf_siblingof_inplace(dbg,cur,
+            cur->di_is_info,next_store,&cur,error);
+    }
+    if (res == DW_DLV_ERROR) {
+        return res;
+    }
+    return DW_DLV_OK;
+}
+
+void
+_dwarf_free_var_loc_sets(Dwarf_CU_Context context)
+{
+    struct Dwarf_Var_Loc_Set_s *vs = context->cc_var_loc_sets;
+
+    while (vs) {
+        struct Dwarf_Var_Loc_Set_s *next = vs->vs_next;
+
+        free(vs->vs_vars);
+        free(vs->vs_blocks);
+        free(vs->vs_ranges);
+        free(vs);
+        vs = next;
+    }
+    context->cc_var_loc_sets = 0;
+}
+
+/*  The variable location set of the subprogram at
+    offset, built on first use and kept, most recently
+    used first, on the CU context.  */
+static int
+_dwarf_var_loc_set(Dwarf_Debug dbg,
+    Dwarf_Die subprogram,
+    struct Dwarf_Var_Loc_Set_s **set_out,
+    Dwarf_Error *error)
+{
+    Dwarf_CU_Context context = subprogram->di_cu_context;
+    struct Dwarf_Var_Loc_Set_s *vs = 0;
+    struct Dwarf_Var_Loc_Set_s *prev = 0;
+    struct Dwarf_Var_Loc_Build_s vb;
+    Dwarf_Off offset = 0;
+    int res = 0;
+
+    res = dwarf_dieoffset(subprogram,&offset,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    for (vs = context->cc_var_loc_sets; vs;
+        prev = vs, vs = vs->vs_next) {
+        if (vs->vs_subprogram_offset == offset) {
+            if (prev) {
+                prev->vs_next = vs->vs_next;
+                vs->vs_next = context->cc_var_loc_sets;
+                context->cc_var_loc_sets = vs;
+            }
+            *set_out = vs;
+            return DW_DLV_OK;
+        }
+    }
+    memset(&vb,0,sizeof(vb));
+    res = _dwarf_var_loc_collect(dbg,&vb,subprogram,0,error);
+    if (res != DW_DLV_OK) {
+        _dwarf_var_loc_build_free(&vb);
+        return res;
+    }
+    vs = (struct Dwarf_Var_Loc_Set_s *)calloc(1,sizeof(*vs));
+    if (!vs) {
+        _dwarf_var_loc_build_free(&vb);
+        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+        return DW_DLV_ERROR;
+    }
+    vs->vs_subprogram_offset = offset;
+    vs->vs_vars = vb.vb_vars;
+    vs->vs_count = vb.vb_count;
+    vs->vs_blocks = vb.vb_blocks;
+    vs->vs_block_count = vb.vb_block_count;
+    vs->vs_ranges = vb.vb_ranges;
+    vs->vs_range_count = vb.vb_range_count;
+    vs->vs_next = context->cc_var_loc_sets;
+    context->cc_var_loc_sets = vs;
+    *set_out = vs;
+    return DW_DLV_OK;
+}
+
+/*  Whether pc is inside block (as vl_block) and
+    all the blocks enclosing it.  */
+static Dwarf_Bool
+_dwarf_var_loc_block_has_pc(struct Dwarf_Var_Loc_Set_s *vs,
+    Dwarf_Unsigned block,
+    Dwarf_Addr pc)
+{
+    while (block) {
+        struct Dwarf_Var_Loc_Block_s *vk = vs->vs_blocks + block - 1;
+        Dwarf_Unsigned i = 0;
+        Dwarf_Bool found = FALSE;
+
+        if (!vk->vk_range_count) {
+            found = TRUE;
+        }
+        for (i = 0; !found && i < vk->vk_range_count; ++i) {
+            struct Dwarf_Var_Loc_Range_s *vr =
+                vs->vs_ranges + vk->vk_range_first + i;
+
+            if (pc >= vr->vr_low && pc < vr->vr_high) {
+                found = TRUE;
+            }
+        }
+        if (!found) {
+            return FALSE;
+        }
+        block = vk->vk_parent;
+    }
+    return TRUE;
+}
+
+/*  New 2018.
+    Which variables and parameters of subprogram
+    have a location at pc.  */
+int
+dwarf_get_variables_at_pc(Dwarf_Die subprogram,
+    Dwarf_Addr       pc,
+    Dwarf_Off      * var_offsets,
+    Dwarf_Unsigned   var_max,
+    Dwarf_Unsigned * var_count,
+    Dwarf_Error    * error)
+{
+    Dwarf_Debug dbg = 0;
+    Dwarf_CU_Context context = 0;
+    struct Dwarf_Var_Loc_Set_s *vs = 0;
+    Dwarf_Unsigned count = 0;
+    Dwarf_Unsigned i = 0;
+    int res = 0;
+
+    CHECK_DIE(subprogram, DW_DLV_ERROR);
+    context = subprogram->di_cu_context;
+    dbg = context->cc_dbg;
+    res = _dwarf_var_loc_set(dbg,subprogram,&vs,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    for (i = 0; i < vs->vs_count; ++i) {
+        struct Dwarf_Var_Loc_s *vl = vs->vs_vars + i;
+
+        if (vl->vl_source != LOC_SOURCE_EXPR) {
+            Dwarf_Block_c b;
+            Dwarf_Addr lowpc = 0;
+            Dwarf_Addr highpc = 0;
+
+            res = _dwarf_loc_find_pc_in_list(context,
+                vl->vl_source,vl->vl_list_offset,pc,
+                &b,&lowpc,&highpc,error);
+            if (res == DW_DLV_ERROR) {
+                return res;
+            }
+            if (res == DW_DLV_NO_ENTRY || !b.bl_len) {
+                continue;
+            }
+        } else if (!_dwarf_var_loc_block_has_pc(vs,vl->vl_block,pc)) {
+            /*  A single expression holds over the
+                scope the variable is declared in. */
+            continue;
+        }
+        if (count < var_max) {
+            var_offsets[count] = vl->vl_die_offset;
+        }
+        count++;
+    }
+    if (!count) {
+        return DW_DLV_NO_ENTRY;
+    }
+    *var_count = count;
+    return DW_DLV_OK;
+}
+
 /* An interface giving us no cu context! */
 int
 dwarf_loclist_from_expr_c(Dwarf_Debug dbg,
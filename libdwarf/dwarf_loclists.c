@@ -0,0 +1,283 @@
+/*
+
+  Copyright (C) 2018 David Anderson. All Rights Reserved.
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of version 2.1 of the GNU Lesser General Public License
+  as published by the Free Software Foundation.
+
+  This program is distributed in the hope that it would be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  Further, this software is distributed without any warranty that it is
+  free of the rightful claim of any third person regarding infringement
+  or the like.  Any license provided herein, whether implied or
+  otherwise, applies only to this software file.  Patent licenses, if
+  any, provided herein do not apply to combinations of this program with
+  other software, or any other product whatsoever.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program; if not, write the Free Software
+  Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston MA 02110-1301,
+  USA.
+
+*/
+
+/*  DWARF5 location lists, .debug_loclists.
+    Decoded the same way as range lists (see dwarf_rnglists.c):
+    straight into the caller's array, with base address entries
+    and .debug_addr indices applied as they are read.
+    The location expressions are returned as pointers into
+    the section, not copied.  */
+
+#include "config.h"
+#include "dwarf_incl.h"
+#include "dwarf_loc.h"
+
+/*  New 2018. */
+int
+dwarf_get_loclist_offset(Dwarf_Attribute attr,
+    Dwarf_Off *offset_out,
+    Dwarf_Error *error)
+{
+    Dwarf_CU_Context context = 0;
+    Dwarf_Debug dbg = 0;
+    Dwarf_Unsigned index = 0;
+    Dwarf_Unsigned offset = 0;
+    Dwarf_Byte_Ptr info_end = 0;
+    Dwarf_Byte_Ptr info_ptr = 0;
+    int res = 0;
+
+    if (attr == NULL) {
+        _dwarf_error(NULL, error, DW_DLE_ATTR_NULL);
+        return DW_DLV_ERROR;
+    }
+    context = attr->ar_cu_context;
+    dbg = context->cc_dbg;
+    if (attr->ar_attribute_form != DW_FORM_loclistx) {
+        Dwarf_Off secoff = 0;
+
+        res = dwarf_global_formref(attr,&secoff,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        *offset_out = secoff;
+        return DW_DLV_OK;
+    }
+    info_ptr = attr->ar_debug_ptr;
+    info_end = _dwarf_calculate_info_section_end_ptr(context);
+    DECODE_LEB128_UWORD_CK(info_ptr,index,dbg,error,info_end);
+    res = _dwarf_lists5_bases(context,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    res = _dwarf_load_section(dbg,&dbg->de_debug_loclists,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    res = _dwarf_lists5_offset_from_index(context,
+        &dbg->de_debug_loclists,
+        context->cc_loclists_base_present,
+        context->cc_loclists_base,
+        index,&offset,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    *offset_out = offset;
+    return DW_DLV_OK;
+}
+
+/*  Reads the location list entry at *ptr_io, leaving *ptr_io
+    just past it.  Base address entries update *base_io and
+    return DW_LLE_base_address.  Every bounded entry returns
+    DW_LLE_start_end with the final pc range in *low_out
+    and *high_out.  DW_LLE_default_location and
+    DW_LLE_end_of_list are returned as themselves.
+    The expression is only located, not decoded.  */
+int
+_dwarf_loclists_read_entry(Dwarf_CU_Context context,
+    Dwarf_Small **ptr_io,
+    Dwarf_Small *secend,
+    Dwarf_Addr *base_io,
+    Dwarf_Small *kind_out,
+    Dwarf_Addr *low_out,
+    Dwarf_Addr *high_out,
+    Dwarf_Small **expr_out,
+    Dwarf_Unsigned *exprlen_out,
+    Dwarf_Error *error)
+{
+    Dwarf_Debug dbg = context->cc_dbg;
+    Dwarf_Half address_size = context->cc_address_size;
+    Dwarf_Small *ptr = *ptr_io;
+    Dwarf_Small code = 0;
+    Dwarf_Small kind = DW_LLE_start_end;
+    Dwarf_Unsigned v1 = 0;
+    Dwarf_Unsigned v2 = 0;
+    Dwarf_Unsigned exprlen = 0;
+    Dwarf_Addr low = 0;
+    Dwarf_Addr high = 0;
+    int res = 0;
+
+    if (ptr >= secend) {
+        _dwarf_error(dbg,error,DW_DLE_LOCLISTS_ERROR);
+        return DW_DLV_ERROR;
+    }
+    code = *ptr++;
+    switch(code) {
+    case DW_LLE_end_of_list:
+        *ptr_io = ptr;
+        *kind_out = DW_LLE_end_of_list;
+        return DW_DLV_OK;
+    case DW_LLE_base_addressx:
+        DECODE_LEB128_UWORD_CK(ptr,v1,dbg,error,secend);
+        res = _dwarf_extract_address_from_debug_addr(dbg,
+            context,v1,base_io,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        *ptr_io = ptr;
+        *kind_out = DW_LLE_base_address;
+        return DW_DLV_OK;
+    case DW_LLE_startx_endx:
+        DECODE_LEB128_UWORD_CK(ptr,v1,dbg,error,secend);
+        DECODE_LEB128_UWORD_CK(ptr,v2,dbg,error,secend);
+        res = _dwarf_extract_address_from_debug_addr(dbg,
+            context,v1,&low,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        res = _dwarf_extract_address_from_debug_addr(dbg,
+            context,v2,&high,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        break;
+    case DW_LLE_startx_length:
+        DECODE_LEB128_UWORD_CK(ptr,v1,dbg,error,secend);
+        DECODE_LEB128_UWORD_CK(ptr,v2,dbg,error,secend);
+        res = _dwarf_extract_address_from_debug_addr(dbg,
+            context,v1,&low,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        high = low + v2;
+        break;
+    case DW_LLE_offset_pair:
+        DECODE_LEB128_UWORD_CK(ptr,v1,dbg,error,secend);
+        DECODE_LEB128_UWORD_CK(ptr,v2,dbg,error,secend);
+        low = *base_io + v1;
+        high = *base_io + v2;
+        break;
+    case DW_LLE_default_location:
+        kind = DW_LLE_default_location;
+        break;
+    case DW_LLE_base_address:
+        READ_UNALIGNED_CK(dbg,*base_io,Dwarf_Addr,
+            ptr,address_size,error,secend);
+        ptr += address_size;
+        *ptr_io = ptr;
+        *kind_out = DW_LLE_base_address;
+        return DW_DLV_OK;
+    case DW_LLE_start_end:
+        READ_UNALIGNED_CK(dbg,low,Dwarf_Addr,
+            ptr,address_size,error,secend);
+        ptr += address_size;
+        READ_UNALIGNED_CK(dbg,high,Dwarf_Addr,
+            ptr,address_size,error,secend);
+        ptr += address_size;
+        break;
+    case DW_LLE_start_length:
+        READ_UNALIGNED_CK(dbg,low,Dwarf_Addr,
+            ptr,address_size,error,secend);
+        ptr += address_size;
+        DECODE_LEB128_UWORD_CK(ptr,v2,dbg,error,secend);
+        high = low + v2;
+        break;
+    default:
+        _dwarf_error(dbg,error,DW_DLE_LOCLISTS_ERROR);
+        return DW_DLV_ERROR;
+    }
+    /*  Every bounded entry and the default entry
+        carry a counted location description. */
+    DECODE_LEB128_UWORD_CK(ptr,exprlen,dbg,error,secend);
+    if (exprlen > (Dwarf_Unsigned)(secend - ptr)) {
+        _dwarf_error(dbg,error,DW_DLE_LOCLISTS_ERROR);
+        return DW_DLV_ERROR;
+    }
+    *kind_out = kind;
+    *low_out = low;
+    *high_out = high;
+    *expr_out = ptr;
+    *exprlen_out = exprlen;
+    *ptr_io = ptr + exprlen;
+    return DW_DLV_OK;
+}
+
+/*  New 2018. */
+int
+dwarf_get_loclist(Dwarf_Die die,
+    Dwarf_Off offset,
+    Dwarf_Loclist_Range *locs,
+    Dwarf_Unsigned locs_max,
+    Dwarf_Unsigned *locs_count,
+    Dwarf_Error *error)
+{
+    Dwarf_CU_Context context = 0;
+    Dwarf_Debug dbg = 0;
+    Dwarf_Small *ptr = 0;
+    Dwarf_Small *secend = 0;
+    Dwarf_Addr base = 0;
+    Dwarf_Unsigned count = 0;
+    int res = 0;
+
+    CHECK_DIE(die, DW_DLV_ERROR);
+    context = die->di_cu_context;
+    dbg = context->cc_dbg;
+    res = _dwarf_load_section(dbg,&dbg->de_debug_loclists,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    if (offset >= dbg->de_debug_loclists.dss_size) {
+        _dwarf_error(dbg,error,DW_DLE_LOCLISTS_ERROR);
+        return DW_DLV_ERROR;
+    }
+    res = _dwarf_lists5_bases(context,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    base = context->cc_lists5_low_pc;
+    ptr = dbg->de_debug_loclists.dss_data + offset;
+    secend = dbg->de_debug_loclists.dss_data +
+        dbg->de_debug_loclists.dss_size;
+    for (;;) {
+        Dwarf_Small kind = 0;
+        Dwarf_Addr low = 0;
+        Dwarf_Addr high = 0;
+        Dwarf_Small *expr = 0;
+        Dwarf_Unsigned exprlen = 0;
+
+        res = _dwarf_loclists_read_entry(context,&ptr,secend,
+            &base,&kind,&low,&high,&expr,&exprlen,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        if (kind == DW_LLE_end_of_list) {
+            break;
+        }
+        if (kind == DW_LLE_base_address) {
+            continue;
+        }
+        if (count < locs_max) {
+            locs[count].dlr_lowpc = low;
+            locs[count].dlr_highpc = high;
+            locs[count].dlr_expr = (Dwarf_Ptr)expr;
+            locs[count].dlr_expr_len = exprlen;
+            locs[count].dlr_is_default =
+                (kind == DW_LLE_default_location);
+        }
+        count++;
+    }
+    *locs_count = count;
+    return DW_DLV_OK;
+}
@@ -270,6 +270,38 @@ struct Dwarf_CU_Context_s {
         For DWARF 2,3,4 this is filled in initially
         from the CU header and refined by inspecting the TAG
         of the CU DIE to detect DW_UT_partial is applicable.  */
+
+    /*  The DIEs of this unit in preorder, built on request by
+        dwarf_die_array_build(). NULL if not built.
+        Freed by dwarf_die_array_free() or at dwarf_finish().  */
+    struct Dwarf_Die_Array_Entry_s *cc_die_array;
+    Dwarf_Unsigned cc_die_array_count;
+
+    /*  Open-addressed hash table remembering where
+        subtrees skipped by dwarf_siblingof_b() end,
+        so each is walked only once.
+        cc_sibling_cache_size is zero or a power of two. */
+    struct Dwarf_Sibling_Cache_Entry_s *cc_sibling_cache;
+    Dwarf_Unsigned cc_sibling_cache_size;
+    Dwarf_Unsigned cc_sibling_cache_count;
+
+    /*  Read from the CU DIE by _dwarf_lists5_bases() the first
+        time a DWARF5 range or location list of this unit
+        is read.  cc_lists5_low_pc is the default base address
+        of the lists (DW_AT_low_pc, zero if absent), and
+        of .debug_loc lists for dwarf_get_loclist_for_pc_c().
+        The list bases are the offsets of the offset tables
+        in .debug_rnglists and .debug_loclists.  */
+    Dwarf_Bool     cc_lists5_bases_known;
+    Dwarf_Addr     cc_lists5_low_pc;
+    Dwarf_Bool     cc_rnglists_base_present;
+    Dwarf_Unsigned cc_rnglists_base;
+    Dwarf_Bool     cc_loclists_base_present;
+    Dwarf_Unsigned cc_loclists_base;
+    /*  For dwarf_get_variables_at_pc(): per subprogram,
+        where the locations of its variables are.
+        Most recently used first. */
+    struct Dwarf_Var_Loc_Set_s *cc_var_loc_sets;
 };
 
 /*  Consolidates section-specific data in one place.
@@ -354,6 +386,12 @@ struct Dwarf_Section_s {
         Dwarf_Obj_Access_Section_s.  */
     Dwarf_Word  dss_flags;
     Dwarf_Word  dss_addralign;
+
+    /*  For dwarf_get_section_load_stats(). The size before
+        decompression, zero if not compressed, and the
+        relocation records applied. */
+    Dwarf_Unsigned dss_compressed_size;
+    Dwarf_Unsigned dss_relocations_applied;
 };
 
 /*  Overview: if next_to_use== first, no error slots are used.
@@ -700,6 +738,20 @@ struct Dwarf_Debug_s {
 
     struct Dwarf_Tied_Data_s de_tied_data;
 
+    /*  Sibling cache use, over all units.
+        See dwarf_get_sibling_cache_stats(). */
+    Dwarf_Unsigned de_sibling_cache_lookups;
+    Dwarf_Unsigned de_sibling_cache_hits;
+    Dwarf_Unsigned de_sibling_cache_entries;
+
+    /*  Built on first use by dwarf_pc_frames(). */
+    struct Dwarf_Pc_Index_s *de_pc_index;
+    /*  Programs made by dwarf_expr_compile(), a dwarf_tsearch
+        hash keyed by the address of the expression. */
+    void *de_expr_programs;
+
+    /*  See dwarf_get_debug_stats(). */
+    Dwarf_Debug_Stats de_stats;
 };
 
 int dwarf_printf(Dwarf_Debug dbg, const char * format, ...)
@@ -908,6 +960,11 @@ Dwarf_Byte_Ptr _dwarf_calculate_info_section_start_ptr(Dwarf_CU_Context context,
 
 Dwarf_Byte_Ptr _dwarf_calculate_info_section_end_ptr(Dwarf_CU_Context context);
 Dwarf_Byte_Ptr _dwarf_calculate_abbrev_section_end_ptr(Dwarf_CU_Context context);
+void _dwarf_free_die_array(Dwarf_CU_Context context);
+void _dwarf_free_sibling_cache(Dwarf_CU_Context context);
+void _dwarf_free_var_loc_sets(Dwarf_CU_Context context);
+void _dwarf_pc_index_destructor(void *m);
+void _dwarf_expr_programs_destroy(Dwarf_Debug dbg);
 
 void _dwarf_dumpsig(const char *msg, Dwarf_Sig8 *sig,int lineno);
 
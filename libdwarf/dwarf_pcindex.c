@@ -0,0 +1,686 @@
+/*
+
+  Copyright (C) 2018 David Anderson. All Rights Reserved.
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of version 2.1 of the GNU Lesser General Public License
+  as published by the Free Software Foundation.
+
+  This program is distributed in the hope that it would be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  Further, this software is distributed without any warranty that it is
+  free of the rightful claim of any third person regarding infringement
+  or the like.  Any license provided herein, whether implied or
+  otherwise, applies only to this software file.  Patent licenses, if
+  any, provided herein do not apply to combinations of this program with
+  other software, or any other product whatsoever.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program; if not, write the Free Software
+  Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston MA 02110-1301,
+  USA.
+
+*/
+
+/*  An index from pc values to the DW_TAG_subprogram and
+    DW_TAG_inlined_subroutine DIEs whose address ranges
+    contain them, built once per Dwarf_Debug.
+
+    Every such DIE becomes a 'frame' which records
+    the frame of its nearest such ancestor DIE.
+    The address ranges of all frames are then flattened
+    into sorted, non-overlapping segments each naming
+    the innermost frame covering it.  A lookup is then
+    a binary search for the segment followed by the
+    chain of parent frames.  */
+
+#include "config.h"
+#include <stdlib.h>
+#include "dwarf_incl.h"
+
+#define TRUE  1
+#define FALSE 0
+
+#define PC_INDEX_NO_FRAME ((Dwarf_Unsigned)-1)
+
+struct Dwarf_Pc_Index_Frame_s {
+    Dwarf_Off      pf_die_offset;
+    Dwarf_Unsigned pf_parent; /* PC_INDEX_NO_FRAME if outermost. */
+    Dwarf_Unsigned pf_call_file;
+    Dwarf_Unsigned pf_call_line;
+    Dwarf_Unsigned pf_call_column;
+    Dwarf_Half     pf_tag;
+};
+
+/*  Used both for the address ranges of frames
+    (pr_depth meaningful) and for the final segments. */
+struct Dwarf_Pc_Index_Range_s {
+    Dwarf_Addr     pr_low;
+    Dwarf_Addr     pr_high; /* One past the last address. */
+    Dwarf_Unsigned pr_frame;
+    Dwarf_Unsigned pr_depth;
+};
+
+struct Dwarf_Pc_Index_s {
+    struct Dwarf_Pc_Index_Frame_s *pi_frames;
+    Dwarf_Unsigned pi_frame_count;
+    Dwarf_Unsigned pi_frame_alloc;
+
+    /*  While building, the ranges of the frames.
+        Once built, the segments. */
+    struct Dwarf_Pc_Index_Range_s *pi_ranges;
+    Dwarf_Unsigned pi_range_count;
+    Dwarf_Unsigned pi_range_alloc;
+};
+
+void
+_dwarf_pc_index_destructor(void *m)
+{
+    struct Dwarf_Pc_Index_s *pi = (struct Dwarf_Pc_Index_s *)m;
+
+    if (!pi) {
+        return;
+    }
+    free(pi->pi_frames);
+    free(pi->pi_ranges);
+    free(pi);
+}
+
+static int
+add_frame(Dwarf_Debug dbg, struct Dwarf_Pc_Index_s *pi,
+    Dwarf_Unsigned *index_out, Dwarf_Error *error)
+{
+    if (pi->pi_frame_count >= pi->pi_frame_alloc) {
+        Dwarf_Unsigned newcount = pi->pi_frame_alloc?
+            pi->pi_frame_alloc*2: 256;
+        struct Dwarf_Pc_Index_Frame_s *newf = 0;
+
+        newf = (struct Dwarf_Pc_Index_Frame_s *)realloc(pi->pi_frames,
+            newcount*sizeof(*newf));
+        if (!newf) {
+            _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+            return DW_DLV_ERROR;
+        }
+        pi->pi_frames = newf;
+        pi->pi_frame_alloc = newcount;
+    }
+    *index_out = pi->pi_frame_count;
+    memset(pi->pi_frames + pi->pi_frame_count,0,
+        sizeof(struct Dwarf_Pc_Index_Frame_s));
+    pi->pi_frame_count++;
+    return DW_DLV_OK;
+}
+
+static int
+add_range(Dwarf_Debug dbg, struct Dwarf_Pc_Index_s *pi,
+    Dwarf_Addr low, Dwarf_Addr high,
+    Dwarf_Unsigned frame, Dwarf_Unsigned depth,
+    Dwarf_Error *error)
+{
+    struct Dwarf_Pc_Index_Range_s *r = 0;
+
+    /*  Linkers leave discarded functions at address zero. */
+    if (low >= high || low == 0) {
+        return DW_DLV_OK;
+    }
+    if (pi->pi_range_count >= pi->pi_range_alloc) {
+        Dwarf_Unsigned newcount = pi->pi_range_alloc?
+            pi->pi_range_alloc*2: 256;
+        struct Dwarf_Pc_Index_Range_s *newr = 0;
+
+        newr = (struct Dwarf_Pc_Index_Range_s *)realloc(pi->pi_ranges,
+            newcount*sizeof(*newr));
+        if (!newr) {
+            _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+            return DW_DLV_ERROR;
+        }
+        pi->pi_ranges = newr;
+        pi->pi_range_alloc = newcount;
+    }
+    r = pi->pi_ranges + pi->pi_range_count;
+    r->pr_low = low;
+    r->pr_high = high;
+    r->pr_frame = frame;
+    r->pr_depth = depth;
+    pi->pi_range_count++;
+    return DW_DLV_OK;
+}
+
+static int
+get_udata_attr(Dwarf_Die die, Dwarf_Half attrnum,
+    Dwarf_Unsigned *val_out, Dwarf_Error *error)
+{
+    Dwarf_Attribute_Storage astore;
+    Dwarf_Attribute attr = 0;
+    int res = 0;
+
+    res = dwarf_attr_inplace(die,attrnum,&astore,&attr,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    if (attr->ar_attribute_form == DW_FORM_sdata) {
+        /*  A producer may use DW_FORM_sdata for any constant. */
+        Dwarf_Signed sval = 0;
+
+        res = dwarf_formsdata(attr,&sval,error);
+        if (res == DW_DLV_OK) {
+            *val_out = (Dwarf_Unsigned)sval;
+        }
+        return res;
+    }
+    return dwarf_formudata(attr,val_out,error);
+}
+
+/*  Adds the ranges of a DWARF5 DW_AT_ranges list
+    (.debug_rnglists). */
+#define PC_INDEX_LOCAL_RANGES 16
+static int
+add_die_rnglist(Dwarf_Debug dbg, struct Dwarf_Pc_Index_s *pi,
+    Dwarf_Die die, Dwarf_Attribute attr,
+    Dwarf_Unsigned frame, Dwarf_Unsigned depth,
+    Dwarf_Error *error)
+{
+    Dwarf_Rnglist_Range localranges[PC_INDEX_LOCAL_RANGES];
+    Dwarf_Rnglist_Range *ranges = localranges;
+    Dwarf_Off listoff = 0;
+    Dwarf_Unsigned count = 0;
+    Dwarf_Unsigned i = 0;
+    int res = 0;
+
+    res = dwarf_get_rnglist_offset(attr,&listoff,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    res = dwarf_get_rnglist(die,listoff,ranges,
+        PC_INDEX_LOCAL_RANGES,&count,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    if (count > PC_INDEX_LOCAL_RANGES) {
+        ranges = (Dwarf_Rnglist_Range *)malloc(
+            count * sizeof(Dwarf_Rnglist_Range));
+        if (!ranges) {
+            _dwarf_error(dbg,error,DW_DLE_ALLOC_FAIL);
+            return DW_DLV_ERROR;
+        }
+        res = dwarf_get_rnglist(die,listoff,ranges,
+            count,&count,error);
+    }
+    for (i = 0; res == DW_DLV_OK && i < count; ++i) {
+        res = add_range(dbg,pi,ranges[i].drr_lowpc,
+            ranges[i].drr_highpc,frame,depth,error);
+    }
+    if (ranges != localranges) {
+        free(ranges);
+    }
+    return res;
+}
+
+/*  Adds the address ranges of die, from DW_AT_low_pc/DW_AT_high_pc
+    or from DW_AT_ranges (.debug_ranges, or .debug_rnglists
+    in DWARF5).  cu_base is the base address for .debug_ranges
+    entries. */
+static int
+add_die_ranges(Dwarf_Debug dbg, struct Dwarf_Pc_Index_s *pi,
+    Dwarf_Die die, Dwarf_Addr cu_base,
+    Dwarf_Unsigned frame, Dwarf_Unsigned depth,
+    Dwarf_Error *error)
+{
+    Dwarf_Addr low = 0;
+    Dwarf_Addr high = 0;
+    Dwarf_Half highform = 0;
+    enum Dwarf_Form_Class highclass = DW_FORM_CLASS_UNKNOWN;
+    Dwarf_Attribute_Storage astore;
+    Dwarf_Attribute attr = 0;
+    Dwarf_Off rangesoffset = 0;
+    Dwarf_Ranges *ranges = 0;
+    Dwarf_Signed rangecount = 0;
+    Dwarf_Signed i = 0;
+    Dwarf_Addr base = cu_base;
+    int res = 0;
+
+    res = dwarf_lowpc(die,&low,error);
+    if (res == DW_DLV_ERROR) {
+        return res;
+    }
+    if (res == DW_DLV_OK) {
+        res = dwarf_highpc_b(die,&high,&highform,&highclass,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        if (highclass == DW_FORM_CLASS_CONSTANT) {
+            high += low;
+        }
+        return add_range(dbg,pi,low,high,frame,depth,error);
+    }
+    res = dwarf_attr_inplace(die,DW_AT_ranges,&astore,&attr,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    if (die->di_cu_context->cc_version_stamp >= DW_CU_VERSION5 ||
+        attr->ar_attribute_form == DW_FORM_rnglistx) {
+        return add_die_rnglist(dbg,pi,die,attr,frame,depth,error);
+    }
+    res = dwarf_global_formref(attr,&rangesoffset,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    res = dwarf_get_ranges_a(dbg,rangesoffset,die,
+        &ranges,&rangecount,0,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    for (i = 0; i < rangecount; ++i) {
+        Dwarf_Ranges *r = ranges + i;
+
+        if (r->dwr_type == DW_RANGES_END) {
+            break;
+        }
+        if (r->dwr_type == DW_RANGES_ADDRESS_SELECTION) {
+            base = r->dwr_addr2;
+            continue;
+        }
+        res = add_range(dbg,pi,base + r->dwr_addr1,
+            base + r->dwr_addr2,frame,depth,error);
+        if (res != DW_DLV_OK) {
+            dwarf_ranges_dealloc(dbg,ranges,rangecount);
+            return res;
+        }
+    }
+    dwarf_ranges_dealloc(dbg,ranges,rangecount);
+    return DW_DLV_OK;
+}
+
+/*  Records the frames of one unit, using the DIE array of
+    the unit for the parent links. */
+static int
+add_unit_frames(Dwarf_Debug dbg, struct Dwarf_Pc_Index_s *pi,
+    Dwarf_Die cu_die, Dwarf_Error *error)
+{
+    Dwarf_Unsigned die_count = 0;
+    Dwarf_Unsigned i = 0;
+    Dwarf_Unsigned *frame_of = 0;
+    Dwarf_Addr cu_base = 0;
+    Dwarf_Bool had_array = FALSE;
+    int res = 0;
+
+    had_array = cu_die->di_cu_context->cc_die_array != 0;
+    res = dwarf_die_array_build(cu_die,&die_count,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    res = dwarf_lowpc(cu_die,&cu_base,error);
+    if (res == DW_DLV_ERROR) {
+        return res;
+    }
+
+    /*  frame_of[i] is the frame of DIE i or of its nearest
+        ancestor having one. */
+    frame_of = (Dwarf_Unsigned *)malloc(die_count*sizeof(*frame_of));
+    if (!frame_of) {
+        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+        return DW_DLV_ERROR;
+    }
+    for (i = 0; i < die_count; ++i) {
+        Dwarf_Off offset = 0;
+        Dwarf_Half tag = 0;
+        Dwarf_Unsigned depth = 0;
+        Dwarf_Unsigned parent = 0;
+        Dwarf_Unsigned outer = PC_INDEX_NO_FRAME;
+        Dwarf_Unsigned frame = 0;
+        struct Dwarf_Pc_Index_Frame_s *f = 0;
+        Dwarf_Die_Storage dstore;
+        Dwarf_Die die = 0;
+
+        res = dwarf_die_array_entry(cu_die,i,&offset,&tag,&depth,error);
+        if (res != DW_DLV_OK) {
+            break;
+        }
+        res = dwarf_die_array_parent(cu_die,i,&parent,error);
+        if (res == DW_DLV_ERROR) {
+            break;
+        }
+        if (res == DW_DLV_OK) {
+            outer = frame_of[parent];
+        }
+        frame_of[i] = outer;
+        if (tag != DW_TAG_subprogram &&
+            tag != DW_TAG_inlined_subroutine) {
+            continue;
+        }
+        res = add_frame(dbg,pi,&frame,error);
+        if (res != DW_DLV_OK) {
+            break;
+        }
+        frame_of[i] = frame;
+        f = pi->pi_frames + frame;
+        f->pf_die_offset = offset;
+        f->pf_parent = outer;
+        f->pf_tag = tag;
+        res = dwarf_die_array_die_inplace(cu_die,i,&dstore,&die,error);
+        if (res != DW_DLV_OK) {
+            break;
+        }
+        if (tag == DW_TAG_inlined_subroutine) {
+            /*  Each is optional: a missing one leaves
+                the others to be read. */
+            res = get_udata_attr(die,DW_AT_call_file,
+                &f->pf_call_file,error);
+            if (res == DW_DLV_ERROR) {
+                break;
+            }
+            res = get_udata_attr(die,DW_AT_call_line,
+                &f->pf_call_line,error);
+            if (res == DW_DLV_ERROR) {
+                break;
+            }
+            res = get_udata_attr(die,DW_AT_call_column,
+                &f->pf_call_column,error);
+            if (res == DW_DLV_ERROR) {
+                break;
+            }
+        }
+        res = add_die_ranges(dbg,pi,die,cu_base,frame,depth,error);
+        if (res == DW_DLV_ERROR) {
+            break;
+        }
+        res = DW_DLV_OK;
+    }
+    free(frame_of);
+    if (!had_array) {
+        Dwarf_Error freeerr = 0;
+
+        dwarf_die_array_free(cu_die,&freeerr);
+    }
+    if (res == DW_DLV_ERROR) {
+        return res;
+    }
+    return DW_DLV_OK;
+}
+
+/*  Lowest start first. For equal starts the longest first
+    and, for equal ranges, the outermost first, so the
+    innermost is pushed last when flattening. */
+static int
+range_compare(const void *l, const void *r)
+{
+    const struct Dwarf_Pc_Index_Range_s *lr =
+        (const struct Dwarf_Pc_Index_Range_s *)l;
+    const struct Dwarf_Pc_Index_Range_s *rr =
+        (const struct Dwarf_Pc_Index_Range_s *)r;
+
+    if (lr->pr_low != rr->pr_low) {
+        return (lr->pr_low < rr->pr_low)? -1: 1;
+    }
+    if (lr->pr_high != rr->pr_high) {
+        return (lr->pr_high > rr->pr_high)? -1: 1;
+    }
+    if (lr->pr_depth != rr->pr_depth) {
+        return (lr->pr_depth < rr->pr_depth)? -1: 1;
+    }
+    return 0;
+}
+
+/*  Appends segment [low,high) for frame to segs,
+    joining it to the previous one when possible.
+    segs has room: there are fewer than two segments
+    per range. */
+static void
+emit_segment(struct Dwarf_Pc_Index_Range_s *segs,
+    Dwarf_Unsigned *segcount,
+    Dwarf_Addr low, Dwarf_Addr high, Dwarf_Unsigned frame)
+{
+    struct Dwarf_Pc_Index_Range_s *last = 0;
+
+    if (low >= high) {
+        return;
+    }
+    if (*segcount) {
+        last = segs + *segcount - 1;
+        if (last->pr_frame == frame && last->pr_high == low) {
+            last->pr_high = high;
+            return;
+        }
+    }
+    last = segs + *segcount;
+    last->pr_low = low;
+    last->pr_high = high;
+    last->pr_frame = frame;
+    last->pr_depth = 0;
+    (*segcount)++;
+}
+
+/*  Turns the sorted, nested ranges into non-overlapping
+    segments, each naming the innermost frame.
+    A range overlapping the end of the range it starts in
+    (not properly nested: bad DWARF or folded functions)
+    is clipped to it. */
+static int
+flatten_ranges(Dwarf_Debug dbg, struct Dwarf_Pc_Index_s *pi,
+    Dwarf_Error *error)
+{
+    struct Dwarf_Pc_Index_Range_s *ranges = pi->pi_ranges;
+    Dwarf_Unsigned count = pi->pi_range_count;
+    struct Dwarf_Pc_Index_Range_s *segs = 0;
+    Dwarf_Unsigned segcount = 0;
+    struct Dwarf_Pc_Index_Range_s **stack = 0;
+    Dwarf_Unsigned top = 0;
+    Dwarf_Addr pos = 0;
+    Dwarf_Unsigned i = 0;
+
+    if (!count) {
+        return DW_DLV_OK;
+    }
+    qsort(ranges,count,sizeof(*ranges),range_compare);
+    segs = (struct Dwarf_Pc_Index_Range_s *)
+        malloc(2*count*sizeof(*segs));
+    stack = (struct Dwarf_Pc_Index_Range_s **)
+        malloc(count*sizeof(*stack));
+    if (!segs || !stack) {
+        free(segs);
+        free(stack);
+        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+        return DW_DLV_ERROR;
+    }
+    for (i = 0; i < count; ++i) {
+        struct Dwarf_Pc_Index_Range_s *r = ranges + i;
+
+        while (top && stack[top-1]->pr_high <= r->pr_low) {
+            struct Dwarf_Pc_Index_Range_s *done = stack[--top];
+
+            emit_segment(segs,&segcount,pos,done->pr_high,
+                done->pr_frame);
+            if (pos < done->pr_high) {
+                pos = done->pr_high;
+            }
+        }
+        if (top) {
+            struct Dwarf_Pc_Index_Range_s *outer = stack[top-1];
+
+            emit_segment(segs,&segcount,pos,r->pr_low,outer->pr_frame);
+            if (r->pr_high > outer->pr_high) {
+                r->pr_high = outer->pr_high;
+            }
+        }
+        pos = r->pr_low;
+        stack[top++] = r;
+    }
+    while (top) {
+        struct Dwarf_Pc_Index_Range_s *done = stack[--top];
+
+        emit_segment(segs,&segcount,pos,done->pr_high,done->pr_frame);
+        if (pos < done->pr_high) {
+            pos = done->pr_high;
+        }
+    }
+    free(stack);
+    free(pi->pi_ranges);
+    pi->pi_ranges = segs;
+    pi->pi_range_count = segcount;
+    pi->pi_range_alloc = 2*count;
+    return DW_DLV_OK;
+}
+
+/*  Walks every unit of .debug_info by header offset,
+    so the dwarf_next_cu_header() position of the caller
+    is not disturbed. */
+static int
+build_pc_index(Dwarf_Debug dbg, struct Dwarf_Pc_Index_s *pi,
+    Dwarf_Error *error)
+{
+    Dwarf_Off cu_offset = 0;
+    Dwarf_Unsigned section_size = 0;
+    int res = 0;
+
+    res = _dwarf_load_debug_info(dbg,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    section_size = dbg->de_debug_info.dss_size;
+    while (cu_offset < section_size) {
+        Dwarf_Off die_offset = 0;
+        Dwarf_Die_Storage cu_store;
+        Dwarf_Die cu_die = 0;
+        Dwarf_CU_Context context = 0;
+
+        res = dwarf_get_cu_die_offset_given_cu_header_offset_b(dbg,
+            cu_offset,TRUE,&die_offset,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        res = dwarf_offdie_inplace(dbg,die_offset,TRUE,
+            &cu_store,&cu_die,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        res = add_unit_frames(dbg,pi,cu_die,error);
+        if (res == DW_DLV_ERROR) {
+            return res;
+        }
+        context = cu_die->di_cu_context;
+        cu_offset = context->cc_debug_offset + context->cc_length +
+            context->cc_length_size + context->cc_extension_size;
+    }
+    return flatten_ranges(dbg,pi,error);
+}
+
+/*  New 2018.
+    Builds the pc index of dbg if not yet built
+    and returns the number of address segments in it. */
+int
+dwarf_pc_index_build(Dwarf_Debug dbg,
+    Dwarf_Unsigned * segment_count,
+    Dwarf_Error * error)
+{
+    struct Dwarf_Pc_Index_s *pi = 0;
+    int res = 0;
+
+    if (dbg == NULL) {
+        _dwarf_error(NULL, error, DW_DLE_DBG_NULL);
+        return (DW_DLV_ERROR);
+    }
+    if (dbg->de_pc_index) {
+        *segment_count = dbg->de_pc_index->pi_range_count;
+        return DW_DLV_OK;
+    }
+    pi = (struct Dwarf_Pc_Index_s *)calloc(1,sizeof(*pi));
+    if (!pi) {
+        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+        return DW_DLV_ERROR;
+    }
+    res = build_pc_index(dbg,pi,error);
+    if (res == DW_DLV_ERROR) {
+        _dwarf_pc_index_destructor(pi);
+        return res;
+    }
+    dbg->de_pc_index = pi;
+    *segment_count = pi->pi_range_count;
+    return DW_DLV_OK;
+}
+
+/*  New 2018. */
+void
+dwarf_pc_index_free(Dwarf_Debug dbg)
+{
+    if (!dbg) {
+        return;
+    }
+    _dwarf_pc_index_destructor(dbg->de_pc_index);
+    dbg->de_pc_index = 0;
+}
+
+/*  New 2018.
+    Fills frames[] with the frames containing pc,
+    innermost first: frames[0] is the deepest
+    DW_TAG_inlined_subroutine (or the DW_TAG_subprogram
+    if nothing is inlined at pc) and the last is the
+    outermost DW_TAG_subprogram.
+    *frames_count is the length of the whole chain even if
+    more than frames_max, in which case only the
+    innermost frames_max are returned.
+    Returns DW_DLV_NO_ENTRY if no function contains pc. */
+int
+dwarf_pc_frames(Dwarf_Debug dbg,
+    Dwarf_Addr pc,
+    Dwarf_Pc_Frame * frames,
+    Dwarf_Unsigned frames_max,
+    Dwarf_Unsigned * frames_count,
+    Dwarf_Error * error)
+{
+    struct Dwarf_Pc_Index_s *pi = 0;
+    struct Dwarf_Pc_Index_Range_s *segs = 0;
+    Dwarf_Unsigned low = 0;
+    Dwarf_Unsigned high = 0;
+    Dwarf_Unsigned frame = 0;
+    Dwarf_Unsigned count = 0;
+    int res = 0;
+
+    if (dbg == NULL) {
+        _dwarf_error(NULL, error, DW_DLE_DBG_NULL);
+        return (DW_DLV_ERROR);
+    }
+    if (!dbg->de_pc_index) {
+        Dwarf_Unsigned segcount = 0;
+
+        res = dwarf_pc_index_build(dbg,&segcount,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+    }
+    pi = dbg->de_pc_index;
+    segs = pi->pi_ranges;
+
+    /*  Find the first segment ending after pc. */
+    high = pi->pi_range_count;
+    while (low < high) {
+        Dwarf_Unsigned mid = low + (high - low)/2;
+
+        if (segs[mid].pr_high <= pc) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low >= pi->pi_range_count || segs[low].pr_low > pc) {
+        return DW_DLV_NO_ENTRY;
+    }
+    for (frame = segs[low].pr_frame; frame != PC_INDEX_NO_FRAME;
+        frame = pi->pi_frames[frame].pf_parent) {
+        struct Dwarf_Pc_Index_Frame_s *f = pi->pi_frames + frame;
+
+        if (count < frames_max) {
+            Dwarf_Pc_Frame *out = frames + count;
+
+            out->dpf_die_offset = f->pf_die_offset;
+            out->dpf_tag = f->pf_tag;
+            out->dpf_call_file = f->pf_call_file;
+            out->dpf_call_line = f->pf_call_line;
+            out->dpf_call_column = f->pf_call_column;
+        }
+        ++count;
+    }
+    *frames_count = count;
+    return DW_DLV_OK;
+}
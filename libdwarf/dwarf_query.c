@@ -206,7 +206,67 @@ dwarf_tag(Dwarf_Die die, Dwarf_Half * tag, Dwarf_Error * error)
     return DW_DLV_OK;
 }
 
-/* Returns the children offsets for the given offset */
+/*  dwarf_offset_list() for a unit with a DIE array
+    (see dwarf_die_array_build()): nothing is decoded. */
+static int
+_dwarf_offset_list_from_array(Dwarf_Debug dbg,
+    Dwarf_Die die,
+    Dwarf_Off **offbuf, Dwarf_Unsigned *offcnt, Dwarf_Error * error)
+{
+    Dwarf_Unsigned index = 0;
+    Dwarf_Unsigned kid = 0;
+    Dwarf_Unsigned first_kid = 0;
+    Dwarf_Unsigned off_count = 0;
+    Dwarf_Unsigned i = 0;
+    Dwarf_Off *ret_offsets = 0;
+    int res = 0;
+
+    res = dwarf_die_array_index(die,&index,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    res = dwarf_die_array_child(die,index,&first_kid,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    kid = first_kid;
+    for (;;) {
+        ++off_count;
+        res = dwarf_die_array_sibling(die,kid,&kid,error);
+        if (res == DW_DLV_ERROR) {
+            return res;
+        }
+        if (res == DW_DLV_NO_ENTRY) {
+            break;
+        }
+    }
+    ret_offsets = (Dwarf_Off *) _dwarf_get_alloc(dbg, DW_DLA_ADDR, off_count);
+    if (ret_offsets == NULL) {
+        _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
+        return (DW_DLV_ERROR);
+    }
+    kid = first_kid;
+    for (i = 0; i < off_count; i++) {
+        Dwarf_Half tag = 0;
+        Dwarf_Unsigned depth = 0;
+
+        res = dwarf_die_array_entry(die,kid,ret_offsets+i,
+            &tag,&depth,error);
+        if (res != DW_DLV_OK) {
+            dwarf_dealloc(dbg,ret_offsets,DW_DLA_ADDR);
+            return res;
+        }
+        /*  DW_DLV_NO_ENTRY only after the last one. */
+        dwarf_die_array_sibling(die,kid,&kid,error);
+    }
+    *offbuf = ret_offsets;
+    *offcnt = off_count;
+    return DW_DLV_OK;
+}
+
+/*  Returns the children offsets for the given offset.
+    If the unit has a DIE array (dwarf_die_array_build())
+    it is used instead of reading the DIEs. */
 int
 dwarf_offset_list(Dwarf_Debug dbg,
     Dwarf_Off offset, Dwarf_Bool is_info,
@@ -238,6 +298,11 @@ dwarf_offset_list(Dwarf_Debug dbg,
     if (DW_DLV_OK != res) {
         return res;
     }
+    if (die->di_cu_context->cc_die_array) {
+        res = _dwarf_offset_list_from_array(dbg,die,offbuf,offcnt,error);
+        dwarf_dealloc(dbg,die,DW_DLA_DIE);
+        return res;
+    }
 
     /* Get first child for die */
     res = dwarf_child(die,&child,error);
@@ -620,20 +685,23 @@ dwarf_hasattr(Dwarf_Die die,
     return DW_DLV_OK;
 }
 
-int
-dwarf_attr(Dwarf_Die die,
+/*  Dwarf_Attribute_Storage (libdwarf.h) must be able to hold
+    a struct Dwarf_Attribute_s: this fails to compile if not. */
+typedef char dwarf_attribute_storage_check[
+    (sizeof(Dwarf_Attribute_Storage) >=
+    sizeof(struct Dwarf_Attribute_s))? 1: -1];
+
+static int
+_dwarf_attr_internal(Dwarf_Die die,
     Dwarf_Half attr,
-    Dwarf_Attribute * ret_attr, Dwarf_Error * error)
+    Dwarf_Attribute attrib,
+    Dwarf_Error * error)
 {
     Dwarf_Half attr_form = 0;
-    Dwarf_Attribute attrib = 0;
     Dwarf_Byte_Ptr info_ptr = 0;
-    Dwarf_Debug dbg = 0;
     int res = 0;
 
     CHECK_DIE(die, DW_DLV_ERROR);
-    dbg = die->di_cu_context->cc_dbg;
-
     res = _dwarf_get_value_ptr(die, attr, &attr_form,&info_ptr,error);
     if(res == DW_DLV_ERROR) {
         return res;
@@ -641,24 +709,63 @@ dwarf_attr(Dwarf_Die die,
     if(res == DW_DLV_NO_ENTRY) {
         return res;
     }
+    memset(attrib,0,sizeof(*attrib));
+    attrib->ar_attribute = attr;
+    attrib->ar_attribute_form = attr_form;
+    attrib->ar_attribute_form_direct = attr_form;
+    attrib->ar_cu_context = die->di_cu_context;
+    attrib->ar_debug_ptr = info_ptr;
+    attrib->ar_die = die;
+    return DW_DLV_OK;
+}
 
+int
+dwarf_attr(Dwarf_Die die,
+    Dwarf_Half attr,
+    Dwarf_Attribute * ret_attr, Dwarf_Error * error)
+{
+    struct Dwarf_Attribute_s sattr;
+    Dwarf_Attribute attrib = 0;
+    Dwarf_Debug dbg = 0;
+    int res = 0;
 
+    res = _dwarf_attr_internal(die,attr,&sattr,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    dbg = die->di_cu_context->cc_dbg;
     attrib = (Dwarf_Attribute) _dwarf_get_alloc(dbg, DW_DLA_ATTR, 1);
     if (attrib == NULL) {
         _dwarf_error(dbg, error, DW_DLE_ALLOC_FAIL);
         return (DW_DLV_ERROR);
     }
-
-    attrib->ar_attribute = attr;
-    attrib->ar_attribute_form = attr_form;
-    attrib->ar_attribute_form_direct = attr_form;
-    attrib->ar_cu_context = die->di_cu_context;
-    attrib->ar_debug_ptr = info_ptr;
-    attrib->ar_die = die;
+    *attrib = sattr;
     *ret_attr = (attrib);
     return DW_DLV_OK;
 }
 
+/*  As dwarf_attr() but the attribute is put in storage
+    owned by the caller: nothing is allocated.
+    The attribute refers to die, so die must
+    stay valid while the attribute is used. */
+int
+dwarf_attr_inplace(Dwarf_Die die,
+    Dwarf_Half attr,
+    Dwarf_Attribute_Storage * storage,
+    Dwarf_Attribute * ret_attr, Dwarf_Error * error)
+{
+    struct Dwarf_Attribute_s sattr;
+    int res = 0;
+
+    res = _dwarf_attr_internal(die,attr,&sattr,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    memcpy(storage,&sattr,sizeof(sattr));
+    *ret_attr = (Dwarf_Attribute)storage;
+    return DW_DLV_OK;
+}
+
 /*  A DWP (.dwp) package object never contains .debug_addr,
     only a normal .o or executable object.
     Error returned here is on dbg, not tieddbg. */
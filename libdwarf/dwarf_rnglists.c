@@ -0,0 +1,213 @@
+/*
+
+  Copyright (C) 2018 David Anderson. All Rights Reserved.
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of version 2.1 of the GNU Lesser General Public License
+  as published by the Free Software Foundation.
+
+  This program is distributed in the hope that it would be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  Further, this software is distributed without any warranty that it is
+  free of the rightful claim of any third person regarding infringement
+  or the like.  Any license provided herein, whether implied or
+  otherwise, applies only to this software file.  Patent licenses, if
+  any, provided herein do not apply to combinations of this program with
+  other software, or any other product whatsoever.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program; if not, write the Free Software
+  Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston MA 02110-1301,
+  USA.
+
+*/
+
+/*  DWARF5 range lists, .debug_rnglists.
+    A list is decoded straight into the caller's array:
+    base address entries and .debug_addr indices are
+    applied as the entries are read, so nothing is allocated.
+    DW_FORM_rnglistx indexes are turned into list offsets
+    through the offsets table following the header of the
+    unit's table, see _dwarf_lists5_offset_from_index().  */
+
+#include "config.h"
+#include "dwarf_incl.h"
+
+/*  New 2018. */
+int
+dwarf_get_rnglist_offset(Dwarf_Attribute attr,
+    Dwarf_Off *offset_out,
+    Dwarf_Error *error)
+{
+    Dwarf_CU_Context context = 0;
+    Dwarf_Debug dbg = 0;
+    Dwarf_Unsigned index = 0;
+    Dwarf_Unsigned offset = 0;
+    Dwarf_Byte_Ptr info_end = 0;
+    Dwarf_Byte_Ptr info_ptr = 0;
+    int res = 0;
+
+    if (attr == NULL) {
+        _dwarf_error(NULL, error, DW_DLE_ATTR_NULL);
+        return DW_DLV_ERROR;
+    }
+    context = attr->ar_cu_context;
+    dbg = context->cc_dbg;
+    if (attr->ar_attribute_form != DW_FORM_rnglistx) {
+        Dwarf_Off secoff = 0;
+
+        res = dwarf_global_formref(attr,&secoff,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        *offset_out = secoff;
+        return DW_DLV_OK;
+    }
+    info_ptr = attr->ar_debug_ptr;
+    info_end = _dwarf_calculate_info_section_end_ptr(context);
+    DECODE_LEB128_UWORD_CK(info_ptr,index,dbg,error,info_end);
+    res = _dwarf_lists5_bases(context,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    res = _dwarf_load_section(dbg,&dbg->de_debug_rnglists,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    res = _dwarf_lists5_offset_from_index(context,
+        &dbg->de_debug_rnglists,
+        context->cc_rnglists_base_present,
+        context->cc_rnglists_base,
+        index,&offset,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    *offset_out = offset;
+    return DW_DLV_OK;
+}
+
+/*  New 2018. */
+int
+dwarf_get_rnglist(Dwarf_Die die,
+    Dwarf_Off offset,
+    Dwarf_Rnglist_Range *ranges,
+    Dwarf_Unsigned ranges_max,
+    Dwarf_Unsigned *ranges_count,
+    Dwarf_Error *error)
+{
+    Dwarf_CU_Context context = 0;
+    Dwarf_Debug dbg = 0;
+    Dwarf_Small *ptr = 0;
+    Dwarf_Small *secend = 0;
+    Dwarf_Half address_size = 0;
+    Dwarf_Addr base = 0;
+    Dwarf_Unsigned count = 0;
+    int res = 0;
+
+    CHECK_DIE(die, DW_DLV_ERROR);
+    context = die->di_cu_context;
+    dbg = context->cc_dbg;
+    address_size = context->cc_address_size;
+    res = _dwarf_load_section(dbg,&dbg->de_debug_rnglists,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    if (offset >= dbg->de_debug_rnglists.dss_size) {
+        _dwarf_error(dbg,error,DW_DLE_RNGLISTS_ERROR);
+        return DW_DLV_ERROR;
+    }
+    res = _dwarf_lists5_bases(context,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    base = context->cc_lists5_low_pc;
+    ptr = dbg->de_debug_rnglists.dss_data + offset;
+    secend = dbg->de_debug_rnglists.dss_data +
+        dbg->de_debug_rnglists.dss_size;
+    for (;;) {
+        Dwarf_Small code = 0;
+        Dwarf_Unsigned v1 = 0;
+        Dwarf_Unsigned v2 = 0;
+        Dwarf_Addr low = 0;
+        Dwarf_Addr high = 0;
+
+        if (ptr >= secend) {
+            _dwarf_error(dbg,error,DW_DLE_RNGLISTS_ERROR);
+            return DW_DLV_ERROR;
+        }
+        code = *ptr++;
+        switch(code) {
+        case DW_RLE_end_of_list:
+            *ranges_count = count;
+            return DW_DLV_OK;
+        case DW_RLE_base_addressx:
+            DECODE_LEB128_UWORD_CK(ptr,v1,dbg,error,secend);
+            res = _dwarf_extract_address_from_debug_addr(dbg,
+                context,v1,&base,error);
+            if (res != DW_DLV_OK) {
+                return res;
+            }
+            continue;
+        case DW_RLE_startx_endx:
+            DECODE_LEB128_UWORD_CK(ptr,v1,dbg,error,secend);
+            DECODE_LEB128_UWORD_CK(ptr,v2,dbg,error,secend);
+            res = _dwarf_extract_address_from_debug_addr(dbg,
+                context,v1,&low,error);
+            if (res != DW_DLV_OK) {
+                return res;
+            }
+            res = _dwarf_extract_address_from_debug_addr(dbg,
+                context,v2,&high,error);
+            if (res != DW_DLV_OK) {
+                return res;
+            }
+            break;
+        case DW_RLE_startx_length:
+            DECODE_LEB128_UWORD_CK(ptr,v1,dbg,error,secend);
+            DECODE_LEB128_UWORD_CK(ptr,v2,dbg,error,secend);
+            res = _dwarf_extract_address_from_debug_addr(dbg,
+                context,v1,&low,error);
+            if (res != DW_DLV_OK) {
+                return res;
+            }
+            high = low + v2;
+            break;
+        case DW_RLE_offset_pair:
+            DECODE_LEB128_UWORD_CK(ptr,v1,dbg,error,secend);
+            DECODE_LEB128_UWORD_CK(ptr,v2,dbg,error,secend);
+            low = base + v1;
+            high = base + v2;
+            break;
+        case DW_RLE_base_address:
+            READ_UNALIGNED_CK(dbg,base,Dwarf_Addr,
+                ptr,address_size,error,secend);
+            ptr += address_size;
+            continue;
+        case DW_RLE_start_end:
+            READ_UNALIGNED_CK(dbg,low,Dwarf_Addr,
+                ptr,address_size,error,secend);
+            ptr += address_size;
+            READ_UNALIGNED_CK(dbg,high,Dwarf_Addr,
+                ptr,address_size,error,secend);
+            ptr += address_size;
+            break;
+        case DW_RLE_start_length:
+            READ_UNALIGNED_CK(dbg,low,Dwarf_Addr,
+                ptr,address_size,error,secend);
+            ptr += address_size;
+            DECODE_LEB128_UWORD_CK(ptr,v2,dbg,error,secend);
+            high = low + v2;
+            break;
+        default:
+            _dwarf_error(dbg,error,DW_DLE_RNGLISTS_ERROR);
+            return DW_DLV_ERROR;
+        }
+        if (count < ranges_max) {
+            ranges[count].drr_lowpc = low;
+            ranges[count].drr_highpc = high;
+        }
+        count++;
+    }
+}
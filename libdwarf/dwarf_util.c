@@ -382,7 +382,9 @@ _dwarf_get_size_of_val(Dwarf_Debug dbg,
     case DW_FORM_addrx:
     case DW_FORM_GNU_addr_index:
     case DW_FORM_strx:
-    case DW_FORM_GNU_str_index: {
+    case DW_FORM_GNU_str_index:
+    case DW_FORM_loclistx:
+    case DW_FORM_rnglistx: {
         UNUSEDARG Dwarf_Unsigned v = 0;
 
         DECODE_LEB128_UWORD_LEN_CK(val_ptr,v,leb128_length,
@@ -463,6 +465,10 @@ _dwarf_valid_form_we_know(UNUSEDARG Dwarf_Debug dbg,
     if (at_form <= DW_FORM_ref_sig8) {
         return TRUE;
     }
+    if (at_form == DW_FORM_loclistx ||
+        at_form == DW_FORM_rnglistx) {
+        return TRUE;
+    }
     if (at_form == DW_FORM_GNU_addr_index ||
         at_form == DW_FORM_GNU_str_index  ||
         at_form == DW_FORM_GNU_ref_alt ||
@@ -472,6 +478,11 @@ _dwarf_valid_form_we_know(UNUSEDARG Dwarf_Debug dbg,
     return FALSE;
 }
 
+/*  Number of LEB128 values (name/form pairs times two)
+    _dwarf_get_abbrev_for_code() decodes per call of
+    _dwarf_decode_u_leb128_pairs(). */
+#define ABBREV_PAIR_BATCH 32
+
 /*  This function returns a pointer to a Dwarf_Abbrev_List_s
     struct for the abbrev with the given code.  It puts the
     struct on the appropriate hash table.  It also adds all
@@ -572,8 +583,10 @@ _dwarf_get_abbrev_for_code(Dwarf_CU_Context cu_context, Dwarf_Unsigned code,
         /*  This returns a pointer to an abbrev list entry, not
             the list itself. */
         *list_out = hash_abbrev_entry;
+        dbg->de_stats.ds_abbrev_hits++;
         return DW_DLV_OK;
     }
+    dbg->de_stats.ds_abbrev_misses++;
 
     if (cu_context->cc_last_abbrev_ptr) {
         abbrev_ptr = cu_context->cc_last_abbrev_ptr;
@@ -657,18 +670,37 @@ _dwarf_get_abbrev_for_code(Dwarf_CU_Context cu_context, Dwarf_Unsigned code,
         hash_table_base->tb_total_abbrev_count++;
 
         /*  Cycle thru the abbrev content, ignoring the content except
-            to find the end of the content. */
-        do {
-            DECODE_LEB128_UWORD_CK(abbrev_ptr, attr_name,
-                dbg,error,end_abbrev_ptr);
-            DECODE_LEB128_UWORD_CK(abbrev_ptr, attr_form,
-                dbg,error,end_abbrev_ptr);
-            if (!_dwarf_valid_form_we_know(dbg,attr_form,attr_name)) {
-                _dwarf_error(dbg,error,DW_DLE_UNKNOWN_FORM);
+            to find the end of the content. The name/form pairs
+            are decoded a batch at a time. */
+        for (;;) {
+            Dwarf_Unsigned pairvals[ABBREV_PAIR_BATCH];
+            Dwarf_Unsigned nvals = 0;
+            Dwarf_Unsigned i = 0;
+            Dwarf_Word pairslen = 0;
+            int pres = 0;
+
+            pres = _dwarf_decode_u_leb128_pairs(abbrev_ptr,
+                end_abbrev_ptr,pairvals,ABBREV_PAIR_BATCH,
+                &nvals,&pairslen);
+            abbrev_ptr += pairslen;
+            for (i = 0; i+1 < nvals; i += 2) {
+                attr_name = pairvals[i];
+                attr_form = pairvals[i+1];
+                if (!_dwarf_valid_form_we_know(dbg,attr_form,
+                    attr_name)) {
+                    _dwarf_error(dbg,error,DW_DLE_UNKNOWN_FORM);
+                    return DW_DLV_ERROR;
+                }
+                atcount++;
+            }
+            if (pres == DW_DLV_ERROR) {
+                _dwarf_error(dbg, error, DW_DLE_LEB_IMPROPER);
                 return DW_DLV_ERROR;
             }
-            atcount++;
-        } while (attr_name != 0 && attr_form != 0);
+            if (pres == DW_DLV_OK) {
+                break;
+            }
+        }
         /*  We counted one too high, by counting the NUL
             byte pair at end of list. So decrement. */
         inner_list_entry->abl_count = atcount-1;
@@ -833,15 +865,30 @@ _dwarf_length_of_cu_header(Dwarf_Debug dbg,
     Dwarf_Half version = 0;
     Dwarf_Unsigned length = 0;
     Dwarf_Unsigned final_size = 0;
-    Dwarf_Small *section_start =
-        is_info? dbg->de_debug_info.dss_data:
-            dbg->de_debug_types.dss_data;
-    Dwarf_Small *cuptr = section_start + offset;
-    Dwarf_Unsigned section_length =
-        is_info? dbg->de_debug_info.dss_size:
-            dbg->de_debug_types.dss_size;
-    Dwarf_Small * section_end_ptr =
-        section_start + section_length;
+    Dwarf_Small *section_start = 0;
+    Dwarf_Small *cuptr = 0;
+    Dwarf_Unsigned section_length = 0;
+    Dwarf_Small * section_end_ptr = 0;
+    int res = 0;
+
+    /*  Callers such as
+        dwarf_get_cu_die_offset_given_cu_header_offset_b()
+        may get here before anything loaded the section. */
+    res = is_info? _dwarf_load_debug_info(dbg,error):
+        _dwarf_load_debug_types(dbg,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    section_start = is_info? dbg->de_debug_info.dss_data:
+        dbg->de_debug_types.dss_data;
+    section_length = is_info? dbg->de_debug_info.dss_size:
+        dbg->de_debug_types.dss_size;
+    if (offset >= section_length) {
+        _dwarf_error(dbg, error, DW_DLE_OFFSET_BAD);
+        return DW_DLV_ERROR;
+    }
+    cuptr = section_start + offset;
+    section_end_ptr = section_start + section_length;
 
     READ_AREA_LENGTH_CK(dbg, length, Dwarf_Unsigned,
         cuptr, local_length_size, local_extension_size,
@@ -1266,8 +1313,132 @@ _dwarf_what_section_are_we(Dwarf_Debug dbg,
     FINDSEC(&dbg->de_debug_frame_eh_gnu,
         our_pointer, section_name_out,
         sec_start_ptr_out, sec_len_out, sec_end_ptr_out);
+    FINDSEC(&dbg->de_debug_loclists,
+        our_pointer, section_name_out,
+        sec_start_ptr_out, sec_len_out, sec_end_ptr_out);
     return DW_DLV_NO_ENTRY;
 }
 
 
 
+
+/*  New 2018. Reads, once per unit, what DWARF5 range and
+    location lists need from the CU DIE: the default base
+    address (DW_AT_low_pc) and the DW_AT_rnglists_base and
+    DW_AT_loclists_base offsets.  */
+int
+_dwarf_lists5_bases(Dwarf_CU_Context context,
+    Dwarf_Error *error)
+{
+    Dwarf_Debug dbg = context->cc_dbg;
+    Dwarf_Die_Storage diestore;
+    Dwarf_Attribute_Storage attrstore;
+    Dwarf_Die cudie = 0;
+    Dwarf_Attribute attr = 0;
+    Dwarf_Off cudieoff = 0;
+    Dwarf_Off base = 0;
+    Dwarf_Addr lowpc = 0;
+    int res = 0;
+
+    if (context->cc_lists5_bases_known) {
+        return DW_DLV_OK;
+    }
+    res = dwarf_get_cu_die_offset_given_cu_header_offset_b(dbg,
+        context->cc_debug_offset,context->cc_is_info,
+        &cudieoff,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    res = dwarf_offdie_inplace(dbg,cudieoff,context->cc_is_info,
+        &diestore,&cudie,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    res = dwarf_lowpc(cudie,&lowpc,error);
+    if (res == DW_DLV_ERROR) {
+        return res;
+    }
+    if (res == DW_DLV_OK) {
+        context->cc_lists5_low_pc = lowpc;
+    }
+    res = dwarf_attr_inplace(cudie,DW_AT_rnglists_base,
+        &attrstore,&attr,error);
+    if (res == DW_DLV_ERROR) {
+        return res;
+    }
+    if (res == DW_DLV_OK) {
+        res = dwarf_global_formref(attr,&base,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        context->cc_rnglists_base = base;
+        context->cc_rnglists_base_present = TRUE;
+    }
+    res = dwarf_attr_inplace(cudie,DW_AT_loclists_base,
+        &attrstore,&attr,error);
+    if (res == DW_DLV_ERROR) {
+        return res;
+    }
+    if (res == DW_DLV_OK) {
+        res = dwarf_global_formref(attr,&base,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        context->cc_loclists_base = base;
+        context->cc_loclists_base_present = TRUE;
+    }
+    context->cc_lists5_bases_known = TRUE;
+    return DW_DLV_OK;
+}
+
+/*  New 2018. Turns a DW_FORM_rnglistx or DW_FORM_loclistx
+    index into a section offset with one read of the offsets
+    table at base in .debug_rnglists or .debug_loclists.
+    The header before the table gives the number of entries.
+    With no DW_AT_rnglists_base (DW_AT_loclists_base) the unit
+    uses the first table, just past the first header.
+    The section must already be loaded.  */
+int
+_dwarf_lists5_offset_from_index(Dwarf_CU_Context context,
+    struct Dwarf_Section_s *section,
+    Dwarf_Bool base_present,
+    Dwarf_Unsigned base,
+    Dwarf_Unsigned index,
+    Dwarf_Unsigned *offset_out,
+    Dwarf_Error *error)
+{
+    Dwarf_Debug dbg = context->cc_dbg;
+    Dwarf_Small *secstart = section->dss_data;
+    Dwarf_Small *secend = secstart + section->dss_size;
+    Dwarf_Unsigned offset_size = context->cc_length_size;
+    /*  unit_length, version, address_size,
+        segment_selector_size and offset_entry_count. */
+    Dwarf_Unsigned header_size = offset_size +
+        context->cc_extension_size + 8;
+    Dwarf_Unsigned entry_count = 0;
+    Dwarf_Unsigned entry = 0;
+
+    if (!base_present) {
+        base = header_size;
+    }
+    if (base < header_size || base > section->dss_size) {
+        _dwarf_error(dbg,error,DW_DLE_LIST_INDEX_BAD);
+        return DW_DLV_ERROR;
+    }
+    READ_UNALIGNED_CK(dbg,entry_count,Dwarf_Unsigned,
+        secstart + base - 4,4,error,secend);
+    if (index >= entry_count ||
+        index >= (section->dss_size - base)/offset_size) {
+        _dwarf_error(dbg,error,DW_DLE_LIST_INDEX_BAD);
+        return DW_DLV_ERROR;
+    }
+    READ_UNALIGNED_CK(dbg,entry,Dwarf_Unsigned,
+        secstart + base + index*offset_size,offset_size,
+        error,secend);
+    if (entry >= section->dss_size - base) {
+        _dwarf_error(dbg,error,DW_DLE_LIST_INDEX_BAD);
+        return DW_DLV_ERROR;
+    }
+    *offset_out = base + entry;
+    return DW_DLV_OK;
+}
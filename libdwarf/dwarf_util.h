@@ -363,6 +363,26 @@ int _dwarf_decode_s_leb128_chk(Dwarf_Small * leb128,
     Dwarf_Word * leb128_length,
     Dwarf_Signed *outval, Dwarf_Byte_Ptr endptr);
 
+/*  Bulk forms of the above, see dwarf_leb.c. */
+int _dwarf_decode_u_leb128_bulk(Dwarf_Small * leb128,
+    Dwarf_Byte_Ptr endptr,
+    Dwarf_Unsigned *outvals,
+    Dwarf_Unsigned count,
+    Dwarf_Word * leb128_length);
+
+int _dwarf_decode_s_leb128_bulk(Dwarf_Small * leb128,
+    Dwarf_Byte_Ptr endptr,
+    Dwarf_Signed *outvals,
+    Dwarf_Unsigned count,
+    Dwarf_Word * leb128_length);
+
+int _dwarf_decode_u_leb128_pairs(Dwarf_Small * leb128,
+    Dwarf_Byte_Ptr endptr,
+    Dwarf_Unsigned *outvals,
+    Dwarf_Unsigned maxvals,
+    Dwarf_Unsigned *count_out,
+    Dwarf_Word * leb128_length);
+
 int
 _dwarf_get_size_of_val(Dwarf_Debug dbg,
     Dwarf_Unsigned form,
@@ -446,5 +466,15 @@ int _dwarf_what_section_are_we(Dwarf_Debug dbg,
     Dwarf_Small    **sec_end_ptr_out,
     Dwarf_Error *error);
 
+int _dwarf_lists5_bases(Dwarf_CU_Context context,
+    Dwarf_Error *error);
+int _dwarf_lists5_offset_from_index(Dwarf_CU_Context context,
+    struct Dwarf_Section_s *section,
+    Dwarf_Bool base_present,
+    Dwarf_Unsigned base,
+    Dwarf_Unsigned index,
+    Dwarf_Unsigned *offset_out,
+    Dwarf_Error *error);
+
 
 #endif /* DWARF_UTIL_H */
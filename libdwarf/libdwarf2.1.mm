@@ -203,6 +203,53 @@ the libdwarf draft for DWARF Version 1 and recent changes.
 
 .H 2 "Items Changed"
 .P
+dwarf_print_memory_stats() now prints what libdwarf
+allocated and loaded and added
+dwarf_get_debug_stats() and dwarf_get_section_load_stats().
+(October 19, 2018)
+.P
+Added dwarf_get_fde_info_for_changed_regs3()
+returning only the registers the frame instructions set.
+(October 19, 2018)
+.P
+Added dwarf_get_fde_info_for_all_regs3_batch()
+getting the register rules for many pcs in one pass.
+(October 19, 2018)
+.P
+Added dwarf_expr_compile() and dwarf_expr_evaluate()
+evaluating DWARF expressions.
+(October 19, 2018)
+.P
+Added dwarf_get_loclist_for_pc_c() and
+dwarf_get_variables_at_pc() finding the location
+in effect at a pc without decoding whole lists.
+(October 19, 2018)
+.P
+Added dwarf_get_rnglist() and dwarf_get_loclist()
+and their offset functions reading DWARF5
+.debug_rnglists and .debug_loclists.
+(October 19, 2018)
+.P
+Added dwarf_pc_frames() returning the chain of
+functions and inlined functions containing a pc.
+(October 19, 2018)
+.P
+dwarf_siblingof_b() now remembers the end of each
+subtree it has had to read through and added
+dwarf_get_sibling_cache_stats().
+(October 19, 2018)
+.P
+Added dwarf_die_array_build() and related functions
+giving parent, sibling and child navigation over a
+flattened array of the DIEs of a unit.
+(October 19, 2018)
+.P
+Added dwarf_child_inplace(), dwarf_siblingof_inplace(),
+dwarf_offdie_inplace() and dwarf_attr_inplace()
+which put the DIE or attribute in storage the
+caller provides, so walking DIEs need not allocate.
+(October 19, 2018)
+.P
 Added COMDAT support. 
 Recent compilers generate COMDAT sections (for some DWARF
 information) routinely so this became important
@@ -2738,6 +2785,16 @@ This die has the
 or \f(CWDW_TAG_type_unit\fP
 tag.
 
+When \f(CWdie\fP has children and no
+\f(CWDW_AT_sibling\fP attribute
+finding its sibling means reading all of
+its children.
+The offset where that subtree ends is remembered
+(per compilation unit) so asking again for
+the sibling of the same DIE does not re-read the
+children.
+See \f(CWdwarf_get_sibling_cache_stats()\fP.
+
 .in +2
 .FG "Example4 dwarf_siblingof()"
 .DS
@@ -2762,6 +2819,29 @@ void example4(Dwarf_Debug dbg,Dwarf_Die in_die,Dwarf_Bool is_info)
 .DE
 .in -2
 
+.H 3 "dwarf_get_sibling_cache_stats()"
+.DS
+\f(CWint dwarf_get_sibling_cache_stats(
+        Dwarf_Debug dbg,
+        Dwarf_Unsigned *lookups,
+        Dwarf_Unsigned *hits,
+        Dwarf_Unsigned *entries,
+        Dwarf_Error *error)\fP
+.DE
+Reports, for the whole \f(CWdbg\fP,
+how often
+\f(CWdwarf_siblingof_b()\fP
+(and \f(CWdwarf_siblingof()\fP,
+\f(CWdwarf_siblingof_inplace()\fP)
+was asked for the sibling of a DIE
+with children (\f(CW*lookups\fP),
+how many of those found the end of the children
+already remembered (\f(CW*hits\fP)
+and how many subtree ends are remembered
+(\f(CW*entries\fP).
+It returns \f(CWDW_DLV_OK\fP unless
+\f(CWdbg\fP is NULL.
+
 .H 3 "dwarf_siblingof()"
 .DS
 \f(CWint dwarf_siblingof(
@@ -2901,6 +2981,297 @@ The function \f(CWdwarf_offdie()\fP is obsolete, use
 The function is still supported in the library, but only
 references the .debug_info section.
 
+.H 3 "dwarf_siblingof_inplace()"
+.DS
+\f(CWint dwarf_siblingof_inplace(
+        Dwarf_Debug dbg,
+        Dwarf_Die die,
+        Dwarf_Bool is_info,
+        Dwarf_Die_Storage *storage,
+        Dwarf_Die *return_sib,
+        Dwarf_Error *error)\fP
+.DE
+.H 3 "dwarf_child_inplace()"
+.DS
+\f(CWint dwarf_child_inplace(
+        Dwarf_Die die,
+        Dwarf_Die_Storage *storage,
+        Dwarf_Die *return_kid,
+        Dwarf_Error *error)\fP
+.DE
+.H 3 "dwarf_offdie_inplace()"
+.DS
+\f(CWint dwarf_offdie_inplace(
+        Dwarf_Debug dbg,
+        Dwarf_Off offset,
+        Dwarf_Bool is_info,
+        Dwarf_Die_Storage *storage,
+        Dwarf_Die *return_die,
+        Dwarf_Error *error)\fP
+.DE
+These work exactly as
+\f(CWdwarf_siblingof_b()\fP,
+\f(CWdwarf_child()\fP
+and
+\f(CWdwarf_offdie_b()\fP
+except that
+the DIE is not allocated by libdwarf.
+It is placed in the
+\f(CWDwarf_Die_Storage\fP
+the caller provides (usually a local variable)
+and the
+\f(CWDwarf_Die\fP
+returned points to that storage.
+So a whole DIE tree can be walked without any
+allocation.
+.P
+The returned
+\f(CWDwarf_Die\fP
+may be passed to any function taking a
+\f(CWDwarf_Die\fP
+for as long as the storage exists and
+is not reused.
+It must never be passed to
+\f(CWdwarf_dealloc()\fP.
+.P
+The storage may be the storage
+of the input
+\f(CWdie\fP,
+so a list of siblings can be walked
+with a single
+\f(CWDwarf_Die_Storage\fP.
+
+.in +2
+.FG "Example6b dwarf_child_inplace()"
+.DS
+\f(CW
+void example6b(Dwarf_Debug dbg,Dwarf_Die in_die,Dwarf_Bool is_info)
+{
+  Dwarf_Die_Storage kidstore;
+  Dwarf_Die kid = 0;
+  Dwarf_Error error = 0;
+  int res = 0;
+
+  res = dwarf_child_inplace(in_die,&kidstore,&kid,&error);
+  while (res == DW_DLV_OK) {
+    /* Use kid here. No dwarf_dealloc() of it. */
+    res = dwarf_siblingof_inplace(dbg,kid,is_info,
+      &kidstore,&kid,&error);
+  }
+}
+\fP
+.DE
+.in -2
+
+.H 3 "dwarf_die_array_build()"
+.DS
+\f(CWint dwarf_die_array_build(
+        Dwarf_Die die,
+        Dwarf_Unsigned *die_count,
+        Dwarf_Error *error)\fP
+.DE
+The function
+\f(CWdwarf_die_array_build()\fP
+reads every DIE of the unit (CU or TU) that
+\f(CWdie\fP
+is in, once, and records them in an array
+in section (preorder) order.
+Each entry holds the DIE offset, tag,
+depth (the unit DIE has depth zero),
+and the array index of its parent and of its
+next sibling.
+On success it returns
+\f(CWDW_DLV_OK\fP
+and sets
+\f(CW*die_count\fP
+to the number of DIEs (so the number of entries).
+If the array already exists it just returns the count.
+It returns
+\f(CWDW_DLV_NO_ENTRY\fP
+if the unit has no DIEs.
+.P
+The array belongs to the unit.
+Any DIE of the unit may be passed as
+\f(CWdie\fP
+to the
+\f(CWdwarf_die_array_*()\fP
+functions below to name the array,
+which lets code needing the enclosing scope
+of a DIE step to its parent without re-reading
+the unit from its start.
+The functions below return
+\f(CWDW_DLV_ERROR\fP
+(\f(CWDW_DLE_DIE_ARRAY_MISSING\fP)
+if the array has not been built and
+\f(CWDW_DLV_ERROR\fP
+(\f(CWDW_DLE_DIE_ARRAY_INDEX_BAD\fP)
+if an index is not less than
+\f(CW*die_count\fP.
+.P
+Once the array for a unit is built
+\f(CWdwarf_offset_list()\fP
+uses it for DIEs in that unit.
+
+.H 3 "dwarf_die_array_free()"
+.DS
+\f(CWint dwarf_die_array_free(
+        Dwarf_Die die,
+        Dwarf_Error *error)\fP
+.DE
+Frees the array for the unit
+\f(CWdie\fP
+is in, if it was built.
+DIEs obtained from the array remain usable.
+Arrays not freed this way are freed by
+\f(CWdwarf_finish()\fP.
+
+.H 3 "dwarf_die_array_index()"
+.DS
+\f(CWint dwarf_die_array_index(
+        Dwarf_Die die,
+        Dwarf_Unsigned *index,
+        Dwarf_Error *error)\fP
+.DE
+Sets
+\f(CW*index\fP
+to the array index of
+\f(CWdie\fP
+itself.
+
+.H 3 "dwarf_die_array_offset_index()"
+.DS
+\f(CWint dwarf_die_array_offset_index(
+        Dwarf_Die die,
+        Dwarf_Off offset,
+        Dwarf_Unsigned *index,
+        Dwarf_Error *error)\fP
+.DE
+Sets
+\f(CW*index\fP
+to the array index of the DIE at the
+section-global
+\f(CWoffset\fP
+using a binary search.
+Returns
+\f(CWDW_DLV_NO_ENTRY\fP
+if no DIE of the unit starts at
+\f(CWoffset\fP.
+
+.H 3 "dwarf_die_array_entry()"
+.DS
+\f(CWint dwarf_die_array_entry(
+        Dwarf_Die die,
+        Dwarf_Unsigned index,
+        Dwarf_Off *offset,
+        Dwarf_Half *tag,
+        Dwarf_Unsigned *depth,
+        Dwarf_Error *error)\fP
+.DE
+Returns the section-global offset,
+the tag and the depth of the DIE at
+\f(CWindex\fP.
+
+.H 3 "dwarf_die_array_parent()"
+.DS
+\f(CWint dwarf_die_array_parent(
+        Dwarf_Die die,
+        Dwarf_Unsigned index,
+        Dwarf_Unsigned *parent_index,
+        Dwarf_Error *error)\fP
+.DE
+.H 3 "dwarf_die_array_sibling()"
+.DS
+\f(CWint dwarf_die_array_sibling(
+        Dwarf_Die die,
+        Dwarf_Unsigned index,
+        Dwarf_Unsigned *sibling_index,
+        Dwarf_Error *error)\fP
+.DE
+.H 3 "dwarf_die_array_child()"
+.DS
+\f(CWint dwarf_die_array_child(
+        Dwarf_Die die,
+        Dwarf_Unsigned index,
+        Dwarf_Unsigned *child_index,
+        Dwarf_Error *error)\fP
+.DE
+These return the index of the parent,
+the next sibling or the first child
+of the DIE at
+\f(CWindex\fP.
+None of them reads any DWARF.
+They return
+\f(CWDW_DLV_NO_ENTRY\fP
+if the unit DIE is asked for its parent,
+or there is no next sibling, or there
+are no children.
+
+.H 3 "dwarf_die_array_die()"
+.DS
+\f(CWint dwarf_die_array_die(
+        Dwarf_Die die,
+        Dwarf_Unsigned index,
+        Dwarf_Die *return_die,
+        Dwarf_Error *error)\fP
+.DE
+.H 3 "dwarf_die_array_die_inplace()"
+.DS
+\f(CWint dwarf_die_array_die_inplace(
+        Dwarf_Die die,
+        Dwarf_Unsigned index,
+        Dwarf_Die_Storage *storage,
+        Dwarf_Die *return_die,
+        Dwarf_Error *error)\fP
+.DE
+These return a
+\f(CWDwarf_Die\fP
+for the DIE at
+\f(CWindex\fP.
+The DIE returned by
+\f(CWdwarf_die_array_die()\fP
+must be freed with
+\f(CWdwarf_dealloc(dbg,*return_die,DW_DLA_DIE)\fP
+as usual.
+\f(CWdwarf_die_array_die_inplace()\fP
+uses
+\f(CW*storage\fP
+as
+\f(CWdwarf_child_inplace()\fP
+does.
+
+.in +2
+.FG "Example6c dwarf_die_array_parent()"
+.DS
+\f(CW
+/*  Print the tags of the scopes enclosing in_die. */
+void example6c(Dwarf_Die in_die)
+{
+  Dwarf_Unsigned count = 0;
+  Dwarf_Unsigned index = 0;
+  Dwarf_Error error = 0;
+  int res = 0;
+
+  res = dwarf_die_array_build(in_die,&count,&error);
+  if (res != DW_DLV_OK) {
+    return;
+  }
+  res = dwarf_die_array_index(in_die,&index,&error);
+  while (res == DW_DLV_OK) {
+    res = dwarf_die_array_parent(in_die,index,&index,&error);
+    if (res == DW_DLV_OK) {
+      Dwarf_Off off = 0;
+      Dwarf_Half tag = 0;
+      Dwarf_Unsigned depth = 0;
+
+      dwarf_die_array_entry(in_die,index,&off,&tag,&depth,&error);
+      /* Use tag here. */
+    }
+  }
+}
+\fP
+.DE
+.in -2
+
 
 .H 3 "dwarf_validate_die_sibling()"
 .DS
@@ -3382,6 +3753,36 @@ It returns \f(CWDW_DLV_NO_ENTRY\fP if \f(CWattr\fP is not contained
 in \f(CWdie\fP. 
 It returns \f(CWDW_DLV_ERROR\fP if an error occurred.
 
+.H 3 "dwarf_attr_inplace()"
+.DS
+\f(CWint dwarf_attr_inplace(
+        Dwarf_Die die, 
+        Dwarf_Half attr, 
+        Dwarf_Attribute_Storage *storage,
+        Dwarf_Attribute *return_attr,
+        Dwarf_Error *error)\fP
+.DE
+.P
+This works exactly as
+\f(CWdwarf_attr()\fP
+except that the attribute is placed in the
+\f(CWDwarf_Attribute_Storage\fP
+the caller provides and
+\f(CW*return_attr\fP
+points to that storage.
+The attribute may be passed to the
+\f(CWdwarf_form*()\fP
+functions and the like while the storage exists,
+and while
+\f(CWdie\fP
+remains valid.
+It must never be passed to
+\f(CWdwarf_dealloc()\fP.
+\f(CWdie\fP
+may be a DIE from
+\f(CWdwarf_child_inplace()\fP
+and the like.
+
 
 .H 3 "dwarf_lowpc()"
 .DS
@@ -4483,6 +4884,161 @@ example_loclistc(Dwarf_Debug dbg,Dwarf_Attribute someattr)
 }
 \fP
 .DE
+.H 3 "dwarf_get_loclist_for_pc_c()"
+.DS
+int dwarf_get_loclist_for_pc_c(Dwarf_Attribute attr,
+   Dwarf_Addr         pc,
+   Dwarf_Loc_Head_c * loclist_head,
+   Dwarf_Addr       * lowpc_out,
+   Dwarf_Addr       * highpc_out,
+   Dwarf_Error      * error);
+.DE
+New 2018.
+This is like
+\f(CWdwarf_get_loclist_c()\fP
+but returns only the entry of a location list
+in effect at
+\f(CWpc\fP.
+Only the address range and expression length of
+each entry are read while searching, and only the
+expression of the entry found is decoded, so this is
+much cheaper than
+\f(CWdwarf_get_loclist_c()\fP
+on long lists when just one address is of interest.
+It works for .debug_loc, .debug_loc.dwo and DWARF5
+.debug_loclists lists.
+.P
+On success it returns
+\f(CWDW_DLV_OK\fP
+and sets
+\f(CW*loclist_head\fP
+to a head with exactly one entry, index 0, to be read
+with
+\f(CWdwarf_get_locdesc_entry_c()\fP
+and freed with
+\f(CWdwarf_loc_head_c_dealloc()\fP.
+\f(CW*lowpc_out\fP
+and
+\f(CW*highpc_out\fP
+are set to the final (base-adjusted) address range
+of the entry, and the entry's lle_value is
+\f(CWDW_LLEX_start_end_entry\fP.
+A DWARF5
+\f(CWDW_LLE_default_location\fP
+entry is returned only when no bounded entry covers
+\f(CWpc\fP,
+with the range 0 to the maximum address.
+If the attribute is a location expression, not a list,
+that expression is returned with the same full range.
+.P
+It returns
+\f(CWDW_DLV_NO_ENTRY\fP
+if no entry of the list covers
+\f(CWpc\fP.
+On error it returns
+\f(CWDW_DLV_ERROR\fP
+and sets
+\f(CW*error\fP.
+.H 3 "dwarf_get_variables_at_pc()"
+.DS
+int dwarf_get_variables_at_pc(Dwarf_Die subprogram,
+   Dwarf_Addr         pc,
+   Dwarf_Off        * var_offsets,
+   Dwarf_Unsigned     var_max,
+   Dwarf_Unsigned   * var_count,
+   Dwarf_Error      * error);
+.DE
+New 2018.
+Given a
+\f(CWDW_TAG_subprogram\fP
+DIE
+this finds those of its
+\f(CWDW_TAG_variable\fP
+and
+\f(CWDW_TAG_formal_parameter\fP
+DIEs (in any nested lexical block or inlined
+subroutine, but not in a nested subprogram)
+whose
+\f(CWDW_AT_location\fP
+gives a non-empty location at
+\f(CWpc\fP.
+A DIE whose location is a single expression
+rather than a list counts only if
+\f(CWpc\fP
+is within the pc ranges of every lexical block and
+inlined subroutine enclosing it.
+The first call for a subprogram records which of its
+DIEs have a location and where each location list is;
+later calls for the same subprogram only search those
+lists (see
+\f(CWdwarf_get_loclist_for_pc_c()\fP).
+The record is freed by
+\f(CWdwarf_finish()\fP.
+.P
+On success it returns
+\f(CWDW_DLV_OK\fP,
+stores the global section offsets of up to
+\f(CWvar_max\fP
+of the DIEs, in DIE order, in
+\f(CWvar_offsets\fP
+and sets
+\f(CW*var_count\fP
+to the full number found
+(which may be more than
+\f(CWvar_max\fP).
+.P
+It returns
+\f(CWDW_DLV_NO_ENTRY\fP
+if no variable or parameter has a location at
+\f(CWpc\fP.
+On error it returns
+\f(CWDW_DLV_ERROR\fP
+and sets
+\f(CW*error\fP.
+.DS
+\f(CW
+void
+examplevarsatpc(Dwarf_Debug dbg, Dwarf_Die subprogram,
+    Dwarf_Addr pc)
+{
+    Dwarf_Off offs[50];
+    Dwarf_Unsigned count = 0;
+    Dwarf_Unsigned i = 0;
+    Dwarf_Error error = 0;
+    int res = 0;
+
+    res = dwarf_get_variables_at_pc(subprogram,pc,
+        offs,50,&count,&error);
+    if (res != DW_DLV_OK) {
+        return;
+    }
+    for (i = 0; i < count && i < 50; ++i) {
+        Dwarf_Die var = 0;
+        Dwarf_Attribute loc = 0;
+        Dwarf_Loc_Head_c head = 0;
+        Dwarf_Addr lowpc = 0;
+        Dwarf_Addr highpc = 0;
+
+        res = dwarf_offdie_b(dbg,offs[i],TRUE,&var,&error);
+        if (res != DW_DLV_OK) {
+            return;
+        }
+        res = dwarf_attr(var,DW_AT_location,&loc,&error);
+        if (res == DW_DLV_OK) {
+            res = dwarf_get_loclist_for_pc_c(loc,pc,&head,
+                &lowpc,&highpc,&error);
+            if (res == DW_DLV_OK) {
+                /*  Use dwarf_get_locdesc_entry_c(head,0,...)
+                    to get at the operators. */
+                dwarf_loc_head_c_dealloc(head);
+            }
+            dwarf_dealloc(dbg,loc,DW_DLA_ATTR);
+        }
+        dwarf_dealloc(dbg,var,DW_DLA_DIE);
+    }
+}
+\fP
+.DE
 .H 3 "dwarf_get_locdesc_entry_c()"
 .DS
 int dwarf_get_locdesc_entry_c(Dwarf_Loc_Head_c /*loclist_head*/,
@@ -9470,6 +10026,78 @@ the values for each row.
 It is up to the caller to allocate space for 
 \f(CW*reg_table\fP and initialize it properly.
 
+.H 3 "dwarf_get_fde_info_for_all_regs3_batch()"
+.DS
+\f(CWint dwarf_get_fde_info_for_all_regs3_batch(
+        Dwarf_Fde fde,
+        Dwarf_Addr *pcs,
+        Dwarf_Unsigned pc_count,
+        Dwarf_Regtable3 *reg_tables,
+        Dwarf_Addr *row_pcs,
+        Dwarf_Error *error)\fP
+.DE
+New 2018.
+\f(CWdwarf_get_fde_info_for_all_regs3_batch()\fP
+does for each of the \f(CWpc_count\fP pcs
+in the array \f(CWpcs\fP what
+\f(CWdwarf_get_fde_info_for_all_regs3()\fP
+does for one pc, but executes the frame instructions
+of the FDE (and its CIE) only once.
+The result for \f(CWpcs[i]\fP is written
+to \f(CWreg_tables[i]\fP and, if \f(CWrow_pcs\fP is
+non-null, the pc of its row to \f(CWrow_pcs[i]\fP.
+.P
+The caller allocates all of this storage and
+sets up each \f(CWreg_tables[i]\fP as for
+\f(CWdwarf_get_fde_info_for_all_regs3()\fP.
+The pcs must all be in the address range of the FDE
+and must be in ascending order (duplicates are allowed),
+otherwise \f(CWDW_DLV_ERROR\fP is returned with
+error \f(CWDW_DLE_PC_NOT_IN_FDE_RANGE\fP or
+\f(CWDW_DLE_FRAME_PCS_NOT_SORTED\fP.
+Returns \f(CWDW_DLV_NO_ENTRY\fP if \f(CWpc_count\fP is zero.
+
+.H 3 "dwarf_get_fde_info_for_changed_regs3()"
+.DS
+\f(CWint dwarf_get_fde_info_for_changed_regs3(
+        Dwarf_Fde fde,
+        Dwarf_Addr pc_requested,
+        Dwarf_Regtable3 *reg_table,
+        Dwarf_Half *columns,
+        Dwarf_Unsigned *changed_count,
+        Dwarf_Addr *row_pc,
+        Dwarf_Error *error)\fP
+.DE
+New 2018.
+\f(CWdwarf_get_fde_info_for_changed_regs3()\fP
+is like \f(CWdwarf_get_fde_info_for_all_regs3()\fP
+but returns only the registers whose rule at
+\f(CWpc_requested\fP was set by the
+instructions of the CIE or the FDE.
+Most FDEs set only a few registers, so
+on targets with a large register table this
+avoids filling in a rule for every register.
+.P
+The registers are returned in ascending order of
+register number:
+\f(CWreg_table->rt3_rules[i]\fP is the
+rule for register \f(CWcolumns[i]\fP.
+The caller provides \f(CWcolumns\fP with
+(at least) \f(CWreg_table->rt3_reg_table_size\fP
+entries.
+Every register not returned has the initial rule
+(see \f(CWdwarf_set_frame_rule_initial_value()\fP).
+The CFA rule is returned in
+\f(CWreg_table->rt3_cfa_rule\fP.
+.P
+\f(CW*changed_count\fP is set to the number of
+such registers.
+If that is greater than
+\f(CWreg_table->rt3_reg_table_size\fP only the first
+\f(CWreg_table->rt3_reg_table_size\fP are returned.
+\f(CW*row_pc\fP, if \f(CWrow_pc\fP is non-null,
+is set as by \f(CWdwarf_get_fde_info_for_all_regs3()\fP.
+
 
 
 .H 3 "dwarf_get_fde_n()"
@@ -10260,6 +10888,514 @@ to a block of \f(CWDwarf_Ranges\fP array and the
 number of structures in the block.  
 It frees all the data in the array of structures.
 
+.H 2 "DWARF5 range and location lists"
+DWARF5 moves range lists to .debug_rnglists
+and location lists to .debug_loclists,
+with new entry kinds (\f(CWDW_RLE_*\fP and \f(CWDW_LLE_*\fP)
+and, with
+\f(CWDW_FORM_rnglistx\fP
+and
+\f(CWDW_FORM_loclistx\fP,
+attributes naming a list by its index in
+an offsets table rather than by section offset.
+These functions read such lists.
+Index to list is a single read of the offsets table
+(at \f(CWDW_AT_rnglists_base\fP or
+\f(CWDW_AT_loclists_base\fP of the unit,
+or just past the first table header if there is none).
+Entries are decoded straight into an array the caller
+provides:
+base address entries, the unit base address
+(\f(CWDW_AT_low_pc\fP of the CU DIE) and
+\f(CWDW_AT_addr_base\fP-relative .debug_addr indices
+are all applied as the list is read
+so each returned entry has final addresses
+and nothing is allocated or needs to be freed.
+.P
+The returned count is always the full number
+of entries in the list.
+If it is larger than the array passed in
+only the first entries are filled in and
+the call can be repeated with a big enough array.
+
+.H 3 "dwarf_get_rnglist_offset()"
+.DS
+\f(CWint dwarf_get_rnglist_offset(
+        Dwarf_Attribute attr,
+        Dwarf_Off *offset,
+        Dwarf_Error *error)\fP
+.DE
+For a
+\f(CWDW_AT_ranges\fP
+attribute of form
+\f(CWDW_FORM_rnglistx\fP
+or
+\f(CWDW_FORM_sec_offset\fP
+\f(CWdwarf_get_rnglist_offset()\fP
+sets
+\f(CW*offset\fP
+to the .debug_rnglists offset of the list
+and returns
+\f(CWDW_DLV_OK\fP.
+It returns
+\f(CWDW_DLV_NO_ENTRY\fP
+if there is no .debug_rnglists section
+and
+\f(CWDW_DLV_ERROR\fP
+with the error
+\f(CWDW_DLE_LIST_INDEX_BAD\fP
+if the index is outside the offsets table.
+
+.H 3 "dwarf_get_rnglist()"
+.DS
+\f(CWint dwarf_get_rnglist(
+        Dwarf_Die die,
+        Dwarf_Off offset,
+        Dwarf_Rnglist_Range *ranges,
+        Dwarf_Unsigned ranges_max,
+        Dwarf_Unsigned *ranges_count,
+        Dwarf_Error *error)\fP
+.DE
+\f(CWdwarf_get_rnglist()\fP
+decodes the range list at
+\f(CWoffset\fP
+in .debug_rnglists.
+\f(CWdie\fP
+is any DIE of the unit the list belongs to
+(usually the one with the
+\f(CWDW_AT_ranges\fP attribute).
+Each
+\f(CWDwarf_Rnglist_Range\fP
+is one address range, from
+\f(CWdrr_lowpc\fP
+up to but not including
+\f(CWdrr_highpc\fP.
+On success it returns
+\f(CWDW_DLV_OK\fP,
+fills in up to
+\f(CWranges_max\fP
+entries of
+\f(CWranges\fP
+and sets
+\f(CW*ranges_count\fP.
+An unknown or truncated entry is
+\f(CWDW_DLE_RNGLISTS_ERROR\fP.
+
+.in +2
+.FG "Examplev5 dwarf_get_rnglist()"
+.DS
+\f(CW
+void examplev5(Dwarf_Die die,Dwarf_Attribute attr)
+{
+  Dwarf_Rnglist_Range ranges[10];
+  Dwarf_Unsigned count = 0;
+  Dwarf_Off offset = 0;
+  Dwarf_Error error = 0;
+  int res = 0;
+
+  res = dwarf_get_rnglist_offset(attr,&offset,&error);
+  if (res != DW_DLV_OK) {
+    return;
+  }
+  res = dwarf_get_rnglist(die,offset,ranges,10,&count,&error);
+  if (res == DW_DLV_OK) {
+    Dwarf_Unsigned i = 0;
+    for( i = 0; i < count && i < 10; ++i ) {
+      /* Use ranges[i].drr_lowpc, ranges[i].drr_highpc */
+    }
+  }
+}
+\fP
+.DE
+.in -2
+
+.H 3 "dwarf_get_loclist_offset()"
+.DS
+\f(CWint dwarf_get_loclist_offset(
+        Dwarf_Attribute attr,
+        Dwarf_Off *offset,
+        Dwarf_Error *error)\fP
+.DE
+As
+\f(CWdwarf_get_rnglist_offset()\fP
+but for a location attribute (such as
+\f(CWDW_AT_location\fP)
+of form
+\f(CWDW_FORM_loclistx\fP
+or
+\f(CWDW_FORM_sec_offset\fP
+and returning a .debug_loclists offset.
+
+.H 3 "dwarf_get_loclist()"
+.DS
+\f(CWint dwarf_get_loclist(
+        Dwarf_Die die,
+        Dwarf_Off offset,
+        Dwarf_Loclist_Range *locs,
+        Dwarf_Unsigned locs_max,
+        Dwarf_Unsigned *locs_count,
+        Dwarf_Error *error)\fP
+.DE
+As
+\f(CWdwarf_get_rnglist()\fP
+but decodes the location list at
+\f(CWoffset\fP
+in .debug_loclists.
+Each
+\f(CWDwarf_Loclist_Range\fP
+gives the pc range
+\f(CWdlr_lowpc\fP,
+\f(CWdlr_highpc\fP
+and the location expression that applies there:
+\f(CWdlr_expr\fP
+points to the
+\f(CWdlr_expr_len\fP
+bytes of the expression in the section
+(pass them to
+\f(CWdwarf_loclist_from_expr_c()\fP
+to get the operators).
+A
+\f(CWDW_LLE_default_location\fP
+entry has
+\f(CWdlr_is_default\fP
+non-zero and zero pc fields.
+An unknown or truncated entry is
+\f(CWDW_DLE_LOCLISTS_ERROR\fP.
+
+.H 2 "Evaluating DWARF expressions"
+These functions evaluate a DWARF expression
+(a location description, a frame base, a
+\f(CWDW_CFA_def_cfa_expression\fP
+and so on) against register and memory values
+supplied by the caller.
+.P
+An expression is first compiled, once, into a
+compact internal form in which operand decoding,
+.debug_addr lookups and branch target resolution
+have already been done.
+Compiled programs are kept by the
+\f(CWDwarf_Debug\fP
+keyed by the address of the expression in its
+section and the unit of the
+\f(CWdie\fP
+it was compiled for,
+so compiling the same expression again
+is just a hash lookup and evaluating it does no
+allocation.
+Programs are freed by
+\f(CWdwarf_finish()\fP;
+there is no dealloc call for them.
+.P
+All values are of the generic type (the size of an
+address).
+Typed operators such as
+\f(CWDW_OP_const_type\fP
+and
+\f(CWDW_OP_deref_type\fP
+are accepted but their type is ignored,
+and
+\f(CWDW_OP_convert\fP
+and
+\f(CWDW_OP_reinterpret\fP
+do nothing.
+\f(CWDW_OP_call2\fP,
+\f(CWDW_OP_call4\fP,
+\f(CWDW_OP_call_ref\fP
+and
+\f(CWDW_OP_GNU_parameter_ref\fP
+cannot be compiled
+(\f(CWDW_DLE_EXPR_OP_UNSUPPORTED\fP).
+\f(CWDW_OP_xderef\fP
+ignores the address space.
+An evaluation that executes more than 10000
+operators (which only a looping
+\f(CWDW_OP_skip\fP
+or
+\f(CWDW_OP_bra\fP
+can do) is stopped with
+\f(CWDW_DLE_EXPR_EVAL_ERROR\fP.
+
+.H 3 "dwarf_expr_compile()"
+.DS
+\f(CWint dwarf_expr_compile(
+        Dwarf_Debug dbg,
+        Dwarf_Die die,
+        Dwarf_Ptr expr,
+        Dwarf_Unsigned expr_len,
+        Dwarf_Expr_Program *program_out,
+        Dwarf_Error *error)\fP
+.DE
+\f(CWexpr\fP
+and
+\f(CWexpr_len\fP
+are the bytes of the expression, which must be
+in a section loaded by libdwarf (as from
+\f(CWdwarf_formexprloc()\fP,
+\f(CWdwarf_get_loclist()\fP
+or a frame instruction), otherwise
+\f(CWDW_DLE_POINTER_SECTION_UNKNOWN\fP
+is the error.
+\f(CWdie\fP
+is any DIE of the unit the expression is from.
+It gives the address size and the
+.debug_addr base for
+\f(CWDW_OP_addrx\fP
+and
+\f(CWDW_OP_constx\fP.
+For a frame expression pass a null
+\f(CWdie\fP:
+the object's pointer size is then used.
+.P
+On success it returns
+\f(CWDW_DLV_OK\fP
+and sets
+\f(CW*program_out\fP.
+It never returns
+\f(CWDW_DLV_NO_ENTRY\fP.
+A branch to other than an operator of the
+expression is
+\f(CWDW_DLE_EXPR_BRANCH_BAD\fP.
+
+.H 3 "dwarf_expr_evaluate()"
+.DS
+\f(CWint dwarf_expr_evaluate(
+        Dwarf_Expr_Program program,
+        Dwarf_Expr_Env *env,
+        Dwarf_Expr_Piece *pieces,
+        Dwarf_Unsigned pieces_max,
+        Dwarf_Unsigned *pieces_count,
+        Dwarf_Error *error)\fP
+.DE
+Evaluates
+\f(CWprogram\fP
+with the register, memory, frame base and CFA values
+of
+\f(CWenv\fP
+(see
+\f(CWDwarf_Expr_Env\fP
+in libdwarf.h).
+\f(CWDW_OP_entry_value\fP
+of a register gets the value from
+\f(CWdee_entry_register\fP;
+of any other expression, evaluates that expression
+with
+\f(CWdee_entry_register\fP
+in place of
+\f(CWdee_read_register\fP.
+.P
+On success it returns
+\f(CWDW_DLV_OK\fP,
+fills in up to
+\f(CWpieces_max\fP
+entries of
+\f(CWpieces\fP
+and sets
+\f(CW*pieces_count\fP
+to the number of pieces of the result.
+An expression without
+\f(CWDW_OP_piece\fP
+or
+\f(CWDW_OP_bit_piece\fP
+gives one piece with
+\f(CWdep_size_bits\fP
+zero.
+\f(CWdep_kind\fP
+is
+\f(CWDW_EXPR_LOC_MEMORY\fP
+(\f(CWdep_value\fP
+is the address of the object),
+\f(CWDW_EXPR_LOC_REGISTER\fP
+(\f(CWdep_value\fP
+is the register number),
+\f(CWDW_EXPR_LOC_VALUE\fP
+(after
+\f(CWDW_OP_stack_value\fP),
+\f(CWDW_EXPR_LOC_IMPLICIT\fP
+(\f(CWdep_value\fP
+bytes at
+\f(CWdep_data\fP),
+\f(CWDW_EXPR_LOC_IMPLICIT_POINTER\fP
+or
+\f(CWDW_EXPR_LOC_UNDEFINED\fP
+(an empty expression or piece).
+.P
+If a callback returns
+\f(CWDW_DLV_NO_ENTRY\fP
+(the value is not available)
+so does
+\f(CWdwarf_expr_evaluate()\fP.
+A callback error, a needed callback that is null
+or a division by zero is
+\f(CWDW_DLE_EXPR_EVAL_ERROR\fP,
+and too few or too many (over 64) stack entries
+\f(CWDW_DLE_EXPR_STACK_ERROR\fP.
+.DS
+\f(CW
+static int
+my_read_register(void *user_data,Dwarf_Unsigned regnum,
+    Dwarf_Unsigned *value_out)
+{
+    /* Look up regnum in the sample's registers. */
+    return DW_DLV_OK;
+}
+
+void
+exampleexpreval(Dwarf_Debug dbg,Dwarf_Die var,
+    Dwarf_Addr frame_base,void *sample)
+{
+    Dwarf_Attribute_Storage astore;
+    Dwarf_Attribute loc = 0;
+    Dwarf_Unsigned len = 0;
+    Dwarf_Ptr expr = 0;
+    Dwarf_Expr_Program prog = 0;
+    Dwarf_Expr_Env env;
+    Dwarf_Expr_Piece pieces[4];
+    Dwarf_Unsigned count = 0;
+    Dwarf_Error error = 0;
+    int res = 0;
+
+    res = dwarf_attr_inplace(var,DW_AT_location,&astore,
+        &loc,&error);
+    if (res != DW_DLV_OK) {
+        return;
+    }
+    res = dwarf_formexprloc(loc,&len,&expr,&error);
+    if (res != DW_DLV_OK) {
+        return;
+    }
+    /*  Cheap after the first time for this expression. */
+    res = dwarf_expr_compile(dbg,var,expr,len,&prog,&error);
+    if (res != DW_DLV_OK) {
+        return;
+    }
+    memset(&env,0,sizeof(env));
+    env.dee_user_data = sample;
+    env.dee_read_register = my_read_register;
+    env.dee_frame_base = frame_base;
+    res = dwarf_expr_evaluate(prog,&env,pieces,4,&count,&error);
+    if (res == DW_DLV_OK &&
+        pieces[0].dep_kind == DW_EXPR_LOC_MEMORY) {
+        /* The variable is at address pieces[0].dep_value */
+    }
+}
+\fP
+.DE
+.H 2 "Functions containing a pc"
+These functions answer the question
+which function, and which inlined functions,
+contain a given pc.
+On first use an index over the address ranges
+(\f(CWDW_AT_low_pc\fP/\f(CWDW_AT_high_pc\fP
+or \f(CWDW_AT_ranges\fP)
+of every
+\f(CWDW_TAG_subprogram\fP
+and
+\f(CWDW_TAG_inlined_subroutine\fP
+DIE in .debug_info
+is built.
+After that each lookup is a binary search.
+Address ranges starting at zero are ignored
+as that is where linkers leave discarded functions.
+.P
+The index is independent of the
+\f(CWdwarf_next_cu_header_d()\fP
+position of the caller.
+
+.H 3 "dwarf_pc_frames()"
+.DS
+\f(CWint dwarf_pc_frames(
+        Dwarf_Debug dbg,
+        Dwarf_Addr pc,
+        Dwarf_Pc_Frame *frames,
+        Dwarf_Unsigned frames_max,
+        Dwarf_Unsigned *frames_count,
+        Dwarf_Error *error)\fP
+.DE
+On success
+\f(CWdwarf_pc_frames()\fP
+returns
+\f(CWDW_DLV_OK\fP,
+fills in up to
+\f(CWframes_max\fP
+entries of the caller's
+\f(CWframes\fP
+array and sets
+\f(CW*frames_count\fP
+to the number of functions containing
+\f(CWpc\fP.
+That may exceed
+\f(CWframes_max\fP,
+in which case only the innermost
+\f(CWframes_max\fP
+are filled in.
+\f(CWframes[0]\fP
+is the innermost function (the deepest
+inlined function if any) and
+the last is the outermost
+\f(CWDW_TAG_subprogram\fP.
+.P
+Each
+\f(CWDwarf_Pc_Frame\fP
+holds the .debug_info offset
+(\f(CWdpf_die_offset\fP)
+and tag (\f(CWdpf_tag\fP)
+of the DIE.
+For a
+\f(CWDW_TAG_inlined_subroutine\fP
+\f(CWdpf_call_file\fP,
+\f(CWdpf_call_line\fP
+and
+\f(CWdpf_call_column\fP
+are its
+\f(CWDW_AT_call_file\fP,
+\f(CWDW_AT_call_line\fP
+and
+\f(CWDW_AT_call_column\fP:
+where in the next frame out the function was inlined.
+They are zero when absent.
+Use
+\f(CWdwarf_offdie_b()\fP
+to get at the DIE itself (to find its name
+via
+\f(CWDW_AT_abstract_origin\fP for example).
+.P
+It returns
+\f(CWDW_DLV_NO_ENTRY\fP
+if no function contains
+\f(CWpc\fP
+and
+\f(CWDW_DLV_ERROR\fP
+if the index could not be built.
+Nothing need be freed.
+
+.H 3 "dwarf_pc_index_build()"
+.DS
+\f(CWint dwarf_pc_index_build(
+        Dwarf_Debug dbg,
+        Dwarf_Unsigned *segment_count,
+        Dwarf_Error *error)\fP
+.DE
+Builds the index now rather than
+at the first call of
+\f(CWdwarf_pc_frames()\fP
+and sets
+\f(CW*segment_count\fP
+to the number of address segments in it
+(each segment being a range of addresses
+with the same innermost function).
+
+.H 3 "dwarf_pc_index_free()"
+.DS
+\f(CWvoid dwarf_pc_index_free(
+        Dwarf_Debug dbg)\fP
+.DE
+Frees the index.
+A later
+\f(CWdwarf_pc_frames()\fP
+builds it again.
+\f(CWdwarf_finish()\fP
+frees it in any case.
+
 .H 2 "Gdb Index operations"
 These functions get access to the fast lookup tables
 defined by gdb and gcc and stored in the
@@ -11650,6 +12786,53 @@ to the size of the object section.
 No free or deallocate of information returned should be done by
 callers.
 
+.H 3 "dwarf_get_section_data_by_name()"
+.DS
+\f(CWint dwarf_get_section_data_by_name(
+   Dwarf_Debug dbg,
+   const char *section_name,
+   const Dwarf_Small **section_data,
+   Dwarf_Unsigned *section_size,
+   Dwarf_Error *error)\fP
+.DE 
+New 2018.
+The function \f(CWdwarf_get_section_data_by_name()\fP 
+returns \f(CWDW_DLV_OK\fP and sets
+\f(CW*section_data\fP and \f(CW*section_size\fP
+to the contents of the DWARF section named \f(CWsection_name\fP
+(for example \f(CW".debug_abbrev"\fP)
+as libdwarf reads them: decompressed and with any
+relocations applied.
+It returns \f(CWDW_DLV_NO_ENTRY\fP if libdwarf has
+no such section or the section is empty.
+.P
+The bytes belong to libdwarf and remain valid until
+\f(CWdwarf_finish()\fP.
+No free or deallocate of information returned should be done by
+callers.
+
+.H 3 "dwarf_get_section_load_stats()"
+.DS
+\f(CWint dwarf_get_section_load_stats(
+   Dwarf_Debug dbg,
+   const char *section_name,
+   Dwarf_Unsigned *loaded_bytes,
+   Dwarf_Unsigned *compressed_bytes,
+   Dwarf_Unsigned *relocations,
+   Dwarf_Error *error)\fP
+.DE 
+New 2018.
+The function \f(CWdwarf_get_section_load_stats()\fP 
+returns \f(CWDW_DLV_OK\fP and sets
+\f(CW*loaded_bytes\fP to the size of the
+section named \f(CWsection_name\fP as loaded,
+\f(CW*compressed_bytes\fP to its compressed size
+(zero unless it was decompressed)
+and \f(CW*relocations\fP to the number of
+relocations applied to it.
+It returns \f(CWDW_DLV_NO_ENTRY\fP if libdwarf has
+no such section or has not yet loaded it.
+
 
 .H 2 "Utility Operations"
 These functions aid in the management of errors encountered when using 
@@ -12052,6 +13235,51 @@ The argument \f(CWtype\fP is an integer code that specifies the allocation
 type of the region pointed to by the \f(CWspace\fP.  Refer to section 
 4 for details on \fIlibdwarf\fP memory management.
 
+.H 3 "dwarf_get_debug_stats()"
+.DS
+\f(CWint dwarf_get_debug_stats(
+        Dwarf_Debug dbg,
+        Dwarf_Debug_Stats *stats_out,
+        Dwarf_Error *error)\fP
+.DE
+New 2018.
+The function \f(CWdwarf_get_debug_stats()\fP
+copies into \f(CW*stats_out\fP what libdwarf has
+counted for \f(CWdbg\fP since it was opened.
+\f(CWds_alloc[]\fP, indexed by \f(CWDW_DLA_*\fP
+allocation type,
+gives for each type the allocations made (\f(CWas_count\fP),
+those not yet freed (\f(CWas_live_count\fP and
+\f(CWas_live_bytes\fP) and the most live at once
+(\f(CWas_peak_count\fP and \f(CWas_peak_bytes\fP).
+\f(CWds_live_bytes\fP and \f(CWds_peak_bytes\fP
+are the same over all types.
+Byte counts include the few bytes libdwarf adds to each
+allocation.
+The remaining fields count the sections loaded and their
+bytes as read from the object, the sections decompressed
+and their decompressed bytes,
+the relocations applied,
+the CU contexts created,
+abbreviation lookups found in and missing from the per-CU cache
+and the DIEs materialized (whether allocated or
+put in caller storage by the \f(CW*_inplace()\fP functions).
+It returns \f(CWDW_DLV_OK\fP unless
+\f(CWdbg\fP is NULL.
+
+.H 3 "dwarf_print_memory_stats()"
+.DS
+\f(CWvoid dwarf_print_memory_stats(
+        Dwarf_Debug dbg)\fP
+.DE
+The function \f(CWdwarf_print_memory_stats()\fP
+prints the \f(CWdwarf_get_debug_stats()\fP counts
+and, for each loaded section, its
+\f(CWdwarf_get_section_load_stats()\fP values
+through the printf callback
+(see \f(CWdwarf_register_printf_callback()\fP).
+It prints nothing if no callback is registered.
+
 .H 3 "dwarf_encode_leb128()"
 .DS
 int dwarf_encode_leb128(Dwarf_Unsigned val,
@@ -795,6 +795,39 @@ or used.  All-lowercase option names are reserved to
 the libdwarf implementation itself (specific implementations
 may want to use a leading upper-case letter for
 additional options).
+Unrecognized option names are ignored.
+.P
+The option
+\f(CWcontiguous_sections\fP
+makes the producer keep each output section
+in a single buffer that doubles in size as it fills,
+rather than in a list of roughly 4 KB chunks.
+With it
+\f(CWdwarf_transform_to_disk_form_a()\fP
+reports one buffer per section and
+each section can be handed out whole by
+\f(CWdwarf_get_section_bytes_a()\fP,
+\f(CWdwarf_pro_stream_section_bytes()\fP
+or
+\f(CWdwarf_pro_write_section_bytes_fd()\fP.
+.P
+The option
+\f(CWtail_merge_strings\fP
+makes
+\f(CWdwarf_transform_to_disk_form_a()\fP
+rewrite
+\f(CW.debug_str\fP
+so that a string which is the tail of
+another string (for example
+\f(CWname\fP
+and
+\f(CW.name\fP)
+is stored only once,
+the shorter one referring into the longer one.
+The output is smaller but the strings are no longer
+in the order they were first used.
+See
+\f(CWdwarf_pro_get_string_tail_merge_stats()\fP.
 
 .P
 The \f(CWerror\fP argument 
@@ -842,6 +875,69 @@ appears exactly once.
 On success it returns \f(CWDW_DLV_OK\fP.
 On error it returns \f(CWDW_DLV_ERROR\fP.
 
+.H 3 "dwarf_pro_set_debug_names_tags()"
+
+.DS
+\f(CWint dwarf_pro_set_debug_names_tags(
+        Dwarf_P_Debug  dbg,
+        Dwarf_Half    *tags,
+        Dwarf_Unsigned tag_count,
+        Dwarf_Error   *error) \fP
+.DE
+.P
+When the output version is 5 the producer
+writes a
+\f(CW.debug_names\fP
+section indexing the names of the DIEs created.
+A DIE is indexed if its tag is one of the
+\f(CWtag_count\fP
+tags in the array
+\f(CWtags\fP
+and it has a
+\f(CWDW_AT_name\fP
+(its own, or one found through
+\f(CWDW_AT_abstract_origin\fP
+or
+\f(CWDW_AT_specification\fP).
+As DWARF5 section 6.1.1.1 requires,
+declarations are never indexed,
+subprograms and inlined subroutines
+are only indexed if they have an address,
+and variables are indexed at file or namespace scope
+and, inside a function, only if their
+\f(CWDW_AT_location\fP
+gives a static address (begins with
+\f(CWDW_OP_addr\fP
+or ends with a TLS operator).
+So function-scope statics are indexed and
+automatic variables and parameters are not.
+.P
+The array is copied, the caller may free it
+on return.
+A
+\f(CWtag_count\fP
+of zero means no
+\f(CW.debug_names\fP
+section is created.
+If this function is never called
+a default list of tags is used:
+the base, class, enumeration, interface,
+structure, subrange, typedef, union,
+unspecified and pointer-to-member types,
+enumerators, namespaces, imported declarations,
+subprograms, inlined subroutines
+and variables.
+.P
+The names are placed in
+\f(CW.debug_str\fP
+(a name already there is not duplicated).
+.P
+The function must be called before
+\f(CWdwarf_transform_to_disk_form_a()\fP.
+.P
+On success it returns \f(CWDW_DLV_OK\fP.
+On error it returns \f(CWDW_DLV_ERROR\fP.
+
 .H 3 "dwarf_transform_to_disk_form_a()"
 .DS
 \f(CWint dwarf_transform_to_disk_form_a(
@@ -1308,6 +1404,91 @@ It is unwise to call this before
 \f(CWdwarf_transform_to_disk_form() \fP has been called.
 .P
 
+.H 3 "dwarf_pro_stream_section_bytes()"
+.DS
+\f(CWint dwarf_pro_stream_section_bytes(
+    Dwarf_P_Debug dbg,
+    Dwarf_P_Section_Sink sink,
+    void * sink_data,
+    Dwarf_Error* error) \fP
+.DE
+Call it after
+\f(CWdwarf_transform_to_disk_form_a()\fP.
+The function
+\f(CWdwarf_pro_stream_section_bytes()\fP
+calls
+.DS
+\f(CWint sink(Dwarf_Signed elf_section_index,
+    Dwarf_Ptr section_bytes,
+    Dwarf_Unsigned length,
+    void * sink_data,
+    int * error)\fP
+.DE
+once for each buffer, in the same order
+\f(CWdwarf_get_section_bytes_a()\fP
+would return them.
+The bytes are the library's own storage: nothing is copied
+and the storage is freed by
+\f(CWdwarf_producer_finish_a()\fP.
+With the
+\f(CWcontiguous_sections\fP
+option (see
+\f(CWdwarf_producer_init()\fP)
+each section arrives in exactly one call.
+.P
+The sink returns
+\f(CWDW_DLV_OK\fP
+to continue.
+Any other return value, or a nonzero
+\f(CW*error\fP,
+stops the stream at that buffer and
+\f(CWdwarf_pro_stream_section_bytes()\fP
+returns
+\f(CWDW_DLV_ERROR\fP.
+The error is the DW_DLE code the sink stored in
+\f(CW*error\fP,
+or
+\f(CWDW_DLE_SECTION_SINK_ERROR\fP
+if it stored none.
+It returns
+\f(CWDW_DLV_NO_ENTRY\fP
+if there are no section bytes at all.
+The iteration state of
+\f(CWdwarf_get_section_bytes_a()\fP
+is not changed.
+
+.H 3 "dwarf_pro_write_section_bytes_fd()"
+.DS
+\f(CWint dwarf_pro_write_section_bytes_fd(
+    Dwarf_P_Debug dbg,
+    Dwarf_Signed elf_section_index,
+    int fd,
+    Dwarf_Unsigned * bytes_written,
+    Dwarf_Error* error) \fP
+.DE
+The function
+\f(CWdwarf_pro_write_section_bytes_fd()\fP
+writes all the bytes of the section whose
+section number (as returned by the
+\f(CWDwarf_Callback_Func\fP) is
+\f(CWelf_section_index\fP
+to
+\f(CWfd\fP
+starting at the current file position.
+The caller positions
+\f(CWfd\fP
+where the section belongs in the output file.
+On success it returns
+\f(CWDW_DLV_OK\fP
+and sets
+\f(CWbytes_written\fP
+(if non-null) to the number of bytes written.
+It returns
+\f(CWDW_DLV_NO_ENTRY\fP
+if there is no such section and
+\f(CWDW_DLV_ERROR\fP
+if a write fails.
+
 .H 3 "dwarf_pro_get_string_stats()"
 .DS
 \f(CWint dwarf_pro_get_string_stats(
@@ -1342,6 +1523,43 @@ and sets
 \f(CWerror\fP 
 through the pointer.
 
+.H 3 "dwarf_pro_get_string_tail_merge_stats()"
+.DS
+\f(CWint dwarf_pro_get_string_tail_merge_stats(
+    Dwarf_P_Debug dbg,
+    Dwarf_Unsigned * tail_merged_count,
+    Dwarf_Unsigned * tail_merged_len,
+    Dwarf_Error* error) \fP
+.DE
+If it returns
+\f(CWDW_DLV_OK\fP
+the function
+\f(CWdwarf_pro_get_string_tail_merge_stats()\fP
+returns through
+\f(CWtail_merged_count\fP
+the number of
+\f(CW.debug_str\fP
+strings stored as the tail of another string
+and through
+\f(CWtail_merged_len\fP
+the bytes (including the terminating NUL bytes)
+that saved.
+Both are zero unless the
+\f(CWtail_merge_strings\fP
+option was passed to
+\f(CWdwarf_producer_init()\fP.
+.P
+Call it after calling
+\f(CWdwarf_transform_to_disk_form()\fP
+and before calling
+\f(CWdwarf_producer_finish_a()\fP .
+.P
+On error it returns
+\f(CWDW_DLV_ERROR\fP
+and sets
+\f(CWerror\fP
+through the pointer.
+
 
 .H 3 "dwarf_producer_finish_a()"
 .DS
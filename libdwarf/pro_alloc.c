@@ -29,6 +29,7 @@
 #include "config.h"
 #include "pro_incl.h"
 #include "pro_alloc.h"
+#include "pro_section.h"
 #ifdef HAVE_STDLIB_H
 #include <stdlib.h>
 #else
@@ -60,13 +61,28 @@
 #define BLOCK_TO_LIST(blk) ((memory_list_t*) (((char*)blk) - sizeof(memory_list_t)))
 
 
-/*
-  dbg should be NULL only when allocating dbg itself.  In that
-  case we initialize it to an empty circular doubly-linked list.
+/*  Nearly every producer object lives until _dwarf_p_dealloc_all(),
+    so small objects are not malloc'd one at a time.  They are
+    carved with a pointer bump from ARENA_BLOCK_SIZE blocks that
+    sit on the dbg list like any other block.
+    Each arena object still has a memory_list_t in front of it,
+    with prev set to NULL, which lets _dwarf_p_dealloc()
+    recognize it and leave it for _dwarf_p_dealloc_all().
+    Objects larger than ARENA_MAX_OBJECT get their own malloc
+    (and can be freed individually) as before.  */
+#define ARENA_BLOCK_SIZE  (64*1024)
+#define ARENA_MAX_OBJECT  (ARENA_BLOCK_SIZE/16)
+/*  Keeps each object (after its memory_list_t) as aligned
+    as malloc would. */
+#define ARENA_ROUND(n) (((n) + 2*sizeof(memory_list_t) - 1) & \
+    ~(Dwarf_Unsigned)(2*sizeof(memory_list_t) - 1))
+
+/*  Allocate one block with malloc and put it on the dbg list.
+    dbg should be NULL only when allocating dbg itself.  In that
+    case we initialize it to an empty circular doubly-linked list.
 */
-
-Dwarf_Ptr
-_dwarf_p_get_alloc(Dwarf_P_Debug dbg, Dwarf_Unsigned size)
+static void *
+alloc_listed_block(Dwarf_P_Debug dbg, Dwarf_Unsigned size)
 {
     void *sp;
     memory_list_t *lp = NULL;
@@ -102,6 +118,35 @@ _dwarf_p_get_alloc(Dwarf_P_Debug dbg, Dwarf_Unsigned size)
     return sp;
 }
 
+Dwarf_Ptr
+_dwarf_p_get_alloc(Dwarf_P_Debug dbg, Dwarf_Unsigned size)
+{
+    Dwarf_Unsigned needed = 0;
+    memory_list_t *lp = NULL;
+
+    if (dbg == NULL || size > ARENA_MAX_OBJECT) {
+        return alloc_listed_block(dbg,size);
+    }
+    needed = ARENA_ROUND(size + sizeof(memory_list_t));
+    if ((Dwarf_Unsigned)(dbg->de_arena_end - dbg->de_arena_next) <
+        needed) {
+        /*  The rest of the old block (at most ARENA_MAX_OBJECT
+            bytes) is simply abandoned. */
+        char *blk = (char *)alloc_listed_block(dbg,ARENA_BLOCK_SIZE);
+        if (!blk) {
+            return NULL;
+        }
+        dbg->de_arena_next = blk;
+        dbg->de_arena_end = blk + ARENA_BLOCK_SIZE;
+    }
+    /*  The block was zeroed when created and nothing in it
+        is ever reused, so no memset here. */
+    lp = (memory_list_t *)dbg->de_arena_next;
+    lp->prev = NULL;
+    dbg->de_arena_next += needed;
+    return LIST_TO_BLOCK(lp);
+}
+
 /*
   This routine is only here in case a caller of an older version of the
   library is calling this for some reason.
@@ -135,6 +180,11 @@ _dwarf_p_dealloc(UNUSEDARG Dwarf_P_Debug dbg,
 {
   memory_list_t *lp;
   lp = BLOCK_TO_LIST(ptr);
+  if (lp->prev == NULL) {
+      /*  Arena object, see _dwarf_p_get_alloc().
+          Its block is freed by _dwarf_p_dealloc_all(). */
+      return;
+  }
 
   /*
     Remove from a doubly linked, circular list.
@@ -173,6 +223,7 @@ _dwarf_p_dealloc_all(Dwarf_P_Debug dbg)
         return;
     }
 
+    _dwarf_pro_free_section_buffers(dbg);
     dbglp = BLOCK_TO_LIST(dbg);
     while (dbglp->next != dbglp) {
         _dwarf_p_dealloc(dbg, LIST_TO_BLOCK(dbglp->next));
@@ -315,36 +315,56 @@ _dwarf_pro_add_AT_stmt_list(Dwarf_P_Debug dbg,
     return DW_DLV_OK;
 }
 
+/*  This is the Daniel J Bernstein hash function
+    originally posted to Usenet news.
+    http://en.wikipedia.org/wiki/List_of_hash_functions or
+    http://stackoverflow.com/questions/10696223/reason-for-5381-number-in-djb-hash-function).
+    It is computed once per entry and kept in dse_hash,
+    see simple_string_hashfunc() in pro_init.c. */
+static Dwarf_Unsigned
+debug_str_hash(const char *str)
+{
+    Dwarf_Unsigned hash = 5381;
+    int c  = 0;
+
+    /*  Extra parens suppress warning about assign in test. */
+    while ((c = *str++)) {
+        hash = hash * 33 + c ;
+    }
+    return hash;
+}
+
+static const char *
+debug_str_entry_string(const struct Dwarf_P_debug_str_entry_s *e)
+{
+    if (e->dse_has_table_offset) {
+        /*  When set the name is in the string table. */
+        /*  ASSERT: dse_sd->ds_data is non-zero.
+            ASSERT: dse_name NULL. */
+        return e->dse_sd->ds_data + e->dse_table_offset;
+    }
+    /*  ASSERT: dse_name non-null */
+    return e->dse_name;
+}
+
 static int
 _dwarf_debug_str_compare_func(const void *l,const void *r)
 {
     const struct Dwarf_P_debug_str_entry_s*el = l;
     const struct Dwarf_P_debug_str_entry_s*er = r;
-    char *lname =  0;
-    char *rname =  0;
     int ir = 0;
 
-    if (el->dse_has_table_offset) {
-        /*  When set the name is in the debug_str table. */
-        /*  ASSERT: dse_dbg->de_debug_str->ds_data is non-zero.
-            ASSERT: dse_name NULL. */
-        lname = el->dse_dbg->de_debug_str->ds_data +
-            el->dse_table_offset;
-    } else {
-        /*  ASSERT: dse_name non-null */
-        lname = el->dse_name;
+    /*  Most non-matching entries in a hash chain differ
+        in the full hash or the length, so avoid
+        the strcmp for them. */
+    if (el->dse_hash != er->dse_hash) {
+        return (el->dse_hash < er->dse_hash)? -1 : 1;
     }
-    if (er->dse_has_table_offset) {
-        /*  When set the name is in the debug_str table. */
-        /*  ASSERT: dse_dbg->de_debug_str->ds_data is non-zero.
-            ASSERT: dse_name NULL. */
-        rname = er->dse_dbg->de_debug_str->ds_data +
-            er->dse_table_offset;
-    } else {
-        /*  ASSERT: dse_name non-null */
-        rname = er->dse_name;
+    if (el->dse_slen != er->dse_slen) {
+        return (el->dse_slen < er->dse_slen)? -1 : 1;
     }
-    ir = strcmp(lname,rname);
+    ir = strcmp(debug_str_entry_string(el),
+        debug_str_entry_string(er));
     return ir;
 }
 
@@ -354,13 +374,34 @@ debug_str_entry_free_func(void *m)
     free(m);
 }
 
+/*  Sets up an entry on the caller's stack used
+    only to look up name with dwarf_tfind(). */
+static void
+init_debug_str_probe(struct Dwarf_P_debug_str_entry_s *probe,
+    Dwarf_P_Debug dbg,
+    Dwarf_P_Section_Data sd,
+    char *name,
+    unsigned slen)
+{
+    memset(probe,0,sizeof(*probe));
+    probe->dse_dbg = dbg;
+    probe->dse_sd = sd;
+    probe->dse_name = name;
+    probe->dse_slen = slen;
+    probe->dse_has_table_offset = FALSE;
+    probe->dse_hash = debug_str_hash(name);
+}
+
+/*  Makes the entry kept in the hash table. The name is
+    in the string table itself at offset_in_table,
+    the hash was already computed for the probe. */
 static int
 make_debug_str_entry(Dwarf_P_Debug dbg,
     struct Dwarf_P_debug_str_entry_s **mt_out,
-    char *name,
+    Dwarf_P_Section_Data sd,
     unsigned slen,
-    unsigned char has_offset,
     Dwarf_Unsigned offset_in_table,
+    Dwarf_Unsigned hash,
     Dwarf_Error *error)
 {
     struct Dwarf_P_debug_str_entry_s *mt =
@@ -372,22 +413,12 @@ make_debug_str_entry(Dwarf_P_Debug dbg,
     }
 
     mt->dse_slen = slen;
-    mt->dse_table_offset = 0;
     mt->dse_dbg = dbg;
-    if (has_offset) {
-        mt->dse_has_table_offset = TRUE;
-        mt->dse_table_offset = offset_in_table;
-        mt->dse_name = 0;
-    } else {
-        /* ASSERT: name != NULL */
-        mt->dse_has_table_offset = FALSE;
-        /* We just set dse_table_offset so it has
-            a known value, though nothing should refer
-            to dse_table_offset because
-            dse_has_table_offset is FALSE.*/
-        mt->dse_table_offset = 0;
-        mt->dse_name = name;
-    }
+    mt->dse_sd = sd;
+    mt->dse_has_table_offset = TRUE;
+    mt->dse_table_offset = offset_in_table;
+    mt->dse_name = 0;
+    mt->dse_hash = hash;
     *mt_out = mt;
     return DW_DLV_OK;
 }
@@ -470,7 +501,7 @@ _dwarf_insert_or_find_in_debug_str(Dwarf_P_Debug dbg,
     Dwarf_Unsigned *offset_in_debug_str,
     Dwarf_Error *error)
 {
-    struct Dwarf_P_debug_str_entry_s *mt = 0;
+    struct Dwarf_P_debug_str_entry_s probe;
     struct Dwarf_P_debug_str_entry_s *mt2 = 0;
     struct Dwarf_P_debug_str_entry_s *retval = 0;
     struct Dwarf_P_debug_str_entry_s *re = 0;
@@ -497,15 +528,11 @@ _dwarf_insert_or_find_in_debug_str(Dwarf_P_Debug dbg,
         _dwarf_p_error(dbg, error, DW_DLE_STRING_HASHTAB_IDENTITY_ERROR);
         return DW_DLV_ERROR;
     }
-    res = make_debug_str_entry(dbg,&mt,name,
-        slen,FALSE, 0, error);
-    if (res != DW_DLV_OK) {
-        return res;
-    }
+    init_debug_str_probe(&probe,dbg,sd,name,slen);
     /*  We do a find as we do not want the string pointer passed in
         to be in the hash table, we want a pointer into the
         debug_str table in the hash table. */
-    retval = dwarf_tfind(mt,(void *const*)hashtab,
+    retval = dwarf_tfind(&probe,(void *const*)hashtab,
         _dwarf_debug_str_compare_func);
     if (retval) {
 
@@ -514,7 +541,6 @@ _dwarf_insert_or_find_in_debug_str(Dwarf_P_Debug dbg,
 
         re = *(struct Dwarf_P_debug_str_entry_s **)retval;
         *offset_in_debug_str = re->dse_table_offset;
-        debug_str_entry_free_func(mt);
         return DW_DLV_OK;
     }
 
@@ -522,8 +548,6 @@ _dwarf_insert_or_find_in_debug_str(Dwarf_P_Debug dbg,
         Insert it into the big string table and get that
         offset. */
 
-    debug_str_entry_free_func(mt);
-    mt = 0;
     res = insert_debug_str_data_string(dbg,name,slen,sd,
         &adding_at_offset, error);
     if (res != DW_DLV_OK) {
@@ -532,8 +556,8 @@ _dwarf_insert_or_find_in_debug_str(Dwarf_P_Debug dbg,
 
     /*  The name is in the string table itself, so use that pointer
         and offset for the string. */
-    res = make_debug_str_entry(dbg,&mt2, 0,
-        slen,TRUE,adding_at_offset,error);
+    res = make_debug_str_entry(dbg,&mt2,sd,
+        slen,adding_at_offset,probe.dse_hash,error);
     if (res != DW_DLV_OK) {
         return res;
     }
@@ -628,6 +652,269 @@ int _dwarf_pro_set_string_attr(Dwarf_P_Attribute new_attr,
 
 }
 
+/*  Returns, in *offset_out, the .debug_str offset a DW_FORM_strp
+    attribute holds. Returns DW_DLV_NO_ENTRY for other forms. */
+int
+_dwarf_pro_attr_strp_offset(Dwarf_P_Debug dbg,
+    Dwarf_P_Attribute attr,
+    Dwarf_Unsigned *offset_out)
+{
+    Dwarf_Unsigned du = 0;
+
+    if (attr->ar_attribute_form != DW_FORM_strp) {
+        return DW_DLV_NO_ENTRY;
+    }
+    /*  Undo the WRITE_UNALIGNED() done by
+        _dwarf_pro_set_string_attr(): de_copy_word
+        is either memcpy or a byte swap, so applying
+        it again restores the value. */
+#ifdef WORDS_BIGENDIAN
+    dbg->de_copy_word(((char *)&du) + sizeof(du) -
+        attr->ar_nbytes, attr->ar_data,attr->ar_nbytes);
+#else
+    dbg->de_copy_word(&du, attr->ar_data,attr->ar_nbytes);
+#endif
+    *offset_out = du;
+    return DW_DLV_OK;
+}
+
+/*  One string of .debug_str as seen by the tail merge. */
+struct tail_merge_piece_s {
+    char *tm_str;
+    Dwarf_Unsigned tm_len;   /* not counting the NUL */
+    Dwarf_Unsigned tm_old_offset;
+    Dwarf_Unsigned tm_new_offset;
+    /*  Non-null if stored as the tail of that piece. */
+    struct tail_merge_piece_s *tm_host;
+    struct Dwarf_P_debug_str_entry_s *tm_entry;
+};
+
+/*  qsort() comparison putting the strings in decreasing
+    order of their reversed bytes, so a string
+    follows every string it is a suffix of. */
+static int
+tail_merge_compare(const void *l, const void *r)
+{
+    const struct tail_merge_piece_s *pl =
+        *(const struct tail_merge_piece_s *const *)l;
+    const struct tail_merge_piece_s *pr =
+        *(const struct tail_merge_piece_s *const *)r;
+    const unsigned char *cl = (const unsigned char *)
+        pl->tm_str + pl->tm_len;
+    const unsigned char *cr = (const unsigned char *)
+        pr->tm_str + pr->tm_len;
+    Dwarf_Unsigned n = (pl->tm_len < pr->tm_len)?
+        pl->tm_len: pr->tm_len;
+
+    for ( ; n > 0; --n) {
+        --cl;
+        --cr;
+        if (*cl != *cr) {
+            return (*cl < *cr)? 1 : -1;
+        }
+    }
+    if (pl->tm_len != pr->tm_len) {
+        return (pl->tm_len < pr->tm_len)? 1 : -1;
+    }
+    return 0;
+}
+
+/*  Pieces are in old offset order: binary search. */
+static struct tail_merge_piece_s *
+tail_merge_find_piece(struct tail_merge_piece_s *pieces,
+    Dwarf_Unsigned count,
+    Dwarf_Unsigned old_offset)
+{
+    Dwarf_Unsigned lo = 0;
+    Dwarf_Unsigned hi = count;
+
+    while (lo < hi) {
+        Dwarf_Unsigned mid = lo + (hi - lo)/2;
+        struct tail_merge_piece_s *p = pieces + mid;
+
+        if (p->tm_old_offset == old_offset) {
+            return p;
+        }
+        if (p->tm_old_offset < old_offset) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return 0;
+}
+
+/*  Rewrite every DW_FORM_strp in the DIE tree to its
+    offset in the merged .debug_str. */
+static int
+tail_merge_update_dies(Dwarf_P_Debug dbg,
+    struct tail_merge_piece_s *pieces,
+    Dwarf_Unsigned count,
+    Dwarf_Error *error)
+{
+    Dwarf_P_Die curdie = dbg->de_dies;
+
+    while (curdie) {
+        Dwarf_P_Attribute a = curdie->di_attrs;
+
+        for ( ; a ; a = a->ar_next) {
+            Dwarf_Unsigned off = 0;
+            struct tail_merge_piece_s *p = 0;
+            int res = 0;
+
+            res = _dwarf_pro_attr_strp_offset(dbg,a,&off);
+            if (res != DW_DLV_OK) {
+                continue;
+            }
+            p = tail_merge_find_piece(pieces,count,off);
+            if (!p) {
+                _dwarf_p_error(dbg, error, DW_DLE_STRING_OFFSET_BAD);
+                return DW_DLV_ERROR;
+            }
+            off = p->tm_new_offset;
+            WRITE_UNALIGNED(dbg, (void *) a->ar_data,
+                (const void *) &off, sizeof(off), a->ar_nbytes);
+        }
+        if (curdie->di_child) {
+            curdie = curdie->di_child;
+        } else {
+            while (curdie && !curdie->di_right) {
+                curdie = curdie->di_parent;
+            }
+            if (curdie) {
+                curdie = curdie->di_right;
+            }
+        }
+    }
+    return DW_DLV_OK;
+}
+
+/*  When "tail_merge_strings" is in the producer init extra
+    string, rebuild .debug_str so a string which is the
+    tail of another one (as "name" is of ".name")
+    is not stored separately but refers into
+    the longer string.
+    Done once, before the sections are generated,
+    while the only .debug_str offsets in existence
+    are the DW_FORM_strp attributes of the DIEs.
+    Strings added afterwards are simply appended
+    (and still shared through the hash table).  */
+int
+_dwarf_pro_tail_merge_debug_str(Dwarf_P_Debug dbg,
+    Dwarf_Error *error)
+{
+    Dwarf_P_Section_Data sd = dbg->de_debug_str;
+    struct Dwarf_P_Str_stats_s *stats = &dbg->de_stats.ps_strp;
+    struct tail_merge_piece_s *pieces = 0;
+    struct tail_merge_piece_s **sorted = 0;
+    struct tail_merge_piece_s *host = 0;
+    Dwarf_Unsigned count = 0;
+    Dwarf_Unsigned i = 0;
+    Dwarf_Unsigned newsize = 0;
+    char *newdata = 0;
+    char *cp = 0;
+    char *end = 0;
+    int res = 0;
+
+    if (!dbg->de_tail_merge_strings || !sd->ds_data ||
+        !sd->ds_nbytes) {
+        return DW_DLV_OK;
+    }
+    end = sd->ds_data + sd->ds_nbytes;
+    for (cp = sd->ds_data; cp < end; cp += strlen(cp) + 1) {
+        count++;
+    }
+    pieces = (struct tail_merge_piece_s *)
+        calloc(count,sizeof(struct tail_merge_piece_s));
+    sorted = (struct tail_merge_piece_s **)
+        calloc(count,sizeof(struct tail_merge_piece_s *));
+    newdata = (char *)calloc(1,sd->ds_orig_alloc);
+    if (!pieces || !sorted || !newdata) {
+        free(pieces);
+        free(sorted);
+        free(newdata);
+        _dwarf_p_error(dbg, error, DW_DLE_ALLOC_FAIL);
+        return DW_DLV_ERROR;
+    }
+    for (cp = sd->ds_data, i = 0; i < count; ++i) {
+        struct tail_merge_piece_s *p = pieces + i;
+        struct Dwarf_P_debug_str_entry_s probe;
+        void *retval = 0;
+
+        p->tm_str = cp;
+        p->tm_len = strlen(cp);
+        p->tm_old_offset = cp - sd->ds_data;
+        init_debug_str_probe(&probe,dbg,sd,cp,p->tm_len + 1);
+        retval = dwarf_tfind(&probe,
+            (void *const*)&dbg->de_debug_str_hashtab,
+            _dwarf_debug_str_compare_func);
+        if (!retval) {
+            free(pieces);
+            free(sorted);
+            free(newdata);
+            _dwarf_p_error(dbg, error, DW_DLE_ILLOGICAL_TSEARCH);
+            return DW_DLV_ERROR;
+        }
+        p->tm_entry = *(struct Dwarf_P_debug_str_entry_s **)retval;
+        sorted[i] = p;
+        cp += p->tm_len + 1;
+    }
+    qsort(sorted,count,sizeof(struct tail_merge_piece_s *),
+        tail_merge_compare);
+    /*  A string that is a suffix of any string kept so far is
+        a suffix of the most recently kept one. */
+    for (i = 0; i < count; ++i) {
+        struct tail_merge_piece_s *p = sorted[i];
+
+        if (host && p->tm_len <= host->tm_len &&
+            !memcmp(host->tm_str + host->tm_len - p->tm_len,
+                p->tm_str,p->tm_len)) {
+            p->tm_host = host;
+            stats->ps_strp_tail_merged_count++;
+            stats->ps_strp_tail_merged_len += p->tm_len + 1;
+        } else {
+            host = p;
+        }
+    }
+    /*  Kept strings stay in their original order. */
+    for (i = 0; i < count; ++i) {
+        struct tail_merge_piece_s *p = pieces + i;
+
+        if (!p->tm_host) {
+            p->tm_new_offset = newsize;
+            memcpy(newdata + newsize,p->tm_str,p->tm_len + 1);
+            newsize += p->tm_len + 1;
+        }
+    }
+    for (i = 0; i < count; ++i) {
+        struct tail_merge_piece_s *p = pieces + i;
+
+        if (p->tm_host) {
+            p->tm_new_offset = p->tm_host->tm_new_offset +
+                p->tm_host->tm_len - p->tm_len;
+        }
+    }
+    res = tail_merge_update_dies(dbg,pieces,count,error);
+    if (res != DW_DLV_OK) {
+        free(pieces);
+        free(sorted);
+        free(newdata);
+        return res;
+    }
+    /*  The hash table entries keep their cached hash, so
+        only the offsets need updating. */
+    for (i = 0; i < count; ++i) {
+        pieces[i].tm_entry->dse_table_offset =
+            pieces[i].tm_new_offset;
+    }
+    free(sd->ds_data);
+    sd->ds_data = newdata;
+    sd->ds_nbytes = newsize;
+    free(pieces);
+    free(sorted);
+    return DW_DLV_OK;
+}
+
 
 /*-----------------------------------------------------------------------------
     Add AT_name attribute to die
@@ -0,0 +1,804 @@
+/*
+
+  Copyright (C) 2018 David Anderson.  All Rights Reserved.
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of version 2.1 of the GNU Lesser General Public License
+  as published by the Free Software Foundation.
+
+  This program is distributed in the hope that it would be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  Further, this software is distributed without any warranty that it is
+  free of the rightful claim of any third person regarding infringement
+  or the like.  Any license provided herein, whether implied or
+  otherwise, applies only to this software file.  Patent licenses, if
+  any, provided herein do not apply to combinations of this program with
+  other software, or any other product whatsoever.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program; if not, write the Free Software
+  Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston MA 02110-1301,
+  USA.
+
+*/
+
+/*  Producer support for the DWARF5 .debug_names section
+    (DWARF5 section 6.1.1).
+
+    We produce a single per-module name index covering
+    the one compilation unit the producer creates.
+    There are no type units, so neither DW_IDX_compile_unit
+    nor DW_IDX_type_unit is needed in the entries: each
+    entry is just an abbreviation code (one per DIE tag)
+    and a DW_IDX_die_offset in DW_FORM_ref4.
+
+    Names are collected in dwarf_transform_to_disk_form_a()
+    before any section is generated so every name is in
+    .debug_str before .debug_str is written (and before
+    the section list is created, so .debug_str exists even
+    if all DW_AT_name attributes are DW_FORM_string).
+    The section itself is written after .debug_info, once
+    the DIE offsets are known. */
+
+#include "config.h"
+#include "libdwarfdefs.h"
+#include <stdio.h>
+#include <string.h>
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif /* HAVE_STDLIB_H */
+#ifdef HAVE_ELFACCESS_H
+#include <elfaccess.h>
+#endif
+#include "pro_incl.h"
+#include "pro_section.h"
+#include "pro_encode_nm.h"
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+/*  One indexed DIE. The same name may appear in several
+    of these, they become one name table entry with
+    several entries in the entry pool. */
+struct Dwarf_P_Dnames_entry_s {
+    Dwarf_P_Die    dne_die;
+    Dwarf_Unsigned dne_str_offset; /* in .debug_str */
+    Dwarf_Unsigned dne_hash;
+    Dwarf_Unsigned dne_bucket;
+    Dwarf_Unsigned dne_seq;   /* DIE tree order, keeps sort stable */
+    Dwarf_Half     dne_tag;
+};
+
+struct Dwarf_P_Dnames_s {
+    /*  Sorted by bucket, then hash, then string offset,
+        so entries for a name are adjacent and names
+        in a bucket are adjacent. */
+    struct Dwarf_P_Dnames_entry_s *dn_entries;
+    Dwarf_Unsigned dn_entry_count;
+
+    /* Count of unique names (the name table size) */
+    Dwarf_Unsigned dn_name_count;
+    Dwarf_Unsigned dn_bucket_count;
+};
+
+/*  The default tag policy. These are the tags DWARF5
+    section 6.1.1.1 lists as belonging in the index
+    for C and C++. */
+static Dwarf_Half default_dnames_tags[] = {
+    DW_TAG_base_type,
+    DW_TAG_class_type,
+    DW_TAG_enumeration_type,
+    DW_TAG_enumerator,
+    DW_TAG_imported_declaration,
+    DW_TAG_inlined_subroutine,
+    DW_TAG_interface_type,
+    DW_TAG_namespace,
+    DW_TAG_ptr_to_member_type,
+    DW_TAG_structure_type,
+    DW_TAG_subprogram,
+    DW_TAG_subrange_type,
+    DW_TAG_typedef,
+    DW_TAG_union_type,
+    DW_TAG_unspecified_type,
+    DW_TAG_variable,
+};
+
+/*  Replaces the tag policy for .debug_names.
+    A tag_count of zero suppresses .debug_names.
+    Must be called before dwarf_transform_to_disk_form*(). */
+int
+dwarf_pro_set_debug_names_tags(Dwarf_P_Debug dbg,
+    Dwarf_Half *tags,
+    Dwarf_Unsigned tag_count,
+    Dwarf_Error * error)
+{
+    Dwarf_Half *newtags = 0;
+
+    if (!dbg) {
+        _dwarf_p_error(NULL, error, DW_DLE_IA);
+        return DW_DLV_ERROR;
+    }
+    if (tag_count && !tags) {
+        _dwarf_p_error(dbg, error, DW_DLE_IA);
+        return DW_DLV_ERROR;
+    }
+    if (tag_count) {
+        newtags = (Dwarf_Half *)_dwarf_p_get_alloc(dbg,
+            tag_count * sizeof(Dwarf_Half));
+        if (!newtags) {
+            _dwarf_p_error(dbg, error, DW_DLE_ALLOC_FAIL);
+            return DW_DLV_ERROR;
+        }
+        memcpy(newtags,tags,tag_count * sizeof(Dwarf_Half));
+    }
+    if (dbg->de_dnames_tags) {
+        _dwarf_p_dealloc(dbg,(Dwarf_Small *)dbg->de_dnames_tags);
+    }
+    dbg->de_dnames_tags = newtags;
+    dbg->de_dnames_tag_count = tag_count;
+    dbg->de_dnames_tags_set = 1;
+    return DW_DLV_OK;
+}
+
+/*  The DWARF5 section 7.33 hash (Bernstein's djb hash)
+    applied to the case-folded name, as DWARF5 6.1.1.4.5
+    asks. Only ASCII letters are folded. */
+static Dwarf_Unsigned
+dnames_hash(const char *name)
+{
+    const unsigned char *cp = (const unsigned char *)name;
+    Dwarf_Unsigned h = 5381;
+
+    for ( ; *cp; ++cp) {
+        unsigned c = *cp;
+
+        if (c >= 'A' && c <= 'Z') {
+            c = c - 'A' + 'a';
+        }
+        h = ((h << 5) + h + c) & 0xffffffff;
+    }
+    return h;
+}
+
+/*  The bucket counts llvm uses: roughly one bucket for
+    every two names, fewer for big tables. */
+static Dwarf_Unsigned
+dnames_bucket_count(Dwarf_Unsigned name_count)
+{
+    if (name_count > 1024) {
+        return name_count / 4;
+    }
+    if (name_count > 16) {
+        return name_count / 2;
+    }
+    return name_count? name_count : 1;
+}
+
+static int
+dnames_tag_wanted(Dwarf_P_Debug dbg, Dwarf_Half tag)
+{
+    Dwarf_Half *tags = default_dnames_tags;
+    unsigned count = sizeof(default_dnames_tags)/
+        sizeof(default_dnames_tags[0]);
+    unsigned i = 0;
+
+    if (dbg->de_dnames_tags_set) {
+        tags = dbg->de_dnames_tags;
+        count = dbg->de_dnames_tag_count;
+    }
+    for (i = 0; i < count; ++i) {
+        if (tags[i] == tag) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/*  A DIE with no DW_AT_name of its own takes its name
+    from its DW_AT_abstract_origin or DW_AT_specification
+    DIE (DWARF5 6.1.1.1). The limit guards against
+    reference cycles. */
+#define DNAMES_ORIGIN_DEPTH 4
+
+static Dwarf_P_Attribute
+dnames_find_name(Dwarf_P_Die die)
+{
+    unsigned depth = 0;
+
+    for ( ; die && depth < DNAMES_ORIGIN_DEPTH; ++depth) {
+        Dwarf_P_Attribute a = 0;
+        Dwarf_P_Die origin = 0;
+
+        for (a = die->di_attrs; a; a = a->ar_next) {
+            if (a->ar_attribute == DW_AT_name) {
+                return a;
+            }
+            if (a->ar_attribute == DW_AT_abstract_origin ||
+                a->ar_attribute == DW_AT_specification) {
+                origin = a->ar_ref_die;
+            }
+        }
+        die = origin;
+    }
+    return 0;
+}
+
+/*  TRUE if a DW_AT_location gives the variable a static
+    address: the expression starts with DW_OP_addr or ends
+    with a TLS operator.  A location list or a frame based
+    expression is an automatic variable. */
+static int
+dnames_location_is_static(Dwarf_P_Attribute loc)
+{
+    unsigned char *p = (unsigned char *)loc->ar_data;
+    unsigned char *end = p + loc->ar_nbytes;
+    unsigned char last = 0;
+
+    switch (loc->ar_attribute_form) {
+    case DW_FORM_block1:
+        p += 1;
+        break;
+    case DW_FORM_block2:
+        p += 2;
+        break;
+    case DW_FORM_block4:
+        p += 4;
+        break;
+    case DW_FORM_block:
+    case DW_FORM_exprloc:
+        /* Skip the ULEB128 length. */
+        while (p < end && (*p & 0x80)) {
+            ++p;
+        }
+        ++p;
+        break;
+    default:
+        return FALSE;
+    }
+    if (p >= end) {
+        return FALSE;
+    }
+    if (*p == DW_OP_addr) {
+        return TRUE;
+    }
+    last = end[-1];
+    return last == DW_OP_form_tls_address ||
+        last == DW_OP_GNU_push_tls_address;
+}
+
+/*  Declarations are not indexed, nor are subprograms
+    and inlined subroutines without an address
+    (DWARF5 6.1.1.1): so an abstract instance root is
+    left out and its concrete instances are indexed.
+    Variables at file or namespace scope are indexed.
+    Inside a function only a variable with a static
+    address (a function-scope static) is, which leaves
+    out locals and parameters. */
+static int
+dnames_die_wanted(Dwarf_P_Debug dbg, Dwarf_P_Die die,
+    Dwarf_P_Attribute *name_attr_out)
+{
+    Dwarf_P_Attribute a = 0;
+    Dwarf_P_Attribute name_attr = 0;
+    Dwarf_P_Attribute location = 0;
+    int has_address = FALSE;
+
+    if (!dnames_tag_wanted(dbg,die->di_tag)) {
+        return FALSE;
+    }
+    for (a = die->di_attrs; a; a = a->ar_next) {
+        switch (a->ar_attribute) {
+        case DW_AT_declaration:
+            return FALSE;
+        case DW_AT_low_pc:
+        case DW_AT_high_pc:
+        case DW_AT_ranges:
+        case DW_AT_entry_pc:
+            has_address = TRUE;
+            break;
+        case DW_AT_location:
+            location = a;
+            break;
+        default:
+            break;
+        }
+    }
+    if (!has_address && (die->di_tag == DW_TAG_subprogram ||
+        die->di_tag == DW_TAG_inlined_subroutine)) {
+        return FALSE;
+    }
+    if (die->di_tag == DW_TAG_variable) {
+        Dwarf_P_Die parent = die->di_parent;
+
+        if (!parent) {
+            return FALSE;
+        }
+        if (parent->di_tag != DW_TAG_compile_unit &&
+            parent->di_tag != DW_TAG_partial_unit &&
+            parent->di_tag != DW_TAG_namespace &&
+            (!location || !dnames_location_is_static(location))) {
+            return FALSE;
+        }
+    }
+    name_attr = dnames_find_name(die);
+    if (!name_attr) {
+        return FALSE;
+    }
+    *name_attr_out = name_attr;
+    return TRUE;
+}
+
+/*  Returns the .debug_str offset of the name, adding the
+    name to .debug_str if it is a DW_FORM_string.
+    DW_DLV_NO_ENTRY for string forms we cannot index
+    (there are none others at present). */
+static int
+dnames_name_offset(Dwarf_P_Debug dbg, Dwarf_P_Attribute attr,
+    Dwarf_Unsigned *offset_out,
+    const char **name_out,
+    Dwarf_Error *error)
+{
+    if (attr->ar_attribute_form == DW_FORM_string) {
+        char *name = attr->ar_data;
+        int res = 0;
+
+        res = _dwarf_insert_or_find_in_debug_str(dbg,name,
+            _dwarf_hash_debug_str,strlen(name)+1,
+            offset_out,error);
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        *name_out = name;
+        return DW_DLV_OK;
+    }
+    if (attr->ar_attribute_form == DW_FORM_strp) {
+        Dwarf_Unsigned du = 0;
+
+        _dwarf_pro_attr_strp_offset(dbg,attr,&du);
+        if (du >= dbg->de_debug_str->ds_nbytes) {
+            _dwarf_p_error(dbg, error, DW_DLE_STRING_OFFSET_BAD);
+            return DW_DLV_ERROR;
+        }
+        *offset_out = du;
+        *name_out = dbg->de_debug_str->ds_data + du;
+        return DW_DLV_OK;
+    }
+    return DW_DLV_NO_ENTRY;
+}
+
+/*  Walks the DIE tree depth first (as
+    _dwarf_pro_generate_debuginfo() does).
+    With entries NULL this just counts. */
+static int
+dnames_walk_dies(Dwarf_P_Debug dbg,
+    struct Dwarf_P_Dnames_entry_s *entries,
+    Dwarf_Unsigned *count_out,
+    Dwarf_Error *error)
+{
+    Dwarf_P_Die curdie = dbg->de_dies;
+    Dwarf_Unsigned count = 0;
+
+    while (curdie) {
+        Dwarf_P_Attribute name_attr = 0;
+
+        if (dnames_die_wanted(dbg,curdie,&name_attr)) {
+            if (entries) {
+                struct Dwarf_P_Dnames_entry_s *e = entries + count;
+                const char *name = 0;
+                int res = 0;
+
+                res = dnames_name_offset(dbg,name_attr,
+                    &e->dne_str_offset,&name,error);
+                if (res == DW_DLV_ERROR) {
+                    return res;
+                }
+                if (res == DW_DLV_OK) {
+                    e->dne_die = curdie;
+                    e->dne_tag = curdie->di_tag;
+                    e->dne_hash = dnames_hash(name);
+                    e->dne_seq = count;
+                    count++;
+                }
+            } else {
+                count++;
+            }
+        }
+        if (curdie->di_child) {
+            curdie = curdie->di_child;
+        } else {
+            while (curdie && !curdie->di_right) {
+                curdie = curdie->di_parent;
+            }
+            if (curdie) {
+                curdie = curdie->di_right;
+            }
+        }
+    }
+    *count_out = count;
+    return DW_DLV_OK;
+}
+
+static int
+dnames_compare_offset(const void *l, const void *r)
+{
+    const struct Dwarf_P_Dnames_entry_s *le = l;
+    const struct Dwarf_P_Dnames_entry_s *re = r;
+
+    if (le->dne_str_offset != re->dne_str_offset) {
+        return le->dne_str_offset < re->dne_str_offset? -1:1;
+    }
+    if (le->dne_seq != re->dne_seq) {
+        return le->dne_seq < re->dne_seq? -1:1;
+    }
+    return 0;
+}
+
+static int
+dnames_compare_bucket(const void *l, const void *r)
+{
+    const struct Dwarf_P_Dnames_entry_s *le = l;
+    const struct Dwarf_P_Dnames_entry_s *re = r;
+
+    if (le->dne_bucket != re->dne_bucket) {
+        return le->dne_bucket < re->dne_bucket? -1:1;
+    }
+    if (le->dne_hash != re->dne_hash) {
+        return le->dne_hash < re->dne_hash? -1:1;
+    }
+    return dnames_compare_offset(l,r);
+}
+
+/*  Called before the section list is created.
+    Leaves dbg->de_dnames NULL if there is nothing to index. */
+int
+_dwarf_pro_collect_debug_names(Dwarf_P_Debug dbg,
+    Dwarf_Error *error)
+{
+    struct Dwarf_P_Dnames_s *dn = 0;
+    struct Dwarf_P_Dnames_entry_s *entries = 0;
+    Dwarf_Unsigned count = 0;
+    Dwarf_Unsigned names = 0;
+    Dwarf_Unsigned i = 0;
+    int res = 0;
+
+    if (dbg->de_output_version != 5 || !dbg->de_dies) {
+        return DW_DLV_OK;
+    }
+    res = dnames_walk_dies(dbg,0,&count,error);
+    if (res != DW_DLV_OK) {
+        return res;
+    }
+    if (!count) {
+        return DW_DLV_OK;
+    }
+    entries = (struct Dwarf_P_Dnames_entry_s *)
+        _dwarf_p_get_alloc(dbg, count * sizeof(*entries));
+    if (!entries) {
+        _dwarf_p_error(dbg, error, DW_DLE_ALLOC_FAIL);
+        return DW_DLV_ERROR;
+    }
+    res = dnames_walk_dies(dbg,entries,&count,error);
+    if (res != DW_DLV_OK) {
+        _dwarf_p_dealloc(dbg,(Dwarf_Small *)entries);
+        return res;
+    }
+    if (!count) {
+        _dwarf_p_dealloc(dbg,(Dwarf_Small *)entries);
+        return DW_DLV_OK;
+    }
+
+    /*  Identical strings share a .debug_str offset, so
+        the offset identifies the name. */
+    qsort(entries,count,sizeof(*entries),dnames_compare_offset);
+    for (i = 0; i < count; ++i) {
+        if (!i || entries[i].dne_str_offset !=
+            entries[i-1].dne_str_offset) {
+            names++;
+        }
+    }
+    dn = (struct Dwarf_P_Dnames_s *)
+        _dwarf_p_get_alloc(dbg, sizeof(*dn));
+    if (!dn) {
+        _dwarf_p_dealloc(dbg,(Dwarf_Small *)entries);
+        _dwarf_p_error(dbg, error, DW_DLE_ALLOC_FAIL);
+        return DW_DLV_ERROR;
+    }
+    dn->dn_entries = entries;
+    dn->dn_entry_count = count;
+    dn->dn_name_count = names;
+    dn->dn_bucket_count = dnames_bucket_count(names);
+    for (i = 0; i < count; ++i) {
+        entries[i].dne_bucket = entries[i].dne_hash %
+            dn->dn_bucket_count;
+    }
+    qsort(entries,count,sizeof(*entries),dnames_compare_bucket);
+    dbg->de_dnames = dn;
+    return DW_DLV_OK;
+}
+
+/*  Abbreviation code for a tag: its index in the table
+    of tags used, plus one. */
+static Dwarf_Unsigned
+dnames_abbrev_code(Dwarf_Half *tags, unsigned tagcount,
+    Dwarf_Half tag)
+{
+    unsigned i = 0;
+
+    for (i = 0; i < tagcount; ++i) {
+        if (tags[i] == tag) {
+            return i+1;
+        }
+    }
+    /* Cannot happen, all tags were added. */
+    return 0;
+}
+
+static unsigned
+dnames_uleb_len(Dwarf_Unsigned val)
+{
+    unsigned len = 1;
+
+    while (val >= 0x80) {
+        val >>= 7;
+        len++;
+    }
+    return len;
+}
+
+static int
+dnames_append_uleb(Dwarf_P_Debug dbg, Dwarf_Unsigned val,
+    Dwarf_Small **data, Dwarf_Error *error)
+{
+    char buff1[ENCODE_SPACE_NEEDED];
+    int nbytes = 0;
+    int res = 0;
+
+    res = _dwarf_pro_encode_leb128_nm(val, &nbytes,
+        buff1, sizeof(buff1));
+    if (res != DW_DLV_OK) {
+        DWARF_P_DBG_ERROR(dbg, DW_DLE_LEB_OUT_ERROR, DW_DLV_ERROR);
+    }
+    memcpy(*data,buff1,nbytes);
+    *data += nbytes;
+    return DW_DLV_OK;
+}
+
+#define DNAMES_UWORD 4 /* Size of the fixed 4 byte fields */
+/* See pro_section.c */
+#define OFFSET_PLUS_EXTENSION_SIZE (offset_size + extension_size)
+#define DNAMES_DIE_OFFSET_SIZE 4 /* DW_FORM_ref4 */
+
+/*  Writes .debug_names, DWARF5 section 6.1.1.4. */
+int
+_dwarf_pro_generate_debug_names(Dwarf_P_Debug dbg,
+    Dwarf_Signed *nbufs,
+    Dwarf_Error * error)
+{
+    struct Dwarf_P_Dnames_s *dn = dbg->de_dnames;
+    struct Dwarf_P_Dnames_entry_s *entries = 0;
+    Dwarf_Unsigned count = 0;
+    Dwarf_Unsigned names = 0;
+    Dwarf_Unsigned buckets = 0;
+    int offset_size = dbg->de_offset_size;
+    int extension_size = dbg->de_64bit_extension ? 4 : 0;
+    int sectno = dbg->de_elf_sects[DEBUG_NAMES];
+    Dwarf_Half *tags = 0;
+    unsigned tagcount = 0;
+    Dwarf_Unsigned abbrev_table_size = 0;
+    Dwarf_Unsigned entry_pool_size = 0;
+    Dwarf_Unsigned header_size = 0;
+    Dwarf_Unsigned total_size = 0;
+    Dwarf_Unsigned adjusted_length = 0;
+    Dwarf_Small *data = 0;
+    Dwarf_Small *start = 0;
+    Dwarf_Small *bucketp = 0;
+    Dwarf_Small *hashp = 0;
+    Dwarf_Small *strp = 0;
+    Dwarf_Small *entryoffp = 0;
+    Dwarf_Unsigned pool_offset = 0;
+    Dwarf_Unsigned name_index = 0;
+    Dwarf_Unsigned i = 0;
+    Dwarf_Unsigned du = 0;
+    int res = 0;
+
+    if (dbg->de_output_version != 5) {
+        DWARF_P_DBG_ERROR(dbg, DW_DLE_VERSION_STAMP_ERROR,
+            DW_DLV_ERROR);
+    }
+    if (!dn) {
+        return DW_DLV_NO_ENTRY;
+    }
+    entries = dn->dn_entries;
+    count = dn->dn_entry_count;
+    names = dn->dn_name_count;
+    buckets = dn->dn_bucket_count;
+
+    /*  The tags actually used. At most one per entry. */
+    tags = (Dwarf_Half *)_dwarf_p_get_alloc(dbg,
+        count * sizeof(Dwarf_Half));
+    if (!tags) {
+        _dwarf_p_error(dbg, error, DW_DLE_ALLOC_FAIL);
+        return DW_DLV_ERROR;
+    }
+    for (i = 0; i < count; ++i) {
+        Dwarf_Half tag = entries[i].dne_tag;
+
+        if (!dnames_abbrev_code(tags,tagcount,tag)) {
+            tags[tagcount++] = tag;
+        }
+    }
+    for (i = 0; i < tagcount; ++i) {
+        abbrev_table_size += dnames_uleb_len(i+1) +
+            dnames_uleb_len(tags[i]) +
+            dnames_uleb_len(DW_IDX_die_offset) +
+            dnames_uleb_len(DW_FORM_ref4) +
+            2; /* 0,0 */
+    }
+    abbrev_table_size += 1; /* Terminating 0 */
+    for (i = 0; i < count; ++i) {
+        entry_pool_size += dnames_uleb_len(
+            dnames_abbrev_code(tags,tagcount,entries[i].dne_tag)) +
+            DNAMES_DIE_OFFSET_SIZE;
+    }
+    entry_pool_size += names; /* Terminating 0 per name */
+
+    header_size = OFFSET_PLUS_EXTENSION_SIZE +
+        sizeof(Dwarf_Half) + /* version */
+        sizeof(Dwarf_Half) + /* padding */
+        7 * DNAMES_UWORD;    /* counts and sizes */
+    total_size = header_size +
+        offset_size +                 /* CU list, one CU */
+        buckets * DNAMES_UWORD +
+        names * DNAMES_UWORD +        /* hashes */
+        names * offset_size +         /* string offsets */
+        names * offset_size +         /* entry offsets */
+        abbrev_table_size +
+        entry_pool_size;
+
+    GET_CHUNK(dbg, sectno, data, total_size, error);
+    start = data;
+    memset(data,0,total_size);
+
+    if (extension_size) {
+        du = DISTINGUISHED_VALUE;
+        WRITE_UNALIGNED(dbg, data, (const void *)&du,
+            sizeof(du), extension_size);
+        data += extension_size;
+    }
+    adjusted_length = total_size - OFFSET_PLUS_EXTENSION_SIZE;
+    WRITE_UNALIGNED(dbg, data, (const void *)&adjusted_length,
+        sizeof(adjusted_length), offset_size);
+    data += offset_size;
+    {
+        Dwarf_Half verstamp = 5;
+
+        WRITE_UNALIGNED(dbg, data, (const void *)&verstamp,
+            sizeof(verstamp), sizeof(Dwarf_Half));
+        /* padding is already zero */
+        data += 2*sizeof(Dwarf_Half);
+    }
+    du = 1; /* comp_unit_count */
+    WRITE_UNALIGNED(dbg, data, (const void *)&du,
+        sizeof(du), DNAMES_UWORD);
+    data += DNAMES_UWORD;
+    /* local_type_unit_count and foreign_type_unit_count are zero. */
+    data += 2*DNAMES_UWORD;
+    WRITE_UNALIGNED(dbg, data, (const void *)&buckets,
+        sizeof(buckets), DNAMES_UWORD);
+    data += DNAMES_UWORD;
+    WRITE_UNALIGNED(dbg, data, (const void *)&names,
+        sizeof(names), DNAMES_UWORD);
+    data += DNAMES_UWORD;
+    WRITE_UNALIGNED(dbg, data, (const void *)&abbrev_table_size,
+        sizeof(abbrev_table_size), DNAMES_UWORD);
+    data += DNAMES_UWORD;
+    /* augmentation_string_size is zero, no augmentation string. */
+    data += DNAMES_UWORD;
+
+    /*  The CU list: our one CU is at .debug_info offset zero,
+        which is already in place. */
+    res = dbg->de_relocate_by_name_symbol(dbg,
+        DEBUG_NAMES, data - start,
+        dbg->de_sect_name_idx[DEBUG_INFO],
+        dwarf_drt_data_reloc, offset_size);
+    if (res != DW_DLV_OK) {
+        DWARF_P_DBG_ERROR(dbg, DW_DLE_REL_ALLOC, DW_DLV_ERROR);
+    }
+    data += offset_size;
+
+    bucketp = data;
+    hashp = bucketp + buckets * DNAMES_UWORD;
+    strp = hashp + names * DNAMES_UWORD;
+    entryoffp = strp + names * offset_size;
+    data = entryoffp + names * offset_size;
+
+    for (i = 0; i < tagcount; ++i) {
+        res = dnames_append_uleb(dbg,i+1,&data,error);
+        if (res == DW_DLV_OK) {
+            res = dnames_append_uleb(dbg,tags[i],&data,error);
+        }
+        if (res == DW_DLV_OK) {
+            res = dnames_append_uleb(dbg,DW_IDX_die_offset,
+                &data,error);
+        }
+        if (res == DW_DLV_OK) {
+            res = dnames_append_uleb(dbg,DW_FORM_ref4,&data,error);
+        }
+        if (res != DW_DLV_OK) {
+            return res;
+        }
+        /* The 0,0 pair is already zero. */
+        data += 2;
+    }
+    /* Terminating 0 of the abbrev table. */
+    data += 1;
+
+    /*  Entries are sorted so each name's entries are
+        adjacent, names are in bucket order. */
+    for (i = 0; i < count; ) {
+        struct Dwarf_P_Dnames_entry_s *e = entries + i;
+        Dwarf_Unsigned nameoff = e->dne_str_offset;
+
+        /*  name_index is zero based here, buckets hold
+            the one-based index of a bucket's first name. */
+        if (!name_index || e->dne_bucket !=
+            entries[i-1].dne_bucket) {
+            du = name_index + 1;
+            WRITE_UNALIGNED(dbg,
+                bucketp + e->dne_bucket * DNAMES_UWORD,
+                (const void *)&du, sizeof(du), DNAMES_UWORD);
+        }
+        WRITE_UNALIGNED(dbg, hashp + name_index * DNAMES_UWORD,
+            (const void *)&e->dne_hash, sizeof(e->dne_hash),
+            DNAMES_UWORD);
+        WRITE_UNALIGNED(dbg, strp + name_index * offset_size,
+            (const void *)&nameoff, sizeof(nameoff), offset_size);
+        res = dbg->de_relocate_by_name_symbol(dbg,
+            DEBUG_NAMES,
+            (strp + name_index * offset_size) - start,
+            dbg->de_sect_name_idx[DEBUG_STR],
+            dwarf_drt_data_reloc, offset_size);
+        if (res != DW_DLV_OK) {
+            DWARF_P_DBG_ERROR(dbg, DW_DLE_REL_ALLOC, DW_DLV_ERROR);
+        }
+        WRITE_UNALIGNED(dbg, entryoffp + name_index * offset_size,
+            (const void *)&pool_offset, sizeof(pool_offset),
+            offset_size);
+        for ( ; i < count && entries[i].dne_str_offset == nameoff;
+            ++i) {
+            Dwarf_Small *entstart = data;
+
+            e = entries + i;
+            res = dnames_append_uleb(dbg,
+                dnames_abbrev_code(tags,tagcount,e->dne_tag),
+                &data,error);
+            if (res != DW_DLV_OK) {
+                return res;
+            }
+            /*  Our single CU starts at offset zero, so the
+                .debug_info offset is the CU relative offset. */
+            WRITE_UNALIGNED(dbg, data,
+                (const void *)&e->dne_die->di_offset,
+                sizeof(e->dne_die->di_offset),
+                DNAMES_DIE_OFFSET_SIZE);
+            data += DNAMES_DIE_OFFSET_SIZE;
+            pool_offset += data - entstart;
+        }
+        /* The terminating 0 for this name is already zero. */
+        data += 1;
+        pool_offset += 1;
+        name_index++;
+    }
+    _dwarf_p_dealloc(dbg,(Dwarf_Small *)tags);
+    if ((Dwarf_Unsigned)(data - start) != total_size) {
+        DWARF_P_DBG_ERROR(dbg, DW_DLE_SECT_ALLOC, DW_DLV_ERROR);
+    }
+    *nbufs = dbg->de_n_debug_sect;
+    return DW_DLV_OK;
+}
@@ -89,3 +89,27 @@ dwarf_pro_get_string_stats(Dwarf_P_Debug dbg,
     return DW_DLV_OK;
 }
 
+
+/*  Counts for the "tail_merge_strings" producer option:
+    the number of .debug_str strings stored as the tail
+    of another string and the bytes so saved. */
+int
+dwarf_pro_get_string_tail_merge_stats(Dwarf_P_Debug dbg,
+    Dwarf_Unsigned * tail_merged_count,
+    Dwarf_Unsigned * tail_merged_len,
+    Dwarf_Error    * error)
+{
+    struct Dwarf_P_Str_stats_s* ps = 0;
+    if (!dbg) {
+        _dwarf_p_error(dbg, error, DW_DLE_IA);
+        return DW_DLV_ERROR;
+    }
+    if (dbg->de_version_magic_number !=PRO_VERSION_MAGIC ) {
+        _dwarf_p_error(dbg, error, DW_DLE_VMM);
+        return DW_DLV_ERROR;
+    }
+    ps = &dbg->de_stats.ps_strp;
+    *tail_merged_count = ps->ps_strp_tail_merged_count;
+    *tail_merged_len   = ps->ps_strp_tail_merged_len;
+    return DW_DLV_OK;
+}
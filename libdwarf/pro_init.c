@@ -135,6 +135,51 @@ static struct Dwarf_P_Section_Data_s init_sect_debug_line_str = {
     then pass a NULL pointer or an empty string as the 'extra'
     parameter.
     */
+/*  Returns 1 if the comma-separated list
+    contains exactly the word name. */
+static int
+extra_has_word(const char *extra, const char *name)
+{
+    size_t namelen = strlen(name);
+    const char *cp = extra;
+
+    while (*cp) {
+        const char *end = strchr(cp,',');
+        size_t len = end? (size_t)(end - cp) : strlen(cp);
+
+        if (len == namelen && !strncmp(cp,name,len)) {
+            return 1;
+        }
+        if (!end) {
+            break;
+        }
+        cp = end + 1;
+    }
+    return 0;
+}
+
+/*  Unknown words in extra are ignored, in the tolerant
+    spirit described above.
+    Known words:
+    contiguous_sections  Each output section in a single
+        growing buffer, see _dwarf_pro_buffer().
+    tail_merge_strings  Store a .debug_str string that is the
+        tail of another string inside that string,
+        see _dwarf_pro_tail_merge_debug_str(). */
+static void
+set_extras(Dwarf_P_Debug dbg, const char *extra)
+{
+    if (!extra) {
+        return;
+    }
+    if (extra_has_word(extra,"contiguous_sections")) {
+        dbg->de_contiguous_sections = 1;
+    }
+    if (extra_has_word(extra,"tail_merge_strings")) {
+        dbg->de_tail_merge_strings = 1;
+    }
+}
+
 int
 dwarf_producer_init(Dwarf_Unsigned flags,
     Dwarf_Callback_Func func,
@@ -143,7 +188,7 @@ dwarf_producer_init(Dwarf_Unsigned flags,
     void * user_data,
     const char *isa_name, /* See isa_reloc_s. */
     const char *dwarf_version, /* V2 V3 V4 or V5. */
-    UNUSEDARG const char *extra, /* Extra input strings, comma separated. */
+    const char *extra, /* Extra input strings, comma separated. */
     Dwarf_P_Debug *dbg_returned,
     Dwarf_Error * error)
 {
@@ -170,6 +215,7 @@ dwarf_producer_init(Dwarf_Unsigned flags,
     if (res != DW_DLV_OK) {
         DWARF_P_DBG_ERROR(dbg, err_ret, DW_DLV_ERROR);
     }
+    set_extras(dbg,extra);
     *dbg_returned = dbg;
     return DW_DLV_OK;
 }
@@ -219,35 +265,16 @@ set_reloc_numbers(Dwarf_P_Debug dbg,
     /* UNREACHED */
 }
 
-/*  This is the Daniel J Bernstein hash function
-    originally posted to Usenet news.
-    http://en.wikipedia.org/wiki/List_of_hash_functions or
-    http://stackoverflow.com/questions/10696223/reason-for-5381-number-in-djb-hash-function).
-*/
+/*  The Daniel J Bernstein hash of the string was computed
+    once when the entry was made (see make_debug_str_entry()),
+    so there is no need to rescan the string here. */
 static DW_TSHASHTYPE
 simple_string_hashfunc(const void *keyp)
 {
-    struct Dwarf_P_debug_str_entry_s* mt =
-        (struct Dwarf_P_debug_str_entry_s*) keyp;
-    DW_TSHASHTYPE up = 0;
-    const char *str = 0;
-    DW_TSHASHTYPE hash = 5381;
-    int c  = 0;
-
-    if (mt->dse_has_table_offset) {
-        /*  ASSERT: mt->dse_dbg->de_debug_str->ds_data not zero. */
-        str = (const char *)mt->dse_dbg->de_debug_str->ds_data +
-            mt->dse_table_offset;
-    } else {
-        /*  ASSERT: dse_name != 0 */
-        str = (const char *)mt->dse_name;
-    }
-    /*  Extra parens suppress warning about assign in test. */
-    while ((c = *str++)) {
-        hash = hash * 33 + c ;
-    }
-    up = hash;
-    return up;
+    const struct Dwarf_P_debug_str_entry_s* mt =
+        (const struct Dwarf_P_debug_str_entry_s*) keyp;
+
+    return (DW_TSHASHTYPE)mt->dse_hash;
 }
 
 
@@ -370,9 +370,18 @@ struct Dwarf_P_debug_str_entry_s {
     Dwarf_Unsigned dse_table_offset;
 
     /*  For tsearch a hash table exists and we have a table offset.
-        dse_dbg->de_debug_str->ds_data + dse_table_offset
+        dse_sd->ds_data + dse_table_offset
         points to the string iff dse_has_table_offset != 0. */
     unsigned char  dse_has_table_offset;
+
+    /*  The string table (.debug_str or .debug_line_str)
+        this entry belongs to. */
+    Dwarf_P_Section_Data dse_sd;
+
+    /*  Hash of the string, computed once by
+        make_debug_str_entry() so the tsearch hash
+        function and rehashing do not rescan the string. */
+    Dwarf_Unsigned dse_hash;
 };
 
 struct Dwarf_P_Str_stats_s {
@@ -381,6 +390,10 @@ struct Dwarf_P_Str_stats_s {
     Dwarf_Unsigned ps_strp_len_debug_line_str;
     Dwarf_Unsigned ps_strp_reused_count;
     Dwarf_Unsigned ps_strp_reused_len;
+    /*  Strings stored as the tail of another string
+        by _dwarf_pro_tail_merge_debug_str(). */
+    Dwarf_Unsigned ps_strp_tail_merged_count;
+    Dwarf_Unsigned ps_strp_tail_merged_len;
 };
 
 struct Dwarf_P_Stats_s {
@@ -574,6 +587,36 @@ struct Dwarf_P_Debug_s {
     struct Dwarf_P_Line_Inits_s de_line_inits;
 
     struct Dwarf_P_Stats_s de_stats;
+
+    /*  Non-zero if "contiguous_sections" was passed in the
+        dwarf_producer_init() extra string. Each output section is
+        then one buffer grown geometrically by _dwarf_pro_buffer()
+        instead of a list of CHUNK_SIZE blocks. */
+    unsigned char de_contiguous_sections;
+
+    /*  Bump allocation state for _dwarf_p_get_alloc():
+        the unused part of the current arena block. */
+    char *de_arena_next;
+    char *de_arena_end;
+
+    /*  .debug_names (DWARF5) tag policy: a DIE is indexed
+        if it has a DW_AT_name and its tag is in this list.
+        Until dwarf_pro_set_debug_names_tags() is called
+        (de_dnames_tags_set zero) a default list is used.
+        A zero de_dnames_tag_count means no .debug_names. */
+    Dwarf_Half *de_dnames_tags;
+    unsigned de_dnames_tag_count;
+    unsigned char de_dnames_tags_set;
+
+    /*  The names collected from the DIE tree by
+        _dwarf_pro_collect_debug_names(). */
+    struct Dwarf_P_Dnames_s *de_dnames;
+
+    /*  Non-zero if "tail_merge_strings" was passed in the
+        dwarf_producer_init() extra string: .debug_str is
+        suffix-merged by _dwarf_pro_tail_merge_debug_str()
+        before the sections are generated. */
+    unsigned char de_tail_merge_strings;
 };
 
 #define CURRENT_VERSION_STAMP   2
@@ -599,4 +642,11 @@ _dwarf_insert_or_find_in_debug_str(Dwarf_P_Debug dbg,
     Dwarf_Unsigned *offset_in_debug_str,
     Dwarf_Error *error);
 
+int _dwarf_pro_attr_strp_offset(Dwarf_P_Debug dbg,
+    Dwarf_P_Attribute attr,
+    Dwarf_Unsigned *offset_out);
+
+int _dwarf_pro_tail_merge_debug_str(Dwarf_P_Debug dbg,
+    Dwarf_Error *error);
+
 #define DISTINGUISHED_VALUE 0xffffffff /* 64bit extension flag */
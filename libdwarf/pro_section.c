@@ -30,6 +30,13 @@
 #include "libdwarfdefs.h"
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif /* HAVE_STDLIB_H */
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif /* HAVE_UNISTD_H */
 #ifdef   HAVE_ELFACCESS_H
 #include <elfaccess.h>
 #endif
@@ -152,8 +159,6 @@ struct Dwarf_P_Rel_Head_s {
 static int
 _dwarf_pro_generate_debug_line_str(Dwarf_P_Debug dbg,
     Dwarf_Signed *nbufs, Dwarf_Error * error);
-static int _dwarf_pro_generate_debug_names(Dwarf_P_Debug dbg,
-    Dwarf_Signed *nbufs, Dwarf_Error * error);
 static int _dwarf_pro_generate_debug_str(Dwarf_P_Debug dbg,
     Dwarf_Signed *nbufs, Dwarf_Error * error);
 static int _dwarf_pro_generate_debugline(Dwarf_P_Debug dbg,
@@ -249,11 +254,13 @@ dwarf_need_debug_line_section(Dwarf_P_Debug dbg)
     return TRUE;
 }
 
-/*  DWARF5 only. */
+/*  DWARF5 only. de_dnames is only set, by
+    _dwarf_pro_collect_debug_names(), for DWARF5 output
+    with at least one name to index. */
 static int
 dwarf_need_debug_names_section(Dwarf_P_Debug dbg)
 {
-    if (!dbg->de_names) {
+    if (!dbg->de_dnames) {
         return FALSE;
     }
     return TRUE;
@@ -300,6 +307,24 @@ dwarf_transform_to_disk_form_a(Dwarf_P_Debug dbg, Dwarf_Signed *count,
         DWARF_P_DBG_ERROR(dbg, DW_DLE_IA, DW_DLV_ERROR);
     }
 
+    /*  Must precede anything recording .debug_str
+        offsets outside of the DIE attributes. */
+    {
+        int res = _dwarf_pro_tail_merge_debug_str(dbg,error);
+        if (res == DW_DLV_ERROR) {
+            return res;
+        }
+    }
+
+    /*  Puts the .debug_names names into .debug_str now,
+        so .debug_str is created below if needed. */
+    {
+        int res = _dwarf_pro_collect_debug_names(dbg,error);
+        if (res == DW_DLV_ERROR) {
+            return res;
+        }
+    }
+
     /* Create dwarf section headers */
     for (sect = 0; sect < NUM_DEBUG_SECTIONS; sect++) {
         long flags = 0;
@@ -390,6 +415,10 @@ dwarf_transform_to_disk_form_a(Dwarf_P_Debug dbg, Dwarf_Signed *count,
             }
             break;
         case DEBUG_NAMES: /* DWARF5 */
+            if (dwarf_need_debug_names_section(dbg) == FALSE) {
+                continue;
+            }
+            break;
         case DEBUG_LOC:
             /* Not handled yet. */
             continue;
@@ -473,6 +502,14 @@ dwarf_transform_to_disk_form_a(Dwarf_P_Debug dbg, Dwarf_Signed *count,
         }
     }
 
+    if (dwarf_need_debug_names_section(dbg) == TRUE) {
+        /*  Needs the DIE offsets from .debug_info. */
+        int res = _dwarf_pro_generate_debug_names(dbg,&nbufs, error);
+        if (res == DW_DLV_ERROR) {
+            return res;
+        }
+    }
+
     if (dbg->de_debug_str->ds_data) {
         int res = _dwarf_pro_generate_debug_str(dbg,&nbufs, error);
         if (res == DW_DLV_ERROR) {
@@ -559,13 +596,6 @@ dwarf_transform_to_disk_form_a(Dwarf_P_Debug dbg, Dwarf_Signed *count,
             }
         }
     }
-    if (dwarf_need_debug_names_section(dbg) == TRUE) {
-        /* FIXME TODO debug_names */
-        int res = _dwarf_pro_generate_debug_names(dbg,&nbufs, error);
-        if (res == DW_DLV_ERROR) {
-            return res;
-        }
-    }
 #if 0  /* FIXME: TODO new sections */
     if (dwarf_need_debug_macro_section(dbg) == TRUE) {
         int res = _dwarf_pro_generate_debug_macro(dbg,&nbufs, error);
@@ -1238,6 +1268,7 @@ _dwarf_pro_generate_debugline(Dwarf_P_Debug dbg,
     int elfsectno = 0;
     unsigned char *start_line_sec = 0;  /* pointer to the buffer at
         section start */
+    struct Dwarf_P_Buffer_Mark_s line_sec_mark;
     /* temps for memcpy */
     Dwarf_Unsigned du = 0;
     Dwarf_Ubyte db = 0;
@@ -1270,6 +1301,7 @@ _dwarf_pro_generate_debugline(Dwarf_P_Debug dbg,
     GET_CHUNK_ERR(dbg, elfsectno, data, prolog_size, error);
 
     start_line_sec = data;
+    _dwarf_pro_buffer_mark(dbg,data,&line_sec_mark);
 
     /* Copy the prologue data into 'data' */
     /* total_length */
@@ -1808,6 +1840,9 @@ _dwarf_pro_generate_debugline(Dwarf_P_Debug dbg,
     /* write total length field */
     du = sum_bytes - OFFSET_PLUS_EXTENSION_SIZE;
     {
+        /*  The buffer may have moved since start_line_sec
+            was set, so use the mark. */
+        start_line_sec = _dwarf_pro_buffer_marked_ptr(&line_sec_mark);
         start_line_sec += extension_size;
         WRITE_UNALIGNED(dbg, (void *) start_line_sec,
             (const void *) &du, sizeof(du), offset_size);
@@ -2458,6 +2493,7 @@ _dwarf_pro_generate_debuginfo(Dwarf_P_Debug dbg,
     unsigned string_attr_count = 0;
     unsigned string_attr_offset = 0;
     Dwarf_Small *abbr_off_ptr = 0;
+    struct Dwarf_P_Buffer_Mark_s abbr_off_mark;
 
     int offset_size = dbg->de_offset_size;
     /*  extension_size is oddly names. The standard calls
@@ -2494,6 +2530,7 @@ _dwarf_pro_generate_debuginfo(Dwarf_P_Debug dbg,
             data += extension_size;
         }
         abbr_off_ptr = data;
+        _dwarf_pro_buffer_mark(dbg,abbr_off_ptr,&abbr_off_mark);
         du = 0; /* length of debug_info, not counting
             this field itself (unknown at this point). */
         WRITE_UNALIGNED(dbg, (void *) data,
@@ -2540,6 +2577,7 @@ _dwarf_pro_generate_debuginfo(Dwarf_P_Debug dbg,
             data += extension_size;
         }
         abbr_off_ptr = data;
+        _dwarf_pro_buffer_mark(dbg,abbr_off_ptr,&abbr_off_mark);
         du = 0; /* length of debug_info, not counting
             this field itself (unknown at this point). */
         WRITE_UNALIGNED(dbg, (void *) data,
@@ -2935,6 +2973,7 @@ _dwarf_pro_generate_debuginfo(Dwarf_P_Debug dbg,
         This is back-patching the CU header we created
         above. */
     du = die_off - OFFSET_PLUS_EXTENSION_SIZE;
+    abbr_off_ptr = _dwarf_pro_buffer_marked_ptr(&abbr_off_mark);
     WRITE_UNALIGNED(dbg, (void *) abbr_off_ptr,
         (const void *) &du, sizeof(du), offset_size);
 
@@ -2998,30 +3037,6 @@ _dwarf_pro_generate_debuginfo(Dwarf_P_Debug dbg,
     *nbufs =  dbg->de_n_debug_sect;
     return DW_DLV_OK;
 }
-static int
-_dwarf_pro_generate_debug_names(Dwarf_P_Debug dbg,
-    UNUSEDARG Dwarf_Signed *nbufs,
-    Dwarf_Error * error)
-{
-#if 0
-    FIXME: Needs implementation
-    int elfsectno_of_debug_names = 0;
-    unsigned char *data = 0;
-
-    elfsectno_of_debug_names = dbg->de_elf_sects[DEBUG_NAMES];
-    GET_CHUNK(dbg, elfsectno_of_debug_str, data, dbg->de_debug_str->ds_nbytes,
-        error);
-    memcpy(data,dbg->de_debug_str->ds_data,dbg->de_debug_str->ds_nbytes);
-    *nbufs = dbg->de_n_debug_sect;
-#endif
-    if (dbg->de_output_version != 5) {
-        /* FIXME: Bogus error value here. */
-        DWARF_P_DBG_ERROR(dbg, DW_DLE_IA, DW_DLV_ERROR);
-    }
-    /* FIXME: Pretending here */
-    return DW_DLV_OK;
-}
-
 static int
 _dwarf_pro_generate_debug_str(Dwarf_P_Debug dbg,
     Dwarf_Signed *nbufs,
@@ -3140,6 +3155,224 @@ dwarf_reset_section_bytes(Dwarf_P_Debug dbg)
     dbg->de_sect_sa_next_to_return = 0;
 }
 
+/*  Hands every section buffer, in the order
+    dwarf_get_section_bytes_a() would, to the caller's sink.
+    The sink sees the library's own buffers: nothing is copied.
+    With "contiguous_sections" each section arrives in one call.
+    Does not disturb the dwarf_get_section_bytes_a() iterator.
+    New 2018. */
+int
+dwarf_pro_stream_section_bytes(Dwarf_P_Debug dbg,
+    Dwarf_P_Section_Sink sink,
+    void *sink_data,
+    Dwarf_Error *error)
+{
+    Dwarf_P_Section_Data sd = 0;
+
+    if (!dbg || dbg->de_version_magic_number != PRO_VERSION_MAGIC) {
+        DWARF_P_DBG_ERROR(dbg, DW_DLE_IA, DW_DLV_ERROR);
+    }
+    if (!sink) {
+        DWARF_P_DBG_ERROR(dbg, DW_DLE_SECTION_SINK_ERROR, DW_DLV_ERROR);
+    }
+    sd = dbg->de_first_debug_sect;
+    if (!sd) {
+        return DW_DLV_NO_ENTRY;
+    }
+    for ( ; sd; sd = sd->ds_next) {
+        int errcode = 0;
+        int res = sink(sd->ds_elf_sect_no,
+            (Dwarf_Ptr)sd->ds_data,
+            sd->ds_nbytes,
+            sink_data,&errcode);
+        if (res != DW_DLV_OK || errcode) {
+            /*  The first failure ends the stream.  The sink's
+                own DW_DLE code, if it set one, is what the
+                caller sees. */
+            if (errcode <= 0 || errcode > DW_DLE_LAST) {
+                errcode = DW_DLE_SECTION_SINK_ERROR;
+            }
+            _dwarf_p_error(dbg,error,errcode);
+            return DW_DLV_ERROR;
+        }
+    }
+    return DW_DLV_OK;
+}
+
+/*  Writes the bytes of one output section to fd at its
+    current file position.  The caller positions fd (with
+    lseek, for example) where the section belongs in the file.
+    New 2018. */
+int
+dwarf_pro_write_section_bytes_fd(Dwarf_P_Debug dbg,
+    Dwarf_Signed elf_section_index,
+    int fd,
+    Dwarf_Unsigned *bytes_written,
+    Dwarf_Error *error)
+{
+    Dwarf_P_Section_Data sd = 0;
+    Dwarf_Unsigned total = 0;
+    int found = FALSE;
+
+    if (!dbg || dbg->de_version_magic_number != PRO_VERSION_MAGIC) {
+        DWARF_P_DBG_ERROR(dbg, DW_DLE_IA, DW_DLV_ERROR);
+    }
+    for (sd = dbg->de_first_debug_sect; sd; sd = sd->ds_next) {
+        const char *p = sd->ds_data;
+        unsigned long remaining = sd->ds_nbytes;
+
+        if (sd->ds_elf_sect_no != elf_section_index) {
+            continue;
+        }
+        found = TRUE;
+#ifdef HAVE_UNISTD_H
+        while (remaining) {
+            ssize_t w = write(fd,p,remaining);
+            if (w < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                DWARF_P_DBG_ERROR(dbg, DW_DLE_SECTION_SINK_ERROR,
+                    DW_DLV_ERROR);
+            }
+            p += w;
+            remaining -= w;
+            total += w;
+        }
+#else /* !HAVE_UNISTD_H */
+        (void)p;
+        (void)remaining;
+        (void)fd;
+        DWARF_P_DBG_ERROR(dbg, DW_DLE_SECTION_SINK_ERROR, DW_DLV_ERROR);
+#endif /* HAVE_UNISTD_H */
+    }
+    if (!found) {
+        return DW_DLV_NO_ENTRY;
+    }
+    if (bytes_written) {
+        *bytes_written = total;
+    }
+    return DW_DLV_OK;
+}
+
+/*  Storage handler for de_contiguous_sections.
+    Each elf section gets exactly one Dwarf_P_Section_Data
+    whose ds_data is a separate malloc, doubled with realloc
+    whenever it fills, so a section of N bytes costs
+    O(log N) allocations and is handed back as one buffer.
+    Because ds_data can move, code holding a pointer into
+    the section across calls here must use
+    _dwarf_pro_buffer_mark().  */
+static Dwarf_Small *
+_dwarf_pro_contiguous_buffer(Dwarf_P_Debug dbg,
+    int elfsectno, unsigned long nbytes)
+{
+    Dwarf_P_Section_Data cursect = dbg->de_current_active_section;
+    unsigned long needed = 0;
+    Dwarf_Small *space_for_caller = 0;
+
+    if (cursect->ds_elf_sect_no != elfsectno) {
+        Dwarf_P_Section_Data sd = dbg->de_first_debug_sect;
+        Dwarf_P_Section_Data lastsd = 0;
+
+        /*  The section changed. Sections are few, and
+            change rarely, so a list walk is fine here. */
+        cursect = 0;
+        for ( ; sd; sd = sd->ds_next) {
+            if (sd->ds_elf_sect_no == elfsectno) {
+                cursect = sd;
+                break;
+            }
+            lastsd = sd;
+        }
+        if (!cursect) {
+            cursect = (Dwarf_P_Section_Data)
+                _dwarf_p_get_alloc(dbg,
+                    sizeof(struct Dwarf_P_Section_Data_s));
+            if (cursect == NULL) {
+                return NULL;
+            }
+            cursect->ds_elf_sect_no = elfsectno;
+            if (!lastsd) {
+                /*  Drop the MAGIC_SECT_NO placeholder, as
+                    _dwarf_pro_buffer() does. */
+                dbg->de_debug_sects = cursect;
+                dbg->de_first_debug_sect = cursect;
+            } else {
+                lastsd->ds_next = cursect;
+            }
+            dbg->de_n_debug_sect++;
+        }
+        dbg->de_current_active_section = cursect;
+    }
+    needed = cursect->ds_nbytes + nbytes;
+    if (needed < cursect->ds_nbytes) {
+        /* Overflow. */
+        return NULL;
+    }
+    if (needed > cursect->ds_orig_alloc) {
+        unsigned long newsize = cursect->ds_orig_alloc;
+        char *newdata = 0;
+
+        if (!newsize) {
+            newsize = CONTIGUOUS_INITIAL_SIZE;
+        }
+        while (newsize < needed) {
+            unsigned long doubled = newsize * 2;
+            if (doubled < newsize) {
+                newsize = needed;
+                break;
+            }
+            newsize = doubled;
+        }
+        newdata = realloc(cursect->ds_data,newsize);
+        if (!newdata) {
+            return NULL;
+        }
+        /*  Callers rely on the space being zeroed, as
+            _dwarf_p_get_alloc() space is. */
+        memset(newdata + cursect->ds_orig_alloc,0,
+            newsize - cursect->ds_orig_alloc);
+        cursect->ds_data = newdata;
+        cursect->ds_orig_alloc = newsize;
+    }
+    space_for_caller = (Dwarf_Small *)
+        (cursect->ds_data + cursect->ds_nbytes);
+    cursect->ds_nbytes = needed;
+    return space_for_caller;
+}
+
+void
+_dwarf_pro_buffer_mark(Dwarf_P_Debug dbg, Dwarf_Small *ptr,
+    struct Dwarf_P_Buffer_Mark_s *mark)
+{
+    Dwarf_P_Section_Data cursect = dbg->de_current_active_section;
+
+    mark->bm_sect = cursect;
+    mark->bm_offset = (char *)ptr - cursect->ds_data;
+}
+
+Dwarf_Small *
+_dwarf_pro_buffer_marked_ptr(struct Dwarf_P_Buffer_Mark_s *mark)
+{
+    return (Dwarf_Small *)mark->bm_sect->ds_data + mark->bm_offset;
+}
+
+void
+_dwarf_pro_free_section_buffers(Dwarf_P_Debug dbg)
+{
+    Dwarf_P_Section_Data sd = 0;
+
+    if (!dbg->de_contiguous_sections) {
+        /* The data is part of each chunk allocation. */
+        return;
+    }
+    for (sd = dbg->de_first_debug_sect; sd; sd = sd->ds_next) {
+        free(sd->ds_data);
+        sd->ds_data = 0;
+    }
+}
+
 /*  Storage handler. Gets either a new chunk of memory, or
     a pointer in existing memory, from the linked list attached
     to dbg at de_debug_sects, depending on size of nbytes
@@ -3158,6 +3391,9 @@ _dwarf_pro_buffer(Dwarf_P_Debug dbg,
 {
     Dwarf_P_Section_Data cursect = 0;
 
+    if (dbg->de_contiguous_sections) {
+        return _dwarf_pro_contiguous_buffer(dbg,elfsectno,nbytes);
+    }
     cursect = dbg->de_current_active_section;
     /*  By using MAGIC_SECT_NO we allow the following MAGIC_SECT_NO must
         not match any legit section number. test to have just two
@@ -53,6 +53,17 @@ struct Dwarf_P_Section_Data_s {
     Dwarf_P_Section_Data ds_next; /* next on the list */
 };
 
+/*  A place in section data to be filled in later
+    (a length field, for example) once more has been
+    written to the section.
+    With de_contiguous_sections the section buffer can move
+    as it grows, so we record the block and an offset
+    rather than a pointer. */
+struct Dwarf_P_Buffer_Mark_s {
+    Dwarf_P_Section_Data bm_sect;
+    unsigned long        bm_offset;
+};
+
 /* Used to allow a dummy initial struct (which we
    drop before it gets used
    This must not match any legitimate 'section' number.
@@ -66,6 +77,10 @@ struct Dwarf_P_Section_Data_s {
 */
 #define CHUNK_SIZE (4096 - sizeof (struct Dwarf_P_Section_Data_s))
 
+/*  Initial size of a de_contiguous_sections buffer.
+    The buffer doubles each time it fills. */
+#define CONTIGUOUS_INITIAL_SIZE 16384
+
 /*
     chunk alloc routine -
     if chunk->ds_data is nil, it will alloc CHUNK_SIZE bytes,
@@ -77,6 +92,17 @@ struct Dwarf_P_Section_Data_s {
 Dwarf_Small *_dwarf_pro_buffer(Dwarf_P_Debug dbg, int sectno,
     unsigned long nbytes);
 
+/*  ptr must be the value just returned by _dwarf_pro_buffer().
+    Records where ptr is so _dwarf_pro_buffer_marked_ptr()
+    can find the same bytes after later _dwarf_pro_buffer() calls. */
+void _dwarf_pro_buffer_mark(Dwarf_P_Debug dbg, Dwarf_Small *ptr,
+    struct Dwarf_P_Buffer_Mark_s *mark);
+Dwarf_Small *_dwarf_pro_buffer_marked_ptr(
+    struct Dwarf_P_Buffer_Mark_s *mark);
+
+/*  Frees the separately allocated de_contiguous_sections buffers. */
+void _dwarf_pro_free_section_buffers(Dwarf_P_Debug dbg);
+
 /* GET_CHUNK_ERROR is new Sept 2016 to use DW_DLV_ERROR. */
 #define GET_CHUNK_ERR(dbg,sectno,ptr,nbytes,error) \
 { \
@@ -99,6 +125,13 @@ int _dwarf_transform_arange_to_disk(Dwarf_P_Debug dbg,
     Dwarf_Signed *nbufs,
     Dwarf_Error * error);
 
+/* In pro_dnames.c */
+int _dwarf_pro_collect_debug_names(Dwarf_P_Debug dbg,
+    Dwarf_Error * error);
+int _dwarf_pro_generate_debug_names(Dwarf_P_Debug dbg,
+    Dwarf_Signed *nbufs,
+    Dwarf_Error * error);
+
 /* These are for creating ELF section type codes.
 */
 #if defined(linux) || defined(__BEOS__) || !defined(SHT_MIPS_DWARF)